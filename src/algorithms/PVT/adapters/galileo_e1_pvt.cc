@@ -76,6 +76,15 @@ GalileoE1Pvt::GalileoE1Pvt(ConfigurationInterface* configuration,
     nmea_dump_devname = configuration->property(role + ".nmea_dump_devname", default_nmea_dump_devname);
     // make PVT object
     pvt_ = galileo_e1_make_pvt_cc(in_streams_, queue_, dump_, dump_filename_, averaging_depth, flag_averaging, output_rate_ms, display_rate_ms, flag_nmea_tty_port, nmea_dump_filename, nmea_dump_devname);
+    // the observables block delivers one epoch every Observables.output_rate_ms
+    int epoch_period_ms;
+    epoch_period_ms = configuration->property("Observables.output_rate_ms", 1);
+    if (epoch_period_ms < 1) epoch_period_ms = 1;
+    if ((output_rate_ms % epoch_period_ms) != 0 or (display_rate_ms % epoch_period_ms) != 0)
+        {
+            LOG(WARNING) << role << ".output_rate_ms and " << role << ".display_rate_ms should be multiples of Observables.output_rate_ms";
+        }
+    pvt_->set_epoch_period_ms(epoch_period_ms);
     DLOG(INFO) << "pvt(" << pvt_->unique_id() << ")";
 }
 
@@ -52,6 +52,8 @@ GpsL1CaPvt::GpsL1CaPvt(ConfigurationInterface* configuration,
     std::string default_dump_filename = "./pvt.dat";
     std::string default_nmea_dump_filename = "./nmea_pvt.nmea";
     std::string default_nmea_dump_devname = "/dev/tty1";
+    std::string default_rtcm_dump_filename = ""; // no RTCM file
+    std::string default_rtcm_dump_devname = "/dev/pts/1";
     DLOG(INFO) << "role " << role;
     dump_ = configuration->property(role + ".dump", false);
     dump_filename_ = configuration->property(role + ".dump_filename", default_dump_filename);
@@ -73,8 +75,37 @@ GpsL1CaPvt::GpsL1CaPvt(ConfigurationInterface* configuration,
     nmea_dump_filename = configuration->property(role + ".nmea_dump_filename", default_nmea_dump_filename);
     std::string nmea_dump_devname;
     nmea_dump_devname = configuration->property(role + ".nmea_dump_devname", default_nmea_dump_devname);
+    // RTCM Printer settings
+    bool flag_rtcm_server;
+    flag_rtcm_server = configuration->property(role + ".flag_rtcm_server", false);
+    unsigned short rtcm_tcp_port;
+    rtcm_tcp_port = configuration->property(role + ".rtcm_tcp_port", 2101);
+    int rtcm_station_id;
+    rtcm_station_id = configuration->property(role + ".rtcm_station_id", 1234);
+    if (rtcm_station_id < 0 or rtcm_station_id > RTCM_MAX_STATION_ID)
+        {
+            LOG(WARNING) << role << ".rtcm_station_id=" << rtcm_station_id << " is out of the 0 to " << RTCM_MAX_STATION_ID << " range, using "
+                         << (rtcm_station_id < 0 ? 0 : RTCM_MAX_STATION_ID);
+            rtcm_station_id = (rtcm_station_id < 0 ? 0 : RTCM_MAX_STATION_ID);
+        }
+    bool flag_rtcm_tty_port;
+    flag_rtcm_tty_port = configuration->property(role + ".flag_rtcm_tty_port", false);
+    std::string rtcm_dump_devname;
+    rtcm_dump_devname = configuration->property(role + ".rtcm_dump_devname", default_rtcm_dump_devname);
+    std::string rtcm_dump_filename;
+    rtcm_dump_filename = configuration->property(role + ".rtcm_dump_filename", default_rtcm_dump_filename);
     // make PVT object
-    pvt_ = gps_l1_ca_make_pvt_cc(in_streams_, queue_, dump_, dump_filename_, averaging_depth, flag_averaging, output_rate_ms, display_rate_ms, flag_nmea_tty_port, nmea_dump_filename, nmea_dump_devname);
+    pvt_ = gps_l1_ca_make_pvt_cc(in_streams_, queue_, dump_, dump_filename_, averaging_depth, flag_averaging, output_rate_ms, display_rate_ms, flag_nmea_tty_port, nmea_dump_filename, nmea_dump_devname,
+            flag_rtcm_server, flag_rtcm_tty_port, rtcm_tcp_port, rtcm_station_id, rtcm_dump_filename, rtcm_dump_devname);
+    // the observables block delivers one epoch every Observables.output_rate_ms
+    int epoch_period_ms;
+    epoch_period_ms = configuration->property("Observables.output_rate_ms", 1);
+    if (epoch_period_ms < 1) epoch_period_ms = 1;
+    if ((output_rate_ms % epoch_period_ms) != 0 or (display_rate_ms % epoch_period_ms) != 0)
+        {
+            LOG(WARNING) << role << ".output_rate_ms and " << role << ".display_rate_ms should be multiples of Observables.output_rate_ms";
+        }
+    pvt_->set_epoch_period_ms(epoch_period_ms);
     DLOG(INFO) << "pvt(" << pvt_->unique_id() << ")";
 }
 
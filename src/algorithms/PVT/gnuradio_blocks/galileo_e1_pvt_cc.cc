@@ -63,20 +63,18 @@ galileo_e1_pvt_cc::galileo_e1_pvt_cc(unsigned int nchannels, boost::shared_ptr<g
 
     d_output_rate_ms = output_rate_ms;
     d_display_rate_ms = display_rate_ms;
+    d_epoch_period_ms = 1;
     d_queue = queue;
     d_dump = dump;
     d_nchannels = nchannels;
     d_dump_filename = dump_filename;
     std::string dump_ls_pvt_filename = dump_filename;
 
-    //initialize kml_printer
+    //initialize the kml, nmea and rinex printers and their thread
     std::string kml_dump_filename;
     kml_dump_filename = d_dump_filename;
     kml_dump_filename.append(".kml");
-    d_kml_dump.set_headers(kml_dump_filename);
-
-    //initialize nmea_printer
-    d_nmea_printer = new Nmea_Printer(nmea_dump_filename, flag_nmea_tty_port, nmea_dump_devname);
+    d_output_sink = new Pvt_Output_Sink(kml_dump_filename, nmea_dump_filename, flag_nmea_tty_port, nmea_dump_devname);
 
     d_dump_filename.append("_raw.dat");
     dump_ls_pvt_filename.append("_ls_pvt.dat");
@@ -87,12 +85,11 @@ galileo_e1_pvt_cc::galileo_e1_pvt_cc(unsigned int nchannels, boost::shared_ptr<g
     d_ls_pvt->set_averaging_depth(d_averaging_depth);
 
     d_sample_counter = 0;
-    d_last_sample_nav_output = 0;
+    d_galileo_ephemeris_version = 0;
+    d_galileo_utc_model_version = 0;
+    d_galileo_iono_version = 0;
     d_rx_time = 0.0;
 
-    b_rinex_header_writen = false;
-    rp = new Rinex_Printer();
-
     // ############# ENABLE DATA FILE LOG #################
     if (d_dump == true)
         {
@@ -116,10 +113,8 @@ galileo_e1_pvt_cc::galileo_e1_pvt_cc(unsigned int nchannels, boost::shared_ptr<g
 
 galileo_e1_pvt_cc::~galileo_e1_pvt_cc()
 {
-    d_kml_dump.close_file();
+    delete d_output_sink;
     delete d_ls_pvt;
-    delete rp;
-    delete d_nmea_printer;
 }
 
 
@@ -134,126 +129,110 @@ bool galileo_e1_pvt_cc::pseudoranges_pairCompare_min( std::pair<int,Gnss_Synchro
 int galileo_e1_pvt_cc::general_work (int noutput_items, gr_vector_int &ninput_items,
         gr_vector_const_void_star &input_items,	gr_vector_void_star &output_items)
 {
-    d_sample_counter++;
-
-    std::map<int,Gnss_Synchro> gnss_pseudoranges_map;
-
     Gnss_Synchro **in = (Gnss_Synchro **)  &input_items[0]; //Get the input pointer
 
-    for (unsigned int i = 0; i < d_nchannels; i++)
+    // process all the epochs available in every channel
+    int n_epochs = ninput_items[0];
+    for (unsigned int i = 1; i < d_nchannels; i++)
         {
-            if (in[i][0].Flag_valid_pseudorange == true)
-                {
-                    gnss_pseudoranges_map.insert(std::pair<int,Gnss_Synchro>(in[i][0].PRN, in[i][0])); // store valid pseudoranges in a map
-                    d_rx_time = in[i][0].d_TOW_at_current_symbol; // all the channels have the same RX timestamp (common RX time pseudoranges)
-                }
+            if (ninput_items[i] < n_epochs) n_epochs = ninput_items[i];
         }
 
-    // ############ 1. READ EPHEMERIS/UTC_MODE/IONO FROM GLOBAL MAPS ####
-
-    if (global_galileo_ephemeris_map.size() > 0)
+    for (int epoch = 0; epoch < n_epochs; epoch++)
         {
-            d_ls_pvt->galileo_ephemeris_map = global_galileo_ephemeris_map.get_map_copy();
-        }
+            // the observables block delivers one epoch every d_epoch_period_ms
+            d_sample_counter += d_epoch_period_ms;
 
-    if (global_galileo_utc_model_map.size() > 0)
-        {
-            // UTC MODEL data is shared for all the Galileo satellites. Read always at ID=0
-            global_galileo_utc_model_map.read(0, d_ls_pvt->galileo_utc_model);
-        }
+            // nothing to do in the epochs without PVT fix, display or dump
+            if ((d_sample_counter % d_output_rate_ms) != 0 and (d_sample_counter % d_display_rate_ms) != 0 and !d_dump) continue;
 
-    if (global_galileo_iono_map.size() > 0)
-        {
-            // IONO data is shared for all the Galileo satellites. Read always at ID=0
-            global_galileo_iono_map.read(0, d_ls_pvt->galileo_iono);
-        }
+            std::map<int,Gnss_Synchro> gnss_pseudoranges_map;
 
-    // ############ 2 COMPUTE THE PVT ################################
-    if (gnss_pseudoranges_map.size() > 0 and d_ls_pvt->galileo_ephemeris_map.size() > 0)
-        {
-            // compute on the fly PVT solution
-            if ((d_sample_counter % d_output_rate_ms) == 0)
+            for (unsigned int i = 0; i < d_nchannels; i++)
                 {
-                    bool pvt_result;
-                    pvt_result = d_ls_pvt->get_PVT(gnss_pseudoranges_map, d_rx_time, d_flag_averaging);
-
-
-                    if (pvt_result == true)
+                    if (in[i][epoch].Flag_valid_pseudorange == true)
                         {
-                            d_kml_dump.print_position_galileo(d_ls_pvt, d_flag_averaging);
-                            //ToDo: Implement Galileo RINEX and Galileo NMEA outputs
-                            //                            d_nmea_printer->Print_Nmea_Line(d_ls_pvt, d_flag_averaging);
-                            //
-                            //                            if (!b_rinex_header_writen) //  & we have utc data in nav message!
-                            //                                {
-                            //                                    std::map<int,Gps_Ephemeris>::iterator gps_ephemeris_iter;
-                            //                                    gps_ephemeris_iter = d_ls_pvt->gps_ephemeris_map.begin();
-                            //                                    if (gps_ephemeris_iter != d_ls_pvt->gps_ephemeris_map.end())
-                            //                                        {
-                            //                                            rp->rinex_obs_header(rp->obsFile, gps_ephemeris_iter->second,d_rx_time);
-                            //                                            rp->rinex_nav_header(rp->navFile,d_ls_pvt->gps_iono, d_ls_pvt->gps_utc_model);
-                            //                                            b_rinex_header_writen = true; // do not write header anymore
-                            //                                        }
-                            //                                }
-                            //                            if(b_rinex_header_writen) // Put here another condition to separate annotations (e.g 30 s)
-                            //                                {
-                            //                                    // Limit the RINEX navigation output rate to 1/6 seg
-                            //                                    // Notice that d_sample_counter period is 1ms (for GPS correlators)
-                            //                                    if ((d_sample_counter-d_last_sample_nav_output)>=6000)
-                            //                                        {
-                            //                                            rp->log_rinex_nav(rp->navFile, d_ls_pvt->gps_ephemeris_map);
-                            //                                            d_last_sample_nav_output=d_sample_counter;
-                            //                                        }
-                            //                                    std::map<int,Gps_Ephemeris>::iterator gps_ephemeris_iter;
-                            //                                    gps_ephemeris_iter = d_ls_pvt->gps_ephemeris_map.begin();
-                            //                                    if (gps_ephemeris_iter != d_ls_pvt->gps_ephemeris_map.end())
-                            //                                        {
-                            //                                            rp->log_rinex_obs(rp->obsFile, gps_ephemeris_iter->second, d_rx_time, gnss_pseudoranges_map);
-                            //                                        }
-                            //                                }
+                            gnss_pseudoranges_map.insert(std::pair<int,Gnss_Synchro>(in[i][epoch].PRN, in[i][epoch])); // store valid pseudoranges in a map
+                            d_rx_time = in[i][epoch].d_TOW_at_current_symbol; // all the channels have the same RX timestamp (common RX time pseudoranges)
                         }
                 }
 
-            // DEBUG MESSAGE: Display position in console output
-            if (((d_sample_counter % d_display_rate_ms) == 0) and d_ls_pvt->b_valid_position == true)
-                {
-                    std::cout << "Position at " << boost::posix_time::to_simple_string(d_ls_pvt->d_position_UTC_time)
-                              << " is Lat = " << d_ls_pvt->d_latitude_d << " [deg], Long = " << d_ls_pvt->d_longitude_d
-                              << " [deg], Height= " << d_ls_pvt->d_height_m << " [m]" << std::endl;
-
-                    LOG(INFO) << "Position at " << boost::posix_time::to_simple_string(d_ls_pvt->d_position_UTC_time)
-                              << " is Lat = " << d_ls_pvt->d_latitude_d << " [deg], Long = " << d_ls_pvt->d_longitude_d
-                              << " [deg], Height= " << d_ls_pvt->d_height_m << " [m]";
-
-                    LOG(INFO) << "Dilution of Precision at " << boost::posix_time::to_simple_string(d_ls_pvt->d_position_UTC_time)
-                              << " is HDOP = " << d_ls_pvt->d_HDOP << " VDOP = "
-                              << d_ls_pvt->d_VDOP <<" TDOP = " << d_ls_pvt->d_TDOP
-                              << " GDOP = " << d_ls_pvt->d_GDOP;
-                }
+            // ############ 1. READ EPHEMERIS/UTC_MODE/IONO FROM GLOBAL MAPS ####
+
+            // the maps are copied only when the data collectors have written new data
+            global_galileo_ephemeris_map.get_map_copy_if_changed(d_galileo_ephemeris_version, d_ls_pvt->galileo_ephemeris_map);
 
-            // MULTIPLEXED FILE RECORDING - Record results to file
-            if(d_dump == true)
+            // UTC MODEL data is shared for all the Galileo satellites. Read always at ID=0
+            global_galileo_utc_model_map.read_if_changed(0, d_galileo_utc_model_version, d_ls_pvt->galileo_utc_model);
+
+            // IONO data is shared for all the Galileo satellites. Read always at ID=0
+            global_galileo_iono_map.read_if_changed(0, d_galileo_iono_version, d_ls_pvt->galileo_iono);
+
+            // ############ 2 COMPUTE THE PVT ################################
+            if (gnss_pseudoranges_map.size() > 0 and d_ls_pvt->galileo_ephemeris_map.size() > 0)
                 {
-                    try
-                    {
-                            double tmp_double;
-                            for (unsigned int i = 0; i < d_nchannels; i++)
+                    // compute on the fly PVT solution
+                    if ((d_sample_counter % d_output_rate_ms) == 0)
+                        {
+                            bool pvt_result;
+                            pvt_result = d_ls_pvt->get_PVT(gnss_pseudoranges_map, d_rx_time, d_flag_averaging);
+
+
+                            if (pvt_result == true)
                                 {
-                                    tmp_double = in[i][0].Pseudorange_m;
-                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                                    tmp_double = 0;
-                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                                    d_dump_file.write((char*)&d_rx_time, sizeof(double));
+                                    // KML output, formatted and written by the output thread
+                                    //ToDo: Implement Galileo RINEX and Galileo NMEA outputs
+                                    Pvt_Output_Record record;
+                                    record.type = PVT_OUTPUT_GALILEO_FIX;
+                                    record.sample_counter = d_sample_counter;
+                                    record.rx_time = d_rx_time;
+                                    record.set_solution(d_ls_pvt);
+                                    record.set_observables(gnss_pseudoranges_map);
+                                    d_output_sink->push(record);
                                 }
-                    }
-                    catch (const std::ifstream::failure& e)
-                    {
-                            LOG(WARNING) << "Exception writing observables dump file " << e.what();
-                    }
+                        }
+
+                    // DEBUG MESSAGE: Display position in console output
+                    if (((d_sample_counter % d_display_rate_ms) == 0) and d_ls_pvt->b_valid_position == true)
+                        {
+                            std::cout << "Position at " << boost::posix_time::to_simple_string(d_ls_pvt->d_position_UTC_time)
+                                      << " is Lat = " << d_ls_pvt->d_latitude_d << " [deg], Long = " << d_ls_pvt->d_longitude_d
+                                      << " [deg], Height= " << d_ls_pvt->d_height_m << " [m]" << std::endl;
+
+                            LOG(INFO) << "Position at " << boost::posix_time::to_simple_string(d_ls_pvt->d_position_UTC_time)
+                                      << " is Lat = " << d_ls_pvt->d_latitude_d << " [deg], Long = " << d_ls_pvt->d_longitude_d
+                                      << " [deg], Height= " << d_ls_pvt->d_height_m << " [m]";
+
+                            LOG(INFO) << "Dilution of Precision at " << boost::posix_time::to_simple_string(d_ls_pvt->d_position_UTC_time)
+                                      << " is HDOP = " << d_ls_pvt->d_HDOP << " VDOP = "
+                                      << d_ls_pvt->d_VDOP <<" TDOP = " << d_ls_pvt->d_TDOP
+                                      << " GDOP = " << d_ls_pvt->d_GDOP;
+                        }
+
+                    // MULTIPLEXED FILE RECORDING - Record results to file
+                    if(d_dump == true)
+                        {
+                            try
+                            {
+                                    double tmp_double;
+                                    for (unsigned int i = 0; i < d_nchannels; i++)
+                                        {
+                                            tmp_double = in[i][epoch].Pseudorange_m;
+                                            d_dump_file.write((char*)&tmp_double, sizeof(double));
+                                            tmp_double = 0;
+                                            d_dump_file.write((char*)&tmp_double, sizeof(double));
+                                            d_dump_file.write((char*)&d_rx_time, sizeof(double));
+                                        }
+                            }
+                            catch (const std::ifstream::failure& e)
+                            {
+                                    LOG(WARNING) << "Exception writing observables dump file " << e.what();
+                            }
+                        }
                 }
         }
 
-    consume_each(1); //one by one
+    consume_each(n_epochs);
     return 0;
 }
 
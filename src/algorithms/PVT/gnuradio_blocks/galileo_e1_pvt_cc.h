@@ -43,9 +43,7 @@
 #include "galileo_ephemeris.h"
 #include "galileo_utc_model.h"
 #include "galileo_iono.h"
-#include "nmea_printer.h"
-#include "kml_printer.h"
-#include "rinex_printer.h"
+#include "pvt_output_sink.h"
 #include "galileo_e1_ls_pvt.h"
 #include "GPS_L1_CA.h"
 #include "Galileo_E1.h"
@@ -95,8 +93,6 @@ private:
                       std::string nmea_dump_devname);
     boost::shared_ptr<gr::msg_queue> d_queue;
     bool d_dump;
-    bool b_rinex_header_writen;
-    Rinex_Printer *rp;
     unsigned int d_nchannels;
     std::string d_dump_filename;
     std::ofstream d_dump_file;
@@ -104,17 +100,25 @@ private:
     bool d_flag_averaging;
     int d_output_rate_ms;
     int d_display_rate_ms;
+    int d_epoch_period_ms; // time between the epochs delivered by the observables block
     long unsigned int d_sample_counter;
-    long unsigned int d_last_sample_nav_output;
-    Kml_Printer d_kml_dump;
-    Nmea_Printer *d_nmea_printer;
+    Pvt_Output_Sink *d_output_sink; // KML, NMEA and RINEX outputs, written by their own thread
     double d_rx_time;
     galileo_e1_ls_pvt *d_ls_pvt;
+    // versions of the global maps last copied into d_ls_pvt
+    unsigned int d_galileo_ephemeris_version;
+    unsigned int d_galileo_utc_model_version;
+    unsigned int d_galileo_iono_version;
     bool pseudoranges_pairCompare_min(std::pair<int,Gnss_Synchro> a, std::pair<int,Gnss_Synchro> b);
 
 public:
     ~galileo_e1_pvt_cc (); //!< Default destructor
 
+    /*!
+     * \brief Sets the time between the epochs delivered by the observables block [ms], 1 by default
+     */
+    void set_epoch_period_ms(int epoch_period_ms) {d_epoch_period_ms = epoch_period_ms;};
+
     int general_work (int noutput_items, gr_vector_int &ninput_items,
             gr_vector_const_void_star &input_items, gr_vector_void_star &output_items); //!< PVT Signal Processing
 };
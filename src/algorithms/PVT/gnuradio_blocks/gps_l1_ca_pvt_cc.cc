@@ -56,9 +56,9 @@ extern concurrent_map<Sbas_Satellite_Correction> global_sbas_sat_corr_map;
 extern concurrent_map<Sbas_Ephemeris> global_sbas_ephemeris_map;
 
 gps_l1_ca_pvt_cc_sptr
-gps_l1_ca_make_pvt_cc(unsigned int nchannels, boost::shared_ptr<gr::msg_queue> queue, bool dump, std::string dump_filename, int averaging_depth, bool flag_averaging, int output_rate_ms, int display_rate_ms, bool flag_nmea_tty_port, std::string nmea_dump_filename, std::string nmea_dump_devname)
+gps_l1_ca_make_pvt_cc(unsigned int nchannels, boost::shared_ptr<gr::msg_queue> queue, bool dump, std::string dump_filename, int averaging_depth, bool flag_averaging, int output_rate_ms, int display_rate_ms, bool flag_nmea_tty_port, std::string nmea_dump_filename, std::string nmea_dump_devname, bool flag_rtcm_server, bool flag_rtcm_tty_port, unsigned short rtcm_tcp_port, unsigned short rtcm_station_id, std::string rtcm_dump_filename, std::string rtcm_dump_devname)
 {
-    return gps_l1_ca_pvt_cc_sptr(new gps_l1_ca_pvt_cc(nchannels, queue, dump, dump_filename, averaging_depth, flag_averaging, output_rate_ms, display_rate_ms, flag_nmea_tty_port, nmea_dump_filename, nmea_dump_devname));
+    return gps_l1_ca_pvt_cc_sptr(new gps_l1_ca_pvt_cc(nchannels, queue, dump, dump_filename, averaging_depth, flag_averaging, output_rate_ms, display_rate_ms, flag_nmea_tty_port, nmea_dump_filename, nmea_dump_devname, flag_rtcm_server, flag_rtcm_tty_port, rtcm_tcp_port, rtcm_station_id, rtcm_dump_filename, rtcm_dump_devname));
 }
 
 
@@ -71,26 +71,32 @@ gps_l1_ca_pvt_cc::gps_l1_ca_pvt_cc(unsigned int nchannels,
         int display_rate_ms,
         bool flag_nmea_tty_port,
         std::string nmea_dump_filename,
-        std::string nmea_dump_devname) :
+        std::string nmea_dump_devname,
+        bool flag_rtcm_server,
+        bool flag_rtcm_tty_port,
+        unsigned short rtcm_tcp_port,
+        unsigned short rtcm_station_id,
+        std::string rtcm_dump_filename,
+        std::string rtcm_dump_devname) :
              gr::block("gps_l1_ca_pvt_cc", gr::io_signature::make(nchannels, nchannels,  sizeof(Gnss_Synchro)),
              gr::io_signature::make(1, 1, sizeof(gr_complex)) )
 {
     d_output_rate_ms = output_rate_ms;
     d_display_rate_ms = display_rate_ms;
+    d_epoch_period_ms = 1;
     d_queue = queue;
     d_dump = dump;
     d_nchannels = nchannels;
     d_dump_filename = dump_filename;
     std::string dump_ls_pvt_filename = dump_filename;
 
-    //initialize kml_printer
+    //initialize the kml, nmea, rinex and rtcm printers and their thread
     std::string kml_dump_filename;
     kml_dump_filename = d_dump_filename;
     kml_dump_filename.append(".kml");
-    d_kml_dump.set_headers(kml_dump_filename);
-
-    //initialize nmea_printer
-    d_nmea_printer = new Nmea_Printer(nmea_dump_filename, flag_nmea_tty_port, nmea_dump_devname);
+    bool flag_rtcm = flag_rtcm_server or flag_rtcm_tty_port or !rtcm_dump_filename.empty();
+    d_output_sink = new Pvt_Output_Sink(kml_dump_filename, nmea_dump_filename, flag_nmea_tty_port, nmea_dump_devname,
+            flag_rtcm, rtcm_dump_filename, flag_rtcm_server, rtcm_tcp_port, flag_rtcm_tty_port, rtcm_dump_devname, rtcm_station_id);
 
     d_dump_filename.append("_raw.dat");
     dump_ls_pvt_filename.append("_ls_pvt.dat");
@@ -101,13 +107,14 @@ gps_l1_ca_pvt_cc::gps_l1_ca_pvt_cc(unsigned int nchannels,
     d_ls_pvt->set_averaging_depth(d_averaging_depth);
 
     d_sample_counter = 0;
-    d_last_sample_nav_output = 0;
+    d_gps_ephemeris_version = 0;
+    d_gps_utc_model_version = 0;
+    d_gps_iono_version = 0;
+    d_sbas_iono_version = 0;
+    d_sbas_sat_corr_version = 0;
+    d_sbas_ephemeris_version = 0;
     d_rx_time = 0.0;
 
-    b_rinex_header_writen = false;
-    b_rinex_sbs_header_writen = false;
-    rp = new Rinex_Printer();
-
     // ############# ENABLE DATA FILE LOG #################
     if (d_dump == true)
         {
@@ -131,10 +138,8 @@ gps_l1_ca_pvt_cc::gps_l1_ca_pvt_cc(unsigned int nchannels,
 
 gps_l1_ca_pvt_cc::~gps_l1_ca_pvt_cc()
 {
-    d_kml_dump.close_file();
+    delete d_output_sink;
     delete d_ls_pvt;
-    delete rp;
-    delete d_nmea_printer;
 }
 
 
@@ -149,165 +154,149 @@ bool pseudoranges_pairCompare_min( std::pair<int,Gnss_Synchro> a, std::pair<int,
 int gps_l1_ca_pvt_cc::general_work (int noutput_items, gr_vector_int &ninput_items,
         gr_vector_const_void_star &input_items,	gr_vector_void_star &output_items)
 {
-    d_sample_counter++;
-
-    std::map<int,Gnss_Synchro> gnss_pseudoranges_map;
-
     Gnss_Synchro **in = (Gnss_Synchro **)  &input_items[0]; //Get the input pointer
 
-    for (unsigned int i = 0; i < d_nchannels; i++)
+    // process all the epochs available in every channel
+    int n_epochs = ninput_items[0];
+    for (unsigned int i = 1; i < d_nchannels; i++)
         {
-            if (in[i][0].Flag_valid_pseudorange == true)
+            if (ninput_items[i] < n_epochs) n_epochs = ninput_items[i];
+        }
+
+    for (int epoch = 0; epoch < n_epochs; epoch++)
+        {
+            // the observables block delivers one epoch every d_epoch_period_ms
+            d_sample_counter += d_epoch_period_ms;
+
+            // nothing to do in the epochs without PVT fix, display or dump
+            if ((d_sample_counter % d_output_rate_ms) != 0 and (d_sample_counter % d_display_rate_ms) != 0 and !d_dump) continue;
+
+            std::map<int,Gnss_Synchro> gnss_pseudoranges_map;
+
+            for (unsigned int i = 0; i < d_nchannels; i++)
                 {
-                    gnss_pseudoranges_map.insert(std::pair<int,Gnss_Synchro>(in[i][0].PRN, in[i][0])); // store valid pseudoranges in a map
-                    d_rx_time = in[i][0].d_TOW_at_current_symbol; // all the channels have the same RX timestamp (common RX time pseudoranges)
+                    if (in[i][epoch].Flag_valid_pseudorange == true)
+                        {
+                            gnss_pseudoranges_map.insert(std::pair<int,Gnss_Synchro>(in[i][epoch].PRN, in[i][epoch])); // store valid pseudoranges in a map
+                            d_rx_time = in[i][epoch].d_TOW_at_current_symbol; // all the channels have the same RX timestamp (common RX time pseudoranges)
+                        }
                 }
-        }
 
-    // ############ 1. READ EPHEMERIS/UTC_MODE/IONO FROM GLOBAL MAPS ####
+            // ############ 1. READ EPHEMERIS/UTC_MODE/IONO FROM GLOBAL MAPS ####
 
-    d_ls_pvt->gps_ephemeris_map = global_gps_ephemeris_map.get_map_copy();
+            // the maps are copied only when the data collectors have written new data
+            bool new_navigation_data = false;
+            if (global_gps_ephemeris_map.get_map_copy_if_changed(d_gps_ephemeris_version, d_ls_pvt->gps_ephemeris_map)) new_navigation_data = true;
 
-    if (global_gps_utc_model_map.size() > 0)
-        {
             // UTC MODEL data is shared for all the GPS satellites. Read always at ID=0
-            global_gps_utc_model_map.read(0, d_ls_pvt->gps_utc_model);
-        }
+            if (global_gps_utc_model_map.read_if_changed(0, d_gps_utc_model_version, d_ls_pvt->gps_utc_model)) new_navigation_data = true;
 
-    if (global_gps_iono_map.size() > 0)
-        {
             // IONO data is shared for all the GPS satellites. Read always at ID=0
-            global_gps_iono_map.read(0, d_ls_pvt->gps_iono);
-        }
-
-    // update SBAS data collections
-    if (global_sbas_iono_map.size() > 0)
-        {
-            // SBAS ionospheric correction is shared for all the GPS satellites. Read always at ID=0
-            global_sbas_iono_map.read(0, d_ls_pvt->sbas_iono);
-        }
-    d_ls_pvt->sbas_sat_corr_map = global_sbas_sat_corr_map.get_map_copy();
-    d_ls_pvt->sbas_ephemeris_map = global_sbas_ephemeris_map.get_map_copy();
+            if (global_gps_iono_map.read_if_changed(0, d_gps_iono_version, d_ls_pvt->gps_iono)) new_navigation_data = true;
 
-    // read SBAS raw messages directly from queue and write them into rinex file
-    Sbas_Raw_Msg sbas_raw_msg;
-    while (global_sbas_raw_msg_queue.try_pop(sbas_raw_msg))
-        {
-            // create the header of not yet done
-            if(!b_rinex_sbs_header_writen)
+            // the RINEX files are written by the output thread, which keeps its own copy
+            if (new_navigation_data)
                 {
-                    rp->rinex_sbs_header(rp->sbsFile);
-                    b_rinex_sbs_header_writen = true;
+                    d_output_sink->set_gps_navigation(d_ls_pvt->gps_ephemeris_map, d_ls_pvt->gps_iono, d_ls_pvt->gps_utc_model);
                 }
 
-            // Define the RX time of the SBAS message by using the GPS time.
-            // It has only an effect if there has not been yet a SBAS MT12 available
-            // when the message was received.
-            if(sbas_raw_msg.get_rx_time_obj().is_related() == false
-                    && gnss_pseudoranges_map.size() > 0
-                    && d_ls_pvt->gps_ephemeris_map.size() > 0)
+            // update SBAS data collections
+            // SBAS ionospheric correction is shared for all the GPS satellites. Read always at ID=0
+            global_sbas_iono_map.read_if_changed(0, d_sbas_iono_version, d_ls_pvt->sbas_iono);
+            global_sbas_sat_corr_map.get_map_copy_if_changed(d_sbas_sat_corr_version, d_ls_pvt->sbas_sat_corr_map);
+            global_sbas_ephemeris_map.get_map_copy_if_changed(d_sbas_ephemeris_version, d_ls_pvt->sbas_ephemeris_map);
+
+            // read SBAS raw messages directly from queue and send them to the rinex file
+            Sbas_Raw_Msg sbas_raw_msg;
+            while (global_sbas_raw_msg_queue.try_pop(sbas_raw_msg))
                 {
-                    // doesn't matter which channel/satellite we choose
-                    Gnss_Synchro gs = gnss_pseudoranges_map.begin()->second;
-                    Gps_Ephemeris eph = d_ls_pvt->gps_ephemeris_map.begin()->second;
+                    // Define the RX time of the SBAS message by using the GPS time.
+                    // It has only an effect if there has not been yet a SBAS MT12 available
+                    // when the message was received.
+                    if(sbas_raw_msg.get_rx_time_obj().is_related() == false
+                            && gnss_pseudoranges_map.size() > 0
+                            && d_ls_pvt->gps_ephemeris_map.size() > 0)
+                        {
+                            // doesn't matter which channel/satellite we choose
+                            Gnss_Synchro gs = gnss_pseudoranges_map.begin()->second;
+                            Gps_Ephemeris eph = d_ls_pvt->gps_ephemeris_map.begin()->second;
 
-                    double relative_rx_time = gs.Tracking_timestamp_secs;
-                    int gps_week = eph.i_GPS_week;
-                    double gps_sec = gs.d_TOW_at_current_symbol;
+                            double relative_rx_time = gs.Tracking_timestamp_secs;
+                            int gps_week = eph.i_GPS_week;
+                            double gps_sec = gs.d_TOW_at_current_symbol;
 
-                    Sbas_Time_Relation time_rel(relative_rx_time, gps_week, gps_sec);
-                    sbas_raw_msg.relate(time_rel);
-                }
+                            Sbas_Time_Relation time_rel(relative_rx_time, gps_week, gps_sec);
+                            sbas_raw_msg.relate(time_rel);
+                        }
 
-            // send the message to the rinex logger if it has a valid GPS time stamp
-            if(sbas_raw_msg.get_rx_time_obj().is_related())
-                {
-                    rp->log_rinex_sbs(rp->sbsFile, sbas_raw_msg);
+                    // send the message to the rinex logger if it has a valid GPS time stamp
+                    if(sbas_raw_msg.get_rx_time_obj().is_related())
+                        {
+                            d_output_sink->push_sbas(sbas_raw_msg);
+                        }
                 }
-        }
 
-    // ############ 2 COMPUTE THE PVT ################################
-    if (gnss_pseudoranges_map.size() > 0 and d_ls_pvt->gps_ephemeris_map.size() >0)
-        {
-            // compute on the fly PVT solution
-            //mod 8/4/2012 Set the PVT computation rate in this block
-            if ((d_sample_counter % d_output_rate_ms) == 0)
+            // ############ 2 COMPUTE THE PVT ################################
+            if (gnss_pseudoranges_map.size() > 0 and d_ls_pvt->gps_ephemeris_map.size() >0)
                 {
-                    bool pvt_result;
-                    pvt_result = d_ls_pvt->get_PVT(gnss_pseudoranges_map, d_rx_time, d_flag_averaging);
-                    if (pvt_result == true)
+                    // compute on the fly PVT solution
+                    //mod 8/4/2012 Set the PVT computation rate in this block
+                    if ((d_sample_counter % d_output_rate_ms) == 0)
                         {
-                            d_kml_dump.print_position(d_ls_pvt, d_flag_averaging);
-                            d_nmea_printer->Print_Nmea_Line(d_ls_pvt, d_flag_averaging);
-
-                            if (!b_rinex_header_writen) //  & we have utc data in nav message!
+                            bool pvt_result;
+                            pvt_result = d_ls_pvt->get_PVT(gnss_pseudoranges_map, d_rx_time, d_flag_averaging);
+                            if (pvt_result == true)
                                 {
-                                    std::map<int,Gps_Ephemeris>::iterator gps_ephemeris_iter;
-                                    gps_ephemeris_iter = d_ls_pvt->gps_ephemeris_map.begin();
-                                    if (gps_ephemeris_iter != d_ls_pvt->gps_ephemeris_map.end())
-                                        {
-                                            rp->rinex_obs_header(rp->obsFile, gps_ephemeris_iter->second,d_rx_time);
-                                            rp->rinex_nav_header(rp->navFile, d_ls_pvt->gps_iono, d_ls_pvt->gps_utc_model);
-                                            b_rinex_header_writen = true; // do not write header anymore
-                                        }
-                                }
-                            if(b_rinex_header_writen) // Put here another condition to separate annotations (e.g 30 s)
-                                {
-                                    // Limit the RINEX navigation output rate to 1/6 seg
-                                    // Notice that d_sample_counter period is 1ms (for GPS correlators)
-                                    if ((d_sample_counter - d_last_sample_nav_output) >= 6000)
-                                        {
-                                            rp->log_rinex_nav(rp->navFile, d_ls_pvt->gps_ephemeris_map);
-                                            d_last_sample_nav_output = d_sample_counter;
-                                        }
-                                    std::map<int,Gps_Ephemeris>::iterator gps_ephemeris_iter;
-                                    gps_ephemeris_iter = d_ls_pvt->gps_ephemeris_map.begin();
-                                    if (gps_ephemeris_iter != d_ls_pvt->gps_ephemeris_map.end())
-                                        {
-                                            rp->log_rinex_obs(rp->obsFile, gps_ephemeris_iter->second, d_rx_time, gnss_pseudoranges_map);
-                                        }
+                                    // KML, NMEA and RINEX outputs, formatted and written by the output thread
+                                    Pvt_Output_Record record;
+                                    record.type = PVT_OUTPUT_GPS_FIX;
+                                    record.sample_counter = d_sample_counter; // Notice that d_sample_counter period is 1ms (for GPS correlators)
+                                    record.rx_time = d_rx_time;
+                                    record.set_solution(d_ls_pvt);
+                                    record.set_observables(gnss_pseudoranges_map);
+                                    d_output_sink->push(record);
                                 }
                         }
-                }
 
-            // DEBUG MESSAGE: Display position in console output
-            if (((d_sample_counter % d_display_rate_ms) == 0) and d_ls_pvt->b_valid_position == true)
-                {
-                    std::cout << "Position at " << boost::posix_time::to_simple_string(d_ls_pvt->d_position_UTC_time)
-                              << " is Lat = " << d_ls_pvt->d_latitude_d << " [deg], Long = " << d_ls_pvt->d_longitude_d
-                              << " [deg], Height= " << d_ls_pvt->d_height_m << " [m]" << std::endl;
+                    // DEBUG MESSAGE: Display position in console output
+                    if (((d_sample_counter % d_display_rate_ms) == 0) and d_ls_pvt->b_valid_position == true)
+                        {
+                            std::cout << "Position at " << boost::posix_time::to_simple_string(d_ls_pvt->d_position_UTC_time)
+                                      << " is Lat = " << d_ls_pvt->d_latitude_d << " [deg], Long = " << d_ls_pvt->d_longitude_d
+                                      << " [deg], Height= " << d_ls_pvt->d_height_m << " [m]" << std::endl;
 
-                    LOG(INFO) << "Position at " << boost::posix_time::to_simple_string(d_ls_pvt->d_position_UTC_time)
-                              << " is Lat = " << d_ls_pvt->d_latitude_d << " [deg], Long = " << d_ls_pvt->d_longitude_d
-                              << " [deg], Height= " << d_ls_pvt->d_height_m << " [m]";
+                            LOG(INFO) << "Position at " << boost::posix_time::to_simple_string(d_ls_pvt->d_position_UTC_time)
+                                      << " is Lat = " << d_ls_pvt->d_latitude_d << " [deg], Long = " << d_ls_pvt->d_longitude_d
+                                      << " [deg], Height= " << d_ls_pvt->d_height_m << " [m]";
 
-                    LOG(INFO) << "Dilution of Precision at " << boost::posix_time::to_simple_string(d_ls_pvt->d_position_UTC_time)
-                              << " is HDOP = " << d_ls_pvt->d_HDOP << " VDOP = "
-                              << d_ls_pvt->d_VDOP <<" TDOP = " << d_ls_pvt->d_TDOP << " GDOP = " << d_ls_pvt->d_GDOP;
-                }
-            // MULTIPLEXED FILE RECORDING - Record results to file
-            if(d_dump == true)
-                {
-                    try
-                    {
-                            double tmp_double;
-                            for (unsigned int i = 0; i < d_nchannels ; i++)
-                                {
-                                    tmp_double = in[i][0].Pseudorange_m;
-                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                                    tmp_double = 0;
-                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                                    d_dump_file.write((char*)&d_rx_time, sizeof(double));
-                                }
-                    }
-                    catch (std::ifstream::failure e)
-                    {
-                            LOG(WARNING) << "Exception writing observables dump file " << e.what();
-                    }
+                            LOG(INFO) << "Dilution of Precision at " << boost::posix_time::to_simple_string(d_ls_pvt->d_position_UTC_time)
+                                      << " is HDOP = " << d_ls_pvt->d_HDOP << " VDOP = "
+                                      << d_ls_pvt->d_VDOP <<" TDOP = " << d_ls_pvt->d_TDOP << " GDOP = " << d_ls_pvt->d_GDOP;
+                        }
+                    // MULTIPLEXED FILE RECORDING - Record results to file
+                    if(d_dump == true)
+                        {
+                            try
+                            {
+                                    double tmp_double;
+                                    for (unsigned int i = 0; i < d_nchannels ; i++)
+                                        {
+                                            tmp_double = in[i][epoch].Pseudorange_m;
+                                            d_dump_file.write((char*)&tmp_double, sizeof(double));
+                                            tmp_double = 0;
+                                            d_dump_file.write((char*)&tmp_double, sizeof(double));
+                                            d_dump_file.write((char*)&d_rx_time, sizeof(double));
+                                        }
+                            }
+                            catch (std::ifstream::failure e)
+                            {
+                                    LOG(WARNING) << "Exception writing observables dump file " << e.what();
+                            }
+                        }
                 }
         }
 
-    consume_each(1); //one by one
+    consume_each(n_epochs);
     return 0;
 }
 
@@ -42,9 +42,7 @@
 #include "gps_ephemeris.h"
 #include "gps_utc_model.h"
 #include "gps_iono.h"
-#include "nmea_printer.h"
-#include "kml_printer.h"
-#include "rinex_printer.h"
+#include "pvt_output_sink.h"
 #include "gps_l1_ca_ls_pvt.h"
 #include "GPS_L1_CA.h"
 
@@ -62,7 +60,13 @@ gps_l1_ca_pvt_cc_sptr gps_l1_ca_make_pvt_cc(unsigned int n_channels,
                                             int display_rate_ms,
                                             bool flag_nmea_tty_port,
                                             std::string nmea_dump_filename,
-                                            std::string nmea_dump_devname);
+                                            std::string nmea_dump_devname,
+                                            bool flag_rtcm_server,
+                                            bool flag_rtcm_tty_port,
+                                            unsigned short rtcm_tcp_port,
+                                            unsigned short rtcm_station_id,
+                                            std::string rtcm_dump_filename,
+                                            std::string rtcm_dump_devname);
 
 /*!
  * \brief This class implements a block that computes the PVT solution
@@ -80,7 +84,13 @@ private:
                                                        int display_rate_ms,
                                                        bool flag_nmea_tty_port,
                                                        std::string nmea_dump_filename,
-                                                       std::string nmea_dump_devname);
+                                                       std::string nmea_dump_devname,
+                                                       bool flag_rtcm_server,
+                                                       bool flag_rtcm_tty_port,
+                                                       unsigned short rtcm_tcp_port,
+                                                       unsigned short rtcm_station_id,
+                                                       std::string rtcm_dump_filename,
+                                                       std::string rtcm_dump_devname);
     gps_l1_ca_pvt_cc(unsigned int nchannels,
                      boost::shared_ptr<gr::msg_queue> queue,
                      bool dump,
@@ -91,12 +101,15 @@ private:
                      int display_rate_ms,
                      bool flag_nmea_tty_port,
                      std::string nmea_dump_filename,
-                     std::string nmea_dump_devname);
+                     std::string nmea_dump_devname,
+                     bool flag_rtcm_server,
+                     bool flag_rtcm_tty_port,
+                     unsigned short rtcm_tcp_port,
+                     unsigned short rtcm_station_id,
+                     std::string rtcm_dump_filename,
+                     std::string rtcm_dump_devname);
     boost::shared_ptr<gr::msg_queue> d_queue;
     bool d_dump;
-    bool b_rinex_header_writen;
-    bool b_rinex_sbs_header_writen;
-    Rinex_Printer *rp;
     unsigned int d_nchannels;
     std::string d_dump_filename;
     std::ofstream d_dump_file;
@@ -104,16 +117,27 @@ private:
     bool d_flag_averaging;
     int d_output_rate_ms;
     int d_display_rate_ms;
+    int d_epoch_period_ms; // time between the epochs delivered by the observables block
     long unsigned int d_sample_counter;
-    long unsigned int d_last_sample_nav_output;
-    Kml_Printer d_kml_dump;
-    Nmea_Printer *d_nmea_printer;
+    Pvt_Output_Sink *d_output_sink; // KML, NMEA and RINEX outputs, written by their own thread
     double d_rx_time;
     gps_l1_ca_ls_pvt *d_ls_pvt;
+    // versions of the global maps last copied into d_ls_pvt
+    unsigned int d_gps_ephemeris_version;
+    unsigned int d_gps_utc_model_version;
+    unsigned int d_gps_iono_version;
+    unsigned int d_sbas_iono_version;
+    unsigned int d_sbas_sat_corr_version;
+    unsigned int d_sbas_ephemeris_version;
 
 public:
     ~gps_l1_ca_pvt_cc (); //!< Default destructor
 
+    /*!
+     * \brief Sets the time between the epochs delivered by the observables block [ms], 1 by default
+     */
+    void set_epoch_period_ms(int epoch_period_ms) {d_epoch_period_ms = epoch_period_ms;};
+
     int general_work (int noutput_items, gr_vector_int &ninput_items,
             gr_vector_const_void_star &input_items, gr_vector_void_star &output_items); //!< PVT Signal Processing
 };
@@ -0,0 +1,219 @@
+/*!
+ * \file hybrid_pvt_cc.cc
+ * \brief Implementation of a Position Velocity and Time computation block that
+ * uses the GPS L1 C/A and Galileo E1 satellites in a single solution
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "hybrid_pvt_cc.h"
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/io_signature.h>
+#include <glog/logging.h>
+#include "gnss_synchro.h"
+#include "concurrent_map.h"
+
+using google::LogMessage;
+
+extern concurrent_map<Gps_Ephemeris> global_gps_ephemeris_map;
+extern concurrent_map<Gps_Iono> global_gps_iono_map;
+extern concurrent_map<Gps_Utc_Model> global_gps_utc_model_map;
+
+extern concurrent_map<Galileo_Ephemeris> global_galileo_ephemeris_map;
+extern concurrent_map<Galileo_Iono> global_galileo_iono_map;
+extern concurrent_map<Galileo_Utc_Model> global_galileo_utc_model_map;
+
+hybrid_pvt_cc_sptr
+hybrid_make_pvt_cc(unsigned int nchannels, boost::shared_ptr<gr::msg_queue> queue, bool dump, std::string dump_filename, int averaging_depth, bool flag_averaging, int output_rate_ms, int display_rate_ms, bool flag_nmea_tty_port, std::string nmea_dump_filename, std::string nmea_dump_devname)
+{
+    return hybrid_pvt_cc_sptr(new hybrid_pvt_cc(nchannels, queue, dump, dump_filename, averaging_depth, flag_averaging, output_rate_ms, display_rate_ms, flag_nmea_tty_port, nmea_dump_filename, nmea_dump_devname));
+}
+
+
+hybrid_pvt_cc::hybrid_pvt_cc(unsigned int nchannels, boost::shared_ptr<gr::msg_queue> queue, bool dump, std::string dump_filename, int averaging_depth, bool flag_averaging, int output_rate_ms, int display_rate_ms, bool flag_nmea_tty_port, std::string nmea_dump_filename, std::string nmea_dump_devname) :
+        gr::block("hybrid_pvt_cc", gr::io_signature::make(nchannels, nchannels,  sizeof(Gnss_Synchro)),
+                gr::io_signature::make(1, 1, sizeof(gr_complex)))
+{
+    d_output_rate_ms = output_rate_ms;
+    d_display_rate_ms = display_rate_ms;
+    d_epoch_period_ms = 1;
+    d_queue = queue;
+    d_dump = dump;
+    d_nchannels = nchannels;
+    d_dump_filename = dump_filename;
+    std::string dump_ls_pvt_filename = dump_filename;
+
+    //initialize the kml printer and its thread
+    std::string kml_dump_filename;
+    kml_dump_filename = d_dump_filename;
+    kml_dump_filename.append(".kml");
+    d_output_sink = new Pvt_Output_Sink(kml_dump_filename, nmea_dump_filename, flag_nmea_tty_port, nmea_dump_devname);
+
+    // the solutions, with the inter-system bias, are dumped by hybrid_ls_pvt
+    dump_ls_pvt_filename.append("_ls_pvt.dat");
+    d_averaging_depth = averaging_depth;
+    d_flag_averaging = flag_averaging;
+
+    d_ls_pvt = new hybrid_ls_pvt(nchannels, dump_ls_pvt_filename, d_dump);
+    d_ls_pvt->set_averaging_depth(d_averaging_depth);
+
+    d_sample_counter = 0;
+    d_gps_ephemeris_version = 0;
+    d_gps_utc_model_version = 0;
+    d_gps_iono_version = 0;
+    d_galileo_ephemeris_version = 0;
+    d_galileo_utc_model_version = 0;
+    d_galileo_iono_version = 0;
+    d_rx_time = 0.0;
+}
+
+
+
+hybrid_pvt_cc::~hybrid_pvt_cc()
+{
+    delete d_output_sink;
+    delete d_ls_pvt;
+}
+
+
+
+int hybrid_pvt_cc::general_work (int noutput_items, gr_vector_int &ninput_items,
+        gr_vector_const_void_star &input_items, gr_vector_void_star &output_items)
+{
+    Gnss_Synchro **in = (Gnss_Synchro **)  &input_items[0]; //Get the input pointer
+
+    // process all the epochs available in every channel
+    int n_epochs = ninput_items[0];
+    for (unsigned int i = 1; i < d_nchannels; i++)
+        {
+            if (ninput_items[i] < n_epochs) n_epochs = ninput_items[i];
+        }
+
+    for (int epoch = 0; epoch < n_epochs; epoch++)
+        {
+            // the observables block delivers one epoch every d_epoch_period_ms
+            d_sample_counter += d_epoch_period_ms;
+
+            // nothing to do in the epochs without PVT fix or display
+            if ((d_sample_counter % d_output_rate_ms) != 0 and (d_sample_counter % d_display_rate_ms) != 0) continue;
+
+            // keyed by channel: a GPS and a Galileo satellite can have the same PRN
+            std::map<int,Gnss_Synchro> gnss_pseudoranges_map;
+
+            // the receiver clock refers to GPS time: take the RX time of the first valid
+            // GPS channel, or of the first valid Galileo channel in a Galileo-only epoch
+            int rx_time_channel = -1;
+            for (unsigned int i = 0; i < d_nchannels; i++)
+                {
+                    if (in[i][epoch].Flag_valid_pseudorange == true
+                            and (rx_time_channel < 0 or (in[i][epoch].System == 'G' and in[rx_time_channel][epoch].System != 'G')))
+                        {
+                            rx_time_channel = i;
+                        }
+                }
+            if (rx_time_channel >= 0)
+                {
+                    d_rx_time = in[rx_time_channel][epoch].d_TOW_at_current_symbol;
+                }
+
+            for (unsigned int i = 0; i < d_nchannels; i++)
+                {
+                    if (in[i][epoch].Flag_valid_pseudorange == true)
+                        {
+                            // the pseudoranges of a fix must share the RX timestamp (common RX time pseudoranges)
+                            if (std::fabs(in[i][epoch].d_TOW_at_current_symbol - d_rx_time) > HYBRID_PVT_MAX_RX_TIME_MISMATCH_S)
+                                {
+                                    DLOG(INFO) << "Channel " << i << " dropped from the fix: RX time " << in[i][epoch].d_TOW_at_current_symbol
+                                               << " [s] instead of " << d_rx_time << " [s]";
+                                    continue;
+                                }
+                            gnss_pseudoranges_map.insert(std::pair<int,Gnss_Synchro>(i, in[i][epoch])); // store valid pseudoranges in a map
+                        }
+                }
+
+            // ############ 1. READ EPHEMERIS/UTC_MODE/IONO FROM GLOBAL MAPS ####
+
+            // the maps of both systems are copied only when the data collectors have written new data
+            global_gps_ephemeris_map.get_map_copy_if_changed(d_gps_ephemeris_version, d_ls_pvt->gps_ephemeris_map);
+            global_galileo_ephemeris_map.get_map_copy_if_changed(d_galileo_ephemeris_version, d_ls_pvt->galileo_ephemeris_map);
+
+            // UTC MODEL and IONO data are shared for all the satellites of a system. Read always at ID=0
+            global_gps_utc_model_map.read_if_changed(0, d_gps_utc_model_version, d_ls_pvt->gps_utc_model);
+            global_gps_iono_map.read_if_changed(0, d_gps_iono_version, d_ls_pvt->gps_iono);
+            global_galileo_utc_model_map.read_if_changed(0, d_galileo_utc_model_version, d_ls_pvt->galileo_utc_model);
+            global_galileo_iono_map.read_if_changed(0, d_galileo_iono_version, d_ls_pvt->galileo_iono);
+
+            // ############ 2 COMPUTE THE PVT ################################
+            if (gnss_pseudoranges_map.size() > 0
+                    and (d_ls_pvt->gps_ephemeris_map.size() > 0 or d_ls_pvt->galileo_ephemeris_map.size() > 0))
+                {
+                    // compute on the fly PVT solution
+                    if ((d_sample_counter % d_output_rate_ms) == 0)
+                        {
+                            bool pvt_result;
+                            pvt_result = d_ls_pvt->get_PVT(gnss_pseudoranges_map, d_rx_time, d_flag_averaging);
+
+                            if (pvt_result == true)
+                                {
+                                    // KML output, formatted and written by the output thread
+                                    Pvt_Output_Record record;
+                                    record.type = PVT_OUTPUT_HYBRID_FIX;
+                                    record.sample_counter = d_sample_counter;
+                                    record.rx_time = d_rx_time;
+                                    record.set_solution(d_ls_pvt);
+                                    record.set_observables(gnss_pseudoranges_map);
+                                    d_output_sink->push(record);
+                                }
+                        }
+
+                    // DEBUG MESSAGE: Display position in console output
+                    if (((d_sample_counter % d_display_rate_ms) == 0) and d_ls_pvt->b_valid_position == true)
+                        {
+                            std::cout << "Position at " << boost::posix_time::to_simple_string(d_ls_pvt->d_position_UTC_time)
+                                      << " is Lat = " << d_ls_pvt->d_latitude_d << " [deg], Long = " << d_ls_pvt->d_longitude_d
+                                      << " [deg], Height= " << d_ls_pvt->d_height_m << " [m]" << std::endl;
+
+                            LOG(INFO) << "Position at " << boost::posix_time::to_simple_string(d_ls_pvt->d_position_UTC_time)
+                                      << " is Lat = " << d_ls_pvt->d_latitude_d << " [deg], Long = " << d_ls_pvt->d_longitude_d
+                                      << " [deg], Height= " << d_ls_pvt->d_height_m << " [m] with "
+                                      << d_ls_pvt->d_valid_gps_observations << " GPS and "
+                                      << d_ls_pvt->d_valid_galileo_observations << " Galileo satellites, ISB = "
+                                      << d_ls_pvt->d_isb_m << " [m]";
+
+                            LOG(INFO) << "Dilution of Precision at " << boost::posix_time::to_simple_string(d_ls_pvt->d_position_UTC_time)
+                                      << " is HDOP = " << d_ls_pvt->d_HDOP << " VDOP = "
+                                      << d_ls_pvt->d_VDOP <<" TDOP = " << d_ls_pvt->d_TDOP
+                                      << " GDOP = " << d_ls_pvt->d_GDOP;
+                        }
+                }
+        }
+
+    consume_each(n_epochs);
+    return 0;
+}
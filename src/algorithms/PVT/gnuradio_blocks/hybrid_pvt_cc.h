@@ -0,0 +1,144 @@
+/*!
+ * \file hybrid_pvt_cc.h
+ * \brief Interface of a Position Velocity and Time computation block that
+ * uses the GPS L1 C/A and Galileo E1 satellites in a single solution
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_HYBRID_PVT_CC_H
+#define	GNSS_SDR_HYBRID_PVT_CC_H
+
+#include <fstream>
+#include <queue>
+#include <utility>
+#include <string>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <gnuradio/block.h>
+#include <gnuradio/msg_queue.h>
+#include "gps_ephemeris.h"
+#include "gps_utc_model.h"
+#include "gps_iono.h"
+#include "galileo_ephemeris.h"
+#include "galileo_utc_model.h"
+#include "galileo_iono.h"
+#include "pvt_output_sink.h"
+#include "hybrid_ls_pvt.h"
+#include "GPS_L1_CA.h"
+#include "Galileo_E1.h"
+
+#define HYBRID_PVT_MAX_RX_TIME_MISMATCH_S 1e-6 //!< Observables with a RX time further from the one of the fix are not used [s]
+
+class hybrid_pvt_cc;
+
+typedef boost::shared_ptr<hybrid_pvt_cc> hybrid_pvt_cc_sptr;
+
+hybrid_pvt_cc_sptr hybrid_make_pvt_cc(unsigned int n_channels,
+                                      boost::shared_ptr<gr::msg_queue> queue,
+                                      bool dump,
+                                      std::string dump_filename,
+                                      int averaging_depth,
+                                      bool flag_averaging,
+                                      int output_rate_ms,
+                                      int display_rate_ms,
+                                      bool flag_nmea_tty_port,
+                                      std::string nmea_dump_filename,
+                                      std::string nmea_dump_devname);
+
+/*!
+ * \brief This class implements a block that computes the PVT solution with
+ * the GPS L1 C/A and Galileo E1 observables of all the channels.
+ *
+ * The navigation data of both systems is copied from the global maps only
+ * when it changes, and each epoch is solved once, with an inter-system bias
+ * between the GPS and Galileo pseudoranges. The fixes are only written to the
+ * KML file: the NMEA and RINEX printers handle GPS fixes only.
+ *
+ * The block needs observables of both systems at common epochs. The receiver
+ * flowgraph can not deliver them yet: all the channels use the same tracking
+ * and telemetry decoder implementations, and the observables blocks handle
+ * the epochs of a single system (1 ms for GPS L1 C/A, 4 ms for Galileo E1).
+ * The RX time of a fix is taken from a GPS channel when there is one, and the
+ * observables with a different RX time are left out of the fix.
+ */
+class hybrid_pvt_cc : public gr::block
+{
+private:
+    friend hybrid_pvt_cc_sptr hybrid_make_pvt_cc(unsigned int nchannels,
+                                                 boost::shared_ptr<gr::msg_queue> queue,
+                                                 bool dump,
+                                                 std::string dump_filename,
+                                                 int averaging_depth,
+                                                 bool flag_averaging,
+                                                 int output_rate_ms,
+                                                 int display_rate_ms,
+                                                 bool flag_nmea_tty_port,
+                                                 std::string nmea_dump_filename,
+                                                 std::string nmea_dump_devname);
+    hybrid_pvt_cc(unsigned int nchannels,
+                  boost::shared_ptr<gr::msg_queue> queue,
+                  bool dump, std::string dump_filename,
+                  int averaging_depth,
+                  bool flag_averaging,
+                  int output_rate_ms,
+                  int display_rate_ms,
+                  bool flag_nmea_tty_port,
+                  std::string nmea_dump_filename,
+                  std::string nmea_dump_devname);
+boost::shared_ptr<gr::msg_queue> d_queue;
+    bool d_dump;
+    unsigned int d_nchannels;
+    std::string d_dump_filename;
+    int d_averaging_depth;
+    bool d_flag_averaging;
+    int d_output_rate_ms;
+    int d_display_rate_ms;
+    int d_epoch_period_ms; // time between the epochs delivered by the observables block
+    long unsigned int d_sample_counter;
+    Pvt_Output_Sink *d_output_sink; // KML, NMEA and RINEX outputs, written by their own thread
+    double d_rx_time;
+    hybrid_ls_pvt *d_ls_pvt;
+    // versions of the global maps last copied into d_ls_pvt
+    unsigned int d_gps_ephemeris_version;
+    unsigned int d_gps_utc_model_version;
+    unsigned int d_gps_iono_version;
+    unsigned int d_galileo_ephemeris_version;
+    unsigned int d_galileo_utc_model_version;
+    unsigned int d_galileo_iono_version;
+
+public:
+    ~hybrid_pvt_cc (); //!< Default destructor
+
+    /*!
+     * \brief Sets the time between the epochs delivered by the observables block [ms], 1 by default
+     */
+    void set_epoch_period_ms(int epoch_period_ms) {d_epoch_period_ms = epoch_period_ms;};
+
+    int general_work (int noutput_items, gr_vector_int &ninput_items,
+            gr_vector_const_void_star &input_items, gr_vector_void_star &output_items); //!< PVT Signal Processing
+};
+
+#endif
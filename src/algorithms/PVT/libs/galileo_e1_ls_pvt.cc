@@ -36,7 +36,7 @@
 
 using google::LogMessage;
 
-galileo_e1_ls_pvt::galileo_e1_ls_pvt(int nchannels, std::string dump_filename, bool flag_dump_to_file)
+galileo_e1_ls_pvt::galileo_e1_ls_pvt(int nchannels, std::string dump_filename, bool flag_dump_to_file) : d_ls_solver(GALILEO_C_m_s)
 {
     // init empty ephemeris for all the available GNSS channels
     d_nchannels = nchannels;
@@ -79,156 +79,16 @@ galileo_e1_ls_pvt::~galileo_e1_ls_pvt()
 }
 
 
-arma::vec galileo_e1_ls_pvt::rotateSatellite(double traveltime, arma::vec X_sat)
+bool galileo_e1_ls_pvt::get_PVT(const std::map<int,Gnss_Synchro> &gnss_pseudoranges_map, double galileo_current_time, bool flag_averaging)
 {
-    /*
-     *  Returns rotated satellite ECEF coordinates due to Earth
-     * rotation during signal travel time
-     *
-     *   Inputs:
-     *       travelTime  - signal travel time
-     *       X_sat       - satellite's ECEF coordinates
-     *
-     *   Returns:
-     *       X_sat_rot   - rotated satellite's coordinates (ECEF)
-     */
-
-    //--- Find rotation angle --------------------------------------------------
-    double omegatau;
-    omegatau = OMEGA_EARTH_DOT * traveltime;
-
-    //--- Build a rotation matrix ----------------------------------------------
-    arma::mat R3 = arma::zeros(3,3);
-    R3(0, 0) = cos(omegatau);
-    R3(0, 1) = sin(omegatau);
-    R3(0, 2) = 0.0;
-    R3(1, 0) = -sin(omegatau);
-    R3(1, 1) = cos(omegatau);
-    R3(1, 2) = 0.0;
-    R3(2, 0) = 0.0;
-    R3(2, 1) = 0.0;
-    R3(2, 2) = 1;
-
-    //--- Do the rotation ------------------------------------------------------
-    arma::vec X_sat_rot;
-    X_sat_rot = R3 * X_sat;
-    return X_sat_rot;
-}
-
-
-arma::vec galileo_e1_ls_pvt::leastSquarePos(arma::mat satpos, arma::vec obs, arma::mat w)
-{
-    /* Computes the Least Squares Solution.
-     *   Inputs:
-     *       satpos      - Satellites positions in ECEF system: [X; Y; Z;]
-     *       obs         - Observations - the pseudorange measurements to each satellite
-     *       w           - weigths vector
-     *
-     *   Returns:
-     *       pos         - receiver position and receiver clock error
-     *                   (in ECEF system: [X, Y, Z, dt])
-     */
-
-    //=== Initialization =======================================================
-    int nmbOfIterations = 10; // TODO: include in config
-    int nmbOfSatellites;
-    nmbOfSatellites = satpos.n_cols;	//Armadillo
-    arma::vec pos = "0.0 0.0 0.0 0.0";
-    arma::mat A;
-    arma::mat omc;
-    arma::mat az;
-    arma::mat el;
-    A = arma::zeros(nmbOfSatellites, 4);
-    omc = arma::zeros(nmbOfSatellites, 1);
-    az = arma::zeros(1, nmbOfSatellites);
-    el = arma::zeros(1, nmbOfSatellites);
-    arma::mat X = satpos;
-    arma::vec Rot_X;
-    double rho2;
-    double traveltime;
-    double trop;
-    arma::mat mat_tmp;
-    arma::vec x;
-
-    //=== Iteratively find receiver position ===================================
-    for (int iter = 0; iter < nmbOfIterations; iter++)
-        {
-            for (int i = 0; i < nmbOfSatellites; i++)
-                {
-                    if (iter == 0)
-                        {
-                            //--- Initialize variables at the first iteration --------------
-                            Rot_X = X.col(i); //Armadillo
-                            trop = 0.0;
-                        }
-                    else
-                        {
-                            //--- Update equations -----------------------------------------
-                            rho2 = (X(0, i) - pos(0)) *
-                                   (X(0, i) - pos(0)) + (X(1, i) - pos(1)) *
-                                   (X(1, i) - pos(1)) + (X(2, i) - pos(2)) *
-                                   (X(2, i) - pos(2));
-                            traveltime = sqrt(rho2) / GALILEO_C_m_s;
-
-                            //--- Correct satellite position (do to earth rotation) --------
-                            Rot_X = rotateSatellite(traveltime, X.col(i)); //armadillo
-
-                            //--- Find DOA and range of satellites
-                            topocent(&d_visible_satellites_Az[i],
-                                     &d_visible_satellites_El[i],
-                                     &d_visible_satellites_Distance[i],
-                                     pos.subvec(0,2),
-                                     Rot_X - pos.subvec(0, 2));
-                        }
-                    //--- Apply the corrections ----------------------------------------
-                    omc(i) = (obs(i) - norm(Rot_X - pos.subvec(0, 2), 2) - pos(3) - trop); // Armadillo
-
-                    //--- Construct the A matrix ---------------------------------------
-                    //Armadillo
-                    A(i,0) = (-(Rot_X(0) - pos(0))) / obs(i);
-                    A(i,1) = (-(Rot_X(1) - pos(1))) / obs(i);
-                    A(i,2) = (-(Rot_X(2) - pos(2))) / obs(i);
-                    A(i,3) = 1.0;
-                }
-                
-            //--- Find position update ---------------------------------------------
-            x = arma::solve(w*A, w*omc); // Armadillo
-
-            //--- Apply position update --------------------------------------------
-            pos = pos + x;
-            if (arma::norm(x,2) < 1e-4)
-            {
-            	break; // exit the loop because we assume that the LS algorithm has converged (err < 0.1 cm)
-            }
-        }
-
-    try
-    {
-            //-- compute the Dilution Of Precision values
-            d_Q = arma::inv(arma::htrans(A)*A);
-    }
-    catch(std::exception& e)
-    {
-            d_Q = arma::zeros(4,4);
-    }
-    return pos;
-}
-
-
-bool galileo_e1_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map, double galileo_current_time, bool flag_averaging)
-{
-    std::map<int,Gnss_Synchro>::iterator gnss_pseudoranges_iter;
+    std::map<int,Gnss_Synchro>::const_iterator gnss_pseudoranges_iter;
     std::map<int,Galileo_Ephemeris>::iterator galileo_ephemeris_iter;
-    int valid_pseudoranges = gnss_pseudoranges_map.size();
-
-    arma::mat W = arma::eye(valid_pseudoranges, valid_pseudoranges); //channels weights matrix
-    arma::vec obs = arma::zeros(valid_pseudoranges);                 // pseudoranges observation vector
-    arma::mat satpos = arma::zeros(3, valid_pseudoranges);           //satellite positions matrix
+    double W[PVT_MAX_CHANNELS];         // channels weights (diagonal of the weights matrix)
+    double obs[PVT_MAX_CHANNELS];       // pseudoranges observation vector
+    double satpos[PVT_MAX_CHANNELS][3]; // satellite positions matrix
 
     int Galileo_week_number = 0;
     double utc = 0;
-    double SV_clock_drift_s = 0;
-    double SV_relativistic_clock_corr_s = 0;
     double TX_time_corrected_s;
     double SV_clock_bias_s = 0;
 
@@ -238,19 +98,18 @@ bool galileo_e1_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map
     // ****** PREPARE THE LEAST SQUARES DATA (SV POSITIONS MATRIX AND OBS VECTORS) ****
     // ********************************************************************************
     int valid_obs = 0; //valid observations counter
-    int obs_counter = 0;
     for(gnss_pseudoranges_iter = gnss_pseudoranges_map.begin();
             gnss_pseudoranges_iter != gnss_pseudoranges_map.end();
             gnss_pseudoranges_iter++)
         {
             // 1- find the ephemeris for the current SV observation. The SV PRN ID is the map key
             galileo_ephemeris_iter = galileo_ephemeris_map.find(gnss_pseudoranges_iter->first);
-            if (galileo_ephemeris_iter != galileo_ephemeris_map.end())
+            if (galileo_ephemeris_iter != galileo_ephemeris_map.end() and valid_obs < PVT_MAX_CHANNELS)
                 {
                     /*!
                      * \todo Place here the satellite CN0 (power level, or weight factor)
                      */
-                    W(obs_counter, obs_counter) = 1;
+                    W[valid_obs] = 1;
 
                     // COMMON RX TIME PVT ALGORITHM MODIFICATION (Like RINEX files)
                     // first estimate of transmit time
@@ -267,23 +126,16 @@ bool galileo_e1_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map
 
                     double Tx_time = Rx_time - gnss_pseudoranges_iter->second.Pseudorange_m/GALILEO_C_m_s;
 
-                    // 2- compute the clock drift using the clock model (broadcast) for this SV
-                    SV_clock_drift_s = galileo_ephemeris_iter->second.sv_clock_drift(Tx_time);
+                    // 2- compute the clock drift and the relativistic clock drift using the clock model (broadcast) for this SV,
+                    // interpolated by the satellite position cache
+                    SV_clock_bias_s = d_position_cache.clock_correction(gnss_pseudoranges_iter->first, galileo_ephemeris_iter->second, Tx_time);
 
-                    // 3- compute the relativistic clock drift using the clock model (broadcast) for this SV
-                    SV_relativistic_clock_corr_s = galileo_ephemeris_iter->second.sv_clock_relativistic_term(Tx_time);
-
-                    // 4- compute the current ECEF position for this SV using corrected TX time
-                    SV_clock_bias_s = SV_clock_drift_s + SV_relativistic_clock_corr_s;
+                    // 3- compute the current ECEF position for this SV using corrected TX time
                     TX_time_corrected_s = Tx_time - SV_clock_bias_s;
-                    galileo_ephemeris_iter->second.satellitePosition(TX_time_corrected_s);
-
-                    satpos(0,obs_counter) = galileo_ephemeris_iter->second.d_satpos_X;
-                    satpos(1,obs_counter) = galileo_ephemeris_iter->second.d_satpos_Y;
-                    satpos(2,obs_counter) = galileo_ephemeris_iter->second.d_satpos_Z;
+                    d_position_cache.position(gnss_pseudoranges_iter->first, galileo_ephemeris_iter->second, TX_time_corrected_s, satpos[valid_obs], NULL);
 
-                    // 5- fill the observations vector with the corrected pseudoranges
-                    obs(obs_counter) = gnss_pseudoranges_iter->second.Pseudorange_m + SV_clock_bias_s*GALILEO_C_m_s;
+                    // 4- fill the observations vector with the corrected pseudoranges
+                    obs[valid_obs] = gnss_pseudoranges_iter->second.Pseudorange_m + SV_clock_bias_s*GALILEO_C_m_s;
                     d_visible_satellites_IDs[valid_obs] = galileo_ephemeris_iter->second.i_satellite_PRN;
                     d_visible_satellites_CN0_dB[valid_obs] = gnss_pseudoranges_iter->second.CN0_dB_hz;
                     valid_obs++;
@@ -303,19 +155,16 @@ bool galileo_e1_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map
 
                     // SV ECEF DEBUG OUTPUT
                     LOG(INFO) << "ECEF satellite SV ID=" << galileo_ephemeris_iter->second.i_satellite_PRN
-                               << " X=" << galileo_ephemeris_iter->second.d_satpos_X
-                               << " [m] Y=" << galileo_ephemeris_iter->second.d_satpos_Y
-                               << " [m] Z=" << galileo_ephemeris_iter->second.d_satpos_Z
-                               << " [m] PR_obs=" << obs(obs_counter) << " [m]";
+                               << " X=" << satpos[valid_obs - 1][0]
+                               << " [m] Y=" << satpos[valid_obs - 1][1]
+                               << " [m] Z=" << satpos[valid_obs - 1][2]
+                               << " [m] PR_obs=" << obs[valid_obs - 1] << " [m]";
                 }
             else // the ephemeris are not available for this SV
                 {
                     // no valid pseudorange for the current SV
-                    W(obs_counter, obs_counter) = 0; // SV de-activated
-                    obs(obs_counter) = 1; // to avoid algorithm problems (divide by zero)
                     DLOG(INFO) << "No ephemeris data for SV "<< gnss_pseudoranges_iter->first;
                 }
-            obs_counter++;
         }
     // ********************************************************************************
     // ****** SOLVE LEAST SQUARES******************************************************
@@ -325,11 +174,13 @@ bool galileo_e1_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map
 
     if (valid_obs >= 4)
         {
-            arma::vec mypos;
-            DLOG(INFO) << "satpos=" << satpos;
-            DLOG(INFO) << "obs="<< obs;
-            DLOG(INFO) << "W=" << W;
-            mypos = leastSquarePos(satpos, obs, W);
+            if (d_ls_solver.solve(valid_obs, satpos, obs, W, d_visible_satellites_Az,
+                    d_visible_satellites_El, d_visible_satellites_Distance) == false)
+                {
+                    b_valid_position = false;
+                    return false;
+                }
+            const double *mypos = d_ls_solver.d_pos;
 
             // Compute GST and Gregorian time
             double GST = galileo_ephemeris_iter->second.Galileo_System_Time(Galileo_week_number, galileo_current_time);
@@ -339,13 +190,14 @@ bool galileo_e1_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map
             // 22 August 1999 00:00 last Galileo start GST epoch (ICD sec 5.1.2)
             boost::posix_time::ptime p_time(boost::gregorian::date(1999, 8, 22), t);
             d_position_UTC_time = p_time;
-            LOG(INFO) << "Galileo Position at TOW=" << galileo_current_time << " in ECEF (X,Y,Z) = " << mypos;
+            LOG(INFO) << "Galileo Position at TOW=" << galileo_current_time << " in ECEF (X,Y,Z) = " << mypos[0] << ", " << mypos[1] << ", " << mypos[2];
 
-            cart2geo((double)mypos(0), (double)mypos(1), (double)mypos(2), 4);
+            cart2geo(mypos[0], mypos[1], mypos[2], 4);
             //ToDo: Find an Observables/PVT random bug with some satellite configurations that gives an erratic PVT solution (i.e. height>50 km)
             if (d_height_m > 50000)
                 {
                     b_valid_position = false;
+                    d_ls_solver.reset(); // do not start the next fix from this one
                     return false;
                 }
             LOG(INFO) << "Galileo Position at " << boost::posix_time::to_simple_string(p_time)
@@ -357,42 +209,7 @@ bool galileo_e1_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map
                       << " [deg], Height= " << d_height_m << " [m]" << std::endl;
 
             // ###### Compute DOPs ########
-            // 1- Rotation matrix from ECEF coordinates to ENU coordinates
-            // ref: http://www.navipedia.net/index.php/Transformations_between_ECEF_and_ENU_coordinates
-            arma::mat F = arma::zeros(3,3);
-            F(0,0) = -sin(GPS_TWO_PI*(d_longitude_d/360.0));
-            F(0,1) = -sin(GPS_TWO_PI*(d_latitude_d/360.0))*cos(GPS_TWO_PI*(d_longitude_d/360.0));
-            F(0,2) = cos(GPS_TWO_PI*(d_latitude_d/360.0))*cos(GPS_TWO_PI*(d_longitude_d/360.0));
-
-            F(1,0) = cos((GPS_TWO_PI*d_longitude_d)/360.0);
-            F(1,1) = -sin((GPS_TWO_PI*d_latitude_d)/360.0)*sin((GPS_TWO_PI*d_longitude_d)/360.0);
-            F(1,2) = cos((GPS_TWO_PI*d_latitude_d/360.0))*sin((GPS_TWO_PI*d_longitude_d)/360.0);
-
-            F(2,0) = 0;
-            F(2,1) = cos((GPS_TWO_PI*d_latitude_d)/360.0);
-            F(2,2) = sin((GPS_TWO_PI*d_latitude_d/360.0));
-
-            // 2- Apply the rotation to the latest covariance matrix (available in ECEF from LS)
-            arma::mat Q_ECEF = d_Q.submat(0, 0, 2, 2);
-            arma::mat DOP_ENU = arma::zeros(3, 3);
-
-            try
-            {
-                    DOP_ENU = arma::htrans(F)*Q_ECEF*F;
-                    d_GDOP  = sqrt(arma::trace(DOP_ENU));                       // Geometric DOP
-                    d_PDOP  = sqrt(DOP_ENU(0,0) + DOP_ENU(1,1) + DOP_ENU(2,2)); // PDOP
-                    d_HDOP  = sqrt(DOP_ENU(0,0) + DOP_ENU(1,1));                // HDOP
-                    d_VDOP  = sqrt(DOP_ENU(2,2));                               // VDOP
-                    d_TDOP  = sqrt(d_Q(3,3));                                   // TDOP
-            }
-            catch(std::exception& ex)
-            {
-                    d_GDOP = -1;   // Geometric DOP
-                    d_PDOP = -1;   // PDOP
-                    d_HDOP = -1;   // HDOP
-                    d_VDOP = -1;   // VDOP
-                    d_TDOP = -1;   // TDOP
-            }
+            d_ls_solver.compute_DOP(d_latitude_d, d_longitude_d, &d_GDOP, &d_PDOP, &d_HDOP, &d_VDOP, &d_TDOP);
 
             // ######## LOG FILE #########
             if(d_flag_dump_enabled == true)
@@ -405,16 +222,16 @@ bool galileo_e1_ls_pvt::get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map
                             tmp_double = galileo_current_time;
                             d_dump_file.write((char*)&tmp_double, sizeof(double));
                             // ECEF User Position East [m]
-                            tmp_double = mypos(0);
+                            tmp_double = mypos[0];
                             d_dump_file.write((char*)&tmp_double, sizeof(double));
                             // ECEF User Position North [m]
-                            tmp_double = mypos(1);
+                            tmp_double = mypos[1];
                             d_dump_file.write((char*)&tmp_double, sizeof(double));
                             // ECEF User Position Up [m]
-                            tmp_double = mypos(2);
+                            tmp_double = mypos[2];
                             d_dump_file.write((char*)&tmp_double, sizeof(double));
                             // User clock offset [s]
-                            tmp_double = mypos(3);
+                            tmp_double = mypos[3];
                             d_dump_file.write((char*)&tmp_double, sizeof(double));
                             // GEO user position Latitude [deg]
                             tmp_double = d_latitude_d;
@@ -534,196 +351,3 @@ void galileo_e1_ls_pvt::cart2geo(double X, double Y, double Z, int elipsoid_sele
     d_longitude_d = lambda * 180 / GPS_PI;
     d_height_m = h;
 }
-
-
-void galileo_e1_ls_pvt::togeod(double *dphi, double *dlambda, double *h, double a, double finv, double X, double Y, double Z)
-{
-    /* Subroutine to calculate geodetic coordinates latitude, longitude,
-	height given Cartesian coordinates X,Y,Z, and reference ellipsoid
-	values semi-major axis (a) and the inverse of flattening (finv).
-
-	 The output units of angular quantities will be in decimal degrees
-	  (15.5 degrees not 15 deg 30 min). The output units of h will be the
-	  same as the units of X,Y,Z,a.
-
-	   Inputs:
-	       a           - semi-major axis of the reference ellipsoid
-	       finv        - inverse of flattening of the reference ellipsoid
-	       X,Y,Z       - Cartesian coordinates
-
-	   Outputs:
-	       dphi        - latitude
-	       dlambda     - longitude
-	       h           - height above reference ellipsoid
-
-	       Based in a Matlab function by Kai Borre
-     */
-
-    *h = 0;
-    double tolsq = 1.e-10;  // tolerance to accept convergence
-    int maxit = 10;         // max number of iterations
-    double rtd = 180/GPS_PI;
-
-    // compute square of eccentricity
-    double esq;
-    if (finv < 1.0E-20)
-        {
-            esq = 0;
-        }
-    else
-        {
-            esq = (2 - 1/finv) / finv;
-        }
-
-    // first guess
-    double P = sqrt(X*X + Y*Y); // P is distance from spin axis
-
-    //direct calculation of longitude
-    if (P > 1.0E-20)
-        {
-            *dlambda = atan2(Y, X) * rtd;
-        }
-    else
-        {
-            *dlambda = 0;
-        }
-
-    // correct longitude bound
-    if (*dlambda < 0)
-        {
-            *dlambda = *dlambda + 360.0;
-        }
-
-    double r = sqrt(P*P + Z*Z); // r is distance from origin (0,0,0)
-
-    double sinphi;
-    if (r > 1.0E-20)
-        {
-            sinphi = Z/r;
-        }
-    else
-        {
-            sinphi = 0;
-        }
-    *dphi = asin(sinphi);
-
-    // initial value of height  =  distance from origin minus
-    // approximate distance from origin to surface of ellipsoid
-    if (r < 1.0E-20)
-        {
-            *h = 0;
-            return;
-        }
-
-    *h = r - a*(1 - sinphi*sinphi/finv);
-
-    // iterate
-    double cosphi;
-    double N_phi;
-    double dP;
-    double dZ;
-    double oneesq = 1 - esq;
-
-    for (int i = 0; i < maxit; i++)
-        {
-            sinphi = sin(*dphi);
-            cosphi = cos(*dphi);
-
-            // compute radius of curvature in prime vertical direction
-            N_phi = a / sqrt(1 - esq*sinphi*sinphi);
-
-            //    compute residuals in P and Z
-            dP = P - (N_phi + (*h)) * cosphi;
-            dZ = Z - (N_phi*oneesq + (*h)) * sinphi;
-
-            //    update height and latitude
-            *h = *h + (sinphi*dZ + cosphi*dP);
-            *dphi = *dphi + (cosphi*dZ - sinphi*dP)/(N_phi + (*h));
-
-            //     test for convergence
-            if ((dP*dP + dZ*dZ) < tolsq)
-                {
-                    break;
-                }
-            if (i == (maxit - 1))
-                {
-                    LOG(WARNING) << "The computation of geodetic coordinates did not converge";
-                }
-        }
-    *dphi = (*dphi) * rtd;
-}
-
-
-void galileo_e1_ls_pvt::topocent(double *Az, double *El, double *D, arma::vec x, arma::vec dx)
-{
-    /*  Transformation of vector dx into topocentric coordinate
-	system with origin at x
-	   Inputs:
-	      x           - vector origin coordinates (in ECEF system [X; Y; Z;])
-	      dx          - vector ([dX; dY; dZ;]).
-
-	   Outputs:
-	      D           - vector length. Units like the input
-	      Az          - azimuth from north positive clockwise, degrees
-	      El          - elevation angle, degrees
-
-	      Based on a Matlab function by Kai Borre
-     */
-    double lambda;
-    double phi;
-    double h;
-    double dtr = GPS_PI/180.0;
-    double a = 6378137.0;        // semi-major axis of the reference ellipsoid WGS-84
-    double finv = 298.257223563; // inverse of flattening of the reference ellipsoid WGS-84
-
-    // Transform x into geodetic coordinates
-    togeod(&phi, &lambda, &h, a, finv, x(0), x(1), x(2));
-
-    double cl = cos(lambda * dtr);
-    double sl = sin(lambda * dtr);
-    double cb = cos(phi * dtr);
-    double sb = sin(phi * dtr);
-
-    arma::mat F = arma::zeros(3,3);
-
-    F(0,0) = -sl;
-    F(0,1) = -sb*cl;
-    F(0,2) = cb*cl;
-
-    F(1,0) = cl;
-    F(1,1) = -sb*sl;
-    F(1,2) = cb*sl;
-
-    F(2,0) = 0;
-    F(2,1) = cb;
-    F(2,2) = sb;
-
-    arma::vec local_vector;
-
-    local_vector = arma::htrans(F) * dx;
-
-    double E = local_vector(0);
-    double N = local_vector(1);
-    double U = local_vector(2);
-
-    double hor_dis;
-    hor_dis = sqrt(E*E + N*N);
-
-    if (hor_dis < 1.0E-20)
-        {
-            *Az = 0;
-            *El = 90;
-        }
-    else
-        {
-            *Az = atan2(E, N)/dtr;
-            *El = atan2(U, hor_dis)/dtr;
-        }
-
-    if (*Az < 0)
-        {
-            *Az = *Az + 360.0;
-        }
-
-    *D = sqrt(dx(0)*dx(0) + dx(1)*dx(1) + dx(2)*dx(2));
-}
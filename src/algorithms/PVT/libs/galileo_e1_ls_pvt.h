@@ -42,26 +42,22 @@
 #include <map>
 #include <sstream>
 #include <string>
-#include <armadillo>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include "GPS_L1_CA.h"
 #include "galileo_navigation_message.h"
 #include "gnss_synchro.h"
 #include "galileo_ephemeris.h"
 #include "galileo_utc_model.h"
+#include "ls_pvt_solver.h"
+#include "satellite_position_cache.h"
 
-#define PVT_MAX_CHANNELS 24
+#define PVT_MAX_CHANNELS LS_PVT_MAX_SATELLITES
 
 /*!
  * \brief This class implements a simple PVT Least Squares solution
  */
 class galileo_e1_ls_pvt
 {
-private:
-    arma::vec leastSquarePos(arma::mat satpos, arma::vec obs, arma::mat w);
-    arma::vec rotateSatellite(double traveltime, arma::vec X_sat);
-    void topocent(double *Az, double *El, double *D, arma::vec x, arma::vec dx);
-    void togeod(double *dphi, double *dlambda, double *h, double a, double finv, double X, double Y, double Z);
 public:
     int d_nchannels;                                        //!< Number of available channels for positioning
     int d_valid_observations;                               //!< Number of valid pseudorange observations (valid satellites)
@@ -100,7 +96,8 @@ public:
     double d_z_m;
 
     // DOP estimations
-    arma::mat d_Q;
+    Ls_Pvt_Solver d_ls_solver; //!< Least Squares solver, started from the previous fix
+    Satellite_Position_Cache<Galileo_Ephemeris> d_position_cache; //!< Interpolated satellite positions and clock corrections
     double d_GDOP;
     double d_PDOP;
     double d_HDOP;
@@ -119,7 +116,7 @@ public:
 
     ~galileo_e1_ls_pvt();
 
-    bool get_PVT(std::map<int,Gnss_Synchro> gnss_pseudoranges_map, double galileo_current_time, bool flag_averaging);
+    bool get_PVT(const std::map<int,Gnss_Synchro> &gnss_pseudoranges_map, double galileo_current_time, bool flag_averaging);
 
     /*!
      * \brief Conversion of Cartesian coordinates (X,Y,Z) to geographical
@@ -0,0 +1,380 @@
+/*!
+ * \file hybrid_ls_pvt.cc
+ * \brief Implementation of a Least Squares Position, Velocity, and Time
+ * (PVT) solver that uses the GPS L1 C/A and Galileo E1 pseudoranges of an
+ * epoch in a single solution, with an inter-system bias.
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+#define GLOG_NO_ABBREVIATED_SEVERITIES
+
+#include "hybrid_ls_pvt.h"
+#include <glog/logging.h>
+
+
+using google::LogMessage;
+
+
+hybrid_ls_pvt::hybrid_ls_pvt(int nchannels, std::string dump_filename, bool flag_dump_to_file) : d_ls_solver(GPS_C_m_s)
+{
+    d_nchannels = nchannels;
+    d_dump_filename = dump_filename;
+    d_flag_dump_enabled = flag_dump_to_file;
+    d_averaging_depth = 0;
+    d_rx_time = 0;
+    d_isb_m = 0;
+    d_valid_observations = 0;
+    d_valid_gps_observations = 0;
+    d_valid_galileo_observations = 0;
+    b_valid_position = false;
+    // ############# ENABLE DATA FILE LOG #################
+    if (d_flag_dump_enabled == true)
+        {
+            if (d_dump_file.is_open() == false)
+                {
+                    try
+                    {
+                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
+                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                            LOG(INFO) << "PVT lib dump enabled Log file: " << d_dump_filename.c_str();
+                    }
+                    catch (const std::ifstream::failure& e)
+                    {
+                            LOG(WARNING) << "Exception opening PVT lib dump file " << e.what();
+                    }
+                }
+        }
+}
+
+
+void hybrid_ls_pvt::set_averaging_depth(int depth)
+{
+    d_averaging_depth = depth;
+}
+
+
+hybrid_ls_pvt::~hybrid_ls_pvt()
+{
+    d_dump_file.close();
+}
+
+
+bool hybrid_ls_pvt::get_PVT(const std::map<int,Gnss_Synchro> &gnss_pseudoranges_map, double rx_time, bool flag_averaging)
+{
+    std::map<int,Gnss_Synchro>::const_iterator gnss_pseudoranges_iter;
+    std::map<int,Gps_Ephemeris>::iterator gps_ephemeris_iter;
+    std::map<int,Galileo_Ephemeris>::iterator galileo_ephemeris_iter;
+    std::map<int,Galileo_Ephemeris>::iterator galileo_time_ephemeris_iter = galileo_ephemeris_map.end();
+    double W[PVT_MAX_CHANNELS];         // channels weights (diagonal of the weights matrix)
+    double obs[PVT_MAX_CHANNELS];       // pseudoranges observation vector
+    double satpos[PVT_MAX_CHANNELS][3]; // satellite positions matrix
+    int system[PVT_MAX_CHANNELS];       // 0 for GPS (reference clock), 1 for Galileo
+
+    int GPS_week = 0;
+    int Galileo_week_number = 0;
+    double gps_tx_time_s = 0;
+    double TX_time_corrected_s;
+    double SV_clock_bias_s = 0;
+
+    d_flag_averaging = flag_averaging;
+    d_rx_time = rx_time;
+
+    // ********************************************************************************
+    // ****** PREPARE THE LEAST SQUARES DATA (SV POSITIONS MATRIX AND OBS VECTORS) ****
+    // ********************************************************************************
+    int valid_obs = 0; //valid observations counter
+    int valid_gps_obs = 0;
+    int valid_galileo_obs = 0;
+    for(gnss_pseudoranges_iter = gnss_pseudoranges_map.begin();
+            gnss_pseudoranges_iter != gnss_pseudoranges_map.end() and valid_obs < PVT_MAX_CHANNELS;
+            gnss_pseudoranges_iter++)
+        {
+            const Gnss_Synchro &gnss_synchro = gnss_pseudoranges_iter->second;
+            int prn = gnss_synchro.PRN;
+
+            // COMMON RX TIME PVT ALGORITHM MODIFICATION (Like RINEX files)
+            // first estimate of transmit time. GST is aligned with GPS time up to
+            // the GGTO, which goes into the inter-system bias
+            double Tx_time = rx_time - gnss_synchro.Pseudorange_m/GPS_C_m_s;
+
+            // 1- find the ephemeris for the current SV observation in the map of its system,
+            // 2- compute the clock drift and the relativistic clock drift using the clock model (broadcast) for this SV,
+            // 3- compute the current ECEF position for this SV using corrected TX time
+            if (gnss_synchro.System == 'G')
+                {
+                    gps_ephemeris_iter = gps_ephemeris_map.find(prn);
+                    if (gps_ephemeris_iter == gps_ephemeris_map.end())
+                        {
+                            DLOG(INFO) << "No ephemeris data for GPS SV " << prn;
+                            continue;
+                        }
+                    SV_clock_bias_s = d_gps_position_cache.clock_correction(prn, gps_ephemeris_iter->second, Tx_time)
+                            - gps_ephemeris_iter->second.d_TGD;
+                    TX_time_corrected_s = Tx_time - SV_clock_bias_s;
+                    d_gps_position_cache.position(prn, gps_ephemeris_iter->second, TX_time_corrected_s, satpos[valid_obs], NULL);
+                    system[valid_obs] = 0;
+                    GPS_week = gps_ephemeris_iter->second.i_GPS_week;
+                    gps_tx_time_s = TX_time_corrected_s;
+                    valid_gps_obs++;
+                }
+            else if (gnss_synchro.System == 'E')
+                {
+                    galileo_ephemeris_iter = galileo_ephemeris_map.find(prn);
+                    if (galileo_ephemeris_iter == galileo_ephemeris_map.end())
+                        {
+                            DLOG(INFO) << "No ephemeris data for Galileo SV " << prn;
+                            continue;
+                        }
+                    SV_clock_bias_s = d_galileo_position_cache.clock_correction(prn, galileo_ephemeris_iter->second, Tx_time);
+                    TX_time_corrected_s = Tx_time - SV_clock_bias_s;
+                    d_galileo_position_cache.position(prn, galileo_ephemeris_iter->second, TX_time_corrected_s, satpos[valid_obs], NULL);
+                    system[valid_obs] = 1;
+                    Galileo_week_number = galileo_ephemeris_iter->second.WN_5;
+                    galileo_time_ephemeris_iter = galileo_ephemeris_iter;
+                    valid_galileo_obs++;
+                }
+            else
+                {
+                    DLOG(INFO) << "Observable of an unsupported system " << gnss_synchro.System;
+                    continue;
+                }
+
+            /*!
+             * \todo Place here the satellite CN0 (power level, or weight factor)
+             */
+            W[valid_obs] = 1;
+
+            // 4- fill the observations vector with the corrected pseudoranges
+            obs[valid_obs] = gnss_synchro.Pseudorange_m + SV_clock_bias_s*GPS_C_m_s;
+            d_visible_satellites_IDs[valid_obs] = prn;
+            d_visible_satellites_System[valid_obs] = gnss_synchro.System;
+            d_visible_satellites_CN0_dB[valid_obs] = gnss_synchro.CN0_dB_hz;
+            valid_obs++;
+
+            // SV ECEF DEBUG OUTPUT
+            DLOG(INFO) << "ECEF satellite SV ID=" << gnss_synchro.System << prn
+                    << " X=" << satpos[valid_obs - 1][0]
+                    << " [m] Y=" << satpos[valid_obs - 1][1]
+                    << " [m] Z=" << satpos[valid_obs - 1][2]
+                    << " [m] PR_obs=" << obs[valid_obs - 1] << " [m]";
+        }
+
+    // ********************************************************************************
+    // ****** SOLVE LEAST SQUARES******************************************************
+    // ********************************************************************************
+    d_valid_observations = valid_obs;
+    d_valid_gps_observations = valid_gps_obs;
+    d_valid_galileo_observations = valid_galileo_obs;
+    LOG(INFO) << "Hybrid PVT: valid observations=" << valid_obs << " (GPS " << valid_gps_obs
+              << ", Galileo " << valid_galileo_obs << ")";
+
+    // one more observation is needed to estimate the inter-system bias
+    int min_obs = (valid_gps_obs > 0 and valid_galileo_obs > 0) ? LS_PVT_MAX_UNKNOWNS : LS_PVT_UNKNOWNS;
+    if (valid_obs < min_obs)
+        {
+            b_valid_position = false;
+            return false;
+        }
+
+    if (d_ls_solver.solve(valid_obs, satpos, obs, W, system, d_visible_satellites_Az,
+            d_visible_satellites_El, d_visible_satellites_Distance) == false)
+        {
+            b_valid_position = false;
+            return false;
+        }
+    const double *mypos = d_ls_solver.d_pos;
+    if (d_ls_solver.d_unknowns == LS_PVT_MAX_UNKNOWNS)
+        {
+            d_isb_m = mypos[4];
+        }
+    LOG(INFO) << "Hybrid position at TOW=" << rx_time << " in ECEF (X,Y,Z) = " << mypos[0] << ", " << mypos[1] << ", " << mypos[2]
+              << " ISB = " << d_isb_m << " [m]";
+    hybrid_ls_pvt::cart2geo(mypos[0], mypos[1], mypos[2], 4);
+    //ToDo: Find an Observables/PVT random bug with some satellite configurations that gives an erratic PVT solution (i.e. height>50 km)
+    if (d_height_m > 50000)
+        {
+            b_valid_position = false;
+            d_ls_solver.reset(); // do not start the next fix from this one
+            return false;
+        }
+
+    // Compute UTC time, from the GPS UTC model if there are GPS satellites
+    double utc;
+    if (valid_gps_obs > 0)
+        {
+            double secondsperweek = 604800.0; // number of seconds in one week (7*24*60*60)
+            utc = gps_utc_model.utc_time(gps_tx_time_s, GPS_week) + secondsperweek*(double)GPS_week;
+        }
+    else
+        {
+            double GST = galileo_time_ephemeris_iter->second.Galileo_System_Time(Galileo_week_number, rx_time);
+            utc = galileo_utc_model.GST_to_UTC_time(GST, Galileo_week_number);
+        }
+    boost::posix_time::time_duration t = boost::posix_time::seconds(utc);
+    // 22 August 1999 last GPS time roll over and GST start epoch
+    boost::posix_time::ptime p_time(boost::gregorian::date(1999, 8, 22), t);
+    d_position_UTC_time = p_time;
+
+    LOG(INFO) << "Hybrid position at " << boost::posix_time::to_simple_string(p_time)
+              << " is Lat = " << d_latitude_d << " [deg], Long = " << d_longitude_d
+              << " [deg], Height= " << d_height_m << " [m]";
+
+    // ###### Compute DOPs ########
+    d_ls_solver.compute_DOP(d_latitude_d, d_longitude_d, &d_GDOP, &d_PDOP, &d_HDOP, &d_VDOP, &d_TDOP);
+
+    // ######## LOG FILE #########
+    if(d_flag_dump_enabled == true)
+        {
+            // MULTIPLEXED FILE RECORDING - Record results to file
+            try
+            {
+                    double tmp_double;
+                    //  PVT GPS time
+                    tmp_double = rx_time;
+                    d_dump_file.write((char*)&tmp_double, sizeof(double));
+                    // ECEF User Position East [m]
+                    tmp_double = mypos[0];
+                    d_dump_file.write((char*)&tmp_double, sizeof(double));
+                    // ECEF User Position North [m]
+                    tmp_double = mypos[1];
+                    d_dump_file.write((char*)&tmp_double, sizeof(double));
+                    // ECEF User Position Up [m]
+                    tmp_double = mypos[2];
+                    d_dump_file.write((char*)&tmp_double, sizeof(double));
+                    // User clock offset [s]
+                    tmp_double = mypos[3];
+                    d_dump_file.write((char*)&tmp_double, sizeof(double));
+                    // GEO user position Latitude [deg]
+                    tmp_double = d_latitude_d;
+                    d_dump_file.write((char*)&tmp_double, sizeof(double));
+                    // GEO user position Longitude [deg]
+                    tmp_double = d_longitude_d;
+                    d_dump_file.write((char*)&tmp_double, sizeof(double));
+                    // GEO user position Height [m]
+                    tmp_double = d_height_m;
+                    d_dump_file.write((char*)&tmp_double, sizeof(double));
+                    // Galileo minus GPS inter-system bias [m]
+                    tmp_double = d_isb_m;
+                    d_dump_file.write((char*)&tmp_double, sizeof(double));
+            }
+            catch (const std::ifstream::failure& e)
+            {
+                    LOG(WARNING) << "Exception writing PVT LS dump file " << e.what();
+            }
+        }
+
+    // MOVING AVERAGE PVT
+    if (flag_averaging == true)
+        {
+            if (d_hist_longitude_d.size() == (unsigned int)d_averaging_depth)
+                {
+                    // Pop oldest value
+                    d_hist_longitude_d.pop_back();
+                    d_hist_latitude_d.pop_back();
+                    d_hist_height_m.pop_back();
+                    // Push new values
+                    d_hist_longitude_d.push_front(d_longitude_d);
+                    d_hist_latitude_d.push_front(d_latitude_d);
+                    d_hist_height_m.push_front(d_height_m);
+
+                    d_avg_latitude_d = 0;
+                    d_avg_longitude_d = 0;
+                    d_avg_height_m = 0;
+                    for (unsigned int i = 0; i < d_hist_longitude_d.size(); i++)
+                        {
+                            d_avg_latitude_d = d_avg_latitude_d + d_hist_latitude_d.at(i);
+                            d_avg_longitude_d = d_avg_longitude_d + d_hist_longitude_d.at(i);
+                            d_avg_height_m  = d_avg_height_m + d_hist_height_m.at(i);
+                        }
+                    d_avg_latitude_d = d_avg_latitude_d / (double)d_averaging_depth;
+                    d_avg_longitude_d = d_avg_longitude_d / (double)d_averaging_depth;
+                    d_avg_height_m = d_avg_height_m / (double)d_averaging_depth;
+                    b_valid_position = true;
+                    return true; //indicates that the returned position is valid
+                }
+            else
+                {
+                    // Push new values
+                    d_hist_longitude_d.push_front(d_longitude_d);
+                    d_hist_latitude_d.push_front(d_latitude_d);
+                    d_hist_height_m.push_front(d_height_m);
+
+                    d_avg_latitude_d = d_latitude_d;
+                    d_avg_longitude_d = d_longitude_d;
+                    d_avg_height_m = d_height_m;
+                    b_valid_position = false;
+                    return false; //indicates that the returned position is not valid yet
+                }
+        }
+    else
+        {
+            b_valid_position = true;
+            return true; //indicates that the returned position is valid
+        }
+}
+
+
+void hybrid_ls_pvt::cart2geo(double X, double Y, double Z, int elipsoid_selection)
+{
+    /* Conversion of Cartesian coordinates (X,Y,Z) to geographical
+     coordinates (latitude, longitude, h) on a selected reference ellipsoid.
+
+       Choices of Reference Ellipsoid for Geographical Coordinates
+                 0. International Ellipsoid 1924
+                 1. International Ellipsoid 1967
+                 2. World Geodetic System 1972
+                 3. Geodetic Reference System 1980
+                 4. World Geodetic System 1984
+     */
+
+    const double a[5] = {6378388, 6378160, 6378135, 6378137, 6378137};
+    const double f[5] = {1/297, 1/298.247, 1/298.26, 1/298.257222101, 1/298.257223563};
+
+    double lambda  = atan2(Y,X);
+    double ex2 = (2 - f[elipsoid_selection]) * f[elipsoid_selection] / ((1 - f[elipsoid_selection])*(1 - f[elipsoid_selection]));
+    double c = a[elipsoid_selection] * sqrt(1 + ex2);
+    double phi = atan(Z / ((sqrt(X*X + Y*Y)*(1 - (2 - f[elipsoid_selection])) * f[elipsoid_selection])));
+
+    double h = 0.1;
+    double oldh = 0;
+    double N;
+    int iterations = 0;
+    do
+        {
+            oldh = h;
+            N = c / sqrt(1 + ex2 * (cos(phi) * cos(phi)));
+            phi = atan(Z / ((sqrt(X*X + Y*Y) * (1 - (2 -f[elipsoid_selection]) * f[elipsoid_selection] *N / (N + h) ))));
+            h = sqrt(X*X + Y*Y) / cos(phi) - N;
+            iterations = iterations + 1;
+            if (iterations > 100)
+                {
+                    LOG(WARNING) << "Failed to approximate h with desired precision. h-oldh= " << h - oldh;
+                    break;
+                }
+        }
+    while (std::abs(h - oldh) > 1.0e-12);
+    d_latitude_d = phi * 180.0 / GPS_PI;
+    d_longitude_d = lambda * 180 / GPS_PI;
+    d_height_m = h;
+}
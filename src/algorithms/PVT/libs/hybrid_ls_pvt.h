@@ -0,0 +1,154 @@
+/*!
+ * \file hybrid_ls_pvt.h
+ * \brief Interface of a Least Squares Position, Velocity, and Time (PVT)
+ * solver that uses the GPS L1 C/A and Galileo E1 pseudoranges of an epoch
+ * in a single solution, with an inter-system bias.
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_HYBRID_LS_PVT_H_
+#define GNSS_SDR_HYBRID_LS_PVT_H_
+
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <string>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include "gnss_synchro.h"
+#include "GPS_L1_CA.h"
+#include "Galileo_E1.h"
+#include "gps_ephemeris.h"
+#include "gps_iono.h"
+#include "gps_utc_model.h"
+#include "galileo_ephemeris.h"
+#include "galileo_iono.h"
+#include "galileo_utc_model.h"
+#include "ls_pvt_solver.h"
+#include "satellite_position_cache.h"
+
+#define PVT_MAX_CHANNELS LS_PVT_MAX_SATELLITES
+
+/*!
+ * \brief This class implements a PVT Least Squares solution with the GPS
+ * and Galileo satellites of an epoch.
+ *
+ * The pseudoranges map is keyed by channel, since a GPS and a Galileo
+ * satellite can have the same PRN: the system of each observation is taken
+ * from Gnss_Synchro::System ('G' or 'E'). The receiver clock offset refers to
+ * GPS time, and d_isb_m holds the bias of the Galileo pseudoranges with
+ * respect to it (GPS to Galileo time offset plus the receiver hardware biases),
+ * estimated in each fix that has satellites of both systems.
+ */
+class hybrid_ls_pvt
+{
+public:
+    int d_nchannels;                                        //!< Number of available channels for positioning
+    int d_valid_observations;                               //!< Number of valid pseudorange observations (valid satellites)
+    int d_valid_gps_observations;                           //!< GPS satellites used in the last solution
+    int d_valid_galileo_observations;                       //!< Galileo satellites used in the last solution
+    int d_visible_satellites_IDs[PVT_MAX_CHANNELS];         //!< Array with the IDs of the valid satellites
+    char d_visible_satellites_System[PVT_MAX_CHANNELS];     //!< Array with the system ('G' or 'E') of the valid satellites
+    double d_visible_satellites_El[PVT_MAX_CHANNELS];       //!< Array with the LOS Elevation of the valid satellites
+    double d_visible_satellites_Az[PVT_MAX_CHANNELS];       //!< Array with the LOS Azimuth of the valid satellites
+    double d_visible_satellites_Distance[PVT_MAX_CHANNELS]; //!< Array with the LOS Distance of the valid satellites
+    double d_visible_satellites_CN0_dB[PVT_MAX_CHANNELS];   //!< Array with the IDs of the valid satellites
+
+    std::map<int,Gps_Ephemeris> gps_ephemeris_map; //!< Map storing new Gps_Ephemeris
+    Gps_Utc_Model gps_utc_model;
+    Gps_Iono gps_iono;
+
+    std::map<int,Galileo_Ephemeris> galileo_ephemeris_map; //!< Map storing new Galileo_Ephemeris
+    Galileo_Utc_Model galileo_utc_model;
+    Galileo_Iono galileo_iono;
+
+    double d_rx_time;
+    boost::posix_time::ptime d_position_UTC_time;
+
+    bool b_valid_position;
+
+    double d_latitude_d;  //!< Latitude in degrees
+    double d_longitude_d; //!< Longitude in degrees
+    double d_height_m;    //!< Height [m]
+    double d_isb_m;       //!< Galileo minus GPS inter-system bias [m], from the last fix with satellites of both systems
+
+    //averaging
+    std::deque<double> d_hist_latitude_d;
+    std::deque<double> d_hist_longitude_d;
+    std::deque<double> d_hist_height_m;
+    int d_averaging_depth;    //!< Length of averaging window
+    double d_avg_latitude_d;  //!< Averaged latitude in degrees
+    double d_avg_longitude_d; //!< Averaged longitude in degrees
+    double d_avg_height_m;    //!< Averaged height [m]
+
+    // DOP estimations
+    Ls_Pvt_Solver d_ls_solver; //!< Least Squares solver, started from the previous fix
+    Satellite_Position_Cache<Gps_Ephemeris> d_gps_position_cache;         //!< Interpolated GPS satellite positions and clock corrections
+    Satellite_Position_Cache<Galileo_Ephemeris> d_galileo_position_cache; //!< Interpolated Galileo satellite positions and clock corrections
+    double d_GDOP;
+    double d_PDOP;
+    double d_HDOP;
+    double d_VDOP;
+    double d_TDOP;
+
+    bool d_flag_dump_enabled;
+    bool d_flag_averaging;
+
+    std::string d_dump_filename;
+    std::ofstream d_dump_file;
+
+    void set_averaging_depth(int depth);
+
+    hybrid_ls_pvt(int nchannels, std::string dump_filename, bool flag_dump_to_file);
+    ~hybrid_ls_pvt();
+
+    /*!
+     * \brief Computes the PVT solution with the GPS and Galileo pseudoranges of an epoch
+     *
+     * \param[in] gnss_pseudoranges_map Valid observables of the epoch, keyed by channel
+     * \param[in] rx_time Common reception time of the epoch (GPS TOW) [s]
+     * \param[in] flag_averaging Moving average of the position
+     */
+    bool get_PVT(const std::map<int,Gnss_Synchro> &gnss_pseudoranges_map, double rx_time, bool flag_averaging);
+
+    /*!
+     * \brief Conversion of Cartesian coordinates (X,Y,Z) to geographical
+     * coordinates (d_latitude_d, d_longitude_d, d_height_m) on a selected reference ellipsoid.
+     *
+     * \param[in] X [m] Cartesian coordinate
+     * \param[in] Y [m] Cartesian coordinate
+     * \param[in] Z [m] Cartesian coordinate
+     * \param[in] elipsoid_selection. Choices of Reference Ellipsoid for Geographical Coordinates:
+     * 0 - International Ellipsoid 1924.
+     * 1 - International Ellipsoid 1967.
+     * 2 - World Geodetic System 1972.
+     * 3 - Geodetic Reference System 1980.
+     * 4 - World Geodetic System 1984.
+     *
+     */
+    void cart2geo(double X, double Y, double Z, int elipsoid_selection);
+};
+
+#endif
@@ -84,51 +84,37 @@ bool Kml_Printer::set_headers(std::string filename)
 
 bool Kml_Printer::print_position(gps_l1_ca_ls_pvt* position,bool print_average_values)
 {
-    double latitude;
-    double longitude;
-    double height;
-    if (print_average_values == false)
-        {
-            latitude = position->d_latitude_d;
-            longitude = position->d_longitude_d;
-            height = position->d_height_m;
-        }
-    else
-        {
-            latitude = position->d_avg_latitude_d;
-            longitude = position->d_avg_longitude_d;
-            height = position->d_avg_height_m;
-        }
-
-    if (kml_file.is_open())
-        {
-            kml_file << longitude << "," << latitude << "," << height << std::endl;
-            return true;
-        }
-    else
-        {
-            return false;
-        }
+    Pvt_Output_Record record;
+    record.set_solution(position);
+    return print_position(record, print_average_values);
 }
 
 //ToDo: make the class ls_pvt generic and heritate the particular gps/gal/glo ls_pvt in order to
 // reuse kml_printer functions
 bool Kml_Printer::print_position_galileo(galileo_e1_ls_pvt* position,bool print_average_values)
+{
+    Pvt_Output_Record record;
+    record.set_solution(position);
+    return print_position(record, print_average_values);
+}
+
+
+bool Kml_Printer::print_position(const Pvt_Output_Record& position, bool print_average_values)
 {
     double latitude;
     double longitude;
     double height;
     if (print_average_values == false)
         {
-            latitude = position->d_latitude_d;
-            longitude = position->d_longitude_d;
-            height = position->d_height_m;
+            latitude = position.d_latitude_d;
+            longitude = position.d_longitude_d;
+            height = position.d_height_m;
         }
     else
         {
-            latitude = position->d_avg_latitude_d;
-            longitude = position->d_avg_longitude_d;
-            height = position->d_avg_height_m;
+            latitude = position.d_avg_latitude_d;
+            longitude = position.d_avg_longitude_d;
+            height = position.d_avg_height_m;
         }
 
     if (kml_file.is_open())
@@ -38,6 +38,7 @@
 #include <string>
 #include "gps_l1_ca_ls_pvt.h"
 #include "galileo_e1_ls_pvt.h"
+#include "pvt_output_record.h"
 
 
 /*!
@@ -53,6 +54,7 @@ public:
     bool set_headers(std::string filename);
     bool print_position(gps_l1_ca_ls_pvt* position, bool print_average_values);
     bool print_position_galileo(galileo_e1_ls_pvt* position, bool print_average_values);
+    bool print_position(const Pvt_Output_Record& position, bool print_average_values);
     bool close_file();
     Kml_Printer();
     ~Kml_Printer();
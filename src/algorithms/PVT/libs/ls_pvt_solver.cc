@@ -0,0 +1,441 @@
+/*!
+ * \file ls_pvt_solver.cc
+ * \brief Least Squares position and clock solver shared by the GPS and
+ * Galileo PVT classes. It works on fixed-size arrays (at most
+ * LS_PVT_MAX_SATELLITES observations, 4 unknowns), so a fix does not allocate
+ * memory.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "ls_pvt_solver.h"
+#include <cmath>
+#include <cstring>
+#include <glog/logging.h>
+#include "GPS_L1_CA.h"
+
+using google::LogMessage;
+
+
+Ls_Pvt_Solver::Ls_Pvt_Solver(double c_m_s)
+{
+    d_c_m_s = c_m_s;
+    d_iterations = 0;
+    d_unknowns = LS_PVT_UNKNOWNS;
+    reset();
+}
+
+
+void Ls_Pvt_Solver::reset()
+{
+    memset(d_pos, 0, sizeof(d_pos));
+    memset(d_Q, 0, sizeof(d_Q));
+    d_valid = false;
+}
+
+
+bool Ls_Pvt_Solver::solve(int n_obs, const double satpos[][3], const double *obs, const double *weights,
+        double *Az, double *El, double *D)
+{
+    return solve(n_obs, satpos, obs, weights, NULL, Az, El, D);
+}
+
+
+bool Ls_Pvt_Solver::solve(int n_obs, const double satpos[][3], const double *obs, const double *weights,
+        const int *system, double *Az, double *El, double *D)
+{
+    if (n_obs > LS_PVT_MAX_SATELLITES)
+        {
+            return false;
+        }
+
+    // the inter-system bias is only estimated if both systems are present
+    int n_unknowns = LS_PVT_UNKNOWNS;
+    bool second_system[LS_PVT_MAX_SATELLITES];
+    bool reference_system = false;
+    bool other_system = false;
+    for (int i = 0; i < n_obs; i++)
+        {
+            second_system[i] = (system != NULL and system[i] != 0);
+            if (second_system[i]) other_system = true;
+            else reference_system = true;
+        }
+    if (reference_system and other_system)
+        {
+            n_unknowns = LS_PVT_MAX_UNKNOWNS;
+        }
+    if (n_obs < n_unknowns)
+        {
+            return false;
+        }
+
+    double pos[LS_PVT_MAX_UNKNOWNS] = {0.0, 0.0, 0.0, 0.0, 0.0};
+    if (d_valid == true)
+        {
+            // warm start from the previous fix
+            memcpy(pos, d_pos, sizeof(pos));
+        }
+    if (n_unknowns < LS_PVT_MAX_UNKNOWNS)
+        {
+            pos[4] = 0.0;
+        }
+    double Rot_X[LS_PVT_MAX_SATELLITES][3];
+    double N[LS_PVT_MAX_UNKNOWNS][LS_PVT_MAX_UNKNOWNS];
+    double L[LS_PVT_MAX_UNKNOWNS][LS_PVT_MAX_UNKNOWNS];
+    double b[LS_PVT_MAX_UNKNOWNS];
+    double x[LS_PVT_MAX_UNKNOWNS];
+    double a[LS_PVT_MAX_UNKNOWNS];
+
+    //=== Iteratively find receiver position ===================================
+    d_iterations = 0;
+    for (int iter = 0; iter < LS_PVT_MAX_ITERATIONS; iter++)
+        {
+            memset(N, 0, sizeof(N));
+            memset(b, 0, sizeof(b));
+            for (int i = 0; i < n_obs; i++)
+                {
+                    if (pos[0] == 0.0 and pos[1] == 0.0 and pos[2] == 0.0)
+                        {
+                            //--- No position yet: the travel time is unknown ------------
+                            Rot_X[i][0] = satpos[i][0];
+                            Rot_X[i][1] = satpos[i][1];
+                            Rot_X[i][2] = satpos[i][2];
+                        }
+                    else
+                        {
+                            //--- Correct satellite position (due to earth rotation) ------
+                            double dX = satpos[i][0] - pos[0];
+                            double dY = satpos[i][1] - pos[1];
+                            double dZ = satpos[i][2] - pos[2];
+                            double traveltime = sqrt(dX*dX + dY*dY + dZ*dZ) / d_c_m_s;
+                            double omegatau = OMEGA_EARTH_DOT * traveltime;
+                            double cos_omegatau = cos(omegatau);
+                            double sin_omegatau = sin(omegatau);
+                            Rot_X[i][0] = cos_omegatau * satpos[i][0] + sin_omegatau * satpos[i][1];
+                            Rot_X[i][1] = -sin_omegatau * satpos[i][0] + cos_omegatau * satpos[i][1];
+                            Rot_X[i][2] = satpos[i][2];
+                        }
+                    double dx0 = Rot_X[i][0] - pos[0];
+                    double dx1 = Rot_X[i][1] - pos[1];
+                    double dx2 = Rot_X[i][2] - pos[2];
+
+                    //--- Apply the corrections ----------------------------------------
+                    double omc = obs[i] - sqrt(dx0*dx0 + dx1*dx1 + dx2*dx2) - pos[3];
+                    if (second_system[i])
+                        {
+                            omc -= pos[4];
+                        }
+
+                    //--- Row of the A matrix, accumulated into A' W A and A' W omc ----
+                    a[0] = -dx0 / obs[i];
+                    a[1] = -dx1 / obs[i];
+                    a[2] = -dx2 / obs[i];
+                    a[3] = 1.0;
+                    a[4] = second_system[i] ? 1.0 : 0.0;
+                    double w2 = weights[i] * weights[i];
+                    for (int j = 0; j < n_unknowns; j++)
+                        {
+                            for (int k = 0; k <= j; k++)
+                                {
+                                    N[j][k] += w2 * a[j] * a[k];
+                                }
+                            b[j] += w2 * a[j] * omc;
+                        }
+                }
+
+            //--- Find position update ---------------------------------------------
+            if (cholesky_decomposition(N, L, n_unknowns) == false)
+                {
+                    DLOG(INFO) << "LS PVT: singular geometry";
+                    reset();
+                    return false;
+                }
+            cholesky_solve(L, b, x, n_unknowns);
+
+            //--- Apply position update --------------------------------------------
+            double update = 0.0;
+            for (int j = 0; j < n_unknowns; j++)
+                {
+                    pos[j] += x[j];
+                    update += x[j] * x[j];
+                }
+            d_iterations++;
+            if (sqrt(update) < 1e-4)
+                {
+                    break; // exit the loop because we assume that the LS algorithm has converged (err < 0.1 cm)
+                }
+        }
+    memcpy(d_pos, pos, sizeof(d_pos));
+    d_unknowns = n_unknowns;
+    d_valid = true;
+
+    //-- compute the Dilution Of Precision values: inv(A' W A), column by column
+    double e[LS_PVT_MAX_UNKNOWNS];
+    double q[LS_PVT_MAX_UNKNOWNS];
+    memset(d_Q, 0, sizeof(d_Q));
+    for (int j = 0; j < n_unknowns; j++)
+        {
+            memset(e, 0, sizeof(e));
+            e[j] = 1.0;
+            cholesky_solve(L, e, q, n_unknowns);
+            for (int k = 0; k < n_unknowns; k++)
+                {
+                    d_Q[k][j] = q[k];
+                }
+        }
+
+    //--- Find DOA and range of satellites (the local frame is the same for all of them)
+    if (Az != NULL or El != NULL or D != NULL)
+        {
+            double phi;
+            double lambda;
+            double h;
+            double dtr = GPS_PI / 180.0;
+            togeod(&phi, &lambda, &h, 6378137.0, 298.257223563, pos[0], pos[1], pos[2]); // WGS-84
+            double cl = cos(lambda * dtr);
+            double sl = sin(lambda * dtr);
+            double cb = cos(phi * dtr);
+            double sb = sin(phi * dtr);
+            for (int i = 0; i < n_obs; i++)
+                {
+                    double dx0 = Rot_X[i][0] - pos[0];
+                    double dx1 = Rot_X[i][1] - pos[1];
+                    double dx2 = Rot_X[i][2] - pos[2];
+                    double E = -sl * dx0 + cl * dx1;
+                    double North = -sb * cl * dx0 - sb * sl * dx1 + cb * dx2;
+                    double U = cb * cl * dx0 + cb * sl * dx1 + sb * dx2;
+                    double hor_dis = sqrt(E*E + North*North);
+                    double azimuth = 0.0;
+                    double elevation = 90.0;
+                    if (hor_dis >= 1.0E-20)
+                        {
+                            azimuth = atan2(E, North) / dtr;
+                            elevation = atan2(U, hor_dis) / dtr;
+                        }
+                    if (azimuth < 0)
+                        {
+                            azimuth = azimuth + 360.0;
+                        }
+                    if (Az != NULL) Az[i] = azimuth;
+                    if (El != NULL) El[i] = elevation;
+                    if (D != NULL) D[i] = sqrt(dx0*dx0 + dx1*dx1 + dx2*dx2);
+                }
+        }
+    return true;
+}
+
+
+void Ls_Pvt_Solver::compute_DOP(double latitude_d, double longitude_d, double *GDOP, double *PDOP,
+        double *HDOP, double *VDOP, double *TDOP)
+{
+    // 1- Rotation matrix from ECEF coordinates to ENU coordinates
+    // ref: http://www.navipedia.net/index.php/Transformations_between_ECEF_and_ENU_coordinates
+    double sin_lat = sin(GPS_TWO_PI * latitude_d / 360.0);
+    double cos_lat = cos(GPS_TWO_PI * latitude_d / 360.0);
+    double sin_lon = sin(GPS_TWO_PI * longitude_d / 360.0);
+    double cos_lon = cos(GPS_TWO_PI * longitude_d / 360.0);
+    const double F[3][3] = {{-sin_lon, -sin_lat * cos_lon, cos_lat * cos_lon},
+                            { cos_lon, -sin_lat * sin_lon, cos_lat * sin_lon},
+                            {     0.0,            cos_lat,           sin_lat}};
+
+    // 2- Apply the rotation to the latest covariance matrix (available in ECEF from LS):
+    // only the diagonal of F' Q_ECEF F is needed
+    double DOP_ENU[3];
+    for (int j = 0; j < 3; j++)
+        {
+            DOP_ENU[j] = 0.0;
+            for (int k = 0; k < 3; k++)
+                {
+                    for (int l = 0; l < 3; l++)
+                        {
+                            DOP_ENU[j] += F[k][j] * d_Q[k][l] * F[l][j];
+                        }
+                }
+        }
+    *GDOP = sqrt(DOP_ENU[0] + DOP_ENU[1] + DOP_ENU[2]); // Geometric DOP (trace of DOP_ENU)
+    *PDOP = sqrt(DOP_ENU[0] + DOP_ENU[1] + DOP_ENU[2]); // PDOP
+    *HDOP = sqrt(DOP_ENU[0] + DOP_ENU[1]);              // HDOP
+    *VDOP = sqrt(DOP_ENU[2]);                           // VDOP
+    *TDOP = sqrt(d_Q[3][3]);                            // TDOP
+}
+
+
+bool Ls_Pvt_Solver::cholesky_decomposition(const double N[LS_PVT_MAX_UNKNOWNS][LS_PVT_MAX_UNKNOWNS], double L[LS_PVT_MAX_UNKNOWNS][LS_PVT_MAX_UNKNOWNS], int n)
+{
+    // N = L L', using the lower triangle of the n x n block of N
+    for (int j = 0; j < n; j++)
+        {
+            double d = N[j][j];
+            for (int k = 0; k < j; k++)
+                {
+                    d -= L[j][k] * L[j][k];
+                }
+            if (!(d > 0.0))
+                {
+                    return false; // not positive definite (or NaN)
+                }
+            L[j][j] = sqrt(d);
+            for (int i = j + 1; i < n; i++)
+                {
+                    double s = N[i][j];
+                    for (int k = 0; k < j; k++)
+                        {
+                            s -= L[i][k] * L[j][k];
+                        }
+                    L[i][j] = s / L[j][j];
+                }
+        }
+    return true;
+}
+
+
+void Ls_Pvt_Solver::cholesky_solve(const double L[LS_PVT_MAX_UNKNOWNS][LS_PVT_MAX_UNKNOWNS], const double *b, double *x, int n)
+{
+    // L y = b, then L' x = y
+    double y[LS_PVT_MAX_UNKNOWNS];
+    for (int i = 0; i < n; i++)
+        {
+            double s = b[i];
+            for (int k = 0; k < i; k++)
+                {
+                    s -= L[i][k] * y[k];
+                }
+            y[i] = s / L[i][i];
+        }
+    for (int i = n - 1; i >= 0; i--)
+        {
+            double s = y[i];
+            for (int k = i + 1; k < n; k++)
+                {
+                    s -= L[k][i] * x[k];
+                }
+            x[i] = s / L[i][i];
+        }
+}
+
+
+void Ls_Pvt_Solver::togeod(double *dphi, double *dlambda, double *h, double a, double finv, double X, double Y, double Z)
+{
+    /* Subroutine to calculate geodetic coordinates latitude, longitude,
+       height given Cartesian coordinates X,Y,Z, and reference ellipsoid
+       values semi-major axis (a) and the inverse of flattening (finv).
+
+       The output units of angular quantities will be in decimal degrees
+       (15.5 degrees not 15 deg 30 min). The output units of h will be the
+       same as the units of X,Y,Z,a.
+
+       Based in a Matlab function by Kai Borre
+     */
+
+    *h = 0;
+    double tolsq = 1.e-10;  // tolerance to accept convergence
+    int maxit = 10;         // max number of iterations
+    double rtd = 180/GPS_PI;
+
+    // compute square of eccentricity
+    double esq;
+    if (finv < 1.0E-20)
+        {
+            esq = 0;
+        }
+    else
+        {
+            esq = (2 - 1/finv) / finv;
+        }
+
+    // first guess
+    double P = sqrt(X*X + Y*Y); // P is distance from spin axis
+    //direct calculation of longitude
+    if (P > 1.0E-20)
+        {
+            *dlambda = atan2(Y,X) * rtd;
+        }
+    else
+        {
+            *dlambda = 0;
+        }
+    // correct longitude bound
+    if (*dlambda < 0)
+        {
+            *dlambda = *dlambda + 360.0;
+        }
+    double r = sqrt(P*P + Z*Z); // r is distance from origin (0,0,0)
+
+    double sinphi;
+    if (r > 1.0E-20)
+        {
+            sinphi = Z/r;
+        }
+    else
+        {
+            sinphi = 0;
+        }
+    *dphi = asin(sinphi);
+
+    // initial value of height  =  distance from origin minus
+    // approximate distance from origin to surface of ellipsoid
+    if (r < 1.0E-20)
+        {
+            *h = 0;
+            return;
+        }
+
+    *h = r - a*(1-sinphi*sinphi/finv);
+
+    // iterate
+    double cosphi;
+    double N_phi;
+    double dP;
+    double dZ;
+    double oneesq = 1 - esq;
+
+    for (int i = 0; i < maxit; i++)
+        {
+            sinphi = sin(*dphi);
+            cosphi = cos(*dphi);
+
+            // compute radius of curvature in prime vertical direction
+            N_phi = a / sqrt(1 - esq*sinphi*sinphi);
+
+            // compute residuals in P and Z
+            dP = P - (N_phi + (*h)) * cosphi;
+            dZ = Z - (N_phi*oneesq + (*h)) * sinphi;
+
+            // update height and latitude
+            *h = *h + (sinphi*dZ + cosphi*dP);
+            *dphi = *dphi + (cosphi*dZ - sinphi*dP)/(N_phi + (*h));
+
+            //     test for convergence
+            if ((dP*dP + dZ*dZ) < tolsq)
+                {
+                    break;
+                }
+            if (i == (maxit - 1))
+                {
+                    LOG(WARNING) << "The computation of geodetic coordinates did not converge";
+                }
+        }
+    *dphi = (*dphi) * rtd;
+}
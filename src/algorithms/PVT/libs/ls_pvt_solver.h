@@ -0,0 +1,120 @@
+/*!
+ * \file ls_pvt_solver.h
+ * \brief Least Squares position and clock solver shared by the GPS,
+ * Galileo and hybrid PVT classes. It works on fixed-size arrays (at most
+ * LS_PVT_MAX_SATELLITES observations, LS_PVT_MAX_UNKNOWNS unknowns), so a fix
+ * does not allocate memory.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_LS_PVT_SOLVER_H_
+#define GNSS_SDR_LS_PVT_SOLVER_H_
+
+#define LS_PVT_MAX_SATELLITES 24   //!< Maximum number of observations of a fix
+#define LS_PVT_UNKNOWNS 4          //!< X, Y, Z [m] and receiver clock offset [m]
+#define LS_PVT_MAX_UNKNOWNS 5      //!< Plus the inter-system bias [m] of a two-system fix
+#define LS_PVT_MAX_ITERATIONS 10
+
+/*!
+ * \brief Iterative Least Squares solution of the receiver position and clock
+ * offset from a set of pseudoranges.
+ *
+ * Each iteration accumulates the 4x4 normal equations (A' W A) dx = A' W omc
+ * and solves them by Cholesky decomposition. The weights are the diagonal of
+ * W, so no n x n matrix is ever built. The iterations start from the previous
+ * solution (warm start) when there is one, which usually converges in one or
+ * two iterations instead of the five or six needed from the center of the Earth.
+ *
+ * When the observations come from two systems, a fifth unknown holds the bias
+ * between the clock of the second system and the clock of the first one (the
+ * offset between the system time scales plus the receiver hardware biases).
+ */
+class Ls_Pvt_Solver
+{
+public:
+    /*!
+     * \param[in] c_m_s Speed of light used by the system [m/s]
+     */
+    Ls_Pvt_Solver(double c_m_s);
+
+    /*!
+     * \brief Computes the position and clock offset.
+     *
+     * \param[in] n_obs Number of observations (4 to LS_PVT_MAX_SATELLITES)
+     * \param[in] satpos Satellite ECEF positions [m] at transmission time
+     * \param[in] obs Corrected pseudoranges [m]
+     * \param[in] weights Weight of each observation (diagonal of W)
+     * \param[out] Az Azimuth of each satellite [deg], can be NULL
+     * \param[out] El Elevation of each satellite [deg], can be NULL
+     * \param[out] D Distance to each satellite [m], can be NULL
+     *
+     * Returns false if there are not enough observations or the geometry is
+     * singular. On success, d_pos holds the solution and d_Q the cofactor matrix.
+     */
+    bool solve(int n_obs, const double satpos[][3], const double *obs, const double *weights,
+            double *Az, double *El, double *D);
+
+    /*!
+     * \brief Computes the position, the clock offset and, if both systems are
+     * present, the inter-system bias.
+     *
+     * \param[in] system System of each observation: 0 for the reference system,
+     * whose clock offset is d_pos[3], and 1 for the second system, whose
+     * pseudoranges also contain d_pos[4].
+     *
+     * The other parameters are the ones of the single system solve(). With
+     * observations of one system only, the solution is the same as the one of
+     * the single system solve() and d_pos[4] is 0.
+     */
+    bool solve(int n_obs, const double satpos[][3], const double *obs, const double *weights,
+            const int *system, double *Az, double *El, double *D);
+
+    /*!
+     * \brief Forgets the previous solution, so the next one starts from the center of the Earth
+     */
+    void reset();
+
+    /*!
+     * \brief Dilution of precision of the last solution at the given geodetic
+     * position, from the ENU rotation of d_Q
+     */
+    void compute_DOP(double latitude_d, double longitude_d, double *GDOP, double *PDOP,
+            double *HDOP, double *VDOP, double *TDOP);
+
+    double d_pos[LS_PVT_MAX_UNKNOWNS];                    //!< Last solution: ECEF X, Y, Z [m], clock offset [m] and inter-system bias [m]
+    double d_Q[LS_PVT_MAX_UNKNOWNS][LS_PVT_MAX_UNKNOWNS]; //!< inv(A' W A) of the last solution
+    int d_unknowns;                                       //!< Unknowns of the last solution (4 or 5)
+    bool d_valid;                                         //!< d_pos is used to start the next solution
+    int d_iterations;                                     //!< Iterations used by the last solution
+
+private:
+    static bool cholesky_decomposition(const double N[LS_PVT_MAX_UNKNOWNS][LS_PVT_MAX_UNKNOWNS], double L[LS_PVT_MAX_UNKNOWNS][LS_PVT_MAX_UNKNOWNS], int n);
+    static void cholesky_solve(const double L[LS_PVT_MAX_UNKNOWNS][LS_PVT_MAX_UNKNOWNS], const double *b, double *x, int n);
+    static void togeod(double *dphi, double *dlambda, double *h, double a, double finv, double X, double Y, double Z);
+    double d_c_m_s;
+};
+
+#endif
@@ -133,6 +133,15 @@ void Nmea_Printer::close_serial ()
 
 
 bool Nmea_Printer::Print_Nmea_Line(gps_l1_ca_ls_pvt* pvt_data, bool print_average_values)
+{
+    Pvt_Output_Record record;
+    record.set_solution(pvt_data);
+    return Print_Nmea_Line(record, print_average_values);
+}
+
+
+
+bool Nmea_Printer::Print_Nmea_Line(const Pvt_Output_Record& pvt_data, bool print_average_values)
 {
     std::string GPRMC;
     std::string GPGGA;
@@ -140,7 +149,7 @@ bool Nmea_Printer::Print_Nmea_Line(gps_l1_ca_ls_pvt* pvt_data, bool print_averag
     std::string GPGSV;
 
     // set the new PVT data
-    d_PVT_data = pvt_data;
+    d_PVT_data = &pvt_data;
 
     // generate the NMEA sentences
 
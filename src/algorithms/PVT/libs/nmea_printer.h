@@ -41,6 +41,7 @@
 #include <fstream>
 #include <string>
 #include "gps_l1_ca_ls_pvt.h"
+#include "pvt_output_record.h"
 
 
 /*!
@@ -62,6 +63,11 @@ public:
      */
     bool Print_Nmea_Line(gps_l1_ca_ls_pvt* position, bool print_average_values);
 
+    /*!
+     * \brief Print NMEA PVT and satellite info of a fix copied by the PVT block
+     */
+    bool Print_Nmea_Line(const Pvt_Output_Record& position, bool print_average_values);
+
     /*!
      * \brief Default destructor.
      */
@@ -72,7 +78,7 @@ private:
     std::ofstream nmea_file_descriptor; // Output file stream for NMEA log file
     std::string nmea_devname;
     int nmea_dev_descriptor; // NMEA serial device descriptor (i.e. COM port)
-    gps_l1_ca_ls_pvt* d_PVT_data;
+    const Pvt_Output_Record* d_PVT_data;
     int init_serial (std::string serial_device); //serial port control
     void close_serial ();
     std::string get_GPGGA(); // fix data
@@ -0,0 +1,156 @@
+/*!
+ * \file observables_dump_reader.cc
+ * \brief Read-only, memory-mapped access to the dump file of the GPS L1 C/A
+ * observables block
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "observables_dump_reader.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+
+Observables_Dump_Reader::Observables_Dump_Reader() :
+        d_map(0),
+        d_map_size(0),
+        d_data(0),
+        d_nchannels(0),
+        d_epochs(0)
+{}
+
+
+
+Observables_Dump_Reader::~Observables_Dump_Reader()
+{
+    close();
+}
+
+
+
+bool Observables_Dump_Reader::open(std::string filename, unsigned int nchannels)
+{
+    close();
+    if (nchannels == 0)
+        {
+            LOG(WARNING) << "Observables dump " << filename << ": the number of channels must be at least 1";
+            return false;
+        }
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        {
+            LOG(WARNING) << "Unable to open the observables dump " << filename << ": " << strerror(errno);
+            return false;
+        }
+    struct stat file_status;
+    if (fstat(fd, &file_status) != 0)
+        {
+            LOG(WARNING) << "Unable to read the size of the observables dump " << filename << ": " << strerror(errno);
+            ::close(fd);
+            return false;
+        }
+    size_t epoch_size = nchannels * OBSERVABLES_DUMP_FIELDS * sizeof(double);
+    unsigned long int epochs = file_status.st_size / epoch_size;
+    if (epochs == 0)
+        {
+            LOG(WARNING) << "The observables dump " << filename << " has no complete epoch for " << nchannels << " channels";
+            ::close(fd);
+            return false;
+        }
+    d_map_size = file_status.st_size;
+    d_map = mmap(0, d_map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file
+    if (d_map == MAP_FAILED)
+        {
+            LOG(WARNING) << "Unable to map the observables dump " << filename << ": " << strerror(errno);
+            d_map = 0;
+            d_map_size = 0;
+            return false;
+        }
+    // the epochs are usually read in order, by blocks
+    madvise(d_map, d_map_size, MADV_SEQUENTIAL);
+    d_data = (const double*)d_map;
+    d_nchannels = nchannels;
+    d_epochs = epochs;
+    if ((unsigned long int)file_status.st_size != epochs * epoch_size)
+        {
+            LOG(WARNING) << "The last epoch of the observables dump " << filename << " is incomplete";
+        }
+    LOG(INFO) << "Observables dump " << filename << ": " << d_epochs << " epochs of " << d_nchannels << " channels";
+    return true;
+}
+
+
+
+void Observables_Dump_Reader::close()
+{
+    if (d_map != 0)
+        {
+            munmap(d_map, d_map_size);
+        }
+    d_map = 0;
+    d_map_size = 0;
+    d_data = 0;
+    d_nchannels = 0;
+    d_epochs = 0;
+}
+
+
+
+double Observables_Dump_Reader::get_epoch(unsigned long int epoch, std::map<int,Gnss_Synchro> &gnss_pseudoranges_map) const
+{
+    gnss_pseudoranges_map.clear();
+    double rx_time = 0.0;
+    if (epoch >= d_epochs) return rx_time;
+    const double *channel = d_data + epoch * d_nchannels * OBSERVABLES_DUMP_FIELDS;
+    for (unsigned int i = 0; i < d_nchannels; i++, channel += OBSERVABLES_DUMP_FIELDS)
+        {
+            if (channel[3] != 0.0)
+                {
+                    Gnss_Synchro gnss_synchro;
+                    gnss_synchro.System = 'G';
+                    gnss_synchro.Channel_ID = i;
+                    gnss_synchro.d_TOW_at_current_symbol = channel[0];
+                    gnss_synchro.Prn_timestamp_ms = channel[1];
+                    gnss_synchro.Pseudorange_m = channel[2];
+                    gnss_synchro.Flag_valid_pseudorange = true;
+                    gnss_synchro.PRN = (unsigned int)channel[4];
+                    // the other observables are not in the dump
+                    gnss_synchro.Carrier_phase_rads = 0.0;
+                    gnss_synchro.Carrier_Doppler_hz = 0.0;
+                    gnss_synchro.CN0_dB_hz = 0.0;
+                    gnss_pseudoranges_map.insert(std::pair<int,Gnss_Synchro>(gnss_synchro.PRN, gnss_synchro));
+                    rx_time = channel[0]; // all the channels have the same RX timestamp (common RX time pseudoranges)
+                }
+        }
+    return rx_time;
+}
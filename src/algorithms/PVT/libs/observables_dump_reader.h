@@ -0,0 +1,83 @@
+/*!
+ * \file observables_dump_reader.h
+ * \brief Read-only, memory-mapped access to the dump file of the GPS L1 C/A
+ * observables block
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_OBSERVABLES_DUMP_READER_H_
+#define GNSS_SDR_OBSERVABLES_DUMP_READER_H_
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include "gnss_synchro.h"
+
+/*!
+ * \brief Doubles written per channel and epoch by gps_l1_ca_observables_cc:
+ * d_TOW_at_current_symbol, Prn_timestamp_ms, Pseudorange_m, Flag_valid_pseudorange and PRN
+ */
+#define OBSERVABLES_DUMP_FIELDS 5
+
+
+/*!
+ * \brief Maps an observables dump file in memory and rebuilds the
+ * pseudoranges map of any epoch, as the PVT block receives it.
+ *
+ * The file is only read, so get_epoch() can be called from several threads at once.
+ */
+class Observables_Dump_Reader
+{
+public:
+    Observables_Dump_Reader();
+    ~Observables_Dump_Reader();
+
+    /*!
+     * \brief Maps the dump of an observables block with nchannels channels.
+     * Returns false if the file can not be mapped. A truncated last epoch is ignored.
+     */
+    bool open(std::string filename, unsigned int nchannels);
+    void close();
+
+    unsigned long int epochs() const { return d_epochs; }
+    unsigned int channels() const { return d_nchannels; }
+
+    /*!
+     * \brief Fills gnss_pseudoranges_map with the valid pseudoranges of the
+     * epoch, keyed by PRN, and returns their common RX time (TOW) [s], or 0
+     * if no channel has a valid pseudorange
+     */
+    double get_epoch(unsigned long int epoch, std::map<int,Gnss_Synchro> &gnss_pseudoranges_map) const;
+
+private:
+    void *d_map;
+    size_t d_map_size;
+    const double *d_data;
+    unsigned int d_nchannels;
+    unsigned long int d_epochs;
+};
+
+#endif
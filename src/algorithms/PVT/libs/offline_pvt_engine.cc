@@ -0,0 +1,256 @@
+/*!
+ * \file offline_pvt_engine.cc
+ * \brief Computes the GPS L1 C/A PVT fixes of an observables dump file on
+ * several threads, and writes them with the outputs of the PVT block
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "offline_pvt_engine.h"
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+
+Offline_Pvt_Engine::Offline_Pvt_Engine(int nchannels, int epoch_period_ms, int output_rate_ms, int averaging_depth, bool flag_averaging, int nthreads) : d_batch_ls_solver(GPS_C_m_s)
+{
+    if (epoch_period_ms < 1) epoch_period_ms = 1;
+    if (output_rate_ms < epoch_period_ms or (output_rate_ms % epoch_period_ms) != 0)
+        {
+            LOG(WARNING) << "The PVT output rate (" << output_rate_ms << " ms) must be a multiple of the epoch period ("
+                         << epoch_period_ms << " ms). Computing a fix every epoch.";
+            output_rate_ms = epoch_period_ms;
+        }
+    if (nthreads < 1) nthreads = 1;
+    d_epoch_period_ms = epoch_period_ms;
+    d_output_rate_ms = output_rate_ms;
+    d_averaging_depth = averaging_depth;
+    d_flag_averaging = flag_averaging;
+    d_workers.resize(nthreads);
+    for (int i = 0; i < nthreads; i++)
+        {
+            d_workers[i].pvt = new gps_l1_ca_ls_pvt(nchannels, "", false);
+            d_workers[i].pvt->set_averaging_depth(averaging_depth);
+            d_workers[i].next_fix = 0;
+        }
+    d_slots.resize(OFFLINE_PVT_BATCH_FIXES);
+    d_valid.resize(OFFLINE_PVT_BATCH_FIXES);
+    d_batch_state_fix = 0; // a new gps_l1_ca_ls_pvt
+}
+
+
+
+Offline_Pvt_Engine::~Offline_Pvt_Engine()
+{
+    for (unsigned int i = 0; i < d_workers.size(); i++)
+        {
+            delete d_workers[i].pvt;
+        }
+}
+
+
+
+void Offline_Pvt_Engine::set_gps_navigation(const std::map<int,Gps_Ephemeris>& gps_ephemeris_map, const Gps_Iono& gps_iono, const Gps_Utc_Model& gps_utc_model)
+{
+    d_gps_ephemeris_map = gps_ephemeris_map;
+    d_gps_iono = gps_iono;
+    d_gps_utc_model = gps_utc_model;
+    for (unsigned int i = 0; i < d_workers.size(); i++)
+        {
+            d_workers[i].pvt->gps_ephemeris_map = gps_ephemeris_map;
+            d_workers[i].pvt->gps_iono = gps_iono;
+            d_workers[i].pvt->gps_utc_model = gps_utc_model;
+            d_workers[i].pvt->d_position_cache.clear();
+        }
+}
+
+
+
+unsigned long int Offline_Pvt_Engine::fixes(const Observables_Dump_Reader& reader) const
+{
+    return reader.epochs() / (d_output_rate_ms / d_epoch_period_ms);
+}
+
+
+
+bool Offline_Pvt_Engine::solve_fix(gps_l1_ca_ls_pvt *pvt, const Observables_Dump_Reader& reader, unsigned long int fix, Pvt_Output_Record *record)
+{
+    // the PVT block computes a fix when its sample counter, increased by
+    // epoch_period_ms at each epoch, is a multiple of output_rate_ms
+    unsigned long int sample_counter = (fix + 1) * d_output_rate_ms;
+    unsigned long int epoch = sample_counter / d_epoch_period_ms - 1;
+    std::map<int,Gnss_Synchro> gnss_pseudoranges_map;
+    double rx_time = reader.get_epoch(epoch, gnss_pseudoranges_map);
+    if (gnss_pseudoranges_map.size() == 0) return false;
+    if (pvt->get_PVT(gnss_pseudoranges_map, rx_time, d_flag_averaging) == false) return false;
+    if (record != 0)
+        {
+            record->type = PVT_OUTPUT_GPS_FIX;
+            record->sample_counter = sample_counter;
+            record->rx_time = rx_time;
+            record->set_solution(pvt);
+            record->set_observables(gnss_pseudoranges_map);
+        }
+    return true;
+}
+
+
+
+void Offline_Pvt_Engine::save_batch_state(const gps_l1_ca_ls_pvt *pvt, unsigned long int fix)
+{
+    d_batch_state_fix = fix;
+    d_batch_hist_latitude_d = pvt->d_hist_latitude_d;
+    d_batch_hist_longitude_d = pvt->d_hist_longitude_d;
+    d_batch_hist_height_m = pvt->d_hist_height_m;
+    d_batch_ls_solver = pvt->d_ls_solver;
+}
+
+
+
+void Offline_Pvt_Engine::restore_batch_state(gps_l1_ca_ls_pvt *pvt) const
+{
+    pvt->d_hist_latitude_d = d_batch_hist_latitude_d;
+    pvt->d_hist_longitude_d = d_batch_hist_longitude_d;
+    pvt->d_hist_height_m = d_batch_hist_height_m;
+    pvt->d_ls_solver = d_batch_ls_solver;
+}
+
+
+
+void Offline_Pvt_Engine::solve_range(Worker *worker, const Observables_Dump_Reader *reader, unsigned long int begin, unsigned long int end, unsigned long int first_fix)
+{
+    if (begin >= end) return;
+    if (worker->next_fix != begin)
+        {
+            // start over from the fixes before the range, as if it followed them:
+            // the averaging window has to hold the last averaging_depth valid fixes,
+            // and the solver has to start from the last valid one. The epochs
+            // without fix are skipped by widening the warm-up until then, but
+            // not before the batch, whose starting state is known.
+            unsigned long int window = d_flag_averaging ? d_averaging_depth : 1;
+            while (true)
+                {
+                    unsigned long int first = (begin > d_batch_state_fix + window) ? begin - window : d_batch_state_fix;
+                    if (first == d_batch_state_fix)
+                        {
+                            restore_batch_state(worker->pvt);
+                        }
+                    else
+                        {
+                            worker->pvt->d_hist_latitude_d.clear();
+                            worker->pvt->d_hist_longitude_d.clear();
+                            worker->pvt->d_hist_height_m.clear();
+                            worker->pvt->d_ls_solver.reset();
+                        }
+                    bool valid_fix = false;
+                    for (unsigned long int fix = first; fix < begin; fix++)
+                        {
+                            valid_fix = solve_fix(worker->pvt, *reader, fix, 0) or valid_fix;
+                        }
+                    if (first == d_batch_state_fix) break;
+                    if (d_flag_averaging and worker->pvt->d_hist_longitude_d.size() == (unsigned int)d_averaging_depth) break;
+                    if (!d_flag_averaging and valid_fix) break;
+                    window = 2 * window;
+                }
+        }
+    for (unsigned long int fix = begin; fix < end; fix++)
+        {
+            d_valid[fix - first_fix] = solve_fix(worker->pvt, *reader, fix, &d_slots[fix - first_fix]);
+        }
+    worker->next_fix = end;
+}
+
+
+
+void Offline_Pvt_Engine::solve(const Observables_Dump_Reader& reader, unsigned long int first_fix, unsigned long int n_fixes, std::vector<Pvt_Output_Record>& records)
+{
+    records.clear();
+    unsigned long int last_fix = first_fix + n_fixes;
+    if (last_fix > fixes(reader)) last_fix = fixes(reader);
+    if (first_fix < d_batch_state_fix)
+        {
+            // going back: start from the state of a new gps_l1_ca_ls_pvt
+            d_batch_state_fix = 0;
+            d_batch_hist_latitude_d.clear();
+            d_batch_hist_longitude_d.clear();
+            d_batch_hist_height_m.clear();
+            d_batch_ls_solver.reset();
+        }
+    for (unsigned long int batch = first_fix; batch < last_fix; batch += OFFLINE_PVT_BATCH_FIXES)
+        {
+            unsigned long int batch_end = batch + OFFLINE_PVT_BATCH_FIXES;
+            if (batch_end > last_fix) batch_end = last_fix;
+            unsigned long int n_workers = d_workers.size();
+            unsigned long int range = (batch_end - batch + n_workers - 1) / n_workers;
+
+            // the calling thread solves the first range
+            boost::thread_group threads;
+            unsigned long int last_worker = 0;
+            for (unsigned long int i = 1; i < n_workers; i++)
+                {
+                    unsigned long int begin = std::min(batch + i * range, batch_end);
+                    unsigned long int end = std::min(begin + range, batch_end);
+                    if (begin < end)
+                        {
+                            threads.create_thread(boost::bind(&Offline_Pvt_Engine::solve_range, this, &d_workers[i], &reader, begin, end, batch));
+                            last_worker = i;
+                        }
+                }
+            solve_range(&d_workers[0], &reader, batch, std::min(batch + range, batch_end), batch);
+            threads.join_all();
+            // the worker of the last range holds the state at the start of the next batch
+            save_batch_state(d_workers[last_worker].pvt, batch_end);
+
+            for (unsigned long int fix = batch; fix < batch_end; fix++)
+                {
+                    if (d_valid[fix - batch]) records.push_back(d_slots[fix - batch]);
+                }
+        }
+}
+
+
+
+unsigned long int Offline_Pvt_Engine::run(const Observables_Dump_Reader& reader, Pvt_Output_Sink& sink)
+{
+    sink.set_gps_navigation(d_gps_ephemeris_map, d_gps_iono, d_gps_utc_model);
+    unsigned long int n_fixes = fixes(reader);
+    unsigned long int valid_fixes = 0;
+    std::vector<Pvt_Output_Record> records;
+    for (unsigned long int batch = 0; batch < n_fixes; batch += OFFLINE_PVT_BATCH_FIXES)
+        {
+            solve(reader, batch, OFFLINE_PVT_BATCH_FIXES, records);
+            for (unsigned int i = 0; i < records.size(); i++)
+                {
+                    sink.write_record(records[i]);
+                }
+            valid_fixes += records.size();
+            LOG(INFO) << "Offline PVT: " << std::min(batch + OFFLINE_PVT_BATCH_FIXES, n_fixes) << " of " << n_fixes << " epochs solved, "
+                      << valid_fixes << " valid fixes";
+        }
+    return valid_fixes;
+}
@@ -0,0 +1,131 @@
+/*!
+ * \file offline_pvt_engine.h
+ * \brief Computes the GPS L1 C/A PVT fixes of an observables dump file on
+ * several threads, and writes them with the outputs of the PVT block
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_OFFLINE_PVT_ENGINE_H_
+#define GNSS_SDR_OFFLINE_PVT_ENGINE_H_
+
+#include <deque>
+#include <map>
+#include <vector>
+#include "gps_ephemeris.h"
+#include "gps_iono.h"
+#include "gps_utc_model.h"
+#include "gps_l1_ca_ls_pvt.h"
+#include "ls_pvt_solver.h"
+#include "observables_dump_reader.h"
+#include "pvt_output_record.h"
+#include "pvt_output_sink.h"
+
+#define OFFLINE_PVT_BATCH_FIXES 1024 // fixes solved in parallel before they are written
+
+
+/*!
+ * \brief Offline GPS L1 C/A PVT over an Observables_Dump_Reader.
+ *
+ * The fixes are computed at the same epochs and with the same gps_l1_ca_ls_pvt
+ * as in gps_l1_ca_pvt_cc: one every output_rate_ms, the observables epochs
+ * being epoch_period_ms apart (Observables.output_rate_ms).
+ *
+ * The fixes are solved by batches of OFFLINE_PVT_BATCH_FIXES. Each thread
+ * solves a contiguous range of a batch with its own gps_l1_ca_ls_pvt. The
+ * least squares fixes are independent, but the moving average and the warm
+ * start of the solver use the previous fixes, so a thread that does not
+ * continue its previous range first solves the fixes before the new one,
+ * going back until averaging_depth of them are valid, and discards them.
+ * The fixes are then the same as those of the PVT block.
+ *
+ * The state of the PVT block at the start of the batch (moving average
+ * window and solver) is kept from the previous batch: the first range starts
+ * from it without warm-up, and the warm-up of the other ranges never goes
+ * back before the batch, however long the epochs without fix before it.
+ */
+class Offline_Pvt_Engine
+{
+public:
+    Offline_Pvt_Engine(int nchannels, int epoch_period_ms, int output_rate_ms, int averaging_depth, bool flag_averaging, int nthreads);
+    ~Offline_Pvt_Engine();
+
+    /*!
+     * \brief Sets the navigation data used by every fix
+     */
+    void set_gps_navigation(const std::map<int,Gps_Ephemeris>& gps_ephemeris_map, const Gps_Iono& gps_iono, const Gps_Utc_Model& gps_utc_model);
+
+    /*!
+     * \brief Number of fixes (output epochs) in the dump
+     */
+    unsigned long int fixes(const Observables_Dump_Reader& reader) const;
+
+    /*!
+     * \brief Solves the fixes first_fix to first_fix + n_fixes - 1 and stores
+     * the valid ones in records, in order
+     */
+    void solve(const Observables_Dump_Reader& reader, unsigned long int first_fix, unsigned long int n_fixes, std::vector<Pvt_Output_Record>& records);
+
+    /*!
+     * \brief Solves every fix of the dump and writes the valid ones to the
+     * KML, NMEA and RINEX outputs of sink. Returns the number of valid fixes.
+     */
+    unsigned long int run(const Observables_Dump_Reader& reader, Pvt_Output_Sink& sink);
+
+private:
+    struct Worker
+    {
+        gps_l1_ca_ls_pvt *pvt;
+        unsigned long int next_fix; //!< Fix that follows the last one solved by pvt
+    };
+
+    void solve_range(Worker *worker, const Observables_Dump_Reader *reader, unsigned long int begin, unsigned long int end, unsigned long int first_fix);
+    void save_batch_state(const gps_l1_ca_ls_pvt *pvt, unsigned long int fix);
+    void restore_batch_state(gps_l1_ca_ls_pvt *pvt) const;
+    bool solve_fix(gps_l1_ca_ls_pvt *pvt, const Observables_Dump_Reader& reader, unsigned long int fix, Pvt_Output_Record *record);
+
+    int d_epoch_period_ms;
+    int d_output_rate_ms;
+    int d_averaging_depth;
+    bool d_flag_averaging;
+    std::vector<Worker> d_workers;
+
+    std::map<int,Gps_Ephemeris> d_gps_ephemeris_map;
+    Gps_Iono d_gps_iono;
+    Gps_Utc_Model d_gps_utc_model;
+
+    // results of the current batch, one slot per fix
+    std::vector<Pvt_Output_Record> d_slots;
+    std::vector<char> d_valid;
+
+    // state of the PVT block before d_batch_state_fix, the first fix of the next batch
+    unsigned long int d_batch_state_fix;
+    std::deque<double> d_batch_hist_latitude_d;
+    std::deque<double> d_batch_hist_longitude_d;
+    std::deque<double> d_batch_hist_height_m;
+    Ls_Pvt_Solver d_batch_ls_solver;
+};
+
+#endif
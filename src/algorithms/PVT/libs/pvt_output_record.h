@@ -0,0 +1,148 @@
+/*!
+ * \file pvt_output_record.h
+ * \brief Fixed-size copy of a PVT solution and of the observables of its
+ * epoch, handed by the PVT blocks to the Pvt_Output_Sink
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PVT_OUTPUT_RECORD_H_
+#define GNSS_SDR_PVT_OUTPUT_RECORD_H_
+
+#include <map>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include "gnss_synchro.h"
+#include "ls_pvt_solver.h"
+
+#define PVT_OUTPUT_MAX_SATELLITES LS_PVT_MAX_SATELLITES
+
+/*!
+ * \brief Systems of the solutions carried by a Pvt_Output_Record
+ */
+enum Pvt_Output_Record_Type
+{
+    PVT_OUTPUT_GPS_FIX = 0,     //!< GPS L1 C/A fix: KML, NMEA and RINEX outputs
+    PVT_OUTPUT_GALILEO_FIX = 1, //!< Galileo E1 fix: KML output
+    PVT_OUTPUT_HYBRID_FIX = 2   //!< GPS L1 C/A and Galileo E1 fix: KML output
+};
+
+/*!
+ * \brief Everything the KML, NMEA and RINEX printers need from one fix.
+ *
+ * The solution members have the same names as in gps_l1_ca_ls_pvt,
+ * galileo_e1_ls_pvt and hybrid_ls_pvt. The record has no pointers, so it can be copied into
+ * a concurrent_bounded_queue without allocating memory.
+ */
+struct Pvt_Output_Record
+{
+    int type;                             //!< One of Pvt_Output_Record_Type
+    long unsigned int sample_counter;     //!< Receiver time of the epoch [ms]
+    double rx_time;                       //!< RX time of the epoch (TOW) [s]
+
+    boost::posix_time::ptime d_position_UTC_time;
+    bool b_valid_position;
+    bool d_flag_averaging;
+    double d_latitude_d;
+    double d_longitude_d;
+    double d_height_m;
+    double d_avg_latitude_d;
+    double d_avg_longitude_d;
+    double d_avg_height_m;
+    double d_GDOP;
+    double d_PDOP;
+    double d_HDOP;
+    double d_VDOP;
+    double d_TDOP;
+
+    int d_valid_observations;
+    int d_visible_satellites_IDs[PVT_OUTPUT_MAX_SATELLITES];
+    double d_visible_satellites_El[PVT_OUTPUT_MAX_SATELLITES];
+    double d_visible_satellites_Az[PVT_OUTPUT_MAX_SATELLITES];
+    double d_visible_satellites_CN0_dB[PVT_OUTPUT_MAX_SATELLITES];
+
+    int n_observables;                                   //!< Valid entries of observables
+    Gnss_Synchro observables[PVT_OUTPUT_MAX_SATELLITES]; //!< Observables of the epoch, for the RINEX observation file
+
+    /*!
+     * \brief Copies the solution of a gps_l1_ca_ls_pvt, galileo_e1_ls_pvt or hybrid_ls_pvt
+     */
+    template<class Ls_Pvt>
+    void set_solution(const Ls_Pvt *pvt)
+    {
+        d_position_UTC_time = pvt->d_position_UTC_time;
+        b_valid_position = pvt->b_valid_position;
+        d_flag_averaging = pvt->d_flag_averaging;
+        d_latitude_d = pvt->d_latitude_d;
+        d_longitude_d = pvt->d_longitude_d;
+        d_height_m = pvt->d_height_m;
+        d_avg_latitude_d = pvt->d_avg_latitude_d;
+        d_avg_longitude_d = pvt->d_avg_longitude_d;
+        d_avg_height_m = pvt->d_avg_height_m;
+        d_GDOP = pvt->d_GDOP;
+        d_PDOP = pvt->d_PDOP;
+        d_HDOP = pvt->d_HDOP;
+        d_VDOP = pvt->d_VDOP;
+        d_TDOP = pvt->d_TDOP;
+        d_valid_observations = pvt->d_valid_observations;
+        if (d_valid_observations > PVT_OUTPUT_MAX_SATELLITES) d_valid_observations = PVT_OUTPUT_MAX_SATELLITES;
+        for (int i = 0; i < d_valid_observations; i++)
+            {
+                d_visible_satellites_IDs[i] = pvt->d_visible_satellites_IDs[i];
+                d_visible_satellites_El[i] = pvt->d_visible_satellites_El[i];
+                d_visible_satellites_Az[i] = pvt->d_visible_satellites_Az[i];
+                d_visible_satellites_CN0_dB[i] = pvt->d_visible_satellites_CN0_dB[i];
+            }
+    }
+
+    /*!
+     * \brief Copies the observables of the epoch (at most PVT_OUTPUT_MAX_SATELLITES)
+     */
+    void set_observables(const std::map<int,Gnss_Synchro> &gnss_pseudoranges_map)
+    {
+        n_observables = 0;
+        for(std::map<int,Gnss_Synchro>::const_iterator it = gnss_pseudoranges_map.begin();
+                it != gnss_pseudoranges_map.end() and n_observables < PVT_OUTPUT_MAX_SATELLITES;
+                it++)
+            {
+                observables[n_observables] = it->second;
+                n_observables++;
+            }
+    }
+
+    /*!
+     * \brief Rebuilds the observables map, keyed by PRN as in the PVT blocks
+     */
+    std::map<int,Gnss_Synchro> get_observables() const
+    {
+        std::map<int,Gnss_Synchro> gnss_pseudoranges_map;
+        for (int i = 0; i < n_observables; i++)
+            {
+                gnss_pseudoranges_map.insert(std::pair<int,Gnss_Synchro>(observables[i].PRN, observables[i]));
+            }
+        return gnss_pseudoranges_map;
+    }
+};
+
+#endif
@@ -0,0 +1,247 @@
+/*!
+ * \file pvt_output_sink.cc
+ * \brief Thread that formats and writes the KML, NMEA and RINEX outputs of a
+ * PVT block, so the flowgraph never waits for a disk or a serial port
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "pvt_output_sink.h"
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+
+Pvt_Output_Sink::Pvt_Output_Sink(std::string kml_filename, std::string nmea_filename, bool flag_nmea_tty_port, std::string nmea_devname,
+        bool flag_rtcm, std::string rtcm_filename, bool flag_rtcm_server, unsigned short rtcm_tcp_port,
+        bool flag_rtcm_tty_port, std::string rtcm_devname, unsigned short rtcm_station_id) :
+        d_records(PVT_OUTPUT_SINK_CAPACITY),
+        d_written(0),
+        d_pushed(0),
+        d_popped(0),
+        b_rinex_header_writen(false),
+        b_rinex_sbs_header_writen(false),
+        d_last_sample_nav_output(0),
+        d_rtcm_printer(0),
+        b_rtcm_nav_writen(false),
+        d_last_sample_rtcm_nav_output(0),
+        d_stop(false)
+{
+    d_kml_dump.set_headers(kml_filename);
+    d_nmea_printer = new Nmea_Printer(nmea_filename, flag_nmea_tty_port, nmea_devname);
+    rp = new Rinex_Printer();
+    if (flag_rtcm)
+        {
+            d_rtcm_printer = new Rtcm_Printer(rtcm_filename, flag_rtcm_tty_port, rtcm_devname, flag_rtcm_server, rtcm_tcp_port, rtcm_station_id);
+        }
+    d_thread = boost::thread(&Pvt_Output_Sink::run, this);
+}
+
+
+
+Pvt_Output_Sink::~Pvt_Output_Sink()
+{
+    {
+        boost::mutex::scoped_lock lock(d_wakeup_mutex);
+        d_stop = true;
+    }
+    d_wakeup.notify_one();
+    d_thread.join();
+    flush();
+    d_kml_dump.close_file();
+    delete d_nmea_printer;
+    delete rp;
+    delete d_rtcm_printer;
+    if (d_records.dropped_items() > 0)
+        {
+            LOG(WARNING) << "PVT output: " << d_records.dropped_items() << " fixes dropped, "
+                         << d_written.load(std::memory_order_relaxed) << " fixes written";
+        }
+}
+
+
+
+void Pvt_Output_Sink::set_gps_navigation(const std::map<int,Gps_Ephemeris>& gps_ephemeris_map, const Gps_Iono& gps_iono, const Gps_Utc_Model& gps_utc_model)
+{
+    Navigation_Update update;
+    update.first_record = d_pushed.load(std::memory_order_acquire);
+    update.gps_ephemeris_map = gps_ephemeris_map;
+    update.gps_iono = gps_iono;
+    update.gps_utc_model = gps_utc_model;
+    boost::mutex::scoped_lock lock(d_navigation_mutex);
+    d_navigation_updates.push_back(update);
+}
+
+
+
+void Pvt_Output_Sink::push_sbas(const Sbas_Raw_Msg& sbas_raw_msg)
+{
+    d_sbas_messages.push(sbas_raw_msg);
+}
+
+
+
+void Pvt_Output_Sink::flush()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+
+    // each record is written with the navigation data set before it was pushed
+    Pvt_Output_Record record;
+    while (d_records.try_pop(record))
+        {
+            update_navigation(d_popped);
+            write(record);
+            d_popped++;
+        }
+    update_navigation(d_popped);
+
+    Sbas_Raw_Msg sbas_raw_msg;
+    while (d_sbas_messages.try_pop(sbas_raw_msg))
+        {
+            // create the header of not yet done
+            if(!b_rinex_sbs_header_writen)
+                {
+                    rp->rinex_sbs_header(rp->sbsFile);
+                    b_rinex_sbs_header_writen = true;
+                }
+            rp->log_rinex_sbs(rp->sbsFile, sbas_raw_msg);
+        }
+}
+
+
+
+void Pvt_Output_Sink::write_record(const Pvt_Output_Record& record)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    update_navigation(d_pushed.load(std::memory_order_acquire));
+    write(record);
+}
+
+
+
+void Pvt_Output_Sink::update_navigation(unsigned long long next_record)
+{
+    boost::mutex::scoped_lock navigation_lock(d_navigation_mutex);
+    while (!d_navigation_updates.empty() and d_navigation_updates.front().first_record <= next_record)
+        {
+            d_gps_ephemeris_map.swap(d_navigation_updates.front().gps_ephemeris_map);
+            d_gps_iono = d_navigation_updates.front().gps_iono;
+            d_gps_utc_model = d_navigation_updates.front().gps_utc_model;
+            d_navigation_updates.pop_front();
+        }
+}
+
+
+
+void Pvt_Output_Sink::run()
+{
+    const boost::posix_time::milliseconds period(PVT_OUTPUT_SINK_PERIOD_MS);
+    while (true)
+        {
+            {
+                boost::mutex::scoped_lock lock(d_wakeup_mutex);
+                if (d_stop) break;
+                d_wakeup.timed_wait(lock, period);
+                if (d_stop) break;
+            }
+            flush();
+        }
+}
+
+
+
+void Pvt_Output_Sink::write(const Pvt_Output_Record& record)
+{
+    switch (record.type)
+    {
+    case PVT_OUTPUT_GPS_FIX:
+        d_kml_dump.print_position(record, record.d_flag_averaging);
+        d_nmea_printer->Print_Nmea_Line(record, record.d_flag_averaging);
+        write_rinex(record);
+        write_rtcm(record);
+        break;
+    case PVT_OUTPUT_GALILEO_FIX:
+        //ToDo: Implement Galileo RINEX and Galileo NMEA outputs
+    case PVT_OUTPUT_HYBRID_FIX:
+        // the NMEA and RINEX printers handle GPS fixes only
+        d_kml_dump.print_position(record, record.d_flag_averaging);
+        break;
+    default:
+        LOG(WARNING) << "Unknown PVT output record type " << record.type;
+        return;
+    }
+    d_written.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+
+void Pvt_Output_Sink::write_rinex(const Pvt_Output_Record& record)
+{
+    std::map<int,Gps_Ephemeris>::iterator gps_ephemeris_iter = d_gps_ephemeris_map.begin();
+    if (gps_ephemeris_iter == d_gps_ephemeris_map.end())
+        {
+            return;
+        }
+    if (!b_rinex_header_writen) //  & we have utc data in nav message!
+        {
+            rp->rinex_obs_header(rp->obsFile, gps_ephemeris_iter->second, record.rx_time);
+            rp->rinex_nav_header(rp->navFile, d_gps_iono, d_gps_utc_model);
+            b_rinex_header_writen = true; // do not write header anymore
+        }
+    // Limit the RINEX navigation output rate
+    if ((record.sample_counter - d_last_sample_nav_output) >= PVT_OUTPUT_SINK_RINEX_NAV_PERIOD_MS)
+        {
+            rp->log_rinex_nav(rp->navFile, d_gps_ephemeris_map);
+            d_last_sample_nav_output = record.sample_counter;
+        }
+    rp->log_rinex_obs(rp->obsFile, gps_ephemeris_iter->second, record.rx_time, record.get_observables());
+}
+
+
+
+void Pvt_Output_Sink::write_rtcm(const Pvt_Output_Record& record)
+{
+    if (d_rtcm_printer == 0) return;
+    // the station position and the ephemerides go before the observables, and are repeated for the clients that connect later
+    if (!b_rtcm_nav_writen or (record.sample_counter - d_last_sample_rtcm_nav_output) >= PVT_OUTPUT_SINK_RTCM_NAV_PERIOD_MS)
+        {
+            if (record.d_flag_averaging)
+                {
+                    d_rtcm_printer->print_M1005(record.d_avg_latitude_d, record.d_avg_longitude_d, record.d_avg_height_m);
+                }
+            else
+                {
+                    d_rtcm_printer->print_M1005(record.d_latitude_d, record.d_longitude_d, record.d_height_m);
+                }
+            for(std::map<int,Gps_Ephemeris>::const_iterator it = d_gps_ephemeris_map.begin(); it != d_gps_ephemeris_map.end(); it++)
+                {
+                    d_rtcm_printer->print_M1019(it->second);
+                }
+            b_rtcm_nav_writen = true;
+            d_last_sample_rtcm_nav_output = record.sample_counter;
+        }
+    d_rtcm_printer->print_MSM4(record.get_observables(), record.rx_time);
+}
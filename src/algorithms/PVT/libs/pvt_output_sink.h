@@ -0,0 +1,181 @@
+/*!
+ * \file pvt_output_sink.h
+ * \brief Thread that formats and writes the KML, NMEA and RINEX outputs of a
+ * PVT block, so the flowgraph never waits for a disk or a serial port
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PVT_OUTPUT_SINK_H_
+#define GNSS_SDR_PVT_OUTPUT_SINK_H_
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <string>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include "concurrent_bounded_queue.h"
+#include "concurrent_queue.h"
+#include "gps_ephemeris.h"
+#include "gps_iono.h"
+#include "gps_utc_model.h"
+#include "sbas_telemetry_data.h"
+#include "kml_printer.h"
+#include "nmea_printer.h"
+#include "rinex_printer.h"
+#include "rtcm_printer.h"
+#include "pvt_output_record.h"
+
+#define PVT_OUTPUT_SINK_CAPACITY 256        // records (more than 25 s of fixes at 10 Hz)
+#define PVT_OUTPUT_SINK_PERIOD_MS 20
+#define PVT_OUTPUT_SINK_RINEX_NAV_PERIOD_MS 6000 // RINEX navigation data is logged at most every 6 s
+#define PVT_OUTPUT_SINK_RTCM_NAV_PERIOD_MS 10000 // RTCM 1005 and 1019 messages are sent every 10 s
+
+
+/*!
+ * \brief Output subsystem of a PVT block.
+ *
+ * The PVT block pushes one Pvt_Output_Record per fix into a lock-free bounded
+ * queue, and the sink thread writes it to every output: the KML file, the NMEA
+ * file and serial port, the RINEX observation file and, if enabled, the RTCM
+ * file, serial port and TCP server. The navigation data needed by the RINEX
+ * headers and navigation file is handed over with
+ * set_gps_navigation() only when it changes, and the SBAS messages through
+ * push_sbas(). When the sink thread falls behind (a slow disk or a blocked
+ * tty), push() fails and the record is counted as dropped instead of blocking
+ * the flowgraph.
+ *
+ * push() and set_gps_navigation() are called from the same thread (the PVT
+ * block), and the navigation data is applied in order with the records: the
+ * records queued before a set_gps_navigation() call are written with the
+ * previous navigation data.
+ */
+class Pvt_Output_Sink
+{
+public:
+    /*!
+     * \brief Opens the output files and starts the sink thread. If flag_rtcm
+     * is true, the GPS fixes are also sent as RTCM messages: the MSM4
+     * observables of every fix, and the station position and the ephemerides
+     * every PVT_OUTPUT_SINK_RTCM_NAV_PERIOD_MS. An empty rtcm_filename
+     * disables the RTCM file.
+     */
+    Pvt_Output_Sink(std::string kml_filename, std::string nmea_filename, bool flag_nmea_tty_port, std::string nmea_devname,
+            bool flag_rtcm = false, std::string rtcm_filename = "", bool flag_rtcm_server = false, unsigned short rtcm_tcp_port = 2101,
+            bool flag_rtcm_tty_port = false, std::string rtcm_devname = "", unsigned short rtcm_station_id = 1234);
+
+    /*!
+     * \brief Writes the pending records, stops the sink thread and closes the files
+     */
+    ~Pvt_Output_Sink();
+
+    /*!
+     * \brief Queues a fix. Lock-free; returns false (and counts it) if the queue is full.
+     */
+    bool push(const Pvt_Output_Record& record)
+    {
+        if (!d_records.try_push(record)) return false;
+        d_pushed.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+
+    /*!
+     * \brief Copies the GPS navigation data written to the RINEX files, for
+     * the records pushed from now on
+     */
+    void set_gps_navigation(const std::map<int,Gps_Ephemeris>& gps_ephemeris_map, const Gps_Iono& gps_iono, const Gps_Utc_Model& gps_utc_model);
+
+    /*!
+     * \brief Queues an SBAS message, already related to the GPS time, for the RINEX SBAS file
+     */
+    void push_sbas(const Sbas_Raw_Msg& sbas_raw_msg);
+
+    /*!
+     * \brief Writes all the pending records in the calling thread
+     */
+    void flush();
+
+    /*!
+     * \brief Writes a record in the calling thread, without the queue, so it
+     * can not be dropped. Used to write the fixes computed offline, with the
+     * last navigation data.
+     */
+    void write_record(const Pvt_Output_Record& record);
+
+    unsigned long long dropped_records() const { return d_records.dropped_items(); }
+    unsigned long long written_records() const { return d_written.load(std::memory_order_relaxed); }
+
+private:
+    /*!
+     * \brief Navigation data to apply before writing the record number first_record
+     */
+    struct Navigation_Update
+    {
+        unsigned long long first_record;
+        std::map<int,Gps_Ephemeris> gps_ephemeris_map;
+        Gps_Iono gps_iono;
+        Gps_Utc_Model gps_utc_model;
+    };
+
+    void run();
+    void update_navigation(unsigned long long next_record);
+    void write(const Pvt_Output_Record& record);
+    void write_rinex(const Pvt_Output_Record& record);
+    void write_rtcm(const Pvt_Output_Record& record);
+
+    concurrent_bounded_queue<Pvt_Output_Record> d_records;
+    concurrent_queue<Sbas_Raw_Msg> d_sbas_messages;
+    std::atomic<unsigned long long> d_written;
+    std::atomic<unsigned long long> d_pushed;
+
+    // navigation data written by the PVT block
+    boost::mutex d_navigation_mutex;
+    std::deque<Navigation_Update> d_navigation_updates;
+
+    // everything below is only used by the thread that holds d_mutex
+    boost::mutex d_mutex;
+    unsigned long long d_popped;
+    Kml_Printer d_kml_dump;
+    Nmea_Printer *d_nmea_printer;
+    Rinex_Printer *rp;
+    bool b_rinex_header_writen;
+    bool b_rinex_sbs_header_writen;
+    long unsigned int d_last_sample_nav_output;
+    Rtcm_Printer *d_rtcm_printer;
+    bool b_rtcm_nav_writen;
+    long unsigned int d_last_sample_rtcm_nav_output;
+    std::map<int,Gps_Ephemeris> d_gps_ephemeris_map;
+    Gps_Iono d_gps_iono;
+    Gps_Utc_Model d_gps_utc_model;
+
+    boost::mutex d_wakeup_mutex;
+    boost::condition_variable d_wakeup;
+    bool d_stop;
+    boost::thread d_thread;
+};
+
+#endif
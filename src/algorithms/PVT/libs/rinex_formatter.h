@@ -0,0 +1,226 @@
+/*!
+ * \file rinex_formatter.h
+ * \brief Number formatting for the RINEX records, written directly into a
+ * line buffer without streams
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_RINEX_FORMATTER_H_
+#define GNSS_SDR_RINEX_FORMATTER_H_
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#define RINEX_FORMATTER_MAX_DECIMALS 9
+
+
+/*!
+ * \brief Rounds |x| * 10^decimals to the nearest integer (ties to even) from
+ * the exact binary value of x, as printf("%.*f") does.
+ *
+ * x = m * 2^-shift with a 53-bit integer m, so the product by 10^decimals fits
+ * in 84 bits and is kept as hi * 2^64 + lo. Returns false if x is not finite
+ * or the result does not fit in 63 bits.
+ */
+inline bool rinex_fixed_digits(double x, int decimals, unsigned long long &q)
+{
+    static const unsigned long long powers_of_ten[RINEX_FORMATTER_MAX_DECIMALS + 1] = {1ULL, 10ULL, 100ULL,
+            1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL};
+    if (decimals < 0 or decimals > RINEX_FORMATTER_MAX_DECIMALS) return false;
+    const unsigned long long p = powers_of_ten[decimals];
+    const double a = fabs(x);
+    if (!(a < 9.0e18 / (double)p)) return false; // also rejects NaN and infinity
+    if (a == 0.0)
+        {
+            q = 0;
+            return true;
+        }
+    int exponent;
+    const double f = frexp(a, &exponent); // a = f * 2^exponent, 0.5 <= f < 1
+    const unsigned long long m = (unsigned long long)ldexp(f, 53);
+    const int shift = 53 - exponent;
+    if (shift <= 0)
+        {
+            // a is an integer
+            q = (m << -shift) * p;
+            return true;
+        }
+    if (shift >= 84)
+        {
+            // a * 10^decimals < 2^83 / 2^shift < 1/2
+            q = 0;
+            return true;
+        }
+    const unsigned long long p0 = (m & 0xffffffffULL) * p;
+    const unsigned long long t = (p0 >> 32) + (m >> 32) * p;
+    const unsigned long long lo = (p0 & 0xffffffffULL) | (t << 32);
+    const unsigned long long hi = t >> 32;
+    unsigned long long rest_hi, rest_lo, half_hi, half_lo;
+    if (shift >= 64)
+        {
+            q = hi >> (shift - 64);
+            rest_hi = hi & ((1ULL << (shift - 64)) - 1);
+            rest_lo = lo;
+            half_hi = (shift > 64) ? (1ULL << (shift - 65)) : 0;
+            half_lo = (shift > 64) ? 0 : (1ULL << 63);
+        }
+    else
+        {
+            q = (lo >> shift) | (hi << (64 - shift));
+            rest_hi = 0;
+            rest_lo = lo & ((1ULL << shift) - 1);
+            half_hi = 0;
+            half_lo = 1ULL << (shift - 1);
+        }
+    if (rest_hi > half_hi or (rest_hi == half_hi and rest_lo > half_lo) or (rest_hi == half_hi and rest_lo == half_lo and (q & 1)))
+        {
+            q++;
+        }
+    return true;
+}
+
+
+/*!
+ * \brief Appends an integer right-justified in width characters, as
+ * Rinex_Printer::rightJustify(boost::lexical_cast<std::string>(n), width, fill)
+ * does for the numbers that fit
+ */
+inline void rinex_append_int(std::string &line, long n, int width = 0, char fill = ' ')
+{
+    char digits[24];
+    int length = 0;
+    unsigned long long u = (n < 0) ? (unsigned long long)(-(n + 1)) + 1 : (unsigned long long)n;
+    do
+        {
+            digits[length++] = '0' + (char)(u % 10);
+            u /= 10;
+        }
+    while (u != 0);
+    if (n < 0) digits[length++] = '-';
+    for (int i = length; i < width; i++) line += fill;
+    while (length > 0) line += digits[--length];
+}
+
+
+/*!
+ * \brief Appends x in fixed notation with the given number of decimals,
+ * right-justified in width characters (0 for no justification).
+ *
+ * Same result as Rinex_Printer::rightJustify(asString(x, decimals), width),
+ * including the truncation from the left of the numbers that do not fit, but
+ * without streams nor the locale.
+ */
+inline void rinex_append_fixed(std::string &line, double x, int decimals, int width = 0)
+{
+    char buffer[48];
+    int length = 0;
+    unsigned long long q;
+    if (rinex_fixed_digits(x, decimals, q))
+        {
+            // digits are written from the right
+            char *end = buffer + sizeof(buffer);
+            char *c = end;
+            for (int i = 0; i < decimals; i++)
+                {
+                    *--c = '0' + (char)(q % 10);
+                    q /= 10;
+                }
+            if (decimals > 0) *--c = '.';
+            do
+                {
+                    *--c = '0' + (char)(q % 10);
+                    q /= 10;
+                }
+            while (q != 0);
+            if (std::signbit(x)) *--c = '-';
+            length = end - c;
+            if (width > 0 and length > width)
+                {
+                    c += length - width;
+                    length = width;
+                }
+            for (int i = length; i < width; i++) line += ' ';
+            line.append(c, length);
+        }
+    else
+        {
+            std::ostringstream ss;
+            ss << std::fixed << std::setprecision(decimals) << x;
+            std::string s = ss.str();
+            if (width > 0 and (int)s.length() > width) s = s.substr(s.length() - width);
+            for (int i = s.length(); i < width; i++) line += ' ';
+            line += s;
+        }
+}
+
+
+/*!
+ * \brief Appends d in FORTRAN notation in length characters, with expLen
+ * exponent digits, as Rinex_Printer::doub2for(d, length, expLen).
+ * For instance, 156360 with length 18 and expLen 2 is " .156360000000D+06".
+ */
+inline void rinex_append_fortran(std::string &line, double d, int length, int expLen)
+{
+    // sign, point, digits, 'D', exponent sign and expLen exponent digits
+    const int precision = length - expLen - 5;
+    char buffer[64];
+    int n = snprintf(buffer, sizeof(buffer), "%.*e", precision, d);
+    int idx = 0;
+    line += (buffer[0] == '-') ? '-' : ' ';
+    if (buffer[0] == '-') idx = 1;
+    if (n <= 0 or n >= (int)sizeof(buffer) or buffer[idx + 1] != '.')
+        {
+            // not finite
+            line.append(buffer + idx, n - idx);
+            return;
+        }
+    // d.ddddde[+-]xx becomes .dddddD[+-]xx, with the exponent increased by one
+    line += '.';
+    line += buffer[idx];
+    line.append(buffer + idx + 2, precision);
+    long exponent = strtol(buffer + idx + precision + 3, 0, 10);
+    if (d != 0.0) exponent++;
+    line += 'D';
+    if (exponent < 0)
+        {
+            line += '-';
+            exponent = -exponent;
+        }
+    else
+        {
+            line += '+';
+        }
+    // as rightJustify, only the last expLen digits are kept
+    long modulus = 1;
+    for (int i = 0; i < expLen; i++) modulus *= 10;
+    rinex_append_int(line, exponent % modulus, expLen, '0');
+}
+
+#endif
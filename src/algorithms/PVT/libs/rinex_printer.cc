@@ -41,6 +41,7 @@
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <gflags/gflags.h>
 #include <glog/logging.h>
+#include "rinex_formatter.h"
 #include "sbas_telemetry_data.h"
 #include "gps_navigation_message.h"
 #include "gps_ephemeris.h"
@@ -160,6 +161,7 @@ Rinex_Printer::Rinex_Printer()
         }
 
     numberTypesObservations = 2; // Number of available types of observable in the system
+    d_buffer.reserve(RINEX_PRINTER_BUFFER_SIZE);
 }
 
 
@@ -205,6 +207,46 @@ void Rinex_Printer::lengthCheck(std::string line)
 
 
 
+void Rinex_Printer::end_line(std::string& buffer, std::string::size_type line_begin)
+{
+    if (buffer.size() - line_begin != 80)
+        {
+            Rinex_Printer::lengthCheck(buffer.substr(line_begin));
+        }
+    buffer += '\n';
+}
+
+
+
+void Rinex_Printer::append_broadcast_orbit(std::string& buffer, double a, double b, double c, double d)
+{
+    std::string::size_type line_begin = buffer.size();
+    buffer += std::string(version == 2 ? 4 : 5, ' ');
+    rinex_append_fortran(buffer, a, 18, 2);
+    buffer += ' ';
+    rinex_append_fortran(buffer, b, 18, 2);
+    buffer += ' ';
+    rinex_append_fortran(buffer, c, 18, 2);
+    buffer += ' ';
+    rinex_append_fortran(buffer, d, 18, 2);
+    if (version == 2)
+        {
+            buffer += ' ';
+        }
+    Rinex_Printer::end_line(buffer, line_begin);
+}
+
+
+
+bool Rinex_Printer::same_ephemeris(const Gps_Ephemeris& a, const Gps_Ephemeris& b)
+{
+    return (a.i_GPS_week == b.i_GPS_week) and (a.d_Toe == b.d_Toe) and (a.d_Toc == b.d_Toc)
+            and (a.d_IODC == b.d_IODC) and (a.d_sqrt_A == b.d_sqrt_A) and (a.d_e_eccentricity == b.d_e_eccentricity)
+            and (a.d_M_0 == b.d_M_0) and (a.d_A_f0 == b.d_A_f0) and (a.d_A_f1 == b.d_A_f1);
+}
+
+
+
 std::string Rinex_Printer::createFilename(std::string type)
 {
     const std::string stationName = "GSDR"; // 4-character station name designator
@@ -615,298 +657,153 @@ void Rinex_Printer::rinex_sbs_header(std::ofstream& out)
 
 
 
-void Rinex_Printer::log_rinex_nav(std::ofstream& out, std::map<int,Gps_Ephemeris> eph_map)
+void Rinex_Printer::log_rinex_nav(std::ofstream& out, const std::map<int,Gps_Ephemeris>& eph_map)
 {
-    std::string line;
-	std::map<int,Gps_Ephemeris>::iterator gps_ephemeris_iter;
+    // The whole set of records is formatted in d_buffer and written at once.
+    // Only the ephemerides not yet in the file are written.
+    std::string& line = d_buffer;
+    line.clear();
+    std::map<int,Gps_Ephemeris>::const_iterator gps_ephemeris_iter;
 
     for(gps_ephemeris_iter = eph_map.begin();
-    		gps_ephemeris_iter != eph_map.end();
-    		gps_ephemeris_iter++)
-    {
+            gps_ephemeris_iter != eph_map.end();
+            gps_ephemeris_iter++)
+        {
+            const Gps_Ephemeris& eph = gps_ephemeris_iter->second;
+            std::map<int,Gps_Ephemeris>::iterator logged = d_logged_ephemeris.find(eph.i_satellite_PRN);
+            if (logged != d_logged_ephemeris.end() and Rinex_Printer::same_ephemeris(logged->second, eph))
+                {
+                    continue;
+                }
+            d_logged_ephemeris[eph.i_satellite_PRN] = eph;
+
             // -------- SV / EPOCH / SV CLK
-            boost::posix_time::ptime p_utc_time = Rinex_Printer::compute_GPS_time(gps_ephemeris_iter->second,gps_ephemeris_iter->second.d_TOW);
-            std::string timestring = boost::posix_time::to_iso_string(p_utc_time);
-            std::string month (timestring, 4, 2);
-            std::string day (timestring, 6, 2);
-            std::string hour (timestring, 9, 2);
-            std::string minutes (timestring, 11, 2);
-            std::string seconds (timestring, 13, 2);
+            boost::posix_time::ptime p_utc_time = Rinex_Printer::compute_GPS_time(eph, eph.d_TOW);
+            boost::gregorian::date date = p_utc_time.date();
+            boost::posix_time::time_duration time = p_utc_time.time_of_day();
+            std::string::size_type line_begin = line.size();
             if (version == 2)
                 {
-                    line += Rinex_Printer::rightJustify(boost::lexical_cast<std::string>(gps_ephemeris_iter->second.i_satellite_PRN), 2);
-                    line += std::string(1, ' ');
-                    std::string year (timestring, 2, 2);
-                    line += year;
-                    line += std::string(1, ' ');
-                    line += month;
-                    line += std::string(1, ' ');
-                    line += day;
-                    line += std::string(1, ' ');
-                    line += hour;
-                    line += std::string(1, ' ');
-                    line += minutes;
-                    line += std::string(1, ' ');
-                    line += seconds;
-                    line += std::string(1, '.');
-                    std::string decimal = std::string("0");
-                    if (timestring.size() > 16)
-                        {
-                            std::string decimal (timestring, 16, 1);
-                        }
-                    line += decimal;
-                    line += std::string(1, ' ');
-                    line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_A_f0, 18, 2);
-                    line += std::string(1, ' ');
-                    line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_A_f1, 18, 2);
-                    line += std::string(1, ' ');
-                    line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_A_f2, 18, 2);
-                    line += std::string(1, ' ');
+                    rinex_append_int(line, eph.i_satellite_PRN, 2);
+                    line += ' ';
+                    rinex_append_int(line, date.year() % 100, 2, '0');
+                    line += ' ';
+                    rinex_append_int(line, date.month().as_number(), 2, '0');
+                    line += ' ';
+                    rinex_append_int(line, date.day(), 2, '0');
+                    line += ' ';
+                    rinex_append_int(line, time.hours(), 2, '0');
+                    line += ' ';
+                    rinex_append_int(line, time.minutes(), 2, '0');
+                    line += ' ';
+                    rinex_append_int(line, time.seconds(), 2, '0');
+                    line += ".0 ";
+                    rinex_append_fortran(line, eph.d_A_f0, 18, 2);
+                    line += ' ';
+                    rinex_append_fortran(line, eph.d_A_f1, 18, 2);
+                    line += ' ';
+                    rinex_append_fortran(line, eph.d_A_f2, 18, 2);
+                    line += ' ';
                 }
             if (version == 3)
                 {
                     line += satelliteSystem["GPS"];
-                    if (gps_ephemeris_iter->second.i_satellite_PRN < 10)  line += std::string("0");
-                    line += boost::lexical_cast<std::string>(gps_ephemeris_iter->second.i_satellite_PRN);
-                    std::string year (timestring, 0, 4);
-                    line += std::string(1, ' ');
-                    line += year;
-                    line += std::string(1, ' ');
-                    line += month;
-                    line += std::string(1, ' ');
-                    line += day;
-                    line += std::string(1, ' ');
-                    line += hour;
-                    line += std::string(1, ' ');
-                    line += minutes;
-                    line += std::string(1, ' ');
-                    line += seconds;
-                    line += std::string(1, ' ');
-                    line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_A_f0, 18, 2);
-                    line += std::string(1, ' ');
-                    line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_A_f1, 18, 2);
-                    line += std::string(1, ' ');
-                    line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_A_f2, 18, 2);
+                    rinex_append_int(line, eph.i_satellite_PRN, 2, '0');
+                    line += ' ';
+                    rinex_append_int(line, date.year(), 4, '0');
+                    line += ' ';
+                    rinex_append_int(line, date.month().as_number(), 2, '0');
+                    line += ' ';
+                    rinex_append_int(line, date.day(), 2, '0');
+                    line += ' ';
+                    rinex_append_int(line, time.hours(), 2, '0');
+                    line += ' ';
+                    rinex_append_int(line, time.minutes(), 2, '0');
+                    line += ' ';
+                    rinex_append_int(line, time.seconds(), 2, '0');
+                    line += ' ';
+                    rinex_append_fortran(line, eph.d_A_f0, 18, 2);
+                    line += ' ';
+                    rinex_append_fortran(line, eph.d_A_f1, 18, 2);
+                    line += ' ';
+                    rinex_append_fortran(line, eph.d_A_f2, 18, 2);
                 }
-            Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
-
+            Rinex_Printer::end_line(line, line_begin);
 
             // -------- BROADCAST ORBIT - 1
-            line.clear();
-
-            if (version == 2)
-                {
-                    line += std::string(4, ' ');
-                }
-            if (version == 3)
-                {
-                    line += std::string(5, ' ');
-                }
             // IODE is not present in ephemeris data
             // If there is a discontinued reception the ephemeris is not validated
-            //if (gps_ephemeris_iter->second.d_IODE_SF2 == gps_ephemeris_iter->second.d_IODE_SF3)
+            //if (eph.d_IODE_SF2 == eph.d_IODE_SF3)
             //    {
-            //        line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_IODE_SF2, 18, 2);
+            //        line += Rinex_Printer::doub2for(eph.d_IODE_SF2, 18, 2);
             //    }
             //else
             //    {
             //        LOG(ERROR) << "Discontinued reception of Frame 2 and 3 " << std::endl;
             //    }
             double d_IODE_SF2 = 0;
-            line += Rinex_Printer::doub2for(d_IODE_SF2, 18, 2);
-            line += std::string(1, ' ');
-            line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_Crs, 18, 2);
-            line += std::string(1, ' ');
-            line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_Delta_n, 18, 2);
-            line += std::string(1, ' ');
-            line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_M_0, 18, 2);
-            if (version == 2)
-                {
-                    line += std::string(1, ' ');
-                }
-            Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
-
+            Rinex_Printer::append_broadcast_orbit(line, d_IODE_SF2, eph.d_Crs, eph.d_Delta_n, eph.d_M_0);
 
             // -------- BROADCAST ORBIT - 2
-            line.clear();
-            if (version == 2)
-                {
-                    line += std::string(4, ' ');
-                }
-            if (version == 3)
-                {
-                    line += std::string(5, ' ');
-                }
-            line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_Cuc, 18, 2);
-            line += std::string(1, ' ');
-            line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_e_eccentricity, 18, 2);
-            line += std::string(1, ' ');
-            line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_Cus, 18, 2);
-            line += std::string(1, ' ');
-            line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_sqrt_A, 18, 2);
-            if (version == 2)
-                {
-                    line += std::string(1, ' ');
-                }
-            Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
-
-
+            Rinex_Printer::append_broadcast_orbit(line, eph.d_Cuc, eph.d_e_eccentricity, eph.d_Cus, eph.d_sqrt_A);
 
             // -------- BROADCAST ORBIT - 3
-            line.clear();
-            if (version == 2)
-                {
-                    line += std::string(4, ' ');
-                }
-            if (version == 3)
-                {
-                    line += std::string(5, ' ');
-                }
-            line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_Toe, 18, 2);
-            line += std::string(1, ' ');
-            line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_Cic, 18, 2);
-            line += std::string(1, ' ');
-            line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_OMEGA0, 18, 2);
-            line += std::string(1, ' ');
-            line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_Cis, 18, 2);
-            if (version == 2)
-                {
-                    line += std::string(1, ' ');
-                }
-            Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
-
-
-
+            Rinex_Printer::append_broadcast_orbit(line, eph.d_Toe, eph.d_Cic, eph.d_OMEGA0, eph.d_Cis);
 
             // -------- BROADCAST ORBIT - 4
-            line.clear();
-            if (version == 2)
-                {
-                    line += std::string(4, ' ');
-                }
-            if (version == 3)
-                {
-                    line += std::string(5, ' ');
-                }
-            line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_i_0, 18, 2);
-            line += std::string(1, ' ');
-            line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_Crc, 18, 2);
-            line += std::string(1, ' ');
-            line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_OMEGA, 18, 2);
-            line += std::string(1, ' ');
-            line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_OMEGA_DOT, 18, 2);
-            if (version == 2)
-                {
-                    line += std::string(1, ' ');
-                }
-            Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
-
-
+            Rinex_Printer::append_broadcast_orbit(line, eph.d_i_0, eph.d_Crc, eph.d_OMEGA, eph.d_OMEGA_DOT);
 
             // -------- BROADCAST ORBIT - 5
-            line.clear();
-            if (version == 2)
-                {
-                    line += std::string(4, ' ');
-                }
-            if (version == 3)
-                {
-                    line += std::string(5, ' ');
-                }
-            line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_IDOT, 18, 2);
-            line += std::string(1, ' ');
-            line += Rinex_Printer::doub2for((double)(gps_ephemeris_iter->second.i_code_on_L2), 18, 2);
-            line += std::string(1, ' ');
-            double GPS_week_continuous_number = (double)(gps_ephemeris_iter->second.i_GPS_week + 1024); // valid until April 7, 2019 (check http://www.colorado.edu/geography/gcraft/notes/gps/gpseow.htm)
-            line += Rinex_Printer::doub2for(GPS_week_continuous_number, 18, 2);
-            line += std::string(1, ' ');
-            line += Rinex_Printer::doub2for((double)(gps_ephemeris_iter->second.i_code_on_L2), 18, 2);
-            if (version == 2)
-                {
-                    line += std::string(1, ' ');
-                }
-            Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
-
+            double GPS_week_continuous_number = (double)(eph.i_GPS_week + 1024); // valid until April 7, 2019 (check http://www.colorado.edu/geography/gcraft/notes/gps/gpseow.htm)
+            Rinex_Printer::append_broadcast_orbit(line, eph.d_IDOT, (double)(eph.i_code_on_L2), GPS_week_continuous_number, (double)(eph.i_code_on_L2));
 
             // -------- BROADCAST ORBIT - 6
-            line.clear();
-            if (version == 2)
-                {
-                    line += std::string(4, ' ');
-                }
-            if (version == 3)
-                {
-                    line += std::string(5, ' ');
-                }
-            line += Rinex_Printer::doub2for((double)(gps_ephemeris_iter->second.i_SV_accuracy), 18, 2);
-            line += std::string(1, ' ');
-            line += Rinex_Printer::doub2for((double)(gps_ephemeris_iter->second.i_SV_health), 18, 2);
-            line += std::string(1, ' ');
-            line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_TGD, 18, 2);
-            line += std::string(1, ' ');
-            line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_IODC, 18, 2);
-            if (version == 2)
-                {
-                    line += std::string(1, ' ');
-                }
-            Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
-
+            Rinex_Printer::append_broadcast_orbit(line, (double)(eph.i_SV_accuracy), (double)(eph.i_SV_health), eph.d_TGD, eph.d_IODC);
 
             // -------- BROADCAST ORBIT - 7
-            line.clear();
-            if (version == 2)
-                {
-                    line += std::string(4, ' ');
-                }
-            if (version == 3)
-                {
-                    line += std::string(5, ' ');
-                }
-            line += Rinex_Printer::doub2for(gps_ephemeris_iter->second.d_TOW, 18, 2);
-            line += std::string(1, ' ');
+            line_begin = line.size();
+            line += std::string(version == 2 ? 4 : 5, ' ');
+            rinex_append_fortran(line, eph.d_TOW, 18, 2);
+            line += ' ';
             double curve_fit_interval = 4;
 
-            if (gps_ephemeris_iter->second.satelliteBlock[gps_ephemeris_iter->second.i_satellite_PRN].compare("IIA"))
+            std::string block;
+            std::map<int,std::string>::const_iterator block_iter = eph.satelliteBlock.find(eph.i_satellite_PRN);
+            if (block_iter != eph.satelliteBlock.end()) block = block_iter->second;
+
+            if (block.compare("IIA"))
                 {
                     // Block II/IIA (Table 20-XI IS-GPS-200E )
-                    if ( (gps_ephemeris_iter->second.d_IODC > 239) && (gps_ephemeris_iter->second.d_IODC < 248) )  curve_fit_interval = 8;
-                    if ( ( (gps_ephemeris_iter->second.d_IODC > 247) && (gps_ephemeris_iter->second.d_IODC < 256) ) || (gps_ephemeris_iter->second.d_IODC == 496) ) curve_fit_interval = 14;
-                    if ( (gps_ephemeris_iter->second.d_IODC > 496) && (gps_ephemeris_iter->second.d_IODC < 504) ) curve_fit_interval = 26;
-                    if ( (gps_ephemeris_iter->second.d_IODC > 503) && (gps_ephemeris_iter->second.d_IODC < 511) )  curve_fit_interval = 50;
-                    if ( ( (gps_ephemeris_iter->second.d_IODC > 751) && (gps_ephemeris_iter->second.d_IODC < 757) ) || (gps_ephemeris_iter->second.d_IODC == 511) ) curve_fit_interval = 74;
-                    if ( gps_ephemeris_iter->second.d_IODC == 757 ) curve_fit_interval = 98;
+                    if ( (eph.d_IODC > 239) && (eph.d_IODC < 248) )  curve_fit_interval = 8;
+                    if ( ( (eph.d_IODC > 247) && (eph.d_IODC < 256) ) || (eph.d_IODC == 496) ) curve_fit_interval = 14;
+                    if ( (eph.d_IODC > 496) && (eph.d_IODC < 504) ) curve_fit_interval = 26;
+                    if ( (eph.d_IODC > 503) && (eph.d_IODC < 511) )  curve_fit_interval = 50;
+                    if ( ( (eph.d_IODC > 751) && (eph.d_IODC < 757) ) || (eph.d_IODC == 511) ) curve_fit_interval = 74;
+                    if ( eph.d_IODC == 757 ) curve_fit_interval = 98;
                 }
 
-            if ((gps_ephemeris_iter->second.satelliteBlock[gps_ephemeris_iter->second.i_satellite_PRN].compare("IIR") == 0) ||
-                    (gps_ephemeris_iter->second.satelliteBlock[gps_ephemeris_iter->second.i_satellite_PRN].compare("IIR-M") == 0) ||
-                    (gps_ephemeris_iter->second.satelliteBlock[gps_ephemeris_iter->second.i_satellite_PRN].compare("IIF") == 0) ||
-                    (gps_ephemeris_iter->second.satelliteBlock[gps_ephemeris_iter->second.i_satellite_PRN].compare("IIIA") == 0) )
+            if ((block.compare("IIR") == 0) ||
+                    (block.compare("IIR-M") == 0) ||
+                    (block.compare("IIF") == 0) ||
+                    (block.compare("IIIA") == 0) )
                 {
                     // Block IIR/IIR-M/IIF/IIIA (Table 20-XII IS-GPS-200E )
-                    if ( (gps_ephemeris_iter->second.d_IODC > 239) && (gps_ephemeris_iter->second.d_IODC < 248))  curve_fit_interval = 8;
-                    if ( ( (gps_ephemeris_iter->second.d_IODC > 247) && (gps_ephemeris_iter->second.d_IODC < 256)) || (gps_ephemeris_iter->second.d_IODC == 496) ) curve_fit_interval = 14;
-                    if ( ( (gps_ephemeris_iter->second.d_IODC > 496) && (gps_ephemeris_iter->second.d_IODC < 504)) || ( (gps_ephemeris_iter->second.d_IODC > 1020) && (gps_ephemeris_iter->second.d_IODC < 1024) ) ) curve_fit_interval = 26;
+                    if ( (eph.d_IODC > 239) && (eph.d_IODC < 248))  curve_fit_interval = 8;
+                    if ( ( (eph.d_IODC > 247) && (eph.d_IODC < 256)) || (eph.d_IODC == 496) ) curve_fit_interval = 14;
+                    if ( ( (eph.d_IODC > 496) && (eph.d_IODC < 504)) || ( (eph.d_IODC > 1020) && (eph.d_IODC < 1024) ) ) curve_fit_interval = 26;
                 }
-            line += Rinex_Printer::doub2for(curve_fit_interval, 18, 2);
-            line += std::string(1, ' ');
+            rinex_append_fortran(line, curve_fit_interval, 18, 2);
+            line += ' ';
             line += std::string(18, ' '); // spare
-            line += std::string(1, ' ');
+            line += ' ';
             line += std::string(18, ' '); // spare
             if (version == 2)
                 {
-                    line += std::string(1, ' ');
+                    line += ' ';
                 }
-            Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
-            line.clear();
+            Rinex_Printer::end_line(line, line_begin);
         }
+    out.write(line.data(), line.size());
 }
 
 
@@ -1146,197 +1043,150 @@ void Rinex_Printer::rinex_obs_header(std::ofstream& out, Gps_Ephemeris eph, doub
 
 
 
-void Rinex_Printer::log_rinex_obs(std::ofstream& out, Gps_Ephemeris eph, double obs_time, std::map<int,Gnss_Synchro> pseudoranges)
+void Rinex_Printer::log_rinex_obs(std::ofstream& out, const Gps_Ephemeris& eph, double obs_time, const std::map<int,Gnss_Synchro>& pseudoranges)
 {
-	// RINEX observations timestamps are GPS timestamps.
+    // RINEX observations timestamps are GPS timestamps.
+    // The epoch is formatted in d_buffer and written at once.
 
-    std::string line;
+    std::string& line = d_buffer;
+    line.clear();
 
     boost::posix_time::ptime p_gps_time = Rinex_Printer::compute_GPS_time(eph,obs_time);
-    std::string timestring = boost::posix_time::to_iso_string(p_gps_time);
+    boost::gregorian::date date = p_gps_time.date();
+    boost::posix_time::time_duration time = p_gps_time.time_of_day();
     //double utc_t = nav_msg.utc_time(nav_msg.sv_clock_correction(obs_time));
     //double gps_t = eph.sv_clock_correction(obs_time);
     double gps_t = obs_time;
 
-    std::string month (timestring, 4, 2);
-    std::string day (timestring, 6, 2);
-    std::string hour (timestring, 9, 2);
-    std::string minutes (timestring, 11, 2);
+    //Number of satellites observed in current epoch
+    int numSatellitesObserved = pseudoranges.size();
+    std::map<int,Gnss_Synchro>::const_iterator pseudoranges_iter;
 
     if (version == 2)
         {
-            line.clear();
-            std::string year (timestring, 2, 2);
-            line += std::string(1, ' ');
-            line += year;
-            line += std::string(1, ' ');
-            if (month.compare(0, 1 , "0") == 0)
-                {
-                    line += std::string(1, ' ');
-                    line += month.substr(1, 1);
-                }
-            else
-                {
-                    line += month;
-                }
-            line += std::string(1, ' ');
-            if (day.compare(0, 1 , "0") == 0)
-                {
-                    line += std::string(1, ' ');
-                    line += day.substr(1, 1);
-                }
-            else
-                {
-                    line += day;
-                }
-            line += std::string(1, ' ');
-            line += hour;
-            line += std::string(1, ' ');
-            line += minutes;
-            line += std::string(1, ' ');
-            line += Rinex_Printer::asString(fmod(gps_t, 60), 7);
+            line += ' ';
+            rinex_append_int(line, date.year() % 100, 2, '0');
+            line += ' ';
+            rinex_append_int(line, date.month().as_number(), 2);
+            line += ' ';
+            rinex_append_int(line, date.day(), 2);
+            line += ' ';
+            rinex_append_int(line, time.hours(), 2, '0');
+            line += ' ';
+            rinex_append_int(line, time.minutes(), 2, '0');
+            line += ' ';
+            rinex_append_fixed(line, fmod(gps_t, 60), 7);
             line += std::string(2, ' ');
             // Epoch flag 0: OK     1: power failure between previous and current epoch   <1: Special event
-            line += std::string(1, '0');
-            //Number of satellites observed in current epoch
-            int numSatellitesObserved = 0;
-            std::map<int,Gnss_Synchro>::iterator pseudoranges_iter;
-            for(pseudoranges_iter = pseudoranges.begin();
-                    pseudoranges_iter != pseudoranges.end();
-                    pseudoranges_iter++)
-                {
-                    numSatellitesObserved++;
-                }
-            line += Rinex_Printer::rightJustify(boost::lexical_cast<std::string>(numSatellitesObserved), 3);
+            line += '0';
+            rinex_append_int(line, numSatellitesObserved, 3);
             for(pseudoranges_iter = pseudoranges.begin();
                     pseudoranges_iter != pseudoranges.end();
                     pseudoranges_iter++)
                 {
                     line += satelliteSystem["GPS"];
-                    if ((int)pseudoranges_iter->first < 10) line += std::string(1, '0');
-                    line += boost::lexical_cast<std::string>((int)pseudoranges_iter->first);
+                    rinex_append_int(line, (int)pseudoranges_iter->first, 2, '0');
                 }
             // Receiver clock offset (optional)
             //line += rightJustify(asString(clockOffset, 12), 15);
-            line += std::string(80 - line.size(), ' ');
-            Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
-
+            if (line.size() < 80) line += std::string(80 - line.size(), ' ');
+            Rinex_Printer::end_line(line, 0);
 
             for(pseudoranges_iter = pseudoranges.begin();
                     pseudoranges_iter != pseudoranges.end();
                     pseudoranges_iter++)
                 {
-                    std::string lineObs;
-                    lineObs.clear();
-                    line.clear();
+                    std::string::size_type line_begin = line.size();
                     // GPS L1 PSEUDORANGE
-                    line += std::string(2, ' ');
-                    lineObs += Rinex_Printer::rightJustify(asString(pseudoranges_iter->second.Pseudorange_m, 3), 14);
+                    rinex_append_fixed(line, pseudoranges_iter->second.Pseudorange_m, 3, 14);
 
                     //Loss of lock indicator (LLI)
                     int lli = 0; // Include in the observation!!
                     if (lli == 0)
                         {
-                            lineObs += std::string(1, ' ');
+                            line += ' ';
                         }
                     else
                         {
-                            lineObs += Rinex_Printer::rightJustify(Rinex_Printer::asString<short>(lli), 1);
+                            rinex_append_int(line, lli, 1);
                         }
                     // GPS L1 CA PHASE
-                    lineObs += Rinex_Printer::rightJustify(asString(pseudoranges_iter->second.Carrier_phase_rads/GPS_TWO_PI, 3), 14);
+                    rinex_append_fixed(line, pseudoranges_iter->second.Carrier_phase_rads/GPS_TWO_PI, 3, 14);
                     // GPS L1 CA DOPPLER
-                    lineObs += Rinex_Printer::rightJustify(asString(pseudoranges_iter->second.Carrier_Doppler_hz, 3), 14);
+                    rinex_append_fixed(line, pseudoranges_iter->second.Carrier_Doppler_hz, 3, 14);
                     //GPS L1 SIGNAL STRENGTH
                     //int ssi=signalStrength(54.0); // The original RINEX 2.11 file stores the RSS in a tabulated format 1-9. However, it is also valid to store the CN0 using dB-Hz units
-                    lineObs += Rinex_Printer::rightJustify(asString(pseudoranges_iter->second.CN0_dB_hz, 3), 14);
-                    if (lineObs.size() < 80) lineObs += std::string(80 - lineObs.size(), ' ');
-                    out << lineObs << std::endl;
+                    rinex_append_fixed(line, pseudoranges_iter->second.CN0_dB_hz, 3, 14);
+                    if (line.size() - line_begin < 80) line += std::string(80 - (line.size() - line_begin), ' ');
+                    line += '\n';
                 }
         }
 
     if (version == 3)
         {
-            std::string year (timestring, 0, 4);
-            line += std::string(1, '>');
-            line += std::string(1, ' ');
-            line += year;
-            line += std::string(1, ' ');
-            line += month;
-            line += std::string(1, ' ');
-            line += day;
-            line += std::string(1, ' ');
-            line += hour;
-            line += std::string(1, ' ');
-            line += minutes;
-
-            line += std::string(1, ' ');
+            line += "> ";
+            rinex_append_int(line, date.year(), 4, '0');
+            line += ' ';
+            rinex_append_int(line, date.month().as_number(), 2, '0');
+            line += ' ';
+            rinex_append_int(line, date.day(), 2, '0');
+            line += ' ';
+            rinex_append_int(line, time.hours(), 2, '0');
+            line += ' ';
+            rinex_append_int(line, time.minutes(), 2, '0');
+
+            line += ' ';
             double seconds=fmod(gps_t, 60);
             // Add extra 0 if seconds are < 10
             if (seconds<10)
-            {
-            	line +=std::string(1, '0');
-            }
-            line += Rinex_Printer::asString(seconds, 7);
-            line += std::string(2, ' ');
-            // Epoch flag 0: OK     1: power failure between previous and current epoch   <1: Special event
-            line += std::string(1, '0');
-
-            //Number of satellites observed in current epoch
-            int numSatellitesObserved = 0;
-            std::map<int,Gnss_Synchro>::iterator pseudoranges_iter;
-            for(pseudoranges_iter = pseudoranges.begin();
-                    pseudoranges_iter != pseudoranges.end();
-                    pseudoranges_iter++)
                 {
-                    numSatellitesObserved++;
+                    line += '0';
                 }
-            line += Rinex_Printer::rightJustify(boost::lexical_cast<std::string>(numSatellitesObserved), 3);
-
+            rinex_append_fixed(line, seconds, 7);
+            line += std::string(2, ' ');
+            // Epoch flag 0: OK     1: power failure between previous and current epoch   <1: Special event
+            line += '0';
+            rinex_append_int(line, numSatellitesObserved, 3);
 
             // Receiver clock offset (optional)
             //line += rightJustify(asString(clockOffset, 12), 15);
 
-            line += std::string(80 - line.size(), ' ');
-            Rinex_Printer::lengthCheck(line);
-            out << line << std::endl;
+            if (line.size() < 80) line += std::string(80 - line.size(), ' ');
+            Rinex_Printer::end_line(line, 0);
 
+            int ssi=signalStrength(54.0); // TODO: include estimated signal strength
             for(pseudoranges_iter = pseudoranges.begin();
                     pseudoranges_iter != pseudoranges.end();
                     pseudoranges_iter++)
                 {
-                    std::string lineObs;
-                    lineObs.clear();
-                    lineObs += satelliteSystem["GPS"];
-                    if ((int)pseudoranges_iter->first < 10) lineObs += std::string(1, '0');
-                    lineObs += boost::lexical_cast<std::string>((int)pseudoranges_iter->first);
-                    //lineObs += std::string(2, ' ');
-                    lineObs += Rinex_Printer::rightJustify(asString(pseudoranges_iter->second.Pseudorange_m, 3), 14);
+                    std::string::size_type line_begin = line.size();
+                    line += satelliteSystem["GPS"];
+                    rinex_append_int(line, (int)pseudoranges_iter->first, 2, '0');
+                    rinex_append_fixed(line, pseudoranges_iter->second.Pseudorange_m, 3, 14);
 
                     //Loss of lock indicator (LLI)
                     int lli = 0; // Include in the observation!!
                     if (lli == 0)
                         {
-                            lineObs += std::string(1, ' ');
+                            line += ' ';
                         }
                     else
                         {
-                            lineObs += Rinex_Printer::rightJustify(Rinex_Printer::asString<short>(lli), 1);
+                            rinex_append_int(line, lli, 1);
                         }
-                    int ssi=signalStrength(54.0); // TODO: include estimated signal strength
                     if (ssi == 0)
                         {
-                            lineObs += std::string(1, ' ');
+                            line += ' ';
                         }
                     else
                         {
-                            lineObs += Rinex_Printer::rightJustify(Rinex_Printer::asString<short>(ssi), 1);
+                            rinex_append_int(line, ssi, 1);
                         }
-                    if (lineObs.size() < 80) lineObs += std::string(80 - lineObs.size(), ' ');
-                    out << lineObs << std::endl;
+                    if (line.size() - line_begin < 80) line += std::string(80 - (line.size() - line_begin), ' ');
+                    line += '\n';
                 }
         }
+    out.write(line.data(), line.size());
 }
 
 
@@ -1517,7 +1367,7 @@ boost::posix_time::ptime Rinex_Printer::compute_UTC_time(Gps_Navigation_Message
     return p_time;
 }
 
-boost::posix_time::ptime Rinex_Printer::compute_GPS_time(Gps_Ephemeris eph, double obs_time)
+boost::posix_time::ptime Rinex_Printer::compute_GPS_time(const Gps_Ephemeris& eph, double obs_time)
 {
     // The RINEX v2.11 v3.00 format uses GPS time for the observations epoch, not UTC time, thus, no leap seconds needed here.
     // (see Section 3 in http://igscb.jpl.nasa.gov/igscb/data/format/rinex211.txt)
@@ -62,6 +62,8 @@
 #include "GPS_L1_CA.h"
 #include "gnss_synchro.h"
 
+#define RINEX_PRINTER_BUFFER_SIZE 8192 // bytes, enough for an epoch of observations or a set of ephemerides
+
 class Sbas_Raw_Msg;
 
 /*!
@@ -108,18 +110,19 @@ public:
     /*!
      *  \brief Computes the GPS time and returns a boost::posix_time::ptime object
      */
-    boost::posix_time::ptime compute_GPS_time(Gps_Ephemeris eph, double obs_time);
+    boost::posix_time::ptime compute_GPS_time(const Gps_Ephemeris& eph, double obs_time);
 
 
     /*!
-     *  \brief Writes data from the navigation message into the RINEX file
+     *  \brief Writes data from the navigation message into the RINEX file.
+     *  Only the ephemerides that changed since the previous call are written.
      */
-    void log_rinex_nav(std::ofstream& out,  std::map<int,Gps_Ephemeris> eph_map);
+    void log_rinex_nav(std::ofstream& out, const std::map<int,Gps_Ephemeris>& eph_map);
 
     /*!
      *  \brief Writes observables into the RINEX file
      */
-    void log_rinex_obs(std::ofstream& out, Gps_Ephemeris eph, double obs_time, std::map<int,Gnss_Synchro> pseudoranges);
+    void log_rinex_obs(std::ofstream& out, const Gps_Ephemeris& eph, double obs_time, const std::map<int,Gnss_Synchro>& pseudoranges);
 
     /*!
      * \brief Represents GPS time in the date time format. Leap years are considered, but leap seconds are not.
@@ -176,6 +179,24 @@ private:
      */
     void lengthCheck(std::string line);
 
+    /*
+     * Ends the line of buffer that starts at line_begin, checking its length
+     */
+    void end_line(std::string& buffer, std::string::size_type line_begin);
+
+    /*
+     * Appends a BROADCAST ORBIT line of the navigation file to buffer
+     */
+    void append_broadcast_orbit(std::string& buffer, double a, double b, double c, double d);
+
+    /*
+     * True if both ephemerides have the same orbit and clock parameters
+     */
+    static bool same_ephemeris(const Gps_Ephemeris& a, const Gps_Ephemeris& b);
+
+    std::string d_buffer; // records of the current call, written to the file at once
+    std::map<int,Gps_Ephemeris> d_logged_ephemeris; // last ephemeris written to the navigation file, by PRN
+
     /*
      * If the string is bigger than length, truncate it from the right.
      * otherwise, add pad characters to its right.
@@ -0,0 +1,147 @@
+/*!
+ * \file rtcm_bit_writer.h
+ * \brief Writes the fields of a RTCM 3 message directly into the bytes of
+ * its transport layer frame
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_RTCM_BIT_WRITER_H_
+#define GNSS_SDR_RTCM_BIT_WRITER_H_
+
+#include <boost/cstdint.hpp>
+#include "crc24q.h"
+
+#define RTCM_PREAMBLE 0xD3
+#define RTCM_HEADER_BYTES 3         // preamble, 6 reserved bits and 10 bits of message length
+#define RTCM_CRC_BYTES 3
+#define RTCM_MAX_PAYLOAD_BYTES 1023
+#define RTCM_MAX_FRAME_BYTES (RTCM_HEADER_BYTES + RTCM_MAX_PAYLOAD_BYTES + RTCM_CRC_BYTES)
+
+
+/*!
+ * \brief Builds one RTCM 3 frame (RTCM Standard 10403.2, Section 4) in a
+ * fixed buffer.
+ *
+ * The data fields are appended MSB first after the frame header with
+ * put_unsigned() and put_signed(), and finish() pads the message to a whole
+ * number of bytes, fills in the header and appends the CRC-24Q. No memory is
+ * allocated, so a writer can be reused for every message.
+ */
+class Rtcm_Bit_Writer
+{
+public:
+    Rtcm_Bit_Writer()
+    {
+        reset();
+    }
+
+    /*!
+     * \brief Starts a new message
+     */
+    void reset()
+    {
+        d_bits = 0;
+        d_frame_length = 0;
+        d_overflow = false;
+    }
+
+    /*!
+     * \brief Appends the bits least significant bits of value (bits <= 64)
+     */
+    void put_unsigned(boost::uint64_t value, unsigned int bits)
+    {
+        if (d_bits + bits > RTCM_MAX_PAYLOAD_BYTES * 8)
+            {
+                d_overflow = true;
+                return;
+            }
+        while (bits > 0)
+            {
+                unsigned int used = d_bits & 7;
+                unsigned int n = (bits < 8 - used) ? bits : 8 - used;
+                unsigned char chunk = (unsigned char)((value >> (bits - n)) & ((1U << n) - 1));
+                unsigned char &byte = d_frame[RTCM_HEADER_BYTES + (d_bits >> 3)];
+                // a byte is cleared when its first bit is written
+                if (used == 0)
+                    {
+                        byte = (unsigned char)(chunk << (8 - n));
+                    }
+                else
+                    {
+                        byte |= (unsigned char)(chunk << (8 - used - n));
+                    }
+                d_bits += n;
+                bits -= n;
+            }
+    }
+
+    /*!
+     * \brief Appends value in two's complement with bits bits. The caller
+     * makes sure that value fits.
+     */
+    void put_signed(boost::int64_t value, unsigned int bits)
+    {
+        put_unsigned((boost::uint64_t)value, bits);
+    }
+
+    /*!
+     * \brief Pads the message with zeros to a whole byte, writes the frame
+     * header and the CRC-24Q, and returns the frame length in bytes
+     * (0 if the message did not fit in a frame).
+     */
+    unsigned int finish()
+    {
+        if (d_overflow)
+            {
+                d_frame_length = 0;
+                return 0;
+            }
+        unsigned int payload_bytes = (d_bits + 7) / 8;
+        d_frame[0] = RTCM_PREAMBLE;
+        d_frame[1] = (unsigned char)((payload_bytes >> 8) & 0x03);
+        d_frame[2] = (unsigned char)(payload_bytes & 0xFF);
+        unsigned int length = RTCM_HEADER_BYTES + payload_bytes;
+        boost::uint32_t crc = crc24q(d_frame, length);
+        d_frame[length] = (unsigned char)(crc >> 16);
+        d_frame[length + 1] = (unsigned char)(crc >> 8);
+        d_frame[length + 2] = (unsigned char)crc;
+        d_frame_length = length + RTCM_CRC_BYTES;
+        return d_frame_length;
+    }
+
+    unsigned int message_bits() const { return d_bits; }              //!< Bits of the message written so far
+    bool overflow() const { return d_overflow; }                      //!< True if the message does not fit in a frame
+    const unsigned char *frame() const { return d_frame; }            //!< The frame, valid after finish()
+    unsigned int frame_length() const { return d_frame_length; }      //!< Length of the frame [bytes], 0 before finish()
+
+private:
+    unsigned char d_frame[RTCM_MAX_FRAME_BYTES];
+    unsigned int d_bits;
+    unsigned int d_frame_length;
+    bool d_overflow;
+};
+
+#endif
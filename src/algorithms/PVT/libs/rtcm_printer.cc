@@ -31,29 +31,34 @@
  * -------------------------------------------------------------------------
  */
 
+
 #include "rtcm_printer.h"
 #include <fcntl.h>    // for O_RDWR
 #include <termios.h>  // for tcgetattr
-#include <algorithm>  // for std::reverse
-#include <sstream>    // for std::stringstream
-#include <boost/algorithm/string.hpp>  // for to_upper_copy
-#include <boost/date_time/posix_time/posix_time.hpp>
-#include <boost/dynamic_bitset.hpp>
+#include <unistd.h>   // for write
+#include <cmath>
+#include <cstdio>     // for remove
+#include <boost/cstdint.hpp>
 #include <gflags/gflags.h>
 #include <glog/logging.h>
+#include "GPS_L1_CA.h"
 
 
 using google::LogMessage;
 
 //DEFINE_string(RTCM_version, "3.2", "Specifies the RTCM Version");
 
-Rtcm_Printer::Rtcm_Printer(std::string filename, bool flag_rtcm_tty_port, std::string rtcm_dump_devname)
+Rtcm_Printer::Rtcm_Printer(std::string filename, bool flag_rtcm_tty_port, std::string rtcm_dump_devname,
+        bool flag_rtcm_server, unsigned short rtcm_tcp_port, unsigned short rtcm_station_id)
 {
     rtcm_filename = filename;
-    rtcm_file_descriptor.open(rtcm_filename.c_str(), std::ios::out);
-    if (rtcm_file_descriptor.is_open())
+    if (!rtcm_filename.empty())
         {
-            DLOG(INFO) << "RTCM printer writing on " << rtcm_filename.c_str();
+            rtcm_file_descriptor.open(rtcm_filename.c_str(), std::ios::out | std::ios::binary);
+            if (rtcm_file_descriptor.is_open())
+                {
+                    DLOG(INFO) << "RTCM printer writing on " << rtcm_filename.c_str();
+                }
         }
 
     rtcm_devname = rtcm_dump_devname;
@@ -69,9 +74,19 @@ Rtcm_Printer::Rtcm_Printer(std::string filename, bool flag_rtcm_tty_port, std::s
         {
             rtcm_dev_descriptor = -1;
         }
-    Rtcm_Printer::reset_data_fields();
-    preamble = std::bitset<8>("11010011");
-    reserved_field = std::bitset<6>("000000");
+
+    rtcm_tcp_server = 0;
+    if (flag_rtcm_server == true)
+        {
+            rtcm_tcp_server = new Rtcm_Tcp_Server(rtcm_tcp_port);
+        }
+    if (rtcm_station_id > RTCM_MAX_STATION_ID)
+        {
+            LOG(WARNING) << "RTCM reference station ID " << rtcm_station_id << " does not fit in 12 bits, using " << RTCM_MAX_STATION_ID;
+            rtcm_station_id = RTCM_MAX_STATION_ID;
+        }
+    d_station_id = rtcm_station_id;
+    d_frames = 0;
 }
 
 
@@ -82,11 +97,12 @@ Rtcm_Printer::~Rtcm_Printer()
     if (rtcm_file_descriptor.is_open())
         {
             long pos;
-            rtcm_file_descriptor.close();
             pos = rtcm_file_descriptor.tellp();
+            rtcm_file_descriptor.close();
             if (pos == 0) remove(rtcm_filename.c_str());
         }
     close_serial();
+    delete rtcm_tcp_server;
 }
 
 
@@ -95,7 +111,7 @@ Rtcm_Printer::~Rtcm_Printer()
 int Rtcm_Printer::init_serial(std::string serial_device)
 {
     /*!
-     * Opens the serial device and sets the default baud rate for a NMEA transmission (9600,8,N,1)
+     * Opens the serial device and sets the baud rate for a RTCM transmission (115200,8,N,1)
      */
     int fd = 0;
     struct termios options;
@@ -111,8 +127,8 @@ int Rtcm_Printer::init_serial(std::string serial_device)
     fcntl(fd, F_SETFL, 0);    // clear all flags on descriptor, enable direct I/O
     tcgetattr(fd, &options);  // read serial port options
 
-    BAUD  = B9600;
-    //BAUD  =  B38400;
+    // MSM messages of 10 satellites at 10 Hz do not fit in 9600 bauds
+    BAUD  = B115200;
     DATABITS = CS8;
     STOPBITS = 0;
     PARITYON = 0;
@@ -138,84 +154,74 @@ void Rtcm_Printer::close_serial()
         }
 }
 
-void Rtcm_Printer::reset_data_fields()
+
+
+/*
+ * Value of a data field: the nearest integer to value / lsb
+ */
+static boost::int64_t rtcm_field(double value, double lsb)
+{
+    return (boost::int64_t)floor(value / lsb + 0.5);
+}
+
+
+
+bool Rtcm_Printer::print_M1005(double latitude_d, double longitude_d, double height_m)
+{
+    // WGS84 ellipsoid
+    const double a = 6378137.0;
+    const double f = 1.0 / 298.257223563;
+    const double e2 = f * (2.0 - f);
+    double phi = latitude_d * GPS_PI / 180.0;
+    double lambda = longitude_d * GPS_PI / 180.0;
+    double N = a / sqrt(1.0 - e2 * sin(phi) * sin(phi));
+    double X = (N + height_m) * cos(phi) * cos(lambda);
+    double Y = (N + height_m) * cos(phi) * sin(lambda);
+    double Z = (N * (1.0 - e2) + height_m) * sin(phi);
+
+    d_writer.reset();
+    get_M1005(d_writer, d_station_id, X, Y, Z);
+    return write_frame(d_writer);
+}
+
+
+
+bool Rtcm_Printer::print_M1019(const Gps_Ephemeris& gps_eph)
+{
+    d_writer.reset();
+    get_M1019(d_writer, gps_eph);
+    return write_frame(d_writer);
+}
+
+
+
+bool Rtcm_Printer::print_MSM4(const std::map<int,Gnss_Synchro>& observables, double tow_s)
 {
-    //DF001.reset();
-    DF002.reset();
-    DF003.reset();
-    DF004.reset();
-    DF005.reset();
-    DF006.reset();
-    DF007.reset();
-    DF008.reset();
-    DF009.reset();
-    DF010.reset();
-    DF011.reset();
-    DF012.reset();
-    DF013.reset();
-    DF014.reset();
-    DF015.reset();
-
-    // Contents of GPS Satellite Ephemeris Data, Message Type 1019
-    DF071.reset();
-    DF076.reset();
-    DF077.reset();
-    DF078.reset();
-    DF079.reset();
-    DF081.reset();
-    DF082.reset();
-    DF083.reset();
-    DF084.reset();
-    DF085.reset();
-    DF086.reset();
-    DF087.reset();
-
-    DF088.reset();
-    DF089.reset();
-    DF090.reset();
-    DF091.reset();
-    DF092.reset();
-    DF093.reset();
-    DF094.reset();
-    DF095.reset();
-    DF096.reset();
-    DF097.reset();
-    DF098.reset();
-    DF099.reset();
-    DF100.reset();
-    DF101.reset();
-    DF102.reset();
-    DF103.reset();
-    DF137.reset();
-
-    // Contents of Galileo F/NAV Satellite Ephemeris Data, Message Type 1045
-    DF252.reset();
-    DF289.reset();
-    DF290.reset();
-    DF291.reset();
-    DF292.reset();
-    DF293.reset();
-    DF294.reset();
-    DF295.reset();
-    DF296.reset();
-    DF297.reset();
-    DF298.reset();
-    DF299.reset();
-    DF300.reset();
-    DF301.reset();
-    DF302.reset();
-    DF303.reset();
-    DF304.reset();
-    DF305.reset();
-    DF306.reset();
-    DF307.reset();
-    DF308.reset();
-    DF309.reset();
-    DF310.reset();
-    DF311.reset();
-    DF312.reset();
-    DF314.reset();
-    DF315.reset();
+    bool gps = false;
+    bool galileo = false;
+    for(std::map<int,Gnss_Synchro>::const_iterator it = observables.begin(); it != observables.end(); it++)
+        {
+            if (it->second.System == 'G') gps = true;
+            if (it->second.System == 'E') galileo = true;
+        }
+    bool result = true;
+    if (gps)
+        {
+            d_writer.reset();
+            if (get_MSM4(d_writer, d_station_id, 'G', observables, tow_s, galileo) >= 0)
+                {
+                    result = write_frame(d_writer) and result;
+                }
+        }
+    if (galileo)
+        {
+            d_writer.reset();
+            if (get_MSM4(d_writer, d_station_id, 'E', observables, tow_s, false) >= 0)
+                {
+                    result = write_frame(d_writer) and result;
+                }
+        }
+    return result;
 }
 
 
@@ -229,164 +235,294 @@ void Rtcm_Printer::reset_data_fields()
    Expected output: D3 00 13 3E D7 D3 02 02 98 0E DE EF 34 B4 BD 62
                     AC 09 41 98 6F 33 36 0B 98
  */
-std::bitset<152> Rtcm_Printer::get_M1005_test ()
+std::string Rtcm_Printer::print_M1005_test ()
 {
-    unsigned int m1005 = 1005;
-    unsigned int reference_station_id = 2003; // Max: 4095
-    long long int ECEF_X = 11141045999;       // Resolution 0.0001 m
-    long long int ECEF_Y = -48507297108;      // Resolution 0.0001 m
-    long long int ECEF_Z = 39755214643;       // Resolution 0.0001 m
-    unsigned int itrf_realization_year = 0;   // Reserved
-    std::bitset<1> DF001;
-
-    DF002 = std::bitset<12>(m1005);
-    DF003 = std::bitset<12>(reference_station_id);
-    DF021 = std::bitset<6>(itrf_realization_year);
-    DF022 = std::bitset<1>("1");          // GPS
-    DF023 = std::bitset<1>("0");          // Glonass
-    DF024 = std::bitset<1>("0");          // Galileo
-    DF141 = std::bitset<1>("0");          // 0: Real, physical reference station
-    DF001 = std::bitset<1>("0");          // Reserved, set to 0
-    DF025 = std::bitset<38>(ECEF_X);      // ECEF-X in 0.0001 m
-    DF142 = std::bitset<1>("0");          // Single Receiver Oscillator Indicator
-    DF026 = std::bitset<38>(ECEF_Y);      // ECEF-Y in 0.0001 m
-    DF364 = std::bitset<2>("00");         // Quarter Cycle Indicator
-    DF027 = std::bitset<38>(ECEF_Z);      // ECEF-Z in 0.0001 m
-
-    std::string message = DF002.to_string() +
-            DF003.to_string() +
-            DF021.to_string() +
-            DF022.to_string() +
-            DF023.to_string() +
-            DF024.to_string() +
-            DF141.to_string() +
-            DF025.to_string() +
-            DF142.to_string() +
-            DF001.to_string() +
-            DF026.to_string() +
-            DF364.to_string() +
-            DF027.to_string() ;
-
-    std::bitset<152> test_msg(message);
-    return test_msg;
+    Rtcm_Bit_Writer writer;
+    get_M1005(writer, 2003, 1114104.5999, -4850729.7108, 3975521.4643);
+    writer.finish();
+    return frame_to_hex(writer);
 }
 
 
 
-std::string Rtcm_Printer::print_M1005_test ()
+void Rtcm_Printer::get_M1005(Rtcm_Bit_Writer& writer, unsigned int reference_station_id, double ecef_X, double ecef_Y, double ecef_Z)
 {
-    std::bitset<152> m1005 = get_M1005_test();
-    unsigned int msg_length_bits = m1005.to_string().length();
-    unsigned int msg_length_bytes = std::ceil((float)msg_length_bits / 8.0);
-    message_length = std::bitset<10>(msg_length_bytes);
-    unsigned int zeros_to_fill = 8*msg_length_bytes -  msg_length_bits;
-    std::string b(zeros_to_fill, '0');
-    std::string msg_content = m1005.to_string() + b;
-    std::string msg_without_crc = preamble.to_string() +
-            reserved_field.to_string() +
-            message_length.to_string() +
-            msg_content;
-    return Rtcm_Printer::add_CRC(msg_without_crc);
+    writer.put_unsigned(1005, 12);                    // DF002 Message number
+    writer.put_unsigned(reference_station_id, 12);    // DF003 Reference station ID
+    writer.put_unsigned(0, 6);                        // DF021 ITRF realization year (reserved)
+    writer.put_unsigned(1, 1);                        // DF022 GPS
+    writer.put_unsigned(0, 1);                        // DF023 Glonass
+    writer.put_unsigned(0, 1);                        // DF024 Galileo
+    writer.put_unsigned(0, 1);                        // DF141 0: Real, physical reference station
+    writer.put_signed(rtcm_field(ecef_X, 0.0001), 38); // DF025 ECEF-X in 0.0001 m
+    writer.put_unsigned(0, 1);                        // DF142 Single Receiver Oscillator Indicator
+    writer.put_unsigned(0, 1);                        // DF001 Reserved
+    writer.put_signed(rtcm_field(ecef_Y, 0.0001), 38); // DF026 ECEF-Y in 0.0001 m
+    writer.put_unsigned(0, 2);                        // DF364 Quarter Cycle Indicator
+    writer.put_signed(rtcm_field(ecef_Z, 0.0001), 38); // DF027 ECEF-Z in 0.0001 m
 }
 
 
 
-std::bitset<122> Rtcm_Printer::get_M1001()
+void Rtcm_Printer::get_M1019(Rtcm_Bit_Writer& writer, const Gps_Ephemeris& gps_eph)
 {
-    unsigned int m1001 = 1001;
-    unsigned int reference_station_id = 1234; // Max: 4095
-    DF002 = std::bitset<12>(m1001);
-    DF003 = std::bitset<12>(reference_station_id);
-    //DF004 = std::bitset<30>
-    //DF005 = std::bitset<1>
-    //DF006 = std::bitset<5>
-    DF007 = std::bitset<1>("0");
-    //DF008 = std::bitset<3>
-    std::bitset<122> fake_msg;
-    fake_msg.reset();
-    return fake_msg;
+    // the scale factors of the data fields are those of the GPS navigation message
+    writer.put_unsigned(1019, 12);                                           // DF002 Message number
+    writer.put_unsigned(gps_eph.i_satellite_PRN, 6);                         // DF009 GPS satellite ID
+    writer.put_unsigned(gps_eph.i_GPS_week % 1024, 10);                      // DF076 GPS week number
+    writer.put_unsigned(gps_eph.i_SV_accuracy, 4);                           // DF077 GPS SV accuracy (URA)
+    writer.put_unsigned(gps_eph.i_code_on_L2, 2);                            // DF078 GPS code on L2
+    writer.put_signed(rtcm_field(gps_eph.d_IDOT, I_DOT_LSB), 14);            // DF079 IDOT
+    writer.put_unsigned((unsigned int)gps_eph.d_IODC & 0xFF, 8);             // DF071 IODE, the 8 LSBs of the IODC
+    writer.put_unsigned(rtcm_field(gps_eph.d_Toc, T_OC_LSB), 16);            // DF081 toc
+    writer.put_signed(rtcm_field(gps_eph.d_A_f2, A_F2_LSB), 8);              // DF082 af2
+    writer.put_signed(rtcm_field(gps_eph.d_A_f1, A_F1_LSB), 16);             // DF083 af1
+    writer.put_signed(rtcm_field(gps_eph.d_A_f0, A_F0_LSB), 22);             // DF084 af0
+    writer.put_unsigned((unsigned int)gps_eph.d_IODC, 10);                   // DF085 IODC
+    writer.put_signed(rtcm_field(gps_eph.d_Crs, C_RS_LSB), 16);              // DF086 Crs
+    writer.put_signed(rtcm_field(gps_eph.d_Delta_n, DELTA_N_LSB), 16);       // DF087 Delta n
+    writer.put_signed(rtcm_field(gps_eph.d_M_0, M_0_LSB), 32);               // DF088 M0
+    writer.put_signed(rtcm_field(gps_eph.d_Cuc, C_UC_LSB), 16);              // DF089 Cuc
+    writer.put_unsigned(rtcm_field(gps_eph.d_e_eccentricity, E_LSB), 32);    // DF090 Eccentricity
+    writer.put_signed(rtcm_field(gps_eph.d_Cus, C_US_LSB), 16);              // DF091 Cus
+    writer.put_unsigned(rtcm_field(gps_eph.d_sqrt_A, SQRT_A_LSB), 32);       // DF092 sqrt(A)
+    writer.put_unsigned(rtcm_field(gps_eph.d_Toe, T_OE_LSB), 16);            // DF093 toe
+    writer.put_signed(rtcm_field(gps_eph.d_Cic, C_IC_LSB), 16);              // DF094 Cic
+    writer.put_signed(rtcm_field(gps_eph.d_OMEGA0, OMEGA_0_LSB), 32);        // DF095 OMEGA0
+    writer.put_signed(rtcm_field(gps_eph.d_Cis, C_IS_LSB), 16);              // DF096 Cis
+    writer.put_signed(rtcm_field(gps_eph.d_i_0, I_0_LSB), 32);               // DF097 i0
+    writer.put_signed(rtcm_field(gps_eph.d_Crc, C_RC_LSB), 16);              // DF098 Crc
+    writer.put_signed(rtcm_field(gps_eph.d_OMEGA, OMEGA_LSB), 32);           // DF099 omega
+    writer.put_signed(rtcm_field(gps_eph.d_OMEGA_DOT, OMEGA_DOT_LSB), 24);   // DF100 OMEGADOT
+    writer.put_signed(rtcm_field(gps_eph.d_TGD, T_GD_LSB), 8);               // DF101 tGD
+    writer.put_unsigned(gps_eph.i_SV_health, 6);                             // DF102 GPS SV health
+    writer.put_unsigned(gps_eph.b_L2_P_data_flag, 1);                        // DF103 GPS L2 P data flag
+    writer.put_unsigned(gps_eph.b_fit_interval_flag, 1);                     // DF137 GPS fit interval
 }
 
 
 
-void Rtcm_Printer::print_M1001 ()
+/*
+ * MSM signal ID (bit of DF395) of a signal, or 0 if it is not supported
+ */
+static int rtcm_msm_signal_id(char system, const char *signal)
 {
-    std::bitset<122> m1001 = get_M1001();
-    unsigned int msg_length_bits = m1001.to_string().length();
-    unsigned int msg_length_bytes = std::ceil((float)msg_length_bits/8.0);
-    message_length = std::bitset<10>(msg_length_bytes);
-    unsigned int zeros_to_fill = 8*msg_length_bytes -  msg_length_bits;
-    std::string b(zeros_to_fill, '0');
-    message_length = std::bitset<10>((int)msg_length_bytes);
-    std::string msg_content = m1001.to_string() + b;
-    std::string msg_without_crc = preamble.to_string() +
-            reserved_field.to_string() +
-            message_length.to_string() +
-            msg_content;
-    std::string message = Rtcm_Printer::add_CRC(msg_without_crc);
+    if (signal[0] != '1') return 0;
+    if (system == 'G' and signal[1] == 'C') return 2;  // L1 C/A
+    if (system == 'E' and signal[1] == 'C') return 2;  // E1 C
+    if (system == 'E' and signal[1] == 'B') return 4;  // E1 B
+    return 0;
 }
 
 
 
-std::bitset<138> Rtcm_Printer::get_M1002 ()
-{
-    std::bitset<138> fake_msg;
-    fake_msg.reset();
-    return fake_msg;
-}
-
-std::bitset<488> Rtcm_Printer::get_M1019 ()
+/*
+ * MSM lock time indicator (DF402) of a lock time
+ */
+static unsigned int rtcm_msm_lock_time_indicator(double lock_time_ms)
 {
-    std::bitset<488> fake_msg;
-        fake_msg.reset();
-        return fake_msg;
+    unsigned int indicator = 0;
+    double limit = 32.0;
+    while (indicator < 15 and lock_time_ms >= limit)
+        {
+            indicator++;
+            limit *= 2.0;
+        }
+    return indicator;
 }
 
 
 
-std::bitset<496> Rtcm_Printer::get_M1045 ()
+int Rtcm_Printer::get_MSM4(Rtcm_Bit_Writer& writer, unsigned int reference_station_id, char system,
+        const std::map<int,Gnss_Synchro>& observables, double tow_s, bool more_messages)
 {
-    std::bitset<496> fake_msg;
-    fake_msg.reset();
-    return fake_msg;
-}
+    // observables of the message, indexed by satellite ID - 1
+    const Gnss_Synchro *satellites[RTCM_MSM_MAX_SATELLITES] = {0};
+    int signal_ids[RTCM_MSM_MAX_SATELLITES];
+    boost::uint32_t signal_mask = 0;
+    for(std::map<int,Gnss_Synchro>::const_iterator it = observables.begin(); it != observables.end(); it++)
+        {
+            const Gnss_Synchro &obs = it->second;
+            if (obs.System != system or obs.PRN < 1 or obs.PRN > RTCM_MSM_MAX_SATELLITES) continue;
+            int signal_id = rtcm_msm_signal_id(system, obs.Signal);
+            if (signal_id == 0) continue;
+            satellites[obs.PRN - 1] = &obs;
+            signal_ids[obs.PRN - 1] = signal_id;
+            signal_mask |= 1U << (32 - signal_id);
+        }
+    int nsat = 0;
+    boost::uint64_t satellite_mask = 0;
+    for (int i = 0; i < RTCM_MSM_MAX_SATELLITES; i++)
+        {
+            if (satellites[i] != 0)
+                {
+                    satellite_mask |= 1ULL << (63 - i);
+                    nsat++;
+                }
+        }
+    int nsig = 0;
+    int signal_index[33]; // position of each signal ID in the signal mask
+    for (int id = 1; id <= 32; id++)
+        {
+            if (signal_mask & (1U << (32 - id))) signal_index[id] = nsig++;
+        }
+    if (nsat * nsig > RTCM_MSM_MAX_CELLS) return -1;
+
+    // Header
+    writer.put_unsigned(system == 'G' ? 1074 : 1094, 12);                  // DF002 Message number
+    writer.put_unsigned(reference_station_id, 12);                         // DF003 Reference station ID
+    writer.put_unsigned(rtcm_field(tow_s, 0.001) % 604800000, 30);         // DF004 / DF248 Epoch time (TOW) [ms]
+    writer.put_unsigned(more_messages, 1);                                 // DF393 Multiple message bit
+    writer.put_unsigned(0, 3);                                             // DF409 IODS
+    writer.put_unsigned(0, 7);                                             // DF001 Reserved
+    writer.put_unsigned(0, 2);                                             // DF411 Clock steering indicator
+    writer.put_unsigned(0, 2);                                             // DF412 External clock indicator
+    writer.put_unsigned(0, 1);                                             // DF417 Divergence-free smoothing indicator
+    writer.put_unsigned(0, 3);                                             // DF418 Smoothing interval
+    writer.put_unsigned(satellite_mask, 64);                               // DF394 GNSS satellite mask
+    writer.put_unsigned(signal_mask, 32);                                  // DF395 GNSS signal mask
+    for (int i = 0; i < RTCM_MSM_MAX_SATELLITES; i++)                      // DF396 GNSS cell mask
+        {
+            if (satellites[i] == 0) continue;
+            for (int j = 0; j < nsig; j++)
+                {
+                    writer.put_unsigned(signal_index[signal_ids[i]] == j, 1);
+                }
+        }
 
+    // Satellite data: rough ranges, in whole milliseconds and 2^-10 ms
+    const double light_ms = GPS_C_m_s * 0.001; // [m/ms]
+    double rough_range_ms[RTCM_MSM_MAX_SATELLITES];
+    for (int i = 0; i < RTCM_MSM_MAX_SATELLITES; i++)
+        {
+            if (satellites[i] == 0) continue;
+            rough_range_ms[i] = rtcm_field(satellites[i]->Pseudorange_m / light_ms, 1.0 / 1024.0) / 1024.0;
+            if (rough_range_ms[i] < 0.0 or rough_range_ms[i] >= 255.0) rough_range_ms[i] = -1.0;
+        }
+    for (int i = 0; i < RTCM_MSM_MAX_SATELLITES; i++)
+        {
+            if (satellites[i] == 0) continue;
+            writer.put_unsigned(rough_range_ms[i] < 0.0 ? 255 : (unsigned int)floor(rough_range_ms[i]), 8); // DF397
+        }
+    for (int i = 0; i < RTCM_MSM_MAX_SATELLITES; i++)
+        {
+            if (satellites[i] == 0) continue;
+            double modulo_ms = rough_range_ms[i] < 0.0 ? 0.0 : rough_range_ms[i] - floor(rough_range_ms[i]);
+            writer.put_unsigned(rtcm_field(modulo_ms, 1.0 / 1024.0), 10);  // DF398
+        }
 
+    // Signal data, one cell per satellite
+    const double wavelength_ms = 1000.0 / GPS_L1_FREQ_HZ; // GPS L1 and Galileo E1 [ms/cycle]
+    boost::int64_t fine_pseudorange[RTCM_MSM_MAX_SATELLITES];
+    boost::int64_t fine_phaserange[RTCM_MSM_MAX_SATELLITES];
+    unsigned int lock_time[RTCM_MSM_MAX_SATELLITES];
+    unsigned int cnr[RTCM_MSM_MAX_SATELLITES];
+    for (int i = 0; i < RTCM_MSM_MAX_SATELLITES; i++)
+        {
+            if (satellites[i] == 0) continue;
+            const Gnss_Synchro &obs = *satellites[i];
+            fine_pseudorange[i] = -16384;  // DF400 invalid
+            fine_phaserange[i] = -2097152; // DF401 invalid
+            lock_time[i] = 0;
+            if (rough_range_ms[i] >= 0.0)
+                {
+                    double pseudorange_ms = obs.Pseudorange_m / light_ms;
+                    fine_pseudorange[i] = rtcm_field(pseudorange_ms - rough_range_ms[i], 1.0 / 16777216.0); // 2^-24 ms
+                    int key = (int)system * 256 + (int)obs.PRN;
+                    if (obs.Carrier_phase_rads != 0.0)
+                        {
+                            double phase_cycles = obs.Carrier_phase_rads / GPS_TWO_PI;
+                            bool locked = d_phase_locks.count(key) > 0;
+                            Msm_Phase_Lock &lock = d_phase_locks[key];
+                            double fine_ms = (phase_cycles - lock.offset_cycles) * wavelength_ms - rough_range_ms[i];
+                            // the fine phaserange covers +-2^-8 ms; the margin leaves room for the code-carrier divergence
+                            if (!locked or tow_s <= lock.last_tow_s or tow_s - lock.last_tow_s >= 1.0 or fabs(fine_ms) > 0.5 / 256.0)
+                                {
+                                    lock.offset_cycles = floor(phase_cycles - pseudorange_ms / wavelength_ms + 0.5);
+                                    lock.lock_start_s = tow_s;
+                                    fine_ms = (phase_cycles - lock.offset_cycles) * wavelength_ms - rough_range_ms[i];
+                                }
+                            lock.last_tow_s = tow_s;
+                            fine_phaserange[i] = rtcm_field(fine_ms, 1.0 / 536870912.0); // 2^-29 ms
+                            lock_time[i] = rtcm_msm_lock_time_indicator((tow_s - lock.lock_start_s) * 1000.0);
+                        }
+                    else
+                        {
+                            d_phase_locks.erase(key);
+                        }
+                }
+            cnr[i] = 0;
+            if (obs.CN0_dB_hz > 0.0)
+                {
+                    cnr[i] = (unsigned int)rtcm_field(obs.CN0_dB_hz, 1.0);
+                    if (cnr[i] < 1) cnr[i] = 1;
+                    if (cnr[i] > 63) cnr[i] = 63;
+                }
+        }
+    for (int i = 0; i < RTCM_MSM_MAX_SATELLITES; i++)
+        {
+            if (satellites[i] != 0) writer.put_signed(fine_pseudorange[i], 15); // DF400 Fine pseudorange
+        }
+    for (int i = 0; i < RTCM_MSM_MAX_SATELLITES; i++)
+        {
+            if (satellites[i] != 0) writer.put_signed(fine_phaserange[i], 22);  // DF401 Fine phaserange
+        }
+    for (int i = 0; i < RTCM_MSM_MAX_SATELLITES; i++)
+        {
+            if (satellites[i] != 0) writer.put_unsigned(lock_time[i], 4);       // DF402 Lock time indicator
+        }
+    for (int i = 0; i < RTCM_MSM_MAX_SATELLITES; i++)
+        {
+            if (satellites[i] != 0) writer.put_unsigned(0, 1);                  // DF420 Half-cycle ambiguity indicator
+        }
+    for (int i = 0; i < RTCM_MSM_MAX_SATELLITES; i++)
+        {
+            if (satellites[i] != 0) writer.put_unsigned(cnr[i], 6);             // DF403 CNR [dB-Hz]
+        }
+    return nsat;
+}
 
 
 
-std::string Rtcm_Printer::add_CRC (const std::string& message_without_crc)
+bool Rtcm_Printer::write_frame(Rtcm_Bit_Writer& writer)
 {
-    // ******  Computes Qualcomm CRC-24Q ******
-    // 1) Converts the string to a vector of unsigned char:
-    boost::dynamic_bitset<unsigned char> frame_bits(message_without_crc);
-    std::vector<unsigned char> bytes;
-    boost::to_block_range(frame_bits, std::back_inserter(bytes));
-    std::reverse(bytes.begin(),bytes.end());
-
-    // 2) Computes CRC
-    CRC_RTCM.process_bytes(bytes.data(), bytes.size());
-    crc_frame = std::bitset<24>(CRC_RTCM.checksum());
-
-    // 3) Builds the complete message
-    std::string complete_message = message_without_crc + crc_frame.to_string();
-    return bin_to_hex(complete_message);
+    unsigned int length = writer.finish();
+    if (length == 0)
+        {
+            LOG(WARNING) << "RTCM message of " << writer.message_bits() << " bits does not fit in a frame";
+            return false;
+        }
+    const unsigned char *frame = writer.frame();
+    if (rtcm_file_descriptor.is_open())
+        {
+            rtcm_file_descriptor.write((const char*)frame, length);
+        }
+    if (rtcm_dev_descriptor != -1)
+        {
+            if (write(rtcm_dev_descriptor, frame, length) != (ssize_t)length)
+                {
+                    DLOG(INFO) << "RTCM printer can not write on serial device " << rtcm_devname.c_str();
+                }
+        }
+    if (rtcm_tcp_server != 0)
+        {
+            rtcm_tcp_server->send(frame, length);
+        }
+    d_frames++;
+    return true;
 }
 
 
-std::string  Rtcm_Printer::bin_to_hex(const std::string& s)
+
+std::string Rtcm_Printer::frame_to_hex(const Rtcm_Bit_Writer& writer)
 {
-    std::string s_aux;
-    std::stringstream ss;
-    for(int i = 0; i < s.length() - 1; i = i + 32)
+    static const char digits[] = "0123456789ABCDEF";
+    std::string hex;
+    hex.reserve(2 * writer.frame_length());
+    for (unsigned int i = 0; i < writer.frame_length(); i++)
         {
-            s_aux.assign(s, i, 32);
-            std::bitset<32> bs(s_aux);
-            unsigned n = bs.to_ulong();
-            ss << std::hex << n;
+            hex += digits[writer.frame()[i] >> 4];
+            hex += digits[writer.frame()[i] & 0x0F];
         }
-    //return ss.str();
-    return boost::to_upper_copy(ss.str());
+    return hex;
 }
-
-
@@ -0,0 +1,135 @@
+/*!
+ * \file rtcm_tcp_server.cc
+ * \brief TCP server that streams RTCM 3 frames to every connected client
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "rtcm_tcp_server.h"
+#include <boost/bind.hpp>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+
+Rtcm_Tcp_Server::Rtcm_Tcp_Server(unsigned short port) :
+        d_acceptor(d_io_service),
+        d_listening(false),
+        d_port(port)
+{
+    boost::system::error_code error;
+    boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::tcp::v4(), port);
+    d_acceptor.open(endpoint.protocol(), error);
+    if (!error) d_acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true), error);
+    if (!error) d_acceptor.bind(endpoint, error);
+    if (!error) d_acceptor.listen(boost::asio::socket_base::max_connections, error);
+    if (error)
+        {
+            LOG(WARNING) << "RTCM server: unable to listen on TCP port " << port << ": " << error.message();
+            return;
+        }
+    d_port = d_acceptor.local_endpoint(error).port();
+    d_listening = true;
+    start_accept();
+    d_thread = boost::thread(boost::bind(&boost::asio::io_service::run, &d_io_service));
+    LOG(INFO) << "RTCM server listening on TCP port " << d_port;
+}
+
+
+
+Rtcm_Tcp_Server::~Rtcm_Tcp_Server()
+{
+    d_io_service.stop();
+    if (d_thread.joinable()) d_thread.join();
+    boost::system::error_code error;
+    d_acceptor.close(error);
+    boost::mutex::scoped_lock lock(d_mutex);
+    for (unsigned int i = 0; i < d_clients.size(); i++)
+        {
+            d_clients[i]->close(error);
+        }
+    d_clients.clear();
+}
+
+
+
+unsigned int Rtcm_Tcp_Server::clients()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    return d_clients.size();
+}
+
+
+
+void Rtcm_Tcp_Server::send(const unsigned char *data, unsigned int length)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    std::vector<socket_ptr>::iterator it = d_clients.begin();
+    while (it != d_clients.end())
+        {
+            boost::system::error_code error;
+            std::size_t written = boost::asio::write(**it, boost::asio::buffer(data, length), error);
+            if (error or written != length)
+                {
+                    // a partial frame would break the stream, the client has to reconnect
+                    LOG(INFO) << "RTCM server: closing the connection with a client: " << error.message();
+                    (*it)->close(error);
+                    it = d_clients.erase(it);
+                }
+            else
+                {
+                    it++;
+                }
+        }
+}
+
+
+
+void Rtcm_Tcp_Server::start_accept()
+{
+    socket_ptr socket(new boost::asio::ip::tcp::socket(d_io_service));
+    d_acceptor.async_accept(*socket, boost::bind(&Rtcm_Tcp_Server::handle_accept, this, socket, boost::asio::placeholders::error));
+}
+
+
+
+void Rtcm_Tcp_Server::handle_accept(socket_ptr socket, const boost::system::error_code& error)
+{
+    if (error == boost::asio::error::operation_aborted) return;
+    if (!error)
+        {
+            boost::system::error_code option_error;
+            socket->non_blocking(true, option_error);
+            socket->set_option(boost::asio::ip::tcp::no_delay(true), option_error);
+            LOG(INFO) << "RTCM server: new client " << socket->remote_endpoint(option_error);
+            boost::mutex::scoped_lock lock(d_mutex);
+            d_clients.push_back(socket);
+        }
+    else
+        {
+            LOG(WARNING) << "RTCM server: " << error.message();
+        }
+    start_accept();
+}
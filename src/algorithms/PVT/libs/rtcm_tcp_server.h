@@ -0,0 +1,84 @@
+/*!
+ * \file rtcm_tcp_server.h
+ * \brief TCP server that streams RTCM 3 frames to every connected client
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_RTCM_TCP_SERVER_H_
+#define GNSS_SDR_RTCM_TCP_SERVER_H_
+
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+
+/*!
+ * \brief Accepts TCP connections (e.g. from an RTK engine) in its own thread
+ * and sends the RTCM frames to all the clients.
+ *
+ * The sockets are non-blocking: a client that can not take a whole frame
+ * is disconnected instead of delaying the other clients and the receiver.
+ */
+class Rtcm_Tcp_Server
+{
+public:
+    /*!
+     * \brief Listens on port (0 for any free port) of every IPv4 interface
+     */
+    Rtcm_Tcp_Server(unsigned short port);
+
+    /*!
+     * \brief Stops accepting connections and closes the clients
+     */
+    ~Rtcm_Tcp_Server();
+
+    bool is_listening() const { return d_listening; }
+    unsigned short port() const { return d_port; } //!< Port the server listens on
+    unsigned int clients();                        //!< Number of connected clients
+
+    /*!
+     * \brief Sends length bytes to every client
+     */
+    void send(const unsigned char *data, unsigned int length);
+
+private:
+    typedef boost::shared_ptr<boost::asio::ip::tcp::socket> socket_ptr;
+    void start_accept();
+    void handle_accept(socket_ptr socket, const boost::system::error_code& error);
+
+    boost::asio::io_service d_io_service;
+    boost::asio::ip::tcp::acceptor d_acceptor;
+    bool d_listening;
+    unsigned short d_port;
+    boost::thread d_thread;
+
+    boost::mutex d_mutex;
+    std::vector<socket_ptr> d_clients;
+};
+
+#endif
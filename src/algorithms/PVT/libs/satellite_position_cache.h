@@ -0,0 +1,265 @@
+/*!
+ * \file satellite_position_cache.h
+ * \brief Cache of satellite positions and clock corrections computed from
+ * the broadcast ephemeris at coarse knots and interpolated at each epoch
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_SATELLITE_POSITION_CACHE_H_
+#define GNSS_SDR_SATELLITE_POSITION_CACHE_H_
+
+#include <cmath>
+#include <limits>
+#include <map>
+#include "gps_ephemeris.h"
+#include "galileo_ephemeris.h"
+
+#define SATELLITE_POSITION_CACHE_KNOT_SPACING_S 30.0 //!< Time between two evaluations of the orbit [s]
+#define SATELLITE_POSITION_CACHE_POINTS 8            //!< Knots used by the interpolation (polynomial degree + 1)
+#define SATELLITE_POSITION_CACHE_SLOTS 16            //!< Knots kept per satellite, a power of two
+
+/*!
+ * \brief Parameters that identify an issue of the ephemeris of a satellite:
+ * reference times of the orbit and of the clock, mean anomaly and square root
+ * of the semi-major axis
+ */
+inline void satellite_position_cache_issue(const Gps_Ephemeris &eph, double *issue)
+{
+    issue[0] = eph.d_Toe;
+    issue[1] = eph.d_Toc;
+    issue[2] = eph.d_M_0;
+    issue[3] = eph.d_sqrt_A;
+}
+
+inline void satellite_position_cache_issue(const Galileo_Ephemeris &eph, double *issue)
+{
+    issue[0] = eph.t0e_1;
+    issue[1] = eph.t0c_4;
+    issue[2] = eph.M0_1;
+    issue[3] = eph.A_1;
+}
+
+
+/*!
+ * \brief Serves the satellite positions, velocities and clock corrections
+ * of an ephemeris type (Gps_Ephemeris or Galileo_Ephemeris).
+ *
+ * The orbit and the clock (sv_clock_drift + sv_clock_relativistic_term) are
+ * evaluated only at knots every SATELLITE_POSITION_CACHE_KNOT_SPACING_S
+ * seconds of transmission time, and any epoch in between is served by
+ * Lagrange interpolation over the SATELLITE_POSITION_CACHE_POINTS nearest
+ * knots; the velocity is the derivative of the interpolating polynomial. The
+ * knots of each satellite are kept in a small direct-mapped table, so
+ * consecutive epochs reuse them and a satellite only allocates memory the first
+ * time it is seen. The knots of a satellite are discarded as soon as it is
+ * evaluated with a different issue of its ephemeris.
+ *
+ * The interpolation error is below 1e-6 m and 1e-15 s for the broadcast orbits.
+ */
+template<class Ephemeris>
+class Satellite_Position_Cache
+{
+public:
+    Satellite_Position_Cache(double knot_spacing_s = SATELLITE_POSITION_CACHE_KNOT_SPACING_S) :
+        d_evaluations(0),
+        d_knot_spacing_s(knot_spacing_s)
+    {
+        // denominators of the Lagrange basis polynomials
+        for (int j = 0; j < SATELLITE_POSITION_CACHE_POINTS; j++)
+            {
+                d_denominators[j] = 1.0;
+                for (int m = 0; m < SATELLITE_POSITION_CACHE_POINTS; m++)
+                    {
+                        if (m != j) d_denominators[j] *= (double)(j - m);
+                    }
+            }
+    }
+
+    /*!
+     * \brief ECEF position [m] and, if vel is not NULL, velocity [m/s] of satellite prn,
+     * computed with eph at transmission time t [s]
+     */
+    void position(int prn, const Ephemeris &eph, double t, double *pos, double *vel)
+    {
+        const Knot *knots[SATELLITE_POSITION_CACHE_POINTS];
+        double weights[SATELLITE_POSITION_CACHE_POINTS];
+        double s = find_knots(prn, eph, t, knots);
+        lagrange_weights(s, weights);
+        for (int c = 0; c < 3; c++)
+            {
+                pos[c] = 0.0;
+                for (int j = 0; j < SATELLITE_POSITION_CACHE_POINTS; j++)
+                    {
+                        pos[c] += weights[j] * knots[j]->pos[c];
+                    }
+            }
+        if (vel != NULL)
+            {
+                lagrange_derivative_weights(s, weights);
+                for (int c = 0; c < 3; c++)
+                    {
+                        vel[c] = 0.0;
+                        for (int j = 0; j < SATELLITE_POSITION_CACHE_POINTS; j++)
+                            {
+                                vel[c] += weights[j] * knots[j]->pos[c];
+                            }
+                        vel[c] = vel[c] / d_knot_spacing_s;
+                    }
+            }
+    }
+
+    /*!
+     * \brief Clock correction of satellite prn (clock drift model plus relativistic term) [s],
+     * computed with eph at transmission time t [s]
+     */
+    double clock_correction(int prn, const Ephemeris &eph, double t)
+    {
+        const Knot *knots[SATELLITE_POSITION_CACHE_POINTS];
+        double weights[SATELLITE_POSITION_CACHE_POINTS];
+        double s = find_knots(prn, eph, t, knots);
+        lagrange_weights(s, weights);
+        double clock = 0.0;
+        for (int j = 0; j < SATELLITE_POSITION_CACHE_POINTS; j++)
+            {
+                clock += weights[j] * knots[j]->clock;
+            }
+        return clock;
+    }
+
+    /*!
+     * \brief Discards all the knots
+     */
+    void clear()
+    {
+        d_satellites.clear();
+    }
+
+    unsigned long int d_evaluations; //!< Number of knots computed from the ephemeris since the creation of the cache
+
+private:
+    struct Knot
+    {
+        long int index;  //!< The knot is at time index * d_knot_spacing_s
+        bool valid;
+        double pos[3];
+        double clock;
+    };
+
+    struct Satellite
+    {
+        Satellite()
+        {
+            // never equal to the issue of an ephemeris
+            for (int i = 0; i < 4; i++) issue[i] = std::numeric_limits<double>::quiet_NaN();
+        }
+        Ephemeris eph;
+        double issue[4];
+        Knot knots[SATELLITE_POSITION_CACHE_SLOTS];
+    };
+
+    /*
+     * Points knots to the SATELLITE_POSITION_CACHE_POINTS knots around t, computing
+     * the missing ones, and returns the position of t in knot units from the first one
+     */
+    double find_knots(int prn, const Ephemeris &eph, double t, const Knot **knots)
+    {
+        Satellite &sat = d_satellites[prn];
+        double issue[4];
+        satellite_position_cache_issue(eph, issue);
+        if (issue[0] != sat.issue[0] or issue[1] != sat.issue[1] or issue[2] != sat.issue[2] or issue[3] != sat.issue[3])
+            {
+                // new satellite, or new ephemeris
+                sat.eph = eph;
+                for (int i = 0; i < 4; i++) sat.issue[i] = issue[i];
+                for (int i = 0; i < SATELLITE_POSITION_CACHE_SLOTS; i++) sat.knots[i].valid = false;
+            }
+        long int first = (long int)floor(t / d_knot_spacing_s) - SATELLITE_POSITION_CACHE_POINTS / 2 + 1;
+        for (int j = 0; j < SATELLITE_POSITION_CACHE_POINTS; j++)
+            {
+                long int index = first + j;
+                Knot &knot = sat.knots[index & (SATELLITE_POSITION_CACHE_SLOTS - 1)];
+                if (knot.valid == false or knot.index != index)
+                    {
+                        double t_knot = (double)index * d_knot_spacing_s;
+                        sat.eph.satellitePosition(t_knot);
+                        knot.pos[0] = sat.eph.d_satpos_X;
+                        knot.pos[1] = sat.eph.d_satpos_Y;
+                        knot.pos[2] = sat.eph.d_satpos_Z;
+                        knot.clock = sat.eph.sv_clock_drift(t_knot) + sat.eph.sv_clock_relativistic_term(t_knot);
+                        knot.index = index;
+                        knot.valid = true;
+                        d_evaluations++;
+                    }
+                knots[j] = &knot;
+            }
+        return t / d_knot_spacing_s - (double)first;
+    }
+
+    void lagrange_weights(double s, double *weights) const
+    {
+        // first barycentric form: l(s) / ((s - j) * denominator_j), with l(s) the product of all the (s - m)
+        double l = 1.0;
+        for (int m = 0; m < SATELLITE_POSITION_CACHE_POINTS; m++)
+            {
+                if (s == (double)m)
+                    {
+                        for (int j = 0; j < SATELLITE_POSITION_CACHE_POINTS; j++) weights[j] = 0.0;
+                        weights[m] = 1.0;
+                        return;
+                    }
+                l *= (s - (double)m);
+            }
+        for (int j = 0; j < SATELLITE_POSITION_CACHE_POINTS; j++)
+            {
+                weights[j] = l / ((s - (double)j) * d_denominators[j]);
+            }
+    }
+
+    void lagrange_derivative_weights(double s, double *weights) const
+    {
+        for (int j = 0; j < SATELLITE_POSITION_CACHE_POINTS; j++)
+            {
+                double w = 0.0;
+                for (int l = 0; l < SATELLITE_POSITION_CACHE_POINTS; l++)
+                    {
+                        if (l == j) continue;
+                        double p = 1.0;
+                        for (int m = 0; m < SATELLITE_POSITION_CACHE_POINTS; m++)
+                            {
+                                if (m != j and m != l) p *= (s - (double)m);
+                            }
+                        w += p;
+                    }
+                weights[j] = w / d_denominators[j];
+            }
+    }
+
+    double d_knot_spacing_s;
+    double d_denominators[SATELLITE_POSITION_CACHE_POINTS];
+    std::map<int, Satellite> d_satellites;
+};
+
+#endif
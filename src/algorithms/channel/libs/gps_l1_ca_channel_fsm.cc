@@ -1,6 +1,6 @@
 /*!
  * \file gps_l1_ca_channel_fsm.cc
- * \brief Implementation of a State Machine for channel using boost::statechart
+ * \brief Implementation of a State Machine for channel, driven by a constant transition table
  * \author Luis Esteve, 2011. luis(at)epsilon-formacion.com
  *
  * -------------------------------------------------------------------------
@@ -36,129 +36,83 @@
 #include "channel.h"
 
 
-struct Ev_gps_channel_start_acquisition: sc::event<Ev_gps_channel_start_acquisition>
-{};
+GpsL1CaChannelFsm::GpsL1CaChannelFsm() :
+        acq_(0),
+        trk_(0),
+        nav_(0),
+        channel_(0),
+        state_(GPS_CHANNEL_FSM_IDLE_S0)
+{}
 
-struct Ev_gps_channel_valid_acquisition: sc::event<Ev_gps_channel_valid_acquisition>
-{};
 
-struct Ev_gps_channel_failed_acquisition_repeat: sc::event<Ev_gps_channel_failed_acquisition_repeat>
-{};
 
-struct Ev_gps_channel_failed_acquisition_no_repeat: sc::event<Ev_gps_channel_failed_acquisition_no_repeat>
-{};
-
-struct Ev_gps_channel_failed_tracking_standby: sc::event<Ev_gps_channel_failed_tracking_standby>
-{};
-
-//struct Ev_gps_channel_failed_tracking_reacq: sc::event<Ev_gps_channel_failed_tracking_reacq>
-//{};
-
-struct gps_channel_idle_fsm_S0: public sc::state<gps_channel_idle_fsm_S0, GpsL1CaChannelFsm>
-{
-public:
-    // sc::transition(event, next state)
-    typedef sc::transition<Ev_gps_channel_start_acquisition, gps_channel_acquiring_fsm_S1> reactions;
-    gps_channel_idle_fsm_S0(my_context ctx) : my_base(ctx)
-    {
-        //std::cout << "Enter Channel_Idle_S0 " << std::endl;
-    }
-};
-
-
-struct gps_channel_acquiring_fsm_S1: public sc::state<gps_channel_acquiring_fsm_S1, GpsL1CaChannelFsm>
-{
-public:
-    typedef mpl::list<sc::transition<Ev_gps_channel_failed_acquisition_no_repeat, gps_channel_waiting_fsm_S3>,
-                      sc::transition<Ev_gps_channel_failed_acquisition_repeat, gps_channel_acquiring_fsm_S1>,
-                      sc::transition<Ev_gps_channel_valid_acquisition, gps_channel_tracking_fsm_S2> > reactions;
-
-    gps_channel_acquiring_fsm_S1(my_context ctx) : my_base(ctx)
-    {
-        //std::cout << "Enter Channel_Acq_S1 " << std::endl;
-        context<GpsL1CaChannelFsm> ().start_acquisition();
-    }
-};
-
-
-struct gps_channel_tracking_fsm_S2: public sc::state<gps_channel_tracking_fsm_S2, GpsL1CaChannelFsm>
-{
-public:
-    typedef mpl::list<sc::transition<Ev_gps_channel_failed_tracking_standby, gps_channel_idle_fsm_S0>,
-                      sc::transition<Ev_gps_channel_start_acquisition, gps_channel_acquiring_fsm_S1>> reactions;
-
-    gps_channel_tracking_fsm_S2(my_context ctx) : my_base(ctx)
-    {
-        //std::cout << "Enter Channel_tracking_S2 " << std::endl;
-        context<GpsL1CaChannelFsm> ().start_tracking();
-    }
+GpsL1CaChannelFsm::GpsL1CaChannelFsm(AcquisitionInterface *acquisition) :
+        acq_(acquisition),
+        trk_(0),
+        nav_(0),
+        channel_(0),
+        state_(GPS_CHANNEL_FSM_IDLE_S0)
+{}
 
-};
 
 
-struct gps_channel_waiting_fsm_S3: public sc::state<gps_channel_waiting_fsm_S3, GpsL1CaChannelFsm>
+void GpsL1CaChannelFsm::process_event(int event)
 {
-public:
-    typedef sc::transition<Ev_gps_channel_start_acquisition,
-            gps_channel_acquiring_fsm_S1> reactions;
-
-    gps_channel_waiting_fsm_S3(my_context ctx) :
-        my_base(ctx)
+    int next_state = gps_channel_fsm_next_state(state_, event);
+    if (next_state < 0)
+        {
+            return; // the event is discarded
+        }
+    state_ = next_state;
+    // entry actions
+    switch (state_)
     {
-        //std::cout << "Enter Channel_waiting_S3 " << std::endl;
-        context<GpsL1CaChannelFsm> ().request_satellite();
+    case GPS_CHANNEL_FSM_ACQUIRING_S1:
+        start_acquisition();
+        break;
+    case GPS_CHANNEL_FSM_TRACKING_S2:
+        start_tracking();
+        break;
+    case GPS_CHANNEL_FSM_WAITING_S3:
+        request_satellite();
+        break;
+    default:
+        break;
     }
-    ~gps_channel_waiting_fsm_S3(){}
-};
-
-
-
-GpsL1CaChannelFsm::GpsL1CaChannelFsm()
-{
-    initiate(); //start the FSM
-}
-
-
-
-GpsL1CaChannelFsm::GpsL1CaChannelFsm(AcquisitionInterface *acquisition) :
-	        acq_(acquisition)
-{
-    initiate(); //start the FSM
 }
 
 
 
 void GpsL1CaChannelFsm::Event_gps_start_acquisition()
 {
-    this->process_event(Ev_gps_channel_start_acquisition());
+    process_event(GPS_CHANNEL_FSM_EV_START_ACQUISITION);
 }
 
 
 void GpsL1CaChannelFsm::Event_gps_valid_acquisition()
 {
-    this->process_event(Ev_gps_channel_valid_acquisition());
+    process_event(GPS_CHANNEL_FSM_EV_VALID_ACQUISITION);
 }
 
 
 void GpsL1CaChannelFsm::Event_gps_failed_acquisition_repeat()
 {
-    this->process_event(Ev_gps_channel_failed_acquisition_repeat());
+    process_event(GPS_CHANNEL_FSM_EV_FAILED_ACQUISITION_REPEAT);
 }
 
 void GpsL1CaChannelFsm::Event_gps_failed_acquisition_no_repeat()
 {
-    this->process_event(Ev_gps_channel_failed_acquisition_no_repeat());
+    process_event(GPS_CHANNEL_FSM_EV_FAILED_ACQUISITION_NO_REPEAT);
 }
 
 
-// Something is wrong here, we are using a memory after it ts freed
 void GpsL1CaChannelFsm::Event_gps_failed_tracking_standby()
 {
-    this->process_event(Ev_gps_channel_failed_tracking_standby());
+    process_event(GPS_CHANNEL_FSM_EV_FAILED_TRACKING_STANDBY);
 }
 
 //void GpsL1CaChannelFsm::Event_gps_failed_tracking_reacq() {
-//	this->process_event(Ev_gps_channel_failed_tracking_reacq());
+//	process_event(GPS_CHANNEL_FSM_EV_FAILED_TRACKING_REACQ);
 //}
 
 void GpsL1CaChannelFsm::set_acquisition(AcquisitionInterface *acquisition)
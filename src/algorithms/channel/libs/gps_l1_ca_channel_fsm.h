@@ -1,6 +1,6 @@
 /*!
  * \file gps_l1_ca_channel_fsm.h
- * \brief Interface of the State Machine for channel using boost::statechart
+ * \brief Interface of the State Machine for channel, driven by a constant transition table
  * \author Luis Esteve, 2011. luis(at)epsilon-formacion.com
  *
  *
@@ -32,15 +32,6 @@
 #ifndef GNSS_SDR_GPS_L1_CA_CHANNEL_FSM_H
 #define GNSS_SDR_GPS_L1_CA_CHANNEL_FSM_H
 
-#include <cstring>
-#include <iostream>
-#include <queue>
-#include <boost/statechart/state_machine.hpp>
-#include <boost/statechart/simple_state.hpp>
-#include <boost/statechart/state.hpp>
-#include <boost/statechart/transition.hpp>
-#include <boost/statechart/custom_reaction.hpp>
-#include <boost/mpl/list.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
 #include <gnuradio/msg_queue.h>
@@ -49,18 +40,54 @@
 #include "telemetry_decoder_interface.h"
 
 
-namespace sc = boost::statechart;
-namespace mpl = boost::mpl;
+enum Gps_Channel_Fsm_State
+{
+    GPS_CHANNEL_FSM_IDLE_S0 = 0,
+    GPS_CHANNEL_FSM_ACQUIRING_S1,
+    GPS_CHANNEL_FSM_TRACKING_S2,
+    GPS_CHANNEL_FSM_WAITING_S3,
+    GPS_CHANNEL_FSM_STATES
+};
+
+enum Gps_Channel_Fsm_Event
+{
+    GPS_CHANNEL_FSM_EV_START_ACQUISITION = 0,
+    GPS_CHANNEL_FSM_EV_VALID_ACQUISITION,
+    GPS_CHANNEL_FSM_EV_FAILED_ACQUISITION_REPEAT,
+    GPS_CHANNEL_FSM_EV_FAILED_ACQUISITION_NO_REPEAT,
+    GPS_CHANNEL_FSM_EV_FAILED_TRACKING_STANDBY,
+    GPS_CHANNEL_FSM_EVENTS
+};
 
-struct gps_channel_idle_fsm_S0;
-struct gps_channel_acquiring_fsm_S1;
-struct gps_channel_tracking_fsm_S2;
-struct gps_channel_waiting_fsm_S3;
+/*!
+ * \brief Next state for each state and event. -1: the state does not react to the event.
+ * A transition to the current state leaves and enters it again (running its entry action).
+ */
+constexpr signed char GPS_CHANNEL_FSM_TRANSITIONS[GPS_CHANNEL_FSM_STATES][GPS_CHANNEL_FSM_EVENTS] =
+{
+    //  start acq                     valid acq                     failed acq repeat             failed acq no repeat        failed trk standby
+    { GPS_CHANNEL_FSM_ACQUIRING_S1, -1,                           -1,                           -1,                         -1 },                      // S0 idle
+    { -1,                           GPS_CHANNEL_FSM_TRACKING_S2,  GPS_CHANNEL_FSM_ACQUIRING_S1, GPS_CHANNEL_FSM_WAITING_S3, -1 },                      // S1 acquiring
+    { GPS_CHANNEL_FSM_ACQUIRING_S1, -1,                           -1,                           -1,                         GPS_CHANNEL_FSM_IDLE_S0 }, // S2 tracking
+    { GPS_CHANNEL_FSM_ACQUIRING_S1, -1,                           -1,                           -1,                         -1 }                       // S3 waiting
+};
 
 /*!
- * \brief This class implements a State Machine for channel using boost::statechart
+ * \brief Next state of the channel FSM, or -1 if the state does not react to the event
  */
-class GpsL1CaChannelFsm: public sc::state_machine<GpsL1CaChannelFsm, gps_channel_idle_fsm_S0>
+constexpr int gps_channel_fsm_next_state(int state, int event)
+{
+    return GPS_CHANNEL_FSM_TRANSITIONS[state][event];
+}
+
+
+/*!
+ * \brief This class implements a State Machine for channel
+ *
+ * The states are an enumeration and the transitions a constant table, so
+ * processing an event is a table lookup and the entry action of the new state.
+ */
+class GpsL1CaChannelFsm
 {
 public:
     GpsL1CaChannelFsm();
@@ -82,12 +109,17 @@ public:
     //void Event_gps_failed_tracking_reacq();
     void Event_gps_failed_tracking_standby();
 
+    int state() const { return state_; } //!< Current Gps_Channel_Fsm_State
+
 private:
+    void process_event(int event);
+
     AcquisitionInterface *acq_;
     TrackingInterface *trk_;
     TelemetryDecoderInterface *nav_;
     boost::shared_ptr<gr::msg_queue> queue_;
     unsigned int channel_;
+    int state_;
 };
 
 #endif /*GNSS_SDR_GPS_L1_CA_CHANNEL_FSM_H*/
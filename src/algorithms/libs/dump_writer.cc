@@ -0,0 +1,265 @@
+/*!
+ * \file dump_writer.cc
+ * \brief Implementation of an asynchronous, buffered binary dump writer.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "dump_writer.h"
+#include <algorithm>
+#include <cstdlib>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+
+Dump_Stream::Dump_Stream(const std::string& filename, size_t record_size, size_t capacity_records, bool lossless) :
+        d_filename(filename),
+        d_buffer(0),
+        d_record_size(record_size),
+        d_capacity(capacity_records),
+        d_lossless(lossless),
+        d_head(0),
+        d_tail(0),
+        d_dropped(0),
+        d_written(0)
+{
+    d_buffer = static_cast<char*>(malloc(d_record_size * d_capacity));
+    try
+    {
+            d_file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+            d_file.open(d_filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    }
+    catch (const std::ofstream::failure& e)
+    {
+            LOG(WARNING) << "Exception opening dump file " << d_filename << ": " << e.what();
+    }
+}
+
+
+
+Dump_Stream::~Dump_Stream()
+{
+    close_file();
+    free(d_buffer);
+}
+
+
+
+bool Dump_Stream::push_after_flush(const void* record)
+{
+    // the ring is full: the producer writes it to disk, and then there is room for the record
+    Dump_Writer::instance().flush_stream(*this);
+    return push(record);
+}
+
+
+
+size_t Dump_Stream::flush_pending()
+{
+    const unsigned long long tail = d_tail.load(std::memory_order_relaxed);
+    const unsigned long long head = d_head.load(std::memory_order_acquire);
+    if (head == tail)
+        {
+            return 0;
+        }
+    unsigned long long pending = head - tail;
+    const size_t first_index = tail % d_capacity;
+    // The pending records are contiguous up to the end of the ring, and then wrap around
+    const size_t first_chunk = std::min<unsigned long long>(pending, d_capacity - first_index);
+    if (d_file.is_open())
+        {
+            try
+            {
+                    d_file.write(d_buffer + first_index * d_record_size, first_chunk * d_record_size);
+                    if (pending > first_chunk)
+                        {
+                            d_file.write(d_buffer, (pending - first_chunk) * d_record_size);
+                        }
+                    d_written.fetch_add(pending, std::memory_order_relaxed);
+            }
+            catch (const std::ofstream::failure& e)
+            {
+                    LOG(WARNING) << "Exception writing dump file " << d_filename << ": " << e.what();
+                    d_dropped.fetch_add(pending, std::memory_order_relaxed);
+                    if (d_lossless)
+                        {
+                            LOG(ERROR) << "Dump file " << d_filename << ": " << pending << " records lost";
+                        }
+            }
+        }
+    else
+        {
+            d_dropped.fetch_add(pending, std::memory_order_relaxed);
+            if (d_lossless)
+                {
+                    LOG(ERROR) << "Dump file " << d_filename << " is closed: " << pending << " records lost";
+                }
+        }
+    d_tail.store(head, std::memory_order_release);
+    return pending * d_record_size;
+}
+
+
+
+void Dump_Stream::close_file()
+{
+    if (d_file.is_open())
+        {
+            try
+            {
+                    d_file.close();
+            }
+            catch (const std::ofstream::failure& e)
+            {
+                    LOG(WARNING) << "Exception closing dump file " << d_filename << ": " << e.what();
+            }
+        }
+}
+
+
+
+Dump_Writer& Dump_Writer::instance()
+{
+    static Dump_Writer writer;
+    return writer;
+}
+
+
+
+Dump_Writer::Dump_Writer() : d_stop(false)
+{
+    d_thread = boost::thread(&Dump_Writer::run, this);
+}
+
+
+
+Dump_Writer::~Dump_Writer()
+{
+    {
+        boost::mutex::scoped_lock lock(d_streams_mutex);
+        d_stop = true;
+    }
+    d_wakeup.notify_one();
+    d_thread.join();
+    flush_all();
+    boost::mutex::scoped_lock lock(d_streams_mutex);
+    for (unsigned int i = 0; i < d_streams.size(); i++)
+        {
+            d_streams.at(i)->close_file();
+        }
+    d_streams.clear();
+}
+
+
+
+boost::shared_ptr<Dump_Stream> Dump_Writer::open_stream(const std::string& filename,
+        size_t record_size,
+        size_t capacity_records,
+        bool lossless)
+{
+    boost::shared_ptr<Dump_Stream> stream(new Dump_Stream(filename, record_size, capacity_records, lossless));
+    if (!stream->is_open())
+        {
+            return boost::shared_ptr<Dump_Stream>();
+        }
+    boost::mutex::scoped_lock lock(d_streams_mutex);
+    d_streams.push_back(stream);
+    return stream;
+}
+
+
+
+void Dump_Writer::close_stream(boost::shared_ptr<Dump_Stream>& stream)
+{
+    if (!stream)
+        {
+            return;
+        }
+    {
+        boost::mutex::scoped_lock lock(d_streams_mutex);
+        d_streams.erase(std::remove(d_streams.begin(), d_streams.end(), stream), d_streams.end());
+    }
+    {
+        boost::mutex::scoped_lock flush_lock(d_flush_mutex);
+        stream->flush_pending();
+        stream->close_file();
+    }
+    if (stream->dropped_records() > 0)
+        {
+            LOG(WARNING) << "Dump file " << stream->filename() << ": " << stream->dropped_records()
+                         << " records dropped, " << stream->written_records() << " records written";
+        }
+    stream.reset();
+}
+
+
+
+void Dump_Writer::flush()
+{
+    flush_all();
+}
+
+
+
+void Dump_Writer::flush_all()
+{
+    std::vector<boost::shared_ptr<Dump_Stream> > streams;
+    {
+        boost::mutex::scoped_lock lock(d_streams_mutex);
+        streams = d_streams;
+    }
+    boost::mutex::scoped_lock flush_lock(d_flush_mutex);
+    for (unsigned int i = 0; i < streams.size(); i++)
+        {
+            streams.at(i)->flush_pending();
+        }
+}
+
+
+
+void Dump_Writer::flush_stream(Dump_Stream& stream)
+{
+    boost::mutex::scoped_lock flush_lock(d_flush_mutex);
+    stream.flush_pending();
+}
+
+
+
+void Dump_Writer::run()
+{
+    const boost::posix_time::milliseconds period(DUMP_WRITER_FLUSH_PERIOD_MS);
+    while (true)
+        {
+            {
+                boost::mutex::scoped_lock lock(d_streams_mutex);
+                if (d_stop) break;
+                d_wakeup.timed_wait(lock, period);
+                if (d_stop) break;
+            }
+            flush_all();
+        }
+}
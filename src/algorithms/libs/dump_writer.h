@@ -0,0 +1,165 @@
+/*!
+ * \file dump_writer.h
+ * \brief Interface of an asynchronous, buffered binary dump writer.
+ *
+ * Signal processing blocks push fixed-size records into a lock-free,
+ * single-producer / single-consumer ring owned by a Dump_Stream. A single
+ * background thread (Dump_Writer) drains all the open streams and writes
+ * their contents to disk with large sequential writes. If the disk cannot
+ * keep up, records are dropped and counted instead of stalling the
+ * signal processing thread.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_DUMP_WRITER_H_
+#define GNSS_SDR_DUMP_WRITER_H_
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#define DUMP_STREAM_DEFAULT_CAPACITY 8192 // records (about 8 s of a 1 ms tracking loop)
+#define DUMP_WRITER_FLUSH_PERIOD_MS 20
+
+
+/*!
+ * \brief A binary dump file fed through a lock-free ring of fixed-size records.
+ *
+ * Only one thread may call push(). The ring is drained by the Dump_Writer thread.
+ * A lossless stream never drops a record because its ring is full: push() then
+ * writes the ring to disk in the calling thread.
+ */
+class Dump_Stream
+{
+public:
+    ~Dump_Stream();
+
+    /*!
+     * \brief Copies one record of record_size() bytes into the ring.
+     * Returns false (and counts the record as dropped) if the ring is full
+     * and the stream is not lossless.
+     */
+    bool push(const void* record)
+    {
+        const unsigned long long head = d_head.load(std::memory_order_relaxed);
+        const unsigned long long tail = d_tail.load(std::memory_order_acquire);
+        if (head - tail >= d_capacity)
+            {
+                if (d_lossless)
+                    {
+                        return push_after_flush(record);
+                    }
+                d_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        memcpy(d_buffer + (head % d_capacity) * d_record_size, record, d_record_size);
+        d_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    template<typename Record>
+    bool push_record(const Record& record)
+    {
+        return push(static_cast<const void*>(&record));
+    }
+
+    bool is_open() const { return d_file.is_open(); }
+    bool is_lossless() const { return d_lossless; }
+    size_t record_size() const { return d_record_size; }
+    unsigned long long dropped_records() const { return d_dropped.load(std::memory_order_relaxed); }
+    unsigned long long written_records() const { return d_written.load(std::memory_order_relaxed); }
+    std::string filename() const { return d_filename; }
+
+private:
+    friend class Dump_Writer;
+    Dump_Stream(const std::string& filename, size_t record_size, size_t capacity_records, bool lossless);
+    bool push_after_flush(const void* record);
+    size_t flush_pending(); // consumer side, only called by Dump_Writer
+    void close_file();
+
+    std::string d_filename;
+    std::ofstream d_file;
+    char* d_buffer;
+    size_t d_record_size;
+    size_t d_capacity;
+    bool d_lossless;
+    std::atomic<unsigned long long> d_head;
+    std::atomic<unsigned long long> d_tail;
+    std::atomic<unsigned long long> d_dropped;
+    std::atomic<unsigned long long> d_written;
+};
+
+
+/*!
+ * \brief Receiver-wide background thread that writes all open Dump_Stream objects to disk.
+ */
+class Dump_Writer
+{
+public:
+    static Dump_Writer& instance();
+    ~Dump_Writer();
+
+    /*!
+     * \brief Opens (truncating) the binary file and registers a new stream for it.
+     * Returns an empty pointer if the file cannot be opened.
+     */
+    boost::shared_ptr<Dump_Stream> open_stream(const std::string& filename,
+            size_t record_size,
+            size_t capacity_records = DUMP_STREAM_DEFAULT_CAPACITY,
+            bool lossless = false);
+
+    /*!
+     * \brief Writes the pending records, closes the file and unregisters the stream.
+     */
+    void close_stream(boost::shared_ptr<Dump_Stream>& stream);
+
+    /*!
+     * \brief Blocks until every record pushed so far has been written to disk.
+     */
+    void flush();
+
+private:
+    friend class Dump_Stream;
+    Dump_Writer();
+    void run();
+    void flush_all();
+    void flush_stream(Dump_Stream& stream);
+
+    std::vector<boost::shared_ptr<Dump_Stream> > d_streams;
+    boost::mutex d_streams_mutex; // protects d_streams
+    boost::mutex d_flush_mutex;   // serializes the consumer side of the rings
+    boost::condition_variable d_wakeup;
+    bool d_stop;
+    boost::thread d_thread;
+};
+
+#endif /*GNSS_SDR_DUMP_WRITER_H_*/
@@ -0,0 +1,234 @@
+/*!
+ * \file nav_archive.cc
+ * \brief Implementation of the records and reader of the navigation data archive
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "nav_archive.h"
+#include <cstring>
+#include <sstream>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+
+std::string nav_archive_filename(const std::string& basename, int channel)
+{
+    std::stringstream filename;
+    filename << basename << channel << ".dat";
+    return filename.str();
+}
+
+
+
+void nav_archive_epoch_record(const Gnss_Synchro& gnss_synchro, unsigned long long item, Nav_Archive_Record& record)
+{
+    memset(&record, 0, sizeof(Nav_Archive_Record));
+    record.item = item;
+    record.type = NAV_ARCHIVE_EPOCH;
+    record.system = gnss_synchro.System;
+    record.signal[0] = gnss_synchro.Signal[0];
+    record.signal[1] = gnss_synchro.Signal[1];
+    record.prn = static_cast<unsigned short>(gnss_synchro.PRN);
+    if (gnss_synchro.Flag_valid_word) record.flags |= NAV_ARCHIVE_FLAG_VALID_WORD;
+    if (gnss_synchro.Flag_preamble) record.flags |= NAV_ARCHIVE_FLAG_PREAMBLE;
+    if (gnss_synchro.Flag_valid_tracking) record.flags |= NAV_ARCHIVE_FLAG_VALID_TRACKING;
+    record.epoch.tracking_timestamp_secs = gnss_synchro.Tracking_timestamp_secs;
+    record.epoch.prn_timestamp_ms = gnss_synchro.Prn_timestamp_ms;
+    record.epoch.prn_timestamp_at_preamble_ms = gnss_synchro.Prn_timestamp_at_preamble_ms;
+    record.epoch.tow = gnss_synchro.d_TOW;
+    record.epoch.tow_at_current_symbol = gnss_synchro.d_TOW_at_current_symbol;
+    record.epoch.carrier_phase_rads = gnss_synchro.Carrier_phase_rads;
+    record.epoch.carrier_doppler_hz = gnss_synchro.Carrier_Doppler_hz;
+    record.epoch.cn0_db_hz = gnss_synchro.CN0_dB_hz;
+}
+
+
+
+void nav_archive_nav_record(unsigned char type, const Gnss_Synchro& gnss_synchro, unsigned long long item,
+        double preamble_time_ms, const unsigned char* bits, unsigned int nbytes, Nav_Archive_Record& record)
+{
+    memset(&record, 0, sizeof(Nav_Archive_Record));
+    record.item = item;
+    record.type = type;
+    record.system = gnss_synchro.System;
+    record.signal[0] = gnss_synchro.Signal[0];
+    record.signal[1] = gnss_synchro.Signal[1];
+    record.prn = static_cast<unsigned short>(gnss_synchro.PRN);
+    record.nav.preamble_time_ms = preamble_time_ms;
+    if (nbytes > NAV_ARCHIVE_NAV_DATA_BYTES) nbytes = NAV_ARCHIVE_NAV_DATA_BYTES;
+    memcpy(record.nav.bits, bits, nbytes);
+}
+
+
+
+void nav_archive_to_gnss_synchro(const Nav_Archive_Record& record, int channel_id, Gnss_Synchro& gnss_synchro)
+{
+    gnss_synchro = Gnss_Synchro();
+    gnss_synchro.System = record.system;
+    gnss_synchro.Signal[0] = record.signal[0];
+    gnss_synchro.Signal[1] = record.signal[1];
+    gnss_synchro.Signal[2] = '\0';
+    gnss_synchro.PRN = record.prn;
+    gnss_synchro.Channel_ID = channel_id;
+    gnss_synchro.Flag_valid_word = (record.flags & NAV_ARCHIVE_FLAG_VALID_WORD) != 0;
+    gnss_synchro.Flag_preamble = (record.flags & NAV_ARCHIVE_FLAG_PREAMBLE) != 0;
+    gnss_synchro.Flag_valid_tracking = (record.flags & NAV_ARCHIVE_FLAG_VALID_TRACKING) != 0;
+    gnss_synchro.Tracking_timestamp_secs = record.epoch.tracking_timestamp_secs;
+    gnss_synchro.Prn_timestamp_ms = record.epoch.prn_timestamp_ms;
+    gnss_synchro.Prn_timestamp_at_preamble_ms = record.epoch.prn_timestamp_at_preamble_ms;
+    gnss_synchro.d_TOW = record.epoch.tow;
+    gnss_synchro.d_TOW_at_current_symbol = record.epoch.tow_at_current_symbol;
+    gnss_synchro.Carrier_phase_rads = record.epoch.carrier_phase_rads;
+    gnss_synchro.Carrier_Doppler_hz = record.epoch.carrier_doppler_hz;
+    gnss_synchro.CN0_dB_hz = record.epoch.cn0_db_hz;
+}
+
+
+
+Nav_Archive_Reader::Nav_Archive_Reader() : d_records(0), d_next(0)
+{}
+
+
+
+Nav_Archive_Reader::~Nav_Archive_Reader()
+{
+    close();
+}
+
+
+
+bool Nav_Archive_Reader::open(const std::string& filename)
+{
+    close();
+    d_file.open(filename.c_str(), std::ios::in | std::ios::binary);
+    if (!d_file.is_open())
+        {
+            LOG(WARNING) << "Unable to open navigation data archive " << filename;
+            return false;
+        }
+    d_file.seekg(0, std::ios::end);
+    std::streamoff size = d_file.tellg();
+    d_file.seekg(0, std::ios::beg);
+    d_records = static_cast<unsigned long long>(size) / sizeof(Nav_Archive_Record);
+    d_next = 0;
+    if (size % sizeof(Nav_Archive_Record) != 0)
+        {
+            LOG(WARNING) << "Navigation data archive " << filename << " ends with a truncated record";
+        }
+    LOG(INFO) << "Navigation data archive " << filename << ": " << d_records << " records";
+    return true;
+}
+
+
+
+void Nav_Archive_Reader::close()
+{
+    if (d_file.is_open())
+        {
+            d_file.close();
+        }
+    d_file.clear();
+    d_records = 0;
+    d_next = 0;
+}
+
+
+
+bool Nav_Archive_Reader::read_record(unsigned long long index, Nav_Archive_Record& record)
+{
+    if (index >= d_records) return false;
+    d_file.clear();
+    d_file.seekg(static_cast<std::streamoff>(index * sizeof(Nav_Archive_Record)), std::ios::beg);
+    d_file.read(reinterpret_cast<char*>(&record), sizeof(Nav_Archive_Record));
+    return !d_file.fail();
+}
+
+
+
+bool Nav_Archive_Reader::next(Nav_Archive_Record& record)
+{
+    if (d_next >= d_records) return false;
+    if (!read_record(d_next, record)) return false;
+    d_next++;
+    return true;
+}
+
+
+
+bool Nav_Archive_Reader::epoch_time_at(unsigned long long index, double& tracking_timestamp_secs)
+{
+    // navigation data records do not carry a time stamp: use the next epoch record
+    Nav_Archive_Record record;
+    for (unsigned long long i = index; i < d_records; i++)
+        {
+            if (!read_record(i, record)) return false;
+            if (record.type == NAV_ARCHIVE_EPOCH)
+                {
+                    tracking_timestamp_secs = record.epoch.tracking_timestamp_secs;
+                    return true;
+                }
+        }
+    return false;
+}
+
+
+
+bool Nav_Archive_Reader::seek_time(double tracking_timestamp_secs)
+{
+    unsigned long long low = 0;
+    unsigned long long high = d_records;
+    double t;
+    while (low < high)
+        {
+            unsigned long long mid = low + (high - low) / 2;
+            if (epoch_time_at(mid, t) && t < tracking_timestamp_secs)
+                {
+                    low = mid + 1;
+                }
+            else
+                {
+                    high = mid;
+                }
+        }
+    // skip the navigation data records up to the epoch found
+    Nav_Archive_Record record;
+    while (low < d_records && read_record(low, record) && record.type != NAV_ARCHIVE_EPOCH)
+        {
+            low++;
+        }
+    d_next = low;
+    return low < d_records;
+}
+
+
+
+bool Nav_Archive_Reader::seek(unsigned long long record_index)
+{
+    if (record_index > d_records) return false;
+    d_next = record_index;
+    return true;
+}
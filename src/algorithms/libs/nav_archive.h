@@ -0,0 +1,168 @@
+/*!
+ * \file nav_archive.h
+ * \brief Records and reader of the navigation data archive written by the
+ * telemetry decoders and replayed by the Nav_Archive_Signal_Source.
+ *
+ * Each channel writes its own archive file, a flat array of fixed-size
+ * records (so record k is at byte k * sizeof(Nav_Archive_Record)):
+ *  - one NAV_ARCHIVE_EPOCH record per output item of the telemetry decoder,
+ *    holding the Gnss_Synchro fields used by the observables and PVT blocks,
+ *  - one NAV_ARCHIVE_GPS_SUBFRAME or NAV_ARCHIVE_GALILEO_PAGE_PART record each
+ *    time the decoder gets new navigation data, written before the epoch
+ *    record of the item in which it was decoded.
+ * The item numbers and time stamps of the epoch records grow monotonically,
+ * which is what the reader uses as index to seek by time.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_NAV_ARCHIVE_H_
+#define GNSS_SDR_NAV_ARCHIVE_H_
+
+#include <fstream>
+#include <string>
+#include "gnss_synchro.h"
+
+#define NAV_ARCHIVE_EPOCH 1
+#define NAV_ARCHIVE_GPS_SUBFRAME 2
+#define NAV_ARCHIVE_GALILEO_PAGE_PART 3
+
+#define NAV_ARCHIVE_FLAG_VALID_WORD 0x01
+#define NAV_ARCHIVE_FLAG_PREAMBLE 0x02
+#define NAV_ARCHIVE_FLAG_VALID_TRACKING 0x04
+
+#define NAV_ARCHIVE_STREAM_CAPACITY 65536 // records (about one minute of a 1 ms telemetry decoder), written losslessly
+#define NAV_ARCHIVE_NAV_DATA_BYTES 56
+
+
+/*!
+ * \brief Gnss_Synchro fields of an output item of the telemetry decoder
+ */
+struct Nav_Archive_Epoch
+{
+    double tracking_timestamp_secs;
+    double prn_timestamp_ms;
+    double prn_timestamp_at_preamble_ms;
+    double tow;
+    double tow_at_current_symbol;
+    double carrier_phase_rads;
+    double carrier_doppler_hz;
+    double cn0_db_hz;
+} __attribute__((packed));
+
+
+/*!
+ * \brief Navigation data bits: a GPS subframe (10 words of GPS_WORD_LENGTH bytes, as
+ * stored by the subframe FSM) or a Galileo I/NAV page part (GALILEO_INAV_PAGE_PART_BITS
+ * bits after Viterbi decoding, packed MSB first)
+ */
+struct Nav_Archive_Nav_Data
+{
+    double preamble_time_ms;
+    unsigned char bits[NAV_ARCHIVE_NAV_DATA_BYTES];
+} __attribute__((packed));
+
+
+struct Nav_Archive_Record
+{
+    unsigned long long item;   //!< Output item of the channel this record belongs to
+    unsigned char type;        //!< NAV_ARCHIVE_EPOCH, NAV_ARCHIVE_GPS_SUBFRAME or NAV_ARCHIVE_GALILEO_PAGE_PART
+    char system;               //!< Gnss_Synchro::System
+    char signal[2];            //!< Gnss_Synchro::Signal
+    unsigned short prn;
+    unsigned char flags;       //!< NAV_ARCHIVE_FLAG_* (epoch records)
+    unsigned char reserved;
+    union
+    {
+        Nav_Archive_Epoch epoch;
+        Nav_Archive_Nav_Data nav;
+    };
+} __attribute__((packed));
+
+
+/*!
+ * \brief Archive file of a channel: basename followed by the channel number and ".dat"
+ */
+std::string nav_archive_filename(const std::string& basename, int channel);
+
+/*!
+ * \brief Fills an epoch record with the telemetry decoder output
+ */
+void nav_archive_epoch_record(const Gnss_Synchro& gnss_synchro, unsigned long long item, Nav_Archive_Record& record);
+
+/*!
+ * \brief Fills a navigation data record (the payload is copied from bits)
+ */
+void nav_archive_nav_record(unsigned char type, const Gnss_Synchro& gnss_synchro, unsigned long long item,
+        double preamble_time_ms, const unsigned char* bits, unsigned int nbytes, Nav_Archive_Record& record);
+
+/*!
+ * \brief Restores the Gnss_Synchro of an epoch record, as seen by the observables block
+ */
+void nav_archive_to_gnss_synchro(const Nav_Archive_Record& record, int channel_id, Gnss_Synchro& gnss_synchro);
+
+
+/*!
+ * \brief Sequential reader of an archive file, with seek by time
+ */
+class Nav_Archive_Reader
+{
+public:
+    Nav_Archive_Reader();
+    ~Nav_Archive_Reader();
+
+    bool open(const std::string& filename);
+    void close();
+    bool is_open() const { return d_file.is_open(); }
+    unsigned long long records() const { return d_records; }
+    unsigned long long position() const { return d_next; } //!< Index of the record returned by the next call to next()
+
+    /*!
+     * \brief Reads the next record. Returns false at the end of the file.
+     */
+    bool next(Nav_Archive_Record& record);
+
+    /*!
+     * \brief Positions the reader at the first epoch record with a tracking time stamp
+     * not lower than tracking_timestamp_secs (binary search over the fixed-size records).
+     * Returns false if there is no such record.
+     */
+    bool seek_time(double tracking_timestamp_secs);
+
+    /*!
+     * \brief Positions the reader at the given record index
+     */
+    bool seek(unsigned long long record_index);
+
+private:
+    bool read_record(unsigned long long index, Nav_Archive_Record& record);
+    bool epoch_time_at(unsigned long long index, double& tracking_timestamp_secs);
+
+    std::ifstream d_file;
+    unsigned long long d_records;
+    unsigned long long d_next;
+};
+
+#endif /*GNSS_SDR_NAV_ARCHIVE_H_*/
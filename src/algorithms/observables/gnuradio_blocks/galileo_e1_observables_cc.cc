@@ -31,10 +31,8 @@
 
 #include "galileo_e1_observables_cc.h"
 #include <algorithm>
-#include <bitset>
 #include <cmath>
 #include <iostream>
-#include <map>
 #include <sstream>
 #include <vector>
 #include <gnuradio/io_signature.h>
@@ -61,9 +59,12 @@ galileo_e1_observables_cc::galileo_e1_observables_cc(unsigned int nchannels, boo
     d_queue = queue;
     d_dump = dump;
     d_nchannels = nchannels;
-    d_output_rate_ms = output_rate_ms;
+    d_output_rate_ms = output_rate_ms > 0 ? output_rate_ms : 1;
     d_dump_filename = dump_filename;
     d_flag_averaging = flag_averaging;
+    d_sample_counter = 0;
+    d_valid_channels.resize(d_nchannels); // indexes of the channels with a valid word in the current epoch
+    set_relative_rate(1.0 / (double)d_output_rate_ms); // one output epoch every d_output_rate_ms input epochs
 
     // ############# ENABLE DATA FILE LOG #################
     if (d_dump == true)
@@ -93,114 +94,109 @@ galileo_e1_observables_cc::~galileo_e1_observables_cc()
 
 
 
-bool Galileo_pairCompare_gnss_synchro_Prn_delay_ms( std::pair<int,Gnss_Synchro> a, std::pair<int,Gnss_Synchro> b)
-{
-    return (a.second.Prn_timestamp_ms) < (b.second.Prn_timestamp_ms);
-}
-
-
-
-bool Galileo_pairCompare_gnss_synchro_d_TOW_at_current_symbol( std::pair<int,Gnss_Synchro> a, std::pair<int,Gnss_Synchro> b)
-{
-    return (a.second.d_TOW_at_current_symbol) < (b.second.d_TOW_at_current_symbol);
-}
-
-
-
 int galileo_e1_observables_cc::general_work (int noutput_items, gr_vector_int &ninput_items,
         gr_vector_const_void_star &input_items,	gr_vector_void_star &output_items)
 {
     Gnss_Synchro **in = (Gnss_Synchro **)  &input_items[0];   // Get the input pointer
     Gnss_Synchro **out = (Gnss_Synchro **)  &output_items[0]; // Get the output pointer
 
-    Gnss_Synchro current_gnss_synchro[d_nchannels];
-    std::map<int,Gnss_Synchro> current_gnss_synchro_map;
-    std::map<int,Gnss_Synchro>::iterator gnss_synchro_iter;
-    d_sample_counter++; //count for the processed samples
-    /*
-     * 1. Read the GNSS SYNCHRO objects from available channels
-     */
-    for (unsigned int i = 0; i < d_nchannels; i++)
+    // process all the epochs available in every channel
+    int n_epochs = ninput_items[0];
+    for (unsigned int i = 1; i < d_nchannels; i++)
         {
-            //Copy the telemetry decoder data to local copy
-            current_gnss_synchro[i] = in[i][0];
-            /*
-             * 1.2 Assume no valid pseudoranges
-             */
-            current_gnss_synchro[i].Flag_valid_pseudorange = false;
-            current_gnss_synchro[i].Pseudorange_m = 0.0;
-            if (current_gnss_synchro[i].Flag_valid_word)
-                {
-                    //record the word structure in a map for pseudorange computation
-                    current_gnss_synchro_map.insert(std::pair<int, Gnss_Synchro>(current_gnss_synchro[i].Channel_ID, current_gnss_synchro[i]));
-                }
+            if (ninput_items[i] < n_epochs) n_epochs = ninput_items[i];
         }
 
-    /*
-     * 2. Compute RAW pseudoranges using COMMON RECEPTION TIME algorithm. Use only the valid channels (channels that are tracking a satellite)
-     */
-    if(current_gnss_synchro_map.size() > 0)
+    int k;
+    int n_outputs = 0;
+    for (k = 0; k < n_epochs and n_outputs < noutput_items; k++)
         {
+            d_sample_counter++; //count for the processed samples
+            // only the epochs at the output rate are delivered to the PVT
+            if ((d_sample_counter % d_output_rate_ms) != 0) continue;
             /*
-             *  2.1 Use CURRENT set of measurements and find the nearest satellite
-             *  common RX time algorithm
+             * 1. Read the GNSS SYNCHRO objects from available channels, straight into the outputs
              */
-            // what is the most recent symbol TOW in the current set? -> this will be the reference symbol
-            gnss_synchro_iter = max_element(current_gnss_synchro_map.begin(), current_gnss_synchro_map.end(), Galileo_pairCompare_gnss_synchro_d_TOW_at_current_symbol);
-            double d_TOW_reference = gnss_synchro_iter->second.d_TOW_at_current_symbol;
-            double d_ref_PRN_rx_time_ms = gnss_synchro_iter->second.Prn_timestamp_ms;
-            //int reference_channel= gnss_synchro_iter->second.Channel_ID;
-
-            // Now compute RX time differences due to the PRN alignment in the correlators
-            double traveltime_ms;
-            double pseudorange_m;
-            double delta_rx_time_ms;
-            for(gnss_synchro_iter = current_gnss_synchro_map.begin(); gnss_synchro_iter != current_gnss_synchro_map.end(); gnss_synchro_iter++)
+            unsigned int n_valid = 0;
+            unsigned int reference_channel = 0;
+            for (unsigned int i = 0; i < d_nchannels; i++)
                 {
-                    // compute the required symbol history shift in order to match the reference symbol
-                    delta_rx_time_ms = gnss_synchro_iter->second.Prn_timestamp_ms-d_ref_PRN_rx_time_ms;
-                    //compute the pseudorange
-                    traveltime_ms = (d_TOW_reference - gnss_synchro_iter->second.d_TOW_at_current_symbol)*1000.0 + delta_rx_time_ms + GALILEO_STARTOFFSET_ms;
-                    pseudorange_m = traveltime_ms * GALILEO_C_m_ms; // [m]
-                    // update the pseudorange object
-                    //current_gnss_synchro[gnss_synchro_iter->second.Channel_ID] = gnss_synchro_iter->second;
-                    current_gnss_synchro[gnss_synchro_iter->second.Channel_ID].Pseudorange_m = pseudorange_m;
-                    current_gnss_synchro[gnss_synchro_iter->second.Channel_ID].Flag_valid_pseudorange = true;
-                    current_gnss_synchro[gnss_synchro_iter->second.Channel_ID].d_TOW_at_current_symbol = round(d_TOW_reference*1000)/1000 + GALILEO_STARTOFFSET_ms/1000.0;
+                    //Copy the telemetry decoder data to the output
+                    Gnss_Synchro &current_gnss_synchro = out[i][n_outputs];
+                    current_gnss_synchro = in[i][k];
+                    /*
+                     * 1.2 Assume no valid pseudoranges
+                     */
+                    current_gnss_synchro.Flag_valid_pseudorange = false;
+                    current_gnss_synchro.Pseudorange_m = 0.0;
+                    if (current_gnss_synchro.Flag_valid_word) //if this channel have valid word
+                        {
+                            // what is the most recent symbol TOW in the current set? -> this will be the reference symbol
+                            if (n_valid == 0 or current_gnss_synchro.d_TOW_at_current_symbol > out[reference_channel][n_outputs].d_TOW_at_current_symbol)
+                                {
+                                    reference_channel = i;
+                                }
+                            d_valid_channels[n_valid] = i;
+                            n_valid++;
+                        }
                 }
-        }
 
-      if(d_dump == true)
-        {
-            // MULTIPLEXED FILE RECORDING - Record results to file
-            try
-            {
-                    double tmp_double;
-                    for (unsigned int i = 0; i < d_nchannels ; i++)
+            /*
+             * 2. Compute RAW pseudoranges using COMMON RECEPTION TIME algorithm. Use only the valid channels (channels that are tracking a satellite)
+             */
+            if (n_valid > 0)
+                {
+                    double d_TOW_reference = out[reference_channel][n_outputs].d_TOW_at_current_symbol;
+                    double d_ref_PRN_rx_time_ms = out[reference_channel][n_outputs].Prn_timestamp_ms;
+
+                    // Now compute RX time differences due to the PRN alignment in the correlators
+                    double traveltime_ms;
+                    double pseudorange_m;
+                    double delta_rx_time_ms;
+                    for (unsigned int j = 0; j < n_valid; j++)
                         {
-                            tmp_double = current_gnss_synchro[i].d_TOW_at_current_symbol;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            tmp_double = current_gnss_synchro[i].Prn_timestamp_ms;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            tmp_double = current_gnss_synchro[i].Pseudorange_m;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            tmp_double = (double)(current_gnss_synchro[i].Flag_valid_pseudorange==true);
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
-                            tmp_double = current_gnss_synchro[i].PRN;
-                            d_dump_file.write((char*)&tmp_double, sizeof(double));
+                            Gnss_Synchro &current_gnss_synchro = out[d_valid_channels[j]][n_outputs];
+                            // compute the required symbol history shift in order to match the reference symbol
+                            delta_rx_time_ms = current_gnss_synchro.Prn_timestamp_ms - d_ref_PRN_rx_time_ms;
+                            //compute the pseudorange
+                            traveltime_ms = (d_TOW_reference - current_gnss_synchro.d_TOW_at_current_symbol)*1000.0 + delta_rx_time_ms + GALILEO_STARTOFFSET_ms;
+                            pseudorange_m = traveltime_ms * GALILEO_C_m_ms; // [m]
+                            // update the pseudorange object
+                            current_gnss_synchro.Pseudorange_m = pseudorange_m;
+                            current_gnss_synchro.Flag_valid_pseudorange = true;
+                            current_gnss_synchro.d_TOW_at_current_symbol = round(d_TOW_reference*1000)/1000 + GALILEO_STARTOFFSET_ms/1000.0;
                         }
-            }
-            catch (const std::ifstream::failure& e)
-            {
-                    LOG(WARNING) << "Exception writing observables dump file " << e.what();
-            }
-        }
+                }
 
-    consume_each(1); //one by one
-    for (unsigned int i = 0; i < d_nchannels ; i++)
-        {
-            *out[i] = current_gnss_synchro[i];
+            if(d_dump == true)
+                {
+                    // MULTIPLEXED FILE RECORDING - Record results to file
+                    try
+                    {
+                            double tmp_double;
+                            for (unsigned int i = 0; i < d_nchannels; i++)
+                                {
+                                    tmp_double = out[i][n_outputs].d_TOW_at_current_symbol;
+                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
+                                    tmp_double = out[i][n_outputs].Prn_timestamp_ms;
+                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
+                                    tmp_double = out[i][n_outputs].Pseudorange_m;
+                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
+                                    tmp_double = (double)(out[i][n_outputs].Flag_valid_pseudorange==true);
+                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
+                                    tmp_double = out[i][n_outputs].PRN;
+                                    d_dump_file.write((char*)&tmp_double, sizeof(double));
+                                }
+                    }
+                    catch (const std::ifstream::failure& e)
+                    {
+                            LOG(WARNING) << "Exception writing observables dump file " << e.what();
+                    }
+                }
+            n_outputs++;
         }
-    return 1; //Output the observables
+
+    consume_each(k);
+    return n_outputs; // Output the observables
 }
 
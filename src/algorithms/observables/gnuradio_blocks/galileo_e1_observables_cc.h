@@ -37,6 +37,7 @@
 #include <queue>
 #include <string>
 #include <utility>
+#include <vector>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
 #include <gnuradio/block.h>
@@ -76,6 +77,7 @@ private:
     bool d_flag_averaging;
     long int d_sample_counter;
     unsigned int d_nchannels;
+    std::vector<unsigned int> d_valid_channels;
     unsigned long int d_fs_in;
     int d_output_rate_ms;
     std::string d_dump_filename;
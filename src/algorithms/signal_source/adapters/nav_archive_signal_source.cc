@@ -0,0 +1,105 @@
+/*!
+ * \file nav_archive_signal_source.cc
+ * \brief Signal source that replays the navigation data archive written by
+ * the telemetry decoders, bypassing acquisition, tracking and telemetry decoding
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "nav_archive_signal_source.h"
+#include <glog/logging.h>
+#include "configuration_interface.h"
+#include "gnss_synchro.h"
+
+extern concurrent_queue<Gps_Ephemeris> global_gps_ephemeris_queue;
+extern concurrent_queue<Gps_Iono> global_gps_iono_queue;
+extern concurrent_queue<Gps_Utc_Model> global_gps_utc_model_queue;
+extern concurrent_queue<Gps_Almanac> global_gps_almanac_queue;
+
+extern concurrent_queue<Galileo_Ephemeris> global_galileo_ephemeris_queue;
+extern concurrent_queue<Galileo_Iono> global_galileo_iono_queue;
+extern concurrent_queue<Galileo_Utc_Model> global_galileo_utc_model_queue;
+extern concurrent_queue<Galileo_Almanac> global_galileo_almanac_queue;
+
+using google::LogMessage;
+
+
+NavArchiveSignalSource::NavArchiveSignalSource(ConfigurationInterface* configuration,
+        std::string role, unsigned int in_streams, unsigned int out_streams,
+        boost::shared_ptr<gr::msg_queue> queue) :
+                role_(role), in_streams_(in_streams), out_streams_(out_streams), queue_(queue)
+{
+    std::string default_archive_filename = "./nav_archive";
+
+    archive_filename_ = configuration->property(role + ".archive_filename", default_archive_filename);
+    start_time_s_ = configuration->property(role + ".start_time_s", 0.0);
+    channels_ = configuration->property("Channels.count", 12);
+    item_size_ = sizeof(Gnss_Synchro);
+
+    replay_source_ = nav_archive_make_replay_source(archive_filename_, channels_, start_time_s_);
+    replay_source_->set_gps_queues(&global_gps_ephemeris_queue, &global_gps_iono_queue,
+            &global_gps_almanac_queue, &global_gps_utc_model_queue);
+    replay_source_->set_galileo_queues(&global_galileo_ephemeris_queue, &global_galileo_iono_queue,
+            &global_galileo_almanac_queue, &global_galileo_utc_model_queue);
+
+    DLOG(INFO) << "replay_source(" << replay_source_->unique_id() << ")";
+    LOG(INFO) << "Replaying the navigation data archive " << archive_filename_
+              << " on " << channels_ << " channels from " << start_time_s_ << " [s]";
+}
+
+
+
+NavArchiveSignalSource::~NavArchiveSignalSource()
+{}
+
+
+
+void NavArchiveSignalSource::connect(gr::top_block_sptr top_block)
+{
+    // Nothing to connect internally
+    DLOG(INFO) << "nothing to connect internally";
+}
+
+
+
+void NavArchiveSignalSource::disconnect(gr::top_block_sptr top_block)
+{
+    // Nothing to disconnect
+}
+
+
+
+gr::basic_block_sptr NavArchiveSignalSource::get_left_block()
+{
+    LOG(WARNING) << "Left block of a signal source should not be retrieved";
+    return gr::block_sptr();
+}
+
+
+
+gr::basic_block_sptr NavArchiveSignalSource::get_right_block()
+{
+    return replay_source_;
+}
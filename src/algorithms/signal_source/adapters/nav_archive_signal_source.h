@@ -0,0 +1,98 @@
+/*!
+ * \file nav_archive_signal_source.h
+ * \brief Signal source that replays the navigation data archive written by
+ * the telemetry decoders, bypassing acquisition, tracking and telemetry decoding
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_NAV_ARCHIVE_SIGNAL_SOURCE_H_
+#define GNSS_SDR_NAV_ARCHIVE_SIGNAL_SOURCE_H_
+
+#include <string>
+#include <gnuradio/msg_queue.h>
+#include "gnss_block_interface.h"
+#include "nav_archive_replay_source.h"
+
+
+class ConfigurationInterface;
+
+/*!
+ * \brief Class that replays the navigation data archive (see nav_archive.h)
+ * and adapts it to a SignalSourceInterface
+ *
+ * The block has one Gnss_Synchro output per channel, which the flowgraph
+ * connects directly to the observables block.
+ */
+class NavArchiveSignalSource: public GNSSBlockInterface
+{
+public:
+    NavArchiveSignalSource(ConfigurationInterface* configuration, std::string role,
+            unsigned int in_streams, unsigned int out_streams,
+            boost::shared_ptr<gr::msg_queue> queue);
+
+    virtual ~NavArchiveSignalSource();
+    std::string role()
+    {
+        return role_;
+    }
+
+    /*!
+     * \brief Returns "Nav_Archive_Signal_Source".
+     */
+    std::string implementation()
+    {
+        return "Nav_Archive_Signal_Source";
+    }
+    size_t item_size()
+    {
+        return item_size_;
+    }
+    void connect(gr::top_block_sptr top_block);
+    void disconnect(gr::top_block_sptr top_block);
+    gr::basic_block_sptr get_left_block();
+    gr::basic_block_sptr get_right_block();
+    std::string archive_filename()
+    {
+        return archive_filename_;
+    }
+    unsigned int channels()
+    {
+        return channels_;
+    }
+
+private:
+    std::string archive_filename_;
+    double start_time_s_;
+    unsigned int channels_;
+    std::string role_;
+    unsigned int in_streams_;
+    unsigned int out_streams_;
+    nav_archive_replay_source_sptr replay_source_;
+    boost::shared_ptr<gr::msg_queue> queue_;
+    size_t item_size_;
+};
+
+#endif /*GNSS_SDR_NAV_ARCHIVE_SIGNAL_SOURCE_H_*/
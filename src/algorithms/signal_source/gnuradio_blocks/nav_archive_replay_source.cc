@@ -0,0 +1,239 @@
+/*!
+ * \file nav_archive_replay_source.cc
+ * \brief GNU Radio source that replays the navigation data archive written
+ * by the telemetry decoders, one output per channel
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "nav_archive_replay_source.h"
+#include <cstring>
+#include <gnuradio/io_signature.h>
+#include <glog/logging.h>
+#include "Galileo_E1.h"
+#include "gnss_synchro.h"
+
+using google::LogMessage;
+
+
+nav_archive_replay_source_sptr nav_archive_make_replay_source(std::string archive_filename,
+        unsigned int channels, double start_time_s)
+{
+    return nav_archive_replay_source_sptr(new nav_archive_replay_source(archive_filename, channels, start_time_s));
+}
+
+
+
+nav_archive_replay_source::nav_archive_replay_source(std::string archive_filename,
+        unsigned int channels, double start_time_s) :
+        gr::sync_block("nav_archive_replay_source",
+                gr::io_signature::make(0, 0, 0),
+                gr::io_signature::make(channels, channels, sizeof(Gnss_Synchro)))
+{
+    d_item = 0;
+    d_started = false;
+    for (unsigned int i = 0; i < channels; i++)
+        {
+            boost::shared_ptr<Nav_Archive_Replay_Channel> channel(new Nav_Archive_Replay_Channel());
+            channel->has_pending = false;
+            channel->start_record = 0;
+            channel->first_item = 0;
+            channel->gps_fsm.i_channel_ID = i;
+            channel->gps_fsm.d_ephemeris_queue = 0;
+            channel->gps_fsm.d_iono_queue = 0;
+            channel->gps_fsm.d_almanac_queue = 0;
+            channel->gps_fsm.d_utc_model_queue = 0;
+            channel->galileo_decoder.i_channel_ID = i;
+            d_channels.push_back(channel);
+
+            std::string filename = nav_archive_filename(archive_filename, i);
+            if (!channel->reader.open(filename))
+                {
+                    LOG(INFO) << "Channel " << i << " has no navigation data archive, replaying empty items";
+                    continue;
+                }
+            if (start_time_s > 0.0)
+                {
+                    if (channel->reader.seek_time(start_time_s))
+                        {
+                            channel->start_record = channel->reader.position();
+                        }
+                    else
+                        {
+                            LOG(INFO) << "Channel " << i << ": navigation data archive ends before " << start_time_s << " [s]";
+                            channel->reader.close();
+                        }
+                }
+        }
+}
+
+
+
+nav_archive_replay_source::~nav_archive_replay_source()
+{}
+
+
+
+void nav_archive_replay_source::set_gps_queues(concurrent_queue<Gps_Ephemeris> *ephemeris_queue,
+        concurrent_queue<Gps_Iono> *iono_queue,
+        concurrent_queue<Gps_Almanac> *almanac_queue,
+        concurrent_queue<Gps_Utc_Model> *utc_model_queue)
+{
+    for (unsigned int i = 0; i < d_channels.size(); i++)
+        {
+            d_channels[i]->gps_fsm.d_ephemeris_queue = ephemeris_queue;
+            d_channels[i]->gps_fsm.d_iono_queue = iono_queue;
+            d_channels[i]->gps_fsm.d_almanac_queue = almanac_queue;
+            d_channels[i]->gps_fsm.d_utc_model_queue = utc_model_queue;
+        }
+}
+
+
+
+void nav_archive_replay_source::set_galileo_queues(concurrent_queue<Galileo_Ephemeris> *ephemeris_queue,
+        concurrent_queue<Galileo_Iono> *iono_queue,
+        concurrent_queue<Galileo_Almanac> *almanac_queue,
+        concurrent_queue<Galileo_Utc_Model> *utc_model_queue)
+{
+    for (unsigned int i = 0; i < d_channels.size(); i++)
+        {
+            d_channels[i]->galileo_decoder.d_ephemeris_queue = ephemeris_queue;
+            d_channels[i]->galileo_decoder.d_iono_queue = iono_queue;
+            d_channels[i]->galileo_decoder.d_almanac_queue = almanac_queue;
+            d_channels[i]->galileo_decoder.d_utc_model_queue = utc_model_queue;
+        }
+}
+
+
+
+void nav_archive_replay_source::start_replay()
+{
+    // the navigation data archived before the start time is decoded first, so
+    // the receiver has the same ephemeris data it had at that time
+    for (unsigned int c = 0; c < d_channels.size(); c++)
+        {
+            Nav_Archive_Replay_Channel &ch = *d_channels[c];
+            if (!ch.reader.is_open()) continue;
+            Nav_Archive_Record record;
+            ch.reader.seek(0);
+            while (ch.reader.position() < ch.start_record and ch.reader.next(record))
+                {
+                    if (record.type != NAV_ARCHIVE_EPOCH)
+                        {
+                            replay_nav_data(c, record);
+                        }
+                }
+            if (read_next(c))
+                {
+                    ch.first_item = ch.pending.item;
+                }
+        }
+    d_started = true;
+}
+
+
+
+bool nav_archive_replay_source::read_next(unsigned int channel)
+{
+    Nav_Archive_Replay_Channel &ch = *d_channels[channel];
+    ch.has_pending = ch.reader.is_open() && ch.reader.next(ch.pending);
+    return ch.has_pending;
+}
+
+
+
+void nav_archive_replay_source::replay_nav_data(unsigned int channel, const Nav_Archive_Record &record)
+{
+    Nav_Archive_Replay_Channel &ch = *d_channels[channel];
+    if (record.type == NAV_ARCHIVE_GPS_SUBFRAME)
+        {
+            memcpy(ch.gps_fsm.d_subframe, record.nav.bits, GPS_SUBFRAME_LENGTH);
+            ch.gps_fsm.d_preamble_time_ms = record.nav.preamble_time_ms;
+            ch.gps_fsm.i_satellite_PRN = record.prn;
+            ch.gps_fsm.gps_subframe_to_nav_msg();
+            ch.gps_fsm.d_flag_new_subframe = false;
+        }
+    else if (record.type == NAV_ARCHIVE_GALILEO_PAGE_PART)
+        {
+            int page_part_bits[GALILEO_INAV_PAGE_PART_BITS];
+            for (int i = 0; i < GALILEO_INAV_PAGE_PART_BITS; i++)
+                {
+                    page_part_bits[i] = (record.nav.bits[i / 8] >> (7 - i % 8)) & 1;
+                }
+            ch.galileo_decoder.decode_page_part(page_part_bits);
+        }
+}
+
+
+
+int nav_archive_replay_source::work(int noutput_items,
+        gr_vector_const_void_star &input_items,
+        gr_vector_void_star &output_items)
+{
+    if (!d_started)
+        {
+            start_replay();
+        }
+    bool pending_records = false;
+    for (unsigned int c = 0; c < d_channels.size(); c++)
+        {
+            pending_records = pending_records or d_channels[c]->has_pending;
+        }
+    if (!pending_records)
+        {
+            LOG(INFO) << "End of the navigation data archive after " << d_item << " items";
+            return WORK_DONE;
+        }
+
+    for (unsigned int c = 0; c < d_channels.size(); c++)
+        {
+            Nav_Archive_Replay_Channel &ch = *d_channels[c];
+            Gnss_Synchro *out = (Gnss_Synchro *) output_items[c];
+            for (int i = 0; i < noutput_items; i++)
+                {
+                    const unsigned long long item = ch.first_item + d_item + i;
+                    // items missing from the archive (not archived, or lost in a write error) are replayed as empty items
+                    out[i] = Gnss_Synchro();
+                    out[i].Channel_ID = c;
+                    while (ch.has_pending and ch.pending.item <= item)
+                        {
+                            if (ch.pending.type == NAV_ARCHIVE_EPOCH)
+                                {
+                                    if (ch.pending.item == item)
+                                        {
+                                            nav_archive_to_gnss_synchro(ch.pending, c, out[i]);
+                                        }
+                                }
+                            else
+                                {
+                                    replay_nav_data(c, ch.pending);
+                                }
+                            read_next(c);
+                        }
+                }
+        }
+    d_item += noutput_items;
+    return noutput_items;
+}
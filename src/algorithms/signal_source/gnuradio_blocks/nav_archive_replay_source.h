@@ -0,0 +1,107 @@
+/*!
+ * \file nav_archive_replay_source.h
+ * \brief GNU Radio source that replays the navigation data archive written
+ * by the telemetry decoders, one output per channel
+ *
+ * Each output produces the telemetry decoder output items of one channel, so
+ * it can be connected directly to the observables block. The navigation data
+ * records are decoded again (GPS subframes by the subframe FSM, Galileo page
+ * parts by the I/NAV page decoder), which pushes the ephemeris, iono, UTC and
+ * almanac data to the receiver queues as the live decoders do.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_NAV_ARCHIVE_REPLAY_SOURCE_H
+#define GNSS_SDR_NAV_ARCHIVE_REPLAY_SOURCE_H
+
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <gnuradio/sync_block.h>
+#include "concurrent_queue.h"
+#include "galileo_e1b_page_decoder.h"
+#include "gps_l1_ca_subframe_fsm.h"
+#include "nav_archive.h"
+
+class nav_archive_replay_source;
+
+typedef boost::shared_ptr<nav_archive_replay_source> nav_archive_replay_source_sptr;
+
+nav_archive_replay_source_sptr nav_archive_make_replay_source(std::string archive_filename,
+        unsigned int channels, double start_time_s);
+
+/*!
+ * \brief Replay state of a channel
+ */
+struct Nav_Archive_Replay_Channel
+{
+    Nav_Archive_Reader reader;
+    Nav_Archive_Record pending;       // next record of the archive
+    bool has_pending;
+    unsigned long long start_record;  // first record replayed as output items, set by the start time
+    unsigned long long first_item;    // archived item replayed as output item 0
+    GpsL1CaSubframeFsm gps_fsm;
+    Galileo_E1b_Page_Decoder galileo_decoder;
+};
+
+/*!
+ * \brief This class implements a source of Gnss_Synchro items read from the navigation data archive
+ */
+class nav_archive_replay_source: public gr::sync_block
+{
+private:
+    friend nav_archive_replay_source_sptr
+    nav_archive_make_replay_source(std::string archive_filename, unsigned int channels, double start_time_s);
+
+    nav_archive_replay_source(std::string archive_filename, unsigned int channels, double start_time_s);
+
+    void start_replay();
+    void replay_nav_data(unsigned int channel, const Nav_Archive_Record &record);
+    bool read_next(unsigned int channel);
+
+    std::vector<boost::shared_ptr<Nav_Archive_Replay_Channel> > d_channels;
+    unsigned long long d_item; // output item number
+    bool d_started;
+
+public:
+    ~nav_archive_replay_source();
+
+    void set_gps_queues(concurrent_queue<Gps_Ephemeris> *ephemeris_queue,
+            concurrent_queue<Gps_Iono> *iono_queue,
+            concurrent_queue<Gps_Almanac> *almanac_queue,
+            concurrent_queue<Gps_Utc_Model> *utc_model_queue);
+
+    void set_galileo_queues(concurrent_queue<Galileo_Ephemeris> *ephemeris_queue,
+            concurrent_queue<Galileo_Iono> *iono_queue,
+            concurrent_queue<Galileo_Almanac> *almanac_queue,
+            concurrent_queue<Galileo_Utc_Model> *utc_model_queue);
+
+    int work(int noutput_items,
+            gr_vector_const_void_star &input_items,
+            gr_vector_void_star &output_items);
+};
+
+#endif
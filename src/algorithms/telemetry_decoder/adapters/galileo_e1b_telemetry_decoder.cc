@@ -66,11 +66,17 @@ GalileoE1BTelemetryDecoder::GalileoE1BTelemetryDecoder(ConfigurationInterface* c
     vector_length_ = configuration->property(role + ".vector_length", 2048);
     dump_ = configuration->property(role + ".dump", false);
     dump_filename_ = configuration->property(role + ".dump_filename", default_dump_filename);
+    std::string default_archive_filename = "./nav_archive";
+    bool archive = configuration->property(role + ".archive", false);
+    std::string archive_filename = configuration->property(role + ".archive_filename", default_archive_filename);
+    bool parallel_page_decoding = configuration->property(role + ".parallel_page_decoding", true);
     int fs_in;
     fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
     // make telemetry decoder object
     telemetry_decoder_ = galileo_e1b_make_telemetry_decoder_cc(satellite_, 0, (long)fs_in, vector_length_, queue_, dump_); // TODO fix me
     DLOG(INFO) << "telemetry_decoder(" << telemetry_decoder_->unique_id() << ")";
+    telemetry_decoder_->set_archive(archive, archive_filename);
+    telemetry_decoder_->set_parallel_page_decoding(parallel_page_decoding);
     // set the navigation msg queue;
     telemetry_decoder_->set_ephemeris_queue(&global_galileo_ephemeris_queue);
     telemetry_decoder_->set_iono_queue(&global_galileo_iono_queue);
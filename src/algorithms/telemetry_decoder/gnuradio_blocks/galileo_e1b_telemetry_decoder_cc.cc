@@ -35,13 +35,15 @@
 #include <stdlib.h>
 #include <iostream>
 #include <sstream>
+#include <vector>
 #include <boost/lexical_cast.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include <gnuradio/io_signature.h>
 #include <glog/logging.h>
 #include "control_message_factory.h"
 #include "galileo_navigation_message.h"
 #include "gnss_synchro.h"
-#include "convolutional.h"
+#include "nav_archive.h"
 
 
 #define CRC_ERROR_LIMIT 6
@@ -61,56 +63,8 @@ galileo_e1b_make_telemetry_decoder_cc(Gnss_Satellite satellite, long if_freq, lo
 
 void galileo_e1b_telemetry_decoder_cc::forecast (int noutput_items, gr_vector_int &ninput_items_required)
 {
-    ninput_items_required[0] = GALILEO_INAV_PAGE_SYMBOLS; // set the required sample history
-}
-
-
-void galileo_e1b_telemetry_decoder_cc::viterbi_decoder(double *page_part_symbols, int *page_part_bits)
-{
-    int CodeLength = 240;
-    int DataLength;
-    int nn, KK, mm, max_states;
-    int g_encoder[2];
-
-    nn = 2;             // Coding rate 1/n
-    KK = 7;             // Constraint Length
-    g_encoder[0] = 121; // Polynomial G1
-    g_encoder[1] = 91;  // Polynomial G2
-
-    mm = KK - 1;
-    max_states = 1 << mm; /* 2^mm */
-    DataLength = (CodeLength/nn) - mm;
-
-    /* create appropriate transition matrices */
-    int *out0, *out1, *state0, *state1;
-    out0 = (int*)calloc( max_states, sizeof(int) );
-    out1 = (int*)calloc( max_states, sizeof(int) );
-    state0 = (int*)calloc( max_states, sizeof(int) );
-    state1 = (int*)calloc( max_states, sizeof(int) );
-
-    nsc_transit( out0, state0, 0, g_encoder, KK, nn );
-    nsc_transit( out1, state1, 1, g_encoder, KK, nn );
-
-    Viterbi(page_part_bits, out0, state0, out1, state1,
-            page_part_symbols, KK, nn, DataLength );
-
-    /* Clean up memory */
-    free( out0 );
-    free( out1 );
-    free( state0 );
-    free( state1 );
-}
-
-
-void galileo_e1b_telemetry_decoder_cc::deinterleaver(int rows, int cols, double *in, double *out)
-{
-    for (int r = 0; r < rows; r++)
-        {
-            for(int c = 0; c < cols; c++)
-                {
-                    out[c*rows + r] = in[r*cols + c];
-                }
-        }
+    // each output item needs the following GALILEO_INAV_PAGE_SYMBOLS symbols (preamble search and page part decoding)
+    ninput_items_required[0] = noutput_items + GALILEO_INAV_PAGE_SYMBOLS - 1;
 }
 
 
@@ -159,6 +113,8 @@ galileo_e1b_telemetry_decoder_cc::galileo_e1b_telemetry_decoder_cc(
                     n++;
                 }
         }
+    d_preamble_correlator.set_preamble(d_preambles_symbols, d_symbols_per_preamble);
+    d_correlator_symbols = 0;
     d_sample_counter = 0;
     d_stat = 0;
     d_preamble_index = 0;
@@ -171,6 +127,15 @@ galileo_e1b_telemetry_decoder_cc::galileo_e1b_telemetry_decoder_cc(
     d_TOW_at_current_symbol = 0;
 
     d_CRC_error_counter = 0;
+    d_archive = false;
+    d_channel = 0;
+    flag_TOW_set = false;
+    Prn_timestamp_at_preamble_ms = 0;
+    d_TOW_page = 0;
+    d_TOW_page_value = 0;
+    d_parallel_page_decoding = true;
+    d_frame_sync_generation = 0;
+    d_page_sample_counter = 0;
 }
 
 
@@ -178,89 +143,117 @@ galileo_e1b_telemetry_decoder_cc::galileo_e1b_telemetry_decoder_cc(
 
 galileo_e1b_telemetry_decoder_cc::~galileo_e1b_telemetry_decoder_cc()
 {
+	// the pool may still be decoding page parts of this channel
+	Galileo_E1b_Decoder_Pool::instance().wait(d_page_pipeline);
 	delete d_preambles_symbols;
 	d_dump_file.close();
+	Dump_Writer::instance().close_stream(d_archive_stream);
 }
 
 
 
 
-void galileo_e1b_telemetry_decoder_cc::decode_word(double *page_part_symbols,int frame_length)
+void galileo_e1b_telemetry_decoder_cc::apply_page_result(const Galileo_E1b_Decode_Result &result, const Gnss_Synchro &current_item)
 {
-    double page_part_symbols_deint[frame_length];
-    // 1. De-interleave
-    deinterleaver(GALILEO_INAV_INTERLEAVER_ROWS, GALILEO_INAV_INTERLEAVER_COLS, page_part_symbols, page_part_symbols_deint);
-
-    // 2. Viterbi decoder
-    // 2.1 Take into account the NOT gate in G2 polynomial (Galileo ICD Figure 13, FEC encoder)
-    // 2.2 Take into account the possible inversion of the polarity due to PLL lock at 180
-    for (int i = 0; i < frame_length; i++)
+    // 1. Archive the page part
+    if (d_archive_stream)
         {
-            if ((i + 1) % 2 == 0)
-                {
-                    page_part_symbols_deint[i] = -page_part_symbols_deint[i];
-                }
+            Nav_Archive_Record record;
+            nav_archive_nav_record(NAV_ARCHIVE_GALILEO_PAGE_PART, current_item, result.sample_counter - 1, 0.0,
+                    result.bits, sizeof(result.bits), record);
+            d_archive_stream->push_record(record);
+        }
+    if (result.generation != d_frame_sync_generation)
+        {
+            return; // the frame sync was lost after this page part was submitted
         }
 
-    int page_part_bits[frame_length/2];
-    viterbi_decoder(page_part_symbols_deint, page_part_bits);
-
-    // 3. Call the Galileo page decoder
-    std::string page_String;
-    for(int i = 0; i < (frame_length/2); i++)
+    // 2. Frame sync, at the time of the preamble of the page part
+    flag_TOW_set = result.flag_TOW_set;
+    if (result.flag_CRC_test == true)
         {
-            if (page_part_bits[i] > 0)
+            d_CRC_error_counter = 0;
+            d_flag_preamble = true; //valid preamble indicator (initialized to false for every item)
+            d_page_sample_counter = result.sample_counter;
+            d_preamble_time_seconds = result.preamble_time_seconds; // - d_preamble_duration_seconds; //record the PRN start sample index associated to the preamble
+            d_TOW_page = result.TOW_page;
+            d_TOW_page_value = result.TOW;
+            if (!d_flag_frame_sync)
                 {
-                    page_String.push_back('1');
+                    d_flag_frame_sync = true;
+                    LOG(INFO) <<" Frame sync SAT " << this->d_satellite << " with preamble start at " << d_preamble_time_seconds << " [s]";
                 }
-            else
+        }
+    else
+        {
+            d_CRC_error_counter++;
+            if (d_CRC_error_counter > CRC_ERROR_LIMIT)
                 {
-                    page_String.push_back('0');
+                    LOG(INFO) << "Lost of frame sync SAT " << this->d_satellite;
+                    d_flag_frame_sync = false;
+                    d_stat = 0;
+                    d_frame_sync_generation++;
                 }
         }
 
-    if (page_part_bits[0] == 1)
+    // 3. TOW at the preamble instant, for each page part (more than one can be applied in the same item)
+    //flag preamble is true after the all page (even and odd) is recevived. I/NAV page period is 2 SECONDS
+    //the page part is applied some items after its preamble: the TOW of the current symbol accounts for them
+    if (result.flag_CRC_test == true and flag_TOW_set == true)
         {
-            // DECODE COMPLETE WORD (even + odd) and TEST CRC
-            d_nav.split_page(page_String, flag_even_word_arrived);
-            if(d_nav.flag_CRC_test == true)
+            Prn_timestamp_at_preamble_ms = d_preamble_time_seconds * 1000.0;
+            if(d_TOW_page == 5 or d_TOW_page == 6) //page 5 or 6 arrived and decoded, so we are in the odd page (since Tow refers to the even page, we have to add 1 sec)
                 {
-                    LOG(INFO) << "Galileo CRC correct on channel " << d_channel;
-                    std::cout << "Galileo CRC correct on channel " << d_channel << std::endl;
+                    d_TOW_at_Preamble = d_TOW_page_value+GALILEO_INAV_PAGE_PART_SECONDS; //TOW_5 and TOW_6 refer to the even preamble, but when we decode it we are in the odd part, so 1 second later
+                    /* 1  sec (GALILEO_INAV_PAGE_PART_SYMBOLS*GALIELO_E1_CODE_PERIOD) is added because
+                     * if we have a TOW value it means that we are at the begining of the last page part
+                     * (GNU Radio history keeps in a buffer the rest of the incomming frame part)*/
+                    d_TOW_at_current_symbol = d_TOW_at_Preamble + (d_sample_counter - d_page_sample_counter) * GALIELO_E1_CODE_PERIOD;
                 }
             else
                 {
-                    std::cout << "Galileo CRC error on channel " << d_channel << std::endl;
-                    LOG(INFO)<< "Galileo CRC error on channel " << d_channel;
+                    //this page has no timming information
+                    d_TOW_at_Preamble = d_TOW_at_Preamble + GALILEO_INAV_PAGE_SECONDS;
                 }
-            flag_even_word_arrived = 0;
-        }
-    else
-        {
-            // STORE HALF WORD (even page)
-            d_nav.split_page(page_String.c_str(), flag_even_word_arrived);
-            flag_even_word_arrived = 1;
         }
+}
 
-    // 4. Push the new navigation data to the queues
-    if (d_nav.have_new_ephemeris() == true)
-        {
-            // get ephemeris object for this SV
-            Galileo_Ephemeris ephemeris = d_nav.get_ephemeris();//notice that the read operation will clear the valid flag
-            //std::cout<<"New Galileo Ephemeris received for SV "<<d_satellite.get_PRN()<<std::endl;
-            d_ephemeris_queue->push(ephemeris);
-        }
-    if (d_nav.have_new_iono_and_GST() == true)
-        {
-            Galileo_Iono iono = d_nav.get_iono(); //notice that the read operation will clear the valid flag
-            //std::cout<<"New Galileo IONO model (and UTC) received for SV "<<d_satellite.get_PRN()<<std::endl;
-            d_iono_queue->push(iono);
-        }
-    if (d_nav.have_new_utc_model() == true)
+
+
+
+bool galileo_e1b_telemetry_decoder_cc::next_page_result(long unsigned int sample_counter, Galileo_E1b_Decode_Result &result)
+{
+    // the results of a channel arrive in order, one per page part
+    while (true)
         {
-            Galileo_Utc_Model utc_model = d_nav.get_utc_model(); //notice that the read operation will clear the valid flag
-            //std::cout<<"New Galileo UTC model received for SV "<<d_satellite.get_PRN()<<std::endl;
-            d_utc_model_queue->push(utc_model);
+            while (!d_page_results.empty() and d_page_results.front().sample_counter < sample_counter)
+                {
+                    d_page_results.pop_front();
+                }
+            if (!d_page_results.empty())
+                {
+                    if (d_page_results.front().sample_counter != sample_counter)
+                        {
+                            return false; // dropped by the pool
+                        }
+                    result = d_page_results.front();
+                    d_page_results.pop_front();
+                    return true;
+                }
+            // not decoded yet: wait for the pool
+            bool pending = d_page_pipeline.d_pending_jobs.load() > 0;
+            if (d_page_pipeline.d_results.try_pop(result))
+                {
+                    d_page_results.push_back(result);
+                }
+            else if (!pending)
+                {
+                    return false; // dropped by the pool
+                }
+            else
+                {
+                    boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+                }
         }
 }
 
@@ -272,205 +265,158 @@ int galileo_e1b_telemetry_decoder_cc::general_work (int noutput_items, gr_vector
 {
     int corr_value = 0;
     int preamble_diff = 0;
+    Galileo_E1b_Decode_Job job;
+    Galileo_E1b_Decode_Result result;
 
-    Gnss_Synchro **out = (Gnss_Synchro **) &output_items[0];
-    d_sample_counter++; //count for the processed samples
+    Gnss_Synchro *out = (Gnss_Synchro *) output_items[0];
 
     // ########### Output the tracking data to navigation and PVT ##########
-    const Gnss_Synchro **in = (const Gnss_Synchro **)  &input_items[0]; //Get the input samples pointer
+    const Gnss_Synchro *in = (const Gnss_Synchro *) input_items[0]; //Get the input samples pointer
 
-    // TODO Optimize me!
-    //******* preamble correlation ********
-    for (int i = 0; i < d_symbols_per_preamble; i++)
-        {
-            if (in[0][i].Prompt_I < 0)	// symbols clipping
-                {
-                    corr_value -= d_preambles_symbols[i];
-                }
-            else
-                {
-                    corr_value += d_preambles_symbols[i];
-                }
-        }
-    d_flag_preamble = false;
+    // process all the items that have a complete page window ahead
+    int n_items = ninput_items[0] - GALILEO_INAV_PAGE_SYMBOLS + 1;
+    if (n_items > noutput_items) n_items = noutput_items;
+    if (n_items <= 0) return 0;
+
+    // sample counter of in[0]
+    const long unsigned int first_item = d_sample_counter;
 
-    //******* frame sync ******************
-    if (d_stat == 0) //no preamble information
+    for (int i = 0; i < n_items; i++)
         {
-            if (abs(corr_value) >= d_symbols_per_preamble)
+            d_sample_counter++; //count for the processed samples
+            // TOW of the current symbol, unless a page part with the TOW sets it below
+            d_TOW_at_current_symbol = d_TOW_at_current_symbol + GALIELO_E1_CODE_PERIOD;
+
+            //******* preamble correlation ********
+            // the window of item i is [i, i + d_symbols_per_preamble): shift in the symbols not yet seen
+            while (d_correlator_symbols < (i + first_item) + d_symbols_per_preamble)
                 {
-                    d_preamble_index = d_sample_counter;//record the preamble sample stamp
-                    LOG(INFO) << "Preamble detection for Galileo SAT " << this->d_satellite << std::endl;
-                    d_stat = 1; // enter into frame pre-detection status
+                    d_preamble_correlator.push(in[d_correlator_symbols - first_item].Prompt_I);
+                    d_correlator_symbols++;
                 }
-        }
-    else if (d_stat == 1) // posible preamble lock
-        {
-            if (abs(corr_value) >= d_symbols_per_preamble)
+            corr_value = d_preamble_correlator.correlation();
+            d_flag_preamble = false;
+
+            //******* frame sync ******************
+            if (d_stat == 0) //no preamble information
                 {
-                    //check preamble separation
-                    preamble_diff = abs(d_sample_counter - d_preamble_index);
-                    if (abs(preamble_diff - GALILEO_INAV_PREAMBLE_PERIOD_SYMBOLS) == 0)
+                    if (abs(corr_value) >= d_symbols_per_preamble)
                         {
-                            //try to decode frame
-                            LOG(INFO) << "Starting page decoder for Galileo SAT " << this->d_satellite << std::endl;
-                            d_preamble_index = d_sample_counter; //record the preamble sample stamp
-                            d_stat = 2;
-                        }
-                    else
-                        {
-                            if (preamble_diff > GALILEO_INAV_PREAMBLE_PERIOD_SYMBOLS)
-                                {
-                                    d_stat = 0; // start again
-                                }
+                            d_preamble_index = d_sample_counter;//record the preamble sample stamp
+                            LOG(INFO) << "Preamble detection for Galileo SAT " << this->d_satellite << std::endl;
+                            d_stat = 1; // enter into frame pre-detection status
                         }
                 }
-        }
-    else if (d_stat == 2)
-        {
-            if (d_sample_counter == d_preamble_index+GALILEO_INAV_PREAMBLE_PERIOD_SYMBOLS)
+            else if (d_stat == 1) // posible preamble lock
                 {
-                    // NEW Galileo page part is received
-                    // 0. fetch the symbols into an array
-                    int frame_length = GALILEO_INAV_PAGE_PART_SYMBOLS - d_symbols_per_preamble;
-                    double page_part_symbols[frame_length];
-
-                    for (int i = 0; i < frame_length; i++)
+                    if (abs(corr_value) >= d_symbols_per_preamble)
                         {
-                            if (corr_value > 0)
+                            //check preamble separation
+                            preamble_diff = abs(d_sample_counter - d_preamble_index);
+                            if (abs(preamble_diff - GALILEO_INAV_PREAMBLE_PERIOD_SYMBOLS) == 0)
                                 {
-                                    page_part_symbols[i] = in[0][i + d_symbols_per_preamble].Prompt_I; // because last symbol of the preamble is just received now!
-
+                                    //try to decode frame
+                                    LOG(INFO) << "Starting page decoder for Galileo SAT " << this->d_satellite << std::endl;
+                                    d_preamble_index = d_sample_counter; //record the preamble sample stamp
+                                    d_stat = 2;
                                 }
                             else
                                 {
-                                    page_part_symbols[i] = -in[0][i + d_symbols_per_preamble].Prompt_I; // because last symbol of the preamble is just received now!
+                                    if (preamble_diff > GALILEO_INAV_PREAMBLE_PERIOD_SYMBOLS)
+                                        {
+                                            d_stat = 0; // start again
+                                        }
                                 }
                         }
-                    //debug
-                    //std::cout<<"ch["<<d_channel<<"] Decoder call at preamble index "<<d_sample_counter<<std::endl;
-                    //                    	    std::cout<<"ch["<<d_channel<<"] frame symbols: ";
-                    //                    	    for (int j=0;j<frame_length;j++)
-                    //                    	    {
-                    //                    	    	if (page_part_symbols[j]>0)
-                    //                    	    	{
-                    //                    	    		std::cout<<"1";
-                    //                    	    	}else{
-                    //                    	    		std::cout<<"0";
-                    //                    	    	}
-                    //                    	    }
-                    //                    	    std::cout<<std::endl;
-                    //end debug
-                    //call the decoder
-                    decode_word(page_part_symbols, frame_length);
-                    if (d_nav.flag_CRC_test == true)
-                        {
-                            d_CRC_error_counter = 0;
-                            d_flag_preamble = true; //valid preamble indicator (initialized to false every work())
-                            d_preamble_index = d_sample_counter;  //record the preamble sample stamp (t_P)
-                            d_preamble_time_seconds = in[0][0].Tracking_timestamp_secs; // - d_preamble_duration_seconds; //record the PRN start sample index associated to the preamble
-                            if (!d_flag_frame_sync)
-                                {
-                                    d_flag_frame_sync = true;
-                                    LOG(INFO) <<" Frame sync SAT " << this->d_satellite << " with preamble start at " << d_preamble_time_seconds << " [s]";
-                                }
-                        }
-                    else
+                }
+            else if (d_stat == 2)
+                {
+                    if (d_sample_counter == d_preamble_index+GALILEO_INAV_PREAMBLE_PERIOD_SYMBOLS)
                         {
-                            d_CRC_error_counter++;
-                            d_preamble_index = d_sample_counter;  //record the preamble sample stamp
-                            if (d_CRC_error_counter > CRC_ERROR_LIMIT)
+                            // NEW Galileo page part is received
+                            // 0. deinterleave the symbols after the preamble straight into the job, fixing the polarity
+                            galileo_e1b_load_page_part(&in[i + d_symbols_per_preamble], corr_value < 0, job.symbols);
+                            //call the decoder
+                            d_preamble_index = d_sample_counter; //record the preamble sample stamp (t_P)
+                            job.pipeline = &d_page_pipeline;
+                            job.sample_counter = d_sample_counter;
+                            job.generation = d_frame_sync_generation;
+                            job.preamble_time_seconds = in[i].Tracking_timestamp_secs;
+                            d_page_jobs.push_back(job.sample_counter);
+                            if (!d_parallel_page_decoding or !Galileo_E1b_Decoder_Pool::instance().submit(job))
                                 {
-                                    LOG(INFO) << "Lost of frame sync SAT " << this->d_satellite;
-                                    d_flag_frame_sync = false;
-                                    d_stat = 0;
+                                    // decoded here, after the page parts of this channel still in the pool
+                                    std::vector<Galileo_E1b_Decode_Result> results;
+                                    d_page_pipeline.decode_after_pending_jobs(job, results);
+                                    d_page_results.insert(d_page_results.end(), results.begin(), results.end());
                                 }
                         }
                 }
-        }
-    consume_each(1); //one by one
-    // UPDATE GNSS SYNCHRO DATA
-    Gnss_Synchro current_synchro_data; //structure to save the synchronization information and send the output object to the next block
-    //1. Copy the current tracking output
-    current_synchro_data = in[0][0];
-    //2. Add the telemetry decoder information
-    if (this->d_flag_preamble == true and d_nav.flag_TOW_set == true)
-        //update TOW at the preamble instant
-        //flag preamble is true after the all page (even and odd) is recevived. I/NAV page period is 2 SECONDS
-        {
-            Prn_timestamp_at_preamble_ms = in[0][0].Tracking_timestamp_secs * 1000.0;
-            if(d_nav.flag_TOW_5 == true) //page 5 arrived and decoded, so we are in the odd page (since Tow refers to the even page, we have to add 1 sec)
+            // page parts decoded by the pool, read as they arrive so that the result queue never fills up
+            while (d_page_pipeline.d_results.try_pop(result))
                 {
-                    //std::cout<< "Using TOW_5 for timestamping" << std::endl;
-                    d_TOW_at_Preamble = d_nav.TOW_5+GALILEO_INAV_PAGE_PART_SECONDS; //TOW_5 refers to the even preamble, but when we decode it we are in the odd part, so 1 second later
-                    /* 1  sec (GALILEO_INAV_PAGE_PART_SYMBOLS*GALIELO_E1_CODE_PERIOD) is added because
-                     * if we have a TOW value it means that we are at the begining of the last page part
-                     * (GNU Radio history keeps in a buffer the rest of the incomming frame part)*/
-                    d_TOW_at_current_symbol = d_TOW_at_Preamble;// + GALILEO_INAV_PAGE_PART_SYMBOLS*GALIELO_E1_CODE_PERIOD;
-                    d_nav.flag_TOW_5 = false;
+                    d_page_results.push_back(result);
                 }
-
-            else if(d_nav.flag_TOW_6 == true) //page 6 arrived and decoded, so we are in the odd page (since Tow refers to the even page, we have to add 1 sec)
+            // each page part is applied GALILEO_E1B_PAGE_RESULT_DELAY_ITEMS items after its preamble,
+            // whether it was decoded here or by the pool, so the output does not depend on the pool timing
+            while (!d_page_jobs.empty() and d_page_jobs.front() + GALILEO_E1B_PAGE_RESULT_DELAY_ITEMS <= d_sample_counter)
                 {
-                    //std::cout<< "Using TOW_6 for timestamping" << std::endl;
-                    d_TOW_at_Preamble = d_nav.TOW_6+GALILEO_INAV_PAGE_PART_SECONDS;
-                    //TOW_6 refers to the even preamble, but when we decode it we are in the odd part, so 1 second later
-                    /* 1  sec (GALILEO_INAV_PAGE_PART_SYMBOLS*GALIELO_E1_CODE_PERIOD) is added because
-                     * if we have a TOW value it means that we are at the begining of the last page part
-                     * (GNU Radio history keeps in a buffer the rest of the incomming frame part)*/
-                    d_TOW_at_current_symbol = d_TOW_at_Preamble;// + GALILEO_INAV_PAGE_PART_SYMBOLS*GALIELO_E1_CODE_PERIOD;
-                    d_nav.flag_TOW_6 = false;
+                    if (next_page_result(d_page_jobs.front(), result))
+                        {
+                            apply_page_result(result, in[i]);
+                        }
+                    d_page_jobs.pop_front();
+                }
+            // UPDATE GNSS SYNCHRO DATA
+            Gnss_Synchro current_synchro_data; //structure to save the synchronization information and send the output object to the next block
+            //1. Copy the current tracking output
+            current_synchro_data = in[i];
+            //2. Add the telemetry decoder information (TOW updated by apply_page_result)
+            //if (d_flag_frame_sync == true and d_nav.flag_TOW_set==true and d_nav.flag_CRC_test == true)
+            if (d_flag_frame_sync == true and flag_TOW_set == true)
+                {
+                    current_synchro_data.Flag_valid_word = true;
                 }
             else
                 {
-                    //this page has no timming information
-                    d_TOW_at_Preamble = d_TOW_at_Preamble + GALILEO_INAV_PAGE_SECONDS;
-                    d_TOW_at_current_symbol =  d_TOW_at_current_symbol + GALIELO_E1_CODE_PERIOD;// + GALILEO_INAV_PAGE_PART_SYMBOLS*GALIELO_E1_CODE_PERIOD;
+                    current_synchro_data.Flag_valid_word = false;
                 }
 
-        }
-    else //if there is not a new preamble, we define the TOW of the current symbol
-        {
-            d_TOW_at_current_symbol = d_TOW_at_current_symbol + GALIELO_E1_CODE_PERIOD;
-        }
-
-    //if (d_flag_frame_sync == true and d_nav.flag_TOW_set==true and d_nav.flag_CRC_test == true)
-    if (d_flag_frame_sync == true and d_nav.flag_TOW_set == true)
-        {
-            current_synchro_data.Flag_valid_word = true;
-        }
-    else
-        {
-            current_synchro_data.Flag_valid_word = false;
-        }
+            current_synchro_data.d_TOW = d_TOW_at_Preamble;
+            current_synchro_data.d_TOW_at_current_symbol = d_TOW_at_current_symbol;
+            current_synchro_data.Flag_preamble = d_flag_preamble;
+            current_synchro_data.Prn_timestamp_ms = in[i].Tracking_timestamp_secs * 1000.0;
+            current_synchro_data.Prn_timestamp_at_preamble_ms = Prn_timestamp_at_preamble_ms;
 
-    current_synchro_data.d_TOW = d_TOW_at_Preamble;
-    current_synchro_data.d_TOW_at_current_symbol = d_TOW_at_current_symbol;
-    current_synchro_data.Flag_preamble = d_flag_preamble;
-    current_synchro_data.Prn_timestamp_ms = in[0][0].Tracking_timestamp_secs * 1000.0;
-    current_synchro_data.Prn_timestamp_at_preamble_ms = Prn_timestamp_at_preamble_ms;
-
-    if(d_dump == true)
-        {
-            // MULTIPLEXED FILE RECORDING - Record results to file
-            try
-            {
-                    double tmp_double;
-                    tmp_double = d_TOW_at_current_symbol;
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                    tmp_double = current_synchro_data.Prn_timestamp_ms;
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                    tmp_double = d_TOW_at_Preamble;
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-            }
-            catch (const std::ifstream::failure& e)
-            {
-                    LOG(WARNING) << "Exception writing observables dump file " << e.what();
-            }
+            if(d_dump == true)
+                {
+                    // MULTIPLEXED FILE RECORDING - Record results to file
+                    try
+                    {
+                            double tmp_double;
+                            tmp_double = d_TOW_at_current_symbol;
+                            d_dump_file.write((char*)&tmp_double, sizeof(double));
+                            tmp_double = current_synchro_data.Prn_timestamp_ms;
+                            d_dump_file.write((char*)&tmp_double, sizeof(double));
+                            tmp_double = d_TOW_at_Preamble;
+                            d_dump_file.write((char*)&tmp_double, sizeof(double));
+                    }
+                    catch (const std::ifstream::failure& e)
+                    {
+                            LOG(WARNING) << "Exception writing observables dump file " << e.what();
+                    }
+                }
+            if (d_archive_stream)
+                {
+                    Nav_Archive_Record record;
+                    nav_archive_epoch_record(current_synchro_data, d_sample_counter - 1, record);
+                    d_archive_stream->push_record(record);
+                }
+            //3. Make the output (copy the object contents to the GNURadio reserved memory)
+            out[i] = current_synchro_data;
         }
-    //3. Make the output (copy the object contents to the GNURadio reserved memory)
-    *out[0] = current_synchro_data;
-    return 1;
+    consume_each(n_items);
+    return n_items;
 }
 
 
@@ -485,6 +431,7 @@ void galileo_e1b_telemetry_decoder_cc::set_satellite(Gnss_Satellite satellite)
 void galileo_e1b_telemetry_decoder_cc::set_channel(int channel)
 {
     d_channel = channel;
+    d_page_pipeline.d_page_decoder.i_channel_ID = channel;
     LOG(INFO) << "Navigation channel set to " << channel;
     // ############# ENABLE DATA FILE LOG #################
     if (d_dump == true)
@@ -506,30 +453,57 @@ void galileo_e1b_telemetry_decoder_cc::set_channel(int channel)
                     }
                 }
         }
+    if (d_archive == true and !d_archive_stream)
+        {
+            std::string filename = nav_archive_filename(d_archive_filename, d_channel);
+            d_archive_stream = Dump_Writer::instance().open_stream(filename, sizeof(Nav_Archive_Record), NAV_ARCHIVE_STREAM_CAPACITY, true);
+            if (d_archive_stream)
+                {
+                    LOG(INFO) << "Navigation data archive enabled on channel " << d_channel << " Archive file: " << filename;
+                }
+            else
+                {
+                    LOG(WARNING) << "channel " << d_channel << " Error opening navigation data archive " << filename;
+                }
+        }
+}
+
+
+
+void galileo_e1b_telemetry_decoder_cc::set_archive(bool archive, std::string archive_filename)
+{
+    d_archive = archive;
+    d_archive_filename = archive_filename;
+}
+
+
+void galileo_e1b_telemetry_decoder_cc::set_parallel_page_decoding(bool parallel)
+{
+    d_parallel_page_decoding = parallel;
 }
 
 
 void galileo_e1b_telemetry_decoder_cc::set_ephemeris_queue(concurrent_queue<Galileo_Ephemeris> *ephemeris_queue)
 {
-    d_ephemeris_queue = ephemeris_queue;
+    d_page_pipeline.d_page_decoder.d_ephemeris_queue = ephemeris_queue;
 }
 
 
 void galileo_e1b_telemetry_decoder_cc::set_iono_queue(concurrent_queue<Galileo_Iono> *iono_queue)
 {
-    d_iono_queue = iono_queue;
+    d_page_pipeline.d_page_decoder.d_iono_queue = iono_queue;
 }
 
 
 void galileo_e1b_telemetry_decoder_cc::set_almanac_queue(concurrent_queue<Galileo_Almanac> *almanac_queue)
 {
-    d_almanac_queue = almanac_queue;
+    d_page_pipeline.d_page_decoder.d_almanac_queue = almanac_queue;
 }
 
 
 void galileo_e1b_telemetry_decoder_cc::set_utc_model_queue(concurrent_queue<Galileo_Utc_Model> *utc_model_queue)
 {
-    d_utc_model_queue = utc_model_queue;
+    d_page_pipeline.d_page_decoder.d_utc_model_queue = utc_model_queue;
 }
 
 
@@ -32,6 +32,7 @@
 #ifndef GNSS_SDR_GALILEO_E1B_TELEMETRY_DECODER_CC_H
 #define GNSS_SDR_GALILEO_E1B_TELEMETRY_DECODER_CC_H
 
+#include <deque>
 #include <fstream>
 #include <string>
 #include <gnuradio/block.h>
@@ -41,12 +42,11 @@
 #include <gnuradio/fec/viterbi.h>
 #include "Galileo_E1.h"
 #include "concurrent_queue.h"
+#include "dump_writer.h"
 #include "gnss_satellite.h"
-#include "galileo_navigation_message.h"
-#include "galileo_ephemeris.h"
-#include "galileo_almanac.h"
-#include "galileo_iono.h"
-#include "galileo_utc_model.h"
+#include "gnss_synchro.h"
+#include "galileo_e1b_decoder_pool.h"
+#include "preamble_sign_correlator.h"
 
 
 
@@ -67,7 +67,20 @@ public:
     ~galileo_e1b_telemetry_decoder_cc();
     void set_satellite(Gnss_Satellite satellite);  //!< Set satellite PRN
     void set_channel(int channel);                 //!< Set receiver's channel
-    int flag_even_word_arrived;
+
+    /*!
+     * \brief Enables the navigation data archive (see nav_archive.h), written to archive_filename + channel + ".dat"
+     */
+    void set_archive(bool archive, std::string archive_filename);
+
+    /*!
+     * \brief Decodes the page parts on the shared Galileo_E1b_Decoder_Pool (default)
+     * instead of inside general_work. Either way, a decoded page part updates the output
+     * (Flag_preamble, TOW, valid word flag) GALILEO_E1B_PAGE_RESULT_DELAY_ITEMS items after
+     * its preamble, waiting for the pool if needed, so the output does not depend on the pool timing.
+     */
+    void set_parallel_page_decoding(bool parallel);
+
     void set_ephemeris_queue(concurrent_queue<Galileo_Ephemeris> *ephemeris_queue); //!< Set the satellite data queue
     void set_iono_queue(concurrent_queue<Galileo_Iono> *iono_queue);                //!< Set the iono data queue
     void set_almanac_queue(concurrent_queue<Galileo_Almanac> *almanac_queue);       //!< Set the almanac data queue
@@ -91,17 +104,16 @@ private:
     galileo_e1b_telemetry_decoder_cc(Gnss_Satellite satellite, long if_freq, long fs_in, unsigned
             int vector_length, boost::shared_ptr<gr::msg_queue> queue, bool dump);
 
-    void viterbi_decoder(double *page_part_symbols, int *page_part_bits);
-
-    void deinterleaver(int rows, int cols, double *in, double *out);
-
-    void decode_word(double *symbols,int frame_length);
+    void apply_page_result(const Galileo_E1b_Decode_Result &result, const Gnss_Synchro &current_item);
+    bool next_page_result(long unsigned int sample_counter, Galileo_E1b_Decode_Result &result); // waits for the result of that page part, false if it was dropped
 
     unsigned short int d_preambles_bits[GALILEO_INAV_PREAMBLE_LENGTH_BITS];
 
     signed int *d_preambles_symbols;
     unsigned int d_samples_per_symbol;
     int d_symbols_per_preamble;
+    Preamble_Sign_Correlator d_preamble_correlator;
+    long unsigned int d_correlator_symbols; // input items shifted into d_preamble_correlator
 
     long unsigned int d_sample_counter;
     long unsigned int d_preamble_index;
@@ -114,17 +126,13 @@ private:
 
     long d_fs_in;
 
-    // navigation message vars
-    Galileo_Navigation_Message d_nav;
-
-    // Galileo ephemeris queue
-    concurrent_queue<Galileo_Ephemeris> *d_ephemeris_queue;
-    // ionospheric parameters queue
-    concurrent_queue<Galileo_Iono> *d_iono_queue;
-    // UTC model parameters queue
-    concurrent_queue<Galileo_Utc_Model> *d_utc_model_queue;
-    // Almanac queue
-    concurrent_queue<Galileo_Almanac> *d_almanac_queue;
+    // navigation message vars (and queues)
+    Galileo_E1b_Page_Pipeline d_page_pipeline;
+    bool d_parallel_page_decoding;
+    unsigned int d_frame_sync_generation; // incremented when the frame sync is lost, to discard the pending page parts
+    unsigned long int d_page_sample_counter; // item of the preamble of the last page used for the TOW
+    std::deque<long unsigned int> d_page_jobs;                 // items of the preambles of the page parts not applied yet
+    std::deque<Galileo_E1b_Decode_Result> d_page_results;      // decoded page parts waiting for their item
 
     boost::shared_ptr<gr::msg_queue> d_queue;
     unsigned int d_vector_length;
@@ -138,9 +146,15 @@ private:
     double d_TOW_at_current_symbol;
     double Prn_timestamp_at_preamble_ms;
     bool flag_TOW_set;
+    int d_TOW_page;
+    double d_TOW_page_value;
 
     std::string d_dump_filename;
     std::ofstream d_dump_file;
+
+    bool d_archive;
+    std::string d_archive_filename;
+    boost::shared_ptr<Dump_Stream> d_archive_stream;
 };
 
 #endif
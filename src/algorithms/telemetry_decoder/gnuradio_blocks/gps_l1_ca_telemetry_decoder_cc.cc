@@ -42,6 +42,7 @@
 #include <glog/logging.h>
 #include "control_message_factory.h"
 #include "gnss_synchro.h"
+#include "nav_archive.h"
 
 #ifndef _rotl
 #define _rotl(X,N)  ((X << N) ^ (X >> (32-N)))  // Used in the parity check algorithm
@@ -63,10 +64,8 @@ gps_l1_ca_make_telemetry_decoder_cc(Gnss_Satellite satellite, long if_freq, long
 
 void gps_l1_ca_telemetry_decoder_cc::forecast (int noutput_items, gr_vector_int &ninput_items_required)
 {
-    for (unsigned i = 0; i < 3; i++)
-        {
-            ninput_items_required[i] = d_samples_per_bit * 8; //set the required sample history
-        }
+    // each output item needs the following d_samples_per_bit*8 symbols to correlate with the preamble
+    ninput_items_required[0] = noutput_items + d_samples_per_bit * 8 - 1;
 }
 
 
@@ -115,6 +114,8 @@ gps_l1_ca_telemetry_decoder_cc::gps_l1_ca_telemetry_decoder_cc(
                     n++;
                 }
         }
+    d_preamble_correlator.set_preamble(d_preambles_symbols, GPS_CA_PREAMBLE_LENGTH_BITS * d_samples_per_bit);
+    d_correlator_symbols = 0;
     d_sample_counter = 0;
     //d_preamble_code_phase_seconds = 0;
     d_stat = 0;
@@ -129,7 +130,10 @@ gps_l1_ca_telemetry_decoder_cc::gps_l1_ca_telemetry_decoder_cc(
     d_flag_parity = false;
     d_TOW_at_Preamble = 0;
     d_TOW_at_current_symbol = 0;
+    Prn_timestamp_at_preamble_ms = 0;
     flag_TOW_set = false;
+    d_archive = false;
+    d_channel = 0;
 
     //set_history(d_samples_per_bit*8); // At least a history of 8 bits are needed to correlate with the preamble
 }
@@ -139,6 +143,7 @@ gps_l1_ca_telemetry_decoder_cc::~gps_l1_ca_telemetry_decoder_cc()
 {
     delete d_preambles_symbols;
     d_dump_file.close();
+    Dump_Writer::instance().close_stream(d_archive_stream);
 }
 
 
@@ -171,179 +176,204 @@ int gps_l1_ca_telemetry_decoder_cc::general_work (int noutput_items, gr_vector_i
 {
     int corr_value = 0;
     int preamble_diff = 0;
+    const unsigned int preamble_length_symbols = d_samples_per_bit * 8;
 
-    Gnss_Synchro **out = (Gnss_Synchro **) &output_items[0];
-    d_sample_counter++; //count for the processed samples
+    Gnss_Synchro *out = (Gnss_Synchro *) output_items[0];
 
     // ########### Output the tracking data to navigation and PVT ##########
-    const Gnss_Synchro **in = (const Gnss_Synchro **)  &input_items[0]; //Get the input samples pointer
+    const Gnss_Synchro *in = (const Gnss_Synchro *) input_items[0]; //Get the input samples pointer
 
-    // TODO Optimize me!
-    //******* preamble correlation ********
-    for (unsigned int i = 0; i < d_samples_per_bit*8; i++)
-        {
-            if (in[0][i].Prompt_I < 0)	// symbols clipping
-                {
-                    corr_value -= d_preambles_symbols[i];
-                }
-            else
-                {
-                    corr_value += d_preambles_symbols[i];
-                }
-        }
-    d_flag_preamble = false;
+    // process all the items that have a complete preamble window ahead
+    int n_items = ninput_items[0] - (int)preamble_length_symbols + 1;
+    if (n_items > noutput_items) n_items = noutput_items;
+    if (n_items <= 0) return 0;
 
-    //******* frame sync ******************
-    if (abs(corr_value) >= 160)
+    // sample counter of in[0]
+    const long unsigned int first_item = d_sample_counter;
+
+    for (int i = 0; i < n_items; i++)
         {
-            //TODO: Rewrite with state machine
-            if (d_stat == 0)
+            d_sample_counter++; //count for the processed samples
+
+            //******* preamble correlation ********
+            // the window of item i is [i, i + preamble_length_symbols): shift in the symbols not yet seen
+            while (d_correlator_symbols < (i + first_item) + preamble_length_symbols)
                 {
-                    d_GPS_FSM.Event_gps_word_preamble();
-                    d_preamble_index = d_sample_counter;//record the preamble sample stamp
-                    LOG(INFO) << "Preamble detection for SAT " << this->d_satellite;
-                    d_symbol_accumulator = 0; //sync the symbol to bits integrator
-                    d_symbol_accumulator_counter = 0;
-                    d_frame_bit_index = 8;
-                    d_stat = 1; // enter into frame pre-detection status
+                    d_preamble_correlator.push(in[d_correlator_symbols - first_item].Prompt_I);
+                    d_correlator_symbols++;
                 }
-            else if (d_stat == 1) //check 6 seconds of preamble separation
+            corr_value = d_preamble_correlator.correlation();
+            d_flag_preamble = false;
+
+            //******* frame sync ******************
+            if (abs(corr_value) >= 160)
                 {
-                    preamble_diff = abs(d_sample_counter - d_preamble_index);
-                    if (abs(preamble_diff - 6000) < 1)
+                    //TODO: Rewrite with state machine
+                    if (d_stat == 0)
                         {
                             d_GPS_FSM.Event_gps_word_preamble();
-                            d_flag_preamble = true;
-                            d_preamble_index = d_sample_counter;  //record the preamble sample stamp (t_P)
-                            d_preamble_time_seconds = in[0][0].Tracking_timestamp_secs;// - d_preamble_duration_seconds; //record the PRN start sample index associated to the preamble
-
-                            if (!d_flag_frame_sync)
+                            d_preamble_index = d_sample_counter;//record the preamble sample stamp
+                            LOG(INFO) << "Preamble detection for SAT " << this->d_satellite;
+                            d_symbol_accumulator = 0; //sync the symbol to bits integrator
+                            d_symbol_accumulator_counter = 0;
+                            d_frame_bit_index = 8;
+                            d_stat = 1; // enter into frame pre-detection status
+                        }
+                    else if (d_stat == 1) //check 6 seconds of preamble separation
+                        {
+                            preamble_diff = abs(d_sample_counter - d_preamble_index);
+                            if (abs(preamble_diff - 6000) < 1)
                                 {
-                                    d_flag_frame_sync = true;
-                                    LOG(INFO) <<" Frame sync SAT " << this->d_satellite << " with preamble start at " << d_preamble_time_seconds << " [s]";
+                                    d_GPS_FSM.Event_gps_word_preamble();
+                                    d_flag_preamble = true;
+                                    d_preamble_index = d_sample_counter;  //record the preamble sample stamp (t_P)
+                                    d_preamble_time_seconds = in[i].Tracking_timestamp_secs;// - d_preamble_duration_seconds; //record the PRN start sample index associated to the preamble
+
+                                    if (!d_flag_frame_sync)
+                                        {
+                                            d_flag_frame_sync = true;
+                                            LOG(INFO) <<" Frame sync SAT " << this->d_satellite << " with preamble start at " << d_preamble_time_seconds << " [s]";
+                                        }
                                 }
                         }
                 }
-        }
-    else
-        {
-            if (d_stat == 1)
+            else
                 {
-                    preamble_diff = d_sample_counter - d_preamble_index;
-                    if (preamble_diff > 6001)
+                    if (d_stat == 1)
                         {
-                            LOG(INFO) << "Lost of frame sync SAT " << this->d_satellite << " preamble_diff= " << preamble_diff;
-                            d_stat = 0; //lost of frame sync
-                            d_flag_frame_sync = false;
-                            flag_TOW_set=false;
+                            preamble_diff = d_sample_counter - d_preamble_index;
+                            if (preamble_diff > 6001)
+                                {
+                                    LOG(INFO) << "Lost of frame sync SAT " << this->d_satellite << " preamble_diff= " << preamble_diff;
+                                    d_stat = 0; //lost of frame sync
+                                    d_flag_frame_sync = false;
+                                    flag_TOW_set=false;
+                                }
                         }
                 }
-        }
 
-    //******* SYMBOL TO BIT *******
-    d_symbol_accumulator += in[0][d_samples_per_bit*8 - 1].Prompt_I; // accumulate the input value in d_symbol_accumulator
-    d_symbol_accumulator_counter++;
-    if (d_symbol_accumulator_counter == 20)
-        {
-            if (d_symbol_accumulator > 0)
-                { //symbol to bit
-                    d_GPS_frame_4bytes += 1; //insert the telemetry bit in LSB
-                }
-            d_symbol_accumulator = 0;
-            d_symbol_accumulator_counter = 0;
-            //******* bits to words ******
-            d_frame_bit_index++;
-            if (d_frame_bit_index == 30)
+            //******* SYMBOL TO BIT *******
+            d_symbol_accumulator += in[i + preamble_length_symbols - 1].Prompt_I; // accumulate the input value in d_symbol_accumulator
+            d_symbol_accumulator_counter++;
+            if (d_symbol_accumulator_counter == 20)
                 {
-                    d_frame_bit_index = 0;
-                    // parity check
-                    // Each word in wordbuff is composed of:
-                    //      Bits 0 to 29 = the GPS data word
-                    //      Bits 30 to 31 = 2 LSBs of the GPS word ahead.
-                    // prepare the extended frame [-2 -1 0 ... 30]
-                    if (d_prev_GPS_frame_4bytes & 0x00000001)
-                        {
-                            d_GPS_frame_4bytes = d_GPS_frame_4bytes | 0x40000000;
-                        }
-                    if (d_prev_GPS_frame_4bytes & 0x00000002)
-                        {
-                            d_GPS_frame_4bytes = d_GPS_frame_4bytes | 0x80000000;
+                    if (d_symbol_accumulator > 0)
+                        { //symbol to bit
+                            d_GPS_frame_4bytes += 1; //insert the telemetry bit in LSB
                         }
-                    /* Check that the 2 most recently logged words pass parity. Have to first
-                     invert the data bits according to bit 30 of the previous word. */
-                    if(d_GPS_frame_4bytes & 0x40000000)
-                        {
-                            d_GPS_frame_4bytes ^= 0x3FFFFFC0; // invert the data bits (using XOR)
-                        }
-                    if (gps_l1_ca_telemetry_decoder_cc::gps_word_parityCheck(d_GPS_frame_4bytes))
+                    d_symbol_accumulator = 0;
+                    d_symbol_accumulator_counter = 0;
+                    //******* bits to words ******
+                    d_frame_bit_index++;
+                    if (d_frame_bit_index == 30)
                         {
-                            memcpy(&d_GPS_FSM.d_GPS_frame_4bytes, &d_GPS_frame_4bytes, sizeof(char)*4);
-                            d_GPS_FSM.d_preamble_time_ms = d_preamble_time_seconds*1000.0;
-                            d_GPS_FSM.Event_gps_word_valid();
-                            d_flag_parity = true;
+                            d_frame_bit_index = 0;
+                            // parity check
+                            // Each word in wordbuff is composed of:
+                            //      Bits 0 to 29 = the GPS data word
+                            //      Bits 30 to 31 = 2 LSBs of the GPS word ahead.
+                            // prepare the extended frame [-2 -1 0 ... 30]
+                            if (d_prev_GPS_frame_4bytes & 0x00000001)
+                                {
+                                    d_GPS_frame_4bytes = d_GPS_frame_4bytes | 0x40000000;
+                                }
+                            if (d_prev_GPS_frame_4bytes & 0x00000002)
+                                {
+                                    d_GPS_frame_4bytes = d_GPS_frame_4bytes | 0x80000000;
+                                }
+                            /* Check that the 2 most recently logged words pass parity. Have to first
+                             invert the data bits according to bit 30 of the previous word. */
+                            if(d_GPS_frame_4bytes & 0x40000000)
+                                {
+                                    d_GPS_frame_4bytes ^= 0x3FFFFFC0; // invert the data bits (using XOR)
+                                }
+                            if (gps_l1_ca_telemetry_decoder_cc::gps_word_parityCheck(d_GPS_frame_4bytes))
+                                {
+                                    memcpy(&d_GPS_FSM.d_GPS_frame_4bytes, &d_GPS_frame_4bytes, sizeof(char)*4);
+                                    d_GPS_FSM.d_preamble_time_ms = d_preamble_time_seconds*1000.0;
+                                    d_GPS_FSM.Event_gps_word_valid();
+                                    d_flag_parity = true;
+                                    if (d_GPS_FSM.d_flag_new_subframe)
+                                        {
+                                            d_GPS_FSM.d_flag_new_subframe = false;
+                                            if (d_archive_stream)
+                                                {
+                                                    Nav_Archive_Record record;
+                                                    nav_archive_nav_record(NAV_ARCHIVE_GPS_SUBFRAME, in[i], d_sample_counter - 1, d_GPS_FSM.d_preamble_time_ms,
+                                                            reinterpret_cast<const unsigned char*>(d_GPS_FSM.d_subframe), GPS_SUBFRAME_LENGTH, record);
+                                                    d_archive_stream->push_record(record);
+                                                }
+                                        }
+                                }
+                            else
+                                {
+                                    d_GPS_FSM.Event_gps_word_invalid();
+                                    d_flag_parity = false;
+                                }
+                            d_prev_GPS_frame_4bytes = d_GPS_frame_4bytes; // save the actual frame
+                            d_GPS_frame_4bytes = d_GPS_frame_4bytes & 0;
                         }
                     else
                         {
-                            d_GPS_FSM.Event_gps_word_invalid();
-                            d_flag_parity = false;
+                            d_GPS_frame_4bytes <<= 1; //shift 1 bit left the telemetry word
                         }
-                    d_prev_GPS_frame_4bytes = d_GPS_frame_4bytes; // save the actual frame
-                    d_GPS_frame_4bytes = d_GPS_frame_4bytes & 0;
                 }
-            else
+            // output the frame
+            Gnss_Synchro current_synchro_data; //structure to save the synchronization information and send the output object to the next block
+            //1. Copy the current tracking output
+            current_synchro_data = in[i];
+            //2. Add the telemetry decoder information
+            if (this->d_flag_preamble == true and d_GPS_FSM.d_nav.d_TOW > 0) //update TOW at the preamble instant (todo: check for valid d_TOW)
                 {
-                    d_GPS_frame_4bytes <<= 1; //shift 1 bit left the telemetry word
+                    d_TOW_at_Preamble = d_GPS_FSM.d_nav.d_TOW + GPS_SUBFRAME_SECONDS; //we decoded the current TOW when the last word of the subframe arrive, so, we have a lag of ONE SUBFRAME
+                    d_TOW_at_current_symbol = d_TOW_at_Preamble + GPS_CA_PREAMBLE_LENGTH_BITS/GPS_CA_TELEMETRY_RATE_BITS_SECOND;
+                    Prn_timestamp_at_preamble_ms = in[i].Tracking_timestamp_secs * 1000.0;
+                    if (flag_TOW_set == false)
+                        {
+                            flag_TOW_set = true;
+                        }
                 }
-        }
-    // output the frame
-    consume_each(1); //one by one
-    Gnss_Synchro current_synchro_data; //structure to save the synchronization information and send the output object to the next block
-    //1. Copy the current tracking output
-    current_synchro_data = in[0][0];
-    //2. Add the telemetry decoder information
-    if (this->d_flag_preamble == true and d_GPS_FSM.d_nav.d_TOW > 0) //update TOW at the preamble instant (todo: check for valid d_TOW)
-        {
-            d_TOW_at_Preamble = d_GPS_FSM.d_nav.d_TOW + GPS_SUBFRAME_SECONDS; //we decoded the current TOW when the last word of the subframe arrive, so, we have a lag of ONE SUBFRAME
-            d_TOW_at_current_symbol = d_TOW_at_Preamble + GPS_CA_PREAMBLE_LENGTH_BITS/GPS_CA_TELEMETRY_RATE_BITS_SECOND;
-            Prn_timestamp_at_preamble_ms = in[0][0].Tracking_timestamp_secs * 1000.0;
-            if (flag_TOW_set == false)
+            else
                 {
-                    flag_TOW_set = true;
+                    d_TOW_at_current_symbol = d_TOW_at_current_symbol + GPS_L1_CA_CODE_PERIOD;
                 }
-        }
-    else
-        {
-            d_TOW_at_current_symbol = d_TOW_at_current_symbol + GPS_L1_CA_CODE_PERIOD;
-        }
 
-    current_synchro_data.d_TOW = d_TOW_at_Preamble;
-    current_synchro_data.d_TOW_at_current_symbol = d_TOW_at_current_symbol;
-    current_synchro_data.Flag_valid_word = (d_flag_frame_sync == true and d_flag_parity == true and flag_TOW_set==true);
-    current_synchro_data.Flag_preamble = d_flag_preamble;
-    current_synchro_data.Prn_timestamp_ms = in[0][0].Tracking_timestamp_secs * 1000.0;
-    current_synchro_data.Prn_timestamp_at_preamble_ms = Prn_timestamp_at_preamble_ms;
+            current_synchro_data.d_TOW = d_TOW_at_Preamble;
+            current_synchro_data.d_TOW_at_current_symbol = d_TOW_at_current_symbol;
+            current_synchro_data.Flag_valid_word = (d_flag_frame_sync == true and d_flag_parity == true and flag_TOW_set==true);
+            current_synchro_data.Flag_preamble = d_flag_preamble;
+            current_synchro_data.Prn_timestamp_ms = in[i].Tracking_timestamp_secs * 1000.0;
+            current_synchro_data.Prn_timestamp_at_preamble_ms = Prn_timestamp_at_preamble_ms;
 
-    if(d_dump == true)
-        {
-            // MULTIPLEXED FILE RECORDING - Record results to file
-            try
-            {
-                    double tmp_double;
-                    tmp_double = d_TOW_at_current_symbol;
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                    tmp_double = current_synchro_data.Prn_timestamp_ms;
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-                    tmp_double = d_TOW_at_Preamble;
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-            }
-            catch (std::ifstream::failure e)
-            {
-                    LOG(WARNING) << "Exception writing observables dump file " << e.what();
-            }
+            if(d_dump == true)
+                {
+                    // MULTIPLEXED FILE RECORDING - Record results to file
+                    try
+                    {
+                            double tmp_double;
+                            tmp_double = d_TOW_at_current_symbol;
+                            d_dump_file.write((char*)&tmp_double, sizeof(double));
+                            tmp_double = current_synchro_data.Prn_timestamp_ms;
+                            d_dump_file.write((char*)&tmp_double, sizeof(double));
+                            tmp_double = d_TOW_at_Preamble;
+                            d_dump_file.write((char*)&tmp_double, sizeof(double));
+                    }
+                    catch (std::ifstream::failure e)
+                    {
+                            LOG(WARNING) << "Exception writing observables dump file " << e.what();
+                    }
+                }
+            if (d_archive_stream)
+                {
+                    Nav_Archive_Record record;
+                    nav_archive_epoch_record(current_synchro_data, d_sample_counter - 1, record);
+                    d_archive_stream->push_record(record);
+                }
+            //3. Make the output (copy the object contents to the GNURadio reserved memory)
+            out[i] = current_synchro_data;
         }
-    //3. Make the output (copy the object contents to the GNURadio reserved memory)
-    *out[0] = current_synchro_data;
-    return 1;
+    consume_each(n_items);
+    return n_items;
 }
 
 
@@ -382,5 +412,26 @@ void gps_l1_ca_telemetry_decoder_cc::set_channel(int channel)
                     }
                 }
         }
+    if (d_archive == true and !d_archive_stream)
+        {
+            std::string filename = nav_archive_filename(d_archive_filename, d_channel);
+            d_archive_stream = Dump_Writer::instance().open_stream(filename, sizeof(Nav_Archive_Record), NAV_ARCHIVE_STREAM_CAPACITY, true);
+            if (d_archive_stream)
+                {
+                    LOG(INFO) << "Navigation data archive enabled on channel " << d_channel << " Archive file: " << filename;
+                }
+            else
+                {
+                    LOG(WARNING) << "channel " << d_channel << " Error opening navigation data archive " << filename;
+                }
+        }
+}
+
+
+
+void gps_l1_ca_telemetry_decoder_cc::set_archive(bool archive, std::string archive_filename)
+{
+    d_archive = archive;
+    d_archive_filename = archive_filename;
 }
 
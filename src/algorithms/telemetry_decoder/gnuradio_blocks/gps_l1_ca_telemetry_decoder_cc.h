@@ -38,7 +38,9 @@
 #include "GPS_L1_CA.h"
 #include "gps_l1_ca_subframe_fsm.h"
 #include "concurrent_queue.h"
+#include "dump_writer.h"
 #include "gnss_satellite.h"
+#include "preamble_sign_correlator.h"
 
 
 
@@ -61,6 +63,11 @@ public:
     void set_satellite(Gnss_Satellite satellite);  //!< Set satellite PRN
     void set_channel(int channel);                 //!< Set receiver's channel
 
+    /*!
+     * \brief Enables the navigation data archive (see nav_archive.h), written to archive_filename + channel + ".dat"
+     */
+    void set_archive(bool archive, std::string archive_filename);
+
     /*!
      * \brief Set the satellite data queue
      */
@@ -96,6 +103,8 @@ private:
     // class private vars
 
     signed int *d_preambles_symbols;
+    Preamble_Sign_Correlator d_preamble_correlator;
+    long unsigned int d_correlator_symbols; // input items shifted into d_preamble_correlator
     unsigned int d_samples_per_bit;
     long unsigned int d_sample_counter;
     long unsigned int d_preamble_index;
@@ -137,6 +146,10 @@ private:
 
     std::string d_dump_filename;
     std::ofstream d_dump_file;
+
+    bool d_archive;
+    std::string d_archive_filename;
+    boost::shared_ptr<Dump_Stream> d_archive_stream;
 };
 
 #endif
@@ -34,6 +34,7 @@
 #include <glog/logging.h>
 #include <boost/lexical_cast.hpp>
 #include "control_message_factory.h"
+#include "crc24q.h"
 #include "gnss_synchro.h"
 #include "sbas_l1_telemetry_decoder_cc.h"
 
@@ -74,7 +75,9 @@ sbas_l1_telemetry_decoder_cc::sbas_l1_telemetry_decoder_cc(
     d_satellite = Gnss_Satellite(satellite.get_system(), satellite.get_PRN());
     LOG(INFO) << "SBAS L1 TELEMETRY PROCESSING: satellite " << d_satellite;
     d_fs_in = fs_in;
-    d_block_size = d_samples_per_symbol * d_symbols_per_bit * d_block_size_in_bits;
+    d_n_samples_in_buf = 0;
+    d_block_sample_stamp = 0;
+    d_block_first_sample = 0;
     set_output_multiple (1);
 }
 
@@ -105,76 +108,28 @@ int sbas_l1_telemetry_decoder_cc::general_work (int noutput_items, gr_vector_int
     const Gnss_Synchro *in = (const Gnss_Synchro *)  input_items[0]; // input
     Gnss_Synchro *out = (Gnss_Synchro *) output_items[0]; 	// output
 
-    // store the time stamp of the first sample in the processed sample block
-    double sample_stamp = in[0].Tracking_timestamp_secs;
-
-    // copy correlation samples into samples vector
+    // copy correlation samples into the block buffer
+    // and decode each time a block is complete
     for (int i = 0; i < noutput_items; i++)
         {
             // check if channel is in tracking state
             //if(in[i].Prompt_I != in[i].Prompt_Q) // TODO: check for real condition
             {
-                d_sample_buf.push_back(in[i].Prompt_I);
+                if (d_n_samples_in_buf == 0)
+                    {
+                        // store the time stamp of the first sample in the processed sample block
+                        d_block_sample_stamp = in[i].Tracking_timestamp_secs;
+                    }
+                d_sample_buf[d_n_samples_in_buf++] = in[i].Prompt_I;
+                if (d_n_samples_in_buf == d_block_size)
+                    {
+                        process_block();
+                        d_n_samples_in_buf = 0;
+                        d_block_first_sample += d_block_size;
+                    }
             }
         }
 
-    // decode only if enough samples in buffer
-    if(d_sample_buf.size() >= d_block_size)
-        {
-            // align correlation samples in pairs
-            // and obtain the symbols by summing the paired correlation samples
-            std::vector<double> symbols;
-            bool sample_alignment = d_sample_aligner.get_symbols(d_sample_buf, symbols);
-
-            // align symbols in pairs
-            // and obtain the bits by decoding the symbol pairs
-            std::vector<int> bits;
-            bool symbol_alignment = d_symbol_aligner_and_decoder.get_bits(symbols, bits);
-
-            // search for preambles
-            // and extract the corresponding message candidates
-            std::vector<msg_candiate_int_t> msg_candidates;
-            d_frame_detector.get_frame_candidates(bits, msg_candidates);
-
-            // verify checksum
-            // and return the valid messages
-            std::vector<msg_candiate_char_t> valid_msgs;
-            d_crc_verifier.get_valid_frames(msg_candidates, valid_msgs);
-
-            // compute message sample stamp
-            // and fill messages in SBAS raw message objects
-            std::vector<Sbas_Raw_Msg> sbas_raw_msgs;
-            for(std::vector<msg_candiate_char_t>::const_iterator it = valid_msgs.begin();
-                    it != valid_msgs.end(); ++it)
-                {
-                    int message_sample_offset =
-                            (sample_alignment ? 0 : -1)
-                            + d_samples_per_symbol*(symbol_alignment ? -1 : 0)
-                            + d_samples_per_symbol * d_symbols_per_bit * it->first;
-                    double message_sample_stamp = sample_stamp + ((double)message_sample_offset)/1000;
-                    VLOG(EVENT) << "message_sample_stamp=" << message_sample_stamp
-                            << " (sample_stamp=" << sample_stamp
-                            << " sample_alignment=" << sample_alignment
-                            << " symbol_alignment=" << symbol_alignment
-                            << " relative_preamble_start=" << it->first
-                            << " message_sample_offset=" << message_sample_offset
-                            << ")";
-                    Sbas_Raw_Msg sbas_raw_msg(message_sample_stamp, this->d_satellite.get_PRN(), it->second);
-                    sbas_raw_msgs.push_back(sbas_raw_msg);
-                }
-
-            // parse messages
-            // and send them to the SBAS raw message queue
-            for(std::vector<Sbas_Raw_Msg>::iterator it = sbas_raw_msgs.begin(); it != sbas_raw_msgs.end(); it++)
-                {
-                    std::cout << "SBAS message type " << it->get_msg_type() << " from PRN" << it->get_prn() << " received" << std::endl;
-                    sbas_telemetry_data.update(*it);
-                }
-
-            // clear all processed samples in the input buffer
-            d_sample_buf.clear();
-        }
-
     // UPDATE GNSS SYNCHRO DATA
     // actually the SBAS telemetry decoder doesn't support ranging
     Gnss_Synchro * current_synchro_data = out; //structure to save the synchronization information and send the output object to the next block
@@ -191,6 +146,54 @@ int sbas_l1_telemetry_decoder_cc::general_work (int noutput_items, gr_vector_int
 
 
 
+void sbas_l1_telemetry_decoder_cc::process_block()
+{
+    // align correlation samples in pairs
+    // and obtain the symbols by summing the paired correlation samples
+    bool sample_alignment = d_sample_aligner.get_symbols(d_sample_buf, d_block_size, d_symbols);
+
+    // align symbols in pairs
+    // and obtain the bits by decoding the symbol pairs
+    int nbits = 0;
+    bool symbol_alignment = d_symbol_aligner_and_decoder.get_bits(d_symbols, d_block_size_in_symbols, d_bits, nbits);
+
+    // search for preambles
+    // and extract the corresponding message candidates
+    int n_candidates = d_frame_detector.get_frame_candidates(d_bits, nbits, d_msg_candidates);
+
+    // verify checksum
+    // and keep the valid messages
+    int n_valid_msgs = d_crc_verifier.get_valid_frames(d_msg_candidates, n_candidates);
+
+    // compute message sample stamp (bit k of the decoded stream starts at sample
+    // d_samples_per_symbol * d_symbols_per_bit * k, which may be in a previous block)
+    // fill messages in SBAS raw message objects
+    // and send them to the SBAS raw message queue
+    for (int i = 0; i < n_valid_msgs; i++)
+        {
+            const msg_candidate &msg = d_msg_candidates[i];
+            long int message_sample_offset =
+                    (sample_alignment ? 0 : -1)
+                    + d_samples_per_symbol*(symbol_alignment ? 0 : -1)
+                    + d_samples_per_symbol * d_symbols_per_bit * msg.preamble_start
+                    - d_block_first_sample;
+            double message_sample_stamp = d_block_sample_stamp + ((double)message_sample_offset)/1000;
+            VLOG(EVENT) << "message_sample_stamp=" << message_sample_stamp
+                    << " (sample_stamp=" << d_block_sample_stamp
+                    << " sample_alignment=" << sample_alignment
+                    << " symbol_alignment=" << symbol_alignment
+                    << " preamble_start=" << msg.preamble_start
+                    << " message_sample_offset=" << message_sample_offset
+                    << ")";
+            Sbas_Raw_Msg sbas_raw_msg(message_sample_stamp, this->d_satellite.get_PRN(),
+                    std::vector<unsigned char>(msg.bytes, msg.bytes + d_sbas_msg_bytes));
+            std::cout << "SBAS message type " << sbas_raw_msg.get_msg_type() << " from PRN" << sbas_raw_msg.get_prn() << " received" << std::endl;
+            sbas_telemetry_data.update(sbas_raw_msg);
+        }
+}
+
+
+
 void sbas_l1_telemetry_decoder_cc::set_satellite(Gnss_Satellite satellite)
 {
     d_satellite = Gnss_Satellite(satellite.get_system(), satellite.get_PRN());
@@ -234,21 +237,21 @@ void sbas_l1_telemetry_decoder_cc::sample_aligner::reset()
 /*
  * samples length must be a multiple of two
  */
-bool sbas_l1_telemetry_decoder_cc::sample_aligner::get_symbols(const std::vector<double> samples, std::vector<double> &symbols)
+bool sbas_l1_telemetry_decoder_cc::sample_aligner::get_symbols(const double *samples, int nsamples, double *symbols)
 {
     double smpls[d_n_smpls_in_history];
     double corr_diff;
     bool stand_by = true;
     double sym;
 
-    VLOG(FLOW) << "get_symbols(): " << "d_past_sample=" << d_past_sample << "\tsamples size=" << samples.size();
+    VLOG(FLOW) << "get_symbols(): " << "d_past_sample=" << d_past_sample << "\tnsamples=" << nsamples;
 
-    for (unsigned int i_sym = 0; i_sym < samples.size()/sbas_l1_telemetry_decoder_cc::d_samples_per_symbol; i_sym++)
+    for (int i_sym = 0; i_sym < nsamples/sbas_l1_telemetry_decoder_cc::d_samples_per_symbol; i_sym++)
         {
             // get the next samples
             for (int i = 0; i < d_n_smpls_in_history; i++)
                 {
-                    smpls[i] = ((int)i_sym)*sbas_l1_telemetry_decoder_cc::d_samples_per_symbol + i - 1 == -1 ? d_past_sample : samples[i_sym*sbas_l1_telemetry_decoder_cc::d_samples_per_symbol + i - 1];
+                    smpls[i] = i_sym*sbas_l1_telemetry_decoder_cc::d_samples_per_symbol + i - 1 == -1 ? d_past_sample : samples[i_sym*sbas_l1_telemetry_decoder_cc::d_samples_per_symbol + i - 1];
                 }
 
             // update the pseudo correlations (IIR method) of the two possible alignments
@@ -265,13 +268,12 @@ bool sbas_l1_telemetry_decoder_cc::sample_aligner::get_symbols(const std::vector
 
             // sum the correct pair of samples to a symbol, depending on the current alignment d_align
             sym = smpls[0 + int(d_aligned)*2] + smpls[1];
-            symbols.push_back(sym);
+            symbols[i_sym] = sym;
 
             // sample alignment debug output
             VLOG(SAMP_SYNC) << std::setprecision(5)
             << "smplp: " << std::setw(6) << smpls[0] << "   " << "smpl0: " << std::setw(6)
             << smpls[1] << "   " << "smpl1: " << std::setw(6) << smpls[2] <<  "\t"
-            //<< "Flag_valid_tracking: " << std::setw(1) << in[0][0].Flag_valid_tracking << " " << std::setw(1) << in[0][0].Flag_valid_tracking << "\t"
             << "d_corr_paired: " << std::setw(10) << d_corr_paired << "\t"
             << "d_corr_shifted: " << std::setw(10) << d_corr_shifted << "\t"
             << "corr_diff: " << std::setw(10) << corr_diff << "\t"
@@ -281,9 +283,10 @@ bool sbas_l1_telemetry_decoder_cc::sample_aligner::get_symbols(const std::vector
         }
 
     // save last sample for next block
-    double  temp;
-    temp = samples.back();
-    d_past_sample = (temp);
+    if (nsamples > 0)
+        {
+            d_past_sample = samples[nsamples - 1];
+        }
     return d_aligned;
 }
 
@@ -291,134 +294,123 @@ bool sbas_l1_telemetry_decoder_cc::sample_aligner::get_symbols(const std::vector
 // ### helper class for symbol alignment and viterbi decoding ###
 sbas_l1_telemetry_decoder_cc::symbol_aligner_and_decoder::symbol_aligner_and_decoder()
 {
-    // convolutional code properties
-    d_KK = 7;
-    int nn = 2;
-    int g_encoder[nn];
-    g_encoder[0] = 121;
-    g_encoder[1] = 91;
-
-    d_vd1 = new Viterbi_Decoder(g_encoder, d_KK, nn);
-    d_vd2 = new Viterbi_Decoder(g_encoder, d_KK, nn);
+    // convolutional code properties (K=7, rate 1/2, G1 = 171, G2 = 133 octal, fixed in Viterbi_Decoder)
+    d_KK = VITERBI_KK;
     d_past_symbol = 0;
 }
 
 
 sbas_l1_telemetry_decoder_cc::symbol_aligner_and_decoder::~symbol_aligner_and_decoder()
-{
-    delete d_vd1;
-    delete d_vd2;
-}
+{}
 
 
 void sbas_l1_telemetry_decoder_cc::symbol_aligner_and_decoder::reset()
 {
     d_past_symbol = 0;
-    d_vd1->reset();
-    d_vd2->reset();
+    d_vd1.reset();
+    d_vd2.reset();
 }
 
 
-bool sbas_l1_telemetry_decoder_cc::symbol_aligner_and_decoder::get_bits(const std::vector<double> symbols, std::vector<int> &bits)
+bool sbas_l1_telemetry_decoder_cc::symbol_aligner_and_decoder::get_bits(const double *symbols, int nsymbols, int *bits, int &nbits)
 {
     const int traceback_depth = 5*d_KK;
-    int nbits_requested = symbols.size()/d_symbols_per_bit;
-    int nbits_decoded;
-    // fill two vectors with the two possible symbol alignments
-    std::vector<double> symbols_vd1(symbols); // aligned symbol vector -> copy input symbol vector
-    std::vector<double> symbols_vd2;  // shifted symbol vector -> add past sample in front of input vector
-    symbols_vd1.push_back(d_past_symbol);
-    for (std::vector<double>::const_iterator symbol_it = symbols.begin(); symbol_it != symbols.end() - 1; ++symbol_it)
+    int nbits_requested = nsymbols/d_symbols_per_bit;
+    int nbits_decoded = 0;
+    // the two possible symbol alignments:
+    // aligned symbols -> the input symbols as they are
+    // shifted symbols -> past symbol in front of the input symbols
+    d_symbols_vd2[0] = d_past_symbol;
+    for (int i = 0; i < nsymbols - 1; i++)
         {
-            symbols_vd2.push_back(*symbol_it);
+            d_symbols_vd2[i + 1] = symbols[i];
         }
-    // arrays for decoded bits
-    int * bits_vd1 = new int[nbits_requested];
-    int * bits_vd2 = new int[nbits_requested];
     // decode
-    float metric_vd1 = d_vd1->decode_continuous(symbols_vd1.data(), traceback_depth, bits_vd1, nbits_requested, nbits_decoded);
-    float metric_vd2 = d_vd2->decode_continuous(symbols_vd2.data(), traceback_depth, bits_vd2, nbits_requested, nbits_decoded);
+    float metric_vd1 = d_vd1.decode_continuous(symbols, traceback_depth, d_bits_vd1, nbits_requested, nbits_decoded);
+    float metric_vd2 = d_vd2.decode_continuous(d_symbols_vd2, traceback_depth, d_bits_vd2, nbits_requested, nbits_decoded);
     // choose the bits with the better metric
-    for (int i = 0; i < nbits_decoded; i++)
+    const int *best_bits = metric_vd1 > metric_vd2 ? d_bits_vd1 : d_bits_vd2;
+    nbits = std::max(0, std::min(nbits_decoded, (int)d_max_bits_per_block));
+    for (int i = 0; i < nbits; i++)
         {
-            if (metric_vd1 > metric_vd2)
-                {// symbols aligned
-                    bits.push_back(bits_vd1[i]);
-                }
-            else
-                {// symbols shifted
-                    bits.push_back(bits_vd2[i]);
-                }
+            bits[i] = best_bits[i];
         }
-    d_past_symbol = symbols.back();
-    delete[] bits_vd1;
-    delete[] bits_vd2;
+    d_past_symbol = symbols[nsymbols - 1];
     return metric_vd1 > metric_vd2;
 }
 
 
 // ### helper class for detecting the preamble and collect the corresponding message candidates ###
+sbas_l1_telemetry_decoder_cc::frame_detector::frame_detector()
+{
+    reset();
+}
+
+
 void sbas_l1_telemetry_decoder_cc::frame_detector::reset()
 {
-    d_buffer.clear();
+    d_start = 0;
+    d_size = 0;
+    d_bits_removed = 0;
 }
 
 
-void sbas_l1_telemetry_decoder_cc::frame_detector::get_frame_candidates(const std::vector<int> bits, std::vector<std::pair<int,std::vector<int>>> &msg_candidates)
+int sbas_l1_telemetry_decoder_cc::frame_detector::get_frame_candidates(const int *bits, int nbits, msg_candidate *msg_candidates)
 {
-    std::stringstream ss;
-    unsigned int sbas_msg_length = 250;
-    std::vector<std::vector<int>> preambles = {{0, 1, 0, 1, 0, 0, 1 ,1},
-                                               {1, 0, 0, 1, 1, 0, 1, 0},
-                                               {1, 1, 0, 0, 0, 1, 1, 0}};
-    VLOG(FLOW) << "get_frame_candidates(): " << "d_buffer.size()=" << d_buffer.size() << "\tbits.size()=" << bits.size();
-    ss << "copy bits ";
-    int count = 0;
+    // the three preambles (ICD order) packed MSB first
+    const unsigned char preambles[3] = {0x53, 0x9A, 0xC6};
+    int n_candidates = 0;
+    VLOG(FLOW) << "get_frame_candidates(): " << "d_size=" << d_size << "\tnbits=" << nbits;
+
     // copy new bits into the working buffer
-    for (std::vector<int>::const_iterator bit_it = bits.begin(); bit_it < bits.end(); ++bit_it)
+    for (int i = 0; i < nbits; i++)
         {
-            d_buffer.push_back(*bit_it);
-            ss << *bit_it;
-            count++;
+            if (d_size == d_bit_buffer_capacity)
+                {
+                    // should not happen: drop the oldest bit
+                    d_start = (d_start + 1) % d_bit_buffer_capacity;
+                    d_size--;
+                    d_bits_removed++;
+                }
+            d_buffer[(d_start + d_size) % d_bit_buffer_capacity] = bits[i] ? 1 : 0;
+            d_size++;
         }
-    VLOG(SAMP_SYNC) << ss.str() << " into working buffer (" << count << " bits)";
-    int relative_preamble_start = 0;
-    while(d_buffer.size() >= sbas_msg_length)
+    while(d_size >= d_sbas_msg_length)
         {
+            unsigned char head = 0;
+            for (int i = 0; i < 8; i++)
+                {
+                    head = (head << 1) | bit(i);
+                }
             // compare with all preambles
-            for (std::vector<std::vector<int>>::iterator preample_it = preambles.begin(); preample_it < preambles.end(); ++preample_it)
+            for (int p = 0; p < 3; p++)
                 {
-                    bool preamble_detected = true;
-                    bool inv_preamble_detected = true;
-                    // compare the buffer bits with the preamble bits
-                    for (std::vector<int>::iterator preample_bit_it = preample_it->begin(); preample_bit_it < preample_it->end(); ++preample_bit_it)
-                        {
-                            preamble_detected = *preample_bit_it == d_buffer[preample_bit_it - preample_it->begin()] ? preamble_detected : false ;
-                            inv_preamble_detected = *preample_bit_it != d_buffer[preample_bit_it - preample_it->begin()] ? inv_preamble_detected : false ;
-                        }
+                    bool preamble_detected = head == preambles[p];
+                    bool inv_preamble_detected = head == (unsigned char)~preambles[p];
                     if (preamble_detected || inv_preamble_detected)
                         {
-                            // copy candidate
-                            std::vector<int> candidate;
-                            std::copy(d_buffer.begin(), d_buffer.begin() + sbas_msg_length, std::back_inserter(candidate));
-                            if(inv_preamble_detected)
+                            // copy candidate, packed in bytes and zero padded at the back (inverting the bits if needed)
+                            msg_candidate &candidate = msg_candidates[n_candidates++];
+                            candidate.preamble_start = d_bits_removed;
+                            const unsigned char inversion = inv_preamble_detected ? 1 : 0;
+                            for (int b = 0; b < d_sbas_msg_bytes; b++)
                                 {
-                                    // invert bits
-                                    for (std::vector<int>::iterator candidate_bit_it = candidate.begin(); candidate_bit_it != candidate.end(); candidate_bit_it++)
-                                        *candidate_bit_it = *candidate_bit_it == 0 ? 1 : 0;
+                                    candidate.bytes[b] = 0;
                                 }
-                            msg_candidates.push_back(std::pair<int,std::vector<int>>(relative_preamble_start, candidate));
-                            ss.str("");
-                            ss << "preamble " << preample_it - preambles.begin() << (inv_preamble_detected?" inverted":" normal") << " detected! candidate=";
-                            for (std::vector<int>::iterator bit_it = candidate.begin(); bit_it < candidate.end(); ++bit_it)
-                                ss << *bit_it;
-                            VLOG(EVENT) << ss.str();
+                            for (int i = 0; i < d_sbas_msg_length; i++)
+                                {
+                                    candidate.bytes[i / 8] |= (bit(i) ^ inversion) << (7 - i % 8);
+                                }
+                            VLOG(EVENT) << "preamble " << p << (inv_preamble_detected ? " inverted" : " normal") << " detected!";
+                            break;
                         }
                 }
-            relative_preamble_start++;
             // remove bit in front
-            d_buffer.pop_front();
+            d_start = (d_start + 1) % d_bit_buffer_capacity;
+            d_size--;
+            d_bits_removed++;
         }
+    return n_candidates;
 }
 
 
@@ -430,97 +422,40 @@ void sbas_l1_telemetry_decoder_cc::crc_verifier::reset()
 
 }
 
-void sbas_l1_telemetry_decoder_cc::crc_verifier::get_valid_frames(const std::vector<msg_candiate_int_t> msg_candidates, std::vector<msg_candiate_char_t> &valid_msgs)
+int sbas_l1_telemetry_decoder_cc::crc_verifier::get_valid_frames(msg_candidate *msg_candidates, int n_candidates)
 {
-    std::stringstream ss;
-    VLOG(FLOW) << "get_valid_frames(): " << "msg_candidates.size()=" << msg_candidates.size();
+    int n_valid = 0;
+    VLOG(FLOW) << "get_valid_frames(): " << "n_candidates=" << n_candidates;
     // for each candidate
-    for (std::vector<msg_candiate_int_t>::const_iterator candidate_it = msg_candidates.begin(); candidate_it < msg_candidates.end(); ++candidate_it)
+    for (int i = 0; i < n_candidates; i++)
         {
-            // convert to bytes
-            std::vector<unsigned char> candidate_bytes;
-            zerropad_back_and_convert_to_bytes(candidate_it->second, candidate_bytes);
             // verify CRC
-            d_checksum_agent.reset(0);
-            d_checksum_agent.process_bytes(candidate_bytes.data(), candidate_bytes.size());
-            unsigned int crc = d_checksum_agent.checksum();
-            VLOG(SAMP_SYNC) << "candidate " << candidate_it - msg_candidates.begin()
+            unsigned int crc = crc24q(msg_candidates[i].bytes, d_sbas_msg_bytes);
+            VLOG(SAMP_SYNC) << "candidate " << i
                             << ": final crc remainder= " << std::hex << crc
                             << std::setfill(' ') << std::resetiosflags(std::ios::hex);
             //  the final remainder must be zero for a valid message, because the CRC is done over the received CRC value
             if (crc == 0)
                 {
-                    valid_msgs.push_back(msg_candiate_char_t(candidate_it->first, candidate_bytes));
-                    ss << "Valid message found!";
-                }
-            else
-                {
-                    ss << "Not a valid message.";
-                }
-            ss << " Relbitoffset=" << candidate_it->first << " content=";
-            for (std::vector<unsigned char>::iterator byte_it = candidate_bytes.begin(); byte_it < candidate_bytes.end(); ++byte_it)
-                {
-                    ss << std::setw(2) << std::setfill('0') << std::hex << (unsigned int)(*byte_it);
-                }
-            VLOG(SAMP_SYNC) << ss.str() << std::setfill(' ') << std::resetiosflags(std::ios::hex) << std::endl;
-        }
-}
-
-
-
-
-
-void sbas_l1_telemetry_decoder_cc::crc_verifier::zerropad_back_and_convert_to_bytes(const std::vector<int> msg_candidate, std::vector<unsigned char> &bytes)
-{
-    std::stringstream ss;
-    const size_t bits_per_byte = 8;
-    unsigned char byte = 0;
-    VLOG(LMORE) << "zerropad_back_and_convert_to_bytes():" << byte;
-    for (std::vector<int>::const_iterator candidate_bit_it = msg_candidate.begin(); candidate_bit_it < msg_candidate.end(); ++candidate_bit_it)
-        {
-            int idx_bit = candidate_bit_it - msg_candidate.begin();
-            int bit_pos_in_current_byte = (bits_per_byte - 1) - (idx_bit % bits_per_byte);
-            byte |= (unsigned char)(*candidate_bit_it) << bit_pos_in_current_byte;
-            ss << *candidate_bit_it;
-            if (idx_bit % bits_per_byte == bits_per_byte - 1)
-                {
-                    bytes.push_back(byte);
-                    VLOG(LMORE) << ss.str() << " -> byte=" << std::setw(2) << std::setfill('0') << std::hex << (unsigned int)byte; ss.str("");
-                    byte = 0;
+                    if (n_valid != i)
+                        {
+                            msg_candidates[n_valid] = msg_candidates[i];
+                        }
+                    n_valid++;
                 }
-        }
-    bytes.push_back(byte); // implies: insert 6 zeros at the end to fit the 250bits into a multiple of bytes
-    VLOG(LMORE) << " -> byte=" << std::setw(2)
-                << std::setfill('0') << std::hex << (unsigned int)byte
-                << std::setfill(' ') << std::resetiosflags(std::ios::hex);
-}
-
-
-
-void sbas_l1_telemetry_decoder_cc::crc_verifier::zerropad_front_and_convert_to_bytes(const std::vector<int> msg_candidate, std::vector<unsigned char> &bytes)
-{
-    std::stringstream ss;
-    const size_t bits_per_byte = 8;
-    unsigned char byte = 0;
-    int idx_bit = 6; // insert 6 zeros at the front to fit the 250bits into a multiple of bytes
-    VLOG(LMORE) << "zerropad_front_and_convert_to_bytes():" << byte;
-    for (std::vector<int>::const_iterator candidate_bit_it = msg_candidate.begin(); candidate_bit_it < msg_candidate.end(); ++candidate_bit_it)
-        {
-            int bit_pos_in_current_byte = (bits_per_byte - 1) - (idx_bit % bits_per_byte);
-            byte |= (unsigned char)(*candidate_bit_it) << bit_pos_in_current_byte;
-            ss << *candidate_bit_it;
-            if (idx_bit % bits_per_byte == bits_per_byte - 1)
+            if (VLOG_IS_ON(SAMP_SYNC))
                 {
-                    bytes.push_back(byte);
-                    VLOG(LMORE) << ss.str() << " -> byte=" << std::setw(2)
-                                << std::setfill('0') << std::hex << (unsigned int)byte; ss.str("");
-                    byte = 0;
+                    std::stringstream ss;
+                    ss << (crc == 0 ? "Valid message found!" : "Not a valid message.");
+                    ss << " Bitoffset=" << msg_candidates[i].preamble_start << " content=";
+                    for (int b = 0; b < d_sbas_msg_bytes; b++)
+                        {
+                            ss << std::setw(2) << std::setfill('0') << std::hex << (unsigned int)msg_candidates[i].bytes[b];
+                        }
+                    VLOG(SAMP_SYNC) << ss.str() << std::setfill(' ') << std::resetiosflags(std::ios::hex) << std::endl;
                 }
-            idx_bit++;
         }
-    VLOG(LMORE) << " -> byte=" << std::setw(2)
-                << std::setfill('0') << std::hex << (unsigned int)byte
-                << std::setfill(' ') << std::resetiosflags(std::ios::hex);
+    return n_valid;
 }
 
 
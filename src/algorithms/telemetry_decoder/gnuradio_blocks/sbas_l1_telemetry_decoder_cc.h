@@ -32,12 +32,9 @@
 #define GNSS_SDR_SBAS_L1_TELEMETRY_DECODER_CC_H
 
 #include <algorithm> // for copy
-#include <deque>
 #include <fstream>
 #include <string>
-#include <utility> // for pair
 #include <vector>
-#include <boost/crc.hpp>
 #include <gnuradio/block.h>
 #include <gnuradio/msg_queue.h>
 #include "gnss_satellite.h"
@@ -88,12 +85,17 @@ private:
     sbas_l1_telemetry_decoder_cc(Gnss_Satellite satellite, long if_freq, long fs_in, unsigned
             int vector_length, boost::shared_ptr<gr::msg_queue> queue, bool dump);
 
-    void viterbi_decoder(double *page_part_symbols, int *page_part_bits);
-    void align_samples();
+    void process_block();
 
     static const int d_samples_per_symbol = 2;
     static const int d_symbols_per_bit = 2;
     static const int d_block_size_in_bits = 30;
+    static const int d_block_size_in_symbols = d_symbols_per_bit * d_block_size_in_bits;
+    static const int d_block_size = d_samples_per_symbol * d_block_size_in_symbols; //!< number of samples which are processed during one invocation of the algorithms
+    static const int d_sbas_msg_length = 250;                                       //!< message length, in bits
+    static const int d_sbas_msg_bytes = (d_sbas_msg_length + 7) / 8;                //!< message length, in bytes (zero padded at the back)
+    static const int d_max_bits_per_block = 2 * d_block_size_in_bits;               //!< room for the bits decoded in one block
+    static const int d_bit_buffer_capacity = 512;                                   //!< must hold d_sbas_msg_length - 1 + d_max_bits_per_block bits
 
     long d_fs_in;
 
@@ -104,11 +106,22 @@ private:
     std::string d_dump_filename;
     std::ofstream d_dump_file;
 
-    size_t d_block_size; //!< number of samples which are processed during one invocation of the algorithms
-    std::vector<double> d_sample_buf; //!< input buffer holding the samples to be processed in one block
+    double d_sample_buf[d_block_size]; //!< input buffer holding the samples of the block being filled
+    int d_n_samples_in_buf;
+    double d_block_sample_stamp;       //!< time stamp of the first sample of the block being filled
+    long int d_block_first_sample;     //!< index of the first sample of the block being filled, counted from the first input sample
 
-    typedef std::pair<int,std::vector<int>> msg_candiate_int_t;
-    typedef std::pair<int,std::vector<unsigned char>> msg_candiate_char_t;
+    // message candidate: index of the first preamble bit, counted from the first decoded bit, and the message bytes
+    struct msg_candidate
+    {
+        long int preamble_start;
+        unsigned char bytes[d_sbas_msg_bytes];
+    };
+
+    // working buffers of the pipeline, reused for every block
+    double d_symbols[d_block_size_in_symbols];
+    int d_bits[d_max_bits_per_block];
+    msg_candidate d_msg_candidates[d_max_bits_per_block];
 
     // helper class for sample alignment
     class sample_aligner
@@ -118,10 +131,10 @@ private:
         ~sample_aligner();
         void reset();
         /*
-         * samples length must be a multiple of two
-         * for block operation
+         * nsamples must be a multiple of two,
+         * writes nsamples/2 symbols
          */
-       bool get_symbols(const std::vector<double> samples, std::vector<double> &symbols);
+       bool get_symbols(const double *samples, int nsamples, double *symbols);
     private:
         int d_n_smpls_in_history ;
         double d_iir_par;
@@ -138,12 +151,19 @@ private:
         symbol_aligner_and_decoder();
         ~symbol_aligner_and_decoder();
         void reset();
-        bool get_bits(const std::vector<double> symbols, std::vector<int> &bits);
+        /*
+         * nsymbols must be a multiple of two and at most d_block_size_in_symbols,
+         * writes at most d_max_bits_per_block bits
+         */
+        bool get_bits(const double *symbols, int nsymbols, int *bits, int &nbits);
     private:
         int d_KK;
-        Viterbi_Decoder * d_vd1;
-        Viterbi_Decoder * d_vd2;
+        Viterbi_Decoder d_vd1;
+        Viterbi_Decoder d_vd2;
         double d_past_symbol;
+        double d_symbols_vd2[d_block_size_in_symbols];
+        int d_bits_vd1[d_max_bits_per_block];
+        int d_bits_vd2[d_max_bits_per_block];
     } d_symbol_aligner_and_decoder;
 
 
@@ -151,10 +171,18 @@ private:
     class frame_detector
     {
     public:
+        frame_detector();
         void reset();
-        void get_frame_candidates(const std::vector<int> bits, std::vector<std::pair<int, std::vector<int>>> &msg_candidates);
+        /*
+         * returns the number of candidates written (at most nbits)
+         */
+        int get_frame_candidates(const int *bits, int nbits, msg_candidate *msg_candidates);
     private:
-        std::deque<int> d_buffer;
+        unsigned char d_buffer[d_bit_buffer_capacity]; // ring buffer of bits
+        int d_start;                                   // ring position of the oldest bit
+        int d_size;                                    // number of bits in the ring
+        long int d_bits_removed;                       // bits removed from the front, i.e. index of the oldest bit in the decoded bit stream
+        unsigned char bit(int i) const { return d_buffer[(d_start + i) % d_bit_buffer_capacity]; }
     } d_frame_detector;
 
 
@@ -163,12 +191,10 @@ private:
     {
     public:
         void reset();
-        void get_valid_frames(const std::vector<msg_candiate_int_t> msg_candidates, std::vector<msg_candiate_char_t> &valid_msgs);
-    private:
-        typedef boost::crc_optimal<24, 0x1864CFBu, 0x0, 0x0, false, false> crc_24_q_type;
-        crc_24_q_type d_checksum_agent;
-        void zerropad_front_and_convert_to_bytes(const std::vector<int> msg_candidate, std::vector<unsigned char> &bytes);
-        void zerropad_back_and_convert_to_bytes(const std::vector<int> msg_candidate, std::vector<unsigned char> &bytes);
+        /*
+         * moves the valid candidates to the front and returns their number
+         */
+        int get_valid_frames(msg_candidate *msg_candidates, int n_candidates);
     } d_crc_verifier;
 
 
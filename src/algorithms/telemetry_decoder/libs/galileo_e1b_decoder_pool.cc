@@ -0,0 +1,228 @@
+/*!
+ * \file galileo_e1b_decoder_pool.cc
+ * \brief Decodes the Galileo E1B I/NAV page parts (deinterleaving, Viterbi
+ * decoding and page parsing) on a small pool of worker threads shared by all
+ * the Galileo telemetry decoder blocks
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "galileo_e1b_decoder_pool.h"
+#include <cstring>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+
+void galileo_e1b_load_page_part(const Gnss_Synchro *items, bool inverted, double *symbols)
+{
+    // The deinterleaved symbol c * ROWS + r is the received symbol r * COLS + c, so each
+    // interleaver row is read in sequence. ROWS is even, so all the symbols of a row
+    // come from the same encoder branch and share a sign: the odd ones (G2) are inverted.
+    for (int r = 0; r < GALILEO_INAV_INTERLEAVER_ROWS; r++)
+        {
+            const double sign = ((r % 2 == 1) != inverted) ? -1.0 : 1.0;
+            const Gnss_Synchro *row = items + r * GALILEO_INAV_INTERLEAVER_COLS;
+            double *column = symbols + r;
+            for (int c = 0; c < GALILEO_INAV_INTERLEAVER_COLS; c++)
+                {
+                    column[c * GALILEO_INAV_INTERLEAVER_ROWS] = sign * row[c].Prompt_I;
+                }
+        }
+}
+
+
+
+Galileo_E1b_Page_Pipeline::Galileo_E1b_Page_Pipeline() :
+        d_results(GALILEO_E1B_DECODER_RESULT_QUEUE_CAPACITY),
+        d_pending_jobs(0)
+{}
+
+
+
+void Galileo_E1b_Page_Pipeline::decode(const Galileo_E1b_Decode_Job &job, Galileo_E1b_Decode_Result &result)
+{
+    // 1. De-interleaving and sign corrections are done by galileo_e1b_load_page_part
+
+    // 2. Viterbi decoder
+    // K=7, rate 1/2 code (Galileo ICD Figure 13, FEC encoder), terminated with 6 tail bits
+    int page_part_bits[GALILEO_E1B_PAGE_PART_FRAME_SYMBOLS / 2];
+    const int data_length = (GALILEO_E1B_PAGE_PART_FRAME_SYMBOLS / VITERBI_NN) - (VITERBI_KK - 1);
+    d_viterbi.decode_block(job.symbols, page_part_bits, data_length);
+
+    // 3. Call the Galileo page decoder and push the new navigation data to the queues
+    d_page_decoder.decode_page_part(page_part_bits);
+
+    // 4. Timing data for the decoder block
+    Galileo_Navigation_Message &nav = d_page_decoder.d_nav;
+    result.sample_counter = job.sample_counter;
+    result.generation = job.generation;
+    result.preamble_time_seconds = job.preamble_time_seconds;
+    result.flag_CRC_test = nav.flag_CRC_test;
+    result.flag_TOW_set = nav.flag_TOW_set;
+    result.TOW_page = 0;
+    result.TOW = 0.0;
+    if (nav.flag_CRC_test == true and nav.flag_TOW_set == true)
+        {
+            if (nav.flag_TOW_5 == true)
+                {
+                    result.TOW_page = 5;
+                    result.TOW = nav.TOW_5;
+                    nav.flag_TOW_5 = false;
+                }
+            else if (nav.flag_TOW_6 == true)
+                {
+                    result.TOW_page = 6;
+                    result.TOW = nav.TOW_6;
+                    nav.flag_TOW_6 = false;
+                }
+        }
+    memset(result.bits, 0, sizeof(result.bits));
+    for (int i = 0; i < GALILEO_INAV_PAGE_PART_BITS - (VITERBI_KK - 1); i++) // the tail bits are not decoded
+        {
+            if (page_part_bits[i] > 0) result.bits[i / 8] |= 0x80 >> (i % 8);
+        }
+}
+
+
+
+void Galileo_E1b_Page_Pipeline::decode_after_pending_jobs(const Galileo_E1b_Decode_Job &job, std::vector<Galileo_E1b_Decode_Result> &results)
+{
+    // the worker uses the decoders of the pipeline until its last job is done, and the
+    // results are read meanwhile so that the worker never finds the result queue full
+    Galileo_E1b_Decode_Result result;
+    while (d_pending_jobs.load() > 0)
+        {
+            if (d_results.try_pop(result))
+                {
+                    results.push_back(result);
+                }
+            else
+                {
+                    boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+                }
+        }
+    while (d_results.try_pop(result))
+        {
+            results.push_back(result);
+        }
+    decode(job, result);
+    results.push_back(result);
+}
+
+
+
+Galileo_E1b_Decoder_Pool& Galileo_E1b_Decoder_Pool::instance()
+{
+    static Galileo_E1b_Decoder_Pool pool;
+    return pool;
+}
+
+
+
+Galileo_E1b_Decoder_Pool::Galileo_E1b_Decoder_Pool() : d_stop(false)
+{
+    for (int i = 0; i < GALILEO_E1B_DECODER_POOL_THREADS; i++)
+        {
+            boost::shared_ptr<Worker> worker(new Worker());
+            d_workers.push_back(worker);
+            worker->thread = boost::thread(&Galileo_E1b_Decoder_Pool::run, this, worker.get());
+        }
+}
+
+
+
+Galileo_E1b_Decoder_Pool::~Galileo_E1b_Decoder_Pool()
+{
+    d_stop.store(true);
+    for (unsigned int i = 0; i < d_workers.size(); i++)
+        {
+            {
+                boost::mutex::scoped_lock lock(d_workers.at(i)->mutex);
+            }
+            d_workers.at(i)->wakeup.notify_one();
+            d_workers.at(i)->thread.join();
+        }
+}
+
+
+
+bool Galileo_E1b_Decoder_Pool::submit(const Galileo_E1b_Decode_Job &job)
+{
+    // the page parts of a channel always go to the same worker, so they are decoded in order
+    Worker &worker = *d_workers.at(job.pipeline->d_page_decoder.i_channel_ID % d_workers.size());
+    job.pipeline->d_pending_jobs.fetch_add(1);
+    if (!worker.jobs.try_push(job))
+        {
+            job.pipeline->d_pending_jobs.fetch_sub(1);
+            return false;
+        }
+    {
+        // the worker checks its queue with the mutex locked before waiting, so the wake up cannot be lost
+        boost::mutex::scoped_lock lock(worker.mutex);
+    }
+    worker.wakeup.notify_one();
+    return true;
+}
+
+
+
+void Galileo_E1b_Decoder_Pool::wait(const Galileo_E1b_Page_Pipeline &pipeline)
+{
+    while (pipeline.d_pending_jobs.load() > 0)
+        {
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+        }
+}
+
+
+
+void Galileo_E1b_Decoder_Pool::run(Worker *worker)
+{
+    Galileo_E1b_Decode_Job job;
+    Galileo_E1b_Decode_Result result;
+    while (true)
+        {
+            {
+                boost::mutex::scoped_lock lock(worker->mutex);
+                while (worker->jobs.empty() and !d_stop.load())
+                    {
+                        worker->wakeup.wait(lock);
+                    }
+            }
+            if (d_stop.load()) break;
+            while (worker->jobs.try_pop(job))
+                {
+                    job.pipeline->decode(job, result);
+                    if (!job.pipeline->d_results.try_push(result))
+                        {
+                            LOG(WARNING) << "Galileo page part of channel " << job.pipeline->d_page_decoder.i_channel_ID
+                                         << " dropped: the telemetry decoder is not reading its results";
+                        }
+                    job.pipeline->d_pending_jobs.fetch_sub(1);
+                }
+        }
+}
@@ -0,0 +1,169 @@
+/*!
+ * \file galileo_e1b_decoder_pool.h
+ * \brief Decodes the Galileo E1B I/NAV page parts (deinterleaving, Viterbi
+ * decoding and page parsing) on a small pool of worker threads shared by all
+ * the Galileo telemetry decoder blocks
+ *
+ * The telemetry decoder block hands each page part to the pool through a
+ * lock-free queue and keeps processing items. The decoded page part comes
+ * back through the lock-free result queue of its Galileo_E1b_Page_Pipeline,
+ * tagged with the item of its preamble, so the block can time stamp it as if
+ * it had been decoded synchronously.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_GALILEO_E1B_DECODER_POOL_H_
+#define GNSS_SDR_GALILEO_E1B_DECODER_POOL_H_
+
+#include <atomic>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include "Galileo_E1.h"
+#include "concurrent_bounded_queue.h"
+#include "galileo_e1b_page_decoder.h"
+#include "gnss_synchro.h"
+#include "viterbi_decoder.h"
+
+#define GALILEO_E1B_DECODER_POOL_THREADS 2
+#define GALILEO_E1B_DECODER_JOB_QUEUE_CAPACITY 64    // page parts waiting per worker
+#define GALILEO_E1B_DECODER_RESULT_QUEUE_CAPACITY 16 // decoded page parts waiting per channel
+#define GALILEO_E1B_PAGE_RESULT_DELAY_ITEMS 25        // items from a preamble to the output item where its decoded page part is applied
+
+const int GALILEO_E1B_PAGE_PART_FRAME_SYMBOLS = GALILEO_INAV_PAGE_PART_SYMBOLS - GALILEO_INAV_PREAMBLE_LENGTH_BITS; //!< page part symbols after the preamble
+const int GALILEO_E1B_PAGE_PART_PACKED_BYTES = (GALILEO_INAV_PAGE_PART_BITS + 7) / 8;
+
+class Galileo_E1b_Page_Pipeline;
+
+/*!
+ * \brief A page part to be decoded: the symbols after the preamble, ready for the Viterbi decoder
+ * (see galileo_e1b_load_page_part)
+ */
+struct Galileo_E1b_Decode_Job
+{
+    Galileo_E1b_Page_Pipeline *pipeline;
+    unsigned long int sample_counter;   //!< Item counter of the decoder block at the end of the preamble
+    unsigned int generation;            //!< Frame sync generation of the decoder block
+    double preamble_time_seconds;       //!< Tracking time stamp of that item
+    double symbols[GALILEO_E1B_PAGE_PART_FRAME_SYMBOLS];
+};
+
+/*!
+ * \brief A decoded page part, with the timing data that the decoder block needs
+ */
+struct Galileo_E1b_Decode_Result
+{
+    unsigned long int sample_counter;
+    unsigned int generation;
+    double preamble_time_seconds;
+    bool flag_CRC_test;  //!< A complete page (even and odd parts) passed the CRC check
+    bool flag_TOW_set;   //!< The navigation message has received a TOW
+    int TOW_page;        //!< 5 or 6 if the page carried the TOW, 0 otherwise
+    double TOW;          //!< TOW of the page (of its even part) [s]
+    unsigned char bits[GALILEO_E1B_PAGE_PART_PACKED_BYTES]; //!< Decoded page part (without tail bits), packed MSB first
+};
+
+
+/*!
+ * \brief Converts the GALILEO_E1B_PAGE_PART_FRAME_SYMBOLS tracking items after a preamble into
+ * Viterbi decoder input in a single pass: deinterleaving, the NOT gate of G2 and, if
+ * inverted is true, the polarity inversion due to a PLL lock at 180 degrees
+ */
+void galileo_e1b_load_page_part(const Gnss_Synchro *items, bool inverted, double *symbols);
+
+
+/*!
+ * \brief The decoding state of a Galileo channel: Viterbi decoder, page decoder and result queue.
+ *
+ * The page parts of a channel are always decoded by the same worker, in order.
+ */
+class Galileo_E1b_Page_Pipeline
+{
+public:
+    Galileo_E1b_Page_Pipeline();
+
+    /*!
+     * \brief Viterbi decodes and parses the page part, and pushes the new
+     * navigation data to the queues of the page decoder
+     */
+    void decode(const Galileo_E1b_Decode_Job &job, Galileo_E1b_Decode_Result &result);
+
+    /*!
+     * \brief Decodes the page part in the calling thread once the pool has decoded the jobs
+     * already submitted for this pipeline. Their results, and then the one of the page part,
+     * are appended to results in order.
+     */
+    void decode_after_pending_jobs(const Galileo_E1b_Decode_Job &job, std::vector<Galileo_E1b_Decode_Result> &results);
+
+    Galileo_E1b_Page_Decoder d_page_decoder;
+    concurrent_bounded_queue<Galileo_E1b_Decode_Result> d_results;
+    std::atomic<int> d_pending_jobs; //!< Jobs submitted to the pool and not decoded yet
+
+private:
+    Viterbi_Decoder d_viterbi;
+};
+
+
+/*!
+ * \brief Receiver-wide pool of threads that decode the Galileo E1B page parts
+ */
+class Galileo_E1b_Decoder_Pool
+{
+public:
+    static Galileo_E1b_Decoder_Pool& instance();
+    ~Galileo_E1b_Decoder_Pool();
+
+    /*!
+     * \brief Queues the page part for decoding. The result is pushed to the result queue of
+     * job.pipeline. Returns false if the queue of the worker is full.
+     */
+    bool submit(const Galileo_E1b_Decode_Job &job);
+
+    /*!
+     * \brief Blocks until the pool has decoded every job submitted for the pipeline
+     */
+    void wait(const Galileo_E1b_Page_Pipeline &pipeline);
+
+private:
+    struct Worker
+    {
+        Worker() : jobs(GALILEO_E1B_DECODER_JOB_QUEUE_CAPACITY) {}
+        concurrent_bounded_queue<Galileo_E1b_Decode_Job> jobs;
+        boost::mutex mutex;
+        boost::condition_variable wakeup;
+        boost::thread thread;
+    };
+
+    Galileo_E1b_Decoder_Pool();
+    void run(Worker *worker);
+
+    std::vector<boost::shared_ptr<Worker> > d_workers;
+    std::atomic<bool> d_stop;
+};
+
+#endif /* GNSS_SDR_GALILEO_E1B_DECODER_POOL_H_ */
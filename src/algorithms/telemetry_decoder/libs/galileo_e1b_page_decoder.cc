@@ -0,0 +1,92 @@
+/*!
+ * \file galileo_e1b_page_decoder.cc
+ * \brief Implementation of the Galileo E1B I/NAV page assembler and decoder
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "galileo_e1b_page_decoder.h"
+#include <iostream>
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+
+Galileo_E1b_Page_Decoder::Galileo_E1b_Page_Decoder()
+{
+    i_channel_ID = 0;
+    d_ephemeris_queue = 0;
+    d_iono_queue = 0;
+    d_utc_model_queue = 0;
+    d_almanac_queue = 0;
+    flag_even_word_arrived = 0;
+}
+
+
+
+void Galileo_E1b_Page_Decoder::decode_page_part(const int *page_part_bits)
+{
+    // 1. Call the Galileo page decoder
+    if (page_part_bits[0] == 1)
+        {
+            // DECODE COMPLETE WORD (even + odd) and TEST CRC
+            d_nav.split_page(page_part_bits, flag_even_word_arrived);
+            if(d_nav.flag_CRC_test == true)
+                {
+                    LOG(INFO) << "Galileo CRC correct on channel " << i_channel_ID;
+                    std::cout << "Galileo CRC correct on channel " << i_channel_ID << std::endl;
+                }
+            else
+                {
+                    std::cout << "Galileo CRC error on channel " << i_channel_ID << std::endl;
+                    LOG(INFO)<< "Galileo CRC error on channel " << i_channel_ID;
+                }
+            flag_even_word_arrived = 0;
+        }
+    else
+        {
+            // STORE HALF WORD (even page)
+            d_nav.split_page(page_part_bits, flag_even_word_arrived);
+            flag_even_word_arrived = 1;
+        }
+
+    // 2. Push the new navigation data to the queues
+    if (d_nav.have_new_ephemeris() == true)
+        {
+            // get ephemeris object for this SV
+            Galileo_Ephemeris ephemeris = d_nav.get_ephemeris();//notice that the read operation will clear the valid flag
+            d_ephemeris_queue->push(ephemeris);
+        }
+    if (d_nav.have_new_iono_and_GST() == true)
+        {
+            Galileo_Iono iono = d_nav.get_iono(); //notice that the read operation will clear the valid flag
+            d_iono_queue->push(iono);
+        }
+    if (d_nav.have_new_utc_model() == true)
+        {
+            Galileo_Utc_Model utc_model = d_nav.get_utc_model(); //notice that the read operation will clear the valid flag
+            d_utc_model_queue->push(utc_model);
+        }
+}
@@ -0,0 +1,69 @@
+/*!
+ * \file galileo_e1b_page_decoder.h
+ * \brief Assembles Galileo E1B I/NAV page parts into pages and pushes the
+ * decoded navigation data to the receiver queues
+ *
+ * This is the part of the E1B telemetry decoder that runs after the Viterbi
+ * decoder, so it is shared by the telemetry decoder block and by the replay
+ * of the navigation data archive.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_GALILEO_E1B_PAGE_DECODER_H_
+#define GNSS_SDR_GALILEO_E1B_PAGE_DECODER_H_
+
+#include "concurrent_queue.h"
+#include "galileo_navigation_message.h"
+#include "galileo_ephemeris.h"
+#include "galileo_almanac.h"
+#include "galileo_iono.h"
+#include "galileo_utc_model.h"
+
+/*!
+ * \brief Joins the even and odd I/NAV page parts, checks the CRC and pushes the new navigation data to the queues
+ */
+class Galileo_E1b_Page_Decoder
+{
+public:
+    Galileo_E1b_Page_Decoder();
+
+    int i_channel_ID;  //!< Channel id, for the log messages
+
+    concurrent_queue<Galileo_Ephemeris> *d_ephemeris_queue; //!< Ephemeris queue
+    concurrent_queue<Galileo_Iono> *d_iono_queue;           //!< Ionospheric parameters queue
+    concurrent_queue<Galileo_Utc_Model> *d_utc_model_queue; //!< UTC model parameters queue
+    concurrent_queue<Galileo_Almanac> *d_almanac_queue;     //!< Almanac queue
+
+    Galileo_Navigation_Message d_nav; //!< Galileo I/NAV navigation message object
+    int flag_even_word_arrived;       //!< An even page part is waiting for its odd part
+
+    /*!
+     * \brief Decodes a page part of GALILEO_INAV_PAGE_PART_BITS bits (one int per bit, as output by the Viterbi decoder)
+     */
+    void decode_page_part(const int *page_part_bits);
+};
+
+#endif /* GNSS_SDR_GALILEO_E1B_PAGE_DECODER_H_ */
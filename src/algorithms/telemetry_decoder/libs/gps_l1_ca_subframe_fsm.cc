@@ -35,203 +35,33 @@
 
 //************ GPS WORD TO SUBFRAME DECODER STATE MACHINE **********
 
-struct Ev_gps_word_valid : sc::event<Ev_gps_word_valid> {};
-struct Ev_gps_word_invalid : sc::event<Ev_gps_word_invalid>{};
-struct Ev_gps_word_preamble : sc::event<Ev_gps_word_preamble>{};
-
-
-struct gps_subframe_fsm_S0: public sc::state<gps_subframe_fsm_S0, GpsL1CaSubframeFsm>
-{
-public:
-    // sc::transition(event,next_status)
-    typedef sc::transition< Ev_gps_word_preamble, gps_subframe_fsm_S1 > reactions;
-    gps_subframe_fsm_S0(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S0 "<<std::endl;
-    }
-};
-
-
-
-
-struct gps_subframe_fsm_S1: public sc::state<gps_subframe_fsm_S1, GpsL1CaSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_subframe_fsm_S2 > > reactions;
-
-    gps_subframe_fsm_S1(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S1 "<<std::endl;
-    }
-};
-
-
-
-
-struct gps_subframe_fsm_S2: public sc::state<gps_subframe_fsm_S2, GpsL1CaSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_subframe_fsm_S3 > > reactions;
-
-    gps_subframe_fsm_S2(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S2 "<<std::endl;
-        context< GpsL1CaSubframeFsm >().gps_word_to_subframe(0);
-    }
-};
-
-
-
-
-struct gps_subframe_fsm_S3: public sc::state<gps_subframe_fsm_S3, GpsL1CaSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_subframe_fsm_S4 > > reactions;
-
-    gps_subframe_fsm_S3(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S3 "<<std::endl;
-        context< GpsL1CaSubframeFsm >().gps_word_to_subframe(1);
-    }
-};
-
-
-
-
-struct gps_subframe_fsm_S4: public sc::state<gps_subframe_fsm_S4, GpsL1CaSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_subframe_fsm_S5 > > reactions;
-
-    gps_subframe_fsm_S4(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S4 "<<std::endl;
-        context< GpsL1CaSubframeFsm >().gps_word_to_subframe(2);
-    }
-};
-
-
-
-
-struct gps_subframe_fsm_S5: public sc::state<gps_subframe_fsm_S5, GpsL1CaSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_subframe_fsm_S6 > > reactions;
-
-    gps_subframe_fsm_S5(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S5 "<<std::endl;
-        context< GpsL1CaSubframeFsm >().gps_word_to_subframe(3);
-    }
-};
-
-
-
-
-
-struct gps_subframe_fsm_S6: public sc::state<gps_subframe_fsm_S6, GpsL1CaSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_subframe_fsm_S7 > > reactions;
-
-    gps_subframe_fsm_S6(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S6 "<<std::endl;
-        context< GpsL1CaSubframeFsm >().gps_word_to_subframe(4);
-    }
-};
-
-
-
-struct gps_subframe_fsm_S7: public sc::state<gps_subframe_fsm_S7, GpsL1CaSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_subframe_fsm_S8 > > reactions;
-
-    gps_subframe_fsm_S7(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S7 "<<std::endl;
-        context< GpsL1CaSubframeFsm >().gps_word_to_subframe(5);
-    }
-};
-
-
-
-struct gps_subframe_fsm_S8: public sc::state<gps_subframe_fsm_S8, GpsL1CaSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_subframe_fsm_S9 > > reactions;
-
-    gps_subframe_fsm_S8(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S8 "<<std::endl;
-        context< GpsL1CaSubframeFsm >().gps_word_to_subframe(6);
-    }
-};
-
-
-
-
-struct gps_subframe_fsm_S9: public sc::state<gps_subframe_fsm_S9, GpsL1CaSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_subframe_fsm_S10 > > reactions;
-
-    gps_subframe_fsm_S9(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S9 "<<std::endl;
-        context< GpsL1CaSubframeFsm >().gps_word_to_subframe(7);
-    }
-};
-
-
-
-struct gps_subframe_fsm_S10: public sc::state<gps_subframe_fsm_S10, GpsL1CaSubframeFsm>
-{
-public:
-    typedef mpl::list<sc::transition< Ev_gps_word_invalid, gps_subframe_fsm_S0 >,
-            sc::transition< Ev_gps_word_valid, gps_subframe_fsm_S11 > > reactions;
-
-    gps_subframe_fsm_S10(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Enter S10 "<<std::endl;
-        context< GpsL1CaSubframeFsm >().gps_word_to_subframe(8);
-    }
-};
-
-
-
-struct gps_subframe_fsm_S11: public sc::state<gps_subframe_fsm_S11, GpsL1CaSubframeFsm>
+GpsL1CaSubframeFsm::GpsL1CaSubframeFsm()
 {
-public:
-    typedef sc::transition< Ev_gps_word_preamble, gps_subframe_fsm_S1 > reactions;
-
-    gps_subframe_fsm_S11(my_context ctx): my_base( ctx )
-    {
-        //std::cout<<"Completed GPS Subframe!"<<std::endl;
-        context< GpsL1CaSubframeFsm >().gps_word_to_subframe(9);
-        context< GpsL1CaSubframeFsm >().gps_subframe_to_nav_msg(); //decode the subframe
-        // DECODE SUBFRAME
-        //std::cout<<"Enter S11"<<std::endl;
-    }
-};
-
+    d_nav.reset();
+    d_flag_new_subframe = false;
+    d_state = GPS_SUBFRAME_FSM_S0; //start the FSM
+}
 
 
 
-GpsL1CaSubframeFsm::GpsL1CaSubframeFsm()
-{
-    d_nav.reset();
-    initiate(); //start the FSM
+void GpsL1CaSubframeFsm::process_event(int event)
+{
+    int next_state = gps_subframe_fsm_next_state(d_state, event);
+    if (next_state < 0)
+        {
+            return; // the event is discarded
+        }
+    d_state = next_state;
+    // entry actions
+    if (d_state >= GPS_SUBFRAME_FSM_S2)
+        {
+            // S2 to S11 store words 0 to 9 of the subframe
+            gps_word_to_subframe(d_state - GPS_SUBFRAME_FSM_S2);
+        }
+    if (d_state == GPS_SUBFRAME_FSM_S11)
+        {
+            gps_subframe_to_nav_msg(); //decode the subframe
+        }
 }
 
 
@@ -256,6 +86,7 @@ void GpsL1CaSubframeFsm::gps_subframe_to_nav_msg()
     d_nav.i_satellite_PRN = i_satellite_PRN;
     d_nav.i_channel_ID = i_channel_ID;
     d_nav.d_subframe_timestamp_ms = this->d_preamble_time_ms;
+    d_flag_new_subframe = true;
 
     switch (subframe_ID)
     {
@@ -292,20 +123,20 @@ void GpsL1CaSubframeFsm::gps_subframe_to_nav_msg()
 
 void GpsL1CaSubframeFsm::Event_gps_word_valid()
 {
-    this->process_event(Ev_gps_word_valid());
+    this->process_event(GPS_SUBFRAME_FSM_EV_WORD_VALID);
 }
 
 
 
 void GpsL1CaSubframeFsm::Event_gps_word_invalid()
 {
-    this->process_event(Ev_gps_word_invalid());
+    this->process_event(GPS_SUBFRAME_FSM_EV_WORD_INVALID);
 }
 
 
 
 void GpsL1CaSubframeFsm::Event_gps_word_preamble()
 {
-    this->process_event(Ev_gps_word_preamble());
+    this->process_event(GPS_SUBFRAME_FSM_EV_WORD_PREAMBLE);
 }
 
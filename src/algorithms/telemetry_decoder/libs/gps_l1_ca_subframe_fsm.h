@@ -32,12 +32,6 @@
 #ifndef GNSS_SDR_GPS_L1_CA_SUBFRAME_FSM_H_
 #define GNSS_SDR_GPS_L1_CA_SUBFRAME_FSM_H_
 
-#include <boost/statechart/state_machine.hpp>
-#include <boost/statechart/simple_state.hpp>
-#include <boost/statechart/state.hpp>
-#include <boost/statechart/transition.hpp>
-#include <boost/statechart/custom_reaction.hpp>
-#include <boost/mpl/list.hpp>
 #include <queue>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
@@ -51,28 +45,69 @@
 #include "gps_almanac.h"
 #include "gps_utc_model.h"
 
-namespace sc = boost::statechart;
-namespace mpl = boost::mpl;
+enum Gps_Subframe_Fsm_State
+{
+    GPS_SUBFRAME_FSM_S0 = 0, //!< waiting for a preamble
+    GPS_SUBFRAME_FSM_S1,     //!< preamble word received
+    GPS_SUBFRAME_FSM_S2,     //!< S2 to S11: word 1 to 10 of the subframe received
+    GPS_SUBFRAME_FSM_S3,
+    GPS_SUBFRAME_FSM_S4,
+    GPS_SUBFRAME_FSM_S5,
+    GPS_SUBFRAME_FSM_S6,
+    GPS_SUBFRAME_FSM_S7,
+    GPS_SUBFRAME_FSM_S8,
+    GPS_SUBFRAME_FSM_S9,
+    GPS_SUBFRAME_FSM_S10,
+    GPS_SUBFRAME_FSM_S11,    //!< subframe completed and decoded
+    GPS_SUBFRAME_FSM_STATES
+};
+
+enum Gps_Subframe_Fsm_Event
+{
+    GPS_SUBFRAME_FSM_EV_WORD_VALID = 0,
+    GPS_SUBFRAME_FSM_EV_WORD_INVALID,
+    GPS_SUBFRAME_FSM_EV_WORD_PREAMBLE,
+    GPS_SUBFRAME_FSM_EVENTS
+};
+
+/*!
+ * \brief Next state for each state and event. -1: the state does not react to the event
+ */
+constexpr signed char GPS_SUBFRAME_FSM_TRANSITIONS[GPS_SUBFRAME_FSM_STATES][GPS_SUBFRAME_FSM_EVENTS] =
+{
+    //  valid                  invalid               preamble
+    { -1,                   -1,                   GPS_SUBFRAME_FSM_S1 }, // S0
+    { GPS_SUBFRAME_FSM_S2,  GPS_SUBFRAME_FSM_S0,  -1 },                  // S1
+    { GPS_SUBFRAME_FSM_S3,  GPS_SUBFRAME_FSM_S0,  -1 },                  // S2
+    { GPS_SUBFRAME_FSM_S4,  GPS_SUBFRAME_FSM_S0,  -1 },                  // S3
+    { GPS_SUBFRAME_FSM_S5,  GPS_SUBFRAME_FSM_S0,  -1 },                  // S4
+    { GPS_SUBFRAME_FSM_S6,  GPS_SUBFRAME_FSM_S0,  -1 },                  // S5
+    { GPS_SUBFRAME_FSM_S7,  GPS_SUBFRAME_FSM_S0,  -1 },                  // S6
+    { GPS_SUBFRAME_FSM_S8,  GPS_SUBFRAME_FSM_S0,  -1 },                  // S7
+    { GPS_SUBFRAME_FSM_S9,  GPS_SUBFRAME_FSM_S0,  -1 },                  // S8
+    { GPS_SUBFRAME_FSM_S10, GPS_SUBFRAME_FSM_S0,  -1 },                  // S9
+    { GPS_SUBFRAME_FSM_S11, GPS_SUBFRAME_FSM_S0,  -1 },                  // S10
+    { -1,                   -1,                   GPS_SUBFRAME_FSM_S1 }  // S11
+};
 
-struct gps_subframe_fsm_S0;
-struct gps_subframe_fsm_S1;
-struct gps_subframe_fsm_S2;
-struct gps_subframe_fsm_S3;
-struct gps_subframe_fsm_S4;
-struct gps_subframe_fsm_S5;
-struct gps_subframe_fsm_S6;
-struct gps_subframe_fsm_S7;
-struct gps_subframe_fsm_S8;
-struct gps_subframe_fsm_S9;
-struct gps_subframe_fsm_S10;
-struct gps_subframe_fsm_S11;
+/*!
+ * \brief Next state of the subframe FSM, or -1 if the state does not react to the event
+ */
+constexpr int gps_subframe_fsm_next_state(int state, int event)
+{
+    return GPS_SUBFRAME_FSM_TRANSITIONS[state][event];
+}
 
 
 /*!
  * \brief This class implements a Finite State Machine that handles the decoding
  *  of the GPS L1 C/A NAV message
+ *
+ * The states are an enumeration and the transitions a constant table
+ * (GPS_SUBFRAME_FSM_TRANSITIONS): each event is a table lookup plus the
+ * entry action of the new state, with no allocation.
  */
-class GpsL1CaSubframeFsm : public sc::state_machine< GpsL1CaSubframeFsm, gps_subframe_fsm_S0 >
+class GpsL1CaSubframeFsm
 {
 public:
     GpsL1CaSubframeFsm(); //!< The constructor starts the Finite State Machine
@@ -97,6 +132,7 @@ public:
     char d_subframe[GPS_SUBFRAME_LENGTH];
     char d_GPS_frame_4bytes[GPS_WORD_LENGTH];
     double d_preamble_time_ms;
+    bool d_flag_new_subframe;  //!< Set when d_subframe holds a new decoded subframe, cleared by the reader
 
     void gps_word_to_subframe(int position); //!< inserts the word in the correct position of the subframe
 
@@ -109,6 +145,12 @@ public:
     void Event_gps_word_valid();    //!< FSM event: the received word is valid
     void Event_gps_word_invalid();  //!< FSM event: the received word is not valid
     void Event_gps_word_preamble(); //!< FSM event: word preamble detected
+
+    int state() const { return d_state; } //!< Current Gps_Subframe_Fsm_State
+
+private:
+    void process_event(int event);
+    int d_state;
 };
 
 #endif
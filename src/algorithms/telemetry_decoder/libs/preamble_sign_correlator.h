@@ -0,0 +1,141 @@
+/*!
+ * \file preamble_sign_correlator.h
+ * \brief Sliding correlation of the sign of the last symbols with a preamble
+ *
+ * Keeps the signs of the last N symbols packed in 64-bit words (the most
+ * recent symbol in the least significant bit), so each new symbol costs one
+ * shift of the history and a preamble correlation costs N/64 XOR and
+ * population count operations, instead of N multiply-accumulates over the
+ * whole window.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_PREAMBLE_SIGN_CORRELATOR_H_
+#define GNSS_SDR_PREAMBLE_SIGN_CORRELATOR_H_
+
+#define PREAMBLE_SIGN_CORRELATOR_MAX_SYMBOLS 256
+#define PREAMBLE_SIGN_CORRELATOR_WORDS (PREAMBLE_SIGN_CORRELATOR_MAX_SYMBOLS / 64)
+
+/*!
+ * \brief Sign correlator of a window of symbols against a +1/-1 preamble
+ *
+ * correlation() returns the same value as the sum over the window of
+ * preamble[i] * (symbol[i] < 0 ? -1 : +1), where symbol[0] is the oldest
+ * symbol of the window.
+ */
+class Preamble_Sign_Correlator
+{
+public:
+    Preamble_Sign_Correlator() : d_length(0), d_words(0), d_symbols(0)
+    {
+        for (int w = 0; w < PREAMBLE_SIGN_CORRELATOR_WORDS; w++)
+            {
+                d_history[w] = 0;
+                d_preamble[w] = 0;
+                d_mask[w] = 0;
+            }
+    }
+
+    /*!
+     * \brief Sets the preamble (length <= PREAMBLE_SIGN_CORRELATOR_MAX_SYMBOLS), one +1/-1 value per symbol
+     */
+    void set_preamble(const signed int* preamble_symbols, unsigned int length)
+    {
+        if (length > PREAMBLE_SIGN_CORRELATOR_MAX_SYMBOLS) length = PREAMBLE_SIGN_CORRELATOR_MAX_SYMBOLS;
+        d_length = length;
+        d_words = (length + 63) / 64;
+        for (int w = 0; w < PREAMBLE_SIGN_CORRELATOR_WORDS; w++)
+            {
+                d_preamble[w] = 0;
+                d_mask[w] = 0;
+            }
+        for (unsigned int i = 0; i < length; i++)
+            {
+                // the oldest symbol of the window ends up in bit length - 1
+                unsigned int bit = length - 1 - i;
+                d_mask[bit / 64] |= 1ULL << (bit % 64);
+                if (preamble_symbols[i] > 0)
+                    {
+                        d_preamble[bit / 64] |= 1ULL << (bit % 64);
+                    }
+            }
+        reset();
+    }
+
+    /*!
+     * \brief Clears the symbol history
+     */
+    void reset()
+    {
+        for (int w = 0; w < PREAMBLE_SIGN_CORRELATOR_WORDS; w++)
+            {
+                d_history[w] = 0;
+            }
+        d_symbols = 0;
+    }
+
+    /*!
+     * \brief Shifts a new symbol into the window, dropping the oldest one
+     */
+    void push(double symbol)
+    {
+        if (d_words == 0) return;
+        for (unsigned int w = d_words - 1; w > 0; w--)
+            {
+                d_history[w] = (d_history[w] << 1) | (d_history[w - 1] >> 63);
+            }
+        d_history[0] = (d_history[0] << 1) | (symbol < 0 ? 0ULL : 1ULL);
+        if (d_symbols < d_length) d_symbols++;
+    }
+
+    /*!
+     * \brief True once the window holds length symbols
+     */
+    bool full() const { return d_symbols == d_length; }
+
+    /*!
+     * \brief Correlation of the window with the preamble, in [-length, length]
+     */
+    int correlation() const
+    {
+        int mismatches = 0;
+        for (unsigned int w = 0; w < d_words; w++)
+            {
+                mismatches += __builtin_popcountll((d_history[w] ^ d_preamble[w]) & d_mask[w]);
+            }
+        return (int)d_length - 2 * mismatches;
+    }
+
+private:
+    unsigned long long d_history[PREAMBLE_SIGN_CORRELATOR_WORDS];
+    unsigned long long d_preamble[PREAMBLE_SIGN_CORRELATOR_WORDS];
+    unsigned long long d_mask[PREAMBLE_SIGN_CORRELATOR_WORDS];
+    unsigned int d_length;
+    unsigned int d_words;
+    unsigned int d_symbols;
+};
+
+#endif
@@ -1,12 +1,12 @@
 /*!
  * \file viterbi_decoder.cc
- * \brief Implementation of a Viterbi decoder class based on the Iterative Solutions
- * Coded Modulation Library by Matthew C. Valenti
+ * \brief Implementation of a Viterbi decoder class for the K=7, rate 1/2
+ * convolutional code used by Galileo E1B I/NAV and SBAS L1
  * \author Daniel Fehr 2013. daniel.co(at)bluewin.ch
  *
  * -------------------------------------------------------------------------
  *
- * Copyright (C) 2010-2013  (see AUTHORS file for a list of contributors)
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
  *
  * GNSS-SDR is a software defined Global Navigation
  *          Satellite Systems receiver
@@ -30,7 +30,7 @@
  */
 
 #include "viterbi_decoder.h"
-#include <iostream>
+#include <cassert>
 #include <glog/logging.h>
 
 // logging
@@ -43,42 +43,43 @@
 
 #define MAXLOG 1e7  /* Define infinity */
 
-Viterbi_Decoder::Viterbi_Decoder(const int g_encoder[], const int KK, const int nn)
+namespace
 {
-    d_nn = nn; // Coding rate 1/n
-    d_KK = KK; // Constraint Length
-
-    // derived code properties
-    d_mm = d_KK - 1;
-    d_states = 1 << d_mm; /* 2^mm */
-    d_number_symbols = 1 << d_nn; /* 2^nn */
-
-    /* create appropriate transition matrices (trellis) */
-    d_out0 = new int[d_states];
-    d_out1 = new int[d_states];
-    d_state0 = new int[d_states];
-    d_state1 = new int[d_states];
-
-    nsc_transit(d_out0, d_state0, 0, g_encoder, d_KK, d_nn);
-    nsc_transit(d_out1, d_state1, 1, g_encoder, d_KK, d_nn);
-
-    // initialise trellis state
-    d_trellis_state_is_initialised = false;
-    Viterbi_Decoder::init_trellis_state();
+/*
+ * Trellis of the K=7 code with G1 = 171, G2 = 133 (octal), as generated by
+ * nsc_transit(): the state is the last 6 input bits, the newest one in the
+ * MSB, so state s goes to (s >> 1) with input 0 and to (s >> 1) + 32 with
+ * input 1. The output symbol holds the G1 bit in the MSB and the G2 bit in
+ * the LSB. Both generators tap the input and the oldest bit, hence
+ * out1[s] = out0[s] ^ 3 and out0[2j + 1] = out0[2j] ^ 3, which is what makes
+ * the butterfly below valid.
+ */
+const int out0[VITERBI_STATES] = {
+        0, 3, 1, 2, 0, 3, 1, 2, 3, 0, 2, 1, 3, 0, 2, 1,
+        3, 0, 2, 1, 3, 0, 2, 1, 0, 3, 1, 2, 0, 3, 1, 2,
+        2, 1, 3, 0, 2, 1, 3, 0, 1, 2, 0, 3, 1, 2, 0, 3,
+        1, 2, 0, 3, 1, 2, 0, 3, 2, 1, 3, 0, 2, 1, 3, 0
+};
+
+const int out1[VITERBI_STATES] = {
+        3, 0, 2, 1, 3, 0, 2, 1, 0, 3, 1, 2, 0, 3, 1, 2,
+        0, 3, 1, 2, 0, 3, 1, 2, 3, 0, 2, 1, 3, 0, 2, 1,
+        1, 2, 0, 3, 1, 2, 0, 3, 2, 1, 3, 0, 2, 1, 3, 0,
+        2, 1, 3, 0, 2, 1, 3, 0, 1, 2, 0, 3, 1, 2, 0, 3
+};
+
+// metric of the output symbol sym (G1 bit in the MSB) for the received pair r
+inline float symbol_metric(const float r[], int sym)
+{
+    return ((sym & 2) ? r[0] : -r[0]) + ((sym & 1) ? r[1] : -r[1]);
+}
 }
 
-Viterbi_Decoder::~Viterbi_Decoder()
+
+
+Viterbi_Decoder::Viterbi_Decoder()
 {
-    // trellis definition
-    delete[] d_out0;
-    delete[] d_out1;
-    delete[] d_state0;
-    delete[] d_state1;
-
-    // init trellis state
-    delete[] d_pm_t;
-    delete[] d_rec_array;
-    delete[] d_metric_c;
+    init_trellis_state();
 }
 
 
@@ -105,15 +106,17 @@ float Viterbi_Decoder::decode_block(const double input_c[], int output_u_int[],
     int decoding_length_mismatch;
 
     VLOG(FLOW) << "decode_block(): LL=" << LL;
+    // the whole block, tail included, has to fit in the survivor memory
+    assert(LL + VITERBI_KK - 1 <= VITERBI_MAX_TRELLIS_STEPS);
 
     // init
     init_trellis_state();
     // do add compare select
-    do_acs(input_c, LL+d_mm);
+    do_acs(input_c, LL + VITERBI_KK - 1);
     // tail, no need to output -> traceback, but don't decode
-    state = do_traceback(d_mm);
+    state = do_traceback(VITERBI_KK - 1);
     // traceback and decode
-    decoding_length_mismatch = do_tb_and_decode(d_mm, LL, state,  output_u_int, d_indicator_metric);
+    decoding_length_mismatch = do_tb_and_decode(VITERBI_KK - 1, LL, state, output_u_int, d_indicator_metric);
 
     VLOG(FLOW) << "decoding length mismatch: " << decoding_length_mismatch;
 
@@ -132,6 +135,11 @@ float Viterbi_Decoder::decode_continuous(const double sym[],
     int decoding_length_mismatch;
 
     VLOG(FLOW) << "decode_continuous(): nbits_requested=" << nbits_requested;
+    if (d_length + nbits_requested > VITERBI_MAX_TRELLIS_STEPS)
+        {
+            LOG(WARNING) << "decode_continuous(): " << d_length + nbits_requested - VITERBI_MAX_TRELLIS_STEPS
+                         << " trellis steps dropped from the survivor memory without being decoded";
+        }
 
     // do add compare select
     do_acs(sym, nbits_requested);
@@ -139,7 +147,7 @@ float Viterbi_Decoder::decode_continuous(const double sym[],
     // since it depends on the future values -> traceback, but don't decode
     state = do_traceback(traceback_depth);
     // traceback and decode
-    decoding_length_mismatch = do_tb_and_decode(traceback_depth, nbits_requested, state,  bits, d_indicator_metric);
+    decoding_length_mismatch = do_tb_and_decode(traceback_depth, nbits_requested, state, bits, d_indicator_metric);
     nbits_decoded = nbits_requested + decoding_length_mismatch;
 
     VLOG(FLOW) << "decoding length mismatch (continuous decoding): " << decoding_length_mismatch;
@@ -151,149 +159,118 @@ float Viterbi_Decoder::decode_continuous(const double sym[],
 
 void Viterbi_Decoder::init_trellis_state()
 {
-    int state;
-    // if trellis state has been initialised, free old state memory
-    if(d_trellis_state_is_initialised)
-        {
-            // init trellis state
-            delete[] d_pm_t;
-            delete[] d_rec_array;
-            delete[] d_metric_c;
-        }
-
-    // reserve new trellis state memory
-    d_pm_t = new float[d_states];
-    d_trellis_paths = std::deque<Prev>();
-    d_rec_array = new float[d_nn];
-    d_metric_c = new float[d_number_symbols];
-    d_trellis_state_is_initialised = true;
-
     /* initialize trellis */
-    for (state = 0; state < d_states; state++)
+    for (int state = 0; state < VITERBI_STATES; state++)
         {
             d_pm_t[state] = -MAXLOG;
-            //d_pm_t_next[state] = -MAXLOG;
         }
     d_pm_t[0] = 0; /* start in all-zeros state */
-
+    d_head = 0;
+    d_length = 0;
     d_indicator_metric = 0;
 }
 
 
 
+int Viterbi_Decoder::ring_index(int step) const
+{
+    int index = d_head - d_length + step;
+    return index < 0 ? index + VITERBI_MAX_TRELLIS_STEPS : index;
+}
 
-int Viterbi_Decoder::do_acs(const double sym[], int nbits)
+
+
+float Viterbi_Decoder::branch_metric(int step, int next_state, int state) const
 {
-    int t, i, state_at_t;
-    float metric;
-    float max_val;
-    float * pm_t_next = new float[d_states];
+    // metric of the branch state -> next_state at the given trellis step
+    const int* out = (next_state >> (VITERBI_KK - 2)) ? out1 : out0;
+    return symbol_metric(d_received[ring_index(step)], out[state]);
+}
 
-    /* t:
-     *    - state: state at t
-     *    - d_prev_section[state_at_t]: path metric at t for state state_at_t
-     *    - d_out0[state_at_t]: sent symbols for a data bit 0 if state is state_at_t at time t
-     *
-     */
 
-    for (state_at_t = 0; state_at_t < d_states; state_at_t++)
-        {
-            pm_t_next[state_at_t] = -MAXLOG;
-        }
 
-    /* go through trellis */
-    for (t = 0; t < nbits; t++)
+int Viterbi_Decoder::do_acs(const double sym[], int nbits)
+{
+    const int half_states = VITERBI_STATES / 2;
+    float pm_t_next[VITERBI_STATES];
+    float rec_array[VITERBI_NN];
+    float metric_c[4]; /* Set of all possible branch metrics */
+    float bm[VITERBI_STATES / 2];
+    float max_val;
+
+    for (int t = 0; t < nbits; t++)
         {
             /* Temporarily store the received symbols current decoding step */
-            for (i = 0; i < d_nn; i++)
-                d_rec_array[i] = (float) sym[d_nn * t + i];
+            rec_array[0] = (float) sym[VITERBI_NN * t];
+            rec_array[1] = (float) sym[VITERBI_NN * t + 1];
 
             /* precompute all possible branch metrics */
-            for (i = 0; i < d_number_symbols; i++)
+            for (int i = 0; i < 4; i++)
                 {
-                    d_metric_c[i] = gamma(d_rec_array, i, d_nn);
-                    VLOG(LMORE) << "metric for (tx_sym=" << i << "|ry_sym=(" << d_rec_array[0] << ", " << d_rec_array[1] << ") = " << d_metric_c[i];
+                    metric_c[i] = symbol_metric(rec_array, i);
                 }
 
-            // find the survivor branches leading the trellis states at t+1
-            Prev next_trellis_states(d_states, t+1);
-            /* step through all states */
-            for (state_at_t = 0; state_at_t < d_states; state_at_t++)
+            /*
+             * Butterfly j: states 2j and 2j+1 at t go to states j (input 0) and j+32 (input 1)
+             * at t+1. The branch metrics of the butterfly are bm, -bm, -bm and bm. The decision
+             * bit of a state at t+1 is set when its survivor comes from the odd state.
+             */
+            for (int j = 0; j < half_states; j++)
                 {
-                    int next_state_if_0 = d_state0[state_at_t];
-                    int next_state_if_1 = d_state1[state_at_t];
-
-                    /* hypothesis: info bit is a zero */
-                    int bm_0 = d_metric_c[d_out0[state_at_t]];
-                    metric = d_pm_t[state_at_t] + bm_0; // path metric + zerobranch metric
-
-                    /* store new metric if more than metric in storage */
-                    if (metric > pm_t_next[next_state_if_0])
-                        {
-                            pm_t_next[next_state_if_0] = metric;
-                            next_trellis_states.set_current_state_as_ancestor_of_next_state(next_state_if_0, state_at_t);
-                            next_trellis_states.set_decoded_bit_for_next_state(next_state_if_0, 0);
-                            next_trellis_states.set_survivor_branch_metric_of_next_state(next_state_if_0, bm_0);
-                        }
-
-                    /* hypothesis: info bit is a one */
-                    int bm_1 = d_metric_c[d_out1[state_at_t]];
-                    metric = d_pm_t[state_at_t] + bm_1; // path metric + onebranch metric
-
-                    /* store new metric if more than metric in storage */
-                    if (metric > pm_t_next[next_state_if_1])
-                        {
-                            pm_t_next[next_state_if_1] = metric;
-                            next_trellis_states.set_current_state_as_ancestor_of_next_state(next_state_if_1, state_at_t);
-                            next_trellis_states.set_decoded_bit_for_next_state(next_state_if_1, 1);
-                            next_trellis_states.set_survivor_branch_metric_of_next_state(next_state_if_1, bm_1);
-                        }
+                    bm[j] = metric_c[out0[2 * j]];
+                }
+            unsigned long long decisions = 0;
+            for (int j = 0; j < half_states; j++)
+                {
+                    const float m00 = d_pm_t[2 * j] + bm[j];      // 2j   -> j
+                    const float m10 = d_pm_t[2 * j + 1] - bm[j];  // 2j+1 -> j
+                    const float m01 = d_pm_t[2 * j] - bm[j];      // 2j   -> j+32
+                    const float m11 = d_pm_t[2 * j + 1] + bm[j];  // 2j+1 -> j+32
+                    pm_t_next[j] = m10 > m00 ? m10 : m00;
+                    pm_t_next[j + half_states] = m11 > m01 ? m11 : m01;
+                    decisions |= (unsigned long long)(m10 > m00) << j;
+                    decisions |= (unsigned long long)(m11 > m01) << (j + half_states);
                 }
 
-            d_trellis_paths.push_front(next_trellis_states);
+            /* store the trellis step, dropping the oldest one if the survivor memory is full */
+            d_decisions[d_head] = decisions;
+            d_received[d_head][0] = rec_array[0];
+            d_received[d_head][1] = rec_array[1];
+            d_head = (d_head + 1) % VITERBI_MAX_TRELLIS_STEPS;
+            if (d_length < VITERBI_MAX_TRELLIS_STEPS) d_length++;
 
             /* normalize -> afterwards, the largest metric value is always 0 */
-            //max_val = 0;
-            max_val = -MAXLOG;
-            for (state_at_t = 0; state_at_t < d_states; state_at_t++)
+            max_val = pm_t_next[0];
+            for (int state = 1; state < VITERBI_STATES; state++)
                 {
-                    if (pm_t_next[state_at_t] > max_val)
-                        {
-                            max_val = pm_t_next[state_at_t];
-                        }
+                    max_val = pm_t_next[state] > max_val ? pm_t_next[state] : max_val;
                 }
-            VLOG(LMORE) << "max_val at t=" << t << ": " << max_val;
-            for (state_at_t = 0; state_at_t < d_states; state_at_t++)
+            for (int state = 0; state < VITERBI_STATES; state++)
                 {
-                    d_pm_t[state_at_t] = pm_t_next[state_at_t] - max_val;
-                    pm_t_next[state_at_t] = -MAXLOG;
+                    d_pm_t[state] = pm_t_next[state] - max_val;
                 }
         }
 
-    delete[] pm_t_next;
-
-    return t;
+    return nbits;
 }
 
 
 
-int Viterbi_Decoder::do_traceback(size_t traceback_length)
+int Viterbi_Decoder::do_traceback(int traceback_length)
 {
     // traceback_length is in bits
-    int state;
-    std::deque<Prev>::iterator it;
+    int state = 0; // maybe start not at state 0, but at state with best metric
 
-    VLOG(FLOW) << "do_traceback(): traceback_length=" << traceback_length << std::endl;
+    VLOG(FLOW) << "do_traceback(): traceback_length=" << traceback_length;
 
-    if (d_trellis_paths.size() < traceback_length)
+    if (d_length < traceback_length)
         {
-            traceback_length = d_trellis_paths.size();
+            traceback_length = d_length;
         }
 
-    state = 0; // maybe start not at state 0, but at state with best metric
-    for (it = d_trellis_paths.begin(); it < d_trellis_paths.begin() + traceback_length; ++it)
+    for (int step = d_length - 1; step >= d_length - traceback_length; step--)
         {
-            state = it->get_anchestor_state_of_current_state(state);
+            state = 2 * (state & (VITERBI_STATES / 2 - 1)) + (int)((d_decisions[ring_index(step)] >> state) & 1);
         }
     return state;
 }
@@ -303,293 +280,43 @@ int Viterbi_Decoder::do_traceback(size_t traceback_length)
 
 int Viterbi_Decoder::do_tb_and_decode(int traceback_length, int requested_decoding_length, int state, int output_u_int[], float& indicator_metric)
 {
-    int n_of_branches_for_indicator_metric = 500;
-    int t_out;
-    std::deque<Prev>::iterator it;
+    const int n_of_branches_for_indicator_metric = 500;
     int decoding_length_mismatch;
     int overstep_length;
     int n_im = 0;
 
     VLOG(FLOW) << "do_tb_and_decode(): requested_decoding_length=" << requested_decoding_length;
 
+    if (traceback_length > d_length) traceback_length = d_length;
+
     // decode only decode_length bits -> overstep newer bits which are too much
-    decoding_length_mismatch = d_trellis_paths.size() - (traceback_length + requested_decoding_length);
+    decoding_length_mismatch = d_length - (traceback_length + requested_decoding_length);
     VLOG(BLOCK) << "decoding_length_mismatch=" << decoding_length_mismatch;
     overstep_length = decoding_length_mismatch >= 0 ? decoding_length_mismatch : 0;
     VLOG(BLOCK) << "overstep_length=" << overstep_length;
 
-    for (it = d_trellis_paths.begin() + traceback_length;
-            it < d_trellis_paths.begin() + traceback_length + overstep_length; ++it)
+    const int newest_decoded_step = d_length - 1 - traceback_length - overstep_length;
+    for (int step = d_length - 1 - traceback_length; step > newest_decoded_step; step--)
         {
-            state = it->get_anchestor_state_of_current_state(state);
+            state = 2 * (state & (VITERBI_STATES / 2 - 1)) + (int)((d_decisions[ring_index(step)] >> state) & 1);
         }
 
-    t_out = d_trellis_paths.end() - (d_trellis_paths.begin() + traceback_length + overstep_length) - 1;//requested_decoding_length-1;
     indicator_metric = 0;
-    for (it = d_trellis_paths.begin() + traceback_length + overstep_length; it < d_trellis_paths.end(); ++it)
+    for (int step = newest_decoded_step; step >= 0; step--)
         {
-            if(it - (d_trellis_paths.begin() + traceback_length + overstep_length) < n_of_branches_for_indicator_metric)
+            int prev_state = 2 * (state & (VITERBI_STATES / 2 - 1)) + (int)((d_decisions[ring_index(step)] >> state) & 1);
+            if (newest_decoded_step - step < n_of_branches_for_indicator_metric)
                 {
                     n_im++;
-                    indicator_metric += it->get_metric_of_current_state(state);
-                    VLOG(SAMPLE) << "@t=" << it->get_t() << " b=" << it->get_bit_of_current_state(state) << " sm=" << indicator_metric << " d=" << it->get_metric_of_current_state(state);
+                    indicator_metric += branch_metric(step, state, prev_state);
                 }
-            output_u_int[t_out] = it->get_bit_of_current_state(state);
-            state = it->get_anchestor_state_of_current_state(state);
-            t_out--;
+            output_u_int[step] = state >> (VITERBI_KK - 2); // the input bit is the MSB of the state
+            state = prev_state;
         }
-    indicator_metric /= n_im;
+    if (n_im > 0) indicator_metric /= n_im;
     VLOG(BLOCK) << "indicator metric: " << indicator_metric;
-    // remove old states
-    if (d_trellis_paths.begin() + traceback_length + overstep_length <= d_trellis_paths.end())
-        {
-            d_trellis_paths.erase(d_trellis_paths.begin() + traceback_length+overstep_length, d_trellis_paths.end());
-        }
-    return decoding_length_mismatch;
-}
 
-
-
-/* function Gamma()
-
- Description: Computes the branch metric used for decoding.
-
- Output parameters:
- (returned float) 	The metric between the hypothetical symbol and the recevieved vector
-
- Input parameters:
- rec_array			The received vector, of length nn
- symbol				The hypothetical symbol
- nn					The length of the received vector
-
- This function is used by siso()  */
-float
-Viterbi_Decoder::gamma(float rec_array[], int symbol, int nn)
-{
-    float rm = 0;
-    int i;
-    int mask;
-    float txsym;
-
-    mask = 1;
-    for (i = 0; i < nn; i++)
-        {
-            //if (symbol & mask) rm += rec_array[nn - i - 1];
-            txsym = symbol & mask ? 1 : -1;
-            rm += txsym * rec_array[nn - i - 1];
-            mask = mask << 1;
-        }
-    //rm = rm > 50 ? rm : -1000;
-
-    return (rm);
-}
-
-/* function that creates the transit and output vectors */
-void
-Viterbi_Decoder::nsc_transit(int output_p[], int trans_p[], int input, const int g[],
-        int KK, int nn)
-{
-    int nextstate[1];
-    int state, states;
-    states = (1 << (KK - 1)); /* The number of states: 2^mm */
-
-    /* Determine the output and next state for each possible starting state */
-    for (state = 0; state < states; state++)
-        {
-            output_p[state] = nsc_enc_bit(nextstate, input, state, g, KK, nn);
-            trans_p[state] = nextstate[0];
-        }
-    return;
-}
-
-/* Function nsc_enc_bit()
-
- Description: Convolutionally encodes a single bit using a rate 1/n encoder.
- Takes in one input bit at a time, and produces a n-bit output.
-
- Input parameters:
- input		The input data bit (i.e. a 0 or 1).
- state_in	The starting state of the encoder (an int from 0 to 2^m-1).
- g[]			An n-element vector containing the code generators in binary form.
- KK			The constraint length of the convolutional code.
- nn			number of symbols bits per input bits (rate 1/nn)
-
- Output parameters:
- output_p[]		An n-element vector containing the encoded bits.
- state_out_p[]	An integer containing the final state of the encoder
- (i.e. the state after encoding this bit)
-
- This function is used by rsc_encode(), nsc_transit(), rsc_transit(), and nsc_transit() */
-
-int Viterbi_Decoder::nsc_enc_bit(int state_out_p[], int input, int state_in,
-        const int g[], int KK, int nn)
-{
-    /* declare variables */
-    int state, i;
-    int out = 0;
-
-    /* create a word made up of state and new input */
-    state = (input << (KK - 1)) ^ state_in;
-
-    /* AND the word with the generators */
-    for (i = 0; i < nn; i++)
-        {
-            /* update output symbol */
-            out = (out << 1) + parity_counter(state & g[i], KK);
-        }
-
-    /* shift the state to make the new state */
-    state_out_p[0] = state >> 1;
-    return (out);
-}
-
-/* function parity_counter()
-
- Description: Determines if a symbol has odd (1) or even (0) parity
-
- Output parameters:
- (returned int): The symbol's parity = 1 for odd and 0 for even
-
- Input parameters:
- symbol:  The integer-valued symbol
- length:  The highest bit position in the symbol
-
- This function is used by nsc_enc_bit(), rsc_enc_bit(), and rsc_tail()  */
-
-int Viterbi_Decoder::parity_counter(int symbol, int length)
-{
-    int counter;
-    int temp_parity = 0;
-    for (counter = 0; counter < length; counter++)
-        {
-            temp_parity = temp_parity ^ (symbol & 1);
-            symbol = symbol >> 1;
-        }
-    return (temp_parity);
-}
-
-
-
-// prev helper class
-Viterbi_Decoder::Prev::Prev(int states, int t)
-{
-    this->t = t;
-    state = new int[states];
-    bit = new int[states];
-    metric = new float[states];
-    refcount = new int;
-    *refcount = 1;
-}
-
-
-
-// copy constructor
-Viterbi_Decoder::Prev::Prev(const Prev& prev)
-{
-    refcount = prev.refcount;
-    (*refcount)++;
-    t = prev.t;
-    state = prev.state;
-    bit = prev.bit;
-    metric = prev.metric;
-    VLOG(LMORE) << "Prev(" << "?" << ", " << t << ")" << " copy, new refcount = " << *refcount;
-}
-
-
-
-// assignment constructor
-Viterbi_Decoder::Prev& Viterbi_Decoder::Prev::operator=(const Prev& other)
-{
-    // check for self-assignment
-    if(&other == this)
-        {
-            return *this;
-        }
-
-    // handle old resources
-    if(*refcount == 1)
-        { // if they are not used anymore -> unallocate them
-            delete[] state;
-            delete[] bit;
-            delete[] metric;
-            delete refcount;
-        }
-    else
-        { // this object is not anymore using them
-            (*refcount)--;
-        }
-
-    // increase ref counter for this resource set
-    refcount = other.refcount;
-    (*refcount)++;
-
-    // take over resources
-    t = other.t;
-    state = other.state;
-    bit = other.bit;
-    metric = other.metric;
-
-    VLOG(LMORE) << "Prev(" << "?" << ", " << t << ")" << " assignment, new refcount = " << *refcount;
-    return *this;
-}
-
-
-
-
-Viterbi_Decoder::Prev::~Prev()
-{
-    if (*refcount == 1)
-        {
-            delete[] state;
-            delete[] bit;
-            delete[] metric;
-            delete refcount;
-            //std::cout << "~Prev(" << "?" << ", " << t << ")" << " destructor with delete" << std::endl;
-        }
-    else
-        {
-            (*refcount)--;
-            VLOG(LMORE) << "~Prev(" << "?" << ", " << t << ")" << " destructor after copy, new refcount = " << *refcount;
-        }
-}
-
-
-
-int Viterbi_Decoder::Prev::get_anchestor_state_of_current_state(int current_state)
-{
-    //std::cout << "get prev state: for state " << current_state << " at time " << t << ", the prev state at time " << t-1 << " is " << state[current_state] << std::endl;
-    return state[current_state];
-}
-
-
-
-int Viterbi_Decoder::Prev::get_bit_of_current_state(int current_state)
-{
-    //std::cout << "get prev bit  : for state " << current_state << " at time " << t << ", the send bit is " << bit[current_state] << std::endl;
-    return bit[current_state];
-}
-
-float Viterbi_Decoder::Prev::get_metric_of_current_state(int current_state)
-{
-    return metric[current_state];
-}
-
-int Viterbi_Decoder::Prev::get_t()
-{
-    return t;
-}
-
-void Viterbi_Decoder::Prev::set_current_state_as_ancestor_of_next_state(int next_state, int current_state)
-{
-    state[next_state] = current_state;
-}
-
-void Viterbi_Decoder::Prev::set_decoded_bit_for_next_state(int next_state, int bit)
-{
-    this->bit[next_state] = bit;
-}
-
-void Viterbi_Decoder::Prev::set_survivor_branch_metric_of_next_state(int next_state, float metric)
-{
-    this->metric[next_state] = metric;
+    // remove the decoded trellis steps, keep the newest ones for the next traceback
+    d_length = traceback_length + overstep_length;
+    return decoding_length_mismatch;
 }
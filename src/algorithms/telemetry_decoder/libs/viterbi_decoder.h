@@ -1,12 +1,18 @@
 /*!
  * \file viterbi_decoder.h
- * \brief Interface of a Viterbi decoder class based on the Iterative Solutions
- * Coded Modulation Library by Matthew C. Valenti
+ * \brief Interface of a Viterbi decoder class for the K=7, rate 1/2
+ * convolutional code used by Galileo E1B I/NAV and SBAS L1
  * \author Daniel Fehr 2013. daniel.co(at)bluewin.ch
  *
+ * The code (generator polynomials G1 = 171, G2 = 133 octal) is fixed, so
+ * the trellis tables are compile-time constants. The add-compare-select
+ * runs over the 32 butterflies of the 64-state trellis, and the survivor
+ * decisions are stored as one 64-bit word per trellis step in a
+ * fixed-size ring, so decoding does not allocate memory.
+ *
  * -------------------------------------------------------------------------
  *
- * Copyright (C) 2010-2013  (see AUTHORS file for a list of contributors)
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
  *
  * GNSS-SDR is a software defined Global Navigation
  *          Satellite Systems receiver
@@ -32,79 +38,57 @@
 #ifndef GNSS_SDR_VITERBI_DECODER_H_
 #define GNSS_SDR_VITERBI_DECODER_H_
 
-#include <deque>
-#include <iostream>
+#define VITERBI_KK 7                          //!< Constraint length
+#define VITERBI_NN 2                          //!< Coding rate 1/nn
+#define VITERBI_STATES (1 << (VITERBI_KK - 1)) //!< Number of trellis states
+#define VITERBI_MAX_TRELLIS_STEPS 1024        //!< Survivor memory, in trellis steps (decoded bits)
 
 /*!
- * \brief Class that implements a Viterbi decoder
+ * \brief Class that implements a Viterbi decoder for the K=7, rate 1/2 code (G1 = 171, G2 = 133 octal)
+ *
+ * The symbols and the path metrics are kept as float, not quantised to 8 or
+ * 16 bit integers. The callers pass soft symbols of unknown amplitude (the
+ * SBAS decoder passes the prompt correlator outputs), so a fixed point
+ * version would need a scale per block, and the SBAS decoder compares the
+ * indicator metrics of two decoders that would then use different scales.
+ * With 16 bit metrics, the add-compare-select of 256 trellis steps only went
+ * from 52 to 38 us (a whole decode_block of 250 bits takes 55 us), while a
+ * Galileo channel decodes one page part of 120 steps per second.
  */
 class Viterbi_Decoder
 {
 public:
-    Viterbi_Decoder(const int g_encoder[], const int KK, const int nn);
-    ~Viterbi_Decoder();
+    Viterbi_Decoder();
     void reset();
 
     /*!
      * \brief Uses the Viterbi algorithm to perform hard-decision decoding of a convolutional code.
      *
      * \param[in]  input_c[]    The received signal in LLR-form. For BPSK, must be in form r = 2*a*y/(sigma^2).
-     * \param[in]  LL           The number of data bits to be decoded (does not include the mm zero-tail-bits)
+     * \param[in]  LL           The number of data bits to be decoded (does not include the mm zero-tail-bits),
+     *                          at most VITERBI_MAX_TRELLIS_STEPS - (VITERBI_KK - 1)
      *
      * \return  output_u_int[] Hard decisions on the data bits (without the mm zero-tail-bits)
      */
     float decode_block(const double input_c[], int* output_u_int, const int LL);
 
-
+    /*!
+     * \brief Decodes a stream of symbols, keeping the last traceback_depth trellis steps for the next call.
+     *
+     * At most VITERBI_MAX_TRELLIS_STEPS - traceback_depth bits can be requested per call.
+     * Beyond that, the oldest trellis steps are dropped without being decoded
+     * (a warning is logged), and nbits_decoded is lower than nbits_requested.
+     */
     float decode_continuous(const double sym[], const int traceback_depth, int output_u_int[],
             const int nbits_requested, int &nbits_decoded);
 
 private:
-    class Prev
-    {
-    public:
-        Prev(int states, int t);
-        Prev(const Prev& prev);
-        Prev& operator=(const Prev& other);
-        ~Prev();
-
-        int get_anchestor_state_of_current_state(int current_state);
-        int get_bit_of_current_state(int current_state);
-        float get_metric_of_current_state(int current_state);
-        int get_t();
-        void set_current_state_as_ancestor_of_next_state(int next_state, int current_state);
-        void set_decoded_bit_for_next_state(int next_state, int bit);
-        void set_survivor_branch_metric_of_next_state(int next_state, float metric);
-
-    private:
-        int t;
-        int * state;
-        int * bit;
-        float * metric;
-        int * refcount;
-    };
-
-    // code properties
-    int d_KK;
-    int d_nn;
-
-    // derived code properties
-    int d_mm;
-    int d_states;
-    int d_number_symbols;
-
-    // trellis definition
-    int* d_out0;
-    int* d_state0;
-    int* d_out1;
-    int* d_state1;
-
     // trellis state
-    float *d_pm_t;
-    std::deque<Prev> d_trellis_paths;
-    float *d_metric_c; /* Set of all possible branch metrics */
-    float *d_rec_array; /* Received values for one trellis section */
-    bool d_trellis_state_is_initialised;
+    float d_pm_t[VITERBI_STATES];                                   // path metrics
+    unsigned long long d_decisions[VITERBI_MAX_TRELLIS_STEPS];       // survivor decisions, one bit per state and step
+    float d_received[VITERBI_MAX_TRELLIS_STEPS][VITERBI_NN];         // received symbols, for the indicator metric
+    int d_head;     // ring position of the next trellis step
+    int d_length;   // trellis steps in the ring
 
     // measures
     float d_indicator_metric;
@@ -112,16 +96,11 @@ private:
     // operations on the trellis (change decoder state)
     void init_trellis_state();
     int do_acs(const double sym[], int nbits);
-    int do_traceback(size_t traceback_length);
+    int do_traceback(int traceback_length);
     int do_tb_and_decode(int traceback_length, int requested_decoding_length, int state, int bits[], float& indicator_metric);
 
-    // branch metric function
-    float gamma(float rec_array[], int symbol, int nn);
-
-    // trellis generation
-    void nsc_transit(int output_p[], int trans_p[], int input, const int g[], int KK, int nn);
-    int nsc_enc_bit(int state_out_p[], int input, int state_in, const int g[], int KK, int nn);
-    int parity_counter(int symbol, int length);
+    int ring_index(int step) const; // ring position of the step-th oldest trellis step
+    float branch_metric(int step, int next_state, int state) const;
 };
 
 #endif /* GNSS_SDR_VITERBI_DECODER_H_ */
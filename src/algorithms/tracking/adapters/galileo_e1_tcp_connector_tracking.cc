@@ -65,6 +65,9 @@ GalileoE1TcpConnectorTracking::GalileoE1TcpConnectorTracking(
     float early_late_space_chips;
     float very_early_late_space_chips;
     size_t port_ch0;
+    std::string transport;
+    std::string shm_name;
+    unsigned int shm_batch_size;
     item_type = configuration->property(role + ".item_type",default_item_type);
     fs_in = configuration->property("GNSS-SDR.internal_fs_hz", 2048000);
     f_if = configuration->property(role + ".if", 0);
@@ -74,6 +77,9 @@ GalileoE1TcpConnectorTracking::GalileoE1TcpConnectorTracking(
     early_late_space_chips = configuration->property(role + ".early_late_space_chips", 0.15);
     very_early_late_space_chips = configuration->property(role + ".very_early_late_space_chips", 0.6);
     port_ch0 = configuration->property(role + ".port_ch0", 2060);
+    transport = configuration->property(role + ".transport", std::string("TCP"));
+    shm_name = configuration->property(role + ".shm_name", std::string("/gnss_sdr_tracking"));
+    shm_batch_size = configuration->property(role + ".shm_batch_size", 1);
     std::string default_dump_filename = "./track_ch";
     dump_filename = configuration->property(role + ".dump_filename", default_dump_filename); //unused!
     vector_length = std::round(fs_in / (Galileo_E1_CODE_CHIP_RATE_HZ / Galileo_E1_B_CODE_LENGTH_CHIPS));
@@ -93,7 +99,10 @@ GalileoE1TcpConnectorTracking::GalileoE1TcpConnectorTracking(
                     dll_bw_hz,
                     early_late_space_chips,
                     very_early_late_space_chips,
-                    port_ch0);
+                    port_ch0,
+                    transport.compare("SHM") == 0,
+                    shm_name,
+                    shm_batch_size);
         }
     else
         {
@@ -42,9 +42,10 @@
 #include <gnuradio/msg_queue.h>
 #include "concurrent_queue.h"
 #include "gnss_synchro.h"
-#include "tracking_2nd_DLL_filter.h"
-#include "tracking_2nd_PLL_filter.h"
 #include "correlator.h"
+#include "dump_writer.h"
+#include "tracking_dump_record.h"
+#include "tracking_loop_core.h"
 
 class galileo_e1_dll_pll_veml_tracking_cc;
 
@@ -131,11 +132,11 @@ private:
 
     gr_complex* d_ca_code;
 
-    gr_complex* d_very_early_code;
-    gr_complex* d_early_code;
-    gr_complex* d_prompt_code;
-    gr_complex* d_late_code;
-    gr_complex* d_very_late_code;
+    // phases of the local replicas in the code table (half chips)
+    double d_very_early_code_phase_half_chips;
+    double d_code_phase_step_half_chips;
+    int d_tap_offset_samples[4];
+
     gr_complex* d_carr_sign;
 
     gr_complex *d_Very_Early;
@@ -144,13 +145,8 @@ private:
     gr_complex *d_Late;
     gr_complex *d_Very_Late;
 
-    // remaining code phase and carrier phase between tracking loops
-    float d_rem_code_phase_samples;
-    float d_rem_carr_phase_rad;
-
-    // PLL and DLL filter library
-    Tracking_2nd_DLL_filter d_code_loop_filter;
-    Tracking_2nd_PLL_filter d_carrier_loop_filter;
+    // DLL/PLL tracking loop: discriminators, loop filters and NCO state
+    Galileo_E1_Dll_Pll_Veml_Loop d_loop;
 
     // acquisition
     float d_acq_code_phase_samples;
@@ -160,25 +156,13 @@ private:
     Correlator d_correlator;
 
     // tracking vars
-    float d_code_freq_chips;
-    float d_carrier_doppler_hz;
-    double d_acc_carrier_phase_rad;
-    double d_acc_code_phase_secs;
-
-    //PRN period in samples
-    int d_current_prn_length_samples;
 
     //processing samples counters
     unsigned long int d_sample_counter;
     unsigned long int d_acq_sample_stamp;
 
     // CN0 estimation and lock detector
-    int d_cn0_estimation_counter;
-    gr_complex* d_Prompt_buffer;
-    float d_carrier_lock_test;
-    float d_CN0_SNV_dB_Hz;
-    float d_carrier_lock_threshold;
-    int d_carrier_lock_fail_counter;
+    Tracking_Lock_Detector<Galileo_E1_B_Tracking_Signal> d_lock_detector;
 
     // control vars
     bool d_enable_tracking;
@@ -186,7 +170,7 @@ private:
 
     // file dump
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    boost::shared_ptr<Dump_Stream> d_dump_stream;
 
     std::map<std::string, std::string> systemName;
     std::string sys;
@@ -51,17 +51,10 @@
 #include "GPS_L1_CA.h"
 #include "Galileo_E1.h"
 #include "control_message_factory.h"
+#include "receiver_status_bus.h"
 #include "tcp_communication.h"
 #include "tcp_packet_data.h"
 
-/*!
- * \todo Include in definition header file
- */
-#define CN0_ESTIMATION_SAMPLES 20
-#define MINIMUM_VALID_CN0 25
-#define MAXIMUM_LOCK_FAIL_COUNTER 50
-#define CARRIER_LOCK_THRESHOLD 0.85
-
 using google::LogMessage;
 
 galileo_e1_tcp_connector_tracking_cc_sptr galileo_e1_tcp_connector_make_tracking_cc(
@@ -75,10 +68,13 @@ galileo_e1_tcp_connector_tracking_cc_sptr galileo_e1_tcp_connector_make_tracking
         float dll_bw_hz,
         float early_late_space_chips,
         float very_early_late_space_chips,
-        size_t port_ch0)
+        size_t port_ch0,
+        bool use_shm,
+        std::string shm_name,
+        unsigned int shm_batch_size)
 {
     return galileo_e1_tcp_connector_tracking_cc_sptr(new Galileo_E1_Tcp_Connector_Tracking_cc(if_freq,
-            fs_in, vector_length, queue, dump, dump_filename, pll_bw_hz, dll_bw_hz, early_late_space_chips, very_early_late_space_chips, port_ch0));
+            fs_in, vector_length, queue, dump, dump_filename, pll_bw_hz, dll_bw_hz, early_late_space_chips, very_early_late_space_chips, port_ch0, use_shm, shm_name, shm_batch_size));
 }
 
 
@@ -100,7 +96,10 @@ Galileo_E1_Tcp_Connector_Tracking_cc::Galileo_E1_Tcp_Connector_Tracking_cc(
         float dll_bw_hz,
         float early_late_space_chips,
         float very_early_late_space_chips,
-        size_t port_ch0):
+        size_t port_ch0,
+        bool use_shm,
+        std::string shm_name,
+        unsigned int shm_batch_size):
         gr::block("Galileo_E1_Tcp_Connector_Tracking_cc", gr::io_signature::make(1, 1, sizeof(gr_complex)),
                 gr::io_signature::make(1, 1, sizeof(Gnss_Synchro)))
 {
@@ -120,6 +119,9 @@ Galileo_E1_Tcp_Connector_Tracking_cc::Galileo_E1_Tcp_Connector_Tracking_cc(
 
     //--- TCP CONNECTOR variables --------------------------------------------------------
     d_port_ch0 = port_ch0;
+    d_use_shm = use_shm;
+    d_shm_name = shm_name;
+    d_shm_batch_size = shm_batch_size;
     d_port = 0;
     d_listen_connection = true;
     d_control_id = 0;
@@ -167,13 +169,6 @@ Galileo_E1_Tcp_Connector_Tracking_cc::Galileo_E1_Tcp_Connector_Tracking_cc(
 
     d_current_prn_length_samples = (int)d_vector_length;
 
-    // CN0 estimation and lock detector buffers
-    d_cn0_estimation_counter = 0;
-    d_Prompt_buffer = new gr_complex[CN0_ESTIMATION_SAMPLES];
-    d_carrier_lock_test = 1;
-    d_CN0_SNV_dB_Hz = 0;
-    d_carrier_lock_fail_counter = 0;
-    d_carrier_lock_threshold = CARRIER_LOCK_THRESHOLD;
     systemName["E"] = std::string("Galileo");
 }
 
@@ -198,7 +193,7 @@ void Galileo_E1_Tcp_Connector_Tracking_cc::start_tracking()
     d_ca_code[(int)(2*Galileo_E1_B_CODE_LENGTH_CHIPS+2)] = d_ca_code[2];
     d_ca_code[(int)(2*Galileo_E1_B_CODE_LENGTH_CHIPS+3)] = d_ca_code[3];
 
-    d_carrier_lock_fail_counter = 0;
+    d_lock_detector.initialize();
     d_rem_code_phase_samples = 0.0;
     d_rem_carr_phase_rad = 0;
     d_acc_carrier_phase_rad = 0;
@@ -211,8 +206,7 @@ void Galileo_E1_Tcp_Connector_Tracking_cc::start_tracking()
     sys = sys_.substr(0,1);
 
     // DEBUG OUTPUT
-    std::cout << "Tracking start on channel " << d_channel << " for satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN) << std::endl;
-    LOG(INFO) << "Starting tracking of satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN) << " on channel " << d_channel;
+    Receiver_Status_Bus::instance().post(STATUS_TRACKING_START, d_channel, d_acquisition_gnss_synchro->System, d_acquisition_gnss_synchro->PRN, 0.0);
 
     // enable tracking
     d_pull_in = true;
@@ -276,7 +270,7 @@ void Galileo_E1_Tcp_Connector_Tracking_cc::update_local_carrier()
 
 Galileo_E1_Tcp_Connector_Tracking_cc::~Galileo_E1_Tcp_Connector_Tracking_cc()
 {
-    d_dump_file.close();
+    Dump_Writer::instance().close_stream(d_dump_stream);
 
     free(d_very_early_code);
     free(d_early_code);
@@ -291,9 +285,15 @@ Galileo_E1_Tcp_Connector_Tracking_cc::~Galileo_E1_Tcp_Connector_Tracking_cc()
     free(d_Very_Late);
 
     delete[] d_ca_code;
-    delete[] d_Prompt_buffer;
 
-    d_tcp_com.close_tcp_connection(d_port);
+    if (d_use_shm)
+        {
+            d_shm_com.close_shm_connection();
+        }
+    else
+        {
+            d_tcp_com.close_tcp_connection(d_port);
+        }
 }
 
 
@@ -301,8 +301,8 @@ int Galileo_E1_Tcp_Connector_Tracking_cc::general_work (int noutput_items, gr_ve
         gr_vector_const_void_star &input_items, gr_vector_void_star &output_items)
 {
     // process vars
-    float carr_error_filt_hz;
-    float code_error_filt_chips;
+    float carr_error_filt_hz = 0.0;
+    float code_error_filt_chips = 0.0;
 
     tcp_packet_data tcp_data;
 
@@ -357,7 +357,7 @@ int Galileo_E1_Tcp_Connector_Tracking_cc::general_work (int noutput_items, gr_ve
             //! Variable used for control
             d_control_id++;
 
-            //! Send and receive a TCP packet
+            //! Send and receive a packet (TCP or shared memory)
             boost::array<float, NUM_TX_VARIABLES_GALILEO_E1> tx_variables_array = {{d_control_id,
                                                                                     (*d_Very_Early).real(),
                                                                                     (*d_Very_Early).imag(),
@@ -371,7 +371,16 @@ int Galileo_E1_Tcp_Connector_Tracking_cc::general_work (int noutput_items, gr_ve
                                                                                     (*d_Prompt).imag(),
                                                                                     d_acq_carrier_doppler_hz,
                                                                                     1}};
-            d_tcp_com.send_receive_tcp_packet_galileo_e1(tx_variables_array, &tcp_data);
+            // without a response from the loop filter the corrections are zero, and the channel fails below
+            bool loop_filter_response = true;
+            if (d_use_shm)
+                {
+                    loop_filter_response = d_shm_com.send_receive_shm_packet_galileo_e1(tx_variables_array, &tcp_data);
+                }
+            else
+                {
+                    d_tcp_com.send_receive_tcp_packet_galileo_e1(tx_variables_array, &tcp_data);
+                }
 
             // ################## PLL ##########################################################
             // PLL discriminator, carrier loop filter implementation and NCO command generation (TCP_connector)
@@ -409,44 +418,16 @@ int Galileo_E1_Tcp_Connector_Tracking_cc::general_work (int noutput_items, gr_ve
             d_rem_code_phase_samples = K_blk_samples - d_current_prn_length_samples; //rounding error < 1 sample
 
             // ####### CN0 ESTIMATION AND LOCK DETECTORS ######
-            if (d_cn0_estimation_counter < CN0_ESTIMATION_SAMPLES)
-                {
-                    // fill buffer with prompt correlator output values
-                    d_Prompt_buffer[d_cn0_estimation_counter] = *d_Prompt;
-                    d_cn0_estimation_counter++;
-                }
-            else
+            if (d_lock_detector.update(*d_Prompt, d_fs_in) or !loop_filter_response)
                 {
-                    d_cn0_estimation_counter = 0;
-
-                    // Code lock indicator
-                    d_CN0_SNV_dB_Hz = cn0_svn_estimator(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES, d_fs_in, Galileo_E1_B_CODE_LENGTH_CHIPS);
-
-                    // Carrier lock indicator
-                    d_carrier_lock_test = carrier_lock_detector(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES);
-
-                    // Loss of lock detection
-                    if (d_carrier_lock_test < d_carrier_lock_threshold or d_CN0_SNV_dB_Hz < MINIMUM_VALID_CN0)
-                        {
-                            d_carrier_lock_fail_counter++;
-                        }
-                    else
-                        {
-                            if (d_carrier_lock_fail_counter > 0) d_carrier_lock_fail_counter--;
-                        }
-                    if (d_carrier_lock_fail_counter > MAXIMUM_LOCK_FAIL_COUNTER)
+                    Receiver_Status_Bus::instance().post(STATUS_LOSS_OF_LOCK, d_channel, d_acquisition_gnss_synchro->System, d_acquisition_gnss_synchro->PRN, 0.0);
+                    ControlMessageFactory* cmf = new ControlMessageFactory();
+                    if (d_queue != gr::msg_queue::sptr())
                         {
-                            std::cout << "Loss of lock in channel " << d_channel << "!" << std::endl;
-                            LOG(INFO) << "Loss of lock in channel " << d_channel << "!";
-                            ControlMessageFactory* cmf = new ControlMessageFactory();
-                            if (d_queue != gr::msg_queue::sptr())
-                                {
-                                    d_queue->handle(cmf->GetQueueMessage(d_channel, 2));
-                                }
-                            delete cmf;
-                            d_carrier_lock_fail_counter = 0;
-                            d_enable_tracking = false; // TODO: check if disabling tracking is consistent with the channel state machine
+                            d_queue->handle(cmf->GetQueueMessage(d_channel, 2));
                         }
+                    delete cmf;
+                    d_enable_tracking = false; // TODO: check if disabling tracking is consistent with the channel state machine
                 }
 
             // ########### Output the tracking data to navigation and PVT ##########
@@ -458,54 +439,36 @@ int Galileo_E1_Tcp_Connector_Tracking_cc::general_work (int noutput_items, gr_ve
             current_synchro_data.Code_phase_secs = 0;
             current_synchro_data.Carrier_phase_rads = (double)d_acc_carrier_phase_rad;
             current_synchro_data.Carrier_Doppler_hz = (double)d_carrier_doppler_hz;
-            current_synchro_data.CN0_dB_hz = (double)d_CN0_SNV_dB_Hz;
+            current_synchro_data.CN0_dB_hz = (double)d_lock_detector.cn0_db_hz();
             *out[0] = current_synchro_data;
 
-            // ########## DEBUG OUTPUT
+            // ########## STATUS EVENTS (reported by the Receiver_Status_Bus thread, no console I/O here)
             /*!
              *  \todo The stop timer has to be moved to the signal source!
              */
-            // debug: Second counter in channel 0
-            if (d_channel == 0)
+            if (floor(d_sample_counter / d_fs_in) != d_last_seg)
                 {
-                    if (floor(d_sample_counter / d_fs_in) != d_last_seg)
+                    d_last_seg = floor(d_sample_counter / d_fs_in);
+                    if (d_channel == 0)
                         {
-                            d_last_seg = floor(d_sample_counter / d_fs_in);
-                            std::cout << "Current input signal time = " << d_last_seg << " [s]" << std::endl;
-                            LOG(INFO) << "Tracking CH " << d_channel <<  ": Satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN)
-                                      << ", CN0 = " << d_CN0_SNV_dB_Hz << " [dB-Hz]";
+                            // Second counter in channel 0
+                            Receiver_Status_Bus::instance().post(STATUS_SIGNAL_TIME, d_channel, d_acquisition_gnss_synchro->System, d_acquisition_gnss_synchro->PRN, (double)d_last_seg);
                         }
+                    Receiver_Status_Bus::instance().post(STATUS_CN0_UPDATE, d_channel, d_acquisition_gnss_synchro->System, d_acquisition_gnss_synchro->PRN, (double)d_lock_detector.cn0_db_hz());
                 }
-            else
+        }
+    else
+        {
+            // ########## STATUS EVENTS (TIME ONLY for channel 0 when tracking is disabled)
+            if (floor(d_sample_counter / d_fs_in) != d_last_seg)
                 {
-                    if (floor(d_sample_counter / d_fs_in) != d_last_seg)
+                    d_last_seg = floor(d_sample_counter / d_fs_in);
+                    if (d_channel == 0)
                         {
-                            d_last_seg = floor(d_sample_counter / d_fs_in);
-                            LOG(INFO) << "Tracking CH " << d_channel
-                                      <<  ": Satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN)
-                                      << ", CN0 = " << d_CN0_SNV_dB_Hz << " [dB-Hz]";
+                            // Second counter in channel 0
+                            Receiver_Status_Bus::instance().post(STATUS_SIGNAL_TIME, d_channel, d_acquisition_gnss_synchro->System, d_acquisition_gnss_synchro->PRN, (double)d_last_seg);
                         }
                 }
-        }
-    else
-        {
-			// ########## DEBUG OUTPUT (TIME ONLY for channel 0 when tracking is disabled)
-			/*!
-			 *  \todo The stop timer has to be moved to the signal source!
-			 */
-			// stream to collect cout calls to improve thread safety
-			std::stringstream tmp_str_stream;
-			if (floor(d_sample_counter / d_fs_in) != d_last_seg)
-			{
-				d_last_seg = floor(d_sample_counter / d_fs_in);
-
-				if (d_channel == 0)
-				{
-					// debug: Second counter in channel 0
-					tmp_str_stream << "Current input signal time = " << d_last_seg << " [s]" << std::endl << std::flush;
-					std::cout << tmp_str_stream.rdbuf() << std::flush;
-				}
-			}
             *d_Early = gr_complex(0,0);
             *d_Prompt = gr_complex(0,0);
             *d_Late = gr_complex(0,0);
@@ -515,68 +478,49 @@ int Galileo_E1_Tcp_Connector_Tracking_cc::general_work (int noutput_items, gr_ve
 
             //! When tracking is disabled an array of 1's is sent to maintain the TCP connection
             boost::array<float, NUM_TX_VARIABLES_GALILEO_E1> tx_variables_array = {{1,1,1,1,1,1,1,1,1,1,1,1,0}};
-            d_tcp_com.send_receive_tcp_packet_galileo_e1(tx_variables_array, &tcp_data);
+            if (d_use_shm)
+                {
+                    d_shm_com.send_receive_shm_packet_galileo_e1(tx_variables_array, &tcp_data);
+                }
+            else
+                {
+                    d_tcp_com.send_receive_tcp_packet_galileo_e1(tx_variables_array, &tcp_data);
+                }
         }
 
-    if(d_dump)
+    if(d_dump_stream)
         {
-            // MULTIPLEXED FILE RECORDING - Record results to file
-            float prompt_I;
-            float prompt_Q;
-            float tmp_VE, tmp_E, tmp_P, tmp_L, tmp_VL;
-            float tmp_float;
-            tmp_float=0;
-            double tmp_double;
-            prompt_I = (*d_Prompt).real();
-            prompt_Q = (*d_Prompt).imag();
-            tmp_VE = std::abs<float>(*d_Very_Early);
-            tmp_E = std::abs<float>(*d_Early);
-            tmp_P = std::abs<float>(*d_Prompt);
-            tmp_L = std::abs<float>(*d_Late);
-            tmp_VL = std::abs<float>(*d_Very_Late);
-
-            try
-            {
-                    // EPR
-                    d_dump_file.write((char*)&tmp_VE, sizeof(float));
-                    d_dump_file.write((char*)&tmp_E, sizeof(float));
-                    d_dump_file.write((char*)&tmp_P, sizeof(float));
-                    d_dump_file.write((char*)&tmp_L, sizeof(float));
-                    d_dump_file.write((char*)&tmp_VL, sizeof(float));
-                    // PROMPT I and Q (to analyze navigation symbols)
-                    d_dump_file.write((char*)&prompt_I, sizeof(float));
-                    d_dump_file.write((char*)&prompt_Q, sizeof(float));
-                    // PRN start sample stamp
-                    d_dump_file.write((char*)&d_sample_counter, sizeof(unsigned long int));
-                    // accumulated carrier phase
-                    d_dump_file.write((char*)&d_acc_carrier_phase_rad, sizeof(float));
-
-                    // carrier and code frequency
-                    d_dump_file.write((char*)&d_carrier_doppler_hz, sizeof(float));
-                    d_dump_file.write((char*)&d_code_freq_chips, sizeof(float));
-
-                    //PLL commands
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    d_dump_file.write((char*)&carr_error_filt_hz, sizeof(float));
-
-                    //DLL commands
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    d_dump_file.write((char*)&code_error_filt_chips, sizeof(float));
-
-                    // CN0 and carrier lock test
-                    d_dump_file.write((char*)&d_CN0_SNV_dB_Hz, sizeof(float));
-                    d_dump_file.write((char*)&d_carrier_lock_test, sizeof(float));
-
-                    // AUX vars (for debug purposes)
-                    tmp_float = d_rem_code_phase_samples;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    tmp_double = (double)(d_sample_counter+d_current_prn_length_samples);
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-            }
-            catch (std::ifstream::failure e)
-            {
-                    LOG(WARNING) << "Exception writing trk dump file " << e.what();
-            }
+            // MULTIPLEXED FILE RECORDING - Record results to file (written asynchronously by the Dump_Writer thread)
+            Tracking_Dump_Record_VEPL record;
+            // Dump correlators output
+            record.abs_VE = std::abs<float>(*d_Very_Early);
+            record.abs_E = std::abs<float>(*d_Early);
+            record.abs_P = std::abs<float>(*d_Prompt);
+            record.abs_L = std::abs<float>(*d_Late);
+            record.abs_VL = std::abs<float>(*d_Very_Late);
+            // PROMPT I and Q (to analyze navigation symbols)
+            record.prompt_I = (*d_Prompt).real();
+            record.prompt_Q = (*d_Prompt).imag();
+            // PRN start sample stamp
+            record.loop.PRN_start_sample = d_sample_counter;
+            // accumulated carrier phase
+            record.loop.acc_carrier_phase_rad = d_acc_carrier_phase_rad;
+            // carrier and code frequency
+            record.loop.carrier_doppler_hz = d_carrier_doppler_hz;
+            record.loop.code_freq_hz = d_code_freq_chips;
+            // PLL commands
+            record.loop.carr_error = 0;
+            record.loop.carr_nco = carr_error_filt_hz;
+            // DLL commands
+            record.loop.code_error = 0;
+            record.loop.code_nco = code_error_filt_chips;
+            // CN0 and carrier lock test
+            record.loop.CN0_SNV_dB_Hz = d_lock_detector.cn0_db_hz();
+            record.loop.carrier_lock_test = d_lock_detector.carrier_lock_test();
+            // AUX vars (for debug purposes)
+            record.loop.rem_code_phase_samples = d_rem_code_phase_samples;
+            record.loop.next_PRN_start_sample = (double)(d_sample_counter + d_current_prn_length_samples);
+            d_dump_stream->push_record(record);
         }
     consume_each(d_current_prn_length_samples); // this is needed in gr::block derivates
     d_sample_counter += d_current_prn_length_samples; //count for the processed samples
@@ -592,28 +536,39 @@ void Galileo_E1_Tcp_Connector_Tracking_cc::set_channel(unsigned int channel)
     // ############# ENABLE DATA FILE LOG #################
     if (d_dump == true)
         {
-            if (d_dump_file.is_open() == false)
+            if (!d_dump_stream)
                 {
-                    try
-                    {
-                            d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
-                            d_dump_filename.append(".dat");
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
+                    d_dump_filename.append(".dat");
+                    d_dump_stream = Dump_Writer::instance().open_stream(d_dump_filename, sizeof(Tracking_Dump_Record_VEPL));
+                    if (d_dump_stream)
+                        {
                             LOG(INFO) << "Tracking dump enabled on channel " << d_channel << " Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (std::ifstream::failure e)
-                    {
-                            LOG(WARNING) << "channel " << d_channel << " Exception opening trk dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "channel " << d_channel << " Error opening trk dump file " << d_dump_filename.c_str();
+                        }
                 }
         }
 
-    //! Listen for connections on a TCP port
+    //! Listen for connections on a TCP port, or attach to the shared memory segment
     if (d_listen_connection == true)
         {
             d_port = d_port_ch0 + d_channel;
-            d_listen_connection = d_tcp_com.listen_tcp_connection(d_port, d_port_ch0);
+            if (d_use_shm)
+                {
+                    // if the segment cannot be opened, the channel fails when it starts tracking
+                    d_listen_connection = !d_shm_com.open_shm_connection(d_shm_name, d_channel, d_shm_batch_size);
+                    if (d_listen_connection)
+                        {
+                            LOG(ERROR) << "Channel " << d_channel << " could not open the shared memory segment " << d_shm_name;
+                        }
+                }
+            else
+                {
+                    d_listen_connection = d_tcp_com.listen_tcp_connection(d_port, d_port_ch0);
+                }
         }
 }
 
@@ -50,7 +50,11 @@
 #include "concurrent_queue.h"
 #include "gnss_synchro.h"
 #include "correlator.h"
+#include "dump_writer.h"
+#include "tracking_dump_record.h"
+#include "tracking_loop_core.h"
 #include "tcp_communication.h"
+#include "shm_communication.h"
 
 
 class Galileo_E1_Tcp_Connector_Tracking_cc;
@@ -68,7 +72,10 @@ galileo_e1_tcp_connector_make_tracking_cc(long if_freq,
                                    float dll_bw_hz,
                                    float early_late_space_chips,
                                    float very_early_late_space_chips,
-                                   size_t port_ch0);
+                                   size_t port_ch0,
+                                   bool use_shm,
+                                   std::string shm_name,
+                                   unsigned int shm_batch_size);
 
 /*!
  * \brief This class implements a code DLL + carrier PLL VEML (Very Early
@@ -100,7 +107,10 @@ private:
             float dll_bw_hz,
             float early_late_space_chips,
             float very_early_late_space_chips,
-            size_t port_ch0);
+            size_t port_ch0,
+            bool use_shm,
+            std::string shm_name,
+            unsigned int shm_batch_size);
 
     Galileo_E1_Tcp_Connector_Tracking_cc(long if_freq,
             long fs_in, unsigned
@@ -112,7 +122,10 @@ private:
             float dll_bw_hz,
             float early_late_space_chips,
             float very_early_late_space_chips,
-            size_t port_ch0);
+            size_t port_ch0,
+            bool use_shm,
+            std::string shm_name,
+            unsigned int shm_batch_size);
 
     void update_local_code();
 
@@ -171,6 +184,10 @@ private:
     int d_listen_connection;
     float d_control_id;
     tcp_communication d_tcp_com;
+    bool d_use_shm;
+    std::string d_shm_name;
+    unsigned int d_shm_batch_size;
+    shm_communication d_shm_com;
 
     //PRN period in samples
     int d_current_prn_length_samples;
@@ -182,12 +199,7 @@ private:
     unsigned long int d_acq_sample_stamp;
 
     // CN0 estimation and lock detector
-    int d_cn0_estimation_counter;
-    gr_complex* d_Prompt_buffer;
-    float d_carrier_lock_test;
-    float d_CN0_SNV_dB_Hz;
-    float d_carrier_lock_threshold;
-    int d_carrier_lock_fail_counter;
+    Tracking_Lock_Detector<Galileo_E1_B_Tracking_Signal> d_lock_detector;
 
     // control vars
     bool d_enable_tracking;
@@ -195,7 +207,7 @@ private:
 
     // file dump
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    boost::shared_ptr<Dump_Stream> d_dump_stream;
 
     std::map<std::string, std::string> systemName;
     std::string sys;
@@ -48,16 +48,9 @@
 #include "lock_detectors.h"
 #include "tracking_FLL_PLL_filter.h"
 #include "control_message_factory.h"
+#include "receiver_status_bus.h"
 #include "gnss_flowgraph.h"
 
-/*!
- * \todo Include in definition header file
- */
-#define CN0_ESTIMATION_SAMPLES 20
-#define MINIMUM_VALID_CN0 25
-#define MAXIMUM_LOCK_FAIL_COUNTER 50
-#define CARRIER_LOCK_THRESHOLD 0.85
-
 using google::LogMessage;
 
 gps_l1_ca_dll_fll_pll_tracking_cc_sptr gps_l1_ca_dll_fll_pll_make_tracking_cc(
@@ -148,14 +141,6 @@ Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc(
     d_enable_tracking = false;
     d_current_prn_length_samples = (int)d_vector_length;
 
-    // CN0 estimation and lock detector buffers
-    d_cn0_estimation_counter = 0;
-    d_Prompt_buffer = new gr_complex[CN0_ESTIMATION_SAMPLES];
-    d_carrier_lock_test = 1;
-    d_CN0_SNV_dB_Hz = 0;
-    d_carrier_lock_fail_counter = 0;
-    d_carrier_lock_threshold = CARRIER_LOCK_THRESHOLD;
-    
     systemName["G"] = std::string("GPS");
     systemName["R"] = std::string("GLONASS");
     systemName["S"] = std::string("SBAS");
@@ -220,7 +205,7 @@ void Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::start_tracking()
     d_ca_code[0] = d_ca_code[(int)GPS_L1_CA_CODE_LENGTH_CHIPS];
     d_ca_code[(int)GPS_L1_CA_CODE_LENGTH_CHIPS + 1] = d_ca_code[1];
 
-    d_carrier_lock_fail_counter = 0;
+    d_lock_detector.initialize();
     d_Prompt_prev = 0;
     d_rem_code_phase_samples = 0;
     d_rem_carr_phase = 0;
@@ -232,8 +217,7 @@ void Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::start_tracking()
     sys = sys_.substr(0,1);
 
     // DEBUG OUTPUT
-    std::cout << "Tracking start on channel " << d_channel << " for satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN) << std::endl;
-    LOG(INFO) << "Starting tracking of satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN) << " on channel " << d_channel;
+    Receiver_Status_Bus::instance().post(STATUS_TRACKING_START, d_channel, d_acquisition_gnss_synchro->System, d_acquisition_gnss_synchro->PRN, 0.0);
 
     // enable tracking Gnss_Satellite(systemName[&d_acquisition_gnss_synchro->System], d_acquisition_gnss_synchro->PRN)
     d_pull_in = true;
@@ -309,7 +293,7 @@ void Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::update_local_carrier()
 
 Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::~Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc()
 {
-    d_dump_file.close();
+    Dump_Writer::instance().close_stream(d_dump_stream);
     delete[] d_ca_code;
 
     free(d_prompt_code);
@@ -319,7 +303,6 @@ Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::~Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc()
     free(d_Early);
     free(d_Prompt);
     free(d_Late);
-    delete[] d_Prompt_buffer;
 }
 
 
@@ -448,64 +431,31 @@ int Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::general_work (int noutput_items, gr_vecto
              * \todo Improve the lock detection algorithm!
              */
             // ####### CN0 ESTIMATION AND LOCK DETECTORS ######
-            if (d_cn0_estimation_counter < CN0_ESTIMATION_SAMPLES)
+            if (d_lock_detector.update(*d_Prompt, d_fs_in))
                 {
-                    // fill buffer with prompt correlator output values
-                    d_Prompt_buffer[d_cn0_estimation_counter] = *d_Prompt;
-                    d_cn0_estimation_counter++;
-                }
-            else
-                {
-                    d_cn0_estimation_counter = 0;
-                    //d_CN0_SNV_dB_Hz = gps_l1_ca_CN0_SNV(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES, d_fs_in);
-                    d_CN0_SNV_dB_Hz = cn0_svn_estimator(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES, d_fs_in, GPS_L1_CA_CODE_LENGTH_CHIPS);
-
-                    d_carrier_lock_test = carrier_lock_detector(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES);
-                    // ###### TRACKING UNLOCK NOTIFICATION #####
-                    if (d_carrier_lock_test < d_carrier_lock_threshold or d_CN0_SNV_dB_Hz < MINIMUM_VALID_CN0)
+                    Receiver_Status_Bus::instance().post(STATUS_LOSS_OF_LOCK, d_channel, d_acquisition_gnss_synchro->System, d_acquisition_gnss_synchro->PRN, 0.0);
+                    ControlMessageFactory* cmf = new ControlMessageFactory();
+                    if (d_queue != gr::msg_queue::sptr())
                         {
-                            d_carrier_lock_fail_counter++;
-                        }
-                    else
-                        {
-                            if (d_carrier_lock_fail_counter > 0) d_carrier_lock_fail_counter--;
-                        }
-                    if (d_carrier_lock_fail_counter > MAXIMUM_LOCK_FAIL_COUNTER)
-                        {
-                            std::cout << "Loss of lock in channel " << d_channel << "!" << std::endl;
-                            LOG(INFO) << "Loss of lock in channel " << d_channel << "!";
-                            ControlMessageFactory* cmf = new ControlMessageFactory();
-                            if (d_queue != gr::msg_queue::sptr())
-                                {
-                                    d_queue->handle(cmf->GetQueueMessage(d_channel, 2));
-                                }
-                            delete cmf;
-                            d_carrier_lock_fail_counter = 0;
-                            d_enable_tracking = false; // TODO: check if disabling tracking is consistent with the channel state machine
+                            d_queue->handle(cmf->GetQueueMessage(d_channel, 2));
                         }
+                    delete cmf;
+                    d_enable_tracking = false; // TODO: check if disabling tracking is consistent with the channel state machine
                 }
 
-            // ########## DEBUG OUTPUT
+            // ########## STATUS EVENTS (reported by the Receiver_Status_Bus thread, no console I/O here)
             /*!
              *  \todo The stop timer has to be moved to the signal source!
              */
-            // debug: Second counter in channel 0
-            if (d_channel == 0)
-                {
-                    if (floor(d_sample_counter/d_fs_in) != d_last_seg)
-                        {
-                            d_last_seg = floor(d_sample_counter/d_fs_in);
-                            std::cout << "Current input signal time = " << d_last_seg << " [s]" << std::endl;
-                            LOG(INFO) << "Tracking CH " << d_channel <<  ": Satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN)  << ", CN0 = " << d_CN0_SNV_dB_Hz << " [dB-Hz]";
-                        }
-                }
-            else
+            if (floor(d_sample_counter / d_fs_in) != d_last_seg)
                 {
-                    if (floor(d_sample_counter/d_fs_in) != d_last_seg)
+                    d_last_seg = floor(d_sample_counter / d_fs_in);
+                    if (d_channel == 0)
                         {
-                            d_last_seg = floor(d_sample_counter/d_fs_in);
-                            LOG(INFO) << "Tracking CH " << d_channel <<  ": Satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN)  << ", CN0 = " << d_CN0_SNV_dB_Hz << " [dB-Hz]";
+                            // Second counter in channel 0
+                            Receiver_Status_Bus::instance().post(STATUS_SIGNAL_TIME, d_channel, d_acquisition_gnss_synchro->System, d_acquisition_gnss_synchro->PRN, (double)d_last_seg);
                         }
+                    Receiver_Status_Bus::instance().post(STATUS_CN0_UPDATE, d_channel, d_acquisition_gnss_synchro->System, d_acquisition_gnss_synchro->PRN, (double)d_lock_detector.cn0_db_hz());
                 }
 
             //predict the next loop PRN period length prediction
@@ -534,29 +484,22 @@ int Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::general_work (int noutput_items, gr_vecto
             current_synchro_data.Code_phase_secs = 0;
             current_synchro_data.Carrier_phase_rads = d_acc_carrier_phase_rad;
             current_synchro_data.Carrier_Doppler_hz = d_carrier_doppler_hz;
-            current_synchro_data.CN0_dB_hz = d_CN0_SNV_dB_Hz;
+            current_synchro_data.CN0_dB_hz = d_lock_detector.cn0_db_hz();
             current_synchro_data.Flag_valid_tracking = true;
             *out[0] = current_synchro_data;
         }
     else
         {
-			// ########## DEBUG OUTPUT (TIME ONLY for channel 0 when tracking is disabled)
-			/*!
-			 *  \todo The stop timer has to be moved to the signal source!
-			 */
-			// stream to collect cout calls to improve thread safety
-			std::stringstream tmp_str_stream;
-			if (floor(d_sample_counter / d_fs_in) != d_last_seg)
-			{
-				d_last_seg = floor(d_sample_counter / d_fs_in);
-
-				if (d_channel == 0)
-				{
-					// debug: Second counter in channel 0
-					tmp_str_stream << "Current input signal time = " << d_last_seg << " [s]" << std::endl << std::flush;
-					std::cout << tmp_str_stream.rdbuf() << std::flush;
-				}
-			}
+            // ########## STATUS EVENTS (TIME ONLY for channel 0 when tracking is disabled)
+            if (floor(d_sample_counter / d_fs_in) != d_last_seg)
+                {
+                    d_last_seg = floor(d_sample_counter / d_fs_in);
+                    if (d_channel == 0)
+                        {
+                            // Second counter in channel 0
+                            Receiver_Status_Bus::instance().post(STATUS_SIGNAL_TIME, d_channel, d_acquisition_gnss_synchro->System, d_acquisition_gnss_synchro->PRN, (double)d_last_seg);
+                        }
+                }
             *d_Early  = gr_complex(0,0);
             *d_Prompt = gr_complex(0,0);
             *d_Late   = gr_complex(0,0);
@@ -565,68 +508,37 @@ int Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::general_work (int noutput_items, gr_vecto
         }
 
 
-    if(d_dump)
+    if(d_dump_stream)
         {
-            // MULTIPLEXED FILE RECORDING - Record results to file
-            float prompt_I;
-            float prompt_Q;
-            float tmp_E, tmp_P, tmp_L;
-            float tmp_float;
-            double tmp_double;
-            prompt_I = (*d_Prompt).real();
-            prompt_Q = (*d_Prompt).imag();
-            tmp_E = std::abs<float>(*d_Early);
-            tmp_P = std::abs<float>(*d_Prompt);
-            tmp_L = std::abs<float>(*d_Late);
-            try
-            {
-                    // EPR
-                    d_dump_file.write((char*)&tmp_E, sizeof(float));
-                    d_dump_file.write((char*)&tmp_P, sizeof(float));
-                    d_dump_file.write((char*)&tmp_L, sizeof(float));
-                    // PROMPT I and Q (to analyze navigation symbols)
-                    d_dump_file.write((char*)&prompt_I, sizeof(float));
-                    d_dump_file.write((char*)&prompt_Q, sizeof(float));
-                    // PRN start sample stamp
-                    d_dump_file.write((char*)&d_sample_counter, sizeof(unsigned long int));
-                    // accumulated carrier phase
-                    tmp_float = (float)d_acc_carrier_phase_rad;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-
-                    // carrier and code frequency
-                    tmp_float = (float)d_carrier_doppler_hz;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    tmp_float = (float)d_code_freq_hz;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-
-                    //PLL commands
-                    tmp_float = (float)PLL_discriminator_hz;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    tmp_float = (float)carr_nco_hz;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-
-                    //DLL commands
-                    tmp_float = (float)code_error_chips;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    tmp_float = (float)code_error_filt_chips;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-
-                    // CN0 and carrier lock test
-                    tmp_float = (float)d_CN0_SNV_dB_Hz;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    tmp_float = (float)d_carrier_lock_test;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-
-                    // AUX vars (for debug purposes)
-                    tmp_float = (float)d_rem_code_phase_samples;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    tmp_double = (double)(d_sample_counter + d_current_prn_length_samples);
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-            }
-            catch (std::ifstream::failure e)
-            {
-                    LOG(INFO) << "Exception writing trk dump file "<< e.what() << std::endl;
-            }
+            // MULTIPLEXED FILE RECORDING - Record results to file (written asynchronously by the Dump_Writer thread)
+            Tracking_Dump_Record_EPL record;
+            // EPR
+            record.abs_E = std::abs<float>(*d_Early);
+            record.abs_P = std::abs<float>(*d_Prompt);
+            record.abs_L = std::abs<float>(*d_Late);
+            // PROMPT I and Q (to analyze navigation symbols)
+            record.prompt_I = (*d_Prompt).real();
+            record.prompt_Q = (*d_Prompt).imag();
+            // PRN start sample stamp
+            record.loop.PRN_start_sample = d_sample_counter;
+            // accumulated carrier phase
+            record.loop.acc_carrier_phase_rad = (float)d_acc_carrier_phase_rad;
+            // carrier and code frequency
+            record.loop.carrier_doppler_hz = (float)d_carrier_doppler_hz;
+            record.loop.code_freq_hz = (float)d_code_freq_hz;
+            // PLL commands
+            record.loop.carr_error = (float)PLL_discriminator_hz;
+            record.loop.carr_nco = (float)carr_nco_hz;
+            // DLL commands
+            record.loop.code_error = (float)code_error_chips;
+            record.loop.code_nco = (float)code_error_filt_chips;
+            // CN0 and carrier lock test
+            record.loop.CN0_SNV_dB_Hz = (float)d_lock_detector.cn0_db_hz();
+            record.loop.carrier_lock_test = (float)d_lock_detector.carrier_lock_test();
+            // AUX vars (for debug purposes)
+            record.loop.rem_code_phase_samples = (float)d_rem_code_phase_samples;
+            record.loop.next_PRN_start_sample = (double)(d_sample_counter + d_current_prn_length_samples);
+            d_dump_stream->push_record(record);
         }
     consume_each(d_current_prn_length_samples); // this is necessary in gr::block derivates
     d_sample_counter += d_current_prn_length_samples; //count for the processed samples
@@ -641,20 +553,19 @@ void Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc::set_channel(unsigned int channel)
     // ############# ENABLE DATA FILE LOG #################
     if (d_dump == true)
         {
-            if (d_dump_file.is_open() == false)
+            if (!d_dump_stream)
                 {
-                    try
-                    {
-                            d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
-                            d_dump_filename.append(".dat");
-                            d_dump_file.exceptions ( std::ifstream::failbit | std::ifstream::badbit );
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
+                    d_dump_filename.append(".dat");
+                    d_dump_stream = Dump_Writer::instance().open_stream(d_dump_filename, sizeof(Tracking_Dump_Record_EPL));
+                    if (d_dump_stream)
+                        {
                             LOG(INFO) << "Tracking dump enabled on channel " << d_channel << " Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (std::ifstream::failure e)
-                    {
-                            LOG(WARNING) << "channel " << d_channel << " Exception opening trk dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "channel " << d_channel << " Error opening trk dump file " << d_dump_filename.c_str();
+                        }
                 }
         }
 }
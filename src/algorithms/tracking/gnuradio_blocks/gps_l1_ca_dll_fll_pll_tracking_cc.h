@@ -51,6 +51,9 @@
 #include "tracking_2nd_DLL_filter.h"
 #include "gnss_synchro.h"
 #include "correlator.h"
+#include "dump_writer.h"
+#include "tracking_dump_record.h"
+#include "tracking_loop_core.h"
 
 class Gps_L1_Ca_Dll_Fll_Pll_Tracking_cc;
 
@@ -189,19 +192,12 @@ private:
     unsigned long int d_acq_sample_stamp;
 
     // CN0 estimation and lock detector
-    int d_cn0_estimation_counter;
-    gr_complex* d_Prompt_buffer;
-    double d_carrier_lock_test;
-    double d_CN0_SNV_dB_Hz;
-
-    double d_carrier_lock_threshold;
-
-    int d_carrier_lock_fail_counter;
+    Tracking_Lock_Detector<Gps_L1_Ca_Tracking_Signal> d_lock_detector;
 
     bool d_enable_tracking;
 
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    boost::shared_ptr<Dump_Stream> d_dump_stream;
 
     std::map<std::string, std::string> systemName;
     std::string sys;
@@ -42,22 +42,13 @@
 #include <glog/logging.h>
 #include "gnss_synchro.h"
 #include "gps_sdr_signal_processing.h"
-#include "tracking_discriminators.h"
-#include "lock_detectors.h"
 #include "GPS_L1_CA.h"
 #include "nco_lib.h"
 #include "control_message_factory.h"
+#include "receiver_status_bus.h"
 
 
 
-/*!
- * \todo Include in definition header file
- */
-#define CN0_ESTIMATION_SAMPLES 20
-#define MINIMUM_VALID_CN0 25
-#define MAXIMUM_LOCK_FAIL_COUNTER 50
-#define CARRIER_LOCK_THRESHOLD 0.85
-
 using google::LogMessage;
 
 gps_l1_ca_dll_pll_optim_tracking_cc_sptr
@@ -110,8 +101,9 @@ Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc(
     d_dump_filename = dump_filename;
 
     // Initialize tracking  ==========================================
-    d_code_loop_filter.set_DLL_BW(dll_bw_hz);
-    d_carrier_loop_filter.set_PLL_BW(pll_bw_hz);
+    d_loop.set_dll_bw(dll_bw_hz);
+    d_loop.set_pll_bw(pll_bw_hz);
+    d_loop.set_sampling_frequency(d_fs_in);
 
     //--- DLL variables --------------------------------------------------------
     d_early_late_spc_chips = early_late_space_chips; // Define early-late offset (in chips)
@@ -138,13 +130,6 @@ Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc(
     if (posix_memalign((void**)&d_Late, 16, sizeof(gr_complex)) == 0){};
 
     //--- Perform initializations ------------------------------
-    // define initial code frequency basis of NCO
-    d_code_freq_chips = GPS_L1_CA_CODE_RATE_HZ;
-    // define residual code phase (in chips)
-    d_rem_code_phase_samples = 0.0;
-    // define residual carrier phase
-    d_rem_carr_phase_rad = 0.0;
-
     // sample synchronization
     d_sample_counter = 0;
     //d_sample_counter_seconds = 0;
@@ -154,15 +139,7 @@ Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc(
     d_pull_in = false;
     d_last_seg = 0;
 
-    d_current_prn_length_samples = (int)d_vector_length;
-
-    // CN0 estimation and lock detector buffers
-    d_cn0_estimation_counter = 0;
-    d_Prompt_buffer = new gr_complex[CN0_ESTIMATION_SAMPLES];
-    d_carrier_lock_test = 1;
-    d_CN0_SNV_dB_Hz = 0;
-    d_carrier_lock_fail_counter = 0;
-    d_carrier_lock_threshold = CARRIER_LOCK_THRESHOLD;
+    d_loop.state().current_prn_length_samples = (int)d_vector_length;
 
     systemName["G"] = std::string("GPS");
     systemName["R"] = std::string("GLONASS");
@@ -192,11 +169,11 @@ void Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::start_tracking()
     float T_chip_mod_seconds;
     float T_prn_mod_seconds;
     float T_prn_mod_samples;
-    d_code_freq_chips = radial_velocity * GPS_L1_CA_CODE_RATE_HZ;
-    T_chip_mod_seconds = 1/d_code_freq_chips;
+    d_loop.state().code_freq_chips = radial_velocity * GPS_L1_CA_CODE_RATE_HZ;
+    T_chip_mod_seconds = 1/d_loop.state().code_freq_chips;
     T_prn_mod_seconds = T_chip_mod_seconds * GPS_L1_CA_CODE_LENGTH_CHIPS;
     T_prn_mod_samples = T_prn_mod_seconds * (float)d_fs_in;
-    d_current_prn_length_samples = round(T_prn_mod_samples);
+    d_loop.state().current_prn_length_samples = round(T_prn_mod_samples);
 
     float T_prn_true_seconds = GPS_L1_CA_CODE_LENGTH_CHIPS / GPS_L1_CA_CODE_RATE_HZ;
     float T_prn_true_samples = T_prn_true_seconds * (float)d_fs_in;
@@ -212,11 +189,9 @@ void Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::start_tracking()
         }
     delay_correction_samples = d_acq_code_phase_samples - corrected_acq_phase_samples;
     d_acq_code_phase_samples = corrected_acq_phase_samples;
-    d_carrier_doppler_hz = d_acq_carrier_doppler_hz;
 
-    // DLL/PLL filter initialization
-    d_carrier_loop_filter.initialize(); //initialize the carrier filter
-    d_code_loop_filter.initialize();    //initialize the code filter
+    // DLL/PLL loop initialization (loop filters, NCOs and phase accumulators)
+    d_loop.reset(d_acq_carrier_doppler_hz, d_loop.state().current_prn_length_samples);
 
     // generate local reference ALWAYS starting at chip 1 (1 sample per chip)
     gps_l1_ca_code_gen_complex(&d_ca_code[1], d_acquisition_gnss_synchro->PRN, 0);
@@ -234,12 +209,12 @@ void Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::start_tracking()
     int epl_loop_length_samples;
 
     // unified loop for E, P, L code vectors
-    code_phase_step_chips = ((double)d_code_freq_chips) / ((double)d_fs_in);
+    code_phase_step_chips = ((double)d_loop.state().code_freq_chips) / ((double)d_fs_in);
     tcode_chips = 0;
 
     // Alternative EPL code generation (40% of speed improvement!)
     early_late_spc_samples = round(d_early_late_spc_chips / code_phase_step_chips);
-    epl_loop_length_samples = d_current_prn_length_samples  +early_late_spc_samples*2;
+    epl_loop_length_samples = d_loop.state().current_prn_length_samples  +early_late_spc_samples*2;
     for (int i = 0; i < epl_loop_length_samples; i++)
         {
             associated_chip_index = 1 + round(fmod(tcode_chips - d_early_late_spc_chips, code_length_chips));
@@ -247,14 +222,11 @@ void Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::start_tracking()
             tcode_chips = tcode_chips + code_phase_step_chips;
         }
 
-    memcpy(d_prompt_code, &d_early_code[early_late_spc_samples], d_current_prn_length_samples* sizeof(gr_complex));
-    memcpy(d_late_code, &d_early_code[early_late_spc_samples*2], d_current_prn_length_samples* sizeof(gr_complex));
+    memcpy(d_prompt_code, &d_early_code[early_late_spc_samples], d_loop.state().current_prn_length_samples* sizeof(gr_complex));
+    memcpy(d_late_code, &d_early_code[early_late_spc_samples*2], d_loop.state().current_prn_length_samples* sizeof(gr_complex));
     //******************************************************************************
 
-    d_carrier_lock_fail_counter = 0;
-    d_rem_code_phase_samples = 0;
-    d_rem_carr_phase_rad = 0;
-    d_acc_carrier_phase_rad = 0;
+    d_lock_detector.initialize();
 
     d_code_phase_samples = d_acq_code_phase_samples;
 
@@ -262,14 +234,13 @@ void Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::start_tracking()
     sys = sys_.substr(0,1);
 
     // DEBUG OUTPUT
-    std::cout << "Tracking start on channel " << d_channel << " for satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN) << std::endl;
-    LOG(INFO) << "Starting tracking of satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN) << " on channel " << d_channel;
+    Receiver_Status_Bus::instance().post(STATUS_TRACKING_START, d_channel, d_acquisition_gnss_synchro->System, d_acquisition_gnss_synchro->PRN, 0.0);
 
     // enable tracking
     d_pull_in = true;
     d_enable_tracking = true;
 
-    LOG(INFO) << "PULL-IN Doppler [Hz]=" << d_carrier_doppler_hz
+    LOG(INFO) << "PULL-IN Doppler [Hz]=" << d_loop.state().carrier_doppler_hz
               << " Code Phase correction [samples]=" << delay_correction_samples
               << " PULL-IN Code Phase [samples]=" << d_acq_code_phase_samples << std::endl;
 }
@@ -287,13 +258,13 @@ void Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::update_local_code()
     int epl_loop_length_samples;
 
     // unified loop for E, P, L code vectors
-    code_phase_step_chips = ((double)d_code_freq_chips) / ((double)d_fs_in);
-    rem_code_phase_chips = d_rem_code_phase_samples * (d_code_freq_chips / d_fs_in);
+    code_phase_step_chips = ((double)d_loop.state().code_freq_chips) / ((double)d_fs_in);
+    rem_code_phase_chips = d_loop.state().rem_code_phase_samples * (d_loop.state().code_freq_chips / d_fs_in);
     tcode_chips = -rem_code_phase_chips;
 
     //EPL code generation
     early_late_spc_samples = round(d_early_late_spc_chips / code_phase_step_chips);
-    epl_loop_length_samples = d_current_prn_length_samples + early_late_spc_samples*2;
+    epl_loop_length_samples = d_loop.state().current_prn_length_samples + early_late_spc_samples*2;
     for (int i = 0; i < epl_loop_length_samples; i++)
         {
             associated_chip_index = 1 + round(fmod(tcode_chips - d_early_late_spc_chips, code_length_chips));
@@ -301,23 +272,23 @@ void Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::update_local_code()
             tcode_chips = tcode_chips + code_phase_step_chips;
         }
 
-    memcpy(d_prompt_code, &d_early_code[early_late_spc_samples], d_current_prn_length_samples* sizeof(gr_complex));
-    memcpy(d_late_code, &d_early_code[early_late_spc_samples*2], d_current_prn_length_samples* sizeof(gr_complex));
+    memcpy(d_prompt_code, &d_early_code[early_late_spc_samples], d_loop.state().current_prn_length_samples* sizeof(gr_complex));
+    memcpy(d_late_code, &d_early_code[early_late_spc_samples*2], d_loop.state().current_prn_length_samples* sizeof(gr_complex));
 }
 
 
 void Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::update_local_carrier()
 {
     float phase_step_rad;
-    phase_step_rad = (float)GPS_TWO_PI*d_carrier_doppler_hz / (float)d_fs_in;
-    fxp_nco(d_carr_sign, d_current_prn_length_samples, d_rem_carr_phase_rad, phase_step_rad);
-    //sse_nco(d_carr_sign, d_current_prn_length_samples,d_rem_carr_phase_rad, phase_step_rad);
+    phase_step_rad = (float)GPS_TWO_PI*d_loop.state().carrier_doppler_hz / (float)d_fs_in;
+    fxp_nco(d_carr_sign, d_loop.state().current_prn_length_samples, d_loop.state().rem_carr_phase_rad, phase_step_rad);
+    //sse_nco(d_carr_sign, d_loop.state().current_prn_length_samples,d_loop.state().rem_carr_phase_rad, phase_step_rad);
 }
 
 
 Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::~Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc()
 {
-    d_dump_file.close();
+    Dump_Writer::instance().close_stream(d_dump_stream);
 
     free(d_prompt_code);
     free(d_late_code);
@@ -328,7 +299,6 @@ Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::~Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc()
     free(d_Late);
 
     delete[] d_ca_code;
-    delete[] d_Prompt_buffer;
 }
 
 
@@ -337,11 +307,10 @@ int Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::general_work (int noutput_items, gr_vec
         gr_vector_const_void_star &input_items, gr_vector_void_star &output_items)
 {
     // stream to collect cout calls to improve thread safety
-    std::stringstream tmp_str_stream;
-    float carr_error_hz;
-    float carr_error_filt_hz;
-    float code_error_chips;
-    float code_error_filt_chips;
+    float carr_error_hz = 0.0;
+    float carr_error_filt_hz = 0.0;
+    float code_error_chips = 0.0;
+    float code_error_filt_chips = 0.0;
 
     if (d_enable_tracking == true)
         {
@@ -354,7 +323,7 @@ int Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::general_work (int noutput_items, gr_vec
                     float acq_trk_shif_correction_samples;
                     int acq_to_trk_delay_samples;
                     acq_to_trk_delay_samples = d_sample_counter - d_acq_sample_stamp;
-                    acq_trk_shif_correction_samples = d_current_prn_length_samples - fmod((float)acq_to_trk_delay_samples, (float)d_current_prn_length_samples);
+                    acq_trk_shif_correction_samples = d_loop.state().current_prn_length_samples - fmod((float)acq_to_trk_delay_samples, (float)d_loop.state().current_prn_length_samples);
                     samples_offset = round(d_acq_code_phase_samples + acq_trk_shif_correction_samples);
                     d_sample_counter = d_sample_counter + samples_offset; //count for the processed samples
                     d_pull_in = false;
@@ -375,7 +344,7 @@ int Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::general_work (int noutput_items, gr_vec
             update_local_carrier();
 
             // perform Early, Prompt and Late correlation
-            d_correlator.Carrier_wipeoff_and_EPL_volk_custom(d_current_prn_length_samples,
+            d_correlator.Carrier_wipeoff_and_EPL_volk_custom(d_loop.state().current_prn_length_samples,
                     in,
                     d_carr_sign,
                     d_early_code,
@@ -386,137 +355,70 @@ int Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::general_work (int noutput_items, gr_vec
                     d_Late,
                     is_unaligned());
 
-            // ################## PLL ##########################################################
-            // PLL discriminator
-            carr_error_hz = pll_cloop_two_quadrant_atan(*d_Prompt) / (float)GPS_TWO_PI;
-            // Carrier discriminator filter
-            carr_error_filt_hz = d_carrier_loop_filter.get_carrier_nco(carr_error_hz);
-            // New carrier Doppler frequency estimation
-            d_carrier_doppler_hz = d_acq_carrier_doppler_hz + carr_error_filt_hz;
-            // New code Doppler frequency estimation
-            d_code_freq_chips = GPS_L1_CA_CODE_RATE_HZ + ((d_carrier_doppler_hz * GPS_L1_CA_CODE_RATE_HZ) / GPS_L1_FREQ_HZ);
-            //carrier phase accumulator for (K) doppler estimation
-            d_acc_carrier_phase_rad = d_acc_carrier_phase_rad + GPS_TWO_PI*d_carrier_doppler_hz*GPS_L1_CA_CODE_PERIOD;
-            //remnant carrier phase to prevent overflow in the code NCO
-            d_rem_carr_phase_rad = d_rem_carr_phase_rad + GPS_TWO_PI*d_carrier_doppler_hz*GPS_L1_CA_CODE_PERIOD;
-            d_rem_carr_phase_rad = fmod(d_rem_carr_phase_rad, GPS_TWO_PI);
-
-            // ################## DLL ##########################################################
-            // DLL discriminator
-            code_error_chips = dll_nc_e_minus_l_normalized(*d_Early, *d_Late); //[chips/Ti]
-            // Code discriminator filter
-            code_error_filt_chips = d_code_loop_filter.get_code_nco(code_error_chips); //[chips/second]
-            //Code phase accumulator
-            float code_error_filt_secs;
-            code_error_filt_secs = (GPS_L1_CA_CODE_PERIOD*code_error_filt_chips) / GPS_L1_CA_CODE_RATE_HZ; //[seconds]
-            d_acc_code_phase_secs = d_acc_code_phase_secs + code_error_filt_secs;
-
-            // ################## CARRIER AND CODE NCO BUFFER ALIGNEMENT #######################
-            // keep alignment parameters for the next input buffer
-            float T_chip_seconds;
-            float T_prn_seconds;
-            float T_prn_samples;
-            float K_blk_samples;
-            // Compute the next buffer lenght based in the new period of the PRN sequence and the code phase error estimation
-            T_chip_seconds = 1 / d_code_freq_chips;
-            T_prn_seconds = T_chip_seconds * GPS_L1_CA_CODE_LENGTH_CHIPS;
-            T_prn_samples = T_prn_seconds * (float)d_fs_in;
-            K_blk_samples = T_prn_samples + d_rem_code_phase_samples + code_error_filt_secs*(float)d_fs_in;
-            d_current_prn_length_samples = round(K_blk_samples); //round to a discrete samples
-            d_rem_code_phase_samples = K_blk_samples - d_current_prn_length_samples; //rounding error < 1 sample
+            // ################## PLL, DLL AND NCO UPDATE #####################################
+            // discriminators, loop filters, new carrier and code frequencies and next PRN block length
+            Tracking_Correlator_Outputs correlator_outputs;
+            correlator_outputs.early = *d_Early;
+            correlator_outputs.prompt = *d_Prompt;
+            correlator_outputs.late = *d_Late;
+            d_loop.update(correlator_outputs);
+            carr_error_hz = d_loop.state().carr_error_hz;
+            carr_error_filt_hz = d_loop.state().carr_error_filt_hz;
+            code_error_chips = d_loop.state().code_error_chips;
+            code_error_filt_chips = d_loop.state().code_error_filt_chips;
 
             // ####### CN0 ESTIMATION AND LOCK DETECTORS ######
-            if (d_cn0_estimation_counter < CN0_ESTIMATION_SAMPLES)
-                {
-                    // fill buffer with prompt correlator output values
-                    d_Prompt_buffer[d_cn0_estimation_counter] = *d_Prompt;
-                    d_cn0_estimation_counter++;
-                }
-            else
+            if (d_lock_detector.update(*d_Prompt, d_fs_in))
                 {
-                    d_cn0_estimation_counter = 0;
-                    // Code lock indicator
-                    d_CN0_SNV_dB_Hz = cn0_svn_estimator(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES, d_fs_in, GPS_L1_CA_CODE_LENGTH_CHIPS);
-                    // Carrier lock indicator
-                    d_carrier_lock_test = carrier_lock_detector(d_Prompt_buffer, CN0_ESTIMATION_SAMPLES);
-                    // Loss of lock detection
-                    if (d_carrier_lock_test < d_carrier_lock_threshold or d_CN0_SNV_dB_Hz < MINIMUM_VALID_CN0)
+                    Receiver_Status_Bus::instance().post(STATUS_LOSS_OF_LOCK, d_channel, d_acquisition_gnss_synchro->System, d_acquisition_gnss_synchro->PRN, 0.0);
+                    ControlMessageFactory* cmf = new ControlMessageFactory();
+                    if (d_queue != gr::msg_queue::sptr())
                         {
-                            d_carrier_lock_fail_counter++;
-                        }
-                    else
-                        {
-                            if (d_carrier_lock_fail_counter > 0) d_carrier_lock_fail_counter--;
-                        }
-                    if (d_carrier_lock_fail_counter > MAXIMUM_LOCK_FAIL_COUNTER)
-                        {
-                            std::cout << "Loss of lock in channel " << d_channel << "!" << std::endl;
-                            LOG(INFO) << "Loss of lock in channel " << d_channel << "!";
-                            ControlMessageFactory* cmf = new ControlMessageFactory();
-                            if (d_queue != gr::msg_queue::sptr())
-                                {
-                                    d_queue->handle(cmf->GetQueueMessage(d_channel, 2));
-                                }
-                            delete cmf;
-                            d_carrier_lock_fail_counter = 0;
-                            d_enable_tracking = false; // TODO: check if disabling tracking is consistent with the channel state machine
+                            d_queue->handle(cmf->GetQueueMessage(d_channel, 2));
                         }
+                    delete cmf;
+                    d_enable_tracking = false; // TODO: check if disabling tracking is consistent with the channel state machine
                 }
             // ########### Output the tracking data to navigation and PVT ##########
             current_synchro_data.Prompt_I = (double)(*d_Prompt).real();
             current_synchro_data.Prompt_Q = (double)(*d_Prompt).imag();
             // Tracking_timestamp_secs is aligned with the PRN start sample
-            current_synchro_data.Tracking_timestamp_secs = ((double)d_sample_counter + (double)d_current_prn_length_samples + (double)d_rem_code_phase_samples) / (double)d_fs_in;
+            current_synchro_data.Tracking_timestamp_secs = ((double)d_sample_counter + (double)d_loop.state().current_prn_length_samples + (double)d_loop.state().rem_code_phase_samples) / (double)d_fs_in;
             // This tracking block aligns the Tracking_timestamp_secs with the start sample of the PRN, thus, Code_phase_secs=0
             current_synchro_data.Code_phase_secs = 0;
-            current_synchro_data.Carrier_phase_rads = (double)d_acc_carrier_phase_rad;
-            current_synchro_data.Carrier_Doppler_hz = (double)d_carrier_doppler_hz;
-            current_synchro_data.CN0_dB_hz = (double)d_CN0_SNV_dB_Hz;
+            current_synchro_data.Carrier_phase_rads = (double)d_loop.state().acc_carrier_phase_rad;
+            current_synchro_data.Carrier_Doppler_hz = (double)d_loop.state().carrier_doppler_hz;
+            current_synchro_data.CN0_dB_hz = (double)d_lock_detector.cn0_db_hz();
             *out[0] = current_synchro_data;
 
-            // ########## DEBUG OUTPUT
+            // ########## STATUS EVENTS (reported by the Receiver_Status_Bus thread, no console I/O here)
             /*!
              *  \todo The stop timer has to be moved to the signal source!
              */
             if (floor(d_sample_counter / d_fs_in) != d_last_seg)
                 {
                     d_last_seg = floor(d_sample_counter / d_fs_in);
-
                     if (d_channel == 0)
                         {
-                            // debug: Second counter in channel 0
-                            tmp_str_stream << "Current input signal time = " << d_last_seg << " [s]" << std::endl;
-                            std::cout << tmp_str_stream.rdbuf();
-                            LOG(INFO) << tmp_str_stream.rdbuf();
+                            // Second counter in channel 0
+                            Receiver_Status_Bus::instance().post(STATUS_SIGNAL_TIME, d_channel, d_acquisition_gnss_synchro->System, d_acquisition_gnss_synchro->PRN, (double)d_last_seg);
                         }
-
-                    tmp_str_stream << "Tracking CH " << d_channel <<  ": Satellite " << Gnss_Satellite(systemName[sys], d_acquisition_gnss_synchro->PRN)
-                                   << ", Doppler=" << d_carrier_doppler_hz << " [Hz] CN0 = " << d_CN0_SNV_dB_Hz << " [dB-Hz]" << std::endl;
-                    //std::cout << tmp_str_stream.rdbuf() << std::flush;
-                    LOG(INFO) << tmp_str_stream.rdbuf();
-                    //if (d_channel == 0 || d_last_seg==5) d_carrier_lock_fail_counter=500; //DEBUG: force unlock!
+                    Receiver_Status_Bus::instance().post(STATUS_CN0_UPDATE, d_channel, d_acquisition_gnss_synchro->System, d_acquisition_gnss_synchro->PRN, (double)d_lock_detector.cn0_db_hz());
                 }
         }
     else
         {
 
-			// ########## DEBUG OUTPUT (TIME ONLY for channel 0 when tracking is disabled)
-			/*!
-			 *  \todo The stop timer has to be moved to the signal source!
-			 */
-			// stream to collect cout calls to improve thread safety
-			std::stringstream tmp_str_stream;
-			if (floor(d_sample_counter / d_fs_in) != d_last_seg)
-			{
-				d_last_seg = floor(d_sample_counter / d_fs_in);
-
-				if (d_channel == 0)
-				{
-					// debug: Second counter in channel 0
-					tmp_str_stream << "Current input signal time = " << d_last_seg << " [s]" << std::endl << std::flush;
-					std::cout << tmp_str_stream.rdbuf() << std::flush;
-				}
-			}
+            // ########## STATUS EVENTS (TIME ONLY for channel 0 when tracking is disabled)
+            if (floor(d_sample_counter / d_fs_in) != d_last_seg)
+                {
+                    d_last_seg = floor(d_sample_counter / d_fs_in);
+                    if (d_channel == 0)
+                        {
+                            // Second counter in channel 0
+                            Receiver_Status_Bus::instance().post(STATUS_SIGNAL_TIME, d_channel, d_acquisition_gnss_synchro->System, d_acquisition_gnss_synchro->PRN, (double)d_last_seg);
+                        }
+                }
             *d_Early = gr_complex(0,0);
             *d_Prompt = gr_complex(0,0);
             *d_Late = gr_complex(0,0);
@@ -525,64 +427,41 @@ int Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::general_work (int noutput_items, gr_vec
             *out[0] = *d_acquisition_gnss_synchro;
         }
 
-    if(d_dump)
+    if(d_dump_stream)
         {
-            // MULTIPLEXED FILE RECORDING - Record results to file
-            float prompt_I;
-            float prompt_Q;
-            float tmp_E, tmp_P, tmp_L;
-            float tmp_float;
-            double tmp_double;
-            prompt_I = (*d_Prompt).real();
-            prompt_Q = (*d_Prompt).imag();
-            tmp_E = std::abs<float>(*d_Early);
-            tmp_P = std::abs<float>(*d_Prompt);
-            tmp_L = std::abs<float>(*d_Late);
-            try
-            {
-                    // EPR
-                    d_dump_file.write((char*)&tmp_E, sizeof(float));
-                    d_dump_file.write((char*)&tmp_P, sizeof(float));
-                    d_dump_file.write((char*)&tmp_L, sizeof(float));
-                    // PROMPT I and Q (to analyze navigation symbols)
-                    d_dump_file.write((char*)&prompt_I, sizeof(float));
-                    d_dump_file.write((char*)&prompt_Q, sizeof(float));
-                    // PRN start sample stamp
-                    //tmp_float=(float)d_sample_counter;
-                    d_dump_file.write((char*)&d_sample_counter, sizeof(unsigned long int));
-                    // accumulated carrier phase
-                    d_dump_file.write((char*)&d_acc_carrier_phase_rad, sizeof(float));
-
-                    // carrier and code frequency
-                    d_dump_file.write((char*)&d_carrier_doppler_hz, sizeof(float));
-                    d_dump_file.write((char*)&d_code_freq_chips, sizeof(float));
-
-                    //PLL commands
-                    d_dump_file.write((char*)&carr_error_hz, sizeof(float));
-                    d_dump_file.write((char*)&carr_error_filt_hz, sizeof(float));
-
-                    //DLL commands
-                    d_dump_file.write((char*)&code_error_chips, sizeof(float));
-                    d_dump_file.write((char*)&code_error_filt_chips, sizeof(float));
-
-                    // CN0 and carrier lock test
-                    d_dump_file.write((char*)&d_CN0_SNV_dB_Hz, sizeof(float));
-                    d_dump_file.write((char*)&d_carrier_lock_test, sizeof(float));
-
-                    // AUX vars (for debug purposes)
-                    tmp_float = d_rem_code_phase_samples;
-                    d_dump_file.write((char*)&tmp_float, sizeof(float));
-                    tmp_double = (double)(d_sample_counter + d_current_prn_length_samples);
-                    d_dump_file.write((char*)&tmp_double, sizeof(double));
-            }
-            catch (std::ifstream::failure& e)
-            {
-                    LOG(WARNING) << "Exception writing trk dump file " << e.what();
-            }
+            // MULTIPLEXED FILE RECORDING - Record results to file (written asynchronously by the Dump_Writer thread)
+            Tracking_Dump_Record_EPL record;
+            // EPR
+            record.abs_E = std::abs<float>(*d_Early);
+            record.abs_P = std::abs<float>(*d_Prompt);
+            record.abs_L = std::abs<float>(*d_Late);
+            // PROMPT I and Q (to analyze navigation symbols)
+            record.prompt_I = (*d_Prompt).real();
+            record.prompt_Q = (*d_Prompt).imag();
+            // PRN start sample stamp
+            record.loop.PRN_start_sample = d_sample_counter;
+            // accumulated carrier phase
+            record.loop.acc_carrier_phase_rad = d_loop.state().acc_carrier_phase_rad;
+            // carrier and code frequency
+            record.loop.carrier_doppler_hz = d_loop.state().carrier_doppler_hz;
+            record.loop.code_freq_hz = d_loop.state().code_freq_chips;
+            // PLL commands
+            record.loop.carr_error = carr_error_hz;
+            record.loop.carr_nco = carr_error_filt_hz;
+            // DLL commands
+            record.loop.code_error = code_error_chips;
+            record.loop.code_nco = code_error_filt_chips;
+            // CN0 and carrier lock test
+            record.loop.CN0_SNV_dB_Hz = d_lock_detector.cn0_db_hz();
+            record.loop.carrier_lock_test = d_lock_detector.carrier_lock_test();
+            // AUX vars (for debug purposes)
+            record.loop.rem_code_phase_samples = d_loop.state().rem_code_phase_samples;
+            record.loop.next_PRN_start_sample = (double)(d_sample_counter + d_loop.state().current_prn_length_samples);
+            d_dump_stream->push_record(record);
         }
 
-    consume_each(d_current_prn_length_samples); // this is necesary in gr_block derivates
-    d_sample_counter += d_current_prn_length_samples; //count for the processed samples
+    consume_each(d_loop.state().current_prn_length_samples); // this is necesary in gr_block derivates
+    d_sample_counter += d_loop.state().current_prn_length_samples; //count for the processed samples
     return 1; //output tracking result ALWAYS even in the case of d_enable_tracking==false
 }
 
@@ -595,20 +474,19 @@ void Gps_L1_Ca_Dll_Pll_Optim_Tracking_cc::set_channel(unsigned int channel)
     // ############# ENABLE DATA FILE LOG #################
     if (d_dump == true)
         {
-            if (d_dump_file.is_open() == false)
+            if (!d_dump_stream)
                 {
-                    try
-                    {
-                            d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
-                            d_dump_filename.append(".dat");
-                            d_dump_file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-                            d_dump_file.open(d_dump_filename.c_str(), std::ios::out | std::ios::binary);
+                    d_dump_filename.append(boost::lexical_cast<std::string>(d_channel));
+                    d_dump_filename.append(".dat");
+                    d_dump_stream = Dump_Writer::instance().open_stream(d_dump_filename, sizeof(Tracking_Dump_Record_EPL));
+                    if (d_dump_stream)
+                        {
                             LOG(INFO) << "Tracking dump enabled on channel " << d_channel << " Log file: " << d_dump_filename.c_str();
-                    }
-                    catch (std::ifstream::failure& e)
-                    {
-                            LOG(WARNING) << "channel " << d_channel << " Exception opening trk dump file " << e.what();
-                    }
+                        }
+                    else
+                        {
+                            LOG(WARNING) << "channel " << d_channel << " Error opening trk dump file " << d_dump_filename.c_str();
+                        }
                 }
         }
 }
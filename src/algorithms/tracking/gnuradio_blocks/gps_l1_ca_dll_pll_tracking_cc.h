@@ -48,9 +48,10 @@
 #include "concurrent_queue.h"
 #include "gps_sdr_signal_processing.h"
 #include "gnss_synchro.h"
-#include "tracking_2nd_DLL_filter.h"
-#include "tracking_2nd_PLL_filter.h"
 #include "correlator.h"
+#include "dump_writer.h"
+#include "tracking_dump_record.h"
+#include "tracking_loop_core.h"
 
 class Gps_L1_Ca_Dll_Pll_Tracking_cc;
 
@@ -137,13 +138,8 @@ private:
     gr_complex *d_Prompt;
     gr_complex *d_Late;
 
-    // remaining code phase and carrier phase between tracking loops
-    float d_rem_code_phase_samples;
-    float d_rem_carr_phase_rad;
-
-    // PLL and DLL filter library
-    Tracking_2nd_DLL_filter d_code_loop_filter;
-    Tracking_2nd_PLL_filter d_carrier_loop_filter;
+    // DLL/PLL tracking loop: discriminators, loop filters and NCO state
+    Gps_L1_Ca_Dll_Pll_Loop d_loop;
 
     // acquisition
     float d_acq_code_phase_samples;
@@ -152,26 +148,14 @@ private:
     Correlator d_correlator;
 
     // tracking vars
-    float d_code_freq_chips;
-    float d_carrier_doppler_hz;
-    float d_acc_carrier_phase_rad;
     float d_code_phase_samples;
-    float d_acc_code_phase_secs;
-
-    //PRN period in samples
-    int d_current_prn_length_samples;
 
     //processing samples counters
     unsigned long int d_sample_counter;
     unsigned long int d_acq_sample_stamp;
 
     // CN0 estimation and lock detector
-    int d_cn0_estimation_counter;
-    gr_complex* d_Prompt_buffer;
-    float d_carrier_lock_test;
-    float d_CN0_SNV_dB_Hz;
-    float d_carrier_lock_threshold;
-    int d_carrier_lock_fail_counter;
+    Tracking_Lock_Detector<Gps_L1_Ca_Tracking_Signal> d_lock_detector;
 
     // control vars
     bool d_enable_tracking;
@@ -179,7 +163,7 @@ private:
 
     // file dump
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    boost::shared_ptr<Dump_Stream> d_dump_stream;
 
     std::map<std::string, std::string> systemName;
     std::string sys;
@@ -51,7 +51,11 @@
 #include "tracking_2nd_DLL_filter.h"
 #include "tracking_2nd_PLL_filter.h"
 #include "correlator.h"
+#include "dump_writer.h"
+#include "tracking_dump_record.h"
+#include "tracking_loop_core.h"
 #include "tcp_communication.h"
+#include "shm_communication.h"
 
 
 
@@ -69,7 +73,10 @@ gps_l1_ca_tcp_connector_make_tracking_cc(long if_freq,
                                    float pll_bw_hz,
                                    float dll_bw_hz,
                                    float early_late_space_chips,
-                                   size_t port_ch0);
+                                   size_t port_ch0,
+                                   bool use_shm,
+                                   std::string shm_name,
+                                   unsigned int shm_batch_size);
 
 
 /*!
@@ -105,7 +112,10 @@ private:
             float pll_bw_hz,
             float dll_bw_hz,
             float early_late_space_chips,
-            size_t port_ch0);
+            size_t port_ch0,
+            bool use_shm,
+            std::string shm_name,
+            unsigned int shm_batch_size);
 
     Gps_L1_Ca_Tcp_Connector_Tracking_cc(long if_freq,
             long fs_in, unsigned
@@ -116,7 +126,10 @@ private:
             float pll_bw_hz,
             float dll_bw_hz,
             float early_late_space_chips,
-            size_t port_ch0);
+            size_t port_ch0,
+            bool use_shm,
+            std::string shm_name,
+            unsigned int shm_batch_size);
     void update_local_code();
     void update_local_carrier();
 
@@ -172,6 +185,10 @@ private:
     int d_listen_connection;
     float d_control_id;
     tcp_communication d_tcp_com;
+    bool d_use_shm;
+    std::string d_shm_name;
+    unsigned int d_shm_batch_size;
+    shm_communication d_shm_com;
 
     //PRN period in samples
     int d_current_prn_length_samples;
@@ -183,12 +200,7 @@ private:
     unsigned long int d_acq_sample_stamp;
 
     // CN0 estimation and lock detector
-    int d_cn0_estimation_counter;
-    gr_complex* d_Prompt_buffer;
-    float d_carrier_lock_test;
-    float d_CN0_SNV_dB_Hz;
-    float d_carrier_lock_threshold;
-    int d_carrier_lock_fail_counter;
+    Tracking_Lock_Detector<Gps_L1_Ca_Tracking_Signal> d_lock_detector;
 
     // control vars
     bool d_enable_tracking;
@@ -196,7 +208,7 @@ private:
 
     // file dump
     std::string d_dump_filename;
-    std::ofstream d_dump_file;
+    boost::shared_ptr<Dump_Stream> d_dump_stream;
 
     std::map<std::string, std::string> systemName;
     std::string sys;
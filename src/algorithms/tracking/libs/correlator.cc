@@ -35,6 +35,7 @@
 
 
 #include "correlator.h"
+#include <cmath>
 #include <iostream>
 #define LV_HAVE_SSE3
 #include "volk_cw_epl_corr.h"
@@ -153,6 +154,51 @@ void Correlator::Carrier_wipeoff_and_VEPL_volk(int signal_length_samples, const
         //}
 }
 
+
+
+void Correlator::Carrier_wipeoff_and_VEPL_code_table(int signal_length_samples, const gr_complex* input, const gr_complex* carrier, const gr_complex* code_table, int code_table_length, double very_early_code_phase, double code_phase_step, const int* tap_offset_samples, gr_complex* VE_out, gr_complex* E_out, gr_complex* P_out, gr_complex* L_out, gr_complex* VL_out)
+{
+    const double table_length = (double)code_table_length;
+    double phase[5];
+    float acc_i[5] = {0, 0, 0, 0, 0};
+    float acc_q[5] = {0, 0, 0, 0, 0};
+
+    /*
+     * The phases are kept rounded (shifted by half an entry) and wrapped to [0, table_length),
+     * so the table index of each tap is a truncation. This selects the same entries as
+     * round(fmod(phase, table_length)) on a table with head and tail padding.
+     */
+    for (int k = 0; k < 5; k++)
+        {
+            double offset = (k == 0) ? 0.0 : (double)tap_offset_samples[k - 1];
+            phase[k] = fmod(very_early_code_phase + offset * code_phase_step + 0.5, table_length);
+            if (phase[k] < 0.0) phase[k] += table_length;
+            if (phase[k] >= table_length) phase[k] -= table_length;
+        }
+
+    for (int i = 0; i < signal_length_samples; i++)
+        {
+            // carrier wipe-off
+            const float bb_i = input[i].real() * carrier[i].real() - input[i].imag() * carrier[i].imag();
+            const float bb_q = input[i].real() * carrier[i].imag() + input[i].imag() * carrier[i].real();
+            // the five replicas share the code table, only their phase differs
+            for (int k = 0; k < 5; k++)
+                {
+                    const gr_complex code = code_table[(int)phase[k]];
+                    acc_i[k] += bb_i * code.real() - bb_q * code.imag();
+                    acc_q[k] += bb_i * code.imag() + bb_q * code.real();
+                    phase[k] += code_phase_step;
+                    if (phase[k] >= table_length) phase[k] -= table_length;
+                }
+        }
+
+    *VE_out = gr_complex(acc_i[0], acc_q[0]);
+    *E_out = gr_complex(acc_i[1], acc_q[1]);
+    *P_out = gr_complex(acc_i[2], acc_q[2]);
+    *L_out = gr_complex(acc_i[3], acc_q[3]);
+    *VL_out = gr_complex(acc_i[4], acc_q[4]);
+}
+
 /*
 void Correlator::cpu_arch_test_volk_32fc_x2_dot_prod_32fc_a()
 {
@@ -48,6 +48,8 @@
  * Implemented versions:
  * - Generic: Standard C++ implementation.
  * - Volk: uses VOLK (Vector-Optimized Library of Kernels) and uses the processor's SIMD instruction sets. See http://gnuradio.org/redmine/projects/gnuradio/wiki/Volk
+ * - Code table: fused carrier wipe-off and correlation that reads the local code replicas directly from the
+ *   sampled code table (e.g. the Galileo E1 sinboc(1,1) code at two samples per chip), without resampled replicas.
  *
  */
 class Correlator
@@ -57,6 +59,15 @@ public:
     void Carrier_wipeoff_and_EPL_volk(int signal_length_samples, const gr_complex* input, gr_complex* carrier, gr_complex* E_code, gr_complex* P_code, gr_complex* L_code, gr_complex* E_out, gr_complex* P_out, gr_complex* L_out, bool input_vector_unaligned);
     void Carrier_wipeoff_and_EPL_volk_custom(int signal_length_samples, const gr_complex* input, gr_complex* carrier, gr_complex* E_code, gr_complex* P_code, gr_complex* L_code, gr_complex* E_out, gr_complex* P_out, gr_complex* L_out, bool input_vector_unaligned);
     void Carrier_wipeoff_and_VEPL_volk(int signal_length_samples, const gr_complex* input, gr_complex* carrier, gr_complex* VE_code, gr_complex* E_code, gr_complex* P_code, gr_complex* L_code, gr_complex* VL_code, gr_complex* VE_out, gr_complex* E_out, gr_complex* P_out, gr_complex* L_out, gr_complex* VL_out, bool input_vector_unaligned);
+    /*!
+     * \brief Carrier wipe-off and Very Early, Early, Prompt, Late and Very Late correlation in a single pass.
+     *
+     * \param code_table One period of the local code, \p code_table_length entries
+     * \param very_early_code_phase Code table phase (in table entries) of the first Very Early sample
+     * \param code_phase_step Code table phase increment per input sample
+     * \param tap_offset_samples Delay (in samples) of the E, P, L and VL replicas with respect to the VE replica
+     */
+    void Carrier_wipeoff_and_VEPL_code_table(int signal_length_samples, const gr_complex* input, const gr_complex* carrier, const gr_complex* code_table, int code_table_length, double very_early_code_phase, double code_phase_step, const int* tap_offset_samples, gr_complex* VE_out, gr_complex* E_out, gr_complex* P_out, gr_complex* L_out, gr_complex* VL_out);
     Correlator();
     ~Correlator();
 private:
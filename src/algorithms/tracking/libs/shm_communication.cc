@@ -0,0 +1,342 @@
+/*!
+ * \file shm_communication.cc
+ * \brief Implementation of a shared memory transport for the tracking connector blocks
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "shm_communication.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#include <glog/logging.h>
+
+using google::LogMessage;
+
+#if ATOMIC_INT_LOCK_FREE != 2
+#error "shm_communication requires lock-free 32-bit atomics"
+#endif
+
+
+namespace
+{
+/*
+ * The futexes are not private: the other side of the mailbox lives in another process.
+ * On systems without futexes the waits degrade to short sleeps.
+ */
+void futex_wait(std::atomic<unsigned int>* addr, unsigned int value, unsigned int timeout_us)
+{
+#if defined(__linux__)
+    struct timespec ts;
+    ts.tv_sec = timeout_us / 1000000;
+    ts.tv_nsec = (timeout_us % 1000000) * 1000;
+    syscall(SYS_futex, reinterpret_cast<unsigned int*>(addr), FUTEX_WAIT, value, &ts, NULL, 0);
+#else
+    if (addr->load(std::memory_order_acquire) == value)
+        {
+            usleep(timeout_us < 50 ? timeout_us : 50);
+        }
+#endif
+}
+
+void futex_wake(std::atomic<unsigned int>* addr)
+{
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<unsigned int*>(addr), FUTEX_WAKE, 1, NULL, NULL, 0);
+#else
+    (void)addr;
+#endif
+}
+}
+
+
+
+shm_communication::shm_communication() :
+        d_header(0),
+        d_segment(0),
+        d_segment_size(sizeof(shm_segment_header) + SHM_MAX_CHANNELS * sizeof(shm_channel_slot)),
+        d_channel(0),
+        d_seq(0)
+{}
+
+
+
+shm_communication::~shm_communication()
+{
+    if (d_segment != 0)
+        {
+            munmap(d_segment, d_segment_size);
+        }
+}
+
+
+
+shm_channel_slot* shm_communication::slot(unsigned int channel)
+{
+    return reinterpret_cast<shm_channel_slot*>(static_cast<char*>(d_segment) + sizeof(shm_segment_header)) + channel;
+}
+
+
+
+bool shm_communication::map_segment(const std::string& shm_name, bool create)
+{
+    d_shm_name = shm_name;
+    int fd = shm_open(shm_name.c_str(), create ? (O_CREAT | O_RDWR) : O_RDWR, 0666);
+    if (fd < 0)
+        {
+            LOG(WARNING) << "Unable to open shared memory segment " << shm_name << ": " << strerror(errno);
+            return false;
+        }
+    struct stat st;
+    bool initialize = false;
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) < d_segment_size)
+        {
+            if (!create || ftruncate(fd, d_segment_size) != 0)
+                {
+                    LOG(WARNING) << "Shared memory segment " << shm_name << " has a wrong size";
+                    close(fd);
+                    return false;
+                }
+            initialize = true;
+        }
+    d_segment = mmap(0, d_segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (d_segment == MAP_FAILED)
+        {
+            d_segment = 0;
+            LOG(WARNING) << "Unable to map shared memory segment " << shm_name << ": " << strerror(errno);
+            return false;
+        }
+    d_header = static_cast<shm_segment_header*>(d_segment);
+    if (initialize)
+        {
+            // ftruncate fills the new segment with zeros, which is a valid state for all the atomics
+            d_header->version = SHM_VERSION;
+            d_header->max_channels = SHM_MAX_CHANNELS;
+            d_header->batch_size = 1;
+            std::atomic_thread_fence(std::memory_order_release);
+            d_header->magic = SHM_MAGIC;
+        }
+    else if (d_header->magic != SHM_MAGIC || d_header->version != SHM_VERSION)
+        {
+            LOG(WARNING) << "Shared memory segment " << shm_name << " has an unknown format";
+            munmap(d_segment, d_segment_size);
+            d_segment = 0;
+            d_header = 0;
+            return false;
+        }
+    return true;
+}
+
+
+
+bool shm_communication::open_shm_connection(const std::string& shm_name, unsigned int channel, unsigned int batch_size)
+{
+    if (channel >= SHM_MAX_CHANNELS)
+        {
+            LOG(WARNING) << "Channel " << channel << " exceeds the " << SHM_MAX_CHANNELS << " shared memory slots";
+            return false;
+        }
+    if (!map_segment(shm_name, true))
+        {
+            return false;
+        }
+    d_channel = channel;
+    d_seq = 0;
+    d_header->batch_size = batch_size > 0 ? batch_size : 1;
+    shm_channel_slot* s = slot(d_channel);
+    s->response_seq.store(0, std::memory_order_relaxed);
+    s->request_seq.store(0, std::memory_order_release);
+    if (d_channel == 0)
+        {
+            std::cout << "Shared memory segment " << shm_name << " ready. Waiting for the loop filter process..." << std::endl;
+        }
+    LOG(INFO) << "Channel " << d_channel << " connected to shared memory segment " << shm_name;
+    return true;
+}
+
+
+
+bool shm_communication::send_receive(const float *buf, unsigned int num_tx, tcp_packet_data *tcp_data_)
+{
+    // the tracking loop gets no correction when the exchange fails
+    tcp_data_->proc_pack_code_error = 0;
+    tcp_data_->proc_pack_carr_error = 0;
+    tcp_data_->proc_pack_carrier_doppler_hz = 0;
+    if (d_segment == 0)
+        {
+            return false;
+        }
+    shm_channel_slot* s = slot(d_channel);
+    // odd sequence number while the request is written, so that the loop filter
+    // discards a copy of tx that overlaps with the writing
+    s->request_seq.store(d_seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(s->tx, buf, num_tx * sizeof(float));
+    s->num_tx = num_tx;
+    d_seq += 2;
+    const unsigned int seq = d_seq;
+    s->request_seq.store(seq, std::memory_order_release);
+
+    // Ring the doorbell, waking up the loop filter once per batch. The pending counter is
+    // shared by all the channels, so it is incremented and reset in a single atomic step.
+    d_header->doorbell.fetch_add(1, std::memory_order_release);
+    const unsigned int batch_size = d_header->batch_size;
+    unsigned int pending = d_header->pending.load(std::memory_order_relaxed);
+    unsigned int next_pending;
+    do
+        {
+            next_pending = (pending + 1 >= batch_size) ? 0 : pending + 1;
+        }
+    while (!d_header->pending.compare_exchange_weak(pending, next_pending, std::memory_order_acq_rel));
+    if (next_pending == 0)
+        {
+            futex_wake(&d_header->doorbell);
+        }
+
+    // Wait for the response: spin first, then sleep on the response sequence number
+    unsigned int response = s->response_seq.load(std::memory_order_acquire);
+    for (int i = 0; i < SHM_SPIN_ITERATIONS && response != seq; i++)
+        {
+            response = s->response_seq.load(std::memory_order_acquire);
+        }
+    unsigned int waited_us = 0;
+    while (response != seq)
+        {
+            if (waited_us >= SHM_RESPONSE_TIMEOUT_MS * 1000)
+                {
+                    LOG(ERROR) << "Channel " << d_channel << ": no response from the loop filter process after "
+                               << SHM_RESPONSE_TIMEOUT_MS << " ms";
+                    return false;
+                }
+            futex_wait(&s->response_seq, response, 1000);
+            waited_us += 1000;
+            response = s->response_seq.load(std::memory_order_acquire);
+        }
+
+    //! Control. The echoed control id must match the one sent, which also discards
+    //! the late response to a request that timed out.
+    if (s->rx[0] != buf[0])
+        {
+            LOG(ERROR) << "Channel " << d_channel << ": shared memory packet error (control id "
+                       << s->rx[0] << " instead of " << buf[0] << ")";
+            return false;
+        }
+
+    // Recover the variables received
+    tcp_data_->proc_pack_code_error = s->rx[1];
+    tcp_data_->proc_pack_carr_error = s->rx[2];
+    tcp_data_->proc_pack_carrier_doppler_hz = s->rx[3];
+    return true;
+}
+
+
+
+bool shm_communication::send_receive_shm_packet_galileo_e1(const boost::array<float, NUM_TX_VARIABLES_GALILEO_E1>& buf, tcp_packet_data *tcp_data_)
+{
+    return send_receive(buf.data(), NUM_TX_VARIABLES_GALILEO_E1, tcp_data_);
+}
+
+
+
+bool shm_communication::send_receive_shm_packet_gps_l1_ca(const boost::array<float, NUM_TX_VARIABLES_GPS_L1_CA>& buf, tcp_packet_data *tcp_data_)
+{
+    return send_receive(buf.data(), NUM_TX_VARIABLES_GPS_L1_CA, tcp_data_);
+}
+
+
+
+void shm_communication::close_shm_connection()
+{
+    if (d_segment != 0)
+        {
+            munmap(d_segment, d_segment_size);
+            d_segment = 0;
+            d_header = 0;
+            LOG(INFO) << "Channel " << d_channel << " disconnected from shared memory segment " << d_shm_name;
+        }
+}
+
+
+
+bool shm_communication::attach_shm_server(const std::string& shm_name)
+{
+    return map_segment(shm_name, false);
+}
+
+
+
+unsigned int shm_communication::wait_shm_requests(unsigned int last_doorbell, unsigned int timeout_us)
+{
+    unsigned int doorbell = d_header->doorbell.load(std::memory_order_acquire);
+    if (doorbell == last_doorbell)
+        {
+            futex_wait(&d_header->doorbell, last_doorbell, timeout_us);
+            doorbell = d_header->doorbell.load(std::memory_order_acquire);
+        }
+    return doorbell;
+}
+
+
+
+bool shm_communication::read_shm_request(unsigned int channel, float *buf, unsigned int *num_tx, unsigned int *seq)
+{
+    shm_channel_slot* s = slot(channel);
+    const unsigned int request = s->request_seq.load(std::memory_order_acquire);
+    if ((request & 1) != 0 || request == s->response_seq.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+    *num_tx = s->num_tx < SHM_MAX_TX_VARIABLES ? s->num_tx : SHM_MAX_TX_VARIABLES;
+    std::memcpy(buf, s->tx, *num_tx * sizeof(float));
+    // the copy is only valid if the channel did not start a new request meanwhile;
+    // the new request rings the doorbell again
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (s->request_seq.load(std::memory_order_relaxed) != request)
+        {
+            return false;
+        }
+    *seq = request;
+    return true;
+}
+
+
+
+void shm_communication::write_shm_response(unsigned int channel, unsigned int seq, const float *buf)
+{
+    shm_channel_slot* s = slot(channel);
+    std::memcpy(s->rx, buf, NUM_RX_VARIABLES * sizeof(float));
+    s->response_seq.store(seq, std::memory_order_release);
+    futex_wake(&s->response_seq);
+}
@@ -0,0 +1,152 @@
+/*!
+ * \file shm_communication.h
+ * \brief Interface of a shared memory transport for the tracking connector blocks
+ *
+ * Alternative to tcp_communication for the TCP connector tracking blocks.
+ * All the channels share one POSIX shared memory segment that holds a
+ * header and one request / response mailbox pair per channel. A channel
+ * writes its correlator outputs in the request mailbox and waits for the
+ * external loop filter to write the response, which keeps the semantics of
+ * the TCP exchange (control id echoed in the first element, followed by
+ * code error, carrier error and carrier Doppler). Notification is done with
+ * futexes on the sequence numbers of the mailboxes, so no system call is
+ * needed when the other side is already waiting.
+ *
+ * Segment layout (all fields are 32-bit, little endian, cache line aligned):
+ *   header: magic, version, max_channels, batch_size, doorbell, pending
+ *   slot[i]: request_seq, num_tx, tx[SHM_MAX_TX_VARIABLES] | response_seq, rx[NUM_RX_VARIABLES]
+ * A channel sets request_seq to an odd value while it writes tx, and to the
+ * next (even) value once the request is complete. A request of channel i is
+ * pending while slot[i].request_seq is even and differs from slot[i].response_seq.
+ * The external process copies tx, checks that request_seq did not change
+ * during the copy, and serves the request by writing rx and then setting
+ * response_seq to the request_seq it read (and waking the futex on response_seq).
+ * A late response to a request that timed out thus keeps the old sequence number.
+ * Every request increments the doorbell; with batch_size = N the doorbell
+ * futex is only woken once every N requests, so the external process should
+ * wait on it with a timeout shorter than one integration period and serve
+ * all the pending slots in one pass. A channel that gets no response within
+ * SHM_RESPONSE_TIMEOUT_MS gives up the exchange, and its tracking block
+ * fails the channel.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_SHM_COMMUNICATION_H_
+#define GNSS_SDR_SHM_COMMUNICATION_H_
+
+#include <atomic>
+#include <string>
+#include <boost/array.hpp>
+#include "tcp_communication.h"
+#include "tcp_packet_data.h"
+
+#define SHM_MAGIC 0x47534d31 // "GSM1"
+#define SHM_VERSION 2
+#define SHM_MAX_CHANNELS 64
+#define SHM_MAX_TX_VARIABLES 14
+#define SHM_SPIN_ITERATIONS 4000
+#define SHM_RESPONSE_TIMEOUT_MS 1000
+
+/*!
+ * \brief Header of the shared memory segment
+ */
+struct shm_segment_header
+{
+    unsigned int magic;
+    unsigned int version;
+    unsigned int max_channels;
+    unsigned int batch_size;
+    std::atomic<unsigned int> doorbell;   //!< Incremented on every request
+    std::atomic<unsigned int> pending;    //!< Requests posted since the last doorbell wake up (shared by all the channels)
+    unsigned int reserved[10];
+};
+
+/*!
+ * \brief Request / response mailbox pair of one channel
+ */
+struct shm_channel_slot
+{
+    std::atomic<unsigned int> request_seq;  //!< Odd while the channel writes tx
+    unsigned int num_tx;
+    float tx[SHM_MAX_TX_VARIABLES];
+    std::atomic<unsigned int> response_seq;
+    float rx[NUM_RX_VARIABLES];
+    unsigned int reserved[11];
+};
+
+
+/*!
+ * \brief Shared memory communication class
+ *
+ * The receiver side (one object per channel) uses open / send_receive / close.
+ * The attach / wait / read / write methods implement the loop filter side
+ * and are provided for external processes written in C++.
+ */
+class shm_communication
+{
+public:
+    shm_communication();
+    ~shm_communication();
+
+    bool open_shm_connection(const std::string& shm_name, unsigned int channel, unsigned int batch_size);
+
+    /*!
+     * \brief Posts the request of the channel and waits for the response of the loop filter.
+     * Returns false, with zero corrections in tcp_data_, if the segment is not open, no response
+     * arrives within SHM_RESPONSE_TIMEOUT_MS or the response has a wrong control id.
+     */
+    bool send_receive_shm_packet_galileo_e1(const boost::array<float, NUM_TX_VARIABLES_GALILEO_E1>& buf, tcp_packet_data *tcp_data_);
+    bool send_receive_shm_packet_gps_l1_ca(const boost::array<float, NUM_TX_VARIABLES_GPS_L1_CA>& buf, tcp_packet_data *tcp_data_);
+    void close_shm_connection();
+
+    bool attach_shm_server(const std::string& shm_name);
+    unsigned int wait_shm_requests(unsigned int last_doorbell, unsigned int timeout_us);
+
+    /*!
+     * \brief Copies the pending request of a channel. Returns false if there is none, or if the
+     * channel rewrote it during the copy. *seq gets the sequence number of the request read.
+     */
+    bool read_shm_request(unsigned int channel, float *buf, unsigned int *num_tx, unsigned int *seq);
+
+    /*!
+     * \brief Answers the request with sequence number seq, as returned by read_shm_request
+     */
+    void write_shm_response(unsigned int channel, unsigned int seq, const float *buf);
+
+private:
+    bool map_segment(const std::string& shm_name, bool create);
+    bool send_receive(const float *buf, unsigned int num_tx, tcp_packet_data *tcp_data_);
+    shm_channel_slot* slot(unsigned int channel);
+
+    std::string d_shm_name;
+    shm_segment_header *d_header;
+    void *d_segment;
+    size_t d_segment_size;
+    unsigned int d_channel;
+    unsigned int d_seq;
+};
+
+#endif
@@ -68,15 +68,6 @@ void Tracking_2nd_DLL_filter::initialize()
 
 
 
-float Tracking_2nd_DLL_filter::get_code_nco(float DLL_discriminator)
-{
-    float code_nco;
-    code_nco = d_old_code_nco + (d_tau2_code/d_tau1_code)*(DLL_discriminator - d_old_code_error) + DLL_discriminator * (d_pdi_code/d_tau1_code);
-    d_old_code_nco   = code_nco;
-    d_old_code_error = DLL_discriminator; //[chips]
-    return code_nco;
-}
-
 Tracking_2nd_DLL_filter::Tracking_2nd_DLL_filter (float pdi_code)
 {
     d_pdi_code = pdi_code;// Summation interval for code
@@ -69,4 +69,19 @@ public:
 	~Tracking_2nd_PLL_filter();
 };
 
+
+/*
+ * PLL second order FIR filter
+ * Req Input in [Hz/Ti]
+ * The output is in [Hz/s].
+ */
+inline float Tracking_2nd_PLL_filter::get_carrier_nco(float PLL_discriminator)
+{
+    float carr_nco;
+    carr_nco = d_old_carr_nco + (d_tau2_carr/d_tau1_carr)*(PLL_discriminator - d_old_carr_error) + PLL_discriminator * (d_pdi_carr/d_tau1_carr);
+    d_old_carr_nco   = carr_nco;
+    d_old_carr_error = PLL_discriminator;
+    return carr_nco;
+}
+
 #endif
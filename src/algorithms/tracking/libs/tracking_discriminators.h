@@ -8,7 +8,8 @@
  *          </ul>
  *
  * Library with a set of code tracking and carrier tracking discriminators
- * that is used by the tracking algorithms.
+ * that is used by the tracking algorithms. They are defined inline so that
+ * they are expanded in the tracking loops.
  *
  * -------------------------------------------------------------------------
  *
@@ -38,6 +39,7 @@
 #ifndef GNSS_SDR_TRACKING_DISCRIMINATORS_H_
 #define GNSS_SDR_TRACKING_DISCRIMINATORS_H_
 
+#include <cmath>
 #include <gnuradio/gr_complex.h>
 
 /*! brief FLL four quadrant arctan discriminator
@@ -50,7 +52,13 @@
  * \f$I_{PS1},Q_{PS1}\f$ are the inphase and quadrature prompt correlator outputs respectively at sample time \f$t_1\f$, and
  * \f$I_{PS2},Q_{PS2}\f$ are the inphase and quadrature prompt correlator outputs respectively at sample time \f$t_2\f$. The output is in [radians/second].
  */
-float fll_four_quadrant_atan(gr_complex prompt_s1, gr_complex prompt_s2, float t1, float t2);
+inline float fll_four_quadrant_atan(gr_complex prompt_s1, gr_complex prompt_s2, float t1, float t2)
+{
+    float cross, dot;
+    dot   = prompt_s1.real()*prompt_s2.real() + prompt_s1.imag()*prompt_s2.imag();
+    cross = prompt_s1.real()*prompt_s2.imag() - prompt_s2.real()*prompt_s1.imag();
+    return atan2(cross, dot) / (t2-t1);
+}
 
 
 /*! \brief PLL four quadrant arctan discriminator
@@ -61,7 +69,10 @@ float fll_four_quadrant_atan(gr_complex prompt_s1, gr_complex prompt_s2, float t
  * \f}
  * where \f$I_{PS1},Q_{PS1}\f$ are the inphase and quadrature prompt correlator outputs respectively. The output is in [radians].
  */
-float pll_four_quadrant_atan(gr_complex prompt_s1);
+inline float pll_four_quadrant_atan(gr_complex prompt_s1)
+{
+    return atan2(prompt_s1.imag(), prompt_s1.real());
+}
 
 
 /*! \brief PLL Costas loop two quadrant arctan discriminator
@@ -72,7 +83,17 @@ float pll_four_quadrant_atan(gr_complex prompt_s1);
  * \f}
  * where \f$I_{PS1},Q_{PS1}\f$ are the inphase and quadrature prompt correlator outputs respectively. The output is in [radians].
  */
-float pll_cloop_two_quadrant_atan(gr_complex prompt_s1);
+inline float pll_cloop_two_quadrant_atan(gr_complex prompt_s1)
+{
+    if (prompt_s1.real() != 0.0)
+        {
+            return atan(prompt_s1.imag() / prompt_s1.real());
+        }
+    else
+        {
+            return 0;
+        }
+}
 
 
 /*! \brief DLL Noncoherent Early minus Late envelope normalized discriminator
@@ -84,7 +105,13 @@ float pll_cloop_two_quadrant_atan(gr_complex prompt_s1);
  * where \f$E=\sqrt{I_{ES}^2+Q_{ES}^2}\f$ is the Early correlator output absolute value and
  * \f$L=\sqrt{I_{LS}^2+Q_{LS}^2}\f$ is the Late correlator output absolute value. The output is in [chips].
  */
-float dll_nc_e_minus_l_normalized(gr_complex early_s1, gr_complex late_s1);
+inline float dll_nc_e_minus_l_normalized(gr_complex early_s1, gr_complex late_s1)
+{
+    float P_early, P_late;
+    P_early = std::abs(early_s1);
+    P_late  = std::abs(late_s1);
+    return (P_early - P_late) / ((P_early + P_late));
+}
 
 
 /*! \brief DLL Noncoherent Very Early Minus Late Power (VEMLP) normalized discriminator
@@ -97,7 +124,13 @@ float dll_nc_e_minus_l_normalized(gr_complex early_s1, gr_complex late_s1);
  * where \f$E=\sqrt{I_{VE}^2+Q_{VE}^2+I_{E}^2+Q_{E}^2}\f$ and
  * \f$L=\sqrt{I_{VL}^2+Q_{VL}^2+I_{L}^2+Q_{L}^2}\f$ . The output is in [chips].
  */
-float dll_nc_vemlp_normalized(gr_complex very_early_s1, gr_complex early_s1, gr_complex late_s1, gr_complex very_late_s1);
+inline float dll_nc_vemlp_normalized(gr_complex very_early_s1, gr_complex early_s1, gr_complex late_s1, gr_complex very_late_s1)
+{
+    float P_early, P_late;
+    P_early = std::sqrt(std::norm(very_early_s1) + std::norm(early_s1));
+    P_late  = std::sqrt(std::norm(very_late_s1) + std::norm(late_s1));
+    return (P_early - P_late) / ((P_early + P_late));
+}
 
 
 #endif
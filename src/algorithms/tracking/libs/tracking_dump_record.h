@@ -0,0 +1,90 @@
+/*!
+ * \file tracking_dump_record.h
+ * \brief Binary layout of the records written by the tracking blocks in dump mode
+ *
+ * The layouts are packed so that the files keep exactly the same format
+ * as the one expected by the MATLAB readers in src/utils/matlab.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_TRACKING_DUMP_RECORD_H_
+#define GNSS_SDR_TRACKING_DUMP_RECORD_H_
+
+/*!
+ * \brief Tracking loop state common to all the tracking dump records
+ *
+ * The accumulated carrier phase is stored as a float in every record. The
+ * Galileo E1 DLL/PLL VEML block used to write the first four bytes of its
+ * double accumulator into this slot, which did not hold a valid float; it now
+ * writes the accumulator rounded to float. The record size is unchanged.
+ */
+struct Tracking_Dump_Loop_State
+{
+    unsigned long int PRN_start_sample;   //!< PRN start sample stamp
+    float acc_carrier_phase_rad;          //!< Accumulated carrier phase
+    float carrier_doppler_hz;             //!< Carrier frequency
+    float code_freq_hz;                   //!< Code frequency
+    float carr_error;                     //!< PLL discriminator output
+    float carr_nco;                       //!< PLL filter output
+    float code_error;                     //!< DLL discriminator output
+    float code_nco;                       //!< DLL filter output
+    float CN0_SNV_dB_Hz;                  //!< C/N0 estimation
+    float carrier_lock_test;              //!< Carrier lock detector
+    float rem_code_phase_samples;         //!< AUX var (for debug purposes)
+    double next_PRN_start_sample;         //!< AUX var (for debug purposes)
+} __attribute__((packed));
+
+
+/*!
+ * \brief Record dumped by the Early-Prompt-Late tracking blocks
+ */
+struct Tracking_Dump_Record_EPL
+{
+    float abs_E;
+    float abs_P;
+    float abs_L;
+    float prompt_I;                       //!< Prompt I (to analyze navigation symbols)
+    float prompt_Q;                       //!< Prompt Q (to analyze navigation symbols)
+    Tracking_Dump_Loop_State loop;
+} __attribute__((packed));
+
+
+/*!
+ * \brief Record dumped by the Very Early-Early-Prompt-Late-Very Late tracking blocks
+ */
+struct Tracking_Dump_Record_VEPL
+{
+    float abs_VE;
+    float abs_E;
+    float abs_P;
+    float abs_L;
+    float abs_VL;
+    float prompt_I;                       //!< Prompt I (to analyze navigation symbols)
+    float prompt_Q;                       //!< Prompt Q (to analyze navigation symbols)
+    Tracking_Dump_Loop_State loop;
+} __attribute__((packed));
+
+#endif
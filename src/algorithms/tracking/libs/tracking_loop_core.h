@@ -0,0 +1,320 @@
+/*!
+ * \file tracking_loop_core.h
+ * \brief Compile-time configurable code and carrier tracking loop
+ *
+ * The DLL/PLL tracking blocks share the same loop update: PLL and DLL
+ * discriminators, loop filters, NCO update, alignment of the next PRN
+ * block and CN0 / carrier lock detection. Tracking_Loop_Core implements
+ * that update once, parameterised on the signal (code rate, code length,
+ * integration time), the discriminators and the loop filters, so that the
+ * compiler can inline every step of a given combination. A new tracking
+ * loop configuration is a typedef, e.g.
+ *
+ * typedef Tracking_Loop_Core<Gps_L1_Ca_Tracking_Signal,
+ *                            Pll_Costas_Discriminator,
+ *                            Dll_Nc_E_Minus_L_Discriminator> Gps_L1_Ca_Dll_Pll_Loop;
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_TRACKING_LOOP_CORE_H_
+#define GNSS_SDR_TRACKING_LOOP_CORE_H_
+
+#include <cmath>
+#include <gnuradio/gr_complex.h>
+#include "GPS_L1_CA.h"
+#include "Galileo_E1.h"
+#include "tracking_discriminators.h"
+#include "tracking_2nd_DLL_filter.h"
+#include "tracking_2nd_PLL_filter.h"
+#include "lock_detectors.h"
+
+#define CN0_ESTIMATION_SAMPLES 20
+#define MINIMUM_VALID_CN0 25
+#define MAXIMUM_LOCK_FAIL_COUNTER 50
+#define CARRIER_LOCK_THRESHOLD 0.85
+
+
+/*
+ * Signal policies: code and carrier parameters, and integration time
+ */
+struct Gps_L1_Ca_Tracking_Signal
+{
+    static double code_rate_hz() { return GPS_L1_CA_CODE_RATE_HZ; }
+    static double code_length_chips() { return GPS_L1_CA_CODE_LENGTH_CHIPS; }
+    static double integration_time_s() { return GPS_L1_CA_CODE_PERIOD; }
+    static double carrier_freq_hz() { return GPS_L1_FREQ_HZ; }
+};
+
+struct Galileo_E1_B_Tracking_Signal
+{
+    static double code_rate_hz() { return Galileo_E1_CODE_CHIP_RATE_HZ; }
+    static double code_length_chips() { return Galileo_E1_B_CODE_LENGTH_CHIPS; }
+    static double integration_time_s() { return Galileo_E1_CODE_PERIOD; }
+    static double carrier_freq_hz() { return Galileo_E1_FREQ_HZ; }
+};
+
+
+/*!
+ * \brief Correlator outputs of one integration period.
+ * The Very Early and Very Late outputs are only used by the VEML discriminators.
+ */
+struct Tracking_Correlator_Outputs
+{
+    gr_complex very_early;
+    gr_complex early;
+    gr_complex prompt;
+    gr_complex late;
+    gr_complex very_late;
+};
+
+
+/*
+ * Discriminator policies
+ */
+struct Pll_Costas_Discriminator
+{
+    //! Carrier phase error [cycles]
+    static float error(const Tracking_Correlator_Outputs& c)
+    {
+        return pll_cloop_two_quadrant_atan(c.prompt) / (float)GPS_TWO_PI;
+    }
+};
+
+struct Pll_Four_Quadrant_Discriminator
+{
+    //! Carrier phase error [cycles]
+    static float error(const Tracking_Correlator_Outputs& c)
+    {
+        return pll_four_quadrant_atan(c.prompt) / (float)GPS_TWO_PI;
+    }
+};
+
+struct Dll_Nc_E_Minus_L_Discriminator
+{
+    //! Code phase error [chips]
+    static float error(const Tracking_Correlator_Outputs& c)
+    {
+        return dll_nc_e_minus_l_normalized(c.early, c.late);
+    }
+};
+
+struct Dll_Nc_Vemlp_Discriminator
+{
+    //! Code phase error [chips]
+    static float error(const Tracking_Correlator_Outputs& c)
+    {
+        return dll_nc_vemlp_normalized(c.very_early, c.early, c.late, c.very_late);
+    }
+};
+
+
+/*!
+ * \brief CN0 estimation and carrier lock detection over blocks of
+ * CN0_ESTIMATION_SAMPLES prompt correlator outputs
+ */
+template<class Signal>
+class Tracking_Lock_Detector
+{
+public:
+    Tracking_Lock_Detector() :
+        d_counter(0),
+        d_fail_counter(0),
+        d_cn0_db_hz(0.0),
+        d_lock_test(1.0),
+        d_threshold(CARRIER_LOCK_THRESHOLD)
+    {
+        for (int i = 0; i < CN0_ESTIMATION_SAMPLES; i++) d_prompt_buffer[i] = gr_complex(0.0, 0.0);
+    }
+
+    void initialize()
+    {
+        d_fail_counter = 0;
+    }
+
+    void set_threshold(float threshold) { d_threshold = threshold; }
+
+    /*!
+     * \brief Accumulates a prompt output. Returns true when the loss of lock is declared.
+     */
+    bool update(const gr_complex& prompt, long fs_in)
+    {
+        if (d_counter < CN0_ESTIMATION_SAMPLES)
+            {
+                // fill buffer with prompt correlator output values
+                d_prompt_buffer[d_counter] = prompt;
+                d_counter++;
+                return false;
+            }
+        d_counter = 0;
+        // Code lock indicator
+        d_cn0_db_hz = cn0_svn_estimator(d_prompt_buffer, CN0_ESTIMATION_SAMPLES, fs_in, Signal::code_length_chips());
+        // Carrier lock indicator
+        d_lock_test = carrier_lock_detector(d_prompt_buffer, CN0_ESTIMATION_SAMPLES);
+        // Loss of lock detection
+        if (d_lock_test < d_threshold or d_cn0_db_hz < MINIMUM_VALID_CN0)
+            {
+                d_fail_counter++;
+            }
+        else
+            {
+                if (d_fail_counter > 0) d_fail_counter--;
+            }
+        if (d_fail_counter > MAXIMUM_LOCK_FAIL_COUNTER)
+            {
+                d_fail_counter = 0;
+                return true;
+            }
+        return false;
+    }
+
+    float cn0_db_hz() const { return d_cn0_db_hz; }
+    float carrier_lock_test() const { return d_lock_test; }
+
+private:
+    gr_complex d_prompt_buffer[CN0_ESTIMATION_SAMPLES];
+    int d_counter;
+    int d_fail_counter;
+    float d_cn0_db_hz;
+    float d_lock_test;
+    float d_threshold;
+};
+
+
+/*!
+ * \brief Code and carrier tracking loop state, read by the blocks to
+ * generate the local replicas, fill the outputs and dump the loop
+ */
+struct Tracking_Loop_State
+{
+    float acq_carrier_doppler_hz;     //!< Carrier Doppler from the acquisition [Hz]
+    float carrier_doppler_hz;         //!< Current carrier Doppler estimation [Hz]
+    float code_freq_chips;            //!< Current code frequency estimation [chips/s]
+    double acc_carrier_phase_rad;     //!< Accumulated carrier phase [rad]
+    float rem_carr_phase_rad;         //!< Remnant carrier phase for the next block [rad]
+    double acc_code_phase_secs;       //!< Accumulated code phase [s]
+    float rem_code_phase_samples;     //!< Code phase rounding error of the next block [samples]
+    int current_prn_length_samples;   //!< Length of the next PRN block [samples]
+    float carr_error_hz;              //!< PLL discriminator output
+    float carr_error_filt_hz;         //!< PLL filter output
+    float code_error_chips;           //!< DLL discriminator output
+    float code_error_filt_chips;      //!< DLL filter output
+};
+
+
+/*!
+ * \brief DLL/PLL tracking loop
+ */
+template<class Signal,
+         class Carrier_Discriminator,
+         class Code_Discriminator,
+         class Carrier_Filter = Tracking_2nd_PLL_filter,
+         class Code_Filter = Tracking_2nd_DLL_filter>
+class Tracking_Loop_Core
+{
+public:
+    Tracking_Loop_Core() :
+        d_fs_in(1),
+        d_carrier_loop_filter(Signal::integration_time_s()),
+        d_code_loop_filter(Signal::integration_time_s())
+    {
+        reset(0.0, 0);
+        d_state.code_freq_chips = Signal::code_rate_hz();
+    }
+
+    void set_sampling_frequency(long fs_in) { d_fs_in = fs_in; }
+    void set_pll_bw(float pll_bw_hz) { d_carrier_loop_filter.set_PLL_BW(pll_bw_hz); }
+    void set_dll_bw(float dll_bw_hz) { d_code_loop_filter.set_DLL_BW(dll_bw_hz); }
+
+    /*!
+     * \brief Starts a new tracking with the acquisition Doppler and the first PRN block length
+     */
+    void reset(float acq_carrier_doppler_hz, int prn_length_samples)
+    {
+        d_carrier_loop_filter.initialize();
+        d_code_loop_filter.initialize();
+        d_state.acq_carrier_doppler_hz = acq_carrier_doppler_hz;
+        d_state.carrier_doppler_hz = acq_carrier_doppler_hz;
+        d_state.acc_carrier_phase_rad = 0.0;
+        d_state.rem_carr_phase_rad = 0.0;
+        d_state.acc_code_phase_secs = 0.0;
+        d_state.rem_code_phase_samples = 0.0;
+        d_state.current_prn_length_samples = prn_length_samples;
+        d_state.carr_error_hz = 0.0;
+        d_state.carr_error_filt_hz = 0.0;
+        d_state.code_error_chips = 0.0;
+        d_state.code_error_filt_chips = 0.0;
+    }
+
+    /*!
+     * \brief Closes the loops with the correlator outputs of the last PRN block
+     */
+    void update(const Tracking_Correlator_Outputs& corr)
+    {
+        Tracking_Loop_State& s = d_state;
+        // ################## PLL ##########################################################
+        s.carr_error_hz = Carrier_Discriminator::error(corr);
+        s.carr_error_filt_hz = d_carrier_loop_filter.get_carrier_nco(s.carr_error_hz);
+        // New carrier Doppler frequency estimation
+        s.carrier_doppler_hz = s.acq_carrier_doppler_hz + s.carr_error_filt_hz;
+        // New code Doppler frequency estimation
+        s.code_freq_chips = Signal::code_rate_hz() + ((s.carrier_doppler_hz * Signal::code_rate_hz()) / Signal::carrier_freq_hz());
+        // carrier phase accumulator for (K) Doppler estimation
+        s.acc_carrier_phase_rad = s.acc_carrier_phase_rad + GPS_TWO_PI * s.carrier_doppler_hz * Signal::integration_time_s();
+        // remnant carrier phase to prevent overflow in the code NCO
+        s.rem_carr_phase_rad = s.rem_carr_phase_rad + GPS_TWO_PI * s.carrier_doppler_hz * Signal::integration_time_s();
+        s.rem_carr_phase_rad = fmod(s.rem_carr_phase_rad, GPS_TWO_PI);
+
+        // ################## DLL ##########################################################
+        s.code_error_chips = Code_Discriminator::error(corr); //[chips/Ti]
+        s.code_error_filt_chips = d_code_loop_filter.get_code_nco(s.code_error_chips); //[chips/second]
+        float code_error_filt_secs = (Signal::integration_time_s() * s.code_error_filt_chips) / Signal::code_rate_hz(); //[seconds]
+        s.acc_code_phase_secs = s.acc_code_phase_secs + code_error_filt_secs;
+
+        // ################## CARRIER AND CODE NCO BUFFER ALIGNEMENT #######################
+        // Compute the next buffer length based in the new period of the PRN sequence and the code phase error estimation
+        float T_chip_seconds = 1 / s.code_freq_chips;
+        float T_prn_seconds = T_chip_seconds * Signal::code_length_chips();
+        float T_prn_samples = T_prn_seconds * (float)d_fs_in;
+        float K_blk_samples = T_prn_samples + s.rem_code_phase_samples + code_error_filt_secs * (float)d_fs_in;
+        s.current_prn_length_samples = round(K_blk_samples); //round to a discrete samples
+        s.rem_code_phase_samples = K_blk_samples - s.current_prn_length_samples; //rounding error < 1 sample
+    }
+
+    Tracking_Loop_State& state() { return d_state; }
+    const Tracking_Loop_State& state() const { return d_state; }
+
+private:
+    long d_fs_in;
+    Carrier_Filter d_carrier_loop_filter;
+    Code_Filter d_code_loop_filter;
+    Tracking_Loop_State d_state;
+};
+
+
+typedef Tracking_Loop_Core<Gps_L1_Ca_Tracking_Signal, Pll_Costas_Discriminator, Dll_Nc_E_Minus_L_Discriminator> Gps_L1_Ca_Dll_Pll_Loop;
+typedef Tracking_Loop_Core<Galileo_E1_B_Tracking_Signal, Pll_Costas_Discriminator, Dll_Nc_Vemlp_Discriminator> Galileo_E1_Dll_Pll_Veml_Loop;
+
+#endif
@@ -0,0 +1,159 @@
+/*!
+ * \file concurrent_bounded_queue.h
+ * \brief Interface of a lock-free, fixed-capacity multi-producer / multi-consumer queue
+ *
+ * Array-based queue where each cell carries a sequence number that tells
+ * producers and consumers whether the cell is free or full (D. Vyukov's
+ * bounded MPMC queue). push() and pop() never block, never allocate and
+ * never take a mutex, so they can be called from signal processing threads.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_CONCURRENT_BOUNDED_QUEUE_H
+#define GNSS_SDR_CONCURRENT_BOUNDED_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+template<typename Data>
+
+/*!
+ * \brief Lock-free bounded queue. The capacity is rounded up to a power of two.
+ *
+ * try_push() fails (and counts a dropped item) when the queue is full;
+ * try_pop() fails when it is empty.
+ */
+class concurrent_bounded_queue
+{
+private:
+    struct cell
+    {
+        std::atomic<size_t> sequence;
+        Data data;
+    };
+    static const size_t cacheline_size = 64;
+    char pad0[cacheline_size];
+    cell* the_buffer;
+    size_t the_mask;
+    char pad1[cacheline_size];
+    std::atomic<size_t> enqueue_pos;
+    char pad2[cacheline_size];
+    std::atomic<size_t> dequeue_pos;
+    char pad3[cacheline_size];
+    std::atomic<unsigned long long> dropped;
+
+    concurrent_bounded_queue(const concurrent_bounded_queue&);
+    concurrent_bounded_queue& operator=(const concurrent_bounded_queue&);
+
+public:
+    explicit concurrent_bounded_queue(size_t capacity) : enqueue_pos(0), dequeue_pos(0), dropped(0)
+    {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        the_buffer = new cell[size];
+        the_mask = size - 1;
+        for (size_t i = 0; i < size; i++)
+            {
+                the_buffer[i].sequence.store(i, std::memory_order_relaxed);
+            }
+    }
+
+    ~concurrent_bounded_queue()
+    {
+        delete[] the_buffer;
+    }
+
+    bool try_push(Data const& data)
+    {
+        cell* c;
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        while (true)
+            {
+                c = &the_buffer[pos & the_mask];
+                size_t seq = c->sequence.load(std::memory_order_acquire);
+                long diff = (long)seq - (long)pos;
+                if (diff == 0)
+                    {
+                        if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                    }
+                else if (diff < 0)
+                    {
+                        dropped.fetch_add(1, std::memory_order_relaxed);
+                        return false; // full
+                    }
+                else
+                    {
+                        pos = enqueue_pos.load(std::memory_order_relaxed);
+                    }
+            }
+        c->data = data;
+        c->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(Data& popped_value)
+    {
+        cell* c;
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        while (true)
+            {
+                c = &the_buffer[pos & the_mask];
+                size_t seq = c->sequence.load(std::memory_order_acquire);
+                long diff = (long)seq - (long)(pos + 1);
+                if (diff == 0)
+                    {
+                        if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                    }
+                else if (diff < 0)
+                    {
+                        return false; // empty
+                    }
+                else
+                    {
+                        pos = dequeue_pos.load(std::memory_order_relaxed);
+                    }
+            }
+        popped_value = c->data;
+        c->sequence.store(pos + the_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const
+    {
+        return enqueue_pos.load(std::memory_order_acquire) == dequeue_pos.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const
+    {
+        return the_mask + 1;
+    }
+
+    unsigned long long dropped_items() const
+    {
+        return dropped.load(std::memory_order_relaxed);
+    }
+};
+#endif
@@ -1,6 +1,6 @@
 /*!
  * \file concurrent_map.h
- * \brief Interface of a thread-safe std::map
+ * \brief Interface of a thread-safe std::map with read-copy-update snapshots
  * \author Javier Arribas, 2011. jarribas(at)cttc.es
  *
  * -------------------------------------------------------------------------
@@ -31,8 +31,10 @@
 #ifndef GNSS_SDR_CONCURRENT_MAP_H
 #define GNSS_SDR_CONCURRENT_MAP_H
 
+#include <atomic>
 #include <map>
 #include <utility>
+#include <boost/shared_ptr.hpp>
 #include <boost/thread/mutex.hpp>
 
 template<typename Data>
@@ -41,61 +43,94 @@ template<typename Data>
 /*!
  * \brief This class implements a thread-safe std::map
  *
+ * Writers publish a new immutable snapshot of the map (read-copy-update), so
+ * readers never take the mutex: get_map_snapshot() returns the current snapshot
+ * in O(1), and version() tells whether it has changed since the last read.
  */
 class concurrent_map
 {
-    typedef typename std::map<int,Data>::iterator Data_iterator; // iterator is scope dependent
+    typedef typename std::map<int,Data>::const_iterator Data_iterator; // iterator is scope dependent
 private:
-    std::map<int,Data> the_map;
-    boost::mutex the_mutex;
+    boost::shared_ptr<const std::map<int,Data> > the_map;
+    std::atomic<unsigned int> the_version;
+    boost::mutex the_mutex; // serializes the writers
 public:
+    concurrent_map() : the_map(new std::map<int,Data>()), the_version(0) {}
+
     void write(int key, Data const& data)
     {
         boost::mutex::scoped_lock lock(the_mutex);
-        Data_iterator data_iter;
-        data_iter = the_map.find(key);
-        if (data_iter != the_map.end())
-            {
-                data_iter->second = data; // update
-            }
-        else
-            {
-                the_map.insert(std::pair<int, Data>(key, data)); // insert SILENTLY fails if the item already exists in the map!
-            }
+        boost::shared_ptr<std::map<int,Data> > new_map(new std::map<int,Data>(*boost::atomic_load(&the_map)));
+        (*new_map)[key] = data; // insert or update
+        boost::atomic_store(&the_map, boost::shared_ptr<const std::map<int,Data> >(new_map));
+        the_version.fetch_add(1);
         lock.unlock();
     }
 
+    /*!
+     * \brief Current contents of the map. The snapshot never changes: later writes publish a new one.
+     */
+    boost::shared_ptr<const std::map<int,Data> > get_map_snapshot() const
+    {
+        return boost::atomic_load(&the_map);
+    }
+
+    /*!
+     * \brief Incremented by every write
+     */
+    unsigned int version() const
+    {
+        return the_version.load();
+    }
+
     std::map<int,Data> get_map_copy()
     {
-        boost::mutex::scoped_lock lock(the_mutex);
-        return the_map;
-        lock.unlock();
+        return *get_map_snapshot();
+    }
+
+    /*!
+     * \brief Copies the map into p_map only if it has been written since last_version, and updates last_version
+     */
+    bool get_map_copy_if_changed(unsigned int &last_version, std::map<int,Data> &p_map)
+    {
+        unsigned int current_version = version(); // read before the snapshot, so a concurrent write is not missed
+        if (current_version == last_version) return false;
+        p_map = *get_map_snapshot();
+        last_version = current_version;
+        return true;
     }
 
     int size()
     {
-        boost::mutex::scoped_lock lock(the_mutex);
-        return the_map.size();
-        lock.unlock();
+        return get_map_snapshot()->size();
     }
 
     bool read(int key, Data& p_data)
     {
-        boost::mutex::scoped_lock lock(the_mutex);
+        boost::shared_ptr<const std::map<int,Data> > snapshot = get_map_snapshot();
         Data_iterator data_iter;
-        data_iter = the_map.find(key);
-        if (data_iter != the_map.end())
+        data_iter = snapshot->find(key);
+        if (data_iter != snapshot->end())
             {
                 p_data = data_iter->second;
-                lock.unlock();
                 return true;
             }
         else
             {
-                lock.unlock();
                 return false;
             }
     }
+
+    /*!
+     * \brief Reads the key only if the map has been written since last_version, and updates last_version
+     */
+    bool read_if_changed(int key, unsigned int &last_version, Data& p_data)
+    {
+        unsigned int current_version = version();
+        if (current_version == last_version) return false;
+        last_version = current_version;
+        return read(key, p_data);
+    }
 };
 
 #endif
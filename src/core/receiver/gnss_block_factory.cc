@@ -45,6 +45,7 @@
 #include "pass_through.h"
 #include "file_signal_source.h"
 #include "nsr_file_signal_source.h"
+#include "nav_archive_signal_source.h"
 #include "null_sink_output_filter.h"
 #include "file_output_filter.h"
 #include "channel.h"
@@ -319,6 +320,12 @@ std::unique_ptr<GNSSBlockInterface> GNSSBlockFactory::GetBlock(
                     exit(1);
             }
         }
+    else if (implementation.compare("Nav_Archive_Signal_Source") == 0)
+        {
+            std::unique_ptr<GNSSBlockInterface> block_(new NavArchiveSignalSource(configuration.get(), role, in_streams,
+                    out_streams, queue));
+            block = std::move(block_);
+        }
     else if (implementation.compare("UHD_Signal_Source") == 0)
         {
             std::unique_ptr<GNSSBlockInterface> block_(new UhdSignalSource(configuration.get(), role, in_streams,
@@ -135,11 +135,18 @@ void GNSSFlowgraph::connect()
             return;
     }
 
+    // The navigation data archive replaces the signal processing up to the telemetry decoders:
+    // its source has one output per channel, connected directly to the observables block
+    bool replay = (sig_source_->implementation().compare("Nav_Archive_Signal_Source") == 0);
+
     // Signal Source > Signal conditioner >
     try
     {
             sig_conditioner_ = std::move(blocks_->at(1));
-            sig_conditioner_->connect(top_block_);
+            if (!replay)
+                {
+                    sig_conditioner_->connect(top_block_);
+                }
     }
     catch (std::exception& e)
     {
@@ -156,7 +163,10 @@ void GNSSFlowgraph::connect()
                     auto chan_ = std::move(blocks_->at(i + 5));
                     std::shared_ptr<ChannelInterface> chan = std::dynamic_pointer_cast<ChannelInterface>(chan_);
                     channels_.push_back(chan);
-                    channels_.at(i)->connect(top_block_);
+                    if (!replay)
+                        {
+                            channels_.at(i)->connect(top_block_);
+                        }
             }
             catch (std::exception& e)
             {
@@ -213,7 +223,11 @@ void GNSSFlowgraph::connect()
     // Signal Source >  Signal conditioner >
     try
     {
-            if(sig_source_->implementation().compare("Raw_Array_Signal_Source") == 0)
+            if (replay)
+                {
+                    LOG(INFO) << "Replaying the navigation data archive: signal conditioner and channels bypassed";
+                }
+            else if(sig_source_->implementation().compare("Raw_Array_Signal_Source") == 0)
                 {
                     //Multichannel Array
                     std::cout << "ARRAY MODE" << std::endl;
@@ -242,6 +256,23 @@ void GNSSFlowgraph::connect()
     // Signal Source > Signal conditioner >> channels_count_ number of Channels in parallel
     for (unsigned int i = 0; i < channels_count_; i++)
         {
+            if (replay)
+                {
+                    // Signal Source >> Observables
+                    try
+                    {
+                            top_block_->connect(sig_source_->get_right_block(), i,
+                                    observables_->get_left_block(), i);
+                    }
+                    catch (std::exception& e)
+                    {
+                            LOG(WARNING) << "Can't connect the navigation data archive channel " << i << " to observables";
+                            LOG(ERROR) << e.what();
+                            top_block_->disconnect_all();
+                            return;
+                    }
+                    continue;
+                }
             try
             {
                     top_block_->connect(sig_conditioner_->get_right_block(), 0,
@@ -0,0 +1,185 @@
+/*!
+ * \file receiver_status_bus.cc
+ * \brief Implementation of a receiver-wide, lock-free status and event channel
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include "receiver_status_bus.h"
+#include <iostream>
+#include <sstream>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <glog/logging.h>
+#include "gnss_satellite.h"
+
+using google::LogMessage;
+
+
+Receiver_Status_Bus& Receiver_Status_Bus::instance()
+{
+    static Receiver_Status_Bus bus;
+    return bus;
+}
+
+
+
+Receiver_Status_Bus::Receiver_Status_Bus() :
+        d_events(RECEIVER_STATUS_BUS_CAPACITY),
+        d_console(true),
+        d_stop(false)
+{
+    d_thread = boost::thread(&Receiver_Status_Bus::run, this);
+}
+
+
+
+Receiver_Status_Bus::~Receiver_Status_Bus()
+{
+    {
+        boost::mutex::scoped_lock lock(d_wakeup_mutex);
+        d_stop = true;
+    }
+    d_wakeup.notify_one();
+    d_thread.join();
+    flush();
+    if (d_events.dropped_items() > 0)
+        {
+            LOG(WARNING) << d_events.dropped_items() << " receiver status events were dropped";
+        }
+}
+
+
+
+void Receiver_Status_Bus::add_listener(listener l)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_listeners.push_back(l);
+}
+
+
+
+void Receiver_Status_Bus::set_console_output(bool enable)
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    d_console = enable;
+}
+
+
+
+void Receiver_Status_Bus::flush()
+{
+    boost::mutex::scoped_lock lock(d_mutex);
+    Receiver_Status_Event event;
+    while (d_events.try_pop(event))
+        {
+            dispatch(event);
+        }
+    std::cout << std::flush;
+}
+
+
+
+void Receiver_Status_Bus::run()
+{
+    const boost::posix_time::milliseconds period(RECEIVER_STATUS_BUS_PERIOD_MS);
+    while (true)
+        {
+            {
+                boost::mutex::scoped_lock lock(d_wakeup_mutex);
+                if (d_stop) break;
+                d_wakeup.timed_wait(lock, period);
+                if (d_stop) break;
+            }
+            if (!d_events.empty())
+                {
+                    flush();
+                }
+        }
+}
+
+
+
+void Receiver_Status_Bus::dispatch(const Receiver_Status_Event& event)
+{
+    report(event);
+    for (unsigned int i = 0; i < d_listeners.size(); i++)
+        {
+            d_listeners.at(i)(event);
+        }
+}
+
+
+
+std::string Receiver_Status_Bus::satellite_name(const Receiver_Status_Event& event)
+{
+    std::string system;
+    switch (event.System)
+    {
+    case 'G': system = "GPS"; break;
+    case 'R': system = "GLONASS"; break;
+    case 'S': system = "SBAS"; break;
+    case 'E': system = "Galileo"; break;
+    case 'C': system = "Compass"; break;
+    default: system = "";
+    }
+    std::stringstream sat;
+    sat << Gnss_Satellite(system, event.PRN);
+    return sat.str();
+}
+
+
+
+void Receiver_Status_Bus::report(const Receiver_Status_Event& event)
+{
+    switch (event.type)
+    {
+    case STATUS_TRACKING_START:
+        if (d_console)
+            {
+                std::cout << "Tracking start on channel " << event.channel << " for satellite " << satellite_name(event) << std::endl;
+            }
+        LOG(INFO) << "Starting tracking of satellite " << satellite_name(event) << " on channel " << event.channel;
+        break;
+    case STATUS_LOSS_OF_LOCK:
+        if (d_console)
+            {
+                std::cout << "Loss of lock in channel " << event.channel << "!" << std::endl;
+            }
+        LOG(INFO) << "Loss of lock in channel " << event.channel << "!";
+        break;
+    case STATUS_CN0_UPDATE:
+        LOG(INFO) << "Tracking CH " << event.channel << ": Satellite " << satellite_name(event)
+                  << ", CN0 = " << event.value << " [dB-Hz]";
+        break;
+    case STATUS_SIGNAL_TIME:
+        if (d_console)
+            {
+                std::cout << "Current input signal time = " << event.value << " [s]" << std::endl;
+            }
+        break;
+    default:
+        LOG(WARNING) << "Unknown receiver status event type " << event.type;
+    }
+}
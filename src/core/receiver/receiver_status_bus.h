@@ -0,0 +1,138 @@
+/*!
+ * \file receiver_status_bus.h
+ * \brief Interface of a receiver-wide, lock-free status and event channel
+ *
+ * Signal processing blocks post small fixed-size events (loss of lock,
+ * C/N0 updates, input signal time, ...) that are consumed by a single
+ * reporter thread, which prints them on the console, writes them to the
+ * log and forwards them to any registered monitor. Posting an event never
+ * blocks nor allocates, so no console I/O is done inside general_work.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_RECEIVER_STATUS_BUS_H_
+#define GNSS_SDR_RECEIVER_STATUS_BUS_H_
+
+#include <string>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include "concurrent_bounded_queue.h"
+
+#define RECEIVER_STATUS_BUS_CAPACITY 4096
+#define RECEIVER_STATUS_BUS_PERIOD_MS 10
+
+/*!
+ * \brief Types of the events carried by the Receiver_Status_Bus
+ */
+enum Receiver_Status_Event_Type
+{
+    STATUS_TRACKING_START = 0,  //!< A channel starts tracking a satellite
+    STATUS_LOSS_OF_LOCK = 1,    //!< A channel lost the carrier lock
+    STATUS_CN0_UPDATE = 2,      //!< Periodic C/N0 report of a channel, value in [dB-Hz]
+    STATUS_SIGNAL_TIME = 3      //!< Current input signal time, value in [s]
+};
+
+/*!
+ * \brief Fixed-size event posted by the signal processing blocks
+ */
+struct Receiver_Status_Event
+{
+    int type;                //!< One of Receiver_Status_Event_Type
+    unsigned int channel;    //!< Receiver channel that generated the event
+    char System;             //!< Satellite system ('G', 'E', 'S', ...)
+    unsigned int PRN;        //!< Satellite PRN
+    double value;            //!< Event value (C/N0, time, ...)
+};
+
+
+/*!
+ * \brief Receiver-wide event bus with a single reporter thread
+ */
+class Receiver_Status_Bus
+{
+public:
+    typedef boost::function<void (const Receiver_Status_Event&)> listener;
+
+    static Receiver_Status_Bus& instance();
+    ~Receiver_Status_Bus();
+
+    /*!
+     * \brief Posts an event. Lock-free; returns false (and counts it) if the bus is full.
+     */
+    bool post(const Receiver_Status_Event& event)
+    {
+        return d_events.try_push(event);
+    }
+
+    bool post(int type, unsigned int channel, char system, unsigned int prn, double value)
+    {
+        Receiver_Status_Event event;
+        event.type = type;
+        event.channel = channel;
+        event.System = system;
+        event.PRN = prn;
+        event.value = value;
+        return d_events.try_push(event);
+    }
+
+    /*!
+     * \brief Registers an external monitor, called from the reporter thread for every event
+     */
+    void add_listener(listener l);
+
+    /*!
+     * \brief Enables or disables the console output (enabled by default)
+     */
+    void set_console_output(bool enable);
+
+    /*!
+     * \brief Processes all the pending events in the calling thread
+     */
+    void flush();
+
+    unsigned long long dropped_events() const { return d_events.dropped_items(); }
+
+private:
+    Receiver_Status_Bus();
+    void run();
+    void dispatch(const Receiver_Status_Event& event);
+    void report(const Receiver_Status_Event& event);
+    std::string satellite_name(const Receiver_Status_Event& event);
+
+    concurrent_bounded_queue<Receiver_Status_Event> d_events;
+    std::vector<listener> d_listeners;
+    boost::mutex d_mutex; // protects d_listeners, d_console and the consumer side of d_events
+    boost::mutex d_wakeup_mutex;
+    boost::condition_variable d_wakeup;
+    bool d_console;
+    bool d_stop;
+    boost::thread d_thread;
+};
+
+#endif
@@ -0,0 +1,54 @@
+/*!
+ * \file crc24q.h
+ * \brief Table-driven CRC-24Q (Qualcomm) checksum
+ *
+ * CRC-24Q (generator polynomial 0x1864CFB, initial value 0, no reflection,
+ * no final XOR) protects the Galileo I/NAV pages, the SBAS L1 messages and
+ * the RTCM 3 frames. The checksum is processed one byte at a time with a
+ * 256-entry table. Messages whose length is not a multiple of 8 bits must be
+ * padded with zeros at the start, which does not change the checksum.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef GNSS_SDR_CRC24Q_H_
+#define GNSS_SDR_CRC24Q_H_
+
+#include <boost/cstdint.hpp>
+
+/*!
+ * \brief Continues a CRC-24Q computation with length more bytes
+ */
+boost::uint32_t crc24q_update(boost::uint32_t crc, const unsigned char *bytes, unsigned int length);
+
+/*!
+ * \brief Returns the CRC-24Q checksum of length bytes
+ */
+inline boost::uint32_t crc24q(const unsigned char *bytes, unsigned int length)
+{
+    return crc24q_update(0, bytes, length);
+}
+
+#endif /* GNSS_SDR_CRC24Q_H_ */
@@ -32,20 +32,19 @@
 
 #include "galileo_navigation_message.h"
 #include <boost/date_time/posix_time/posix_time.hpp>
-#include <boost/crc.hpp>      // for boost::crc_basic, boost::crc_optimal
-#include <boost/dynamic_bitset.hpp>
 #include <glog/logging.h>
 #include <iostream>
 #include <cstring>
 #include <string>
-
-typedef boost::crc_optimal<24, 0x1864CFBu, 0x0, 0x0, false, false> CRC_Galileo_INAV_type;
+#include "crc24q.h"
 
 
 void Galileo_Navigation_Message::reset()
 {
     flag_even_word = 0;
     Page_type_time_stamp = 0;
+    d_page_even[0] = 0;
+    d_page_even[1] = 0;
 
     flag_CRC_test = false;
     flag_all_ephemeris = false;  // flag indicating that all words containing ephemeris have been received
@@ -209,26 +208,55 @@ Galileo_Navigation_Message::Galileo_Navigation_Message()
 }
 
 
-bool Galileo_Navigation_Message::CRC_test(std::bitset<GALILEO_DATA_FRAME_BITS> bits,boost::uint32_t checksum)
+namespace
 {
-    CRC_Galileo_INAV_type CRC_Galileo;
-
-    boost::uint32_t crc_computed;
-    // Galileo INAV frame for CRC is not an integer multiple of bytes
-    // it needs to be filled with zeroes at the start of the frame.
-    // This operation is done in the transformation from bits to bytes
-    // using boost::dynamic_bitset.
-    // ToDo: Use boost::dynamic_bitset for all the bitset operations in this class
+/*
+ * Returns length (<= 64) bits of a packed bit array, starting at bit first (0-based).
+ * Bit 0 is the most significant bit of words[0].
+ */
+inline boost::uint64_t read_bits(const boost::uint64_t *words, int first, int length)
+{
+    const int word = first / 64;
+    const int offset = first % 64;
+    boost::uint64_t value = words[word] << offset;
+    if (offset + length > 64)
+        {
+            value |= words[word + 1] >> (64 - offset);
+        }
+    return length == 64 ? value : value >> (64 - length);
+}
 
-    boost::dynamic_bitset<unsigned char> frame_bits(std::string(bits.to_string()));
+/*
+ * Packs n bits (one int per bit) in words, starting at bit first (0-based). The words must be cleared.
+ */
+inline void pack_bits(const int *bits, int n, boost::uint64_t *words, int first)
+{
+    for (int i = 0; i < n; i++)
+        {
+            if (bits[i] > 0)
+                {
+                    const int pos = first + i;
+                    words[pos / 64] |= 1ULL << (63 - pos % 64);
+                }
+        }
+}
+}
 
-    std::vector<unsigned char> bytes;
-    boost::to_block_range(frame_bits, std::back_inserter(bytes));
-    std::reverse(bytes.begin(),bytes.end());
 
-    CRC_Galileo.process_bytes( bytes.data(), GALILEO_DATA_FRAME_BYTES );
+bool Galileo_Navigation_Message::CRC_test(const boost::uint64_t *page_bits)
+{
+    // Galileo INAV frame for CRC is not an integer multiple of bytes
+    // it needs to be filled with zeroes at the start of the frame.
+    const int pad_bits = GALILEO_DATA_FRAME_BYTES * 8 - GALILEO_DATA_FRAME_BITS;
+    unsigned char bytes[GALILEO_DATA_FRAME_BYTES];
+    bytes[0] = (unsigned char)read_bits(page_bits, 0, 8 - pad_bits);
+    for (int i = 1; i < GALILEO_DATA_FRAME_BYTES; i++)
+        {
+            bytes[i] = (unsigned char)read_bits(page_bits, 8 * i - pad_bits, 8);
+        }
 
-    crc_computed = CRC_Galileo.checksum();
+    boost::uint32_t crc_computed = crc24q(bytes, GALILEO_DATA_FRAME_BYTES);
+    boost::uint32_t checksum = (boost::uint32_t)read_bits(page_bits, GALILEO_DATA_FRAME_BITS, 24);
     if (checksum == crc_computed)
         {
             return true;
@@ -240,184 +268,61 @@ bool Galileo_Navigation_Message::CRC_test(std::bitset<GALILEO_DATA_FRAME_BITS> b
 }
 
 
-unsigned long int Galileo_Navigation_Message::read_navigation_unsigned(std::bitset<GALILEO_DATA_JK_BITS> bits, const std::vector<std::pair<int,int> > parameter)
+unsigned long int Galileo_Navigation_Message::read_navigation_unsigned(const boost::uint64_t *data_jk_bits, const Galileo_Inav_Field &parameter)
 {
-    unsigned long int value = 0;
-    int num_of_slices = parameter.size();
-    for (int i = 0; i < num_of_slices; i++)
-        {
-            for (int j = 0; j < parameter[i].second; j++)
-                {
-                    value <<= 1; //shift left
-                    if (bits[GALILEO_DATA_JK_BITS - parameter[i].first - j] == 1)
-                        {
-                            value += 1; // insert the bit
-                        }
-                }
-        }
-    return value;
+    return (unsigned long int)read_bits(data_jk_bits, parameter.first - 1, parameter.length);
 }
 
 
 
-unsigned long int Galileo_Navigation_Message::read_page_type_unsigned(std::bitset<GALILEO_PAGE_TYPE_BITS> bits, const std::vector<std::pair<int,int> > parameter)
+signed long int Galileo_Navigation_Message::read_navigation_signed(const boost::uint64_t *data_jk_bits, const Galileo_Inav_Field &parameter)
 {
-    unsigned long int value = 0;
-    int num_of_slices = parameter.size();
-    for (int i = 0; i < num_of_slices; i++)
-        {
-            for (int j = 0; j < parameter[i].second; j++)
-                {
-                    value <<= 1; //shift left
-                    if (bits[GALILEO_PAGE_TYPE_BITS - parameter[i].first - j] == 1)
-                        {
-                            value += 1; // insert the bit
-                        }
-                }
-        }
-    return value;
-}
-
-
-
-signed long int Galileo_Navigation_Message::read_navigation_signed(std::bitset<GALILEO_DATA_JK_BITS> bits, const std::vector<std::pair<int,int> > parameter)
-{
-    signed long int value = 0;
-    int num_of_slices = parameter.size();
-    // Discriminate between 64 bits and 32 bits compiler
-    int long_int_size_bytes = sizeof(signed long int);
-    if (long_int_size_bytes == 8) // if a long int takes 8 bytes, we are in a 64 bits system
-        {
-            // read the MSB and perform the sign extension
-            if (bits[GALILEO_DATA_JK_BITS - parameter[0].first] == 1)
-                {
-                    value ^= 0xFFFFFFFFFFFFFFFF; //64 bits variable
-                }
-            else
-                {
-                    value &= 0;
-                }
-
-            for (int i = 0; i < num_of_slices; i++)
-                {
-                    for (int j = 0; j < parameter[i].second; j++)
-                        {
-                            value <<= 1; //shift left
-                            value &= 0xFFFFFFFFFFFFFFFE; //reset the corresponding bit (for the 64 bits variable)
-                            if (bits[GALILEO_DATA_JK_BITS - parameter[i].first - j] == 1)
-                                {
-                                    value += 1; // insert the bit
-                                }
-                        }
-                }
-        }
-    else  // we assume we are in a 32 bits system
+    boost::uint64_t value = read_bits(data_jk_bits, parameter.first - 1, parameter.length);
+    // perform the sign extension from the MSB of the field
+    if (parameter.length < 64 && ((value >> (parameter.length - 1)) & 1ULL))
         {
-            // read the MSB and perform the sign extension
-            if (bits[GALILEO_DATA_JK_BITS - parameter[0].first] == 1)
-                {
-                    value ^= 0xFFFFFFFF;
-                }
-            else
-                {
-                    value &= 0;
-                }
-
-            for (int i = 0; i < num_of_slices; i++)
-                {
-                    for (int j = 0; j < parameter[i].second; j++)
-                        {
-                            value <<= 1; //shift left
-                            value &= 0xFFFFFFFE; //reset the corresponding bit
-                            if (bits[GALILEO_DATA_JK_BITS - parameter[i].first - j] == 1)
-                                {
-                                    value += 1; // insert the bit
-                                }
-                        }
-                }
+            value |= ~0ULL << parameter.length;
         }
-    return value;
+    return (signed long int)(boost::int64_t)value;
 }
 
 
-bool Galileo_Navigation_Message::read_navigation_bool(std::bitset<GALILEO_DATA_JK_BITS> bits, const std::vector<std::pair<int,int> > parameter)
+bool Galileo_Navigation_Message::read_navigation_bool(const boost::uint64_t *data_jk_bits, const Galileo_Inav_Field &parameter)
 {
-    bool value;
-    if (bits[GALILEO_DATA_JK_BITS - parameter[0].first] == 1)
-        {
-            value = true;
-        }
-    else
-        {
-            value = false;
-        }
-    return value;
+    return read_bits(data_jk_bits, parameter.first - 1, 1) == 1;
 }
 
 
 
 
-void Galileo_Navigation_Message::split_page(std::string page_string, int flag_even_word)
+void Galileo_Navigation_Message::split_page(const int *page_part_bits, int flag_even_word)
 {
-    // ToDo: Clean all the tests and create an independent google test code for the telemetry decoder.
-    //char correct_tail[7]="011110"; //the viterbi decoder output change the tail to this value (why?)
-    //char correct_tail[7]="000000";
-
+    // Page layout (ICD 4.3.2.3), bits counted from the start of the even page part:
+    // Even (1) | Page type (1) | Data_k (112) | Odd (1) | Page type (1) | Data_j (16) | Reserved 1 (40) |
+    // SAR (22) | Spare (2) | CRC (24) | Reserved 2 (8) | Tail (6)
+    const int even_bits = GALILEO_INAV_PAGE_PART_BITS - 6; // the tail of the even part is not kept
     int Page_type = 0;
-    //std::cout << "Start decoding Galileo I/NAV " << std::endl;
 
-    if(page_string.at(0) == '1')// if page is odd
+    if (page_part_bits[0] > 0) // if page is odd
         {
-            //std::cout<< "page_string.at(0) split page="<<page_string.at(0) << std::endl;
-            std::string page_Odd = page_string;
-            //std::cout<<"Page odd string in split page"<< std::endl << page_Odd << std::endl;
-
             if (flag_even_word == 1) // An odd page has been received but the previous even page is kept in memory and it is considered to join pages
                 {
-                    std::string page_INAV_even = page_Even;
-                    std::string page_INAV = page_INAV_even + page_Odd; // Join pages: Even + Odd = INAV page
-                    std::string Even_bit = page_INAV.substr (0,1);
-                    std::string Page_type_even = page_INAV.substr (1,1);
-                    std::string nominal = "0";
-
-                    //if (Page_type_even.compare(nominal) != 0)
-                    //		std::cout << "Alert frame "<< std::endl;
-                    //else std::cout << "Nominal Page" << std::endl;
-
-                    std::string Data_k = page_INAV.substr (2,112);
-                    std::string Odd_bit = page_INAV.substr (114,1);
-                    std::string Page_type_Odd = page_INAV.substr (115,1);
-                    std::string Data_j = page_INAV.substr (116,16);
-
-                    std::string Reserved_1 = page_INAV.substr (132,40);
-                    std::string SAR = page_INAV.substr (172,22);
-                    std::string Spare = page_INAV.substr (194,2);
-                    std::string CRC_data = page_INAV.substr (196,24);
-                    std::string Reserved_2 = page_INAV.substr (220,8);
-                    std::string Tail_odd = page_INAV.substr (228,6);
+                    // Join pages: Even + Odd = INAV page
+                    boost::uint64_t page_INAV[4] = {d_page_even[0], d_page_even[1], 0, 0};
+                    pack_bits(page_part_bits, GALILEO_INAV_PAGE_PART_BITS, page_INAV, even_bits);
 
                     //************ CRC checksum control *******/
-                    std::stringstream TLM_word_for_CRC_stream;
-                    TLM_word_for_CRC_stream << page_INAV;
-                    std::string TLM_word_for_CRC;
-                    TLM_word_for_CRC = TLM_word_for_CRC_stream.str().substr(0, GALILEO_DATA_FRAME_BITS);
-                    std::bitset<GALILEO_DATA_FRAME_BITS> TLM_word_for_CRC_bits(TLM_word_for_CRC);
-                    std::bitset<24> checksum(CRC_data);
-
-                    //if (Tail_odd.compare(correct_tail) != 0)
-                    //		std::cout << "Tail odd is not correct!" << std::endl;
-                    //else std::cout<<"Tail odd is correct!"<<std::endl;
-
-                    if (CRC_test(TLM_word_for_CRC_bits, checksum.to_ulong()) == true)
+                    if (CRC_test(page_INAV) == true)
                         {
                             flag_CRC_test = true;
                             // CRC correct: Decode word
-                            std::string page_number_bits = Data_k.substr (0,6);
-                            std::bitset<GALILEO_PAGE_TYPE_BITS> page_type_bits (page_number_bits); // from string to bitset
-                            Page_type = (int)read_page_type_unsigned(page_type_bits, type);
+                            // Data_jk = Data_k (bits 2 to 113) + Data_j (bits 116 to 131)
+                            boost::uint64_t data_jk_bits[2];
+                            data_jk_bits[0] = read_bits(page_INAV, 2, 64);
+                            data_jk_bits[1] = (read_bits(page_INAV, 66, 48) << 16) | read_bits(page_INAV, 116, 16);
+                            Page_type = (int)read_navigation_unsigned(data_jk_bits, type);
                             Page_type_time_stamp = Page_type;
-                            std::string Data_jk_ephemeris = Data_k + Data_j;
-                            page_jk_decoder(Data_jk_ephemeris.c_str());
+                            page_jk_decoder(data_jk_bits);
                         }
                     else
                         {
@@ -425,19 +330,30 @@ void Galileo_Navigation_Message::split_page(std::string page_string, int flag_ev
                             flag_CRC_test = false;
                         }
                 } // end of CRC checksum control
-        } // end if (page_string.at(0)=='1')
+        } // end if page is odd
     else
         {
-            page_Even = page_string.substr (0,114);
-            std::string tail_Even =  page_string.substr (114,6);
-            //std::cout << "tail_even_string: " << tail_Even <<std::endl;
-            //if (tail_Even.compare(correct_tail) != 0)
-            //	 std::cout << "Tail even is not correct!" << std::endl;
-            //else std::cout<<"Tail even is correct!"<< std::endl;
+            d_page_even[0] = 0;
+            d_page_even[1] = 0;
+            pack_bits(page_part_bits, even_bits, d_page_even, 0);
         }
 }
 
 
+
+void Galileo_Navigation_Message::split_page(const std::string &page_string, int flag_even_word)
+{
+    int page_part_bits[GALILEO_INAV_PAGE_PART_BITS] = {0};
+    const int n = std::min((int)page_string.length(), GALILEO_INAV_PAGE_PART_BITS);
+    for (int i = 0; i < n; i++)
+        {
+            page_part_bits[i] = page_string[i] == '1' ? 1 : 0;
+        }
+    split_page(page_part_bits, flag_even_word);
+}
+
+
+
 bool Galileo_Navigation_Message::have_new_ephemeris() //Check if we have a new ephemeris stored in the galileo navigation class
 {
     if ((flag_ephemeris_1 == true) and (flag_ephemeris_2 == true) and (flag_ephemeris_3 == true) and (flag_ephemeris_4 == true) and (flag_iono_and_GST == true))
@@ -648,11 +564,21 @@ Galileo_Almanac Galileo_Navigation_Message::get_almanac()
 
 int Galileo_Navigation_Message::page_jk_decoder(const char *data_jk)
 {
-    int page_number = 0;
+    int data_jk_int[GALILEO_DATA_JK_BITS];
+    for (int i = 0; i < GALILEO_DATA_JK_BITS; i++)
+        {
+            data_jk_int[i] = data_jk[i] == '1' ? 1 : 0;
+        }
+    boost::uint64_t data_jk_bits[2] = {0, 0};
+    pack_bits(data_jk_int, GALILEO_DATA_JK_BITS, data_jk_bits, 0);
+    return page_jk_decoder(data_jk_bits);
+}
+
+
 
-    std::string data_jk_string = data_jk;
-    std::bitset<GALILEO_DATA_JK_BITS> data_jk_bits (data_jk_string);
-    //DLOG(INFO) << "Data_jk_bits (bitset)  "<< endl << data_jk_bits << endl;
+int Galileo_Navigation_Message::page_jk_decoder(const boost::uint64_t *data_jk_bits)
+{
+    int page_number = 0;
 
     page_number = (int)read_navigation_unsigned(data_jk_bits, PAGE_TYPE_bit);
     LOG(INFO) << "Page number = " << page_number;
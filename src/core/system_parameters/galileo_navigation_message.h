@@ -56,16 +56,17 @@
 class Galileo_Navigation_Message
 {
 private:
-    bool CRC_test(std::bitset<GALILEO_DATA_FRAME_BITS> bits, boost::uint32_t checksum);
-    bool read_navigation_bool(std::bitset<GALILEO_DATA_JK_BITS> bits, const std::vector<std::pair<int,int> > parameter);
+    bool CRC_test(const boost::uint64_t *page_bits);
+    bool read_navigation_bool(const boost::uint64_t *data_jk_bits, const Galileo_Inav_Field &parameter);
     //void print_galileo_word_bytes(unsigned int GPS_word);
-    unsigned long int read_navigation_unsigned(std::bitset<GALILEO_DATA_JK_BITS> bits, const std::vector< std::pair<int,int> > parameter);
-    unsigned long int read_page_type_unsigned(std::bitset<GALILEO_PAGE_TYPE_BITS> bits, const std::vector< std::pair<int,int> > parameter);
-    signed long int read_navigation_signed(std::bitset<GALILEO_DATA_JK_BITS> bits, const std::vector<std::pair<int,int> > parameter);
+    unsigned long int read_navigation_unsigned(const boost::uint64_t *data_jk_bits, const Galileo_Inav_Field &parameter);
+    signed long int read_navigation_signed(const boost::uint64_t *data_jk_bits, const Galileo_Inav_Field &parameter);
+    int page_jk_decoder(const boost::uint64_t *data_jk_bits);
+
+    boost::uint64_t d_page_even[2];     // even page part (first 114 bits, MSB first)
 public:
     int Page_type_time_stamp;
     int flag_even_word;
-    std::string page_Even;
     bool flag_CRC_test;
     bool flag_all_ephemeris;  //!< Flag indicating that all words containing ephemeris have been received
     bool flag_ephemeris_1;    //!< Flag indicating that ephemeris 1/4 (word 1) have been received
@@ -233,13 +234,21 @@ public:
 
     /*
      * \brief Takes in input a page (Odd or Even) of 120 bit, split it according ICD 4.3.2.3 and join Data_k with Data_j
+     *
+     * The bits are read from the decoded page part (one int per bit, as delivered by the Viterbi decoder)
+     * and packed in 64-bit words, so the page is parsed without string copies.
+     */
+    void split_page(const int *page_part_bits, int flag_even_word);
+
+    /*
+     * \brief Same as above, with the page given as a string of '0' and '1' characters
      */
-    void split_page(std::string page_string, int flag_even_word);
+    void split_page(const std::string &page_string, int flag_even_word);
 
     /*
      * \brief Takes in input Data_jk (128 bit) and split it in ephemeris parameters according ICD 4.3.5
      *
-     * Takes in input Data_jk (128 bit) and split it in ephemeris parameters according ICD 4.3.5
+     * Takes in input Data_jk (128 bit, as a string of '0' and '1' characters) and split it in ephemeris parameters according ICD 4.3.5
      */
     int page_jk_decoder(const char *data_jk);
 
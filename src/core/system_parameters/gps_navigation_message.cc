@@ -193,37 +193,31 @@ void Gps_Navigation_Message::print_gps_word_bytes(unsigned int GPS_word)
 
 
 
-bool Gps_Navigation_Message::read_navigation_bool(std::bitset<GPS_SUBFRAME_BITS> bits, const std::vector<std::pair<int,int>> parameter)
+bool Gps_Navigation_Message::read_navigation_bool(const unsigned int *subframe_words, const Gps_Navigation_Field &parameter)
 {
-    bool value;
-
-    if (bits[GPS_SUBFRAME_BITS - parameter[0].first] == 1)
-        {
-            value = true;
-        }
-    else
-        {
-            value = false;
-        }
-    return value;
+    const int first = parameter.slices[0].first - 1;
+    return ((subframe_words[first / GPS_WORD_BITS] >> (GPS_WORD_BITS - 1 - first % GPS_WORD_BITS)) & 1) == 1;
 }
 
 
 
 
-unsigned long int Gps_Navigation_Message::read_navigation_unsigned(std::bitset<GPS_SUBFRAME_BITS> bits, const std::vector<std::pair<int,int>> parameter)
+unsigned long int Gps_Navigation_Message::read_navigation_unsigned(const unsigned int *subframe_words, const Gps_Navigation_Field &parameter)
 {
     unsigned long int value = 0;
-    int num_of_slices = parameter.size();
-    for (int i=0; i<num_of_slices; i++)
+    for (int i = 0; i < parameter.num_slices; i++)
         {
-            for (int j=0; j<parameter[i].second; j++)
+            int first = parameter.slices[i].first - 1;
+            int length = parameter.slices[i].length;
+            // the slices do not cross word boundaries in the ICD, but split them anyway
+            while (length > 0)
                 {
-                    value <<= 1; //shift left
-                    if (bits[GPS_SUBFRAME_BITS - parameter[i].first - j] == 1)
-                        {
-                            value += 1; // insert the bit
-                        }
+                    const int offset = first % GPS_WORD_BITS;
+                    const int n = std::min(length, GPS_WORD_BITS - offset);
+                    const unsigned long int bits = subframe_words[first / GPS_WORD_BITS] >> (GPS_WORD_BITS - offset - n);
+                    value = (value << n) | (bits & ((1UL << n) - 1));
+                    first += n;
+                    length -= n;
                 }
         }
     return value;
@@ -233,63 +227,22 @@ unsigned long int Gps_Navigation_Message::read_navigation_unsigned(std::bitset<G
 
 
 
-signed long int Gps_Navigation_Message::read_navigation_signed(std::bitset<GPS_SUBFRAME_BITS> bits, const std::vector<std::pair<int,int>> parameter)
+signed long int Gps_Navigation_Message::read_navigation_signed(const unsigned int *subframe_words, const Gps_Navigation_Field &parameter)
 {
-    signed long int value = 0;
-    int num_of_slices = parameter.size();
-    // Discriminate between 64 bits and 32 bits compiler
-    int long_int_size_bytes = sizeof(signed long int);
-    if (long_int_size_bytes == 8) // if a long int takes 8 bytes, we are in a 64 bits system
+    int length = 0;
+    for (int i = 0; i < parameter.num_slices; i++)
         {
-            // read the MSB and perform the sign extension
-            if (bits[GPS_SUBFRAME_BITS - parameter[0].first] == 1)
-                {
-                    value ^= 0xFFFFFFFFFFFFFFFF; //64 bits variable
-                }
-            else
-                {
-                    value &= 0;
-                }
-
-            for (int i=0; i<num_of_slices; i++)
-                {
-                    for (int j=0; j<parameter[i].second; j++)
-                        {
-                            value <<= 1; //shift left
-                            value &= 0xFFFFFFFFFFFFFFFE; //reset the corresponding bit (for the 64 bits variable)
-                            if (bits[GPS_SUBFRAME_BITS - parameter[i].first - j] == 1)
-                                {
-                                    value += 1; // insert the bit
-                                }
-                        }
-                }
+            length += parameter.slices[i].length;
         }
-    else  // we assume we are in a 32 bits system
+    unsigned long int value = read_navigation_unsigned(subframe_words, parameter);
+    // perform the sign extension from the MSB of the first slice. A field as
+    // wide as unsigned long (32 bits with a 32 bits compiler) is already
+    // complete, and shifting by the type width is undefined
+    if (length < (int)(sizeof(unsigned long int) * 8) and ((value >> (length - 1)) & 1UL))
         {
-            // read the MSB and perform the sign extension
-            if (bits[GPS_SUBFRAME_BITS - parameter[0].first] == 1)
-                {
-                    value ^= 0xFFFFFFFF;
-                }
-            else
-                {
-                    value &= 0;
-                }
-
-            for (int i=0; i<num_of_slices; i++)
-                {
-                    for (int j=0; j<parameter[i].second; j++)
-                        {
-                            value <<= 1; //shift left
-                            value &= 0xFFFFFFFE; //reset the corresponding bit
-                            if (bits[GPS_SUBFRAME_BITS - parameter[i].first - j] == 1)
-                                {
-                                    value += 1; // insert the bit
-                                }
-                        }
-                }
+            value |= ~0UL << length;
         }
-    return value;
+    return (signed long int)value;
 }
 
 
@@ -434,19 +387,12 @@ int Gps_Navigation_Message::subframe_decoder(char *subframe)
     int SV_page = 0;
     //double tmp_TOW;
 
-    unsigned int gps_word;
-
-    // UNPACK BYTES TO BITS AND REMOVE THE CRC REDUNDANCE
-    std::bitset<GPS_SUBFRAME_BITS> subframe_bits;
-    std::bitset<GPS_WORD_BITS+2> word_bits;
-    for (int i=0; i<10; i++)
+    // UNPACK THE WORDS AND REMOVE THE TWO MSB (D29* AND D30* OF THE PREVIOUS WORD)
+    unsigned int subframe_bits[GPS_SUBFRAME_BITS / GPS_WORD_BITS];
+    memcpy(subframe_bits, subframe, sizeof(subframe_bits));
+    for (int i = 0; i < GPS_SUBFRAME_BITS / GPS_WORD_BITS; i++)
         {
-            memcpy(&gps_word, &subframe[i*4], sizeof(char)*4);
-            word_bits = std::bitset<(GPS_WORD_BITS+2)>(gps_word);
-            for (int j=0; j<GPS_WORD_BITS; j++)
-                {
-                    subframe_bits[GPS_WORD_BITS*(9-i) + j] = word_bits[j];
-                }
+            subframe_bits[i] &= (1U << GPS_WORD_BITS) - 1;
         }
 
     subframe_ID = (int)read_navigation_unsigned(subframe_bits, SUBFRAME_ID);
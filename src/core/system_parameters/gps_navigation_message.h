@@ -57,9 +57,9 @@
 class Gps_Navigation_Message
 {
 private:
-    unsigned long int read_navigation_unsigned(std::bitset<GPS_SUBFRAME_BITS> bits, const std::vector<std::pair<int,int>> parameter);
-    signed long int read_navigation_signed(std::bitset<GPS_SUBFRAME_BITS> bits, const std::vector<std::pair<int,int>> parameter);
-    bool read_navigation_bool(std::bitset<GPS_SUBFRAME_BITS> bits, const std::vector<std::pair<int,int>> parameter);
+    unsigned long int read_navigation_unsigned(const unsigned int *subframe_words, const Gps_Navigation_Field &parameter);
+    signed long int read_navigation_signed(const unsigned int *subframe_words, const Gps_Navigation_Field &parameter);
+    bool read_navigation_bool(const unsigned int *subframe_words, const Gps_Navigation_Field &parameter);
     void print_gps_word_bytes(unsigned int GPS_word);
     /*
      * Accounts for the beginning or end of week crossover
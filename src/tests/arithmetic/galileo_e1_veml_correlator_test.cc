@@ -0,0 +1,176 @@
+/*!
+ * \file galileo_e1_veml_correlator_test.cc
+ * \brief This file implements tests for the Galileo E1 Very Early, Early,
+ * Prompt, Late and Very Late correlation read from the code table
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <gnuradio/gr_complex.h>
+#include "correlator.h"
+#include "Galileo_E1.h"
+#include "galileo_e1_signal_processing.h"
+
+
+/*
+ * Code table with head and tail, as in the VEML tracking block
+ */
+void galileo_e1_veml_test_code_table(gr_complex* ca_code, int prn)
+{
+    const int code_length_half_chips = (int)(2*Galileo_E1_B_CODE_LENGTH_CHIPS);
+    char signal[3] = "1B";
+    galileo_e1_code_gen_complex_sampled(&ca_code[2], signal, false, prn, 2*Galileo_E1_CODE_CHIP_RATE_HZ, 0);
+    ca_code[0] = ca_code[code_length_half_chips];
+    ca_code[1] = ca_code[code_length_half_chips + 1];
+    ca_code[code_length_half_chips + 2] = ca_code[2];
+    ca_code[code_length_half_chips + 3] = ca_code[3];
+}
+
+
+TEST(Galileo_E1_Veml_Correlator_Test, KnownOutputs)
+{
+    const int code_length_half_chips = (int)(2*Galileo_E1_B_CODE_LENGTH_CHIPS);
+    // PRN, sampling frequency, early-late and very early-late spacings, code frequency,
+    // remnant code phase in samples, input code delay in half chips and residual carrier
+    const int prn[3] = {1, 11, 36};
+    const long fs_in[3] = {4000000, 6500000, 8000000};
+    const double spc_chips[3][2] = {{0.15, 0.6}, {0.5, 1.0}, {0.15, 0.6}};
+    const double code_freq_chips[3] = {Galileo_E1_CODE_CHIP_RATE_HZ * (1 + 2e-6), Galileo_E1_CODE_CHIP_RATE_HZ * (1 - 3e-6), Galileo_E1_CODE_CHIP_RATE_HZ};
+    const float rem_code_phase_samples[3] = {0.3, -0.4, 0.1};
+    const double delay_half_chips[3] = {0.4, 1.3, 7.8};
+    const double carrier_rad_per_sample[3] = {0.002, -0.001, 0.0};
+    // VE, E, P, L and VL correlation with the replicas generated by the previous
+    // update_local_code(), accumulated in double precision
+    const gr_complex expected[3][5] = {
+            {{-5207.575, -2844.911}, {-1598.955, -873.513}, {9174.248, 5011.915}, {8135.190, 4444.275}, {-2638.013, -1441.153}},
+            {{1.755, 0.959}, {-3168.073, -1730.726}, {-4017.573, -2194.810}, {17332.256, 9468.654}, {-10150.120, -5545.036}},
+            {{-45.634, -24.930}, {45.634, 24.930}, {-214.130, -116.980}, {-466.874, -255.054}, {372.095, 203.276}}
+    };
+    const int max_prn_length_samples = 2 * round(8000000 * Galileo_E1_CODE_PERIOD);
+
+    Correlator correlator;
+    gr_complex* ca_code = new gr_complex[code_length_half_chips + 4];
+    gr_complex* input;
+    gr_complex* carrier;
+    gr_complex out[5];
+    if (posix_memalign((void**)&input, 16, max_prn_length_samples * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&carrier, 16, max_prn_length_samples * sizeof(gr_complex)) == 0){};
+
+    for (int c = 0; c < 3; c++)
+        {
+            galileo_e1_veml_test_code_table(ca_code, prn[c]);
+            int prn_length_samples = round((double)fs_in[c] * Galileo_E1_B_CODE_LENGTH_CHIPS / code_freq_chips[c] + rem_code_phase_samples[c]);
+            double input_step_half_chips = 2.0 * code_freq_chips[c] / (double)fs_in[c];
+            for (int i = 0; i < prn_length_samples; i++)
+                {
+                    int index = (int)fmod(i * input_step_half_chips + delay_half_chips[c], (double)code_length_half_chips);
+                    double carrier_phase = carrier_rad_per_sample[c] * i;
+                    input[i] = ca_code[2 + index] * gr_complex(cos(carrier_phase + 0.5), sin(carrier_phase + 0.5));
+                    carrier[i] = gr_complex(cos(carrier_phase), -sin(carrier_phase));
+                }
+
+            // phases as computed by update_local_code()
+            double code_phase_step_chips = code_freq_chips[c] / (double)fs_in[c];
+            double code_phase_step_half_chips = (2.0 * code_freq_chips[c]) / (double)fs_in[c];
+            float rem_code_phase_half_chips = rem_code_phase_samples[c] * (2*code_freq_chips[c] / fs_in[c]);
+            double very_early_code_phase_half_chips = -(double)rem_code_phase_half_chips - 2*spc_chips[c][1];
+            int early_late_spc_samples = round(spc_chips[c][0] / code_phase_step_chips);
+            int very_early_late_spc_samples = round(spc_chips[c][1] / code_phase_step_chips);
+            int tap_offset_samples[4] = {very_early_late_spc_samples - early_late_spc_samples,
+                                         very_early_late_spc_samples,
+                                         very_early_late_spc_samples + early_late_spc_samples,
+                                         2*very_early_late_spc_samples};
+
+            correlator.Carrier_wipeoff_and_VEPL_code_table(prn_length_samples, input, carrier,
+                    &ca_code[2], code_length_half_chips, very_early_code_phase_half_chips,
+                    code_phase_step_half_chips, tap_offset_samples,
+                    &out[0], &out[1], &out[2], &out[3], &out[4]);
+
+            // the single precision accumulation over a code period drifts by a few units,
+            // a tap one sample away moves the output by hundreds
+            for (int k = 0; k < 5; k++)
+                {
+                    EXPECT_NEAR(expected[c][k].real(), out[k].real(), 5.0) << "case " << c << " tap " << k;
+                    EXPECT_NEAR(expected[c][k].imag(), out[k].imag(), 5.0) << "case " << c << " tap " << k;
+                }
+        }
+
+    delete[] ca_code;
+    free(input);
+    free(carrier);
+}
+
+
+
+TEST(Galileo_E1_Veml_Correlator_Test, AlignedCode)
+{
+    // four samples per chip, so that each half chip of the input lasts two samples
+    const int code_length_half_chips = (int)(2*Galileo_E1_B_CODE_LENGTH_CHIPS);
+    const int prn_length_samples = 2 * code_length_half_chips;
+    const double code_phase_step_half_chips = 0.5;
+    // one and two samples between the taps
+    const int tap_offset_samples[4] = {1, 2, 3, 4};
+
+    Correlator correlator;
+    gr_complex* ca_code = new gr_complex[code_length_half_chips + 4];
+    gr_complex* input;
+    gr_complex* carrier;
+    gr_complex out[5];
+    if (posix_memalign((void**)&input, 16, prn_length_samples * sizeof(gr_complex)) == 0){};
+    if (posix_memalign((void**)&carrier, 16, prn_length_samples * sizeof(gr_complex)) == 0){};
+
+    for (int prn = 1; prn <= 50; prn += 7)
+        {
+            galileo_e1_veml_test_code_table(ca_code, prn);
+            for (int i = 0; i < prn_length_samples; i++)
+                {
+                    double carrier_phase = 0.003 * i;
+                    input[i] = ca_code[2 + i / 2] * gr_complex(cos(carrier_phase), sin(carrier_phase));
+                    carrier[i] = gr_complex(cos(carrier_phase), -sin(carrier_phase));
+                }
+
+            // the Prompt starts a quarter of a half chip before the first entry of the table
+            double very_early_code_phase_half_chips = -0.25 - tap_offset_samples[1] * code_phase_step_half_chips;
+            correlator.Carrier_wipeoff_and_VEPL_code_table(prn_length_samples, input, carrier,
+                    &ca_code[2], code_length_half_chips, very_early_code_phase_half_chips,
+                    code_phase_step_half_chips, tap_offset_samples,
+                    &out[0], &out[1], &out[2], &out[3], &out[4]);
+
+            // the Prompt reads the input code, and over a whole code period the Early
+            // and Late taps (Very Early and Very Late) see the same code transitions
+            EXPECT_NEAR(prn_length_samples, out[2].real(), 1.0) << "PRN " << prn;
+            EXPECT_NEAR(0.0, out[2].imag(), 1.0) << "PRN " << prn;
+            EXPECT_NEAR(out[1].real(), out[3].real(), 1.0) << "PRN " << prn;
+            EXPECT_NEAR(out[0].real(), out[4].real(), 1.0) << "PRN " << prn;
+            EXPECT_LT(std::abs(out[1]), 0.75 * prn_length_samples) << "PRN " << prn;
+            EXPECT_LT(std::abs(out[0]), 0.75 * prn_length_samples) << "PRN " << prn;
+        }
+
+    delete[] ca_code;
+    free(input);
+    free(carrier);
+}
@@ -0,0 +1,402 @@
+/*!
+ * \file hybrid_ls_pvt_test.cc
+ * \brief Solves synthetic GPS and Galileo pseudoranges with the joint PVT
+ * solver: recovery of the inter-system bias, epochs of a single system, and
+ * satellites of both systems with the same PRN
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cmath>
+#include <map>
+#include <set>
+#include <utility>
+#include "GPS_L1_CA.h"
+#include "gps_ephemeris.h"
+#include "galileo_ephemeris.h"
+#include "gps_l1_ca_ls_pvt.h"
+#include "galileo_e1_ls_pvt.h"
+#include "hybrid_ls_pvt.h"
+
+#define HYBRID_LS_PVT_TEST_SATELLITES 4   // of each system
+
+const double hybrid_ls_pvt_test_rx[3] = {4796983.5, 166582.1, 4185339.2}; // ECEF [m]
+const double hybrid_ls_pvt_test_rx_time = 345600.5;                     // GPS TOW [s]
+
+
+Gps_Ephemeris hybrid_ls_pvt_test_gps_ephemeris(int prn)
+{
+    Gps_Ephemeris eph;
+    eph.i_satellite_PRN = prn;
+    eph.i_GPS_week = 766;
+    eph.d_Toe = 345600.0;
+    eph.d_Toc = 345600.0;
+    eph.d_sqrt_A = 5153.65;
+    eph.d_e_eccentricity = 0.0112;
+    eph.d_M_0 = 0.4 + 1.7 * prn;
+    eph.d_Delta_n = 4.5e-9;
+    eph.d_OMEGA0 = -1.75 + 0.9 * prn;
+    eph.d_OMEGA = 0.83;
+    eph.d_OMEGA_DOT = -8.1e-9;
+    eph.d_i_0 = 0.96;
+    eph.d_IDOT = 2.5e-10;
+    eph.d_Cuc = -1.9e-6;
+    eph.d_Cus = 8.4e-6;
+    eph.d_Crc = 218.0;
+    eph.d_Crs = -37.0;
+    eph.d_Cic = 1.1e-7;
+    eph.d_Cis = -4.3e-8;
+    eph.d_A_f0 = 1.2e-4;
+    eph.d_A_f1 = 3.4e-12;
+    eph.d_A_f2 = 0.0;
+    eph.d_TGD = 0.0;
+    return eph;
+}
+
+
+Galileo_Ephemeris hybrid_ls_pvt_test_galileo_ephemeris(int prn)
+{
+    Galileo_Ephemeris eph;
+    eph.i_satellite_PRN = prn;
+    eph.WN_5 = 766;
+    eph.t0e_1 = 345600.0;
+    eph.t0c_4 = 345600.0;
+    eph.A_1 = 5440.6;
+    eph.e_1 = 0.0003;
+    eph.M0_1 = -2.1 + 1.3 * prn;
+    eph.delta_n_3 = 3.1e-9;
+    eph.OMEGA_0_2 = 0.52 + 2.1 * prn;
+    eph.omega_2 = -0.6;
+    eph.OMEGA_dot_3 = -5.6e-9;
+    eph.i_0_2 = 0.97;
+    eph.iDot_2 = 1.0e-10;
+    eph.C_uc_3 = 1.0e-6;
+    eph.C_us_3 = 4.0e-6;
+    eph.C_rc_3 = 200.0;
+    eph.C_rs_3 = 20.0;
+    eph.C_ic_4 = 5.0e-8;
+    eph.C_is_4 = -2.0e-8;
+    eph.af0_4 = -3.0e-4;
+    eph.af1_4 = 1.0e-12;
+    eph.af2_4 = 0.0;
+    return eph;
+}
+
+
+/*
+ * Pseudorange of a satellite seen from hybrid_ls_pvt_test_rx at rx_time by
+ * a receiver whose clock is bias_m ahead of the system time, with the Earth
+ * rotation model of the solver
+ */
+template<class Eph>
+Gnss_Synchro hybrid_ls_pvt_test_observable(Eph &eph, char system, int prn, double rx_time, double bias_m)
+{
+    double tau = 0.07;
+    for (int iter = 0; iter < 4; iter++)
+        {
+            eph.satellitePosition(rx_time - tau);
+            double dX = eph.d_satpos_X - hybrid_ls_pvt_test_rx[0];
+            double dY = eph.d_satpos_Y - hybrid_ls_pvt_test_rx[1];
+            double dZ = eph.d_satpos_Z - hybrid_ls_pvt_test_rx[2];
+            double omegatau = OMEGA_EARTH_DOT * sqrt(dX*dX + dY*dY + dZ*dZ) / GPS_C_m_s;
+            double rot_X = cos(omegatau) * eph.d_satpos_X + sin(omegatau) * eph.d_satpos_Y - hybrid_ls_pvt_test_rx[0];
+            double rot_Y = -sin(omegatau) * eph.d_satpos_X + cos(omegatau) * eph.d_satpos_Y - hybrid_ls_pvt_test_rx[1];
+            tau = sqrt(rot_X*rot_X + rot_Y*rot_Y + dZ*dZ) / GPS_C_m_s;
+        }
+    double clock = eph.sv_clock_drift(rx_time - tau) + eph.sv_clock_relativistic_term(rx_time - tau);
+    Gnss_Synchro obs;
+    obs.System = system;
+    obs.PRN = prn;
+    obs.CN0_dB_hz = 45.0;
+    obs.Flag_valid_pseudorange = true;
+    obs.Pseudorange_m = (tau - clock) * GPS_C_m_s + bias_m;
+    obs.d_TOW_at_current_symbol = rx_time;
+    return obs;
+}
+
+
+/*
+ * Fills the navigation data of the solvers and returns the observables of
+ * the epoch keyed by channel: the GPS and the Galileo satellites have the
+ * same PRNs, the receiver clock is clock_m ahead of GPS time, and the Galileo
+ * pseudoranges have an additional inter-system bias of isb_m
+ */
+std::map<int,Gnss_Synchro> hybrid_ls_pvt_test_epoch(hybrid_ls_pvt &pvt, double isb_m, double clock_m = 0.0)
+{
+    std::map<int,Gnss_Synchro> gnss_pseudoranges_map;
+    for (int prn = 1; prn <= HYBRID_LS_PVT_TEST_SATELLITES; prn++)
+        {
+            Gps_Ephemeris gps_eph = hybrid_ls_pvt_test_gps_ephemeris(prn);
+            Galileo_Ephemeris galileo_eph = hybrid_ls_pvt_test_galileo_ephemeris(prn);
+            pvt.gps_ephemeris_map[prn] = gps_eph;
+            pvt.galileo_ephemeris_map[prn] = galileo_eph;
+            gnss_pseudoranges_map[prn - 1] = hybrid_ls_pvt_test_observable(gps_eph, 'G', prn, hybrid_ls_pvt_test_rx_time, clock_m);
+            gnss_pseudoranges_map[HYBRID_LS_PVT_TEST_SATELLITES + prn - 1] = hybrid_ls_pvt_test_observable(galileo_eph, 'E', prn, hybrid_ls_pvt_test_rx_time, clock_m + isb_m);
+        }
+    return gnss_pseudoranges_map;
+}
+
+
+/*
+ * Observables of the epoch of a single system
+ */
+std::map<int,Gnss_Synchro> hybrid_ls_pvt_test_select(const std::map<int,Gnss_Synchro> &gnss_pseudoranges_map, char system)
+{
+    std::map<int,Gnss_Synchro> selected;
+    for (std::map<int,Gnss_Synchro>::const_iterator it = gnss_pseudoranges_map.begin(); it != gnss_pseudoranges_map.end(); it++)
+        {
+            if (it->second.System == system) selected[it->first] = it->second;
+        }
+    return selected;
+}
+
+
+
+TEST(Hybrid_Ls_Pvt_Test, JointSolution)
+{
+    hybrid_ls_pvt pvt(2 * HYBRID_LS_PVT_TEST_SATELLITES, "", false);
+    const double isb = 25.0; // [m]
+    std::map<int,Gnss_Synchro> gnss_pseudoranges_map = hybrid_ls_pvt_test_epoch(pvt, isb);
+
+    ASSERT_TRUE(pvt.get_PVT(gnss_pseudoranges_map, hybrid_ls_pvt_test_rx_time, false));
+    EXPECT_EQ(2 * HYBRID_LS_PVT_TEST_SATELLITES, pvt.d_valid_observations);
+    EXPECT_EQ(HYBRID_LS_PVT_TEST_SATELLITES, pvt.d_valid_gps_observations);
+    EXPECT_EQ(HYBRID_LS_PVT_TEST_SATELLITES, pvt.d_valid_galileo_observations);
+    EXPECT_EQ(LS_PVT_MAX_UNKNOWNS, pvt.d_ls_solver.d_unknowns);
+    for (int j = 0; j < 3; j++)
+        {
+            EXPECT_NEAR(hybrid_ls_pvt_test_rx[j], pvt.d_ls_solver.d_pos[j], 0.01) << "coordinate " << j;
+        }
+    EXPECT_NEAR(0.0, pvt.d_ls_solver.d_pos[3], 0.01);
+    EXPECT_NEAR(isb, pvt.d_isb_m, 0.01);
+    EXPECT_EQ('G', pvt.d_visible_satellites_System[0]);
+    EXPECT_EQ('E', pvt.d_visible_satellites_System[HYBRID_LS_PVT_TEST_SATELLITES]);
+    EXPECT_EQ(1, pvt.d_visible_satellites_IDs[HYBRID_LS_PVT_TEST_SATELLITES]);
+
+    // the bias needs a fifth observation: 3 GPS and 1 Galileo satellites are not enough
+    std::map<int,Gnss_Synchro> few_pseudoranges_map;
+    for (int channel = 1; channel <= HYBRID_LS_PVT_TEST_SATELLITES; channel++)
+        {
+            few_pseudoranges_map[channel] = gnss_pseudoranges_map[channel];
+        }
+    EXPECT_FALSE(pvt.get_PVT(few_pseudoranges_map, hybrid_ls_pvt_test_rx_time, false));
+    few_pseudoranges_map[0] = gnss_pseudoranges_map[0];
+    ASSERT_TRUE(pvt.get_PVT(few_pseudoranges_map, hybrid_ls_pvt_test_rx_time, false));
+    EXPECT_NEAR(isb, pvt.d_isb_m, 0.01);
+
+    // a satellite without ephemeris is not used
+    pvt.galileo_ephemeris_map.erase(1);
+    ASSERT_TRUE(pvt.get_PVT(gnss_pseudoranges_map, hybrid_ls_pvt_test_rx_time, false));
+    EXPECT_EQ(2 * HYBRID_LS_PVT_TEST_SATELLITES - 1, pvt.d_valid_observations);
+    EXPECT_EQ(HYBRID_LS_PVT_TEST_SATELLITES - 1, pvt.d_valid_galileo_observations);
+}
+
+
+
+TEST(Hybrid_Ls_Pvt_Test, SameAsSingleSystem)
+{
+    hybrid_ls_pvt pvt(2 * HYBRID_LS_PVT_TEST_SATELLITES, "", false);
+    std::map<int,Gnss_Synchro> gnss_pseudoranges_map = hybrid_ls_pvt_test_epoch(pvt, 0.0);
+
+    // the single system blocks key the observables by PRN
+    gps_l1_ca_ls_pvt gps_pvt(HYBRID_LS_PVT_TEST_SATELLITES, "", false);
+    galileo_e1_ls_pvt galileo_pvt(HYBRID_LS_PVT_TEST_SATELLITES, "", false);
+    gps_pvt.gps_ephemeris_map = pvt.gps_ephemeris_map;
+    galileo_pvt.galileo_ephemeris_map = pvt.galileo_ephemeris_map;
+    std::map<int,Gnss_Synchro> gps_map;
+    std::map<int,Gnss_Synchro> galileo_map;
+    std::map<int,Gnss_Synchro> hybrid_gps_map;
+    std::map<int,Gnss_Synchro> hybrid_galileo_map;
+    for (std::map<int,Gnss_Synchro>::iterator it = gnss_pseudoranges_map.begin(); it != gnss_pseudoranges_map.end(); it++)
+        {
+            if (it->second.System == 'G')
+                {
+                    gps_map[it->second.PRN] = it->second;
+                    hybrid_gps_map[it->first] = it->second;
+                }
+            else
+                {
+                    galileo_map[it->second.PRN] = it->second;
+                    hybrid_galileo_map[it->first] = it->second;
+                }
+        }
+
+    ASSERT_TRUE(gps_pvt.get_PVT(gps_map, hybrid_ls_pvt_test_rx_time, false));
+    ASSERT_TRUE(pvt.get_PVT(hybrid_gps_map, hybrid_ls_pvt_test_rx_time, false));
+    EXPECT_EQ(LS_PVT_UNKNOWNS, pvt.d_ls_solver.d_unknowns);
+    for (int j = 0; j < 4; j++)
+        {
+            EXPECT_DOUBLE_EQ(gps_pvt.d_ls_solver.d_pos[j], pvt.d_ls_solver.d_pos[j]) << "unknown " << j;
+        }
+    EXPECT_DOUBLE_EQ(gps_pvt.d_latitude_d, pvt.d_latitude_d);
+    EXPECT_DOUBLE_EQ(gps_pvt.d_longitude_d, pvt.d_longitude_d);
+    EXPECT_DOUBLE_EQ(gps_pvt.d_height_m, pvt.d_height_m);
+    EXPECT_DOUBLE_EQ(gps_pvt.d_GDOP, pvt.d_GDOP);
+
+    pvt.d_ls_solver.reset();
+    ASSERT_TRUE(galileo_pvt.get_PVT(galileo_map, hybrid_ls_pvt_test_rx_time, false));
+    ASSERT_TRUE(pvt.get_PVT(hybrid_galileo_map, hybrid_ls_pvt_test_rx_time, false));
+    EXPECT_EQ(LS_PVT_UNKNOWNS, pvt.d_ls_solver.d_unknowns);
+    for (int j = 0; j < 4; j++)
+        {
+            EXPECT_DOUBLE_EQ(galileo_pvt.d_ls_solver.d_pos[j], pvt.d_ls_solver.d_pos[j]) << "unknown " << j;
+        }
+}
+
+
+
+TEST(Hybrid_Ls_Pvt_Test, InterSystemBias)
+{
+    // the bias is recovered whatever its sign and size, and separated from the receiver clock offset
+    const double isbs[4] = {-150.0, 0.0, 25.0, 3000.0};   // [m]
+    const double clocks[2] = {0.0, 300.0};                // [m]
+    for (int c = 0; c < 2; c++)
+        {
+            for (int i = 0; i < 4; i++)
+                {
+                    hybrid_ls_pvt pvt(2 * HYBRID_LS_PVT_TEST_SATELLITES, "", false);
+                    std::map<int,Gnss_Synchro> gnss_pseudoranges_map = hybrid_ls_pvt_test_epoch(pvt, isbs[i], clocks[c]);
+                    ASSERT_TRUE(pvt.get_PVT(gnss_pseudoranges_map, hybrid_ls_pvt_test_rx_time, false)) << "ISB " << isbs[i];
+                    for (int j = 0; j < 3; j++)
+                        {
+                            EXPECT_NEAR(hybrid_ls_pvt_test_rx[j], pvt.d_ls_solver.d_pos[j], 0.01) << "ISB " << isbs[i] << ", coordinate " << j;
+                        }
+                    EXPECT_NEAR(clocks[c], pvt.d_ls_solver.d_pos[3], 0.01) << "ISB " << isbs[i];
+                    EXPECT_NEAR(isbs[i], pvt.d_isb_m, 0.01) << "clock " << clocks[c];
+                }
+        }
+
+    // a change of the bias is followed from one epoch to the next
+    hybrid_ls_pvt pvt(2 * HYBRID_LS_PVT_TEST_SATELLITES, "", false);
+    ASSERT_TRUE(pvt.get_PVT(hybrid_ls_pvt_test_epoch(pvt, 25.0), hybrid_ls_pvt_test_rx_time, false));
+    EXPECT_NEAR(25.0, pvt.d_isb_m, 0.01);
+    ASSERT_TRUE(pvt.get_PVT(hybrid_ls_pvt_test_epoch(pvt, -60.0), hybrid_ls_pvt_test_rx_time, false));
+    EXPECT_NEAR(-60.0, pvt.d_isb_m, 0.01);
+}
+
+
+
+TEST(Hybrid_Ls_Pvt_Test, SingleSystemEpoch)
+{
+    const double isb = 25.0;    // [m]
+    const double clock = 300.0; // [m]
+    hybrid_ls_pvt pvt(2 * HYBRID_LS_PVT_TEST_SATELLITES, "", false);
+    std::map<int,Gnss_Synchro> gnss_pseudoranges_map = hybrid_ls_pvt_test_epoch(pvt, isb, clock);
+    ASSERT_TRUE(pvt.get_PVT(gnss_pseudoranges_map, hybrid_ls_pvt_test_rx_time, false));
+    ASSERT_EQ(LS_PVT_MAX_UNKNOWNS, pvt.d_ls_solver.d_unknowns);
+
+    // a GPS only epoch is solved without the bias, that keeps its last estimation
+    std::map<int,Gnss_Synchro> gps_map = hybrid_ls_pvt_test_select(gnss_pseudoranges_map, 'G');
+    ASSERT_TRUE(pvt.get_PVT(gps_map, hybrid_ls_pvt_test_rx_time, false));
+    EXPECT_EQ(LS_PVT_UNKNOWNS, pvt.d_ls_solver.d_unknowns);
+    EXPECT_EQ(HYBRID_LS_PVT_TEST_SATELLITES, pvt.d_valid_gps_observations);
+    EXPECT_EQ(0, pvt.d_valid_galileo_observations);
+    for (int j = 0; j < 3; j++)
+        {
+            EXPECT_NEAR(hybrid_ls_pvt_test_rx[j], pvt.d_ls_solver.d_pos[j], 0.01) << "coordinate " << j;
+        }
+    EXPECT_NEAR(clock, pvt.d_ls_solver.d_pos[3], 0.01);
+    EXPECT_NEAR(isb, pvt.d_isb_m, 0.01);
+    boost::posix_time::ptime gps_utc_time = pvt.d_position_UTC_time;
+
+    // in a Galileo only epoch the clock offset refers to the Galileo pseudoranges,
+    // and the time of the fix comes from the Galileo system time
+    std::map<int,Gnss_Synchro> galileo_map = hybrid_ls_pvt_test_select(gnss_pseudoranges_map, 'E');
+    ASSERT_TRUE(pvt.get_PVT(galileo_map, hybrid_ls_pvt_test_rx_time, false));
+    EXPECT_EQ(LS_PVT_UNKNOWNS, pvt.d_ls_solver.d_unknowns);
+    EXPECT_EQ(0, pvt.d_valid_gps_observations);
+    EXPECT_EQ(HYBRID_LS_PVT_TEST_SATELLITES, pvt.d_valid_galileo_observations);
+    for (int j = 0; j < 3; j++)
+        {
+            EXPECT_NEAR(hybrid_ls_pvt_test_rx[j], pvt.d_ls_solver.d_pos[j], 0.01) << "coordinate " << j;
+        }
+    EXPECT_NEAR(clock + isb, pvt.d_ls_solver.d_pos[3], 0.01);
+    EXPECT_FALSE(pvt.d_position_UTC_time.is_not_a_date_time());
+    EXPECT_GT(boost::posix_time::minutes(1), (pvt.d_position_UTC_time - gps_utc_time).abs());
+
+    // a single system needs 4 satellites
+    galileo_map.erase(galileo_map.begin());
+    EXPECT_FALSE(pvt.get_PVT(galileo_map, hybrid_ls_pvt_test_rx_time, false));
+
+    // the next joint epoch estimates the bias again
+    ASSERT_TRUE(pvt.get_PVT(gnss_pseudoranges_map, hybrid_ls_pvt_test_rx_time, false));
+    EXPECT_EQ(LS_PVT_MAX_UNKNOWNS, pvt.d_ls_solver.d_unknowns);
+    EXPECT_NEAR(clock, pvt.d_ls_solver.d_pos[3], 0.01);
+    EXPECT_NEAR(isb, pvt.d_isb_m, 0.01);
+}
+
+
+
+TEST(Hybrid_Ls_Pvt_Test, SamePrnInBothSystems)
+{
+    const double isb = 25.0; // [m]
+    hybrid_ls_pvt pvt(2 * HYBRID_LS_PVT_TEST_SATELLITES + 2, "", false);
+    std::map<int,Gnss_Synchro> gnss_pseudoranges_map = hybrid_ls_pvt_test_epoch(pvt, isb);
+
+    // GPS and Galileo satellites with the same PRN are different observations,
+    // each one with the ephemeris of its own system
+    ASSERT_TRUE(pvt.get_PVT(gnss_pseudoranges_map, hybrid_ls_pvt_test_rx_time, false));
+    ASSERT_EQ(2 * HYBRID_LS_PVT_TEST_SATELLITES, pvt.d_valid_observations);
+    std::set<std::pair<char,int> > satellites;
+    for (int i = 0; i < pvt.d_valid_observations; i++)
+        {
+            satellites.insert(std::pair<char,int>(pvt.d_visible_satellites_System[i], pvt.d_visible_satellites_IDs[i]));
+        }
+    EXPECT_EQ((unsigned int)(2 * HYBRID_LS_PVT_TEST_SATELLITES), satellites.size());
+    for (int prn = 1; prn <= HYBRID_LS_PVT_TEST_SATELLITES; prn++)
+        {
+            EXPECT_EQ(1u, satellites.count(std::pair<char,int>('G', prn))) << "GPS PRN " << prn;
+            EXPECT_EQ(1u, satellites.count(std::pair<char,int>('E', prn))) << "Galileo PRN " << prn;
+        }
+    for (int j = 0; j < 3; j++)
+        {
+            EXPECT_NEAR(hybrid_ls_pvt_test_rx[j], pvt.d_ls_solver.d_pos[j], 0.01) << "coordinate " << j;
+        }
+    EXPECT_NEAR(isb, pvt.d_isb_m, 0.01);
+
+    // a Galileo satellite whose PRN only has a GPS ephemeris is not used
+    const int prn = HYBRID_LS_PVT_TEST_SATELLITES + 1;
+    Gps_Ephemeris gps_eph = hybrid_ls_pvt_test_gps_ephemeris(prn);
+    Galileo_Ephemeris galileo_eph = hybrid_ls_pvt_test_galileo_ephemeris(prn);
+    pvt.gps_ephemeris_map[prn] = gps_eph;
+    gnss_pseudoranges_map[2 * HYBRID_LS_PVT_TEST_SATELLITES] = hybrid_ls_pvt_test_observable(galileo_eph, 'E', prn, hybrid_ls_pvt_test_rx_time, isb);
+    ASSERT_TRUE(pvt.get_PVT(gnss_pseudoranges_map, hybrid_ls_pvt_test_rx_time, false));
+    EXPECT_EQ(HYBRID_LS_PVT_TEST_SATELLITES, pvt.d_valid_galileo_observations);
+    EXPECT_NEAR(hybrid_ls_pvt_test_rx[0], pvt.d_ls_solver.d_pos[0], 0.01);
+
+    // nor a GPS satellite whose PRN only has a Galileo ephemeris
+    pvt.gps_ephemeris_map.erase(prn);
+    pvt.galileo_ephemeris_map[prn] = galileo_eph;
+    gnss_pseudoranges_map[2 * HYBRID_LS_PVT_TEST_SATELLITES + 1] = hybrid_ls_pvt_test_observable(gps_eph, 'G', prn, hybrid_ls_pvt_test_rx_time, 0.0);
+    ASSERT_TRUE(pvt.get_PVT(gnss_pseudoranges_map, hybrid_ls_pvt_test_rx_time, false));
+    EXPECT_EQ(HYBRID_LS_PVT_TEST_SATELLITES, pvt.d_valid_gps_observations);
+    EXPECT_EQ(HYBRID_LS_PVT_TEST_SATELLITES + 1, pvt.d_valid_galileo_observations);
+    for (int j = 0; j < 3; j++)
+        {
+            EXPECT_NEAR(hybrid_ls_pvt_test_rx[j], pvt.d_ls_solver.d_pos[j], 0.01) << "coordinate " << j;
+        }
+    EXPECT_NEAR(isb, pvt.d_isb_m, 0.01);
+}
@@ -0,0 +1,353 @@
+/*!
+ * \file ls_pvt_solver_test.cc
+ * \brief  Checks the fixed-size Least Squares PVT solver against the
+ * Armadillo implementation that it replaces, and compares their speed.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cmath>
+#include <sys/time.h>
+#include <armadillo>
+#include "GPS_L1_CA.h"
+#include "ls_pvt_solver.h"
+
+DEFINE_int32(ls_pvt_solver_test_fixes, 10000, "Number of fixes computed by the LS PVT solver benchmark");
+
+#define LS_PVT_TEST_SATELLITES 8
+
+
+/*
+ * Satellites at 26560 km from the center of the Earth, seen from the receiver at
+ * rx (X, Y, Z [m], clock offset [m]) at elevations from 10 to 80 degrees, and the
+ * pseudoranges that the solver model gives for them (Earth rotation during the
+ * travel time). The azimuths turn slowly with the time t [s].
+ */
+void ls_pvt_test_observations(const double *rx, double t, double satpos[][3], double *obs)
+{
+    const double dtr = GPS_PI / 180.0;
+    double lambda = atan2(rx[1], rx[0]);
+    double phi = atan2(rx[2], sqrt(rx[0]*rx[0] + rx[1]*rx[1]));
+    double rx_norm2 = rx[0]*rx[0] + rx[1]*rx[1] + rx[2]*rx[2];
+    for (int i = 0; i < LS_PVT_TEST_SATELLITES; i++)
+        {
+            double az = (45.0 * i + 0.01 * t) * dtr;
+            double el = (10.0 + 10.0 * i) * dtr;
+            double E = sin(az) * cos(el);
+            double N = cos(az) * cos(el);
+            double U = sin(el);
+            // line of sight in ECEF
+            double u[3] = {-sin(lambda) * E - sin(phi) * cos(lambda) * N + cos(phi) * cos(lambda) * U,
+                            cos(lambda) * E - sin(phi) * sin(lambda) * N + cos(phi) * sin(lambda) * U,
+                            cos(phi) * N + sin(phi) * U};
+            double rx_u = rx[0] * u[0] + rx[1] * u[1] + rx[2] * u[2];
+            double rho = -rx_u + sqrt(rx_u * rx_u - rx_norm2 + 26560000.0 * 26560000.0);
+            for (int j = 0; j < 3; j++) satpos[i][j] = rx[j] + rho * u[j];
+
+            double dX = satpos[i][0] - rx[0];
+            double dY = satpos[i][1] - rx[1];
+            double dZ = satpos[i][2] - rx[2];
+            double omegatau = OMEGA_EARTH_DOT * sqrt(dX*dX + dY*dY + dZ*dZ) / GPS_C_m_s;
+            double rot_X = cos(omegatau) * satpos[i][0] + sin(omegatau) * satpos[i][1] - rx[0];
+            double rot_Y = -sin(omegatau) * satpos[i][0] + cos(omegatau) * satpos[i][1] - rx[1];
+            obs[i] = sqrt(rot_X*rot_X + rot_Y*rot_Y + dZ*dZ) + rx[3];
+        }
+}
+
+
+/*
+ * The Armadillo Least Squares solution used by the PVT classes before the
+ * fixed-size solver (without the azimuth and elevation computation)
+ */
+arma::vec ls_pvt_test_armadillo_solution(arma::mat satpos, arma::vec obs, arma::mat w, arma::mat &Q)
+{
+    int nmbOfSatellites = satpos.n_cols;
+    arma::vec pos = arma::zeros(4);
+    arma::mat A = arma::zeros(nmbOfSatellites, 4);
+    arma::vec omc = arma::zeros(nmbOfSatellites);
+    arma::vec Rot_X;
+    arma::vec x;
+    for (int iter = 0; iter < 10; iter++)
+        {
+            for (int i = 0; i < nmbOfSatellites; i++)
+                {
+                    if (iter == 0)
+                        {
+                            Rot_X = satpos.col(i);
+                        }
+                    else
+                        {
+                            double traveltime = arma::norm(satpos.col(i) - pos.subvec(0, 2), 2) / GPS_C_m_s;
+                            double omegatau = OMEGA_EARTH_DOT * traveltime;
+                            arma::mat R3 = arma::zeros(3, 3);
+                            R3(0, 0) = cos(omegatau);
+                            R3(0, 1) = sin(omegatau);
+                            R3(1, 0) = -sin(omegatau);
+                            R3(1, 1) = cos(omegatau);
+                            R3(2, 2) = 1;
+                            Rot_X = R3 * satpos.col(i);
+                        }
+                    omc(i) = obs(i) - arma::norm(Rot_X - pos.subvec(0, 2), 2) - pos(3);
+                    A(i, 0) = -(Rot_X(0) - pos(0)) / obs(i);
+                    A(i, 1) = -(Rot_X(1) - pos(1)) / obs(i);
+                    A(i, 2) = -(Rot_X(2) - pos(2)) / obs(i);
+                    A(i, 3) = 1.0;
+                }
+            x = arma::solve(w * A, w * omc);
+            pos = pos + x;
+            if (arma::norm(x, 2) < 1e-4)
+                {
+                    break;
+                }
+        }
+    Q = arma::inv(arma::trans(A) * A);
+    return pos;
+}
+
+
+long long int ls_pvt_test_microseconds()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+const double ls_pvt_test_receiver[4] = {4796983.5, 160309.0, 4187332.0, 1500.0}; // near Barcelona, 1500 m of clock offset
+
+
+
+TEST(Ls_Pvt_Solver_Test, SameSolutionAsArmadillo)
+{
+    double satpos[LS_PVT_TEST_SATELLITES][3];
+    double obs[LS_PVT_TEST_SATELLITES];
+    double weights[LS_PVT_TEST_SATELLITES];
+    ls_pvt_test_observations(ls_pvt_test_receiver, 0.0, satpos, obs);
+    arma::mat arma_satpos(3, LS_PVT_TEST_SATELLITES);
+    arma::vec arma_obs(LS_PVT_TEST_SATELLITES);
+    for (int i = 0; i < LS_PVT_TEST_SATELLITES; i++)
+        {
+            weights[i] = 1.0;
+            arma_obs(i) = obs[i] + 3.0 * sin(7.0 * i); // some noise, so the residuals are not zero
+            obs[i] = arma_obs(i);
+            for (int j = 0; j < 3; j++) arma_satpos(j, i) = satpos[i][j];
+        }
+
+    arma::mat Q;
+    arma::vec reference = ls_pvt_test_armadillo_solution(arma_satpos, arma_obs, arma::eye(LS_PVT_TEST_SATELLITES, LS_PVT_TEST_SATELLITES), Q);
+
+    Ls_Pvt_Solver solver(GPS_C_m_s);
+    double Az[LS_PVT_TEST_SATELLITES];
+    double El[LS_PVT_TEST_SATELLITES];
+    double D[LS_PVT_TEST_SATELLITES];
+    ASSERT_TRUE(solver.solve(LS_PVT_TEST_SATELLITES, satpos, obs, weights, Az, El, D));
+    for (int j = 0; j < 4; j++)
+        {
+            EXPECT_NEAR(reference(j), solver.d_pos[j], 1e-3) << "unknown " << j;
+            EXPECT_NEAR(ls_pvt_test_receiver[j], solver.d_pos[j], 10.0) << "unknown " << j;
+            for (int k = 0; k < 4; k++)
+                {
+                    EXPECT_NEAR(Q(j, k), solver.d_Q[j][k], 1e-6 * std::abs(Q(j, j))) << "Q(" << j << ", " << k << ")";
+                }
+        }
+    for (int i = 0; i < LS_PVT_TEST_SATELLITES; i++)
+        {
+            EXPECT_NEAR(10.0 + 10.0 * i, El[i], 0.5) << "satellite " << i;
+            EXPECT_GE(Az[i], 0.0) << "satellite " << i;
+            EXPECT_LT(Az[i], 360.0) << "satellite " << i;
+            EXPECT_NEAR(obs[i] - solver.d_pos[3], D[i], 20.0) << "satellite " << i;
+        }
+
+    // a satellite without weight does not change the solution
+    double bad_satpos[LS_PVT_TEST_SATELLITES + 1][3];
+    double bad_obs[LS_PVT_TEST_SATELLITES + 1];
+    double bad_weights[LS_PVT_TEST_SATELLITES + 1];
+    for (int i = 0; i < LS_PVT_TEST_SATELLITES; i++)
+        {
+            for (int j = 0; j < 3; j++) bad_satpos[i][j] = satpos[i][j];
+            bad_obs[i] = obs[i];
+            bad_weights[i] = 1.0;
+        }
+    for (int j = 0; j < 3; j++) bad_satpos[LS_PVT_TEST_SATELLITES][j] = satpos[0][j];
+    bad_obs[LS_PVT_TEST_SATELLITES] = obs[0] + 100000.0;
+    bad_weights[LS_PVT_TEST_SATELLITES] = 0.0;
+    Ls_Pvt_Solver weighted_solver(GPS_C_m_s);
+    ASSERT_TRUE(weighted_solver.solve(LS_PVT_TEST_SATELLITES + 1, bad_satpos, bad_obs, bad_weights, NULL, NULL, NULL));
+    for (int j = 0; j < 4; j++)
+        {
+            EXPECT_NEAR(solver.d_pos[j], weighted_solver.d_pos[j], 1e-3) << "unknown " << j;
+        }
+
+    // not enough observations
+    EXPECT_FALSE(weighted_solver.solve(3, satpos, obs, weights, NULL, NULL, NULL));
+}
+
+
+
+TEST(Ls_Pvt_Solver_Test, WarmStart)
+{
+    double satpos[LS_PVT_TEST_SATELLITES][3];
+    double obs[LS_PVT_TEST_SATELLITES];
+    double weights[LS_PVT_TEST_SATELLITES];
+    for (int i = 0; i < LS_PVT_TEST_SATELLITES; i++) weights[i] = 1.0;
+
+    Ls_Pvt_Solver solver(GPS_C_m_s);
+    ls_pvt_test_observations(ls_pvt_test_receiver, 0.0, satpos, obs);
+    ASSERT_TRUE(solver.solve(LS_PVT_TEST_SATELLITES, satpos, obs, weights, NULL, NULL, NULL));
+    int cold_iterations = solver.d_iterations;
+    EXPECT_GT(cold_iterations, 2);
+
+    // one second later the receiver has moved 10 m and its clock has drifted
+    double moved[4] = {ls_pvt_test_receiver[0] + 6.0, ls_pvt_test_receiver[1] - 8.0, ls_pvt_test_receiver[2], ls_pvt_test_receiver[3] + 0.3};
+    ls_pvt_test_observations(moved, 1.0, satpos, obs);
+    ASSERT_TRUE(solver.solve(LS_PVT_TEST_SATELLITES, satpos, obs, weights, NULL, NULL, NULL));
+    EXPECT_LT(solver.d_iterations, cold_iterations);
+    for (int j = 0; j < 4; j++)
+        {
+            EXPECT_NEAR(moved[j], solver.d_pos[j], 1e-3) << "unknown " << j;
+        }
+
+    // after a reset, the solution starts again from the center of the Earth
+    solver.reset();
+    ASSERT_TRUE(solver.solve(LS_PVT_TEST_SATELLITES, satpos, obs, weights, NULL, NULL, NULL));
+    EXPECT_EQ(cold_iterations, solver.d_iterations);
+}
+
+
+
+TEST(Ls_Pvt_Solver_Test, InterSystemBias)
+{
+    double satpos[LS_PVT_TEST_SATELLITES][3];
+    double obs[LS_PVT_TEST_SATELLITES];
+    double weights[LS_PVT_TEST_SATELLITES];
+    int system[LS_PVT_TEST_SATELLITES];
+    const double isb = -37.5; // [m]
+    ls_pvt_test_observations(ls_pvt_test_receiver, 0.0, satpos, obs);
+    for (int i = 0; i < LS_PVT_TEST_SATELLITES; i++)
+        {
+            weights[i] = 1.0;
+            system[i] = i % 2;
+            if (system[i] == 1) obs[i] += isb;
+        }
+
+    Ls_Pvt_Solver solver(GPS_C_m_s);
+    ASSERT_TRUE(solver.solve(LS_PVT_TEST_SATELLITES, satpos, obs, weights, system, NULL, NULL, NULL));
+    EXPECT_EQ(LS_PVT_MAX_UNKNOWNS, solver.d_unknowns);
+    for (int j = 0; j < 4; j++)
+        {
+            EXPECT_NEAR(ls_pvt_test_receiver[j], solver.d_pos[j], 1e-3) << "unknown " << j;
+        }
+    EXPECT_NEAR(isb, solver.d_pos[4], 1e-3);
+    EXPECT_GT(solver.d_Q[4][4], 0.0);
+
+    // the bias needs one more observation
+    EXPECT_FALSE(solver.solve(4, satpos, obs, weights, system, NULL, NULL, NULL));
+    ASSERT_TRUE(solver.solve(5, satpos, obs, weights, system, NULL, NULL, NULL));
+    EXPECT_NEAR(isb, solver.d_pos[4], 1e-3);
+
+    // with one system only, the solution is the one of the single system solver
+    ls_pvt_test_observations(ls_pvt_test_receiver, 0.0, satpos, obs);
+    for (int i = 0; i < LS_PVT_TEST_SATELLITES; i++) system[i] = 1;
+    Ls_Pvt_Solver single_solver(GPS_C_m_s);
+    Ls_Pvt_Solver joint_solver(GPS_C_m_s);
+    ASSERT_TRUE(single_solver.solve(LS_PVT_TEST_SATELLITES, satpos, obs, weights, NULL, NULL, NULL));
+    ASSERT_TRUE(joint_solver.solve(LS_PVT_TEST_SATELLITES, satpos, obs, weights, system, NULL, NULL, NULL));
+    EXPECT_EQ(LS_PVT_UNKNOWNS, joint_solver.d_unknowns);
+    EXPECT_EQ(single_solver.d_iterations, joint_solver.d_iterations);
+    for (int j = 0; j < 4; j++)
+        {
+            EXPECT_EQ(single_solver.d_pos[j], joint_solver.d_pos[j]) << "unknown " << j;
+        }
+    EXPECT_EQ(0.0, joint_solver.d_pos[4]);
+}
+
+
+
+TEST(Ls_Pvt_Solver_Test, ArmadilloImplementation)
+{
+    double satpos[LS_PVT_TEST_SATELLITES][3];
+    double obs[LS_PVT_TEST_SATELLITES];
+    ls_pvt_test_observations(ls_pvt_test_receiver, 0.0, satpos, obs);
+    arma::mat arma_satpos(3, LS_PVT_TEST_SATELLITES);
+    arma::vec arma_obs(LS_PVT_TEST_SATELLITES);
+    for (int i = 0; i < LS_PVT_TEST_SATELLITES; i++)
+        {
+            arma_obs(i) = obs[i];
+            for (int j = 0; j < 3; j++) arma_satpos(j, i) = satpos[i][j];
+        }
+    arma::mat W = arma::eye(LS_PVT_TEST_SATELLITES, LS_PVT_TEST_SATELLITES);
+    arma::mat Q;
+    arma::vec pos;
+
+    long long int begin = ls_pvt_test_microseconds();
+    for (int n = 0; n < FLAGS_ls_pvt_solver_test_fixes; n++)
+        {
+            pos = ls_pvt_test_armadillo_solution(arma_satpos, arma_obs, W, Q);
+        }
+    long long int end = ls_pvt_test_microseconds();
+    std::cout << FLAGS_ls_pvt_solver_test_fixes << " LS PVT fixes of " << LS_PVT_TEST_SATELLITES
+              << " satellites with Armadillo finished in " << (end - begin)
+              << " microseconds" << std::endl;
+    ASSERT_LE(0, end - begin);
+    EXPECT_NEAR(ls_pvt_test_receiver[0], pos(0), 1e-3);
+}
+
+
+
+TEST(Ls_Pvt_Solver_Test, FixedSizeImplementation)
+{
+    double satpos[LS_PVT_TEST_SATELLITES][3];
+    double obs[LS_PVT_TEST_SATELLITES];
+    double weights[LS_PVT_TEST_SATELLITES];
+    ls_pvt_test_observations(ls_pvt_test_receiver, 0.0, satpos, obs);
+    for (int i = 0; i < LS_PVT_TEST_SATELLITES; i++) weights[i] = 1.0;
+    Ls_Pvt_Solver solver(GPS_C_m_s);
+
+    long long int begin = ls_pvt_test_microseconds();
+    for (int n = 0; n < FLAGS_ls_pvt_solver_test_fixes; n++)
+        {
+            solver.reset();
+            solver.solve(LS_PVT_TEST_SATELLITES, satpos, obs, weights, NULL, NULL, NULL);
+        }
+    long long int end = ls_pvt_test_microseconds();
+    std::cout << FLAGS_ls_pvt_solver_test_fixes << " LS PVT fixes of " << LS_PVT_TEST_SATELLITES
+              << " satellites with the fixed-size solver finished in " << (end - begin)
+              << " microseconds" << std::endl;
+    ASSERT_LE(0, end - begin);
+    EXPECT_NEAR(ls_pvt_test_receiver[0], solver.d_pos[0], 1e-3);
+
+    begin = ls_pvt_test_microseconds();
+    for (int n = 0; n < FLAGS_ls_pvt_solver_test_fixes; n++)
+        {
+            solver.solve(LS_PVT_TEST_SATELLITES, satpos, obs, weights, NULL, NULL, NULL);
+        }
+    end = ls_pvt_test_microseconds();
+    std::cout << FLAGS_ls_pvt_solver_test_fixes << " LS PVT fixes of " << LS_PVT_TEST_SATELLITES
+              << " satellites with the fixed-size solver and warm start finished in " << (end - begin)
+              << " microseconds" << std::endl;
+    ASSERT_LE(0, end - begin);
+    EXPECT_NEAR(ls_pvt_test_receiver[0], solver.d_pos[0], 1e-3);
+}
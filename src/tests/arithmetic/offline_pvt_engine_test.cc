@@ -0,0 +1,353 @@
+/*!
+ * \file offline_pvt_engine_test.cc
+ * \brief Solves a synthetic observables dump with the offline PVT engine and
+ * checks that the fixes do not depend on the number of threads
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <vector>
+#include <sys/time.h>
+#include <boost/thread/thread.hpp>
+#include "GPS_L1_CA.h"
+#include "gps_ephemeris.h"
+#include "gps_l1_ca_ls_pvt.h"
+#include "observables_dump_reader.h"
+#include "offline_pvt_engine.h"
+
+#define OFFLINE_PVT_TEST_SATELLITES 7
+#define OFFLINE_PVT_TEST_CHANNELS 8       // the last channel has no valid pseudorange
+#define OFFLINE_PVT_TEST_EPOCH_PERIOD_MS 20
+
+DEFINE_int32(size_offline_pvt_engine_test, 2500, "Number of epochs of the synthetic observables dump of the offline PVT test");
+
+const double offline_pvt_test_rx[3] = {4796983.5, 166582.1, 4185339.2}; // ECEF [m]
+
+
+Gps_Ephemeris offline_pvt_test_ephemeris(int prn)
+{
+    Gps_Ephemeris eph;
+    eph.i_satellite_PRN = prn;
+    eph.i_GPS_week = 766;
+    eph.d_Toe = 345600.0;
+    eph.d_Toc = 345600.0;
+    eph.d_sqrt_A = 5153.65;
+    eph.d_e_eccentricity = 0.0112;
+    eph.d_M_0 = 0.4 + 1.7 * prn;
+    eph.d_Delta_n = 4.5e-9;
+    eph.d_OMEGA0 = -1.75 + 0.9 * prn;
+    eph.d_OMEGA = 0.83;
+    eph.d_OMEGA_DOT = -8.1e-9;
+    eph.d_i_0 = 0.96;
+    eph.d_IDOT = 2.5e-10;
+    eph.d_Cuc = -1.9e-6;
+    eph.d_Cus = 8.4e-6;
+    eph.d_Crc = 218.0;
+    eph.d_Crs = -37.0;
+    eph.d_Cic = 1.1e-7;
+    eph.d_Cis = -4.3e-8;
+    eph.d_A_f0 = 1.2e-4;
+    eph.d_A_f1 = 3.4e-12;
+    eph.d_A_f2 = 0.0;
+    eph.d_TGD = 0.0;
+    return eph;
+}
+
+
+/*
+ * Writes the dump that gps_l1_ca_observables_cc would write for a static
+ * receiver at offline_pvt_test_rx with no clock offset, and returns the
+ * ephemerides of the satellites. The epochs in the [first, last) gaps have
+ * no valid pseudorange.
+ */
+std::map<int,Gps_Ephemeris> offline_pvt_test_write_dump(std::string filename, int epochs,
+        const std::vector<std::pair<int,int> >& gaps = std::vector<std::pair<int,int> >())
+{
+    std::map<int,Gps_Ephemeris> eph_map;
+    for (int prn = 1; prn <= OFFLINE_PVT_TEST_SATELLITES; prn++)
+        {
+            eph_map[prn] = offline_pvt_test_ephemeris(prn);
+        }
+    std::ofstream dump(filename.c_str(), std::ios::out | std::ios::binary);
+    for (int k = 0; k < epochs; k++)
+        {
+            double rx_time = 345600.0 + 0.001 * OFFLINE_PVT_TEST_EPOCH_PERIOD_MS * (k + 1);
+            bool gap = false;
+            for (unsigned int g = 0; g < gaps.size(); g++)
+                {
+                    if (k >= gaps[g].first and k < gaps[g].second) gap = true;
+                }
+            for (int channel = 0; channel < OFFLINE_PVT_TEST_CHANNELS; channel++)
+                {
+                    double record[OBSERVABLES_DUMP_FIELDS] = {rx_time, 0.0, 0.0, 0.0, 0.0};
+                    if (channel < OFFLINE_PVT_TEST_SATELLITES and !gap)
+                        {
+                            Gps_Ephemeris &eph = eph_map[channel + 1];
+                            // travel time, with the Earth rotation model of the solver
+                            double tau = 0.07;
+                            for (int iter = 0; iter < 4; iter++)
+                                {
+                                    eph.satellitePosition(rx_time - tau);
+                                    double dX = eph.d_satpos_X - offline_pvt_test_rx[0];
+                                    double dY = eph.d_satpos_Y - offline_pvt_test_rx[1];
+                                    double dZ = eph.d_satpos_Z - offline_pvt_test_rx[2];
+                                    double omegatau = OMEGA_EARTH_DOT * sqrt(dX*dX + dY*dY + dZ*dZ) / GPS_C_m_s;
+                                    double rot_X = cos(omegatau) * eph.d_satpos_X + sin(omegatau) * eph.d_satpos_Y - offline_pvt_test_rx[0];
+                                    double rot_Y = -sin(omegatau) * eph.d_satpos_X + cos(omegatau) * eph.d_satpos_Y - offline_pvt_test_rx[1];
+                                    tau = sqrt(rot_X*rot_X + rot_Y*rot_Y + dZ*dZ) / GPS_C_m_s;
+                                }
+                            double clock = eph.sv_clock_drift(rx_time - tau) + eph.sv_clock_relativistic_term(rx_time - tau);
+                            record[1] = 1000.0 * (rx_time - tau);
+                            record[2] = (tau - clock) * GPS_C_m_s;
+                            record[3] = 1.0;
+                            record[4] = channel + 1;
+                        }
+                    dump.write((char*)record, sizeof(record));
+                }
+        }
+    return eph_map;
+}
+
+
+/*
+ * Fixes of the PVT block, that solves the epochs of the dump one after the other
+ */
+std::vector<Pvt_Output_Record> offline_pvt_test_block_fixes(const Observables_Dump_Reader& reader, const std::map<int,Gps_Ephemeris>& eph_map, int output_rate_ms, int averaging_depth)
+{
+    gps_l1_ca_ls_pvt pvt(OFFLINE_PVT_TEST_CHANNELS, "", false);
+    pvt.set_averaging_depth(averaging_depth);
+    pvt.gps_ephemeris_map = eph_map;
+    std::vector<Pvt_Output_Record> block_fixes;
+    unsigned long int sample_counter = 0;
+    for (unsigned long int epoch = 0; epoch < reader.epochs(); epoch++)
+        {
+            sample_counter += OFFLINE_PVT_TEST_EPOCH_PERIOD_MS;
+            if ((sample_counter % output_rate_ms) != 0) continue;
+            std::map<int,Gnss_Synchro> gnss_pseudoranges_map;
+            double rx_time = reader.get_epoch(epoch, gnss_pseudoranges_map);
+            if (gnss_pseudoranges_map.size() > 0 and pvt.get_PVT(gnss_pseudoranges_map, rx_time, true))
+                {
+                    Pvt_Output_Record record;
+                    record.sample_counter = sample_counter;
+                    record.rx_time = rx_time;
+                    record.set_solution(&pvt);
+                    block_fixes.push_back(record);
+                }
+        }
+    return block_fixes;
+}
+
+
+/*
+ * Checks that the engine solves the fixes of the PVT block
+ */
+void offline_pvt_test_compare(const std::vector<Pvt_Output_Record>& block_fixes, const std::vector<Pvt_Output_Record>& fixes, int threads)
+{
+    ASSERT_EQ(block_fixes.size(), fixes.size()) << threads << " threads";
+    for (unsigned int i = 0; i < fixes.size(); i++)
+        {
+            ASSERT_EQ(block_fixes[i].sample_counter, fixes[i].sample_counter) << threads << " threads";
+            EXPECT_EQ(PVT_OUTPUT_GPS_FIX, fixes[i].type);
+            EXPECT_EQ(OFFLINE_PVT_TEST_SATELLITES, fixes[i].n_observables);
+            ASSERT_NEAR(block_fixes[i].d_latitude_d, fixes[i].d_latitude_d, 1e-9) << threads << " threads";
+            ASSERT_NEAR(block_fixes[i].d_longitude_d, fixes[i].d_longitude_d, 1e-9) << threads << " threads";
+            ASSERT_NEAR(block_fixes[i].d_height_m, fixes[i].d_height_m, 1e-4) << threads << " threads";
+            ASSERT_NEAR(block_fixes[i].d_avg_latitude_d, fixes[i].d_avg_latitude_d, 1e-9) << threads << " threads";
+            ASSERT_NEAR(block_fixes[i].d_avg_longitude_d, fixes[i].d_avg_longitude_d, 1e-9) << threads << " threads";
+            ASSERT_NEAR(block_fixes[i].d_avg_height_m, fixes[i].d_avg_height_m, 1e-4) << threads << " threads";
+        }
+}
+
+
+long long int offline_pvt_test_microseconds()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+
+TEST(Offline_Pvt_Engine_Test, ReadDump)
+{
+    std::string filename = "offline_pvt_engine_test_observables.dat";
+    offline_pvt_test_write_dump(filename, 10);
+    Observables_Dump_Reader reader;
+    ASSERT_TRUE(reader.open(filename, OFFLINE_PVT_TEST_CHANNELS));
+    EXPECT_EQ(10UL, reader.epochs());
+    std::map<int,Gnss_Synchro> gnss_pseudoranges_map;
+    double rx_time = reader.get_epoch(3, gnss_pseudoranges_map);
+    EXPECT_DOUBLE_EQ(345600.0 + 0.001 * OFFLINE_PVT_TEST_EPOCH_PERIOD_MS * 4, rx_time);
+    ASSERT_EQ((unsigned int)OFFLINE_PVT_TEST_SATELLITES, gnss_pseudoranges_map.size());
+    EXPECT_EQ(1u, gnss_pseudoranges_map.begin()->second.PRN);
+    EXPECT_LT(19.0e6, gnss_pseudoranges_map.begin()->second.Pseudorange_m);
+    EXPECT_EQ(0.0, reader.get_epoch(10, gnss_pseudoranges_map));
+    EXPECT_EQ(0u, gnss_pseudoranges_map.size());
+    reader.close();
+
+    // missing file and no channels
+    EXPECT_FALSE(reader.open("offline_pvt_engine_test_missing.dat", OFFLINE_PVT_TEST_CHANNELS));
+    EXPECT_FALSE(reader.open(filename, 0));
+    remove(filename.c_str());
+}
+
+
+
+TEST(Offline_Pvt_Engine_Test, SameFixesOnAnyNumberOfThreads)
+{
+    std::string filename = "offline_pvt_engine_test_observables.dat";
+    std::map<int,Gps_Ephemeris> eph_map = offline_pvt_test_write_dump(filename, FLAGS_size_offline_pvt_engine_test);
+    Observables_Dump_Reader reader;
+    ASSERT_TRUE(reader.open(filename, OFFLINE_PVT_TEST_CHANNELS));
+    Gps_Iono gps_iono;
+    Gps_Utc_Model gps_utc_model;
+    int output_rate_ms = 2 * OFFLINE_PVT_TEST_EPOCH_PERIOD_MS;
+
+    // the fixes of the PVT block
+    std::vector<Pvt_Output_Record> block_fixes = offline_pvt_test_block_fixes(reader, eph_map, output_rate_ms, 10);
+
+    // the first fixes fill the averaging window
+    ASSERT_EQ(reader.epochs() / 2 - 10, block_fixes.size());
+
+    // the receiver position
+    gps_l1_ca_ls_pvt pvt(OFFLINE_PVT_TEST_CHANNELS, "", false);
+    pvt.cart2geo(offline_pvt_test_rx[0], offline_pvt_test_rx[1], offline_pvt_test_rx[2], 4);
+    for (unsigned int i = 0; i < block_fixes.size(); i++)
+        {
+            ASSERT_NEAR(pvt.d_latitude_d, block_fixes[i].d_latitude_d, 1e-7);
+            ASSERT_NEAR(pvt.d_longitude_d, block_fixes[i].d_longitude_d, 1e-7);
+            ASSERT_NEAR(pvt.d_height_m, block_fixes[i].d_height_m, 0.01);
+        }
+
+    int threads[3] = {1, 3, 8};
+    for (int t = 0; t < 3; t++)
+        {
+            Offline_Pvt_Engine engine(OFFLINE_PVT_TEST_CHANNELS, OFFLINE_PVT_TEST_EPOCH_PERIOD_MS, output_rate_ms, 10, true, threads[t]);
+            engine.set_gps_navigation(eph_map, gps_iono, gps_utc_model);
+            EXPECT_EQ(reader.epochs() / 2, engine.fixes(reader));
+            std::vector<Pvt_Output_Record> fixes;
+            engine.solve(reader, 0, engine.fixes(reader), fixes);
+            offline_pvt_test_compare(block_fixes, fixes, threads[t]);
+        }
+    remove(filename.c_str());
+}
+
+
+
+TEST(Offline_Pvt_Engine_Test, InvalidEpochsBeforeARange)
+{
+    // 1250 fixes of two epochs. With 3 threads, the second range of the first
+    // batch starts at fix 342, and the second batch at fix 1024: the fixes
+    // just before them have no valid pseudoranges, so the averaging window of
+    // these ranges has to be filled with older fixes
+    std::string filename = "offline_pvt_engine_test_observables.dat";
+    std::vector<std::pair<int,int> > gaps;
+    gaps.push_back(std::pair<int,int>(2 * 335, 2 * 342));
+    gaps.push_back(std::pair<int,int>(2 * 1018, 2 * 1024));
+    std::map<int,Gps_Ephemeris> eph_map = offline_pvt_test_write_dump(filename, 2500, gaps);
+    Observables_Dump_Reader reader;
+    ASSERT_TRUE(reader.open(filename, OFFLINE_PVT_TEST_CHANNELS));
+    int output_rate_ms = 2 * OFFLINE_PVT_TEST_EPOCH_PERIOD_MS;
+    std::vector<Pvt_Output_Record> block_fixes = offline_pvt_test_block_fixes(reader, eph_map, output_rate_ms, 10);
+    ASSERT_EQ(1250u - 7u - 6u - 10u, block_fixes.size());
+
+    int threads[2] = {1, 3};
+    for (int t = 0; t < 2; t++)
+        {
+            Offline_Pvt_Engine engine(OFFLINE_PVT_TEST_CHANNELS, OFFLINE_PVT_TEST_EPOCH_PERIOD_MS, output_rate_ms, 10, true, threads[t]);
+            engine.set_gps_navigation(eph_map, Gps_Iono(), Gps_Utc_Model());
+            std::vector<Pvt_Output_Record> fixes;
+            engine.solve(reader, 0, engine.fixes(reader), fixes);
+            offline_pvt_test_compare(block_fixes, fixes, threads[t]);
+        }
+    remove(filename.c_str());
+}
+
+
+
+TEST(Offline_Pvt_Engine_Test, InvalidEpochsBeforeSeveralBatches)
+{
+    // 3500 fixes of two epochs, the first 2100 without valid pseudoranges:
+    // the ranges of the third batch are warmed up from the start of that
+    // batch, and the fixes of the fourth batch follow the third one
+    std::string filename = "offline_pvt_engine_test_observables.dat";
+    std::vector<std::pair<int,int> > gaps;
+    gaps.push_back(std::pair<int,int>(0, 2 * 2100));
+    std::map<int,Gps_Ephemeris> eph_map = offline_pvt_test_write_dump(filename, 7000, gaps);
+    Observables_Dump_Reader reader;
+    ASSERT_TRUE(reader.open(filename, OFFLINE_PVT_TEST_CHANNELS));
+    int output_rate_ms = 2 * OFFLINE_PVT_TEST_EPOCH_PERIOD_MS;
+    std::vector<Pvt_Output_Record> block_fixes = offline_pvt_test_block_fixes(reader, eph_map, output_rate_ms, 10);
+    ASSERT_EQ(3500u - 2100u - 10u, block_fixes.size());
+
+    int threads[2] = {1, 3};
+    for (int t = 0; t < 2; t++)
+        {
+            Offline_Pvt_Engine engine(OFFLINE_PVT_TEST_CHANNELS, OFFLINE_PVT_TEST_EPOCH_PERIOD_MS, output_rate_ms, 10, true, threads[t]);
+            engine.set_gps_navigation(eph_map, Gps_Iono(), Gps_Utc_Model());
+            std::vector<Pvt_Output_Record> fixes;
+            std::vector<Pvt_Output_Record> batch_fixes;
+            // batch by batch, as run() does
+            for (unsigned long int batch = 0; batch < engine.fixes(reader); batch += OFFLINE_PVT_BATCH_FIXES)
+                {
+                    engine.solve(reader, batch, OFFLINE_PVT_BATCH_FIXES, batch_fixes);
+                    fixes.insert(fixes.end(), batch_fixes.begin(), batch_fixes.end());
+                }
+            offline_pvt_test_compare(block_fixes, fixes, threads[t]);
+            // and again from the start
+            engine.solve(reader, 0, engine.fixes(reader), fixes);
+            offline_pvt_test_compare(block_fixes, fixes, threads[t]);
+        }
+    remove(filename.c_str());
+}
+
+
+
+TEST(Offline_Pvt_Engine_Test, Throughput)
+{
+    std::string filename = "offline_pvt_engine_test_observables.dat";
+    std::map<int,Gps_Ephemeris> eph_map = offline_pvt_test_write_dump(filename, FLAGS_size_offline_pvt_engine_test);
+    Observables_Dump_Reader reader;
+    ASSERT_TRUE(reader.open(filename, OFFLINE_PVT_TEST_CHANNELS));
+    int threads[2] = {1, (int)boost::thread::hardware_concurrency()};
+    for (int t = 0; t < 2; t++)
+        {
+            Offline_Pvt_Engine engine(OFFLINE_PVT_TEST_CHANNELS, OFFLINE_PVT_TEST_EPOCH_PERIOD_MS, OFFLINE_PVT_TEST_EPOCH_PERIOD_MS, 10, false, threads[t]);
+            engine.set_gps_navigation(eph_map, Gps_Iono(), Gps_Utc_Model());
+            std::vector<Pvt_Output_Record> fixes;
+            long long int begin = offline_pvt_test_microseconds();
+            engine.solve(reader, 0, engine.fixes(reader), fixes);
+            long long int end = offline_pvt_test_microseconds();
+            std::cout << fixes.size() << " offline PVT fixes solved on " << threads[t] << " threads in "
+                      << (end - begin) << " microseconds" << std::endl;
+            ASSERT_LE(0, end - begin);
+        }
+    remove(filename.c_str());
+}
@@ -0,0 +1,267 @@
+/*!
+ * \file satellite_position_cache_test.cc
+ * \brief  Checks the interpolated satellite positions and clock corrections
+ * of the satellite position cache against the direct evaluation of the
+ * ephemeris, and compares their speed.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cmath>
+#include <sys/time.h>
+#include "gps_ephemeris.h"
+#include "galileo_ephemeris.h"
+#include "satellite_position_cache.h"
+
+DEFINE_int32(size_satellite_position_cache_test, 100000, "Number of epochs evaluated by the satellite position cache benchmark");
+
+
+/*
+ * A GPS ephemeris with the orbit of a typical satellite
+ */
+Gps_Ephemeris satellite_position_cache_test_gps_ephemeris(double Toe, double M_0)
+{
+    Gps_Ephemeris eph;
+    eph.i_satellite_PRN = 5;
+    eph.d_Toe = Toe;
+    eph.d_Toc = Toe;
+    eph.d_sqrt_A = 5153.65;
+    eph.d_e_eccentricity = 0.0112;
+    eph.d_M_0 = M_0;
+    eph.d_Delta_n = 4.5e-9;
+    eph.d_OMEGA0 = -1.75;
+    eph.d_OMEGA = 0.83;
+    eph.d_OMEGA_DOT = -8.1e-9;
+    eph.d_i_0 = 0.96;
+    eph.d_IDOT = 2.5e-10;
+    eph.d_Cuc = -1.9e-6;
+    eph.d_Cus = 8.4e-6;
+    eph.d_Crc = 218.0;
+    eph.d_Crs = -37.0;
+    eph.d_Cic = 1.1e-7;
+    eph.d_Cis = -4.3e-8;
+    eph.d_A_f0 = 1.2e-4;
+    eph.d_A_f1 = 3.4e-12;
+    eph.d_A_f2 = 0.0;
+    return eph;
+}
+
+
+long long int satellite_position_cache_test_microseconds()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+
+TEST(Satellite_Position_Cache_Test, SameAsEphemeris)
+{
+    Gps_Ephemeris eph = satellite_position_cache_test_gps_ephemeris(345600.0, 0.4);
+    Satellite_Position_Cache<Gps_Ephemeris> cache;
+    double pos[3];
+    double vel[3];
+    // two hours at 20 Hz, around the end of the week
+    for (double t = 602000.0; t < 602000.0 + 7200.0; t += 0.05)
+        {
+            double tx = t - 0.07;
+            cache.position(5, eph, tx, pos, vel);
+            eph.satellitePosition(tx);
+            ASSERT_NEAR(eph.d_satpos_X, pos[0], 1e-6) << "t = " << t;
+            ASSERT_NEAR(eph.d_satpos_Y, pos[1], 1e-6) << "t = " << t;
+            ASSERT_NEAR(eph.d_satpos_Z, pos[2], 1e-6) << "t = " << t;
+            double clock = eph.sv_clock_drift(tx) + eph.sv_clock_relativistic_term(tx);
+            ASSERT_NEAR(clock, cache.clock_correction(5, eph, tx), 1e-15) << "t = " << t;
+        }
+
+    // the velocity is the derivative of the orbit
+    for (double t = 604000.0; t < 604000.0 + 1800.0; t += 7.3)
+        {
+            cache.position(5, eph, t, pos, vel);
+            double h = 1e-3;
+            eph.satellitePosition(t + h);
+            double after[3] = {eph.d_satpos_X, eph.d_satpos_Y, eph.d_satpos_Z};
+            eph.satellitePosition(t - h);
+            EXPECT_NEAR((after[0] - eph.d_satpos_X) / (2 * h), vel[0], 1e-3) << "t = " << t;
+            EXPECT_NEAR((after[1] - eph.d_satpos_Y) / (2 * h), vel[1], 1e-3) << "t = " << t;
+            EXPECT_NEAR((after[2] - eph.d_satpos_Z) / (2 * h), vel[2], 1e-3) << "t = " << t;
+        }
+
+    // the orbit has been evaluated about once per knot
+    EXPECT_LE(cache.d_evaluations, (unsigned long int)((7200.0 + 1800.0) / SATELLITE_POSITION_CACHE_KNOT_SPACING_S + 2 * SATELLITE_POSITION_CACHE_POINTS));
+}
+
+
+
+TEST(Satellite_Position_Cache_Test, NewEphemeris)
+{
+    Gps_Ephemeris eph = satellite_position_cache_test_gps_ephemeris(345600.0, 0.4);
+    Gps_Ephemeris new_eph = satellite_position_cache_test_gps_ephemeris(352800.0, 0.4 + 7200.0 * 1.4585e-4);
+    Satellite_Position_Cache<Gps_Ephemeris> cache;
+    double pos[3];
+    double t = 350000.0;
+    cache.position(5, eph, t, pos, NULL);
+    eph.satellitePosition(t);
+    EXPECT_NEAR(eph.d_satpos_X, pos[0], 1e-6);
+    unsigned long int evaluations = cache.d_evaluations;
+    cache.position(5, eph, t + 1.0, pos, NULL);
+    EXPECT_EQ(evaluations, cache.d_evaluations);
+
+    // the knots of the old ephemeris are not used anymore
+    cache.position(5, new_eph, t + 1.0, pos, NULL);
+    new_eph.satellitePosition(t + 1.0);
+    EXPECT_NEAR(new_eph.d_satpos_X, pos[0], 1e-6);
+    EXPECT_NEAR(new_eph.d_satpos_Y, pos[1], 1e-6);
+    EXPECT_NEAR(new_eph.d_satpos_Z, pos[2], 1e-6);
+    EXPECT_EQ(evaluations + SATELLITE_POSITION_CACHE_POINTS, cache.d_evaluations);
+
+    // other satellites have their own knots
+    cache.position(6, eph, t, pos, NULL);
+    eph.satellitePosition(t);
+    EXPECT_NEAR(eph.d_satpos_X, pos[0], 1e-6);
+    cache.clear();
+    cache.position(5, new_eph, t + 1.0, pos, NULL);
+    EXPECT_NEAR(new_eph.d_satpos_X, pos[0], 1e-6);
+}
+
+
+
+TEST(Satellite_Position_Cache_Test, Galileo)
+{
+    Galileo_Ephemeris eph;
+    eph.i_satellite_PRN = 11;
+    eph.t0e_1 = 86400.0;
+    eph.t0c_4 = 86400.0;
+    eph.A_1 = 5440.6;
+    eph.e_1 = 0.0003;
+    eph.M0_1 = -2.1;
+    eph.delta_n_3 = 3.1e-9;
+    eph.OMEGA_0_2 = 0.52;
+    eph.omega_2 = -0.6;
+    eph.OMEGA_dot_3 = -5.6e-9;
+    eph.i_0_2 = 0.97;
+    eph.iDot_2 = 1.0e-10;
+    eph.C_uc_3 = 1.0e-6;
+    eph.C_us_3 = 4.0e-6;
+    eph.C_rc_3 = 200.0;
+    eph.C_rs_3 = 20.0;
+    eph.C_ic_4 = 5.0e-8;
+    eph.C_is_4 = -2.0e-8;
+    eph.af0_4 = -3.0e-4;
+    eph.af1_4 = 1.0e-12;
+    eph.af2_4 = 0.0;
+    Satellite_Position_Cache<Galileo_Ephemeris> cache;
+    double pos[3];
+    for (double t = 86000.0; t < 86000.0 + 600.0; t += 0.1)
+        {
+            cache.position(11, eph, t, pos, NULL);
+            eph.satellitePosition(t);
+            ASSERT_NEAR(eph.d_satpos_X, pos[0], 1e-6) << "t = " << t;
+            ASSERT_NEAR(eph.d_satpos_Y, pos[1], 1e-6) << "t = " << t;
+            ASSERT_NEAR(eph.d_satpos_Z, pos[2], 1e-6) << "t = " << t;
+            double clock = eph.sv_clock_drift(t) + eph.sv_clock_relativistic_term(t);
+            ASSERT_NEAR(clock, cache.clock_correction(11, eph, t), 1e-15) << "t = " << t;
+        }
+}
+
+
+
+TEST(Satellite_Position_Cache_Test, ClockPolynomial)
+{
+    // af2 set to about the largest value of the navigation messages, so that
+    // the second order term shows up in the clock corrections
+    Gps_Ephemeris gps_eph = satellite_position_cache_test_gps_ephemeris(345600.0, 0.4);
+    gps_eph.d_A_f2 = 3.0e-15;
+    Satellite_Position_Cache<Gps_Ephemeris> gps_cache;
+    for (double t = 345600.0 - 7200.0; t < 345600.0 + 7200.0; t += 0.7)
+        {
+            double dt = t - gps_eph.d_Toc;
+            double drift = gps_eph.d_A_f0 + gps_eph.d_A_f1 * dt + gps_eph.d_A_f2 * dt * dt;
+            ASSERT_NEAR(drift, gps_eph.sv_clock_drift(t), 1e-15) << "t = " << t;
+            ASSERT_NEAR(drift + gps_eph.sv_clock_relativistic_term(t), gps_cache.clock_correction(5, gps_eph, t), 1e-15) << "t = " << t;
+        }
+
+    Galileo_Ephemeris galileo_eph;
+    galileo_eph.i_satellite_PRN = 11;
+    galileo_eph.t0e_1 = 86400.0;
+    galileo_eph.t0c_4 = 86400.0;
+    galileo_eph.A_1 = 5440.6;
+    galileo_eph.e_1 = 0.0003;
+    galileo_eph.af0_4 = -3.0e-4;
+    galileo_eph.af1_4 = 1.0e-12;
+    galileo_eph.af2_4 = 5.0e-17;
+    Satellite_Position_Cache<Galileo_Ephemeris> galileo_cache;
+    for (double t = 86400.0 - 7200.0; t < 86400.0 + 7200.0; t += 0.7)
+        {
+            double dt = t - galileo_eph.t0c_4;
+            double drift = galileo_eph.af0_4 + galileo_eph.af1_4 * dt + galileo_eph.af2_4 * dt * dt;
+            ASSERT_NEAR(drift, galileo_eph.sv_clock_drift(t), 1e-15) << "t = " << t;
+            ASSERT_NEAR(drift + galileo_eph.sv_clock_relativistic_term(t), galileo_cache.clock_correction(11, galileo_eph, t), 1e-15) << "t = " << t;
+        }
+}
+
+
+
+TEST(Satellite_Position_Cache_Test, EphemerisImplementation)
+{
+    Gps_Ephemeris eph = satellite_position_cache_test_gps_ephemeris(345600.0, 0.4);
+    double acc = 0.0;
+    long long int begin = satellite_position_cache_test_microseconds();
+    for (int n = 0; n < FLAGS_size_satellite_position_cache_test; n++)
+        {
+            double t = 345600.0 + 0.02 * n;
+            eph.satellitePosition(t);
+            acc += eph.d_satpos_X + eph.sv_clock_drift(t) + eph.sv_clock_relativistic_term(t);
+        }
+    long long int end = satellite_position_cache_test_microseconds();
+    std::cout << FLAGS_size_satellite_position_cache_test << " satellite positions and clocks computed from the ephemeris in "
+              << (end - begin) << " microseconds" << std::endl;
+    ASSERT_LE(0, end - begin);
+    EXPECT_NE(0.0, acc);
+}
+
+
+
+TEST(Satellite_Position_Cache_Test, CacheImplementation)
+{
+    Gps_Ephemeris eph = satellite_position_cache_test_gps_ephemeris(345600.0, 0.4);
+    Satellite_Position_Cache<Gps_Ephemeris> cache;
+    double pos[3];
+    double acc = 0.0;
+    long long int begin = satellite_position_cache_test_microseconds();
+    for (int n = 0; n < FLAGS_size_satellite_position_cache_test; n++)
+        {
+            double t = 345600.0 + 0.02 * n;
+            cache.position(5, eph, t, pos, NULL);
+            acc += pos[0] + cache.clock_correction(5, eph, t);
+        }
+    long long int end = satellite_position_cache_test_microseconds();
+    std::cout << FLAGS_size_satellite_position_cache_test << " satellite positions and clocks interpolated by the cache in "
+              << (end - begin) << " microseconds" << std::endl;
+    ASSERT_LE(0, end - begin);
+    EXPECT_NE(0.0, acc);
+}
@@ -0,0 +1,254 @@
+/*!
+ * \file viterbi_decoder_test.cc
+ * \brief Checks the table-driven Viterbi_Decoder on symbol sequences decoded
+ * by the decoders that it replaces, and on encoded random bits.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+
+#include <random>
+#include <vector>
+#include "viterbi_decoder.h"
+
+
+/*
+ * Known answers of the previous decoders. The symbols are 4 * (+/-1) plus
+ * Gaussian noise of sigma 3.6, rounded, so that some bits are decoded wrong.
+ *
+ * A Galileo E1B page part (114 bits and the 6 zero tail bits) and its bits
+ * decoded by Viterbi() of the old convolutional.h:
+ */
+const signed char viterbi_test_block_symbols[240] = {
+         -9,  -9,  -7,  -6,   5,   5,  -7,  10,  -9,   5,  -3,  -5,  -3,   0,  -5,  -5,   5,   4,   5,   3,
+         -5, -12,   1,   9,   1,  -5,   9,  -8,  -5,   1,  -4,  -2,  -6,  -4,  -1,   1,   1,   7,  -4,   5,
+         -1,  -4,   1,  -3,   2,   6,  -6,   5,   5,   1,   6,  -1,   2, -11,  -9,   8,   5,   8,   2,  -8,
+          3,  -3,   7,   1,  -6,   5,   3,  -7,   6,   5,   3,   5, -10,   8,   3,  -5,  -3,   5,   1,   1,
+          5,  -1,  -3,  -6,   2,   0,   0,  -5,  -8,  -4,  -1,   7,   6,  -1,  -3,  -3,   3,  -4,  -5,  -6,
+        -11,   3,  -6,   2,  -4,   0,   5,   1,   1,  -4,   1,  12,   0,  -4,  -1,  -1,  -6,  -5,   3,  -1,
+         -8,  -4,  -3,   2,  -2,   0,   5,   7,  -6,   0,   0,   5,   2,   2,  -5,   8,   0,   6,  -1,   2,
+         -5,  -6,  11,   7,  14,  -5,   7,   1,   1,  -4,  -5,  -8,   3,  -9,  -3,   5,  -6,  -6,  -4,  -3,
+          2, -11,   2,  -5,   4,   2,  -6,  -7,   0,   2,   6, -10,   2,  -1,  -4,   3,   2,   4,  -5,   4,
+          8,   0,  -5,   3,  -9,  -3,   4,  -4,   5,   6,  -6,  -2,   8,  -1,  -6,  -2,   3,   4,  -4,  -3,
+          1,  -7,   4,   8,   1,   4,   5,  -6,   4,  -1,  -7,  -2,  -1,   4,   8,   4,  15,   8,  -7,  -6,
+         -1,   5,  12,  13,   3,  -3,   6,  -6,   9,   6,   0,   3,  -6,   0,   4,   5,   6,   3,  -8,  -3
+};
+const char viterbi_test_block_bits[] =
+        "0011001100101010010101110001100000011110110000010101101100010001"
+        "11110110011111100111101101011000101110000100000010";
+
+
+/*
+ * A stream of 300 bits decoded in chunks by the old Viterbi_Decoder class,
+ * with the traceback depth of the SBAS telemetry decoder: bits requested,
+ * bits decoded and indicator metric of each call, and all the decoded bits.
+ */
+const float viterbi_test_continuous_calls[5][3] = {
+        {60, 25, 8.39999962f},
+        {1, 1, 9.0f},
+        {150, 150, 7.57333326f},
+        {37, 37, 8.4594593f},
+        {52, 52, 7.88461542f}
+};
+const signed char viterbi_test_continuous_symbols[600] = {
+         -1,   1,  -3,   2,  -9,  -1,   2,   7,   4,  -3,   8,  -1,   0,   3,   9,   0,  -7,  -4,   4,   1,
+         -4,  -2,   3,  -7,   2,  -8,  -3,  -7,   0,  -4,  -7,  11,   3,  -5,   0,   6,  -5, -10, -14,  -2,
+          6,  -1,  -5,  -6,  -3,   7,   5,   1,   7,   2,   2,  -7,   4,  -2,  -6,   8,   0,  -4,  -6,  -3,
+         -5,   0,   7,   3,   7,  -4,  -4,  -4,   9,   2,  -2,  -3,   6,   2,   3,   2,  -6,  -6,   1,   2,
+          2,  10,  -5,   4,  -3, -10,  -2,  -3,   1,   1,   7,  -4,   1,  -2,  -8,   1,   0,   4, -10,  -7,
+          4,   2,  -4,  -6,   4,  -5,   1,   3,   9,   1,  -9,   5,   7,  -1,  -5,   0,  -8,  -9,   3,   1,
+          0,   5,   2,   1,  -2,   3,   3,  -4,   2,  -2,  -4,  -3,   2,  -2,   8,   5,   5,   2,   2,   4,
+          0,  -4,  -9,   6,  -2,  -4,   5,   4,  -1,  -3,  -3,   3,   7,  -4,  -1,  -4,  -6,  -6,   4,   2,
+          2,   1,   1,  -8,   2,   7,  -6,   2,  -7,  10,   7,   0,   2,   5, -10,   2,   0,  -4,   3,   1,
+          2,   9,   2,   7,  -9,   3,   9,   1,  -4,   3,  10,  -4,  -6,   3,   8,  -5,   0,  -1,  11,   8,
+          6,   1,  -1,   0,   5, -10,   4,   1,   2,  -2,  -5,  -8,   9,   1,   2,   3,   1,  -7,  -7,  -4,
+         -5,  -6,  -1,  -3,   4,  -1,  -2,  -2,  -5,  -4,   4,  -4,  -4,   3,   4,   6,  -2,  -7,  -6,   1,
+         -1,  -7,   6,   0,   3,   6,   5,  -3,   8,   7,  -2,   3,   5,  -3,   1,  -4,  -6,   5,  -7,  -4,
+          0,   5,  -6,  -3,  -3,  -2,   5,   2,   2,  -1,   1,   7,   1, -11,  -5,  -4,   5,   4,  -2,   9,
+          8,  11,   4,  -7, -10,   7,   1,  -5,   4,   6, -11,   6,   2,  -3,  -1,   9,   4,  -7,   2,  -6,
+          9,   2,   3,  -2,  -7,   4,   5,  -3, -10,   0,  -1,   0,   1,  -3,   2,   2,  -3,  -1,   7,  -4,
+          3,  10,  -2,  -3,  -2,  -5,  -4,   3,   0,   2, -10,   2,   6,   2,  -4,  -3,   9,  -7,  -5,   1,
+          2,  -3,  -7,  -2,  -7,  -7,   7,   7,  -8,  -2,  -2,  -2,  -3,   8,  -8,  11,  -9,   4,  -1,  -3,
+          2,   7,   6,  -6,  -6,  -8, -10,   2,  10,  -7,   6,   4,  -7,   7,   4,  -1,   0,   9,  -5,  -3,
+          0,  -5,  -6,   0,   5,  -2,  -4,  -3,   4,  -3,   5,  -2,   1,  -6,   1,  -2,   6,  -1,   8,  -3,
+         -7,  -9,  -6,   4,  -3,  -6,  -6,  -1,   4,  -4,   3,   1,   3,   1,   5,  -1,  -5,  -3,  -1,   3,
+          0,   8,   8,   5,  -5,  -3,   7,  -3,  -2,   2,  -1,  -3,   5,  -8,   4,   1,  -5,  -4,  -5,  -3,
+          7,  -9,   1,   9,   2,   4,   6,  -2,  -2,   6,  -5,  -5,   5,   0,   7,   2,   0,  -3,  -7,  -3,
+          0,   5,  -6,  -2,   7,   2,   2,   3,  -8,   4,  -1,  -4,  -7,  -4,  -1,  -6,  10,   1,  -6,  -4,
+          3,   6,   9,   6,   0,   5, -10,  -6,  12,   3,   3,  -4,   4,  -2,  -4,  -5,   1,  13,  -4,   6,
+         -5,  -6,  -2,  -5,  -3,  -5,  -7,  -5, -10,  10,   5,   8,   9,  -6,  -4,  -1,  -9,   3,  -5,  -4,
+          1,   2,   0,   4,  -5,  -4,   2,  -5,  -8,   4,   7,  -3,  -6, -10,   3,  -6,  -9,  -5,   0,   6,
+        -10,   1,   2,  -3,   4,  -7,  -2,  -7,   6,  -5,   3,  -2,   1,  -5,   5,   2,  -8,  -6,  -4,  -2,
+          7,  -5, -10,  -2,  -1,   0,  -1, -11,  -6,   2,  -9,  -1,  -7, -10,   2,   7,  -2,   6,  -3,  -3,
+         -8,   7, -11,  -6,  -7,   7,  -6,  -9,  -6,  10,  -2,  -1,   8,   6,  -3,  -9,  -1,  -3,  -1,  -4
+};
+const char viterbi_test_continuous_bits[] =
+        "1101111111001011101011100001100010100010101011001101111011110000"
+        "0100011101001100011110000001111001100011000100100001001100011100"
+        "1000011001001010011110100101001111000111000101001010001101000111"
+        "0000010011011111111100000000011110101111101110011001010111111010"
+        "111001011";
+
+
+
+/*
+ * Encodes the bits (G1 = 171, G2 = 133 octal, starting at the all-zeros state)
+ * as LLR symbols of the given amplitude plus Gaussian noise
+ */
+std::vector<double> viterbi_test_symbols(const std::vector<int> &bits, double amplitude, double sigma, std::mt19937 &generator)
+{
+    std::normal_distribution<double> noise(0.0, sigma);
+    std::vector<double> symbols;
+    int state = 0;
+    for (unsigned int i = 0; i < bits.size(); i++)
+        {
+            int reg = (bits[i] << 6) | state;
+            symbols.push_back((__builtin_parity(reg & 0171) ? amplitude : -amplitude) + noise(generator));
+            symbols.push_back((__builtin_parity(reg & 0133) ? amplitude : -amplitude) + noise(generator));
+            state = reg >> 1;
+        }
+    return symbols;
+}
+
+
+std::vector<int> viterbi_test_bits(int n_bits, std::mt19937 &generator)
+{
+    std::uniform_int_distribution<int> random_bit(0, 1);
+    std::vector<int> bits(n_bits);
+    for (int i = 0; i < n_bits; i++) bits[i] = random_bit(generator);
+    return bits;
+}
+
+
+
+TEST(Viterbi_Decoder_Test, BlockDecodingAsReference)
+{
+    const int data_length = 114;
+    std::vector<double> symbols(viterbi_test_block_symbols, viterbi_test_block_symbols + 2 * (data_length + VITERBI_KK - 1));
+    std::vector<int> decoded_bits(data_length);
+    Viterbi_Decoder decoder;
+    decoder.decode_block(symbols.data(), decoded_bits.data(), data_length);
+    for (int i = 0; i < data_length; i++)
+        {
+            EXPECT_EQ(viterbi_test_block_bits[i] - '0', decoded_bits[i]) << "bit " << i;
+        }
+}
+
+
+
+TEST(Viterbi_Decoder_Test, ContinuousDecodingAsReference)
+{
+    const int traceback_depth = 5 * VITERBI_KK;
+    const int n_calls = sizeof(viterbi_test_continuous_calls) / sizeof(viterbi_test_continuous_calls[0]);
+    std::vector<double> symbols(viterbi_test_continuous_symbols,
+            viterbi_test_continuous_symbols + sizeof(viterbi_test_continuous_symbols));
+    Viterbi_Decoder decoder;
+    std::vector<int> decoded_bits;
+    int bit = 0;
+    for (int call = 0; call < n_calls; call++)
+        {
+            int nbits_requested = viterbi_test_continuous_calls[call][0];
+            std::vector<int> decoded_chunk(nbits_requested);
+            int nbits_decoded;
+            float metric = decoder.decode_continuous(&symbols[VITERBI_NN * bit], traceback_depth,
+                    decoded_chunk.data(), nbits_requested, nbits_decoded);
+            ASSERT_EQ((int)viterbi_test_continuous_calls[call][1], nbits_decoded) << "call " << call;
+            EXPECT_FLOAT_EQ(viterbi_test_continuous_calls[call][2], metric) << "call " << call;
+            decoded_bits.insert(decoded_bits.end(), decoded_chunk.begin(), decoded_chunk.begin() + nbits_decoded);
+            bit += nbits_requested;
+        }
+    ASSERT_EQ(sizeof(viterbi_test_continuous_bits) - 1, decoded_bits.size());
+    for (unsigned int i = 0; i < decoded_bits.size(); i++)
+        {
+            EXPECT_EQ(viterbi_test_continuous_bits[i] - '0', decoded_bits[i]) << "bit " << i;
+        }
+}
+
+
+
+/*
+ * Galileo E1B page parts: the encoded bits are decoded back, without errors
+ * if the noise is low
+ */
+TEST(Viterbi_Decoder_Test, BlockEncodeDecode)
+{
+    const int data_length = 114;
+    std::mt19937 generator(32);
+    Viterbi_Decoder decoder;
+    int bit_errors = 0;
+    for (int block = 0; block < 200; block++)
+        {
+            std::vector<int> bits = viterbi_test_bits(data_length, generator);
+            bits.resize(data_length + VITERBI_KK - 1, 0);
+            double sigma = (block % 2 == 0) ? 0.3 : 0.7;
+            std::vector<double> symbols = viterbi_test_symbols(bits, 1.0, sigma, generator);
+            std::vector<int> decoded_bits(data_length);
+            decoder.decode_block(symbols.data(), decoded_bits.data(), data_length);
+            bits.resize(data_length);
+            if (block % 2 == 0)
+                {
+                    ASSERT_EQ(bits, decoded_bits) << "block " << block;
+                }
+            for (int i = 0; i < data_length; i++) bit_errors += (decoded_bits[i] != bits[i]);
+        }
+    EXPECT_GT(200 * data_length / 100, bit_errors); // less than 1 % with the noisier blocks
+}
+
+
+
+/*
+ * SBAS: a stream of encoded bits decoded in chunks of any length gives back
+ * the bits, all but the last traceback_depth ones
+ */
+TEST(Viterbi_Decoder_Test, ContinuousEncodeDecode)
+{
+    const int traceback_depth = 5 * VITERBI_KK;
+    const int chunk_bits[4] = {60, 1, 250, 37};
+    std::mt19937 generator(35);
+    std::vector<int> bits = viterbi_test_bits(20000, generator);
+    std::vector<double> symbols = viterbi_test_symbols(bits, 1.0, 0.3, generator);
+
+    Viterbi_Decoder decoder;
+    std::vector<int> decoded_bits;
+    int bit = 0;
+    for (int chunk = 0; bit < (int)bits.size(); chunk++)
+        {
+            int nbits_requested = chunk_bits[chunk % 4];
+            if (bit + nbits_requested > (int)bits.size()) nbits_requested = bits.size() - bit;
+            std::vector<int> decoded_chunk(nbits_requested);
+            int nbits_decoded;
+            decoder.decode_continuous(&symbols[VITERBI_NN * bit], traceback_depth,
+                    decoded_chunk.data(), nbits_requested, nbits_decoded);
+            ASSERT_LE(nbits_decoded, nbits_requested) << "chunk " << chunk;
+            if (nbits_decoded > 0)
+                {
+                    decoded_bits.insert(decoded_bits.end(), decoded_chunk.begin(), decoded_chunk.begin() + nbits_decoded);
+                }
+            bit += nbits_requested;
+        }
+    ASSERT_EQ(bits.size() - traceback_depth, decoded_bits.size());
+    EXPECT_TRUE(std::equal(decoded_bits.begin(), decoded_bits.end(), bits.begin()));
+}
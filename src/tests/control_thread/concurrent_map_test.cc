@@ -0,0 +1,124 @@
+/*!
+ * \file concurrent_map_test.cc
+ * \brief  This file implements tests for the snapshots of concurrent_map.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <map>
+#include <boost/thread/thread.hpp>
+#include "concurrent_map.h"
+
+
+
+
+TEST(Concurrent_Map_Test, SnapshotsDoNotChange)
+{
+    concurrent_map<double> the_map;
+    EXPECT_EQ(0u, the_map.version());
+    EXPECT_EQ(0, the_map.size());
+
+    the_map.write(1, 1.0);
+    boost::shared_ptr<const std::map<int, double> > snapshot = the_map.get_map_snapshot();
+    the_map.write(1, 2.0);
+    the_map.write(2, 3.0);
+
+    EXPECT_EQ(3u, the_map.version());
+    ASSERT_EQ(1u, snapshot->size());
+    EXPECT_EQ(1.0, snapshot->at(1));
+
+    double value = 0.0;
+    EXPECT_TRUE(the_map.read(1, value));
+    EXPECT_EQ(2.0, value);
+    EXPECT_FALSE(the_map.read(3, value));
+    EXPECT_EQ(2, the_map.size());
+}
+
+
+
+
+TEST(Concurrent_Map_Test, CopyOnlyIfChanged)
+{
+    concurrent_map<double> the_map;
+    unsigned int map_version = 0;
+    unsigned int value_version = 0;
+    std::map<int, double> copy;
+    double value = 0.0;
+
+    EXPECT_FALSE(the_map.get_map_copy_if_changed(map_version, copy));
+    EXPECT_FALSE(the_map.read_if_changed(0, value_version, value));
+
+    the_map.write(0, 5.0);
+    EXPECT_TRUE(the_map.get_map_copy_if_changed(map_version, copy));
+    EXPECT_EQ(5.0, copy[0]);
+    EXPECT_FALSE(the_map.get_map_copy_if_changed(map_version, copy));
+    EXPECT_TRUE(the_map.read_if_changed(0, value_version, value));
+    EXPECT_EQ(5.0, value);
+    EXPECT_FALSE(the_map.read_if_changed(0, value_version, value));
+}
+
+
+
+
+void concurrent_map_test_writer(concurrent_map<int> *the_map, int n_writes)
+{
+    for (int i = 1; i <= n_writes; i++)
+        {
+            the_map->write(i % 8, i);
+        }
+}
+
+
+TEST(Concurrent_Map_Test, ReadersSeeCompleteWrites)
+{
+    concurrent_map<int> the_map;
+    const int n_writes = 20000;
+    boost::thread writer(concurrent_map_test_writer, &the_map, n_writes);
+    unsigned int last_version = 0;
+    std::map<int, int> copy;
+    int last_newest = 0;
+    while (last_newest < n_writes)
+        {
+            if (the_map.get_map_copy_if_changed(last_version, copy))
+                {
+                    // every snapshot holds the last write of each key up to its newest write
+                    int newest = 0;
+                    for (std::map<int, int>::const_iterator it = copy.begin(); it != copy.end(); ++it)
+                        {
+                            if (it->second > newest) newest = it->second;
+                        }
+                    for (std::map<int, int>::const_iterator it = copy.begin(); it != copy.end(); ++it)
+                        {
+                            EXPECT_GT(it->second, newest - 8);
+                            EXPECT_EQ(it->first, it->second % 8);
+                        }
+                    EXPECT_GE(newest, last_newest);
+                    last_newest = newest;
+                }
+        }
+    writer.join();
+    EXPECT_EQ((unsigned int)n_writes, the_map.version());
+}
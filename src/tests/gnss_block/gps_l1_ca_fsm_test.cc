@@ -0,0 +1,300 @@
+/*!
+ * \file gps_l1_ca_fsm_test.cc
+ * \brief  Replays random event sequences through the table-driven channel
+ * and subframe state machines and through reference boost::statechart
+ * implementations of the same machines, and checks that both behave the same.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cstring>
+#include <random>
+#include <vector>
+#include <boost/statechart/state_machine.hpp>
+#include <boost/statechart/state.hpp>
+#include <boost/statechart/transition.hpp>
+#include <boost/mpl/list.hpp>
+#include <gnuradio/msg_queue.h>
+#include "gps_l1_ca_channel_fsm.h"
+#include "gps_l1_ca_subframe_fsm.h"
+
+
+/*
+ * Reference implementations: the boost::statechart machines that the table
+ * driven ones replaced. They record the entered states instead of running
+ * the entry actions.
+ */
+struct Ref_Ev_start_acquisition : boost::statechart::event<Ref_Ev_start_acquisition> {};
+struct Ref_Ev_valid_acquisition : boost::statechart::event<Ref_Ev_valid_acquisition> {};
+struct Ref_Ev_failed_acquisition_repeat : boost::statechart::event<Ref_Ev_failed_acquisition_repeat> {};
+struct Ref_Ev_failed_acquisition_no_repeat : boost::statechart::event<Ref_Ev_failed_acquisition_no_repeat> {};
+struct Ref_Ev_failed_tracking_standby : boost::statechart::event<Ref_Ev_failed_tracking_standby> {};
+
+struct Ref_channel_S0;
+struct Ref_channel_S1;
+struct Ref_channel_S2;
+struct Ref_channel_S3;
+
+struct Ref_Channel_Fsm : boost::statechart::state_machine<Ref_Channel_Fsm, Ref_channel_S0>
+{
+    Ref_Channel_Fsm() : state(0) { entered[0] = entered[1] = entered[2] = entered[3] = 0; }
+    void enter(int s) { state = s; entered[s]++; }
+    int state;
+    int entered[4];
+};
+
+struct Ref_channel_S0 : boost::statechart::state<Ref_channel_S0, Ref_Channel_Fsm>
+{
+    typedef boost::statechart::transition<Ref_Ev_start_acquisition, Ref_channel_S1> reactions;
+    Ref_channel_S0(my_context ctx) : my_base(ctx) { context<Ref_Channel_Fsm>().enter(0); }
+};
+
+struct Ref_channel_S1 : boost::statechart::state<Ref_channel_S1, Ref_Channel_Fsm>
+{
+    typedef boost::mpl::list<boost::statechart::transition<Ref_Ev_failed_acquisition_no_repeat, Ref_channel_S3>,
+            boost::statechart::transition<Ref_Ev_failed_acquisition_repeat, Ref_channel_S1>,
+            boost::statechart::transition<Ref_Ev_valid_acquisition, Ref_channel_S2> > reactions;
+    Ref_channel_S1(my_context ctx) : my_base(ctx) { context<Ref_Channel_Fsm>().enter(1); }
+};
+
+struct Ref_channel_S2 : boost::statechart::state<Ref_channel_S2, Ref_Channel_Fsm>
+{
+    typedef boost::mpl::list<boost::statechart::transition<Ref_Ev_failed_tracking_standby, Ref_channel_S0>,
+            boost::statechart::transition<Ref_Ev_start_acquisition, Ref_channel_S1> > reactions;
+    Ref_channel_S2(my_context ctx) : my_base(ctx) { context<Ref_Channel_Fsm>().enter(2); }
+};
+
+struct Ref_channel_S3 : boost::statechart::state<Ref_channel_S3, Ref_Channel_Fsm>
+{
+    typedef boost::statechart::transition<Ref_Ev_start_acquisition, Ref_channel_S1> reactions;
+    Ref_channel_S3(my_context ctx) : my_base(ctx) { context<Ref_Channel_Fsm>().enter(3); }
+};
+
+
+struct Ref_Ev_word_valid : boost::statechart::event<Ref_Ev_word_valid> {};
+struct Ref_Ev_word_invalid : boost::statechart::event<Ref_Ev_word_invalid> {};
+struct Ref_Ev_word_preamble : boost::statechart::event<Ref_Ev_word_preamble> {};
+
+template <int N> struct Ref_subframe_S;
+
+struct Ref_Subframe_Fsm : boost::statechart::state_machine<Ref_Subframe_Fsm, Ref_subframe_S<0> >
+{
+    Ref_Subframe_Fsm() : state(0), subframes(0) { std::memset(subframe, 0, sizeof(subframe)); }
+    void enter(int s)
+    {
+        state = s;
+        if (s >= 2) std::memcpy(&subframe[(s - 2) * GPS_WORD_LENGTH], word, GPS_WORD_LENGTH);
+        if (s == 11) subframes++;
+    }
+    int state;
+    int subframes;
+    char word[GPS_WORD_LENGTH];
+    char subframe[GPS_SUBFRAME_LENGTH];
+};
+
+// S1 to S10: an invalid word restarts the search, a valid one moves to the next word
+template <int N> struct Ref_subframe_S : boost::statechart::state<Ref_subframe_S<N>, Ref_Subframe_Fsm>
+{
+    typedef boost::statechart::state<Ref_subframe_S<N>, Ref_Subframe_Fsm> base;
+    typedef boost::mpl::list<boost::statechart::transition<Ref_Ev_word_invalid, Ref_subframe_S<0> >,
+            boost::statechart::transition<Ref_Ev_word_valid, Ref_subframe_S<N + 1> > > reactions;
+    Ref_subframe_S(typename base::my_context ctx) : base(ctx) { this->template context<Ref_Subframe_Fsm>().enter(N); }
+};
+
+template <> struct Ref_subframe_S<0> : boost::statechart::state<Ref_subframe_S<0>, Ref_Subframe_Fsm>
+{
+    typedef boost::statechart::transition<Ref_Ev_word_preamble, Ref_subframe_S<1> > reactions;
+    Ref_subframe_S(my_context ctx) : my_base(ctx) { context<Ref_Subframe_Fsm>().enter(0); }
+};
+
+template <> struct Ref_subframe_S<11> : boost::statechart::state<Ref_subframe_S<11>, Ref_Subframe_Fsm>
+{
+    typedef boost::statechart::transition<Ref_Ev_word_preamble, Ref_subframe_S<1> > reactions;
+    Ref_subframe_S(my_context ctx) : my_base(ctx) { context<Ref_Subframe_Fsm>().enter(11); }
+};
+
+
+
+/*
+ * Acquisition and tracking that count the calls of the channel FSM entry actions
+ */
+class Fsm_Test_Acquisition : public AcquisitionInterface
+{
+public:
+    Fsm_Test_Acquisition() : resets(0) {}
+    std::string role() { return "Acquisition"; }
+    std::string implementation() { return "Fsm_Test_Acquisition"; }
+    size_t item_size() { return 0; }
+    void connect(gr::top_block_sptr top_block) {}
+    void disconnect(gr::top_block_sptr top_block) {}
+    gr::basic_block_sptr get_left_block() { return gr::basic_block_sptr(); }
+    gr::basic_block_sptr get_right_block() { return gr::basic_block_sptr(); }
+    void set_gnss_synchro(Gnss_Synchro* gnss_synchro) {}
+    void set_channel(unsigned int channel) {}
+    void set_threshold(float threshold) {}
+    void set_doppler_max(unsigned int doppler_max) {}
+    void set_doppler_step(unsigned int doppler_step) {}
+    void set_channel_queue(concurrent_queue<int> *channel_internal_queue) {}
+    void init() {}
+    void set_local_code() {}
+    signed int mag() { return 0; }
+    void reset() { resets++; }
+    int resets;
+};
+
+class Fsm_Test_Tracking : public TrackingInterface
+{
+public:
+    Fsm_Test_Tracking() : starts(0) {}
+    std::string role() { return "Tracking"; }
+    std::string implementation() { return "Fsm_Test_Tracking"; }
+    size_t item_size() { return 0; }
+    void connect(gr::top_block_sptr top_block) {}
+    void disconnect(gr::top_block_sptr top_block) {}
+    gr::basic_block_sptr get_left_block() { return gr::basic_block_sptr(); }
+    gr::basic_block_sptr get_right_block() { return gr::basic_block_sptr(); }
+    void start_tracking() { starts++; }
+    void set_gnss_synchro(Gnss_Synchro* gnss_synchro) {}
+    void set_channel(unsigned int channel) {}
+    void set_channel_queue(concurrent_queue<int> *channel_internal_queue) {}
+    int starts;
+};
+
+
+
+TEST(GpsL1CaFsmTest, ChannelFsmMatchesStatechart)
+{
+    std::mt19937 generator(38);
+    std::uniform_int_distribution<int> random_event(0, GPS_CHANNEL_FSM_EVENTS - 1);
+    for (int sequence = 0; sequence < 20; sequence++)
+        {
+            Fsm_Test_Acquisition acquisition;
+            Fsm_Test_Tracking tracking;
+            boost::shared_ptr<gr::msg_queue> queue = gr::msg_queue::make(0);
+            GpsL1CaChannelFsm fsm(&acquisition);
+            fsm.set_tracking(&tracking);
+            fsm.set_queue(queue);
+            Ref_Channel_Fsm reference;
+            reference.initiate();
+            int satellite_requests = 0;
+            EXPECT_EQ(GPS_CHANNEL_FSM_IDLE_S0, fsm.state());
+
+            for (int n = 0; n < 500; n++)
+                {
+                    int event = random_event(generator);
+                    switch (event)
+                    {
+                    case GPS_CHANNEL_FSM_EV_START_ACQUISITION:
+                        fsm.Event_gps_start_acquisition();
+                        reference.process_event(Ref_Ev_start_acquisition());
+                        break;
+                    case GPS_CHANNEL_FSM_EV_VALID_ACQUISITION:
+                        fsm.Event_gps_valid_acquisition();
+                        reference.process_event(Ref_Ev_valid_acquisition());
+                        break;
+                    case GPS_CHANNEL_FSM_EV_FAILED_ACQUISITION_REPEAT:
+                        fsm.Event_gps_failed_acquisition_repeat();
+                        reference.process_event(Ref_Ev_failed_acquisition_repeat());
+                        break;
+                    case GPS_CHANNEL_FSM_EV_FAILED_ACQUISITION_NO_REPEAT:
+                        fsm.Event_gps_failed_acquisition_no_repeat();
+                        reference.process_event(Ref_Ev_failed_acquisition_no_repeat());
+                        break;
+                    default:
+                        fsm.Event_gps_failed_tracking_standby();
+                        reference.process_event(Ref_Ev_failed_tracking_standby());
+                        break;
+                    }
+                    // the tracking and satellite request entry actions both send a control message
+                    satellite_requests = queue->count() - tracking.starts;
+                    ASSERT_EQ(reference.state, fsm.state()) << "sequence " << sequence << " event " << n;
+                    ASSERT_EQ(reference.entered[1], acquisition.resets) << "sequence " << sequence << " event " << n;
+                    ASSERT_EQ(reference.entered[2], tracking.starts) << "sequence " << sequence << " event " << n;
+                    ASSERT_EQ(reference.entered[3], satellite_requests) << "sequence " << sequence << " event " << n;
+                }
+        }
+}
+
+
+
+TEST(GpsL1CaFsmTest, SubframeFsmMatchesStatechart)
+{
+    concurrent_queue<Gps_Ephemeris> ephemeris_queue;
+    concurrent_queue<Gps_Iono> iono_queue;
+    concurrent_queue<Gps_Utc_Model> utc_model_queue;
+    concurrent_queue<Gps_Almanac> almanac_queue;
+
+    GpsL1CaSubframeFsm fsm;
+    fsm.i_channel_ID = 0;
+    fsm.i_satellite_PRN = 1;
+    fsm.d_preamble_time_ms = 0.0;
+    fsm.d_ephemeris_queue = &ephemeris_queue;
+    fsm.d_iono_queue = &iono_queue;
+    fsm.d_utc_model_queue = &utc_model_queue;
+    fsm.d_almanac_queue = &almanac_queue;
+    std::memset(fsm.d_subframe, 0, sizeof(fsm.d_subframe));
+    Ref_Subframe_Fsm reference;
+    reference.initiate();
+    EXPECT_EQ(GPS_SUBFRAME_FSM_S0, fsm.state());
+
+    // mostly valid words, so that complete subframes are assembled
+    std::mt19937 generator(38);
+    std::discrete_distribution<int> random_event({90, 5, 5});
+    std::uniform_int_distribution<int> random_byte(0, 255);
+    int subframes = 0;
+    for (int n = 0; n < 5000; n++)
+        {
+            for (int i = 0; i < GPS_WORD_LENGTH; i++)
+                {
+                    fsm.d_GPS_frame_4bytes[i] = reference.word[i] = static_cast<char>(random_byte(generator));
+                }
+            int event = random_event(generator);
+            switch (event)
+            {
+            case GPS_SUBFRAME_FSM_EV_WORD_VALID:
+                fsm.Event_gps_word_valid();
+                reference.process_event(Ref_Ev_word_valid());
+                break;
+            case GPS_SUBFRAME_FSM_EV_WORD_INVALID:
+                fsm.Event_gps_word_invalid();
+                reference.process_event(Ref_Ev_word_invalid());
+                break;
+            default:
+                fsm.Event_gps_word_preamble();
+                reference.process_event(Ref_Ev_word_preamble());
+                break;
+            }
+            if (fsm.d_flag_new_subframe)
+                {
+                    subframes++;
+                    fsm.d_flag_new_subframe = false;
+                }
+            ASSERT_EQ(reference.state, fsm.state()) << "event " << n;
+            ASSERT_EQ(reference.subframes, subframes) << "event " << n;
+            ASSERT_EQ(0, std::memcmp(reference.subframe, fsm.d_subframe, GPS_SUBFRAME_LENGTH)) << "event " << n;
+        }
+    EXPECT_GT(subframes, 0);
+}
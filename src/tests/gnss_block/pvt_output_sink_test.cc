@@ -0,0 +1,201 @@
+/*!
+ * \file pvt_output_sink_test.cc
+ * \brief Checks the record counters, the order of the records and of the
+ * navigation data, and the flush on destruction of Pvt_Output_Sink.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/thread/thread.hpp>
+#include "pvt_output_sink.h"
+
+
+/*
+ * A fix whose KML coordinates line starts with its index
+ */
+Pvt_Output_Record pvt_output_sink_test_record(int type, int index)
+{
+    Pvt_Output_Record record = Pvt_Output_Record(); // zero-initialized
+    record.type = type;
+    record.sample_counter = 100 * (index + 1);
+    record.rx_time = 345600.0 + 0.1 * index;
+    record.d_position_UTC_time = boost::posix_time::ptime(boost::gregorian::date(2014, 5, 1));
+    record.b_valid_position = true;
+    record.d_flag_averaging = false;
+    record.d_longitude_d = index;
+    record.d_latitude_d = 41.5;
+    record.d_height_m = 100.0;
+    return record;
+}
+
+
+/*
+ * Reads the longitudes of the KML coordinates
+ */
+std::vector<int> pvt_output_sink_test_read_kml(std::string filename)
+{
+    std::vector<int> longitudes;
+    std::ifstream kml(filename.c_str());
+    std::string line;
+    bool coordinates = false;
+    while (std::getline(kml, line))
+        {
+            if (line.find("</coordinates>") != std::string::npos) break;
+            if (coordinates) longitudes.push_back(atoi(line.c_str()));
+            if (line.find("<coordinates>") != std::string::npos) coordinates = true;
+        }
+    return longitudes;
+}
+
+
+/*
+ * Reads the message numbers of a RTCM file. For the 1019 messages, the
+ * satellite PRN is stored instead, as 1019000 + PRN.
+ */
+std::vector<unsigned int> pvt_output_sink_test_read_rtcm(std::string filename)
+{
+    std::vector<unsigned int> messages;
+    std::ifstream rtcm(filename.c_str(), std::ios::in | std::ios::binary);
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(rtcm)), std::istreambuf_iterator<char>());
+    unsigned int pos = 0;
+    while (pos + 6 <= data.size() and data[pos] == 0xD3)
+        {
+            unsigned int length = ((data[pos + 1] & 0x03) << 8) | data[pos + 2];
+            unsigned int message = (data[pos + 3] << 4) | (data[pos + 4] >> 4);
+            if (message == 1019) message = 1019000 + (((data[pos + 4] & 0x0F) << 2) | (data[pos + 5] >> 6));
+            messages.push_back(message);
+            pos += 3 + length + 3;
+        }
+    return messages;
+}
+
+
+
+TEST(Pvt_Output_Sink_Test, PushedAndDroppedRecords)
+{
+    std::string kml_filename = "pvt_output_sink_test.kml";
+    std::string nmea_filename = "pvt_output_sink_test.nmea";
+    int n_records = 40 * PVT_OUTPUT_SINK_CAPACITY;
+    std::vector<int> accepted;
+    unsigned long long dropped;
+    {
+        Pvt_Output_Sink sink(kml_filename, nmea_filename, false, "");
+        for (int i = 0; i < n_records; i++)
+            {
+                if (sink.push(pvt_output_sink_test_record(PVT_OUTPUT_GALILEO_FIX, i))) accepted.push_back(i);
+            }
+        dropped = sink.dropped_records();
+        EXPECT_GE(accepted.size(), sink.written_records());
+    }
+
+    // the queue holds PVT_OUTPUT_SINK_CAPACITY records, so pushing faster than
+    // the sink thread wakes up drops some, and every record is either queued or counted
+    EXPECT_LT(0u, dropped);
+    EXPECT_LE((unsigned int)PVT_OUTPUT_SINK_CAPACITY, accepted.size());
+    EXPECT_EQ((unsigned long long)n_records, accepted.size() + dropped);
+
+    // the queued records are written in order, and only them
+    std::vector<int> longitudes = pvt_output_sink_test_read_kml(kml_filename);
+    EXPECT_EQ(accepted, longitudes);
+    remove(kml_filename.c_str());
+    remove(nmea_filename.c_str());
+}
+
+
+
+TEST(Pvt_Output_Sink_Test, FlushOnDestruction)
+{
+    std::string kml_filename = "pvt_output_sink_test.kml";
+    std::string nmea_filename = "pvt_output_sink_test.nmea";
+    {
+        Pvt_Output_Sink sink(kml_filename, nmea_filename, false, "");
+        for (int i = 0; i < 100; i++)
+            {
+                ASSERT_TRUE(sink.push(pvt_output_sink_test_record(PVT_OUTPUT_GALILEO_FIX, i)));
+                if (i == 50) boost::this_thread::sleep(boost::posix_time::milliseconds(3 * PVT_OUTPUT_SINK_PERIOD_MS));
+            }
+        EXPECT_EQ(0u, sink.dropped_records());
+        // the sink thread has written the first half at most
+        EXPECT_GE(51u, sink.written_records());
+    }
+    // the destructor writes the records still queued
+    std::vector<int> longitudes = pvt_output_sink_test_read_kml(kml_filename);
+    ASSERT_EQ(100u, longitudes.size());
+    for (int i = 0; i < 100; i++)
+        {
+            EXPECT_EQ(i, longitudes[i]);
+        }
+    remove(kml_filename.c_str());
+    remove(nmea_filename.c_str());
+}
+
+
+
+TEST(Pvt_Output_Sink_Test, NavigationDataInOrderWithTheRecords)
+{
+    std::string kml_filename = "pvt_output_sink_test.kml";
+    std::string nmea_filename = "pvt_output_sink_test.nmea";
+    std::string rtcm_filename = "pvt_output_sink_test.rtcm";
+    std::map<int,Gps_Ephemeris> gps_ephemeris_map;
+    for (int prn = 1; prn <= 2; prn++)
+        {
+            gps_ephemeris_map[prn].i_satellite_PRN = prn;
+            gps_ephemeris_map[prn].d_sqrt_A = 5153.65;
+        }
+    {
+        Pvt_Output_Sink sink(kml_filename, nmea_filename, false, "", true, rtcm_filename);
+        std::map<int,Gps_Ephemeris> first_map;
+        first_map[1] = gps_ephemeris_map[1];
+        sink.set_gps_navigation(first_map, Gps_Iono(), Gps_Utc_Model());
+        // the station position and the ephemerides are sent with the first record
+        // and PVT_OUTPUT_SINK_RTCM_NAV_PERIOD_MS later
+        for (int i = 0; i < 2; i++)
+            {
+                Pvt_Output_Record record = pvt_output_sink_test_record(PVT_OUTPUT_GPS_FIX, i);
+                record.sample_counter = 1000 + i * PVT_OUTPUT_SINK_RTCM_NAV_PERIOD_MS;
+                record.n_observables = 1;
+                record.observables[0].System = 'G';
+                strcpy(record.observables[0].Signal, "1C");
+                record.observables[0].PRN = 1;
+                record.observables[0].Pseudorange_m = 2.0e7;
+                record.observables[0].Flag_valid_pseudorange = true;
+                ASSERT_TRUE(sink.push(record));
+                // the second ephemeris arrives after the first record has been queued
+                if (i == 0) sink.set_gps_navigation(gps_ephemeris_map, Gps_Iono(), Gps_Utc_Model());
+            }
+    }
+    std::vector<unsigned int> messages = pvt_output_sink_test_read_rtcm(rtcm_filename);
+    unsigned int expected[7] = {1005, 1019001, 1074, 1005, 1019001, 1019002, 1074};
+    EXPECT_EQ(std::vector<unsigned int>(expected, expected + 7), messages);
+    remove(kml_filename.c_str());
+    remove(nmea_filename.c_str());
+    remove(rtcm_filename.c_str());
+}
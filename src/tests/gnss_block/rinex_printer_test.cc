@@ -0,0 +1,334 @@
+/*!
+ * \file rinex_printer_test.cc
+ * \brief Checks the RINEX observation and navigation records against the
+ * output of the stream-based formatting they replaced, and measures the
+ * throughput of the observation file.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/time.h>
+#include "rinex_printer.h"
+#include "rinex_formatter.h"
+#include "gps_ephemeris.h"
+#include "gnss_synchro.h"
+
+DECLARE_string(RINEX_version);
+DEFINE_int32(size_rinex_printer_test, 50000, "Number of epochs written by the RINEX observation benchmark");
+
+
+Gps_Ephemeris rinex_printer_test_ephemeris(int prn, double scale)
+{
+    Gps_Ephemeris eph;
+    eph.i_satellite_PRN = prn;
+    eph.i_GPS_week = 766;
+    eph.d_TOW = 345600.0 + prn * 6.0;
+    eph.d_Toe = 352800.0;
+    eph.d_Toc = 352800.0;
+    eph.d_sqrt_A = 5153.6531 + scale;
+    eph.d_e_eccentricity = 0.011248 * scale;
+    eph.d_M_0 = -0.41238 * scale;
+    eph.d_Delta_n = 4.5233e-9;
+    eph.d_OMEGA0 = -1.7524 * scale;
+    eph.d_OMEGA = 0.83301;
+    eph.d_OMEGA_DOT = -8.1024e-9;
+    eph.d_i_0 = 0.96142;
+    eph.d_IDOT = 2.5001e-10 * scale;
+    eph.d_Cuc = -1.9278e-6;
+    eph.d_Cus = 8.4397e-6;
+    eph.d_Crc = 218.3125;
+    eph.d_Crs = -37.21875 * scale;
+    eph.d_Cic = 1.1175e-7;
+    eph.d_Cis = -4.2841e-8;
+    eph.d_A_f0 = 1.2047e-4 * scale;
+    eph.d_A_f1 = 3.4106e-12;
+    eph.d_A_f2 = 0.0;
+    eph.d_TGD = -1.1176e-8;
+    eph.d_IODC = 243.0 + prn;
+    eph.i_code_on_L2 = 1;
+    eph.i_SV_accuracy = 2;
+    eph.i_SV_health = 0;
+    return eph;
+}
+
+
+std::map<int,Gnss_Synchro> rinex_printer_test_observables(int k)
+{
+    std::map<int,Gnss_Synchro> observables;
+    int prns[4] = {3, 11, 17, 28};
+    for (int i = 0; i < 4; i++)
+        {
+            Gnss_Synchro gnss_synchro;
+            gnss_synchro.System = 'G';
+            gnss_synchro.PRN = prns[i];
+            gnss_synchro.Pseudorange_m = 20123456.7891 + 1234567.25 * i + 0.0005 * k + 17.123 * k;
+            gnss_synchro.Carrier_phase_rads = -123456.789 * (i + 1) - 1.5 * k;
+            gnss_synchro.Carrier_Doppler_hz = -2345.6785 + 1000.0 * i + 0.25 * k;
+            gnss_synchro.CN0_dB_hz = 44.0625 + i;
+            observables[prns[i]] = gnss_synchro;
+        }
+    return observables;
+}
+
+
+/*
+ * Writes three epochs of observations and two ephemerides with the given
+ * RINEX version, and returns the lines of both files
+ */
+void rinex_printer_test_write(std::string version, std::vector<std::string>& obs_lines, std::vector<std::string>& nav_lines)
+{
+    std::string saved_version = FLAGS_RINEX_version;
+    FLAGS_RINEX_version = version;
+    Rinex_Printer rp;
+    FLAGS_RINEX_version = saved_version;
+    std::string obs_filename = "rinex_printer_test_obs.txt";
+    std::string nav_filename = "rinex_printer_test_nav.txt";
+    {
+        std::ofstream out(obs_filename.c_str());
+        double times[3] = {345678.123, 345665.02, 345719.9999999};
+        for (int k = 0; k < 3; k++)
+            {
+                rp.log_rinex_obs(out, rinex_printer_test_ephemeris(3, 1.0), times[k], rinex_printer_test_observables(k));
+            }
+    }
+    {
+        std::ofstream out(nav_filename.c_str());
+        std::map<int,Gps_Ephemeris> eph_map;
+        eph_map[5] = rinex_printer_test_ephemeris(5, 1.0);
+        eph_map[12] = rinex_printer_test_ephemeris(12, -0.37);
+        rp.log_rinex_nav(out, eph_map);
+        // the same ephemerides are not written again
+        rp.log_rinex_nav(out, eph_map);
+    }
+    std::string line;
+    std::ifstream obs_file(obs_filename.c_str());
+    while (std::getline(obs_file, line)) obs_lines.push_back(line);
+    std::ifstream nav_file(nav_filename.c_str());
+    while (std::getline(nav_file, line)) nav_lines.push_back(line);
+    remove(obs_filename.c_str());
+    remove(nav_filename.c_str());
+}
+
+
+std::string rinex_printer_test_pad(std::string line)
+{
+    return line + std::string(80 - line.size(), ' ');
+}
+
+
+long long int rinex_printer_test_microseconds()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+
+
+TEST(Rinex_Printer_Test, FixedFormat)
+{
+    // same result as std::fixed and std::setprecision, as used by Rinex_Printer::asString
+    double values[] = {0.0, -0.0, 0.5, 1.5, 2.5, -2.5, 0.0005, 0.0015, 0.0025, 20123456.7891,
+            -19648.7578125, 44.0625, 45.0625, 59.9999999, 59.99999995, 1.0e-300, 1.0e15, -123456789.0};
+    for (unsigned int i = 0; i < sizeof(values) / sizeof(double); i++)
+        {
+            for (int decimals = 0; decimals <= RINEX_FORMATTER_MAX_DECIMALS; decimals++)
+                {
+                    std::ostringstream ss;
+                    ss << std::fixed << std::setprecision(decimals) << values[i];
+                    std::string line;
+                    rinex_append_fixed(line, values[i], decimals);
+                    EXPECT_EQ(ss.str(), line) << values[i] << " with " << decimals << " decimals";
+                }
+        }
+    srand(1);
+    for (int n = 0; n < 100000; n++)
+        {
+            double x = ((double)rand() / RAND_MAX - 0.5) * 6.0e7;
+            int decimals = n % (RINEX_FORMATTER_MAX_DECIMALS + 1);
+            std::ostringstream ss;
+            ss << std::fixed << std::setprecision(decimals) << x;
+            std::string line;
+            rinex_append_fixed(line, x, decimals);
+            ASSERT_EQ(ss.str(), line) << x << " with " << decimals << " decimals";
+        }
+
+    // right justification truncates from the left, as Rinex_Printer::rightJustify
+    std::string line;
+    rinex_append_fixed(line, -19648.7578125, 3, 14);
+    EXPECT_EQ("    -19648.758", line);
+    line.clear();
+    rinex_append_fixed(line, 123456789012345.0, 3, 14);
+    EXPECT_EQ("6789012345.000", line);
+    line.clear();
+    rinex_append_int(line, 7, 2, '0');
+    rinex_append_int(line, -42, 4);
+    EXPECT_EQ("07 -42", line);
+}
+
+
+
+TEST(Rinex_Printer_Test, FortranFormat)
+{
+    double values[] = {0.0, -0.0, 1.0, -1.0, 1.2047e-4, -1.1176e-8, 5153.6531, 352800.0,
+            9.99999999999951e5, 1e-100, 1.5e100, 123456789012.5, -4.2841e-8, 0.5, 3.4106e-12};
+    std::string expected[] = {" .000000000000D+00", "-.000000000000D+00", " .100000000000D+01",
+            "-.100000000000D+01", " .120470000000D-03", "-.111760000000D-07", " .515365310000D+04",
+            " .352800000000D+06", " .100000000000D+07", " .100000000000D-99", " .150000000000D+01",
+            " .123456789012D+12", "-.428410000000D-07", " .500000000000D+00", " .341060000000D-11"};
+    for (unsigned int i = 0; i < sizeof(values) / sizeof(double); i++)
+        {
+            std::string line;
+            rinex_append_fortran(line, values[i], 18, 2);
+            EXPECT_EQ(expected[i], line) << values[i];
+        }
+}
+
+
+
+TEST(Rinex_Printer_Test, Version2)
+{
+    std::vector<std::string> obs;
+    std::vector<std::string> nav;
+    rinex_printer_test_write("2.11", obs, nav);
+
+    std::string expected_obs[] = {
+            " 14  5  1 00 01 18.1230000  0  4G03G11G17G28                                    ",
+            "  20123456.789     -19648.758     -2345.678        44.062                       ",
+            "  21358024.039     -39297.516     -1345.678        45.062                       ",
+            "  22592591.289     -58946.275      -345.678        46.062                       ",
+            "  23827158.539     -78595.033       654.322        47.062                       ",
+            " 14  5  1 00 01 5.0200000  0  4G03G11G17G28                                     ",
+            "  20123473.913     -19648.997     -2345.428        44.062                       ",
+            "  21358041.163     -39297.755     -1345.428        45.062                       ",
+            "  22592608.413     -58946.513      -345.428        46.062                       ",
+            "  23827175.663     -78595.272       654.572        47.062                       ",
+            " 14  5  1 00 01 59.9999999  0  4G03G11G17G28                                    ",
+            "  20123491.036     -19649.236     -2345.178        44.062                       ",
+            "  21358058.286     -39297.994     -1345.178        45.062                       ",
+            "  22592625.536     -58946.752      -345.178        46.062                       ",
+            "  23827192.786     -78595.510       654.822        47.062                       "};
+    ASSERT_EQ(sizeof(expected_obs) / sizeof(std::string), obs.size());
+    for (unsigned int i = 0; i < obs.size(); i++) EXPECT_EQ(expected_obs[i], obs[i]);
+
+    std::string expected_nav[] = {
+            " 5 14 05 01 00 00 30.0  .120470000000D-03  .341060000000D-11  .000000000000D+00 ",
+            "     .000000000000D+00 -.372187500000D+02  .452330000000D-08 -.412380000000D+00 ",
+            "    -.192780000000D-05  .112480000000D-01  .843970000000D-05  .515465310000D+04 ",
+            "     .352800000000D+06  .111750000000D-06 -.175240000000D+01 -.428410000000D-07 ",
+            "     .961420000000D+00  .218312500000D+03  .833010000000D+00 -.810240000000D-08 ",
+            "     .250010000000D-09  .100000000000D+01  .179000000000D+04  .100000000000D+01 ",
+            "     .200000000000D+01  .000000000000D+00 -.111760000000D-07  .248000000000D+03 ",
+            "     .345630000000D+06  .140000000000D+02                                       ",
+            "12 14 05 01 00 01 12.0 -.445739000000D-04  .341060000000D-11  .000000000000D+00 ",
+            "     .000000000000D+00  .137709375000D+02  .452330000000D-08  .152580600000D+00 ",
+            "    -.192780000000D-05 -.416176000000D-02  .843970000000D-05  .515328310000D+04 ",
+            "     .352800000000D+06  .111750000000D-06  .648388000000D+00 -.428410000000D-07 ",
+            "     .961420000000D+00  .218312500000D+03  .833010000000D+00 -.810240000000D-08 ",
+            "    -.925037000000D-10  .100000000000D+01  .179000000000D+04  .100000000000D+01 ",
+            "     .200000000000D+01  .000000000000D+00 -.111760000000D-07  .255000000000D+03 ",
+            "     .345672000000D+06  .140000000000D+02                                       "};
+    ASSERT_EQ(sizeof(expected_nav) / sizeof(std::string), nav.size());
+    for (unsigned int i = 0; i < nav.size(); i++) EXPECT_EQ(expected_nav[i], nav[i]);
+}
+
+
+
+TEST(Rinex_Printer_Test, Version3)
+{
+    std::vector<std::string> obs;
+    std::vector<std::string> nav;
+    rinex_printer_test_write("3.01", obs, nav);
+
+    std::string expected_obs[] = {
+            rinex_printer_test_pad("> 2014 05 01 00 01 18.1230000  0  4"),
+            rinex_printer_test_pad("G03  20123456.789 9"),
+            rinex_printer_test_pad("G11  21358024.039 9"),
+            rinex_printer_test_pad("G17  22592591.289 9"),
+            rinex_printer_test_pad("G28  23827158.539 9"),
+            rinex_printer_test_pad("> 2014 05 01 00 01 05.0200000  0  4"),
+            rinex_printer_test_pad("G03  20123473.913 9"),
+            rinex_printer_test_pad("G11  21358041.163 9"),
+            rinex_printer_test_pad("G17  22592608.413 9"),
+            rinex_printer_test_pad("G28  23827175.663 9"),
+            rinex_printer_test_pad("> 2014 05 01 00 01 59.9999999  0  4"),
+            rinex_printer_test_pad("G03  20123491.036 9"),
+            rinex_printer_test_pad("G11  21358058.286 9"),
+            rinex_printer_test_pad("G17  22592625.536 9"),
+            rinex_printer_test_pad("G28  23827192.786 9")};
+    ASSERT_EQ(sizeof(expected_obs) / sizeof(std::string), obs.size());
+    for (unsigned int i = 0; i < obs.size(); i++) EXPECT_EQ(expected_obs[i], obs[i]);
+
+    std::string expected_nav[] = {
+            "G05 2014 05 01 00 00 30  .120470000000D-03  .341060000000D-11  .000000000000D+00",
+            "      .000000000000D+00 -.372187500000D+02  .452330000000D-08 -.412380000000D+00",
+            "     -.192780000000D-05  .112480000000D-01  .843970000000D-05  .515465310000D+04",
+            "      .352800000000D+06  .111750000000D-06 -.175240000000D+01 -.428410000000D-07",
+            "      .961420000000D+00  .218312500000D+03  .833010000000D+00 -.810240000000D-08",
+            "      .250010000000D-09  .100000000000D+01  .179000000000D+04  .100000000000D+01",
+            "      .200000000000D+01  .000000000000D+00 -.111760000000D-07  .248000000000D+03",
+            rinex_printer_test_pad("      .345630000000D+06  .140000000000D+02"),
+            "G12 2014 05 01 00 01 12 -.445739000000D-04  .341060000000D-11  .000000000000D+00",
+            "      .000000000000D+00  .137709375000D+02  .452330000000D-08  .152580600000D+00",
+            "     -.192780000000D-05 -.416176000000D-02  .843970000000D-05  .515328310000D+04",
+            "      .352800000000D+06  .111750000000D-06  .648388000000D+00 -.428410000000D-07",
+            "      .961420000000D+00  .218312500000D+03  .833010000000D+00 -.810240000000D-08",
+            "     -.925037000000D-10  .100000000000D+01  .179000000000D+04  .100000000000D+01",
+            "      .200000000000D+01  .000000000000D+00 -.111760000000D-07  .255000000000D+03",
+            rinex_printer_test_pad("      .345672000000D+06  .140000000000D+02")};
+    ASSERT_EQ(sizeof(expected_nav) / sizeof(std::string), nav.size());
+    for (unsigned int i = 0; i < nav.size(); i++) EXPECT_EQ(expected_nav[i], nav[i]);
+}
+
+
+
+TEST(Rinex_Printer_Test, ObservationThroughput)
+{
+    Rinex_Printer rp;
+    std::string obs_filename = "rinex_printer_test_throughput.txt";
+    std::ofstream out(obs_filename.c_str());
+    Gps_Ephemeris eph = rinex_printer_test_ephemeris(3, 1.0);
+    std::map<int,Gnss_Synchro> observables = rinex_printer_test_observables(1);
+    long long int begin = rinex_printer_test_microseconds();
+    for (int n = 0; n < FLAGS_size_rinex_printer_test; n++)
+        {
+            // 50 Hz epochs
+            rp.log_rinex_obs(out, eph, 345600.0 + 0.02 * n, observables);
+        }
+    out.close();
+    long long int end = rinex_printer_test_microseconds();
+    std::cout << FLAGS_size_rinex_printer_test << " RINEX observation epochs written in "
+              << (end - begin) << " microseconds" << std::endl;
+    remove(obs_filename.c_str());
+    ASSERT_LE(0, end - begin);
+}
@@ -28,13 +28,109 @@
  * -------------------------------------------------------------------------
  */
 
+#include <cmath>
+#include <cstring>
 #include <fstream>
 #include <map>
 #include <string>
+#include <sys/time.h>
 #include <boost/archive/xml_iarchive.hpp>
+#include <boost/asio.hpp>
 #include <boost/serialization/nvp.hpp>
+#include <boost/thread/thread.hpp>
 #include "rtcm_printer.h"
+#include "rtcm_bit_writer.h"
+#include "rtcm_tcp_server.h"
 #include "gps_ephemeris.h"
+#include "GPS_L1_CA.h"
+
+DEFINE_int32(size_rtcm_printer_test, 100000, "Number of MSM4 messages encoded by the RTCM benchmark");
+
+
+/*
+ * Reads the data fields of a RTCM frame, MSB first, after the frame header
+ */
+class Rtcm_Test_Bit_Reader
+{
+public:
+    Rtcm_Test_Bit_Reader(const unsigned char *frame) : d_frame(frame), d_bit(24) {}
+    unsigned long long get_unsigned(unsigned int bits)
+    {
+        unsigned long long value = 0;
+        for (unsigned int i = 0; i < bits; i++, d_bit++)
+            {
+                value = (value << 1) | ((d_frame[d_bit / 8] >> (7 - d_bit % 8)) & 1);
+            }
+        return value;
+    }
+    long long get_signed(unsigned int bits)
+    {
+        unsigned long long value = get_unsigned(bits);
+        if (value & (1ULL << (bits - 1))) return (long long)value - (long long)(1ULL << (bits - 1)) * 2;
+        return (long long)value;
+    }
+private:
+    const unsigned char *d_frame;
+    unsigned int d_bit;
+};
+
+
+Gps_Ephemeris rtcm_printer_test_ephemeris()
+{
+    Gps_Ephemeris eph;
+    eph.i_satellite_PRN = 17;
+    eph.i_GPS_week = 1790;
+    eph.i_SV_accuracy = 2;
+    eph.i_code_on_L2 = 1;
+    eph.d_IDOT = -123 * I_DOT_LSB;
+    eph.d_IODC = 301;
+    eph.d_Toc = 345600;
+    eph.d_A_f2 = 0;
+    eph.d_A_f1 = -5 * A_F1_LSB;
+    eph.d_A_f0 = -1234567 * A_F0_LSB;
+    eph.d_Crs = -372 * C_RS_LSB;
+    eph.d_Delta_n = 14000 * DELTA_N_LSB;
+    eph.d_M_0 = -2000000000 * M_0_LSB;
+    eph.d_Cuc = -1000 * C_UC_LSB;
+    eph.d_e_eccentricity = 96000000 * E_LSB;
+    eph.d_Cus = 4500 * C_US_LSB;
+    eph.d_sqrt_A = 2702000000.0 * SQRT_A_LSB;
+    eph.d_Toe = 345600;
+    eph.d_Cic = 59 * C_IC_LSB;
+    eph.d_OMEGA0 = 1500000000 * OMEGA_0_LSB;
+    eph.d_Cis = -22 * C_IS_LSB;
+    eph.d_i_0 = 660000000 * I_0_LSB;
+    eph.d_Crc = 6977 * C_RC_LSB;
+    eph.d_OMEGA = -900000000 * OMEGA_LSB;
+    eph.d_OMEGA_DOT = -8000000 * OMEGA_DOT_LSB;
+    eph.d_TGD = -11 * T_GD_LSB;
+    eph.i_SV_health = 0;
+    eph.b_L2_P_data_flag = true;
+    eph.b_fit_interval_flag = false;
+    return eph;
+}
+
+
+std::map<int,Gnss_Synchro> rtcm_printer_test_observables(double tow_s)
+{
+    std::map<int,Gnss_Synchro> observables;
+    unsigned int prns[4] = {2, 9, 17, 31};
+    for (int i = 0; i < 4; i++)
+        {
+            Gnss_Synchro obs;
+            memset(&obs, 0, sizeof(obs));
+            obs.System = 'G';
+            strcpy(obs.Signal, "1C");
+            obs.PRN = prns[i];
+            // ranges changing by 500 m/s, and carrier phases 100 cycles away from them
+            obs.Pseudorange_m = 20.0e6 + 1.2345e6 * i + 500.0 * (tow_s - 345600.0);
+            obs.Carrier_phase_rads = GPS_TWO_PI * (obs.Pseudorange_m / (GPS_C_m_s / GPS_L1_FREQ_HZ) + 100.25);
+            obs.CN0_dB_hz = 38.4 + i;
+            obs.Flag_valid_pseudorange = true;
+            observables.insert(std::pair<int,Gnss_Synchro>(obs.PRN, obs));
+        }
+    return observables;
+}
 
 
 TEST(Rtcm_Printer_Test, Instantiate)
@@ -73,3 +169,237 @@ TEST(Rtcm_Printer_Test, Instantiate_and_Run)
 
     EXPECT_EQ(reference_msg, testing_msg);
 }
+
+
+
+TEST(Rtcm_Printer_Test, Bit_Writer)
+{
+    Rtcm_Bit_Writer writer;
+    writer.put_unsigned(1, 1);
+    writer.put_unsigned(0x1FF, 9);
+    writer.put_signed(-2, 4);
+    writer.put_unsigned(0x123456789ABCDEFULL, 64);
+    EXPECT_EQ(78u, writer.message_bits());
+    EXPECT_EQ(3u + 10u + 3u, writer.finish());
+    const unsigned char *frame = writer.frame();
+    EXPECT_EQ(0xD3, frame[0]);
+    EXPECT_EQ(0x00, frame[1]);
+    EXPECT_EQ(10, frame[2]);
+    Rtcm_Test_Bit_Reader reader(frame);
+    EXPECT_EQ(1u, reader.get_unsigned(1));
+    EXPECT_EQ(0x1FFu, reader.get_unsigned(9));
+    EXPECT_EQ(-2, reader.get_signed(4));
+    EXPECT_EQ(0x123456789ABCDEFULL, reader.get_unsigned(64));
+    EXPECT_EQ(0u, reader.get_unsigned(2)); // padding
+    EXPECT_EQ(crc24q(frame, 13), (unsigned int)((frame[13] << 16) | (frame[14] << 8) | frame[15]));
+
+    // the writer is reused, and a message longer than 1023 bytes is rejected
+    writer.reset();
+    for (int i = 0; i < 128; i++) writer.put_unsigned(0, 64);
+    EXPECT_TRUE(writer.overflow());
+    EXPECT_EQ(0u, writer.finish());
+}
+
+
+
+TEST(Rtcm_Printer_Test, M1019)
+{
+    Rtcm_Printer printer("", false, "");
+    Gps_Ephemeris eph = rtcm_printer_test_ephemeris();
+    Rtcm_Bit_Writer writer;
+    printer.get_M1019(writer, eph);
+    EXPECT_EQ(488u, writer.message_bits());
+    ASSERT_EQ(3u + 61u + 3u, writer.finish());
+    Rtcm_Test_Bit_Reader reader(writer.frame());
+    EXPECT_EQ(1019u, reader.get_unsigned(12));
+    EXPECT_EQ(17u, reader.get_unsigned(6));
+    EXPECT_EQ(1790u % 1024u, reader.get_unsigned(10));
+    EXPECT_EQ(2u, reader.get_unsigned(4));
+    EXPECT_EQ(1u, reader.get_unsigned(2));
+    EXPECT_EQ(-123, reader.get_signed(14));
+    EXPECT_EQ(301u & 0xFF, reader.get_unsigned(8));
+    EXPECT_EQ(345600u / 16, reader.get_unsigned(16));
+    EXPECT_EQ(0, reader.get_signed(8));
+    EXPECT_EQ(-5, reader.get_signed(16));
+    EXPECT_EQ(-1234567, reader.get_signed(22));
+    EXPECT_EQ(301u, reader.get_unsigned(10));
+    EXPECT_EQ(-372, reader.get_signed(16));
+    EXPECT_EQ(14000, reader.get_signed(16));
+    EXPECT_EQ(-2000000000, reader.get_signed(32));
+    EXPECT_EQ(-1000, reader.get_signed(16));
+    EXPECT_EQ(96000000u, reader.get_unsigned(32));
+    EXPECT_EQ(4500, reader.get_signed(16));
+    EXPECT_EQ(2702000000u, reader.get_unsigned(32));
+    EXPECT_EQ(345600u / 16, reader.get_unsigned(16));
+    EXPECT_EQ(59, reader.get_signed(16));
+    EXPECT_EQ(1500000000, reader.get_signed(32));
+    EXPECT_EQ(-22, reader.get_signed(16));
+    EXPECT_EQ(660000000, reader.get_signed(32));
+    EXPECT_EQ(6977, reader.get_signed(16));
+    EXPECT_EQ(-900000000, reader.get_signed(32));
+    EXPECT_EQ(-8000000, reader.get_signed(24));
+    EXPECT_EQ(-11, reader.get_signed(8));
+    EXPECT_EQ(0u, reader.get_unsigned(6));
+    EXPECT_EQ(1u, reader.get_unsigned(1));
+    EXPECT_EQ(0u, reader.get_unsigned(1));
+}
+
+
+
+TEST(Rtcm_Printer_Test, MSM4)
+{
+    Rtcm_Printer printer("", false, "");
+    const double light_ms = GPS_C_m_s * 0.001;
+    const double wavelength_ms = 1000.0 / GPS_L1_FREQ_HZ;
+    double lock_start_phaserange_ms = 0.0;
+    for (int epoch = 0; epoch < 20; epoch++)
+        {
+            double tow_s = 345600.0 + 0.1 * epoch;
+            std::map<int,Gnss_Synchro> observables = rtcm_printer_test_observables(tow_s);
+            Rtcm_Bit_Writer writer;
+            ASSERT_EQ(4, printer.get_MSM4(writer, 1234, 'G', observables, tow_s, false));
+            EXPECT_EQ(169u + 4u + 4u * 18u + 4u * 48u, writer.message_bits());
+            writer.finish();
+            Rtcm_Test_Bit_Reader reader(writer.frame());
+            EXPECT_EQ(1074u, reader.get_unsigned(12));
+            EXPECT_EQ(1234u, reader.get_unsigned(12));
+            EXPECT_EQ((unsigned long long)(345600000 + 100 * epoch), reader.get_unsigned(30));
+            EXPECT_EQ(0u, reader.get_unsigned(1));
+            reader.get_unsigned(3 + 7 + 2 + 2 + 1 + 3);
+            EXPECT_EQ((1ULL << 62) | (1ULL << 55) | (1ULL << 47) | (1ULL << 33), reader.get_unsigned(64));
+            EXPECT_EQ(1ULL << 30, reader.get_unsigned(32)); // signal ID 2: L1 C/A
+            EXPECT_EQ(0xFu, reader.get_unsigned(4));
+            double rough_ms[4];
+            for (int i = 0; i < 4; i++) rough_ms[i] = reader.get_unsigned(8);
+            for (int i = 0; i < 4; i++) rough_ms[i] += reader.get_unsigned(10) / 1024.0;
+            double pseudorange_ms[4];
+            double phaserange_ms[4];
+            for (int i = 0; i < 4; i++) pseudorange_ms[i] = rough_ms[i] + reader.get_signed(15) / 16777216.0;
+            for (int i = 0; i < 4; i++) phaserange_ms[i] = rough_ms[i] + reader.get_signed(22) / 536870912.0;
+            unsigned int lock_time[4];
+            for (int i = 0; i < 4; i++) lock_time[i] = reader.get_unsigned(4);
+            for (int i = 0; i < 4; i++) EXPECT_EQ(0u, reader.get_unsigned(1));
+            int i = 0;
+            for(std::map<int,Gnss_Synchro>::iterator it = observables.begin(); it != observables.end(); it++, i++)
+                {
+                    EXPECT_NEAR(it->second.Pseudorange_m, pseudorange_ms[i] * light_ms, 0.02);
+                    EXPECT_EQ((unsigned long long)floor(it->second.CN0_dB_hz + 0.5), reader.get_unsigned(6));
+                    // whole cycles are removed from the carrier phase to bring it near the pseudorange
+                    EXPECT_NEAR(0.25 * wavelength_ms, phaserange_ms[i] - pseudorange_ms[i], 1e-7);
+                }
+            // the lock time grows from 0 (100 ms per epoch)
+            if (epoch == 0)
+                {
+                    EXPECT_EQ(0u, lock_time[0]);
+                    lock_start_phaserange_ms = phaserange_ms[0];
+                }
+            if (epoch == 1)
+                {
+                    EXPECT_EQ(2u, lock_time[0]);  // 100 ms
+                }
+            if (epoch == 19)
+                {
+                    EXPECT_EQ(6u, lock_time[0]);  // 1900 ms
+                }
+            // no cycles are removed while the lock lasts
+            EXPECT_NEAR(lock_start_phaserange_ms + 500.0 * 0.1 * epoch / light_ms, phaserange_ms[0], 1e-8);
+        }
+
+    // a gap in the epochs restarts the lock
+    std::map<int,Gnss_Synchro> observables = rtcm_printer_test_observables(345610.0);
+    Rtcm_Bit_Writer writer;
+    printer.get_MSM4(writer, 1234, 'G', observables, 345610.0, false);
+    writer.finish();
+    Rtcm_Test_Bit_Reader reader(writer.frame());
+    reader.get_unsigned(169 + 4 + 4 * 18 + 4 * 15 + 4 * 22);
+    EXPECT_EQ(0u, reader.get_unsigned(4));
+
+    // no Galileo observables
+    writer.reset();
+    EXPECT_EQ(0, printer.get_MSM4(writer, 1234, 'E', observables, 345610.0, false));
+}
+
+
+
+TEST(Rtcm_Printer_Test, Station_Id_Range)
+{
+    Rtcm_Printer printer("", false, "", false, 2101, 4095);
+    EXPECT_EQ(4095u, printer.station_id());
+
+    // DF003 has 12 bits: a larger ID is clamped instead of being truncated into another station
+    Rtcm_Printer clamped("", false, "", false, 2101, 5000);
+    EXPECT_EQ(4095u, clamped.station_id());
+    Rtcm_Bit_Writer writer;
+    clamped.get_M1005(writer, clamped.station_id(), 1114104.5999, -4850729.7108, 3975521.4643);
+    writer.finish();
+    Rtcm_Test_Bit_Reader reader(writer.frame());
+    EXPECT_EQ(1005u, reader.get_unsigned(12));
+    EXPECT_EQ(4095u, reader.get_unsigned(12));
+}
+
+
+
+TEST(Rtcm_Printer_Test, Tcp_Server)
+{
+    Rtcm_Tcp_Server server(0);
+    ASSERT_TRUE(server.is_listening());
+    boost::asio::io_service io_service;
+    boost::asio::ip::tcp::socket client(io_service);
+    client.connect(boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), server.port()));
+    for (int i = 0; i < 200 and server.clients() == 0; i++)
+        {
+            boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+        }
+    ASSERT_EQ(1u, server.clients());
+
+    Rtcm_Printer printer("", false, "");
+    Rtcm_Bit_Writer writer;
+    printer.get_M1005(writer, 2003, 1114104.5999, -4850729.7108, 3975521.4643);
+    writer.finish();
+    server.send(writer.frame(), writer.frame_length());
+    unsigned char received[RTCM_MAX_FRAME_BYTES];
+    boost::asio::read(client, boost::asio::buffer(received, writer.frame_length()));
+    EXPECT_EQ(0, memcmp(writer.frame(), received, writer.frame_length()));
+
+    // a client that closes the connection is removed
+    client.close();
+    for (int i = 0; i < 200 and server.clients() > 0; i++)
+        {
+            server.send(writer.frame(), writer.frame_length());
+            boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+        }
+    EXPECT_EQ(0u, server.clients());
+}
+
+
+
+TEST(Rtcm_Printer_Test, MSM4_Throughput)
+{
+    Rtcm_Printer printer("", false, "");
+    std::map<int,Gnss_Synchro> observables;
+    for (int i = 0; i < 3; i++)
+        {
+            std::map<int,Gnss_Synchro> more = rtcm_printer_test_observables(345600.0 + i);
+            for(std::map<int,Gnss_Synchro>::iterator it = more.begin(); it != more.end(); it++)
+                {
+                    it->second.PRN += i;
+                    observables.insert(std::pair<int,Gnss_Synchro>(it->second.PRN, it->second));
+                }
+        }
+    Rtcm_Bit_Writer writer;
+    unsigned long long bytes = 0;
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    long long int begin = tv.tv_sec * 1000000 + tv.tv_usec;
+    for (int i = 0; i < FLAGS_size_rtcm_printer_test; i++)
+        {
+            writer.reset();
+            printer.get_MSM4(writer, 1234, 'G', observables, 345600.0 + 0.05 * i, false);
+            bytes += writer.finish();
+        }
+    gettimeofday(&tv, NULL);
+    long long int end = tv.tv_sec * 1000000 + tv.tv_usec;
+    std::cout << FLAGS_size_rtcm_printer_test << " MSM4 messages of " << observables.size() << " satellites ("
+              << bytes << " bytes) encoded in " << (end - begin) << " microseconds" << std::endl;
+    ASSERT_LE(0, end - begin);
+}
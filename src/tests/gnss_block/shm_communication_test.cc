@@ -0,0 +1,278 @@
+/*!
+ * \file shm_communication_test.cc
+ * \brief Checks the request / response exchange of the shared memory
+ * transport of the TCP connector tracking blocks, its error paths and the
+ * doorbell batch counter.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <boost/array.hpp>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/thread.hpp>
+#include "shm_communication.h"
+#include "tcp_packet_data.h"
+
+
+std::string shm_test_segment_name()
+{
+    return "/gnss_sdr_shm_test_" + boost::lexical_cast<std::string>(getpid());
+}
+
+
+/*
+ * Loop filter process: answers every request with the control id, and the
+ * code error, carrier error and Doppler equal to the first correlator output
+ * times 1, 2 and 3. With wrong_control_id the echoed control id is wrong.
+ */
+void shm_test_loop_filter(const std::string &shm_name, unsigned int channels, bool wrong_control_id, std::atomic<bool> *stop)
+{
+    shm_communication server;
+    if (!server.attach_shm_server(shm_name)) return;
+    unsigned int doorbell = 0;
+    float request[SHM_MAX_TX_VARIABLES];
+    float response[NUM_RX_VARIABLES];
+    unsigned int num_tx;
+    unsigned int seq;
+    while (!stop->load())
+        {
+            doorbell = server.wait_shm_requests(doorbell, 500);
+            for (unsigned int channel = 0; channel < channels; channel++)
+                {
+                    if (server.read_shm_request(channel, request, &num_tx, &seq))
+                        {
+                            response[0] = wrong_control_id ? request[0] + 1 : request[0];
+                            response[1] = request[1];
+                            response[2] = 2 * request[1];
+                            response[3] = 3 * request[1];
+                            server.write_shm_response(channel, seq, response);
+                        }
+                }
+        }
+}
+
+
+/*
+ * Tracking channel: counts the exchanges that fail or get the response of another channel
+ */
+void shm_test_channel(shm_communication *channel, unsigned int id, int n_requests, int *failures)
+{
+    tcp_packet_data tcp_data;
+    for (int i = 1; i <= n_requests; i++)
+        {
+            boost::array<float, NUM_TX_VARIABLES_GPS_L1_CA> tx = {{(float)i, (float)id, 0, 0, 0, 0, 0, 0, 1}};
+            if (!channel->send_receive_shm_packet_gps_l1_ca(tx, &tcp_data) or tcp_data.proc_pack_code_error != id)
+                {
+                    (*failures)++;
+                }
+        }
+}
+
+
+/*
+ * Tracking channel: two exchanges with the same control id, the first one with no response
+ */
+void shm_test_timed_out_channel(shm_communication *channel, bool *results, float *code_error)
+{
+    tcp_packet_data tcp_data;
+    boost::array<float, NUM_TX_VARIABLES_GPS_L1_CA> tx = {{1, 1, 0, 0, 0, 0, 0, 0, 1}};
+    results[0] = channel->send_receive_shm_packet_gps_l1_ca(tx, &tcp_data);
+    tx[1] = 2;
+    results[1] = channel->send_receive_shm_packet_gps_l1_ca(tx, &tcp_data);
+    *code_error = tcp_data.proc_pack_code_error;
+}
+
+
+/*
+ * Reads the doorbell batch counter of the segment
+ */
+unsigned int shm_test_pending(const std::string &shm_name)
+{
+    unsigned int pending = 0;
+    int fd = shm_open(shm_name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return pending;
+    void *segment = mmap(0, sizeof(shm_segment_header), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (segment != MAP_FAILED)
+        {
+            pending = static_cast<shm_segment_header*>(segment)->pending.load();
+            munmap(segment, sizeof(shm_segment_header));
+        }
+    return pending;
+}
+
+
+
+TEST(Shm_Communication_Test, Exchange)
+{
+    std::string shm_name = shm_test_segment_name();
+    shm_communication channel;
+    ASSERT_TRUE(channel.open_shm_connection(shm_name, 3, 1));
+    std::atomic<bool> stop(false);
+    boost::thread loop_filter(shm_test_loop_filter, shm_name, 4, false, &stop);
+
+    tcp_packet_data tcp_data;
+    for (int i = 1; i <= 100; i++)
+        {
+            boost::array<float, NUM_TX_VARIABLES_GPS_L1_CA> tx = {{(float)i, 0.5f * i, 0, 0, 0, 0, 0, 0, 1}};
+            ASSERT_TRUE(channel.send_receive_shm_packet_gps_l1_ca(tx, &tcp_data));
+            EXPECT_EQ(0.5f * i, tcp_data.proc_pack_code_error);
+            EXPECT_EQ(1.0f * i, tcp_data.proc_pack_carr_error);
+            EXPECT_EQ(1.5f * i, tcp_data.proc_pack_carrier_doppler_hz);
+        }
+    stop.store(true);
+    loop_filter.join();
+    channel.close_shm_connection();
+    shm_unlink(shm_name.c_str());
+}
+
+
+
+TEST(Shm_Communication_Test, ErrorsResetTheOutputs)
+{
+    std::string shm_name = shm_test_segment_name();
+    boost::array<float, NUM_TX_VARIABLES_GALILEO_E1> tx = {{1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1}};
+    tcp_packet_data tcp_data;
+
+    // not open
+    shm_communication channel;
+    EXPECT_FALSE(channel.open_shm_connection(shm_name, SHM_MAX_CHANNELS, 1));
+    tcp_data.proc_pack_code_error = 1;
+    tcp_data.proc_pack_carr_error = 1;
+    tcp_data.proc_pack_carrier_doppler_hz = 1;
+    EXPECT_FALSE(channel.send_receive_shm_packet_galileo_e1(tx, &tcp_data));
+    EXPECT_EQ(0, tcp_data.proc_pack_code_error);
+    EXPECT_EQ(0, tcp_data.proc_pack_carr_error);
+    EXPECT_EQ(0, tcp_data.proc_pack_carrier_doppler_hz);
+
+    // no loop filter process
+    ASSERT_TRUE(channel.open_shm_connection(shm_name, 0, 1));
+    tcp_data.proc_pack_carrier_doppler_hz = 1;
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    EXPECT_FALSE(channel.send_receive_shm_packet_galileo_e1(tx, &tcp_data));
+    long waited_ms = (boost::posix_time::microsec_clock::universal_time() - start).total_milliseconds();
+    EXPECT_LE(SHM_RESPONSE_TIMEOUT_MS, waited_ms);
+    EXPECT_GT(SHM_RESPONSE_TIMEOUT_MS * 2, waited_ms);
+    EXPECT_EQ(0, tcp_data.proc_pack_carrier_doppler_hz);
+
+    // wrong control id
+    std::atomic<bool> stop(false);
+    boost::thread loop_filter(shm_test_loop_filter, shm_name, 1, true, &stop);
+    tx[0] = 2;
+    tcp_data.proc_pack_carrier_doppler_hz = 1;
+    EXPECT_FALSE(channel.send_receive_shm_packet_galileo_e1(tx, &tcp_data));
+    EXPECT_EQ(0, tcp_data.proc_pack_carrier_doppler_hz);
+    stop.store(true);
+    loop_filter.join();
+    channel.close_shm_connection();
+    shm_unlink(shm_name.c_str());
+}
+
+
+
+TEST(Shm_Communication_Test, LateResponseIsNotTakenForTheNextRequest)
+{
+    std::string shm_name = shm_test_segment_name();
+    shm_communication channel;
+    ASSERT_TRUE(channel.open_shm_connection(shm_name, 0, 1));
+    shm_communication server;
+    ASSERT_TRUE(server.attach_shm_server(shm_name));
+    bool results[2] = {true, false};
+    float code_error = 0;
+    boost::thread tracking(shm_test_timed_out_channel, &channel, results, &code_error);
+
+    // the loop filter reads the first request, but only answers it after the channel timed out
+    float request[SHM_MAX_TX_VARIABLES];
+    unsigned int num_tx;
+    unsigned int first_seq;
+    unsigned int second_seq;
+    while (!server.read_shm_request(0, request, &num_tx, &first_seq)) boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    EXPECT_EQ(1, request[1]);
+    do
+        {
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+        }
+    while (!server.read_shm_request(0, request, &num_tx, &second_seq) or second_seq == first_seq);
+    EXPECT_EQ(2, request[1]);
+    float late_response[NUM_RX_VARIABLES] = {1, 10, 0, 0};
+    server.write_shm_response(0, first_seq, late_response);
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+    float response[NUM_RX_VARIABLES] = {1, 20, 0, 0};
+    server.write_shm_response(0, second_seq, response);
+    tracking.join();
+
+    EXPECT_FALSE(results[0]);
+    EXPECT_TRUE(results[1]);
+    EXPECT_EQ(20, code_error);
+    channel.close_shm_connection();
+    server.close_shm_connection();
+    shm_unlink(shm_name.c_str());
+}
+
+
+
+TEST(Shm_Communication_Test, BatchCounterWithConcurrentChannels)
+{
+    // the doorbell counter counts the requests of all the channels modulo the batch size
+    std::string shm_name = shm_test_segment_name();
+    const unsigned int n_channels = 8;
+    const unsigned int batch_size = 3;
+    const int n_requests = 2000;
+    std::vector<boost::shared_ptr<shm_communication> > channels;
+    for (unsigned int c = 0; c < n_channels; c++)
+        {
+            channels.push_back(boost::shared_ptr<shm_communication>(new shm_communication()));
+            ASSERT_TRUE(channels.back()->open_shm_connection(shm_name, c, batch_size));
+        }
+    std::atomic<bool> stop(false);
+    boost::thread loop_filter(shm_test_loop_filter, shm_name, n_channels, false, &stop);
+
+    std::vector<int> failures(n_channels, 0);
+    boost::thread_group tracking;
+    for (unsigned int c = 0; c < n_channels; c++)
+        {
+            tracking.create_thread(boost::bind(&shm_test_channel, channels[c].get(), c, n_requests, &failures[c]));
+        }
+    tracking.join_all();
+    stop.store(true);
+    loop_filter.join();
+
+    for (unsigned int c = 0; c < n_channels; c++)
+        {
+            EXPECT_EQ(0, failures[c]) << "channel " << c;
+        }
+    EXPECT_EQ((n_channels * n_requests) % batch_size, shm_test_pending(shm_name));
+    channels.clear();
+    shm_unlink(shm_name.c_str());
+}
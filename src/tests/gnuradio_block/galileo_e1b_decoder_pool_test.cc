@@ -0,0 +1,300 @@
+/*!
+ * \file galileo_e1b_decoder_pool_test.cc
+ * \brief  Checks that the Galileo E1B telemetry decoder gives the same
+ * output when the page parts are decoded on the decoder pool and when
+ * they are decoded inside general_work, and that the page parts decoded
+ * in the calling thread when the pool is full keep their order.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cstring>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <gnuradio/top_block.h>
+#include <gnuradio/blocks/vector_source_b.h>
+#include <gnuradio/blocks/vector_sink_b.h>
+#include <gnuradio/msg_queue.h>
+#include "Galileo_E1.h"
+#include "crc24q.h"
+#include "gnss_satellite.h"
+#include "gnss_synchro.h"
+#include "galileo_e1b_decoder_pool.h"
+#include "galileo_e1b_telemetry_decoder_cc.h"
+
+
+/*
+ * Appends the 250 symbols of a page part: the preamble, and the 120 bits
+ * convolutionally encoded (G1 = 171, G2 = 133 octal, G2 inverted) and interleaved
+ */
+void galileo_pool_test_page_part(const std::vector<int> &bits, std::vector<double> &symbols)
+{
+    const int preamble[GALILEO_INAV_PREAMBLE_LENGTH_BITS] = GALILEO_INAV_PREAMBLE;
+    for (int i = 0; i < GALILEO_INAV_PREAMBLE_LENGTH_BITS; i++)
+        {
+            symbols.push_back(preamble[i] == 1 ? 1.0 : -1.0);
+        }
+    std::vector<double> encoded;
+    int state = 0;
+    for (int i = 0; i < GALILEO_INAV_PAGE_PART_BITS; i++)
+        {
+            int reg = (bits[i] << 6) | state;
+            encoded.push_back(__builtin_parity(reg & 0171) ? 1.0 : -1.0);
+            encoded.push_back(__builtin_parity(reg & 0133) ? -1.0 : 1.0);
+            state = reg >> 1;
+        }
+    std::vector<double> interleaved(encoded.size());
+    for (int r = 0; r < GALILEO_INAV_INTERLEAVER_ROWS; r++)
+        {
+            for (int c = 0; c < GALILEO_INAV_INTERLEAVER_COLS; c++)
+                {
+                    interleaved[r * GALILEO_INAV_INTERLEAVER_COLS + c] = encoded[c * GALILEO_INAV_INTERLEAVER_ROWS + r];
+                }
+        }
+    symbols.insert(symbols.end(), interleaved.begin(), interleaved.end());
+}
+
+
+/*
+ * Tracking output (4 ms symbols) carrying n_pages I/NAV pages of word type 6,
+ * with the TOW of the first page equal to first_TOW
+ */
+std::vector<unsigned char> galileo_pool_test_input(int n_pages, unsigned int first_TOW)
+{
+    std::vector<double> symbols;
+    for (int p = 0; p < n_pages; p++)
+        {
+            // Even (1) | Page type (1) | Data_k (112) | Odd (1) | Page type (1) | Data_j (16) | Reserved 1 (40) |
+            // SAR (22) | Spare (2) | CRC (24) | Reserved 2 (8) | Tail (6)
+            std::vector<int> page(234, 0);
+            std::vector<int> word(GALILEO_DATA_JK_BITS, 0);
+            for (int i = 0; i < 6; i++) word[i] = (6 >> (5 - i)) & 1; // word type 6
+            unsigned int TOW = first_TOW + 2 * p;
+            for (int i = 0; i < TOW_6_bit.length; i++) word[TOW_6_bit.first - 1 + i] = (TOW >> (TOW_6_bit.length - 1 - i)) & 1;
+            for (int i = 0; i < 112; i++) page[2 + i] = word[i];
+            page[114] = 1;
+            for (int i = 0; i < 16; i++) page[116 + i] = word[112 + i];
+            unsigned char bytes[GALILEO_DATA_FRAME_BYTES] = {0};
+            const int pad_bits = GALILEO_DATA_FRAME_BYTES * 8 - GALILEO_DATA_FRAME_BITS;
+            for (int i = 0; i < GALILEO_DATA_FRAME_BITS; i++)
+                {
+                    if (page[i]) bytes[(i + pad_bits) / 8] |= 0x80 >> ((i + pad_bits) % 8);
+                }
+            boost::uint32_t crc = crc24q(bytes, GALILEO_DATA_FRAME_BYTES);
+            for (int i = 0; i < 24; i++) page[GALILEO_DATA_FRAME_BITS + i] = (crc >> (23 - i)) & 1;
+
+            std::vector<int> even(page.begin(), page.begin() + 114);
+            even.resize(GALILEO_INAV_PAGE_PART_BITS, 0);
+            std::vector<int> odd(page.begin() + 114, page.end());
+            galileo_pool_test_page_part(even, symbols);
+            galileo_pool_test_page_part(odd, symbols);
+        }
+    std::vector<unsigned char> items;
+    for (unsigned int n = 0; n < symbols.size(); n++)
+        {
+            Gnss_Synchro synchro = Gnss_Synchro();
+            synchro.Prompt_I = symbols[n];
+            synchro.Flag_valid_tracking = true;
+            synchro.Tracking_timestamp_secs = n * GALIELO_E1_CODE_PERIOD;
+            const unsigned char *bytes = reinterpret_cast<const unsigned char*>(&synchro);
+            items.insert(items.end(), bytes, bytes + sizeof(Gnss_Synchro));
+        }
+    return items;
+}
+
+
+std::vector<Gnss_Synchro> galileo_pool_test_run(bool parallel, const std::vector<unsigned char> &items,
+        concurrent_queue<Galileo_Utc_Model> *utc_model_queue)
+{
+    concurrent_queue<Galileo_Ephemeris> ephemeris_queue;
+    concurrent_queue<Galileo_Iono> iono_queue;
+    concurrent_queue<Galileo_Almanac> almanac_queue;
+    gr::msg_queue::sptr queue = gr::msg_queue::make(0);
+    galileo_e1b_telemetry_decoder_cc_sptr decoder = galileo_e1b_make_telemetry_decoder_cc(Gnss_Satellite("Galileo", 11), 0, 4000000, 16000, queue, false);
+    decoder->set_channel(parallel ? 1 : 0);
+    decoder->set_parallel_page_decoding(parallel);
+    decoder->set_ephemeris_queue(&ephemeris_queue);
+    decoder->set_iono_queue(&iono_queue);
+    decoder->set_almanac_queue(&almanac_queue);
+    decoder->set_utc_model_queue(utc_model_queue);
+
+    gr::top_block_sptr top_block = gr::make_top_block("galileo_e1b_decoder_pool_test");
+    gr::blocks::vector_source_b::sptr source = gr::blocks::vector_source_b::make(items, false, sizeof(Gnss_Synchro));
+    gr::blocks::vector_sink_b::sptr sink = gr::blocks::vector_sink_b::make(sizeof(Gnss_Synchro));
+    top_block->connect(source, 0, decoder, 0);
+    top_block->connect(decoder, 0, sink, 0);
+    top_block->run();
+    top_block->stop();
+
+    std::vector<unsigned char> data = sink->data();
+    std::vector<Gnss_Synchro> output(data.size() / sizeof(Gnss_Synchro));
+    if (!output.empty())
+        {
+            memcpy(&output[0], &data[0], output.size() * sizeof(Gnss_Synchro));
+        }
+    return output;
+}
+
+
+
+/*
+ * The decoding job of the page part k of the tracking output made by galileo_pool_test_input
+ */
+void galileo_pool_test_job(const std::vector<unsigned char> &items, int k, Galileo_E1b_Page_Pipeline *pipeline, Galileo_E1b_Decode_Job &job)
+{
+    const Gnss_Synchro *synchro = reinterpret_cast<const Gnss_Synchro*>(&items[0]) + k * GALILEO_INAV_PAGE_PART_SYMBOLS;
+    galileo_e1b_load_page_part(synchro + GALILEO_INAV_PREAMBLE_LENGTH_BITS, false, job.symbols);
+    job.pipeline = pipeline;
+    job.sample_counter = (k + 1) * GALILEO_INAV_PAGE_PART_SYMBOLS;
+    job.generation = 0;
+    job.preamble_time_seconds = synchro->Tracking_timestamp_secs;
+}
+
+
+
+TEST(GalileoE1bDecoderPoolTest, SameTowAsSynchronousDecoding)
+{
+    const unsigned int first_TOW = 345600;
+    std::vector<unsigned char> items = galileo_pool_test_input(10, first_TOW);
+    concurrent_queue<Galileo_Utc_Model> reference_utc_queue;
+    concurrent_queue<Galileo_Utc_Model> parallel_utc_queue;
+    std::vector<Gnss_Synchro> reference = galileo_pool_test_run(false, items, &reference_utc_queue);
+    std::vector<Gnss_Synchro> parallel = galileo_pool_test_run(true, items, &parallel_utc_queue);
+    ASSERT_EQ(reference.size(), parallel.size());
+
+    // the TOW of the current symbol follows the tracking time stamps (within the accumulated rounding errors)
+    int preambles = 0;
+    int valid_reference = 0;
+    double TOW_offset = 0.0;
+    for (unsigned int i = 0; i < reference.size(); i++)
+        {
+            if (reference[i].Flag_preamble) preambles++;
+            if (reference[i].Flag_valid_word)
+                {
+                    if (valid_reference == 0)
+                        {
+                            TOW_offset = reference[i].d_TOW_at_current_symbol - reference[i].Tracking_timestamp_secs;
+                            EXPECT_NEAR(first_TOW + 2.0 + GALILEO_INAV_PAGE_PART_SECONDS - reference[i].Prn_timestamp_at_preamble_ms / 1000.0, TOW_offset, 1e-7);
+                        }
+                    EXPECT_NEAR(TOW_offset, reference[i].d_TOW_at_current_symbol - reference[i].Tracking_timestamp_secs, 1e-7) << "item " << i;
+                    valid_reference++;
+                }
+            // the page parts decoded by the pool are applied at the same items
+            EXPECT_EQ(reference[i].Flag_valid_word, parallel[i].Flag_valid_word) << "item " << i;
+            EXPECT_EQ(reference[i].Flag_preamble, parallel[i].Flag_preamble) << "item " << i;
+            EXPECT_EQ(reference[i].d_TOW, parallel[i].d_TOW) << "item " << i;
+            EXPECT_EQ(reference[i].d_TOW_at_current_symbol, parallel[i].d_TOW_at_current_symbol) << "item " << i;
+            EXPECT_EQ(reference[i].Prn_timestamp_at_preamble_ms, parallel[i].Prn_timestamp_at_preamble_ms) << "item " << i;
+        }
+    EXPECT_GE(preambles, 14);
+
+    Galileo_Utc_Model utc_model;
+    EXPECT_TRUE(reference_utc_queue.try_pop(utc_model));
+    EXPECT_TRUE(parallel_utc_queue.try_pop(utc_model));
+}
+
+
+
+TEST(GalileoE1bDecoderPoolTest, FullJobQueueSameAsSerialDecoding)
+{
+    // the page parts of all the pipelines go to the same worker, faster than it decodes them
+    const int n_pipelines = 8;
+    const int n_page_parts = 40;
+    std::vector<unsigned char> items = galileo_pool_test_input(n_page_parts / 2, 345600);
+    concurrent_queue<Galileo_Ephemeris> ephemeris_queue;
+    concurrent_queue<Galileo_Iono> iono_queue;
+    concurrent_queue<Galileo_Utc_Model> utc_model_queue;
+    concurrent_queue<Galileo_Almanac> almanac_queue;
+    std::vector<boost::shared_ptr<Galileo_E1b_Page_Pipeline> > pipelines;
+    for (int p = 0; p <= n_pipelines; p++)
+        {
+            boost::shared_ptr<Galileo_E1b_Page_Pipeline> pipeline(new Galileo_E1b_Page_Pipeline());
+            pipeline->d_page_decoder.i_channel_ID = p * GALILEO_E1B_DECODER_POOL_THREADS;
+            pipeline->d_page_decoder.d_ephemeris_queue = &ephemeris_queue;
+            pipeline->d_page_decoder.d_iono_queue = &iono_queue;
+            pipeline->d_page_decoder.d_utc_model_queue = &utc_model_queue;
+            pipeline->d_page_decoder.d_almanac_queue = &almanac_queue;
+            pipelines.push_back(pipeline);
+        }
+
+    // the last pipeline decodes serially
+    Galileo_E1b_Decode_Job job;
+    Galileo_E1b_Decode_Result result;
+    std::vector<Galileo_E1b_Decode_Result> reference;
+    for (int k = 0; k < n_page_parts; k++)
+        {
+            galileo_pool_test_job(items, k, pipelines[n_pipelines].get(), job);
+            pipelines[n_pipelines]->decode(job, result);
+            reference.push_back(result);
+        }
+
+    // the others submit their page parts to the pool, and decode them as the decoder block does when it is full
+    std::vector<std::vector<Galileo_E1b_Decode_Result> > results(n_pipelines);
+    int decoded_here = 0;
+    for (int k = 0; k < n_page_parts; k++)
+        {
+            for (int p = 0; p < n_pipelines; p++)
+                {
+                    galileo_pool_test_job(items, k, pipelines[p].get(), job);
+                    if (!Galileo_E1b_Decoder_Pool::instance().submit(job))
+                        {
+                            pipelines[p]->decode_after_pending_jobs(job, results[p]);
+                            decoded_here++;
+                        }
+                    while (pipelines[p]->d_results.try_pop(result))
+                        {
+                            results[p].push_back(result);
+                        }
+                }
+        }
+    EXPECT_LT(0, decoded_here);
+
+    for (int p = 0; p < n_pipelines; p++)
+        {
+            Galileo_E1b_Decoder_Pool::instance().wait(*pipelines[p]);
+            while (pipelines[p]->d_results.try_pop(result))
+                {
+                    results[p].push_back(result);
+                }
+            EXPECT_EQ(0u, pipelines[p]->d_results.dropped_items());
+            ASSERT_EQ(reference.size(), results[p].size()) << "pipeline " << p;
+            for (unsigned int k = 0; k < reference.size(); k++)
+                {
+                    EXPECT_EQ(reference[k].sample_counter, results[p][k].sample_counter) << "pipeline " << p << ", page part " << k;
+                    EXPECT_EQ(reference[k].flag_CRC_test, results[p][k].flag_CRC_test) << "pipeline " << p << ", page part " << k;
+                    EXPECT_EQ(reference[k].TOW_page, results[p][k].TOW_page) << "pipeline " << p << ", page part " << k;
+                    EXPECT_EQ(reference[k].TOW, results[p][k].TOW) << "pipeline " << p << ", page part " << k;
+                    EXPECT_EQ(0, memcmp(reference[k].bits, results[p][k].bits, sizeof(result.bits))) << "pipeline " << p << ", page part " << k;
+                }
+        }
+    // every odd page part completes a page with the TOW
+    int TOW_pages = 0;
+    for (unsigned int k = 0; k < reference.size(); k++)
+        {
+            if (reference[k].TOW_page == 6) TOW_pages++;
+        }
+    EXPECT_EQ(n_page_parts / 2, TOW_pages);
+}
@@ -0,0 +1,282 @@
+/*!
+ * \file nav_archive_replay_source_test.cc
+ * \brief  Writes a navigation data archive and checks that the reader and
+ * the replay source give back the archived telemetry decoder output, also
+ * when the archive is written by the decoder itself, and that no record is
+ * dropped when the archive ring is full.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <gnuradio/top_block.h>
+#include <gnuradio/blocks/vector_source_b.h>
+#include <gnuradio/blocks/vector_sink_b.h>
+#include <gnuradio/msg_queue.h>
+#include "dump_writer.h"
+#include "galileo_e1b_telemetry_decoder_cc.h"
+#include "gnss_satellite.h"
+#include "gnss_synchro.h"
+#include "nav_archive.h"
+#include "nav_archive_replay_source.h"
+
+
+/*
+ * Writes the archive of a Galileo channel with one epoch record per item
+ * (4 ms apart), except for the missing item, and a page part record in item 3
+ */
+void nav_archive_test_write(const std::string &filename, int n_items, int missing_item)
+{
+    std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    Gnss_Synchro synchro = Gnss_Synchro();
+    synchro.System = 'E';
+    synchro.Signal[0] = '1';
+    synchro.Signal[1] = 'B';
+    synchro.PRN = 11;
+    Nav_Archive_Record record;
+    for (int i = 0; i < n_items; i++)
+        {
+            if (i == 3)
+                {
+                    unsigned char page_part[15] = {0}; // even page part
+                    nav_archive_nav_record(NAV_ARCHIVE_GALILEO_PAGE_PART, synchro, i, 0.0, page_part, sizeof(page_part), record);
+                    file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+                }
+            if (i == missing_item) continue;
+            synchro.Tracking_timestamp_secs = 1.0 + i * 0.004;
+            synchro.Prn_timestamp_ms = synchro.Tracking_timestamp_secs * 1000.0;
+            synchro.d_TOW_at_current_symbol = 100.0 + i * 0.004;
+            synchro.Flag_valid_word = (i % 2 == 0);
+            synchro.Flag_valid_tracking = true;
+            nav_archive_epoch_record(synchro, i, record);
+            file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        }
+}
+
+
+
+TEST(NavArchiveTest, ReaderRoundTripAndSeek)
+{
+    std::string basename = "./nav_archive_test_reader";
+    std::string filename = nav_archive_filename(basename, 0);
+    EXPECT_EQ(std::string("./nav_archive_test_reader0.dat"), filename);
+    nav_archive_test_write(filename, 100, -1);
+
+    Nav_Archive_Reader reader;
+    ASSERT_TRUE(reader.open(filename));
+    EXPECT_EQ(101u, reader.records());
+
+    Nav_Archive_Record record;
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(NAV_ARCHIVE_EPOCH, record.type);
+    EXPECT_EQ(0u, record.item);
+    Gnss_Synchro synchro;
+    nav_archive_to_gnss_synchro(record, 7, synchro);
+    EXPECT_EQ('E', synchro.System);
+    EXPECT_EQ(11u, synchro.PRN);
+    EXPECT_EQ(7, synchro.Channel_ID);
+    EXPECT_TRUE(synchro.Flag_valid_word);
+    EXPECT_TRUE(synchro.Flag_valid_tracking);
+    EXPECT_DOUBLE_EQ(1.0, synchro.Tracking_timestamp_secs);
+    EXPECT_DOUBLE_EQ(100.0, synchro.d_TOW_at_current_symbol);
+
+    // first epoch at or after 1.2 s is item 50 (record 51, after the page part record)
+    ASSERT_TRUE(reader.seek_time(1.2 - 1e-9));
+    EXPECT_EQ(51u, reader.position());
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(50u, record.item);
+
+    // a time between the page part record and the next epoch lands on the epoch
+    ASSERT_TRUE(reader.seek_time(1.0 + 2.5 * 0.004));
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(NAV_ARCHIVE_EPOCH, record.type);
+    EXPECT_EQ(3u, record.item);
+
+    EXPECT_FALSE(reader.seek_time(10.0));
+    reader.close();
+    std::remove(filename.c_str());
+}
+
+
+
+TEST(NavArchiveTest, ReplaySource)
+{
+    std::string basename = "./nav_archive_test_replay";
+    nav_archive_test_write(nav_archive_filename(basename, 0), 20, 5);
+    // channel 1 has no archive
+
+    concurrent_queue<Galileo_Ephemeris> ephemeris_queue;
+    concurrent_queue<Galileo_Iono> iono_queue;
+    concurrent_queue<Galileo_Almanac> almanac_queue;
+    concurrent_queue<Galileo_Utc_Model> utc_model_queue;
+
+    gr::top_block_sptr top_block = gr::make_top_block("nav_archive_replay_source_test");
+    nav_archive_replay_source_sptr source = nav_archive_make_replay_source(basename, 2, 0.0);
+    source->set_galileo_queues(&ephemeris_queue, &iono_queue, &almanac_queue, &utc_model_queue);
+    gr::blocks::vector_sink_b::sptr sink0 = gr::blocks::vector_sink_b::make(sizeof(Gnss_Synchro));
+    gr::blocks::vector_sink_b::sptr sink1 = gr::blocks::vector_sink_b::make(sizeof(Gnss_Synchro));
+    top_block->connect(source, 0, sink0, 0);
+    top_block->connect(source, 1, sink1, 0);
+    top_block->run();
+    top_block->stop();
+
+    std::vector<unsigned char> data0 = sink0->data();
+    std::vector<unsigned char> data1 = sink1->data();
+    ASSERT_GE(data0.size(), 20 * sizeof(Gnss_Synchro));
+    ASSERT_EQ(data0.size(), data1.size());
+    std::vector<Gnss_Synchro> out0(data0.size() / sizeof(Gnss_Synchro));
+    std::vector<Gnss_Synchro> out1(data1.size() / sizeof(Gnss_Synchro));
+    memcpy(&out0[0], &data0[0], data0.size());
+    memcpy(&out1[0], &data1[0], data1.size());
+
+    for (int i = 0; i < 20; i++)
+        {
+            EXPECT_EQ(0, out0[i].Channel_ID) << "item " << i;
+            EXPECT_EQ(1, out1[i].Channel_ID) << "item " << i;
+            EXPECT_FALSE(out1[i].Flag_valid_word) << "item " << i;
+            if (i == 5)
+                {
+                    // lost item: replayed as an empty item
+                    EXPECT_FALSE(out0[i].Flag_valid_word);
+                    EXPECT_FALSE(out0[i].Flag_valid_tracking);
+                }
+            else
+                {
+                    EXPECT_EQ(11u, out0[i].PRN) << "item " << i;
+                    EXPECT_EQ(i % 2 == 0, out0[i].Flag_valid_word) << "item " << i;
+                    EXPECT_DOUBLE_EQ(1.0 + i * 0.004, out0[i].Tracking_timestamp_secs) << "item " << i;
+                }
+        }
+    std::remove(nav_archive_filename(basename, 0).c_str());
+}
+
+
+
+TEST(NavArchiveTest, LosslessStreamKeepsEveryRecord)
+{
+    // a ring of 4 records fills up long before the writer thread wakes up
+    std::string filename = "./nav_archive_test_lossless.dat";
+    boost::shared_ptr<Dump_Stream> stream = Dump_Writer::instance().open_stream(filename, sizeof(Nav_Archive_Record), 4, true);
+    ASSERT_TRUE(stream);
+    EXPECT_TRUE(stream->is_lossless());
+    Gnss_Synchro synchro = Gnss_Synchro();
+    Nav_Archive_Record record;
+    const int n_records = 10000;
+    for (int i = 0; i < n_records; i++)
+        {
+            nav_archive_epoch_record(synchro, i, record);
+            ASSERT_TRUE(stream->push_record(record)) << "record " << i;
+        }
+    EXPECT_EQ(0u, stream->dropped_records());
+    Dump_Writer::instance().close_stream(stream);
+
+    Nav_Archive_Reader reader;
+    ASSERT_TRUE(reader.open(filename));
+    ASSERT_EQ((unsigned long long)n_records, reader.records());
+    for (int i = 0; i < n_records; i++)
+        {
+            ASSERT_TRUE(reader.next(record));
+            ASSERT_EQ((unsigned long long)i, record.item);
+        }
+    reader.close();
+    std::remove(filename.c_str());
+}
+
+
+
+TEST(NavArchiveTest, DecoderArchiveReplay)
+{
+    // the Galileo telemetry decoder archives its output, and the replay source gives it back
+    std::string basename = "./nav_archive_test_decoder";
+    const unsigned int first_TOW = 345600;
+    std::vector<unsigned char> items = galileo_pool_test_input(10, first_TOW); // see galileo_e1b_decoder_pool_test.cc
+    std::vector<Gnss_Synchro> decoded;
+    {
+        concurrent_queue<Galileo_Ephemeris> ephemeris_queue;
+        concurrent_queue<Galileo_Iono> iono_queue;
+        concurrent_queue<Galileo_Almanac> almanac_queue;
+        concurrent_queue<Galileo_Utc_Model> utc_model_queue;
+        gr::msg_queue::sptr queue = gr::msg_queue::make(0);
+        galileo_e1b_telemetry_decoder_cc_sptr decoder = galileo_e1b_make_telemetry_decoder_cc(Gnss_Satellite("Galileo", 11), 0, 4000000, 16000, queue, false);
+        decoder->set_archive(true, basename);
+        decoder->set_channel(0);
+        decoder->set_parallel_page_decoding(false); // every page part is decoded before the flow graph ends
+        decoder->set_ephemeris_queue(&ephemeris_queue);
+        decoder->set_iono_queue(&iono_queue);
+        decoder->set_almanac_queue(&almanac_queue);
+        decoder->set_utc_model_queue(&utc_model_queue);
+
+        gr::top_block_sptr top_block = gr::make_top_block("nav_archive_decoder_test");
+        gr::blocks::vector_source_b::sptr source = gr::blocks::vector_source_b::make(items, false, sizeof(Gnss_Synchro));
+        gr::blocks::vector_sink_b::sptr sink = gr::blocks::vector_sink_b::make(sizeof(Gnss_Synchro));
+        top_block->connect(source, 0, decoder, 0);
+        top_block->connect(decoder, 0, sink, 0);
+        top_block->run();
+        top_block->stop();
+        std::vector<unsigned char> data = sink->data();
+        decoded.resize(data.size() / sizeof(Gnss_Synchro));
+        ASSERT_FALSE(decoded.empty());
+        memcpy(&decoded[0], &data[0], data.size());
+        // the decoder closes its archive when it is destroyed
+    }
+
+    concurrent_queue<Galileo_Ephemeris> ephemeris_queue;
+    concurrent_queue<Galileo_Iono> iono_queue;
+    concurrent_queue<Galileo_Almanac> almanac_queue;
+    concurrent_queue<Galileo_Utc_Model> utc_model_queue;
+    gr::top_block_sptr top_block = gr::make_top_block("nav_archive_replay_test");
+    nav_archive_replay_source_sptr replay = nav_archive_make_replay_source(basename, 1, 0.0);
+    replay->set_galileo_queues(&ephemeris_queue, &iono_queue, &almanac_queue, &utc_model_queue);
+    gr::blocks::vector_sink_b::sptr sink = gr::blocks::vector_sink_b::make(sizeof(Gnss_Synchro));
+    top_block->connect(replay, 0, sink, 0);
+    top_block->run();
+    top_block->stop();
+    std::vector<unsigned char> data = sink->data();
+    std::vector<Gnss_Synchro> replayed(data.size() / sizeof(Gnss_Synchro));
+    ASSERT_LE(decoded.size(), replayed.size());
+    memcpy(&replayed[0], &data[0], data.size());
+
+    int valid_words = 0;
+    for (unsigned int i = 0; i < decoded.size(); i++)
+        {
+            ASSERT_EQ(decoded[i].Flag_valid_word, replayed[i].Flag_valid_word) << "item " << i;
+            EXPECT_EQ(decoded[i].Flag_preamble, replayed[i].Flag_preamble) << "item " << i;
+            EXPECT_EQ(decoded[i].Flag_valid_tracking, replayed[i].Flag_valid_tracking) << "item " << i;
+            EXPECT_EQ(decoded[i].Tracking_timestamp_secs, replayed[i].Tracking_timestamp_secs) << "item " << i;
+            EXPECT_EQ(decoded[i].Prn_timestamp_ms, replayed[i].Prn_timestamp_ms) << "item " << i;
+            EXPECT_EQ(decoded[i].d_TOW_at_current_symbol, replayed[i].d_TOW_at_current_symbol) << "item " << i;
+            if (decoded[i].Flag_valid_word) valid_words++;
+        }
+    EXPECT_LT(0, valid_words);
+
+    // the page parts are decoded again by the replay source
+    Galileo_Utc_Model utc_model;
+    EXPECT_TRUE(utc_model_queue.try_pop(utc_model));
+    std::remove(nav_archive_filename(basename, 0).c_str());
+}
@@ -0,0 +1,191 @@
+/*!
+ * \file observables_batch_test.cc
+ * \brief  Checks that the observables blocks produce the same output
+ * when they process one epoch per call and when they process all the
+ * available epochs per call, checks the common reception time
+ * pseudoranges and the decimated delivery of epochs to the PVT.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cstring>
+#include <vector>
+#include <gnuradio/top_block.h>
+#include <gnuradio/blocks/vector_source_b.h>
+#include <gnuradio/blocks/vector_sink_b.h>
+#include <gnuradio/msg_queue.h>
+#include "gnss_synchro.h"
+#include "gps_l1_ca_observables_cc.h"
+#include "galileo_e1_observables_cc.h"
+
+#define OBSERVABLES_BATCH_CHANNELS 4
+#define OBSERVABLES_BATCH_EPOCHS 2000
+
+
+/*
+ * Telemetry decoder output of a channel, one item per ms. Channel c gets a
+ * valid word from epoch 100 * c on, and the last channel never does.
+ */
+std::vector<unsigned char> observables_batch_input(int channel)
+{
+    std::vector<unsigned char> items;
+    for (int n = 0; n < OBSERVABLES_BATCH_EPOCHS; n++)
+        {
+            Gnss_Synchro synchro = Gnss_Synchro();
+            synchro.Channel_ID = channel;
+            synchro.PRN = channel + 1;
+            synchro.Flag_valid_tracking = true;
+            synchro.Flag_valid_word = (channel < OBSERVABLES_BATCH_CHANNELS - 1) and (n >= 100 * channel);
+            synchro.Prn_timestamp_ms = n + 0.1 * channel;
+            synchro.d_TOW_at_current_symbol = 345600.0 + n / 1000.0 - 0.001 * channel;
+            const unsigned char *bytes = reinterpret_cast<const unsigned char*>(&synchro);
+            items.insert(items.end(), bytes, bytes + sizeof(Gnss_Synchro));
+        }
+    return items;
+}
+
+
+/*
+ * Runs the observables block over the input of every channel. With
+ * max_noutput_items = 1 the block is called once per epoch, which is the
+ * reference behaviour.
+ */
+std::vector<std::vector<Gnss_Synchro> > observables_batch_run(gr::block_sptr observables, int max_noutput_items)
+{
+    gr::top_block_sptr top_block = gr::make_top_block("observables_batch_test");
+    std::vector<gr::blocks::vector_sink_b::sptr> sinks;
+    if (max_noutput_items > 0)
+        {
+            observables->set_max_noutput_items(max_noutput_items);
+        }
+    for (int c = 0; c < OBSERVABLES_BATCH_CHANNELS; c++)
+        {
+            gr::blocks::vector_source_b::sptr source = gr::blocks::vector_source_b::make(observables_batch_input(c), false, sizeof(Gnss_Synchro));
+            sinks.push_back(gr::blocks::vector_sink_b::make(sizeof(Gnss_Synchro)));
+            top_block->connect(source, 0, observables, c);
+            top_block->connect(observables, c, sinks.back(), 0);
+        }
+    top_block->run();
+    top_block->stop();
+
+    std::vector<std::vector<Gnss_Synchro> > output;
+    for (int c = 0; c < OBSERVABLES_BATCH_CHANNELS; c++)
+        {
+            std::vector<unsigned char> data = sinks.at(c)->data();
+            output.push_back(std::vector<Gnss_Synchro>(data.size() / sizeof(Gnss_Synchro)));
+            if (!output.back().empty())
+                {
+                    memcpy(&output.back()[0], &data[0], data.size());
+                }
+        }
+    return output;
+}
+
+
+void observables_batch_compare(const std::vector<std::vector<Gnss_Synchro> > &reference,
+        const std::vector<std::vector<Gnss_Synchro> > &batched, double c_m_ms, double start_offset_ms)
+{
+    ASSERT_EQ(reference.size(), batched.size());
+    for (unsigned int c = 0; c < reference.size(); c++)
+        {
+            ASSERT_EQ((unsigned int)OBSERVABLES_BATCH_EPOCHS, reference[c].size());
+            ASSERT_EQ(reference[c].size(), batched[c].size());
+            for (unsigned int n = 0; n < reference[c].size(); n++)
+                {
+                    ASSERT_EQ(reference[c][n].Flag_valid_pseudorange, batched[c][n].Flag_valid_pseudorange) << "channel " << c << " epoch " << n;
+                    ASSERT_EQ(reference[c][n].Pseudorange_m, batched[c][n].Pseudorange_m) << "channel " << c << " epoch " << n;
+                    ASSERT_EQ(reference[c][n].d_TOW_at_current_symbol, batched[c][n].d_TOW_at_current_symbol) << "channel " << c << " epoch " << n;
+                    ASSERT_EQ(reference[c][n].Prn_timestamp_ms, batched[c][n].Prn_timestamp_ms) << "channel " << c << " epoch " << n;
+                }
+        }
+
+    // channel 0 has the most recent symbol, so it is the reference
+    for (unsigned int n = 0; n < (unsigned int)OBSERVABLES_BATCH_EPOCHS; n++)
+        {
+            for (unsigned int c = 0; c < reference.size(); c++)
+                {
+                    bool valid = (c < OBSERVABLES_BATCH_CHANNELS - 1) and (n >= 100 * c);
+                    ASSERT_EQ(valid, batched[c][n].Flag_valid_pseudorange) << "channel " << c << " epoch " << n;
+                    if (valid)
+                        {
+                            double traveltime_ms = 0.001 * c * 1000.0 + 0.1 * c + start_offset_ms;
+                            EXPECT_NEAR(traveltime_ms * c_m_ms, batched[c][n].Pseudorange_m, 0.1) << "channel " << c << " epoch " << n;
+                        }
+                }
+        }
+}
+
+
+
+TEST(ObservablesBatchTest, GpsL1Ca)
+{
+    gr::msg_queue::sptr queue = gr::msg_queue::make(0);
+    gr::block_sptr reference_observables = gps_l1_ca_make_observables_cc(OBSERVABLES_BATCH_CHANNELS, queue, false, "", 1, false);
+    gr::block_sptr batch_observables = gps_l1_ca_make_observables_cc(OBSERVABLES_BATCH_CHANNELS, queue, false, "", 1, false);
+    std::vector<std::vector<Gnss_Synchro> > reference = observables_batch_run(reference_observables, 1);
+    std::vector<std::vector<Gnss_Synchro> > batched = observables_batch_run(batch_observables, 0);
+
+    observables_batch_compare(reference, batched, GPS_C_m_ms, GPS_STARTOFFSET_ms);
+}
+
+
+
+TEST(ObservablesBatchTest, GalileoE1)
+{
+    gr::msg_queue::sptr queue = gr::msg_queue::make(0);
+    gr::block_sptr reference_observables = galileo_e1_make_observables_cc(OBSERVABLES_BATCH_CHANNELS, queue, false, "", 1, false);
+    gr::block_sptr batch_observables = galileo_e1_make_observables_cc(OBSERVABLES_BATCH_CHANNELS, queue, false, "", 1, false);
+    std::vector<std::vector<Gnss_Synchro> > reference = observables_batch_run(reference_observables, 1);
+    std::vector<std::vector<Gnss_Synchro> > batched = observables_batch_run(batch_observables, 0);
+
+    observables_batch_compare(reference, batched, GALILEO_C_m_ms, GALILEO_STARTOFFSET_ms);
+}
+
+
+
+TEST(ObservablesBatchTest, DecimatedEpochs)
+{
+    const int output_rate_ms = 100;
+    gr::msg_queue::sptr queue = gr::msg_queue::make(0);
+    gr::block_sptr reference_observables = gps_l1_ca_make_observables_cc(OBSERVABLES_BATCH_CHANNELS, queue, false, "", 1, false);
+    gr::block_sptr decimated_observables = gps_l1_ca_make_observables_cc(OBSERVABLES_BATCH_CHANNELS, queue, false, "", output_rate_ms, false);
+    std::vector<std::vector<Gnss_Synchro> > reference = observables_batch_run(reference_observables, 0);
+    std::vector<std::vector<Gnss_Synchro> > decimated = observables_batch_run(decimated_observables, 0);
+
+    // the epochs delivered are the ones at the output rate, and they are not changed
+    for (unsigned int c = 0; c < reference.size(); c++)
+        {
+            ASSERT_EQ((unsigned int)(OBSERVABLES_BATCH_EPOCHS / output_rate_ms), decimated[c].size());
+            for (unsigned int m = 0; m < decimated[c].size(); m++)
+                {
+                    const Gnss_Synchro &epoch = reference[c][(m + 1) * output_rate_ms - 1];
+                    EXPECT_EQ(epoch.Prn_timestamp_ms, decimated[c][m].Prn_timestamp_ms) << "channel " << c << " output " << m;
+                    EXPECT_EQ(epoch.Flag_valid_pseudorange, decimated[c][m].Flag_valid_pseudorange) << "channel " << c << " output " << m;
+                    EXPECT_EQ(epoch.Pseudorange_m, decimated[c][m].Pseudorange_m) << "channel " << c << " output " << m;
+                    EXPECT_EQ(epoch.d_TOW_at_current_symbol, decimated[c][m].d_TOW_at_current_symbol) << "channel " << c << " output " << m;
+                }
+        }
+}
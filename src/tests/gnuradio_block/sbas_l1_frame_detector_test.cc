@@ -0,0 +1,136 @@
+/*!
+ * \file sbas_l1_frame_detector_test.cc
+ * \brief Checks the messages found by the SBAS L1 telemetry decoder in a
+ * stream of encoded messages, random bits and false preambles
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <random>
+#include <utility>
+#include <vector>
+#include <boost/crc.hpp>
+#include "concurrent_queue.h"
+#include "gnss_satellite.h"
+#include "sbas_l1_telemetry_decoder_cc.h"
+#include "sbas_telemetry_data.h"
+
+
+
+/*
+ * Appends a 250-bit message: preamble, type, random data and the CRC-24Q of the first
+ * 226 bits, optionally with a wrong CRC bit and with all the bits inverted.
+ * Returns the message as the decoder gives it: not inverted, and zero padded
+ * at the back to 32 bytes
+ */
+std::vector<unsigned char> sbas_frame_test_message(int preamble, bool wrong_crc, bool inverted, std::mt19937 &generator, std::vector<int> &bits)
+{
+    std::uniform_int_distribution<int> random_bit(0, 1);
+    std::vector<int> message(250, 0);
+    for (int i = 0; i < 8; i++) message[i] = (preamble >> (7 - i)) & 1;
+    // message type 63 (null message), so that the telemetry decoder does not parse the random data
+    for (int i = 8; i < 14; i++) message[i] = 1;
+    for (int i = 14; i < 226; i++) message[i] = random_bit(generator);
+    boost::crc_optimal<24, 0x1864CFBu, 0x0, 0x0, false, false> crc;
+    unsigned char bytes[29] = {0};
+    for (int i = 0; i < 226; i++)
+        {
+            if (message[i]) bytes[(i + 6) / 8] |= 0x80 >> ((i + 6) % 8);
+        }
+    crc.process_bytes(bytes, 29);
+    for (int i = 0; i < 24; i++) message[226 + i] = (crc.checksum() >> (23 - i)) & 1;
+    if (wrong_crc) message[240] ^= 1;
+    for (int i = 0; i < 250; i++) bits.push_back(inverted ? 1 - message[i] : message[i]);
+    std::vector<unsigned char> message_bytes(32, 0);
+    for (int i = 0; i < 250; i++)
+        {
+            if (message[i]) message_bytes[i / 8] |= 0x80 >> (i % 8);
+        }
+    return message_bytes;
+}
+
+
+
+/*
+ * Random bits, with false preambles, and messages with normal and inverted
+ * preambles, some of them with a wrong CRC, separated by 0 to 300 bits. They
+ * go through the telemetry decoder as encoded samples (K = 7, 2 samples per
+ * symbol), run by telemetry_batch_run (telemetry_decoder_batch_test.cc), which
+ * must give back the messages with a valid CRC, in order, time stamped at the
+ * first sample of their preamble.
+ */
+TEST(SbasL1FrameDetectorTest, EncodedMessages)
+{
+    const int preambles[3] = {0x53, 0x9A, 0xC6};
+    std::mt19937 generator(35);
+    std::uniform_int_distribution<int> random_bit(0, 1);
+    std::uniform_int_distribution<int> random_gap(0, 300);
+    std::vector<int> bits;
+    std::vector<std::pair<int, std::vector<unsigned char>>> expected_msgs;
+    for (int m = 0; m < 60; m++)
+        {
+            int gap = random_gap(generator);
+            for (int i = 0; i < gap; i++) bits.push_back(random_bit(generator));
+            int first_bit = bits.size();
+            bool wrong_crc = m % 4 == 3;
+            std::vector<unsigned char> message = sbas_frame_test_message(preambles[m % 3], wrong_crc, m % 5 == 2, generator, bits);
+            if (!wrong_crc)
+                {
+                    expected_msgs.push_back(std::make_pair(first_bit, message));
+                }
+        }
+    // zeros to flush the Viterbi traceback: no preamble can be found in them
+    bits.resize(bits.size() + 120, 0);
+    ASSERT_EQ(45u, expected_msgs.size());
+
+    std::vector<double> samples;
+    int state = 0;
+    for (unsigned int i = 0; i < bits.size(); i++)
+        {
+            int reg = (bits[i] << 6) | state;
+            samples.insert(samples.end(), 2, __builtin_parity(reg & 0171) ? 1.0 : -1.0);
+            samples.insert(samples.end(), 2, __builtin_parity(reg & 0133) ? 1.0 : -1.0);
+            state = reg >> 1;
+        }
+    std::vector<unsigned char> items = telemetry_batch_items(samples, 0.001);
+    gr::msg_queue::sptr queue = gr::msg_queue::make(0);
+    concurrent_queue<Sbas_Raw_Msg> raw_msg_queue;
+    sbas_l1_telemetry_decoder_cc_sptr decoder = sbas_l1_make_telemetry_decoder_cc(Gnss_Satellite("SBAS", 120), 0, 4000000, 4000, queue, false);
+    decoder->set_raw_msg_queue(&raw_msg_queue);
+    telemetry_batch_run(decoder, items, 0);
+
+    // 4 samples of 1 ms per bit
+    Sbas_Raw_Msg raw_msg;
+    unsigned int m = 0;
+    while (raw_msg_queue.try_pop(raw_msg))
+        {
+            ASSERT_LT(m, expected_msgs.size());
+            EXPECT_EQ(expected_msgs[m].second, raw_msg.get_msg()) << "message " << m;
+            EXPECT_NEAR(4 * expected_msgs[m].first / 1000.0, raw_msg.get_sample_stamp(), 1e-9) << "message " << m;
+            m++;
+        }
+    EXPECT_EQ(expected_msgs.size(), m);
+}
@@ -0,0 +1,358 @@
+/*!
+ * \file telemetry_decoder_batch_test.cc
+ * \brief  Checks that the telemetry decoders decode encoded GPS subframes,
+ * Galileo I/NAV pages and SBAS messages as they did when they processed one
+ * item per call, and that they produce the same output when they process one
+ * item per call and when they process all the available items per call.
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <cstring>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <gnuradio/top_block.h>
+#include <gnuradio/blocks/vector_source_b.h>
+#include <gnuradio/blocks/vector_sink_b.h>
+#include <gnuradio/msg_queue.h>
+#include "GPS_L1_CA.h"
+#include "Galileo_E1.h"
+#include "concurrent_queue.h"
+#include "crc24q.h"
+#include "gnss_satellite.h"
+#include "gnss_synchro.h"
+#include "gps_l1_ca_telemetry_decoder_cc.h"
+#include "galileo_e1b_telemetry_decoder_cc.h"
+#include "sbas_l1_telemetry_decoder_cc.h"
+#include "sbas_telemetry_data.h"
+
+
+/*
+ * Tracking output with one item per value of prompt, every item_period_s seconds
+ */
+std::vector<unsigned char> telemetry_batch_items(const std::vector<double> &prompt, double item_period_s)
+{
+    std::vector<unsigned char> items;
+    for (unsigned int n = 0; n < prompt.size(); n++)
+        {
+            Gnss_Synchro synchro = Gnss_Synchro();
+            synchro.Prompt_I = prompt[n];
+            synchro.Flag_valid_tracking = true;
+            synchro.Tracking_timestamp_secs = n * item_period_s;
+            const unsigned char *bytes = reinterpret_cast<const unsigned char*>(&synchro);
+            items.insert(items.end(), bytes, bytes + sizeof(Gnss_Synchro));
+        }
+    return items;
+}
+
+
+/*
+ * Appends the 20 symbols of each bit of a GPS subframe with the given subframe
+ * ID and a HOW that carries TOW_count. The data bits are zero, and the last
+ * two data bits of each word are solved to make D29 = D30 = 0 (IS-GPS-200,
+ * 20.3.5.2), so that no word is sent complemented.
+ */
+void telemetry_batch_gps_subframe(int subframe_ID, unsigned int TOW_count, std::vector<double> &symbols)
+{
+    // data bits (1 to 24) that enter the parity bits D25 to D30
+    const int parity_bits[6][16] = {{1, 2, 3, 5, 6, 10, 11, 12, 13, 14, 17, 18, 20, 23},
+                                    {2, 3, 4, 6, 7, 11, 12, 13, 14, 15, 18, 19, 21, 24},
+                                    {1, 3, 4, 5, 7, 8, 12, 13, 14, 15, 16, 19, 20, 22},
+                                    {2, 4, 5, 6, 8, 9, 13, 14, 15, 16, 17, 20, 21, 23},
+                                    {1, 3, 5, 6, 7, 9, 10, 14, 15, 16, 17, 18, 21, 22, 24},
+                                    {3, 5, 6, 8, 9, 10, 11, 13, 15, 19, 22, 23, 24}};
+    const int preamble[GPS_CA_PREAMBLE_LENGTH_BITS] = GPS_PREAMBLE;
+    for (int w = 0; w < GPS_SUBFRAME_BITS / GPS_WORD_BITS; w++)
+        {
+            int word[GPS_WORD_BITS + 1] = {0}; // indexed from 1
+            if (w == 0)
+                {
+                    for (int i = 0; i < GPS_CA_PREAMBLE_LENGTH_BITS; i++) word[1 + i] = preamble[i];
+                }
+            if (w == 1)
+                {
+                    for (int i = 0; i < 17; i++) word[1 + i] = (TOW_count >> (16 - i)) & 1;
+                    for (int i = 0; i < 3; i++) word[20 + i] = (subframe_ID >> (2 - i)) & 1;
+                }
+            for (int t = 0; t < 4; t++)
+                {
+                    word[23] = t >> 1;
+                    word[24] = t & 1;
+                    for (int p = 0; p < 6; p++)
+                        {
+                            word[25 + p] = 0;
+                            for (int k = 0; k < 16 and parity_bits[p][k] != 0; k++) word[25 + p] ^= word[parity_bits[p][k]];
+                        }
+                    if (word[29] == 0 and word[30] == 0) break;
+                }
+            for (int b = 1; b <= GPS_WORD_BITS; b++)
+                {
+                    symbols.insert(symbols.end(), 20, word[b] == 1 ? 1.0 : -1.0);
+                }
+        }
+}
+
+
+/*
+ * Tracking output (two 1 ms samples per symbol) carrying n_messages SBAS
+ * messages of type 63 (null message) with the three preambles in turn, the
+ * 250 bits convolutionally encoded (G1 = 171, G2 = 133 octal), after
+ * n_lead_samples zero samples. The messages are returned packed in bytes and
+ * zero padded at the back, as the decoder delivers them.
+ */
+std::vector<unsigned char> telemetry_batch_sbas_input(int n_messages, int n_lead_samples, std::vector<std::vector<unsigned char> > &messages)
+{
+    const int preambles[3] = {0x53, 0x9A, 0xC6};
+    std::vector<double> symbols(n_lead_samples, 0.0);
+    int state = 0;
+    for (int m = 0; m < n_messages; m++)
+        {
+            // Preamble (8) | Message type (6) | Data (212) | CRC (24)
+            std::vector<int> bits(250, 0);
+            for (int i = 0; i < 8; i++) bits[i] = (preambles[m % 3] >> (7 - i)) & 1;
+            for (int i = 0; i < 6; i++) bits[8 + i] = (63 >> (5 - i)) & 1;
+            for (int i = 14; i < 226; i++) bits[i] = ((i + m) % 5) < 2;
+            // the CRC is computed over the first 226 bits, with 6 zeros in front to fill 29 bytes
+            unsigned char bytes[29] = {0};
+            for (int i = 0; i < 226; i++)
+                {
+                    if (bits[i]) bytes[(i + 6) / 8] |= 0x80 >> ((i + 6) % 8);
+                }
+            boost::uint32_t crc = crc24q(bytes, 29);
+            for (int i = 0; i < 24; i++) bits[226 + i] = (crc >> (23 - i)) & 1;
+
+            std::vector<unsigned char> message(32, 0);
+            for (int i = 0; i < 250; i++)
+                {
+                    if (bits[i]) message[i / 8] |= 0x80 >> (i % 8);
+                    int reg = (bits[i] << 6) | state;
+                    symbols.insert(symbols.end(), 2, __builtin_parity(reg & 0171) ? 1.0 : -1.0);
+                    symbols.insert(symbols.end(), 2, __builtin_parity(reg & 0133) ? 1.0 : -1.0);
+                    state = reg >> 1;
+                }
+            messages.push_back(message);
+        }
+    return telemetry_batch_items(symbols, 0.001);
+}
+
+
+/*
+ * Runs the decoder over the input. With max_noutput_items = 1 the decoder is
+ * called once per item, and with 0 it gets all the available items.
+ */
+std::vector<Gnss_Synchro> telemetry_batch_run(gr::block_sptr decoder, const std::vector<unsigned char> &items, int max_noutput_items)
+{
+    gr::top_block_sptr top_block = gr::make_top_block("telemetry_decoder_batch_test");
+    gr::blocks::vector_source_b::sptr source = gr::blocks::vector_source_b::make(items, false, sizeof(Gnss_Synchro));
+    gr::blocks::vector_sink_b::sptr sink = gr::blocks::vector_sink_b::make(sizeof(Gnss_Synchro));
+    if (max_noutput_items > 0)
+        {
+            decoder->set_max_noutput_items(max_noutput_items);
+        }
+    top_block->connect(source, 0, decoder, 0);
+    top_block->connect(decoder, 0, sink, 0);
+    top_block->run();
+    top_block->stop();
+
+    std::vector<unsigned char> data = sink->data();
+    std::vector<Gnss_Synchro> output(data.size() / sizeof(Gnss_Synchro));
+    if (!output.empty())
+        {
+            memcpy(&output[0], &data[0], output.size() * sizeof(Gnss_Synchro));
+        }
+    return output;
+}
+
+
+void telemetry_batch_compare(const std::vector<Gnss_Synchro> &reference, const std::vector<Gnss_Synchro> &batched)
+{
+    ASSERT_EQ(reference.size(), batched.size());
+    for (unsigned int i = 0; i < reference.size(); i++)
+        {
+            ASSERT_EQ(reference[i].Tracking_timestamp_secs, batched[i].Tracking_timestamp_secs) << "item " << i;
+            ASSERT_EQ(reference[i].Prompt_I, batched[i].Prompt_I) << "item " << i;
+            ASSERT_EQ(reference[i].Flag_valid_word, batched[i].Flag_valid_word) << "item " << i;
+            ASSERT_EQ(reference[i].Flag_preamble, batched[i].Flag_preamble) << "item " << i;
+            ASSERT_EQ(reference[i].d_TOW, batched[i].d_TOW) << "item " << i;
+            ASSERT_EQ(reference[i].d_TOW_at_current_symbol, batched[i].d_TOW_at_current_symbol) << "item " << i;
+            ASSERT_EQ(reference[i].Prn_timestamp_ms, batched[i].Prn_timestamp_ms) << "item " << i;
+            ASSERT_EQ(reference[i].Prn_timestamp_at_preamble_ms, batched[i].Prn_timestamp_at_preamble_ms) << "item " << i;
+        }
+}
+
+
+
+/*
+ * Checks the SBAS messages taken from the raw message queue against the
+ * encoded ones: the message m starts at the sample n_lead_samples + 1000 * m
+ */
+void telemetry_batch_sbas_check(const std::vector<std::vector<unsigned char> > &messages, int n_lead_samples,
+        concurrent_queue<Sbas_Raw_Msg> &raw_msg_queue)
+{
+    Sbas_Raw_Msg raw_msg;
+    unsigned int m = 0;
+    while (raw_msg_queue.try_pop(raw_msg))
+        {
+            ASSERT_LT(m, messages.size());
+            EXPECT_EQ(120, raw_msg.get_prn());
+            EXPECT_EQ(63, raw_msg.get_msg_type());
+            EXPECT_EQ(messages[m], raw_msg.get_msg()) << "message " << m;
+            EXPECT_NEAR((n_lead_samples + 1000 * m) / 1000.0, raw_msg.get_sample_stamp(), 1e-9) << "message " << m;
+            m++;
+        }
+    // the Viterbi traceback holds the last message back
+    EXPECT_EQ(messages.size() - 1, m);
+}
+
+
+
+TEST(TelemetryDecoderBatchTest, GpsL1Ca)
+{
+    // subframes 1 to 5 and 1 again; the HOW carries the TOW count of the next subframe
+    const unsigned int first_TOW = 345600;
+    std::vector<double> symbols;
+    for (int k = 0; k < 6; k++)
+        {
+            telemetry_batch_gps_subframe(k % 5 + 1, (first_TOW + (k + 1) * 6) / 6, symbols);
+        }
+    std::vector<unsigned char> items = telemetry_batch_items(symbols, GPS_L1_CA_CODE_PERIOD);
+    gr::msg_queue::sptr queue = gr::msg_queue::make(0);
+    concurrent_queue<Gps_Ephemeris> ephemeris_queue;
+    concurrent_queue<Gps_Iono> iono_queue;
+    concurrent_queue<Gps_Almanac> almanac_queue;
+    concurrent_queue<Gps_Utc_Model> utc_model_queue;
+
+    std::vector<Gnss_Synchro> output[2];
+    for (int run = 0; run < 2; run++)
+        {
+            gps_l1_ca_telemetry_decoder_cc_sptr decoder = gps_l1_ca_make_telemetry_decoder_cc(Gnss_Satellite("GPS", 1), 0, 4000000, 4000, queue, false);
+            decoder->set_ephemeris_queue(&ephemeris_queue);
+            decoder->set_iono_queue(&iono_queue);
+            decoder->set_almanac_queue(&almanac_queue);
+            decoder->set_utc_model_queue(&utc_model_queue);
+            output[run] = telemetry_batch_run(decoder, items, run == 0 ? 1 : 0);
+        }
+    telemetry_batch_compare(output[0], output[1]);
+
+    // as in the decoder that processed one item per call: the frame sync comes at the
+    // second preamble, the subframe that starts there is decoded at its end, and its
+    // TOW applies from the third preamble on
+    const std::vector<Gnss_Synchro> &reference = output[0];
+    ASSERT_GT(reference.size(), 5u * 6000u);
+    for (unsigned int i = 0; i < reference.size(); i++)
+        {
+            if (i < 2 * 6000)
+                {
+                    ASSERT_FALSE(reference[i].Flag_valid_word) << "item " << i;
+                    continue;
+                }
+            ASSERT_TRUE(reference[i].Flag_valid_word) << "item " << i;
+            EXPECT_NEAR(first_TOW + reference[i].Tracking_timestamp_secs, reference[i].d_TOW_at_current_symbol, 1e-6) << "item " << i;
+            EXPECT_EQ(i % 6000 == 0, reference[i].Flag_preamble) << "item " << i;
+            if (reference[i].Flag_preamble)
+                {
+                    EXPECT_DOUBLE_EQ(first_TOW + i / 1000, reference[i].d_TOW) << "item " << i;
+                }
+        }
+}
+
+
+
+TEST(TelemetryDecoderBatchTest, GalileoE1b)
+{
+    // I/NAV pages of word type 6 made by galileo_pool_test_input (galileo_e1b_decoder_pool_test.cc),
+    // with the TOW of the page p equal to first_TOW + 2 * p
+    const unsigned int first_TOW = 345600;
+    std::vector<unsigned char> items = galileo_pool_test_input(10, first_TOW);
+    gr::msg_queue::sptr queue = gr::msg_queue::make(0);
+    concurrent_queue<Galileo_Ephemeris> ephemeris_queue;
+    concurrent_queue<Galileo_Iono> iono_queue;
+    concurrent_queue<Galileo_Almanac> almanac_queue;
+    concurrent_queue<Galileo_Utc_Model> utc_model_queue;
+
+    std::vector<Gnss_Synchro> output[2];
+    for (int run = 0; run < 2; run++)
+        {
+            galileo_e1b_telemetry_decoder_cc_sptr decoder = galileo_e1b_make_telemetry_decoder_cc(Gnss_Satellite("Galileo", 11), 0, 4000000, 16000, queue, false);
+            decoder->set_parallel_page_decoding(false);
+            decoder->set_ephemeris_queue(&ephemeris_queue);
+            decoder->set_iono_queue(&iono_queue);
+            decoder->set_almanac_queue(&almanac_queue);
+            decoder->set_utc_model_queue(&utc_model_queue);
+            output[run] = telemetry_batch_run(decoder, items, run == 0 ? 1 : 0);
+        }
+    telemetry_batch_compare(output[0], output[1]);
+
+    // as in the decoder that processed one item per call: the words are valid from
+    // the preamble of the fourth page part on, with the TOW of the transmitted pages.
+    // Each page part is applied GALILEO_E1B_PAGE_RESULT_DELAY_ITEMS items after its preamble.
+    const std::vector<Gnss_Synchro> &reference = output[0];
+    ASSERT_GT(reference.size(), 9u * GALILEO_INAV_PAGE_SYMBOLS);
+    for (unsigned int i = 0; i < reference.size(); i++)
+        {
+            if (i < 3 * GALILEO_INAV_PAGE_PART_SYMBOLS + GALILEO_E1B_PAGE_RESULT_DELAY_ITEMS)
+                {
+                    ASSERT_FALSE(reference[i].Flag_valid_word) << "item " << i;
+                    continue;
+                }
+            ASSERT_TRUE(reference[i].Flag_valid_word) << "item " << i;
+            EXPECT_NEAR(first_TOW + reference[i].Tracking_timestamp_secs, reference[i].d_TOW_at_current_symbol, 1e-6) << "item " << i;
+            EXPECT_EQ((i - GALILEO_E1B_PAGE_RESULT_DELAY_ITEMS) % GALILEO_INAV_PAGE_PART_SYMBOLS == 0, reference[i].Flag_preamble) << "item " << i;
+        }
+
+    // eight pages are decoded in each run, with the UTC model of word type 6
+    Galileo_Utc_Model utc_model;
+    int n_utc_models = 0;
+    while (utc_model_queue.try_pop(utc_model)) n_utc_models++;
+    EXPECT_EQ(2 * 8, n_utc_models);
+}
+
+
+
+TEST(TelemetryDecoderBatchTest, SbasL1)
+{
+    // with the samples paired as the symbols, and shifted by one symbol and one sample
+    const int n_messages = 8;
+    const int lead_samples[2] = {0, 3};
+    for (int l = 0; l < 2; l++)
+        {
+            std::vector<std::vector<unsigned char> > messages;
+            std::vector<unsigned char> items = telemetry_batch_sbas_input(n_messages, lead_samples[l], messages);
+            gr::msg_queue::sptr queue = gr::msg_queue::make(0);
+
+            std::vector<Gnss_Synchro> output[2];
+            for (int run = 0; run < 2; run++)
+                {
+                    concurrent_queue<Sbas_Raw_Msg> raw_msg_queue;
+                    sbas_l1_telemetry_decoder_cc_sptr decoder = sbas_l1_make_telemetry_decoder_cc(Gnss_Satellite("SBAS", 120), 0, 4000000, 4000, queue, false);
+                    decoder->set_raw_msg_queue(&raw_msg_queue);
+                    output[run] = telemetry_batch_run(decoder, items, run == 0 ? 1 : 0);
+                    telemetry_batch_sbas_check(messages, lead_samples[l], raw_msg_queue);
+                }
+            EXPECT_FALSE(output[0].empty());
+            telemetry_batch_compare(output[0], output[1]);
+        }
+}
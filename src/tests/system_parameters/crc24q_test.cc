@@ -0,0 +1,133 @@
+/*!
+ * \file crc24q_test.cc
+ * \brief Checks crc24q() on known checksums, and the CRC of the Galileo I/NAV
+ * pages on a page whose CRC was computed by boost::crc_optimal
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+
+#include <random>
+#include <string>
+#include <vector>
+#include "crc24q.h"
+#include "Galileo_E1.h"
+#include "galileo_navigation_message.h"
+
+
+/*
+ * An even and an odd page part without their tails, with the CRC computed by
+ * the boost::crc_optimal<24, 0x1864CFB> that crc24q() replaces:
+ * Even (1) | Page type (1) | Data_k (112) | Odd (1) | ... | CRC (24) | Reserved 2 (8) | Tail (6)
+ */
+const char crc24q_test_galileo_page[] =
+        "001000100011000001010111111010110110000010011000100111000100"
+        "011111101101111111010001110000101100111101011000000011110010"
+        "001011010001110010111101110100101010100101111001100100101111"
+        "110101100011111010110100110001011110001010111101100111";
+
+
+std::vector<unsigned char> crc24q_test_bytes(const std::string &hex)
+{
+    std::vector<unsigned char> bytes;
+    for (unsigned int i = 0; i + 1 < hex.size(); i += 2)
+        {
+            bytes.push_back(std::stoi(hex.substr(i, 2), 0, 16));
+        }
+    return bytes;
+}
+
+
+
+TEST(Crc24q_Test, KnownChecksums)
+{
+    // check value of the CRC-24Q
+    std::string check = "123456789";
+    EXPECT_EQ(0xCDE703u, crc24q((const unsigned char*)check.data(), check.size()));
+    EXPECT_EQ(0u, crc24q((const unsigned char*)check.data(), 0));
+
+    // the RTCM 3 message 1005 of the RTCM standard example (rtcm_printer_test.cc), without its CRC
+    std::vector<unsigned char> frame = crc24q_test_bytes("D300133ED7D30202980EDEEF34B4BD62AC0941986F33");
+    EXPECT_EQ(0x360B98u, crc24q(frame.data(), frame.size()));
+}
+
+
+
+/*
+ * A message followed by its CRC has a zero CRC, and the CRC does not depend
+ * on how the message is split between calls
+ */
+TEST(Crc24q_Test, ChecksumProperties)
+{
+    std::mt19937 generator(33);
+    std::uniform_int_distribution<int> random_byte(0, 255);
+    for (int length = 0; length <= 64; length++)
+        {
+            for (int k = 0; k < 20; k++)
+                {
+                    std::vector<unsigned char> bytes(length + 3);
+                    for (int i = 0; i < length; i++) bytes[i] = random_byte(generator);
+                    boost::uint32_t crc = crc24q(bytes.data(), length);
+                    ASSERT_GT(0x1000000u, crc);
+                    bytes[length] = crc >> 16;
+                    bytes[length + 1] = crc >> 8;
+                    bytes[length + 2] = crc;
+                    EXPECT_EQ(0u, crc24q(bytes.data(), length + 3)) << "length " << length;
+
+                    // split in two calls
+                    int first = k * length / 20;
+                    boost::uint32_t partial = crc24q_update(0, bytes.data(), first);
+                    EXPECT_EQ(crc, crc24q_update(partial, bytes.data() + first, length - first)) << "length " << length;
+                }
+        }
+}
+
+
+
+/*
+ * The page of crc24q_test_galileo_page passes the CRC check, and fails it
+ * with any bit of the frame or of the CRC changed
+ */
+TEST(Crc24q_Test, GalileoPageCrc)
+{
+    const int even_bits = GALILEO_INAV_PAGE_PART_BITS - 6;
+    const std::string page_INAV(crc24q_test_galileo_page);
+    ASSERT_EQ((unsigned int)(even_bits + GALILEO_INAV_PAGE_PART_BITS), page_INAV.size());
+
+    Galileo_Navigation_Message nav;
+    nav.split_page(page_INAV.substr(0, even_bits), 0);
+    nav.split_page(page_INAV.substr(even_bits), 1);
+    EXPECT_TRUE(nav.flag_CRC_test);
+
+    for (int position = 0; position < GALILEO_DATA_FRAME_BITS + 24; position++)
+        {
+            std::string page = page_INAV;
+            page[position] = page[position] == '1' ? '0' : '1';
+            Galileo_Navigation_Message wrong_nav;
+            wrong_nav.split_page(page.substr(0, even_bits), 0);
+            wrong_nav.split_page(page.substr(even_bits), 1);
+            EXPECT_FALSE(wrong_nav.flag_CRC_test) << "bit " << position;
+        }
+}
@@ -0,0 +1,388 @@
+/*!
+ * \file gps_navigation_message_test.cc
+ * \brief Tests the GPS L1 C/A subframe decoder of Gps_Navigation_Message
+ * on known subframes and on subframes encoded with random field values
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <cstring>
+#include <random>
+#include "gps_navigation_message.h"
+
+
+/*
+ * Subframes 1, 2, 3, 4 (page 18) and 5 (page 25) with valid parity, as stored by the
+ * telemetry decoder (one 32-bit word per GPS word, D29* and D30* in the two MSB).
+ */
+const unsigned int reference_subframes[5][10] = {
+    {0x22C00012, 0xB0F14926, 0xAF340073, 0xC000003F, 0xC000003F, 0xC000003F, 0xC0003D46, 0xA8E4B1E6, 0x803FFD3C, 0x3E1DC013},
+    {0x22C00012, 0xB0F16A1D, 0x68FE0C35, 0x4BB82D87, 0xDA7F4B93, 0xFD12008A, 0x9D4C21D2, 0x86D62847, 0xC353C802, 0xA3B1C00A},
+    {0x22C00012, 0xB0F18B21, 0x40190EBC, 0x379A2C6F, 0xFFF389D5, 0x55B3403A, 0x85DC3A24, 0x0A1F003D, 0x7FEA8418, 0x28FED419},
+    {0x22C00012, 0xB0F1AC36, 0x9482FFFD, 0x711E1685, 0x7F6716AB, 0xFFFFFDB9, 0x7FFFFFD5, 0x7F6439A6, 0x842241FC, 0x0400001C},
+    {0x22C00012, 0xB0F1CD15, 0x56643980, 0x00000FDE, 0x80000029, 0x4003F010, 0x00000000, 0x00FC003A, 0x80000029, 0x40000016}
+};
+
+
+
+
+/*
+ * Decodes one of the subframes above with Gps_Navigation_Message
+ */
+int gps_navigation_test_decode(Gps_Navigation_Message &nav, const unsigned int *words)
+{
+    char subframe[GPS_SUBFRAME_BITS / GPS_WORD_BITS * 4];
+    memcpy(subframe, words, sizeof(subframe));
+    return nav.subframe_decoder(subframe);
+}
+
+
+/*
+ * Writes the raw value of a field at its bit positions in the subframe words
+ */
+void gps_navigation_test_put(unsigned int *words, const Gps_Navigation_Field &field, unsigned long long raw)
+{
+    int bit = 0;
+    for (int i = 0; i < field.num_slices; i++)
+        {
+            bit += field.slices[i].length;
+        }
+    for (int i = 0; i < field.num_slices; i++)
+        {
+            for (int j = 0; j < field.slices[i].length; j++)
+                {
+                    const int position = field.slices[i].first + j - 1;
+                    const unsigned int mask = 1U << (GPS_WORD_BITS - 1 - position % GPS_WORD_BITS);
+                    bit--;
+                    if ((raw >> bit) & 1)
+                        {
+                            words[position / GPS_WORD_BITS] |= mask;
+                        }
+                    else
+                        {
+                            words[position / GPS_WORD_BITS] &= ~mask;
+                        }
+                }
+        }
+}
+
+
+/*
+ * Writes a random value of the width of the field, and returns it with the
+ * sign of the field
+ */
+long int gps_navigation_test_put_random(std::mt19937 &rng, unsigned int *words, const Gps_Navigation_Field &field, bool is_signed)
+{
+    int width = 0;
+    for (int i = 0; i < field.num_slices; i++)
+        {
+            width += field.slices[i].length;
+        }
+    const unsigned long long raw = (unsigned long long)rng() & ((1ULL << width) - 1);
+    gps_navigation_test_put(words, field, raw);
+    if (is_signed && ((raw >> (width - 1)) & 1))
+        {
+            return (long int)raw - (long int)(1ULL << width);
+        }
+    return (long int)raw;
+}
+
+
+
+TEST(GpsNavigationMessageTest, KnownSubframes)
+{
+    Gps_Navigation_Message nav;
+
+    EXPECT_EQ(1, gps_navigation_test_decode(nav, reference_subframes[0]));
+    EXPECT_EQ(601398, nav.d_TOW);
+    EXPECT_FALSE(nav.b_integrity_status_flag);
+    EXPECT_FALSE(nav.b_alert_flag);
+    EXPECT_TRUE(nav.b_antispoofing_flag);
+    EXPECT_EQ(601404, nav.d_TOW_SF1);
+    EXPECT_EQ(755, nav.i_GPS_week);
+    EXPECT_EQ(0, nav.i_SV_accuracy);
+    EXPECT_EQ(0, nav.i_SV_health);
+    EXPECT_FALSE(nav.b_L2_P_data_flag);
+    EXPECT_EQ(1, nav.i_code_on_L2);
+    EXPECT_DOUBLE_EQ(-11 * T_GD_LSB, nav.d_TGD);
+    EXPECT_EQ(419, nav.d_IODC);
+    EXPECT_DOUBLE_EQ(37575 * T_OC_LSB, nav.d_Toc);
+    EXPECT_DOUBLE_EQ(-123456 * A_F0_LSB, nav.d_A_f0);
+    EXPECT_DOUBLE_EQ(-12 * A_F1_LSB, nav.d_A_f1);
+    EXPECT_DOUBLE_EQ(0, nav.d_A_f2);
+
+    EXPECT_EQ(2, gps_navigation_test_decode(nav, reference_subframes[1]));
+    EXPECT_EQ(601404, nav.d_TOW);
+    EXPECT_EQ(601410, nav.d_TOW_SF2);
+    EXPECT_EQ(163, nav.d_IODE_SF2);
+    EXPECT_DOUBLE_EQ(-2000 * C_RS_LSB, nav.d_Crs);
+    EXPECT_DOUBLE_EQ(12000 * DELTA_N_LSB, nav.d_Delta_n);
+    EXPECT_DOUBLE_EQ(-1234567890 * M_0_LSB, nav.d_M_0);
+    EXPECT_DOUBLE_EQ(-3000 * C_UC_LSB, nav.d_Cuc);
+    EXPECT_DOUBLE_EQ(41234567 * E_LSB, nav.d_e_eccentricity);
+    EXPECT_DOUBLE_EQ(7000 * C_US_LSB, nav.d_Cus);
+    EXPECT_DOUBLE_EQ(2702004000.0 * SQRT_A_LSB, nav.d_sqrt_A);
+    EXPECT_DOUBLE_EQ(36551 * T_OE_LSB, nav.d_Toe);
+    EXPECT_TRUE(nav.b_fit_interval_flag);
+    EXPECT_EQ(2700, nav.i_AODO);
+
+    EXPECT_EQ(3, gps_navigation_test_decode(nav, reference_subframes[2]));
+    EXPECT_EQ(601410, nav.d_TOW);
+    EXPECT_EQ(601416, nav.d_TOW_SF3);
+    EXPECT_DOUBLE_EQ(100 * C_IC_LSB, nav.d_Cic);
+    EXPECT_DOUBLE_EQ(987654321 * OMEGA_0_LSB, nav.d_OMEGA0);
+    EXPECT_DOUBLE_EQ(-50 * C_IS_LSB, nav.d_Cis);
+    EXPECT_DOUBLE_EQ(660000000 * I_0_LSB, nav.d_i_0);
+    EXPECT_DOUBLE_EQ(6000 * C_RC_LSB, nav.d_Crc);
+    EXPECT_DOUBLE_EQ(-400000000 * OMEGA_LSB, nav.d_OMEGA);
+    EXPECT_DOUBLE_EQ(-22000 * OMEGA_DOT_LSB, nav.d_OMEGA_DOT);
+    EXPECT_EQ(163, nav.d_IODE_SF3);
+    EXPECT_DOUBLE_EQ(-300 * I_DOT_LSB, nav.d_IDOT);
+
+    EXPECT_EQ(4, gps_navigation_test_decode(nav, reference_subframes[3]));
+    EXPECT_EQ(601416, nav.d_TOW);
+    EXPECT_EQ(601422, nav.d_TOW_SF4);
+    EXPECT_DOUBLE_EQ(11 * ALPHA_0_LSB, nav.d_alpha0);
+    EXPECT_DOUBLE_EQ(-1 * ALPHA_1_LSB, nav.d_alpha1);
+    EXPECT_DOUBLE_EQ(-60 * ALPHA_2_LSB, nav.d_alpha2);
+    EXPECT_DOUBLE_EQ(120 * ALPHA_3_LSB, nav.d_alpha3);
+    EXPECT_DOUBLE_EQ(90 * BETA_0_LSB, nav.d_beta0);
+    EXPECT_DOUBLE_EQ(-3 * BETA_1_LSB, nav.d_beta1);
+    EXPECT_DOUBLE_EQ(-100 * BETA_2_LSB, nav.d_beta2);
+    EXPECT_DOUBLE_EQ(90 * BETA_3_LSB, nav.d_beta3);
+    EXPECT_DOUBLE_EQ(-10 * A_1_LSB, nav.d_A1);
+    EXPECT_DOUBLE_EQ(-3 * A_0_LSB, nav.d_A0);
+    EXPECT_DOUBLE_EQ(144 * T_OT_LSB, nav.d_t_OT);
+    EXPECT_EQ(230, nav.i_WN_T);
+    EXPECT_EQ(16, nav.d_DeltaT_LS);
+    EXPECT_EQ(137, nav.i_WN_LSF);
+    EXPECT_EQ(7, nav.i_DN);
+    EXPECT_EQ(16, nav.d_DeltaT_LSF);
+    EXPECT_TRUE(nav.flag_iono_valid);
+    EXPECT_TRUE(nav.flag_utc_model_valid);
+
+    EXPECT_EQ(5, gps_navigation_test_decode(nav, reference_subframes[4]));
+    EXPECT_EQ(601422, nav.d_TOW);
+    EXPECT_EQ(601428, nav.d_TOW_SF5);
+    EXPECT_DOUBLE_EQ(144 * T_OA_LSB, nav.d_Toa);
+    EXPECT_EQ(230, nav.i_WN_A);
+    for (int sv = 1; sv <= 24; sv++)
+        {
+            EXPECT_EQ((sv == 4 || sv == 11 || sv == 18) ? 63 : 0, nav.almanacHealth[sv]) << "SV " << sv;
+        }
+}
+
+
+
+TEST(GpsNavigationMessageTest, EncodeDecode)
+{
+    const Gps_Navigation_Field* health_sv1_24[24] = {&HEALTH_SV1, &HEALTH_SV2, &HEALTH_SV3, &HEALTH_SV4,
+            &HEALTH_SV5, &HEALTH_SV6, &HEALTH_SV7, &HEALTH_SV8, &HEALTH_SV9, &HEALTH_SV10, &HEALTH_SV11,
+            &HEALTH_SV12, &HEALTH_SV13, &HEALTH_SV14, &HEALTH_SV15, &HEALTH_SV16, &HEALTH_SV17, &HEALTH_SV18,
+            &HEALTH_SV19, &HEALTH_SV20, &HEALTH_SV21, &HEALTH_SV22, &HEALTH_SV23, &HEALTH_SV24};
+    const Gps_Navigation_Field* health_sv25_32[8] = {&HEALTH_SV25, &HEALTH_SV26, &HEALTH_SV27, &HEALTH_SV28,
+            &HEALTH_SV29, &HEALTH_SV30, &HEALTH_SV31, &HEALTH_SV32};
+    long int health[33];
+
+    Gps_Navigation_Message nav;
+    std::mt19937 rng(1);
+    for (int n = 0; n < 5000; n++)
+        {
+            // random D29*, D30* and bits outside of the fields
+            unsigned int words[10];
+            for (int i = 0; i < 10; i++)
+                {
+                    words[i] = rng();
+                }
+            const int subframe_ID = 1 + n % 5;
+            const int SV_page = (n / 5) % 2 == 0 ? 18 : 25;
+            gps_navigation_test_put(words, SUBFRAME_ID, subframe_ID);
+            gps_navigation_test_put(words, SV_PAGE, SV_page);
+            const long int tow = gps_navigation_test_put_random(rng, words, TOW, false);
+            const bool integrity = gps_navigation_test_put_random(rng, words, INTEGRITY_STATUS_FLAG, false);
+            const bool alert = gps_navigation_test_put_random(rng, words, ALERT_FLAG, false);
+            const bool antispoofing = gps_navigation_test_put_random(rng, words, ANTI_SPOOFING_FLAG, false);
+
+            switch (subframe_ID)
+            {
+            case 1:
+                {
+                    const long int week = gps_navigation_test_put_random(rng, words, GPS_WEEK, false);
+                    const long int code_on_L2 = gps_navigation_test_put_random(rng, words, CA_OR_P_ON_L2, false);
+                    const long int accuracy = gps_navigation_test_put_random(rng, words, SV_ACCURACY, false);
+                    const long int sv_health = gps_navigation_test_put_random(rng, words, SV_HEALTH, false);
+                    const bool L2_P_data = gps_navigation_test_put_random(rng, words, L2_P_DATA_FLAG, false);
+                    const long int tgd = gps_navigation_test_put_random(rng, words, T_GD, true);
+                    const long int iodc = gps_navigation_test_put_random(rng, words, IODC, false);
+                    const long int toc = gps_navigation_test_put_random(rng, words, T_OC, false);
+                    const long int af2 = gps_navigation_test_put_random(rng, words, A_F2, true);
+                    const long int af1 = gps_navigation_test_put_random(rng, words, A_F1, true);
+                    const long int af0 = gps_navigation_test_put_random(rng, words, A_F0, true);
+                    ASSERT_EQ(1, gps_navigation_test_decode(nav, words));
+                    EXPECT_EQ(tow * 6, nav.d_TOW_SF1);
+                    EXPECT_EQ(week, nav.i_GPS_week);
+                    EXPECT_EQ(code_on_L2, nav.i_code_on_L2);
+                    EXPECT_EQ(accuracy, nav.i_SV_accuracy);
+                    EXPECT_EQ(sv_health, nav.i_SV_health);
+                    EXPECT_EQ(L2_P_data, nav.b_L2_P_data_flag);
+                    EXPECT_DOUBLE_EQ(tgd * T_GD_LSB, nav.d_TGD);
+                    EXPECT_EQ(iodc, nav.d_IODC);
+                    EXPECT_DOUBLE_EQ(toc * T_OC_LSB, nav.d_Toc);
+                    EXPECT_DOUBLE_EQ(af2 * A_F2_LSB, nav.d_A_f2);
+                    EXPECT_DOUBLE_EQ(af1 * A_F1_LSB, nav.d_A_f1);
+                    EXPECT_DOUBLE_EQ(af0 * A_F0_LSB, nav.d_A_f0);
+                    break;
+                }
+            case 2:
+                {
+                    // FIT_INTERVAL_FLAG and AODO share their bits with T_OE in GPS_L1_CA.h,
+                    // they are checked on the known subframes only
+                    const long int iode = gps_navigation_test_put_random(rng, words, IODE_SF2, false);
+                    const long int crs = gps_navigation_test_put_random(rng, words, C_RS, true);
+                    const long int delta_n = gps_navigation_test_put_random(rng, words, DELTA_N, true);
+                    const long int m0 = gps_navigation_test_put_random(rng, words, M_0, true);
+                    const long int cuc = gps_navigation_test_put_random(rng, words, C_UC, true);
+                    const long int e = gps_navigation_test_put_random(rng, words, E, false);
+                    const long int cus = gps_navigation_test_put_random(rng, words, C_US, true);
+                    const long int sqrt_a = gps_navigation_test_put_random(rng, words, SQRT_A, false);
+                    const long int toe = gps_navigation_test_put_random(rng, words, T_OE, false);
+                    ASSERT_EQ(2, gps_navigation_test_decode(nav, words));
+                    EXPECT_EQ(tow * 6, nav.d_TOW_SF2);
+                    EXPECT_EQ(iode, nav.d_IODE_SF2);
+                    EXPECT_DOUBLE_EQ(crs * C_RS_LSB, nav.d_Crs);
+                    EXPECT_DOUBLE_EQ(delta_n * DELTA_N_LSB, nav.d_Delta_n);
+                    EXPECT_DOUBLE_EQ(m0 * M_0_LSB, nav.d_M_0);
+                    EXPECT_DOUBLE_EQ(cuc * C_UC_LSB, nav.d_Cuc);
+                    EXPECT_DOUBLE_EQ(e * E_LSB, nav.d_e_eccentricity);
+                    EXPECT_DOUBLE_EQ(cus * C_US_LSB, nav.d_Cus);
+                    EXPECT_DOUBLE_EQ(sqrt_a * SQRT_A_LSB, nav.d_sqrt_A);
+                    EXPECT_DOUBLE_EQ(toe * T_OE_LSB, nav.d_Toe);
+                    break;
+                }
+            case 3:
+                {
+                    const long int cic = gps_navigation_test_put_random(rng, words, C_IC, true);
+                    const long int omega0 = gps_navigation_test_put_random(rng, words, OMEGA_0, true);
+                    const long int cis = gps_navigation_test_put_random(rng, words, C_IS, true);
+                    const long int i0 = gps_navigation_test_put_random(rng, words, I_0, true);
+                    const long int crc = gps_navigation_test_put_random(rng, words, C_RC, true);
+                    const long int omega = gps_navigation_test_put_random(rng, words, OMEGA, true);
+                    const long int omega_dot = gps_navigation_test_put_random(rng, words, OMEGA_DOT, true);
+                    const long int iode = gps_navigation_test_put_random(rng, words, IODE_SF3, false);
+                    const long int idot = gps_navigation_test_put_random(rng, words, I_DOT, true);
+                    ASSERT_EQ(3, gps_navigation_test_decode(nav, words));
+                    EXPECT_EQ(tow * 6, nav.d_TOW_SF3);
+                    EXPECT_DOUBLE_EQ(cic * C_IC_LSB, nav.d_Cic);
+                    EXPECT_DOUBLE_EQ(omega0 * OMEGA_0_LSB, nav.d_OMEGA0);
+                    EXPECT_DOUBLE_EQ(cis * C_IS_LSB, nav.d_Cis);
+                    EXPECT_DOUBLE_EQ(i0 * I_0_LSB, nav.d_i_0);
+                    EXPECT_DOUBLE_EQ(crc * C_RC_LSB, nav.d_Crc);
+                    EXPECT_DOUBLE_EQ(omega * OMEGA_LSB, nav.d_OMEGA);
+                    EXPECT_DOUBLE_EQ(omega_dot * OMEGA_DOT_LSB, nav.d_OMEGA_DOT);
+                    EXPECT_EQ(iode, nav.d_IODE_SF3);
+                    EXPECT_DOUBLE_EQ(idot * I_DOT_LSB, nav.d_IDOT);
+                    break;
+                }
+            case 4:
+                if (SV_page == 18)
+                    {
+                        const long int alpha0 = gps_navigation_test_put_random(rng, words, ALPHA_0, true);
+                        const long int alpha1 = gps_navigation_test_put_random(rng, words, ALPHA_1, true);
+                        const long int alpha2 = gps_navigation_test_put_random(rng, words, ALPHA_2, true);
+                        const long int alpha3 = gps_navigation_test_put_random(rng, words, ALPHA_3, true);
+                        const long int beta0 = gps_navigation_test_put_random(rng, words, BETA_0, true);
+                        const long int beta1 = gps_navigation_test_put_random(rng, words, BETA_1, true);
+                        const long int beta2 = gps_navigation_test_put_random(rng, words, BETA_2, true);
+                        const long int beta3 = gps_navigation_test_put_random(rng, words, BETA_3, true);
+                        const long int a1 = gps_navigation_test_put_random(rng, words, A_1, true);
+                        const long int a0 = gps_navigation_test_put_random(rng, words, A_0, true);
+                        const long int tot = gps_navigation_test_put_random(rng, words, T_OT, false);
+                        const long int wnt = gps_navigation_test_put_random(rng, words, WN_T, false);
+                        const long int deltat_ls = gps_navigation_test_put_random(rng, words, DELTAT_LS, true);
+                        const long int wn_lsf = gps_navigation_test_put_random(rng, words, WN_LSF, false);
+                        const long int dn = gps_navigation_test_put_random(rng, words, DN, false);
+                        const long int deltat_lsf = gps_navigation_test_put_random(rng, words, DELTAT_LSF, true);
+                        ASSERT_EQ(4, gps_navigation_test_decode(nav, words));
+                        EXPECT_DOUBLE_EQ(alpha0 * ALPHA_0_LSB, nav.d_alpha0);
+                        EXPECT_DOUBLE_EQ(alpha1 * ALPHA_1_LSB, nav.d_alpha1);
+                        EXPECT_DOUBLE_EQ(alpha2 * ALPHA_2_LSB, nav.d_alpha2);
+                        EXPECT_DOUBLE_EQ(alpha3 * ALPHA_3_LSB, nav.d_alpha3);
+                        EXPECT_DOUBLE_EQ(beta0 * BETA_0_LSB, nav.d_beta0);
+                        EXPECT_DOUBLE_EQ(beta1 * BETA_1_LSB, nav.d_beta1);
+                        EXPECT_DOUBLE_EQ(beta2 * BETA_2_LSB, nav.d_beta2);
+                        EXPECT_DOUBLE_EQ(beta3 * BETA_3_LSB, nav.d_beta3);
+                        EXPECT_DOUBLE_EQ(a1 * A_1_LSB, nav.d_A1);
+                        EXPECT_DOUBLE_EQ(a0 * A_0_LSB, nav.d_A0);
+                        EXPECT_DOUBLE_EQ(tot * T_OT_LSB, nav.d_t_OT);
+                        EXPECT_EQ(wnt, nav.i_WN_T);
+                        EXPECT_EQ(deltat_ls, nav.d_DeltaT_LS);
+                        EXPECT_EQ(wn_lsf, nav.i_WN_LSF);
+                        EXPECT_EQ(dn, nav.i_DN);
+                        EXPECT_EQ(deltat_lsf, nav.d_DeltaT_LSF);
+                    }
+                else
+                    {
+                        for (int sv = 25; sv <= 32; sv++)
+                            {
+                                health[sv] = gps_navigation_test_put_random(rng, words, *health_sv25_32[sv - 25], false);
+                            }
+                        ASSERT_EQ(4, gps_navigation_test_decode(nav, words));
+                        for (int sv = 25; sv <= 32; sv++)
+                            {
+                                EXPECT_EQ(health[sv], nav.almanacHealth[sv]) << "SV " << sv;
+                            }
+                    }
+                EXPECT_EQ(tow * 6, nav.d_TOW_SF4);
+                break;
+            case 5:
+                if (SV_page == 25)
+                    {
+                        const long int toa = gps_navigation_test_put_random(rng, words, T_OA, false);
+                        const long int wna = gps_navigation_test_put_random(rng, words, WN_A, false);
+                        for (int sv = 1; sv <= 24; sv++)
+                            {
+                                health[sv] = gps_navigation_test_put_random(rng, words, *health_sv1_24[sv - 1], false);
+                            }
+                        ASSERT_EQ(5, gps_navigation_test_decode(nav, words));
+                        EXPECT_DOUBLE_EQ(toa * T_OA_LSB, nav.d_Toa);
+                        EXPECT_EQ(wna, nav.i_WN_A);
+                        for (int sv = 1; sv <= 24; sv++)
+                            {
+                                EXPECT_EQ(health[sv], nav.almanacHealth[sv]) << "SV " << sv;
+                            }
+                    }
+                else
+                    {
+                        ASSERT_EQ(5, gps_navigation_test_decode(nav, words));
+                    }
+                EXPECT_EQ(tow * 6, nav.d_TOW_SF5);
+                break;
+            }
+            EXPECT_EQ(tow * 6 - 6, nav.d_TOW);
+            EXPECT_EQ(integrity, nav.b_integrity_status_flag);
+            EXPECT_EQ(alert, nav.b_alert_flag);
+            EXPECT_EQ(antispoofing, nav.b_antispoofing_flag);
+        }
+}
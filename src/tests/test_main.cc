@@ -73,14 +73,24 @@ DECLARE_string(log_dir);
 #include "arithmetic/conjugate_test.cc"
 #include "arithmetic/magnitude_squared_test.cc"
 #include "arithmetic/multiply_test.cc"
+#include "arithmetic/ls_pvt_solver_test.cc"
+#include "arithmetic/satellite_position_cache_test.cc"
+#include "arithmetic/offline_pvt_engine_test.cc"
+#include "arithmetic/hybrid_ls_pvt_test.cc"
+#include "arithmetic/viterbi_decoder_test.cc"
+#include "arithmetic/galileo_e1_veml_correlator_test.cc"
 #include "configuration/file_configuration_test.cc"
 #include "configuration/in_memory_configuration_test.cc"
 #include "control_thread/control_message_factory_test.cc"
+#include "control_thread/concurrent_map_test.cc"
 //#include "control_thread/control_thread_test.cc"
 #include "flowgraph/pass_through_test.cc"
 //#include "flowgraph/gnss_flowgraph_test.cc"
 #include "gnss_block/gnss_block_factory_test.cc"
 #include "gnss_block/rtcm_printer_test.cc"
+#include "gnss_block/rinex_printer_test.cc"
+#include "gnss_block/pvt_output_sink_test.cc"
+#include "gnss_block/shm_communication_test.cc"
 #include "gnss_block/file_output_filter_test.cc"
 #include "gnss_block/file_signal_source_test.cc"
 #include "gnss_block/fir_filter_test.cc"
@@ -98,9 +108,17 @@ DECLARE_string(log_dir);
 #include "gnss_block/galileo_e1_pcps_tong_ambiguous_acquisition_gsoc2013_test.cc"
 #include "gnss_block/galileo_e1_pcps_cccwsr_ambiguous_acquisition_gsoc2013_test.cc"
 #include "gnss_block/galileo_e1_dll_pll_veml_tracking_test.cc"
+#include "gnss_block/gps_l1_ca_fsm_test.cc"
 #include "gnuradio_block/gnss_sdr_valve_test.cc"
 #include "gnuradio_block/direct_resampler_conditioner_cc_test.cc"
+#include "gnuradio_block/galileo_e1b_decoder_pool_test.cc"
+#include "gnuradio_block/telemetry_decoder_batch_test.cc"
+#include "gnuradio_block/sbas_l1_frame_detector_test.cc"
+#include "gnuradio_block/nav_archive_replay_source_test.cc"
+#include "gnuradio_block/observables_batch_test.cc"
 #include "string_converter/string_converter_test.cc"
+#include "system_parameters/gps_navigation_message_test.cc"
+#include "system_parameters/crc24q_test.cc"
 
 
 concurrent_queue<Gps_Ephemeris> global_gps_ephemeris_queue;
@@ -124,7 +124,9 @@ function [GNSS_tracking] = galileo_e1_dll_pll_veml_read_tracking_dump (filename,
 %                     // PRN start sample stamp
 %                     //tmp_float=(float)d_sample_counter;
 %                     d_dump_file.write((char*)&d_sample_counter, sizeof(unsigned long int));
-%                     // accumulated carrier phase
+%                     // accumulated carrier phase, rounded to float (dumps written
+%                     // before the Tracking_Dump_Record_VEPL records hold the first
+%                     // four bytes of the double accumulator instead)
 %                     d_dump_file.write((char*)&d_acc_carrier_phase_rad, sizeof(float));
 % 
 %                     // carrier and code frequency
@@ -0,0 +1,170 @@
+/*!
+ * \file main.cc
+ * \brief Main file of the offline PVT program, which computes the GPS L1 C/A
+ * fixes of an observables dump file and writes the KML, NMEA and RINEX outputs
+ *
+ * -------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2014  (see AUTHORS file for a list of contributors)
+ *
+ * GNSS-SDR is a software defined Global Navigation
+ *          Satellite Systems receiver
+ *
+ * This file is part of GNSS-SDR.
+ *
+ * GNSS-SDR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * at your option) any later version.
+ *
+ * GNSS-SDR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNSS-SDR. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------
+ */
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <sys/time.h>
+#include <boost/archive/xml_iarchive.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/nvp.hpp>
+#include <boost/thread/thread.hpp>
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include "gps_ephemeris.h"
+#include "gps_iono.h"
+#include "gps_utc_model.h"
+#include "observables_dump_reader.h"
+#include "offline_pvt_engine.h"
+#include "pvt_output_sink.h"
+
+using google::LogMessage;
+
+DEFINE_string(observables_dump, "./observables.dat", "Dump file of the GPS L1 C/A observables block (Observables.dump_filename)");
+DEFINE_int32(channels, 8, "Number of channels of the observables block (Channels_GPS.count)");
+DEFINE_int32(epoch_period_ms, 1, "Time between the epochs of the dump (Observables.output_rate_ms)");
+DEFINE_int32(output_rate_ms, 500, "Time between the PVT fixes (PVT.output_rate_ms)");
+DEFINE_int32(averaging_depth, 10, "Length of the PVT moving average (PVT.averaging_depth)");
+DEFINE_bool(flag_averaging, false, "Average the PVT fixes (PVT.flag_averaging)");
+DEFINE_int32(threads, 0, "Number of threads solving the fixes (0 for one per core)");
+DEFINE_string(gps_ephemeris_xml, "./gps_ephemeris.xml", "GPS ephemeris saved by the receiver (GNSS-SDR.SUPL_gps_ephemeris_xml)");
+DEFINE_string(gps_utc_model_xml, "./gps_utc_model.xml", "GPS UTC model saved by the receiver, for the RINEX headers");
+DEFINE_string(gps_iono_xml, "./gps_iono.xml", "GPS ionospheric model saved by the receiver, for the RINEX headers");
+DEFINE_string(kml_filename, "./offline_pvt.kml", "KML output file");
+DEFINE_string(nmea_filename, "./offline_pvt.nmea", "NMEA output file");
+
+
+/*
+ * Reads a map saved by ControlThread with boost::archive::xml_oarchive
+ */
+template<class T>
+bool offline_pvt_load_xml(std::string file_name, std::string name, std::map<int,T> &data_map)
+{
+    try
+    {
+            std::ifstream ifs(file_name.c_str(), std::ifstream::binary | std::ifstream::in);
+            boost::archive::xml_iarchive xml(ifs);
+            xml >> boost::serialization::make_nvp(name.c_str(), data_map);
+            ifs.close();
+    }
+    catch (std::exception& e)
+    {
+            LOG(WARNING) << e.what() << " File: " << file_name;
+            return false;
+    }
+    return true;
+}
+
+
+
+int main(int argc, char** argv)
+{
+    const std::string intro_help(
+            std::string("\nComputes the GPS L1 C/A PVT of an observables dump file on all the cores,\n")
+    +
+    "and writes the KML, NMEA and RINEX outputs of the PVT block\n"
+    +
+    "Copyright (C) 2010-2014 (see AUTHORS file for a list of contributors)\n"
+    +
+    "This program comes with ABSOLUTELY NO WARRANTY;\n"
+    +
+    "See COPYING file to see a copy of the General Public License\n \n");
+
+    const std::string gnss_sdr_version(GNSS_SDR_VERSION);
+    google::SetUsageMessage(intro_help);
+    google::SetVersionString(gnss_sdr_version);
+    google::ParseCommandLineFlags(&argc, &argv, true);
+    google::InitGoogleLogging(argv[0]);
+
+    std::map<int,Gps_Ephemeris> gps_ephemeris_map;
+    if (offline_pvt_load_xml(FLAGS_gps_ephemeris_xml, "GNSS-SDR_ephemeris_map", gps_ephemeris_map) == false or gps_ephemeris_map.size() == 0)
+        {
+            std::cout << "No GPS ephemeris could be read from " << FLAGS_gps_ephemeris_xml << std::endl;
+            return 1;
+        }
+    std::cout << "Loaded the ephemeris of " << gps_ephemeris_map.size() << " satellites" << std::endl;
+
+    // UTC and iono data are shared for all the GPS satellites, stored at ID=0
+    Gps_Utc_Model gps_utc_model;
+    Gps_Iono gps_iono;
+    std::map<int,Gps_Utc_Model> gps_utc_model_map;
+    std::map<int,Gps_Iono> gps_iono_map;
+    if (offline_pvt_load_xml(FLAGS_gps_utc_model_xml, "GNSS-SDR_utc_map", gps_utc_model_map) and gps_utc_model_map.size() > 0)
+        {
+            gps_utc_model = gps_utc_model_map.begin()->second;
+        }
+    else
+        {
+            std::cout << "No GPS UTC model in " << FLAGS_gps_utc_model_xml << std::endl;
+        }
+    if (offline_pvt_load_xml(FLAGS_gps_iono_xml, "GNSS-SDR_iono_map", gps_iono_map) and gps_iono_map.size() > 0)
+        {
+            gps_iono = gps_iono_map.begin()->second;
+        }
+    else
+        {
+            std::cout << "No GPS ionospheric model in " << FLAGS_gps_iono_xml << std::endl;
+        }
+
+    Observables_Dump_Reader reader;
+    if (reader.open(FLAGS_observables_dump, FLAGS_channels) == false)
+        {
+            std::cout << "Unable to read " << FLAGS_observables_dump << " as an observables dump of "
+                      << FLAGS_channels << " channels" << std::endl;
+            return 1;
+        }
+
+    int nthreads = FLAGS_threads;
+    if (nthreads <= 0) nthreads = boost::thread::hardware_concurrency();
+    Offline_Pvt_Engine engine(FLAGS_channels, FLAGS_epoch_period_ms, FLAGS_output_rate_ms,
+            FLAGS_averaging_depth, FLAGS_flag_averaging, nthreads);
+    engine.set_gps_navigation(gps_ephemeris_map, gps_iono, gps_utc_model);
+
+    std::cout << "Solving " << engine.fixes(reader) << " fixes of " << reader.epochs()
+              << " epochs on " << nthreads << " threads..." << std::endl;
+
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    long long int begin = tv.tv_sec * 1000000 + tv.tv_usec;
+
+    unsigned long int valid_fixes;
+    {
+        Pvt_Output_Sink sink(FLAGS_kml_filename, FLAGS_nmea_filename, false, "");
+        valid_fixes = engine.run(reader, sink);
+    }
+
+    gettimeofday(&tv, NULL);
+    long long int end = tv.tv_sec * 1000000 + tv.tv_usec;
+    std::cout << valid_fixes << " valid fixes written in " << (end - begin) / 1000000.0 << " [seconds]" << std::endl;
+
+    google::ShutDownCommandLineFlags();
+    return 0;
+}